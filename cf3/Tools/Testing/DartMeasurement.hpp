@@ -0,0 +1,39 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Tools_Testing_DartMeasurement_hpp
+#define cf3_Tools_Testing_DartMeasurement_hpp
+
+#include <iostream>
+#include <string>
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace Tools {
+namespace Testing {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Print a measurement in the format picked up by CDash
+/// @param name Name of the measurement, as shown on the dashboard
+/// @param value Measured value
+/// @param type Numeric type of the value, "double" or "integer"
+template<typename ValueT>
+void dart_measurement(const std::string& name, const ValueT& value, const std::string& type = "double")
+{
+  std::cout << "<DartMeasurement name=\"" << name << "\" type=\"numeric/" << type << "\">" << value << "</DartMeasurement>" << std::endl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // Testing
+} // Tools
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_Tools_Testing_DartMeasurement_hpp
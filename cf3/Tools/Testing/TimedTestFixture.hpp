@@ -16,6 +16,8 @@
 
 #include "common/Timer.hpp"
 
+#include "Tools/Testing/DartMeasurement.hpp"
+
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace cf3 {
@@ -49,8 +51,7 @@ public:
 
   /// Stop timing when a test ends
   void test_unit_finish( boost::unit_test::test_unit const& unit ) {
-    // TODO: Provide more generic support for output in CDash format
-    std::cout << "<DartMeasurement name=\"" << unit.p_name.get() << " time\" type=\"numeric/double\">" << m_timer.elapsed() << "</DartMeasurement>" << std::endl;
+    dart_measurement(unit.p_name.get() + " time", m_timer.elapsed());
   }
 private:
   common::Timer m_timer;
@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <iostream>
 #include <boost/program_options.hpp>
 #include <boost/regex.hpp>
@@ -24,6 +25,8 @@
 #include "mesh/MeshTransformer.hpp"
 #include "mesh/Field.hpp"
 #include "mesh/LoadMesh.hpp"
+#include "mesh/StreamingMeshReader.hpp"
+#include "mesh/StreamingMeshWriter.hpp"
 
 #include "Tools/Shell/BasicCommands.hpp"
 #include "Tools/mesh_transformer/Transformer.hpp"
@@ -58,6 +61,7 @@ Transformer::commands_description Transformer::description()
   ("input3d",   value< std::vector<std::string> >()->notifier(&input3   )->multitoken(), "input file(s), force 3D")
   ("output" ,   value< std::vector<std::string> >()->notifier(&output   )->multitoken(), "output file(s)")
   ("transform", value< std::vector<std::string> >()->notifier(&transform)->multitoken(), "transformations")
+  ("convert",   value< std::vector<std::string> >()->notifier(&convert  )->multitoken(), "convert input file to output file in chunks, without building the mesh (args: input output [chunk_size:integer=N])")
   ;
   return desc;
 }
@@ -330,6 +334,50 @@ void Transformer::transform( const std::vector<std::string>& params )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void Transformer::convert( const std::vector<std::string>& params )
+{
+  if (params.size() < 2)
+    throw SetupError(FromHere(), "convert needs an input and an output file");
+
+  const URI inputfile (params[0],URI::Scheme::FILE);
+  const URI outputfile (params[1],URI::Scheme::FILE);
+
+  boost::shared_ptr< StreamingMeshReader > reader;
+  Handle< Factory > reader_fac = Core::instance().factories().get_factory<StreamingMeshReader>();
+  boost_foreach(Builder& bdr, find_components_recursively<Builder>( *reader_fac ) )
+  {
+    boost::shared_ptr< StreamingMeshReader > candidate = boost::dynamic_pointer_cast<StreamingMeshReader>(bdr.build("reader"));
+    const std::vector<std::string> extensions = candidate->get_extensions();
+    if (std::find(extensions.begin(), extensions.end(), inputfile.extension()) != extensions.end())
+      reader = candidate;
+  }
+
+  boost::shared_ptr< StreamingMeshWriter > writer;
+  Handle< Factory > writer_fac = Core::instance().factories().get_factory<StreamingMeshWriter>();
+  boost_foreach(Builder& bdw, find_components_recursively<Builder>( *writer_fac ) )
+  {
+    boost::shared_ptr< StreamingMeshWriter > candidate = boost::dynamic_pointer_cast<StreamingMeshWriter>(bdw.build("writer"));
+    const std::vector<std::string> extensions = candidate->get_extensions();
+    if (std::find(extensions.begin(), extensions.end(), outputfile.extension()) != extensions.end())
+      writer = candidate;
+  }
+
+  if (!reader)
+    throw FileFormatError(FromHere(), "No streaming mesh reader for extension " + inputfile.extension()
+                          + ", use --input and --output instead");
+  if (!writer)
+    throw FileFormatError(FromHere(), "No streaming mesh writer for extension " + outputfile.extension()
+                          + ", use --input and --output instead");
+
+  std::vector<std::string> reader_args(params.begin()+2, params.end());
+  reader->options().set(reader_args);
+
+  CFinfo << "\nConverting " << inputfile.path() << " with " << reader->get_format() << " to " << writer->get_format() << CFendl;
+  reader->convert(inputfile, outputfile, *writer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh_transformer
 } // Tools
 } // cf3
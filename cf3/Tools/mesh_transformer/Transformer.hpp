@@ -42,6 +42,7 @@ public:
   static void input3( const std::vector<std::string>& params);
   static void output( const std::vector<std::string>& params );
   static void transform( const std::vector<std::string>& params );
+  static void convert( const std::vector<std::string>& params );
 
   static commands_description description();
 };
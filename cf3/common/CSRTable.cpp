@@ -0,0 +1,74 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/Builder.hpp"
+
+#include "common/LibCommon.hpp"
+#include "common/CSRTable.hpp"
+
+namespace cf3 {
+namespace common {
+
+common::ComponentBuilder < CSRTable<Uint>, Component, LibCommon > CSRTable_Uint_Builder;
+
+common::ComponentBuilder < CSRTable<int>, Component, LibCommon >  CSRTable_int_Builder;
+
+common::ComponentBuilder < CSRTable<Real>, Component, LibCommon > CSRTable_Real_Builder;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+  template<typename RowT>
+  void print_row(std::ostream& os, const RowT& row)
+  {
+    if (row.empty())
+      os << "~";
+    else
+    {
+      boost_foreach(const typename boost::range_value<RowT>::type& entry, row)
+        os << entry << " ";
+    }
+  }
+
+  template<typename T>
+  void print_table(std::ostream& os, const CSRTable<T>& table)
+  {
+    if (table.size())
+      os << "\n";
+    for (Uint i=0; i<table.size(); ++i)
+    {
+      os << "  " << i << ":  ";
+      print_row(os, table[i]);
+      os << "\n";
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::ostream& operator<<(std::ostream& os, const CSRTable<Uint>& table)
+{
+  detail::print_table(os, table);
+  return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const CSRTable<int>& table)
+{
+  detail::print_table(os, table);
+  return os;
+}
+
+std::ostream& operator<<(std::ostream& os, const CSRTable<Real>& table)
+{
+  detail::print_table(os, table);
+  return os;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
@@ -0,0 +1,164 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_common_CSRTable_hpp
+#define cf3_common_CSRTable_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/range/iterator_range.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Component.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Foreach.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Component holding a table with variable row-size per row, stored in compressed sparse row format:
+/// all values are packed in a single array, and row i holds the values between offsets()[i] and offsets()[i+1].
+/// Compared to DynTable, this avoids one allocation per row, at the cost of fixing the row sizes before filling.
+/// The table is built in two passes:
+/// -# count the number of entries of each row, and call set_row_sizes()
+/// -# fill the rows through operator[]
+/// The rows have the same access interface as the DynTable rows (size(), operator[], iteration)
+template<typename T>
+class CSRTable : public common::Component {
+
+public:
+
+  typedef std::vector<T> ValuesT;
+  typedef std::vector<Uint> OffsetsT;
+  typedef boost::iterator_range<T*> Row;
+  typedef boost::iterator_range<const T*> ConstRow;
+
+  /// Contructor
+  /// @param name of the component
+  CSRTable ( const std::string& name ) : Component(name), m_offsets(1,0) { }
+
+  ~CSRTable () {}
+
+  /// Get the class name
+  static std::string type_name () { return "CSRTable<"+common::class_name<T>()+">"; }
+
+  /// Number of rows
+  Uint size() const { return m_offsets.size()-1; }
+
+  /// Total number of entries, summed over all rows
+  Uint nb_values() const { return m_values.size(); }
+
+  /// Number of entries in row i
+  Uint row_size(const Uint i) const { cf3_assert(i<size()); return m_offsets[i+1]-m_offsets[i]; }
+
+  /// Change the number of rows. Existing rows are kept, new rows are empty.
+  void resize(const Uint new_size)
+  {
+    m_offsets.resize(new_size+1,m_offsets.back());
+    m_values.resize(m_offsets.back());
+  }
+
+  /// Remove all rows and release the memory
+  void clear()
+  {
+    OffsetsT(1,0).swap(m_offsets);
+    ValuesT().swap(m_values);
+  }
+
+  /// Allocate the table for the given row sizes. The number of rows is set to row_sizes.size().
+  /// All values are default-initialized, and must be filled afterwards using operator[]
+  template<typename VectorT>
+  void set_row_sizes(const VectorT& row_sizes)
+  {
+    m_offsets.resize(row_sizes.size()+1);
+    m_offsets[0] = 0;
+    for(Uint i=0; i<row_sizes.size(); ++i)
+      m_offsets[i+1] = m_offsets[i] + row_sizes[i];
+    ValuesT(m_offsets.back()).swap(m_values);
+  }
+
+  /// Copy row into row array_idx, which must have the same size
+  template<typename VectorT>
+  void set_row(const Uint array_idx, const VectorT& row)
+  {
+    if (row.size() != row_size(array_idx))
+      throw BadValue(FromHere(), "Row size " + to_str(row.size()) + " does not match allocated size " + to_str(row_size(array_idx)) + " of row " + to_str(array_idx) + " in " + uri().string());
+
+    Uint j=m_offsets[array_idx];
+    boost_foreach( const typename VectorT::value_type& v, row)
+      m_values[j++] = v;
+  }
+
+  Row operator[] (const Uint idx)
+  {
+    cf3_assert(idx<size());
+    T* begin = data();
+    return Row(begin+m_offsets[idx], begin+m_offsets[idx+1]);
+  }
+
+  ConstRow operator[] (const Uint idx) const
+  {
+    cf3_assert(idx<size());
+    const T* begin = data();
+    return ConstRow(begin+m_offsets[idx], begin+m_offsets[idx+1]);
+  }
+
+  /// @return The start of each row in values(), with an extra entry holding the total number of values
+  const OffsetsT& offsets() const { return m_offsets; }
+
+  /// @return The packed values of all rows
+  ValuesT& values() { return m_values; }
+
+  /// @return The packed values of all rows
+  const ValuesT& values() const { return m_values; }
+
+  /// @return The number of bytes allocated for the table data
+  Uint memory_size() const { return m_offsets.capacity()*sizeof(Uint) + m_values.capacity()*sizeof(T); }
+
+private: // functions
+
+  T* data()
+  {
+    if (m_values.empty())
+      return nullptr;
+    return &m_values[0];
+  }
+
+  const T* data() const
+  {
+    if (m_values.empty())
+      return nullptr;
+    return &m_values[0];
+  }
+
+private: // data
+
+  /// Start of each row in m_values, size()+1 entries
+  OffsetsT m_offsets;
+
+  /// Packed row values
+  ValuesT m_values;
+
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::ostream& operator<<(std::ostream& os, const CSRTable<Uint>& table);
+std::ostream& operator<<(std::ostream& os, const CSRTable<int>& table);
+std::ostream& operator<<(std::ostream& os, const CSRTable<Real>& table);
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // common
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_common_CSRTable_hpp
@@ -86,6 +86,27 @@ Environment::Environment ( const std::string& name) : Component ( name )
       .description("If true, signal error when some user provided config parameters are not used.")
       .mark_basic();
 
+  options().add("nb_threads", 1u)
+      .pretty_name("Number of Threads")
+      .description("Number of shared-memory threads used by the loops that support threading. 1 disables threading.")
+      .mark_basic();
+
+  options().add("compile_functions", false)
+      .pretty_name("Compile Functions")
+      .description("If true, parsed analytical functions are translated to C and compiled with the function_compiler into shared "
+                   "objects, cached in function_cache_dir. Functions that fail to compile are interpreted.")
+      .mark_basic();
+
+  options().add("function_compiler", std::string("cc -O2 -fPIC -shared"))
+      .pretty_name("Function Compiler")
+      .description("Command compiling a C file into a shared object, used for compile_functions. The source file, "
+                   "-o and the output file are appended.");
+
+  options().add("function_cache_dir", std::string())
+      .pretty_name("Function Cache Directory")
+      .description("Directory holding the compiled functions. Empty means coolfluid-functions-<user id> in the temporary directory. "
+                   "It is created accessible by the current user only, and libraries owned by someone else or writable by others are not loaded.");
+
   options().add("main_logger_file_name", std::string("output.log"))
       .pretty_name("Main Logger File Name")
       .description("The name if the file in which to put the logging messages.")
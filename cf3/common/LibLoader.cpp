@@ -52,6 +52,13 @@ void LibLoader::unload_library( Library& lib )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void* LibLoader::system_load_symbol(const std::string& lib, const std::string& symbol)
+{
+  throw LibLoadingError("Loading symbol " + symbol + " from library " + lib + " is not supported by this library loader");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // common
 } // cf3
 
@@ -62,6 +62,12 @@ public: // methods
   ///
   virtual void set_search_paths(const std::vector< URI >& paths) = 0;
 
+  /// Loads a plain shared library, if not loaded yet, and returns the address of a symbol in it.
+  /// Unlike load_library, the library is not initiated as a coolfluid library.
+  /// @throw LibLoadingError if the library or the symbol can't be found, or if the operating system
+  ///        doesn't support it
+  virtual void* system_load_symbol(const std::string& lib, const std::string& symbol);
+
   /// Gets the Class name
   static std::string type_name() { return "LibLoader"; }
 
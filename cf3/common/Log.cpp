@@ -12,6 +12,7 @@
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/stream_buffer.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/thread/tss.hpp>
 
 #include "common/BoostFilesystem.hpp"
 
@@ -36,6 +37,19 @@ namespace common {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+/// Private stream of each muted thread
+boost::thread_specific_ptr<LogStream>& muted_stream()
+{
+  static boost::thread_specific_ptr<LogStream> stream;
+  return stream;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 Logger::Logger()
 {
   // streams initialization
@@ -82,34 +96,36 @@ void Logger::initiate()
 
 LogStream & Logger::Info (const CodeLocation & place)
 {
-  return *(m_streams[INFO]) << place;
+  return getStream(INFO) << place;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 LogStream & Logger::Error(const CodeLocation & place)
 {
-  return *(m_streams[ERROR]) << place;
+  return getStream(ERROR) << place;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 LogStream & Logger::Warn(const CodeLocation & place)
 {
-  return *(m_streams[WARNING]) << place;
+  return getStream(WARNING) << place;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 LogStream & Logger::Debug(const CodeLocation & place)
 {
-  return *(m_streams[DEBUG]) << place;
+  return getStream(DEBUG) << place;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 LogStream & Logger::getStream(LogLevel type)
 {
+  if(is_not_null(muted_stream().get()))
+    return *muted_stream();
   return *(m_streams[type]);
 }
 
@@ -151,5 +167,33 @@ void Logger::set_log_level(const Uint log_level)
 
 //////////////////////////////////////////////////////////////////////////////
 
+void Logger::set_thread_muted(const bool muted)
+{
+  if(!muted)
+  {
+    muted_stream().reset();
+    return;
+  }
+
+  if(is_not_null(muted_stream().get()))
+    return;
+
+  LogStream* stream = new LogStream("Muted");
+  stream->useDestination(LogStream::SCREEN, false);
+  stream->useDestination(LogStream::FILE, false);
+  stream->useDestination(LogStream::STRING, false);
+  stream->useDestination(LogStream::SYNC_SCREEN, false);
+  muted_stream().reset(stream);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+bool Logger::is_thread_muted() const
+{
+  return is_not_null(muted_stream().get());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 } // common
 } // cf3
@@ -80,6 +80,17 @@ class Common_API Logger : public boost::noncopyable {
 
   void set_log_level(const Uint log_level);
 
+  /// @brief Discards the messages logged by the calling thread, or restores them.
+
+  /// The streams are shared and not thread-safe, so a thread other than the main
+  /// thread must be muted before it runs code that logs. Each muted thread logs
+  /// to a private stream without destinations, deleted when the thread exits.
+  /// @param muted If @c true, the messages of the calling thread are discarded.
+  void set_thread_muted(const bool muted);
+
+  /// @return Returns @c true if the messages of the calling thread are discarded.
+  bool is_thread_muted() const;
+
   private :
 
   /// @brief Managed streams.
@@ -51,7 +51,10 @@ CommPattern::CommPattern(const std::string& name): Component(name), m_gid(alloca
   m_sendCount(PE::Comm::instance().size(),0),
   m_sendMap(0),
   m_recvCount(PE::Comm::instance().size(),0),
-  m_recvMap(0)
+  m_recvMap(0),
+  m_sendStarts(1,0),
+  m_recvStarts(1,0),
+  m_schedule_version(0)
 {
   //self->regist_signal ( "update" , "Executes communication patterns on all the registered data.", "" ).connect ( boost::bind ( &CommPattern2::update, self, _1 ) );
   m_isUpToDate=false;
@@ -62,6 +65,8 @@ CommPattern::CommPattern(const std::string& name): Component(name), m_gid(alloca
 
 CommPattern::~CommPattern()
 {
+  for (SyncBuffersT::iterator it=m_sync_buffers.begin(); it!=m_sync_buffers.end(); ++it)
+    free_requests(it->second);
   if (m_gid.get()!=nullptr) m_gid->remove_tag("gid_of_"+this->name());
 }
 
@@ -455,6 +460,8 @@ void CommPattern::setup()
 //PEProcessSortedExecute(-1, PEDebugVector(m_sendMap,m_sendMap.size()); );
 //PECheckPoint(100,"");
 
+  setup_neighbours();
+
   // set gids
   m_gid->resize(m_add_buffer.size());
   CommWrapperView<Uint> cwv_gid(m_gid);
@@ -560,49 +567,172 @@ void CommPattern::setup()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-void CommPattern::synchronize_all()
+void CommPattern::setup_neighbours()
 {
-  std::vector<unsigned char> sndbuf(1);
-  std::vector<unsigned char> rcvbuf(1);
-  BOOST_FOREACH( CommWrapper& pobj, find_components_recursively<CommWrapper>(*this) )
+  m_sendRanks.clear();
+  m_sendStarts.assign(1,0);
+  for (int i=0; i<(const int)m_sendCount.size(); i++)
+    if (m_sendCount[i]!=0)
+    {
+      m_sendRanks.push_back(i);
+      m_sendStarts.push_back(m_sendStarts.back()+m_sendCount[i]);
+    }
+
+  m_recvRanks.clear();
+  m_recvStarts.assign(1,0);
+  for (int i=0; i<(const int)m_recvCount.size(); i++)
+    if (m_recvCount[i]!=0)
+    {
+      m_recvRanks.push_back(i);
+      m_recvStarts.push_back(m_recvStarts.back()+m_recvCount[i]);
+    }
+
+  // the persistent requests of all the parallel objects are recreated on their next synchronization
+  ++m_schedule_version;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::setup_sync_buffers( SyncBuffers& buffers, const int item_size )
+{
+  if ( buffers.schedule_version==m_schedule_version && buffers.item_size==item_size ) return;
+
+  free_requests(buffers);
+
+  // the requests point into the buffers, so these must never be reallocated afterwards
+  // one extra item keeps &buf[0] valid when there is nothing to communicate
+  buffers.sndbuf.resize((m_sendMap.size()+1)*item_size);
+  buffers.rcvbuf.resize((m_recvMap.size()+1)*item_size);
+  buffers.requests.assign(m_recvRanks.size()+m_sendRanks.size(),MPI_REQUEST_NULL);
+
+  const Communicator comm=PE::Comm::instance().communicator();
+  const int tag=0;
+  const int nrecv=m_recvRanks.size();
+  for (int i=0; i<nrecv; i++)
+    MPI_CHECK_RESULT(MPI_Recv_init, (&buffers.rcvbuf[m_recvStarts[i]*item_size], (m_recvStarts[i+1]-m_recvStarts[i])*item_size, MPI_BYTE, m_recvRanks[i], tag, comm, &buffers.requests[i]));
+  for (int i=0; i<(const int)m_sendRanks.size(); i++)
+    MPI_CHECK_RESULT(MPI_Send_init, (&buffers.sndbuf[m_sendStarts[i]*item_size], (m_sendStarts[i+1]-m_sendStarts[i])*item_size, MPI_BYTE, m_sendRanks[i], tag, comm, &buffers.requests[nrecv+i]));
+
+  buffers.schedule_version=m_schedule_version;
+  buffers.item_size=item_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::free_requests( SyncBuffers& buffers )
+{
+  // after MPI_Finalize the requests are gone anyway
+  if ( PE::Comm::instance().is_initialized() && !PE::Comm::instance().is_finalized() )
   {
-    synchronize_this(pobj,sndbuf,rcvbuf);
+    BOOST_FOREACH( MPI_Request& request, buffers.requests )
+      if (request!=MPI_REQUEST_NULL)
+        MPI_CHECK_RESULT(MPI_Request_free, (&request));
   }
+  buffers.requests.clear();
+  buffers.schedule_version=0;
+  buffers.item_size=0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::free_sync_buffers( const CommWrapper& pobj )
+{
+  SyncBuffersT::iterator buffers_it=m_sync_buffers.find(&pobj);
+  if (buffers_it==m_sync_buffers.end()) return;
+  if (buffers_it->second.in_progress)
+    throw ShouldNotBeHere(FromHere(), type_name() + " at " + uri().path() + ": " + pobj.name() + " was removed while being synchronized.");
+  free_requests(buffers_it->second);
+  m_sync_buffers.erase(buffers_it);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::synchronize_all()
+{
+  // start all, so the messages of the different objects are in flight at the same time
+  BOOST_FOREACH( CommWrapper& pobj, find_components_recursively<CommWrapper>(*this) )
+    start_synchronize(pobj);
+  BOOST_FOREACH( CommWrapper& pobj, find_components_recursively<CommWrapper>(*this) )
+    finish_synchronize(pobj);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void CommPattern::synchronize( const std::string& name )
 {
-  std::vector<unsigned char> sndbuf(1);
-  std::vector<unsigned char> rcvbuf(1);
   Handle<CommWrapper> pobj(get_child(name));
-  synchronize_this(*pobj,sndbuf,rcvbuf);
+  synchronize_this(*pobj);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
 void CommPattern::synchronize( const CommWrapper& pobj )
 {
-  std::vector<unsigned char> sndbuf(1);
-  std::vector<unsigned char> rcvbuf(1);
-  synchronize_this(pobj,sndbuf,rcvbuf);
+  synchronize_this(pobj);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
-// having the vectors for the intermediate buf coming from outside allows keeping them and reuse for all synchronize
-void CommPattern::synchronize_this( const CommWrapper& pobj, std::vector<unsigned char>& sndbuf, std::vector<unsigned char>& rcvbuf )
+void CommPattern::synchronize_this( const CommWrapper& pobj )
 {
-//  std::cout << PERank << pobj.name() << "\n" << std::flush;
-//  std::cout << PERank << pobj.needs_update() << "\n" << std::flush;
-  if ( pobj.needs_update() )
-  {
-    pobj.pack(sndbuf,m_sendMap);
-    rcvbuf.resize(m_recvMap.size()*pobj.size_of()*pobj.stride());
-    PE::Comm::instance().all_to_all(sndbuf,m_sendCount,rcvbuf,m_recvCount,pobj.size_of()*pobj.stride());
-    pobj.unpack(rcvbuf,m_recvMap);
-  }
+  start_synchronize(pobj);
+  finish_synchronize(pobj);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::start_synchronize( const std::string& name )
+{
+  Handle<CommWrapper> pobj(get_child(name));
+  if (is_null(pobj)) throw ValueNotFound(FromHere(), type_name() + " at " + uri().path() + ": no parallel object named " + name);
+  start_synchronize(*pobj);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::start_synchronize( const CommWrapper& pobj )
+{
+  if ( !pobj.needs_update() ) return;
+
+  SyncBuffers& buffers=m_sync_buffers[&pobj];
+  if (buffers.in_progress)
+    throw ShouldNotBeHere(FromHere(), type_name() + " at " + uri().path() + ": synchronization of " + pobj.name() + " was started twice.");
+
+  // the schedule of neighbours is fixed by setup, only the data is packed and the persistent requests are restarted
+  setup_sync_buffers(buffers,pobj.size_of()*pobj.stride());
+  pobj.pack(m_sendMap,&buffers.sndbuf[0]);
+  if (!buffers.requests.empty())
+    MPI_CHECK_RESULT(MPI_Startall, ((int)buffers.requests.size(), &buffers.requests[0]));
+
+  buffers.in_progress=true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::finish_synchronize( const std::string& name )
+{
+  Handle<CommWrapper> pobj(get_child(name));
+  if (is_null(pobj)) throw ValueNotFound(FromHere(), type_name() + " at " + uri().path() + ": no parallel object named " + name);
+  finish_synchronize(*pobj);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void CommPattern::finish_synchronize( const CommWrapper& pobj )
+{
+  if ( !pobj.needs_update() ) return;
+
+  SyncBuffersT::iterator buffers_it=m_sync_buffers.find(&pobj);
+  if (buffers_it==m_sync_buffers.end() || !buffers_it->second.in_progress)
+    throw ShouldNotBeHere(FromHere(), type_name() + " at " + uri().path() + ": synchronization of " + pobj.name() + " was not started.");
+
+  SyncBuffers& buffers=buffers_it->second;
+  buffers.in_progress=false;
+  if (!buffers.requests.empty())
+    MPI_CHECK_RESULT(MPI_Waitall, ((int)buffers.requests.size(), &buffers.requests[0], MPI_STATUSES_IGNORE));
+
+  if (!m_recvMap.empty())
+    pobj.unpack(&buffers.rcvbuf[0],m_recvMap);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -7,6 +7,8 @@
 #ifndef cf3_common_PE_CommPattern_hpp
 #define cf3_common_PE_CommPattern_hpp
 
+#include <map>
+
 #include "common/Component.hpp"
 #include "common/BoostArray.hpp"
 #include "common/PE/Comm.hpp"
@@ -188,8 +190,9 @@ public:
   /// removes data by name
   void clear( const std::string& name)
   {
+    Handle<CommWrapper> pobj(get_child(name));
+    if (is_not_null(pobj)) free_sync_buffers(*pobj);
     remove_component(name);
-    // anything to be deallocated?
   }
 
   //@} END DATA REGISTRATION
@@ -229,6 +232,26 @@ public:
   /// @param name the name of the parallel object
   void synchronize( const CommWrapper& pobj );
 
+  /// start synchronizing the parallel object designated by its name, without waiting for the ghost data to arrive
+  /// @param name the name of the parallel object
+  /// @see start_synchronize( const CommWrapper& pobj )
+  void start_synchronize( const std::string& name );
+
+  /// start synchronizing the parallel object designated by its commwrapper reference, without waiting for the ghost data to arrive
+  /// persistent sends and receives to the neighbouring ranks only are created on the first call after setup, and restarted afterwards
+  /// the data of the updatable nodes must not change and the ghosts must not be used until finish_synchronize is called
+  /// all ranks must start the synchronizations of the different objects in the same order
+  /// @param pobj reference to the commwrapper object to synchronize
+  void start_synchronize( const CommWrapper& pobj );
+
+  /// wait for the synchronization of the parallel object designated by its name to complete
+  /// @param name the name of the parallel object
+  void finish_synchronize( const std::string& name );
+
+  /// wait for the synchronization of the parallel object designated by its commwrapper reference to complete, and update the ghosts
+  /// @param pobj reference to the commwrapper object passed to start_synchronize
+  void finish_synchronize( const CommWrapper& pobj );
+
   /// add element to the commpattern
   /// when all changes done, all needs to be committed by calling setup
   /// if global id is not on current rank, then a ghost is automatically created on current rank
@@ -288,9 +311,14 @@ protected: // helper function
   /// function to synchronize this object
   /// useful for reusing in the different synchronize functions
   /// @param pobj reference to commwrapper object to synchronize to
-  /// @param sndbuf vector for intermediate buffer for send
-  /// @param rcvbuf vector for intermediate buffer for recieve
-  void synchronize_this( const CommWrapper& pobj, std::vector<unsigned char>& sndbuf, std::vector<unsigned char>& rcvbuf );
+  void synchronize_this( const CommWrapper& pobj );
+
+  /// compute the lists of neighbouring ranks from m_sendCount and m_recvCount
+  void setup_neighbours();
+
+  /// free the persistent requests and buffers of the synchronization of a parallel object
+  /// @param pobj reference to the commwrapper object
+  void free_sync_buffers( const CommWrapper& pobj );
 
 private:
 
@@ -343,6 +371,45 @@ private:
   /// this is the map of receiveing communication pattern
   std::vector< CPint > m_recvMap;
 
+  /// ranks that are sent data to, in increasing order
+  std::vector< CPint > m_sendRanks;
+
+  /// start of the data for each rank of m_sendRanks in m_sendMap, with an extra entry holding the end
+  std::vector< CPint > m_sendStarts;
+
+  /// ranks that data is received from, in increasing order
+  std::vector< CPint > m_recvRanks;
+
+  /// start of the data for each rank of m_recvRanks in m_recvMap, with an extra entry holding the end
+  std::vector< CPint > m_recvStarts;
+
+  /// counter incremented each time the neighbour lists change, to detect outdated persistent requests
+  Uint m_schedule_version;
+
+  /// intermediate buffers and persistent requests of the synchronization of one parallel object
+  struct SyncBuffers
+  {
+    SyncBuffers() : schedule_version(0), item_size(0), in_progress(false) {}
+    std::vector<unsigned char> sndbuf;
+    std::vector<unsigned char> rcvbuf;
+    std::vector<MPI_Request> requests;
+    /// value of m_schedule_version when the requests were created
+    Uint schedule_version;
+    /// number of bytes per item the requests were created for
+    int item_size;
+    bool in_progress;
+  };
+
+  /// (re)create the buffers and persistent requests if the schedule or the item size changed
+  void setup_sync_buffers( SyncBuffers& buffers, const int item_size );
+
+  /// free the persistent requests of buffers
+  void free_requests( SyncBuffers& buffers );
+
+  /// synchronization buffers, kept per parallel object to avoid reallocation
+  typedef std::map<const CommWrapper*, SyncBuffers> SyncBuffersT;
+  SyncBuffersT m_sync_buffers;
+
 }; // CommPattern
 
 ////////////////////////////////////////////////////////////////////////////////////////////
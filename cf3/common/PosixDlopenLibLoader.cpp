@@ -140,6 +140,27 @@ void PosixDlopenLibLoader::system_load_library(const std::string& lib)
   throw LibLoadingError ("Library " + lib + " failed to load with dlopen error: " + std::string(msg));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+void* PosixDlopenLibLoader::system_load_symbol(const std::string& lib, const std::string& symbol)
+{
+  // dlopen returns the same handle if the library was loaded before
+  void* hdl = call_dlopen( URI(lib) );
+  if( is_null(hdl) )
+  {
+    const char * msg = dlerror();
+    throw LibLoadingError ("Library " + lib + " failed to load with dlopen error: " + std::string(msg));
+  }
+
+  dlerror(); // clear previous errors
+  void* address = dlsym(hdl, symbol.c_str());
+  const char * msg = dlerror();
+  if( is_not_null(msg) )
+    throw LibLoadingError ("Symbol " + symbol + " not found in library " + lib + ": " + std::string(msg));
+
+  return address;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
   } // common
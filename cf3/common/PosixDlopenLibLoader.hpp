@@ -37,6 +37,10 @@ public: // functions
   ///
   virtual void set_search_paths(const std::vector< URI >& paths);
 
+  /// Loads a plain shared library with dlopen and finds a symbol in it with dlsym
+  /// @throw LibLoadingError if the library or the symbol can't be found
+  virtual void* system_load_symbol(const std::string& lib, const std::string& symbol);
+
   protected:
 
   void* call_dlopen(const URI& fpath);
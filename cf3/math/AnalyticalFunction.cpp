@@ -28,14 +28,16 @@ namespace math {
 AnalyticalFunction::AnalyticalFunction()
   : m_is_parsed(false),
     m_vars(),
-    m_function("")
+    m_function(""),
+    m_compiled(0)
 {
 }
 
 AnalyticalFunction::AnalyticalFunction( const std::string& func, const std::string& vars, const std::string& separator)
   : m_is_parsed(false),
     m_vars(),
-    m_function("")
+    m_function(""),
+    m_compiled(0)
 {
   parse(func,vars,separator);
 }
@@ -43,7 +45,8 @@ AnalyticalFunction::AnalyticalFunction( const std::string& func, const std::stri
 AnalyticalFunction::AnalyticalFunction( const std::string& func, const std::vector<std::string>& vars )
   : m_is_parsed(false),
     m_vars(),
-    m_function("")
+    m_function(""),
+    m_compiled(0)
 {
   parse(func,vars);
 }
@@ -60,6 +63,7 @@ AnalyticalFunction::~AnalyticalFunction()
 void AnalyticalFunction::clear()
 {
   m_parser.reset();
+  m_compiled = 0;
   m_is_parsed = false;
 }
 
@@ -101,7 +105,7 @@ void AnalyticalFunction::parse (const std::string& function)
   clear();
   m_function = function;
 
-  m_parser = boost::shared_ptr<FunctionParser>( new FunctionParser() );
+  m_parser = boost::shared_ptr<BatchFunctionParser>( new BatchFunctionParser() );
   m_parser->AddConstant("pi", Consts::pi());
 
     // CFinfo << "Parsing Function: \'" << m_functions[i] << "\' Vars: \'" << m_vars << "\'\n" << CFendl;
@@ -122,6 +126,18 @@ void AnalyticalFunction::parse (const std::string& function)
     throw common::ParsingFailed (FromHere(),msg);
   }
   m_is_parsed = true;
+
+  if(FunctionCompiler::enabled())
+    compile();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool AnalyticalFunction::compile()
+{
+  cf3_assert(m_is_parsed);
+  m_compiled = FunctionCompiler::compile(*m_parser).function;
+  return m_compiled != 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -9,8 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
-#include "fparser/fparser.hh"
-
+#include "math/BatchFunctionParser.hpp"
+#include "math/FunctionCompiler.hpp"
 #include "math/LibMath.hpp"
 #include "math/MatrixTypes.hpp"
 
@@ -59,6 +59,12 @@ public: // functions
   /// @throw ParsingFailed if there is an error while parsing
   void parse (const std::string& function, const std::vector<std::string>& vars);
 
+  /// Compile the parsed function to native code, see FunctionCompiler.
+  /// parse() calls this if the compile_functions option of the environment is set.
+  /// @pre only call this function if already parsed
+  /// @return true if the function was compiled, otherwise it keeps being interpreted
+  bool compile();
+
   /// @return if the AnalyticalFunctionParser has been parsed yet.
   bool is_parsed() const { return m_is_parsed; }
 
@@ -102,7 +108,10 @@ private: // data
   std::string m_function; 
 
   /// vector holding the parsers, one for each entry in the vector
-  boost::shared_ptr<FunctionParser> m_parser;
+  boost::shared_ptr<BatchFunctionParser> m_parser;
+
+  /// compiled version of the parser, null if the function is interpreted
+  FunctionCompiler::FunctionT m_compiled;
 
 }; // AnalyticalFunction
 
@@ -115,7 +124,7 @@ void AnalyticalFunction::evaluate(const var_t& var_values, ret_t& ret_value) con
   cf3_assert(var_values.size() == m_vars.size());
 
   // evaluate and store the functions line by line in the vector
-  ret_value = m_parser->Eval(&var_values[0]);
+  ret_value = m_compiled ? m_compiled(&var_values[0]) : m_parser->Eval(&var_values[0]);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,574 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <cstdio>
+#include <map>
+#include <sstream>
+
+#include <boost/math/special_functions/fpclassify.hpp>
+
+#include "common/StringConversion.hpp"
+
+#include "math/BatchFunctionParser.hpp"
+
+// The bytecode and the math functions of the parser, as used by FunctionParser::Eval
+#include "fparser/extrasrc/fptypes.hh"
+#include "fparser/extrasrc/fpaux.hh"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace FUNCTIONPARSERTYPES;
+
+namespace cf3 {
+namespace math {
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Loops over the points of the batch. x is the top of the stack, y the level below it for binary operations.
+// The checks mirror the evaluation checks of FunctionParser::Eval, so the points where Eval fails are detected.
+#define CF3_BATCH_CHECK(cond) \
+  { bool failed = false; for(Uint i = 0; i != n; ++i) { const Real x = top[i]; failed |= (cond); } if(failed) return false; }
+#define CF3_BATCH_CHECK2(cond) \
+  { bool failed = false; for(Uint i = 0; i != n; ++i) { const Real x = below[i]; const Real y = top[i]; failed |= (cond); } if(failed) return false; }
+#define CF3_BATCH_UNARY(expr) \
+  { for(Uint i = 0; i != n; ++i) { const Real x = top[i]; top[i] = (expr); } break; }
+#define CF3_BATCH_BINARY(expr) \
+  { for(Uint i = 0; i != n; ++i) { const Real x = below[i]; const Real y = top[i]; below[i] = (expr); } --SP; break; }
+
+////////////////////////////////////////////////////////////////////////////////
+
+BatchFunctionParser::BatchFunctionParser() :
+  m_batchable(false)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int BatchFunctionParser::Parse(const std::string& function, const std::string& vars, bool use_degrees)
+{
+  const int result = FunctionParser::Parse(function, vars, use_degrees);
+  m_batchable = scan_batchable();
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool BatchFunctionParser::scan_batchable() const
+{
+  const Data& data = *const_cast<BatchFunctionParser*>(this)->getParserData();
+  if(data.mParseErrorType != FP_NO_ERROR)
+    return false;
+
+  for(Uint IP = 0; IP < data.mByteCode.size(); ++IP)
+  {
+    switch(data.mByteCode[IP])
+    {
+      case cIf: case cAbsIf: case cJump: case cEval: case cFCall: case cPCall:
+      case cArg: case cConj: case cImag: case cPolar: case cReal:
+        return false;
+      case cFetch:
+        ++IP; break;
+#ifdef FP_SUPPORT_OPTIMIZER
+      case cPopNMov:
+        IP += 2; break;
+#endif
+      default:
+        break;
+    }
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint BatchFunctionParser::stack_size() const
+{
+  return const_cast<BatchFunctionParser*>(this)->getParserData()->mStackSize;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool BatchFunctionParser::eval_batch(const Uint n, const Real* const* var_values, Real* result, Real* stack) const
+{
+  if(!is_batchable())
+    return false;
+
+  const Data& data = *const_cast<BatchFunctionParser*>(this)->getParserData();
+  const unsigned* const byte_code = &data.mByteCode[0];
+  const Real* const immed = data.mImmed.empty() ? 0 : &data.mImmed[0];
+  const Uint byte_code_size = data.mByteCode.size();
+  Uint DP = 0;
+  int SP = -1;
+
+  for(Uint IP = 0; IP != byte_code_size; ++IP)
+  {
+    // rows of the stack for the top level, the level below it and the next free level
+    Real* const top = SP < 0 ? stack : stack + SP*n;
+    Real* const below = SP < 1 ? stack : stack + (SP-1)*n;
+    Real* const next = stack + (SP+1)*n;
+
+    switch(byte_code[IP])
+    {
+// Functions:
+      case cAbs:   CF3_BATCH_UNARY(fp_abs(x))
+      case cAcos:  CF3_BATCH_CHECK(x < Real(-1) || x > Real(1)) CF3_BATCH_UNARY(fp_acos(x))
+      case cAcosh: CF3_BATCH_CHECK(x < Real(1))                 CF3_BATCH_UNARY(fp_acosh(x))
+      case cAsin:  CF3_BATCH_CHECK(x < Real(-1) || x > Real(1)) CF3_BATCH_UNARY(fp_asin(x))
+      case cAsinh: CF3_BATCH_UNARY(fp_asinh(x))
+      case cAtan:  CF3_BATCH_UNARY(fp_atan(x))
+      case cAtan2: CF3_BATCH_BINARY(fp_atan2(x, y))
+      case cAtanh: CF3_BATCH_CHECK(x <= Real(-1) || x >= Real(1)) CF3_BATCH_UNARY(fp_atanh(x))
+      case cCbrt:  CF3_BATCH_UNARY(fp_cbrt(x))
+      case cCeil:  CF3_BATCH_UNARY(fp_ceil(x))
+      case cCos:   CF3_BATCH_UNARY(fp_cos(x))
+      case cCosh:  CF3_BATCH_UNARY(fp_cosh(x))
+      case cCot:   CF3_BATCH_CHECK(fp_tan(x) == Real(0)) CF3_BATCH_UNARY(Real(1) / fp_tan(x))
+      case cCsc:   CF3_BATCH_CHECK(fp_sin(x) == Real(0)) CF3_BATCH_UNARY(Real(1) / fp_sin(x))
+      case cExp:   CF3_BATCH_UNARY(fp_exp(x))
+      case cExp2:  CF3_BATCH_UNARY(fp_exp2(x))
+      case cFloor: CF3_BATCH_UNARY(fp_floor(x))
+      case cHypot: CF3_BATCH_BINARY(fp_hypot(x, y))
+      case cInt:   CF3_BATCH_UNARY(fp_int(x))
+      case cLog:   CF3_BATCH_CHECK(!(x > Real(0))) CF3_BATCH_UNARY(fp_log(x))
+      case cLog10: CF3_BATCH_CHECK(!(x > Real(0))) CF3_BATCH_UNARY(fp_log10(x))
+      case cLog2:  CF3_BATCH_CHECK(!(x > Real(0))) CF3_BATCH_UNARY(fp_log2(x))
+      case cMax:   CF3_BATCH_BINARY(fp_max(x, y))
+      case cMin:   CF3_BATCH_BINARY(fp_min(x, y))
+      case cPow:   CF3_BATCH_CHECK2(x == Real(0) && y < Real(0)) CF3_BATCH_BINARY(fp_pow(x, y))
+      case cTrunc: CF3_BATCH_UNARY(fp_trunc(x))
+      case cSec:   CF3_BATCH_CHECK(fp_cos(x) == Real(0)) CF3_BATCH_UNARY(Real(1) / fp_cos(x))
+      case cSin:   CF3_BATCH_UNARY(fp_sin(x))
+      case cSinh:  CF3_BATCH_UNARY(fp_sinh(x))
+      case cSqrt:  CF3_BATCH_CHECK(x < Real(0)) CF3_BATCH_UNARY(fp_sqrt(x))
+      case cTan:   CF3_BATCH_UNARY(fp_tan(x))
+      case cTanh:  CF3_BATCH_UNARY(fp_tanh(x))
+
+// Misc:
+      case cImmed:
+      {
+        const Real value = immed[DP++];
+        for(Uint i = 0; i != n; ++i)
+          next[i] = value;
+        ++SP;
+        break;
+      }
+
+// Operators:
+      case cNeg:   CF3_BATCH_UNARY(-x)
+      case cAdd:   CF3_BATCH_BINARY(x + y)
+      case cSub:   CF3_BATCH_BINARY(x - y)
+      case cMul:   CF3_BATCH_BINARY(x * y)
+      case cDiv:   CF3_BATCH_CHECK(x == Real(0)) CF3_BATCH_BINARY(x / y)
+      case cMod:   CF3_BATCH_CHECK(x == Real(0)) CF3_BATCH_BINARY(fp_mod(x, y))
+
+      case cEqual:       CF3_BATCH_BINARY(Real(fp_equal(x, y)))
+      case cNEqual:      CF3_BATCH_BINARY(Real(fp_nequal(x, y)))
+      case cLess:        CF3_BATCH_BINARY(Real(fp_less(x, y)))
+      case cLessOrEq:    CF3_BATCH_BINARY(Real(fp_lessOrEq(x, y)))
+      case cGreater:     CF3_BATCH_BINARY(Real(fp_less(y, x)))
+      case cGreaterOrEq: CF3_BATCH_BINARY(Real(fp_lessOrEq(y, x)))
+
+      case cNot:    CF3_BATCH_UNARY(fp_not(x))
+      case cNotNot: CF3_BATCH_UNARY(fp_notNot(x))
+      case cAnd:    CF3_BATCH_BINARY(fp_and(x, y))
+      case cOr:     CF3_BATCH_BINARY(fp_or(x, y))
+
+// Degrees-radians conversion:
+      case cDeg: CF3_BATCH_UNARY(RadiansToDegrees(x))
+      case cRad: CF3_BATCH_UNARY(DegreesToRadians(x))
+
+      case cFetch:
+      {
+        const Real* const source = stack + byte_code[++IP]*n;
+        for(Uint i = 0; i != n; ++i)
+          next[i] = source[i];
+        ++SP;
+        break;
+      }
+
+#ifdef FP_SUPPORT_OPTIMIZER
+      case cPopNMov:
+      {
+        const unsigned target = byte_code[++IP];
+        const unsigned source = byte_code[++IP];
+        for(Uint i = 0; i != n; ++i)
+          stack[target*n + i] = stack[source*n + i];
+        SP = target;
+        break;
+      }
+
+      case cLog2by: CF3_BATCH_CHECK2(!(x > Real(0))) CF3_BATCH_BINARY(fp_log2(x) * y)
+
+      case cNop: break;
+#endif
+
+      case cSinCos:
+        for(Uint i = 0; i != n; ++i)
+        {
+          const Real x = top[i];
+          fp_sinCos(top[i], next[i], x);
+        }
+        ++SP;
+        break;
+
+      case cSinhCosh:
+        for(Uint i = 0; i != n; ++i)
+        {
+          const Real x = top[i];
+          fp_sinhCosh(top[i], next[i], x);
+        }
+        ++SP;
+        break;
+
+      case cAbsNot:    CF3_BATCH_UNARY(fp_absNot(x))
+      case cAbsNotNot: CF3_BATCH_UNARY(fp_absNotNot(x))
+      case cAbsAnd:    CF3_BATCH_BINARY(fp_absAnd(x, y))
+      case cAbsOr:     CF3_BATCH_BINARY(fp_absOr(x, y))
+
+      case cDup:
+        for(Uint i = 0; i != n; ++i)
+          next[i] = top[i];
+        ++SP;
+        break;
+
+      case cInv:   CF3_BATCH_CHECK(x == Real(0)) CF3_BATCH_UNARY(Real(1) / x)
+      case cSqr:   CF3_BATCH_UNARY(x * x)
+      case cRDiv:  CF3_BATCH_CHECK2(x == Real(0)) CF3_BATCH_BINARY(y / x)
+      case cRSub:  CF3_BATCH_BINARY(y - x)
+      case cRSqrt: CF3_BATCH_CHECK(x == Real(0)) CF3_BATCH_UNARY(Real(1) / fp_sqrt(x))
+
+// Variables:
+      default:
+      {
+        if(byte_code[IP] < VarBegin)
+          return false;
+        const Real* const source = var_values[byte_code[IP] - VarBegin];
+        for(Uint i = 0; i != n; ++i)
+          next[i] = source[i];
+        ++SP;
+        break;
+      }
+    }
+  }
+
+  const Real* const top = stack + SP*n;
+  for(Uint i = 0; i != n; ++i)
+    result[i] = top[i];
+  return true;
+}
+
+#undef CF3_BATCH_CHECK
+#undef CF3_BATCH_CHECK2
+#undef CF3_BATCH_UNARY
+#undef CF3_BATCH_BINARY
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Literal that converts back to exactly the same double
+std::string c_literal(const Real value)
+{
+  char buffer[32];
+  std::sprintf(buffer, "%.17g", value);
+  std::string result(buffer);
+  if(result.find_first_of(".en") == std::string::npos)
+    result += ".";
+  return result;
+}
+
+/// Name of stack level i
+std::string s(const int i)
+{
+  return "s[" + common::to_str(i) + "]";
+}
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
+std::string BatchFunctionParser::c_source(const std::string& name) const
+{
+  const Data& data = *const_cast<BatchFunctionParser*>(this)->getParserData();
+  if(data.mParseErrorType != FP_NO_ERROR)
+    return std::string();
+
+  const std::vector<unsigned>& byte_code = data.mByteCode;
+
+  // Stack depth at the jump targets, needed after unconditional jumps
+  std::map<Uint, int> label_sp;
+  std::ostringstream body;
+  Uint DP = 0;
+  int SP = -1;
+
+  for(Uint IP = 0; IP < byte_code.size(); ++IP)
+  {
+    if(label_sp.count(IP))
+    {
+      body << "L" << IP << ": ;\n";
+      SP = label_sp[IP];
+    }
+
+    // the top of the stack, the level below it and the next free level
+    const std::string x = s(SP-1);
+    const std::string y = s(SP);
+    const std::string t = s(SP);
+    const std::string next = s(SP+1);
+
+#define CF3_C_CHECK(cond) body << "  if(" << cond << ") goto failed;\n";
+#define CF3_C_UNARY(expr) { body << "  " << t << " = " << expr << ";\n"; break; }
+#define CF3_C_BINARY(expr) { body << "  " << x << " = " << expr << ";\n"; --SP; break; }
+
+    switch(byte_code[IP])
+    {
+// Functions:
+      case cAbs:   CF3_C_UNARY("fabs(" << t << ")")
+      case cAcos:  CF3_C_CHECK(t << " < -1. || " << t << " > 1.") CF3_C_UNARY("acos(" << t << ")")
+      case cAcosh: CF3_C_CHECK(t << " < 1.") CF3_C_UNARY("fp_acosh(" << t << ")")
+      case cAsin:  CF3_C_CHECK(t << " < -1. || " << t << " > 1.") CF3_C_UNARY("asin(" << t << ")")
+      case cAsinh: CF3_C_UNARY("fp_asinh(" << t << ")")
+      case cAtan:  CF3_C_UNARY("atan(" << t << ")")
+      case cAtan2: CF3_C_BINARY("atan2(" << x << ", " << y << ")")
+      case cAtanh: CF3_C_CHECK(t << " <= -1. || " << t << " >= 1.") CF3_C_UNARY("fp_atanh(" << t << ")")
+      case cCbrt:  CF3_C_UNARY("fp_cbrt(" << t << ")")
+      case cCeil:  CF3_C_UNARY("ceil(" << t << ")")
+      case cCos:   CF3_C_UNARY("cos(" << t << ")")
+      case cCosh:  CF3_C_UNARY("cosh(" << t << ")")
+      case cCot:   CF3_C_UNARY("tan(" << t << ")") // checked and inverted below
+      case cCsc:   CF3_C_UNARY("sin(" << t << ")")
+      case cExp:   CF3_C_UNARY("exp(" << t << ")")
+      case cExp2:  CF3_C_UNARY("fp_pow(2., " << t << ")")
+      case cFloor: CF3_C_UNARY("floor(" << t << ")")
+      case cHypot: CF3_C_BINARY("fp_hypot(" << x << ", " << y << ")")
+      case cIf:
+      case cAbsIf:
+      {
+        const Uint target = byte_code[IP+1] + 1;
+        if(byte_code[IP] == cIf)
+          body << "  if(!fp_truth(" << t << ")) goto L" << target << ";\n";
+        else
+          body << "  if(!(" << t << " >= 0.5)) goto L" << target << ";\n";
+        --SP;
+        label_sp[target] = SP;
+        IP += 2;
+        break;
+      }
+      case cInt:   CF3_C_UNARY("fp_int(" << t << ")")
+      case cLog:   CF3_C_CHECK("!(" << t << " > 0.)") CF3_C_UNARY("log(" << t << ")")
+      case cLog10: CF3_C_CHECK("!(" << t << " > 0.)") CF3_C_UNARY("log(" << t << ") * " << c_literal(fp_const_log10inv<Real>()))
+      case cLog2:  CF3_C_CHECK("!(" << t << " > 0.)") CF3_C_UNARY("fp_log2(" << t << ")")
+      case cMax:   CF3_C_BINARY("(" << x << " > " << y << " ? " << x << " : " << y << ")")
+      case cMin:   CF3_C_BINARY("(" << x << " < " << y << " ? " << x << " : " << y << ")")
+      case cPow:   CF3_C_CHECK(x << " == 0. && " << y << " < 0.") CF3_C_BINARY("fp_pow(" << x << ", " << y << ")")
+      case cTrunc: CF3_C_UNARY("(" << t << " < 0. ? ceil(" << t << ") : floor(" << t << "))")
+      case cSec:   CF3_C_UNARY("cos(" << t << ")")
+      case cSin:   CF3_C_UNARY("sin(" << t << ")")
+      case cSinh:  CF3_C_UNARY("sinh(" << t << ")")
+      case cSqrt:  CF3_C_CHECK(t << " < 0.") CF3_C_UNARY("sqrt(" << t << ")")
+      case cTan:   CF3_C_UNARY("tan(" << t << ")")
+      case cTanh:  CF3_C_UNARY("tanh(" << t << ")")
+
+// Misc:
+      case cImmed:
+      {
+        const Real value = data.mImmed[DP++];
+        if(!(boost::math::isfinite)(value))
+          return std::string();
+        body << "  " << next << " = " << c_literal(value) << ";\n";
+        ++SP;
+        break;
+      }
+      case cJump:
+      {
+        const Uint target = byte_code[IP+1] + 1;
+        body << "  goto L" << target << ";\n";
+        label_sp[target] = SP;
+        IP += 2;
+        break;
+      }
+
+// Operators:
+      case cNeg:   CF3_C_UNARY("-" << t)
+      case cAdd:   CF3_C_BINARY(x << " + " << y)
+      case cSub:   CF3_C_BINARY(x << " - " << y)
+      case cMul:   CF3_C_BINARY(x << " * " << y)
+      case cDiv:   CF3_C_CHECK(y << " == 0.") CF3_C_BINARY(x << " / " << y)
+      case cMod:   CF3_C_CHECK(y << " == 0.") CF3_C_BINARY("fmod(" << x << ", " << y << ")")
+
+      case cEqual:       CF3_C_BINARY("(double)(fabs(" << x << " - " << y << ") <= FP_EPSILON)")
+      case cNEqual:      CF3_C_BINARY("(double)(fabs(" << x << " - " << y << ") > FP_EPSILON)")
+      case cLess:        CF3_C_BINARY("(double)(" << x << " < " << y << " - FP_EPSILON)")
+      case cLessOrEq:    CF3_C_BINARY("(double)(" << x << " <= " << y << " + FP_EPSILON)")
+      case cGreater:     CF3_C_BINARY("(double)(" << y << " < " << x << " - FP_EPSILON)")
+      case cGreaterOrEq: CF3_C_BINARY("(double)(" << y << " <= " << x << " + FP_EPSILON)")
+
+      case cNot:    CF3_C_UNARY("(double)!fp_truth(" << t << ")")
+      case cNotNot: CF3_C_UNARY("(double)fp_truth(" << t << ")")
+      case cAnd:    CF3_C_BINARY("(double)(fp_truth(" << x << ") && fp_truth(" << y << "))")
+      case cOr:     CF3_C_BINARY("(double)(fp_truth(" << x << ") || fp_truth(" << y << "))")
+
+// Degrees-radians conversion:
+      case cDeg: CF3_C_UNARY(t << " * " << c_literal(fp_const_rad_to_deg<Real>()))
+      case cRad: CF3_C_UNARY(t << " * " << c_literal(fp_const_deg_to_rad<Real>()))
+
+      case cFetch:
+        body << "  " << next << " = " << s(byte_code[++IP]) << ";\n";
+        ++SP;
+        break;
+
+#ifdef FP_SUPPORT_OPTIMIZER
+      case cPopNMov:
+      {
+        const int target = byte_code[++IP];
+        const int source = byte_code[++IP];
+        body << "  " << s(target) << " = " << s(source) << ";\n";
+        SP = target;
+        break;
+      }
+
+      case cLog2by: CF3_C_CHECK("!(" << x << " > 0.)") CF3_C_BINARY("fp_log2(" << x << ") * " << y)
+
+      case cNop: break;
+#endif
+
+      case cSinCos:
+        body << "  " << next << " = cos(" << t << ");\n";
+        body << "  " << t << " = sin(" << t << ");\n";
+        ++SP;
+        break;
+
+      case cSinhCosh:
+        body << "  " << next << " = fp_cosh(" << t << ");\n";
+        body << "  " << t << " = fp_sinh(" << t << ");\n";
+        ++SP;
+        break;
+
+      case cAbsNot:    CF3_C_UNARY("(double)!(" << t << " >= 0.5)")
+      case cAbsNotNot: CF3_C_UNARY("(double)(" << t << " >= 0.5)")
+      case cAbsAnd:    CF3_C_BINARY("(double)(" << x << " >= 0.5 && " << y << " >= 0.5)")
+      case cAbsOr:     CF3_C_BINARY("(double)(" << x << " >= 0.5 || " << y << " >= 0.5)")
+
+      case cDup:
+        body << "  " << next << " = " << t << ";\n";
+        ++SP;
+        break;
+
+      case cInv:   CF3_C_CHECK(t << " == 0.") CF3_C_UNARY("1. / " << t)
+      case cSqr:   CF3_C_UNARY(t << " * " << t)
+      case cRDiv:  CF3_C_CHECK(x << " == 0.") CF3_C_BINARY(y << " / " << x)
+      case cRSub:  CF3_C_BINARY(y << " - " << x)
+      case cRSqrt: CF3_C_CHECK(t << " == 0.") CF3_C_UNARY("1. / sqrt(" << t << ")")
+
+// Variables:
+      default:
+        if(byte_code[IP] < VarBegin)
+          return std::string();
+        body << "  " << next << " = vars[" << byte_code[IP] - VarBegin << "];\n";
+        ++SP;
+        break;
+    }
+
+#undef CF3_C_CHECK
+#undef CF3_C_UNARY
+#undef CF3_C_BINARY
+
+    // cot, csc and sec are the inverse of tan, sin and cos
+    const unsigned op = byte_code[IP];
+    if(op == cCot || op == cCsc || op == cSec)
+    {
+      body << "  if(" << t << " == 0.) goto failed;\n";
+      body << "  " << t << " = 1. / " << t << ";\n";
+    }
+  }
+  if(label_sp.count(byte_code.size()))
+    body << "L" << byte_code.size() << ": ;\n";
+
+  const Uint nb_vars = data.mVariablesAmount;
+  std::ostringstream source;
+  source << "/* Generated by coolfluid from the bytecode of fparser */\n"
+         << "#include <math.h>\n\n"
+         << "#define FP_EPSILON " << c_literal(fp_epsilon<Real>()) << "\n\n"
+         << "static int fp_truth(const double x) { return fabs(x) >= 0.5; }\n"
+         << "static double fp_int(const double x) { return x < 0. ? ceil(x - 0.5) : floor(x + 0.5); }\n"
+         << "static double fp_powi(double x, unsigned long y)\n"
+         << "{\n"
+         << "  double result = 1.;\n"
+         << "  while(y != 0) { if(y & 1) { result *= x; y -= 1; } else { x *= x; y /= 2; } }\n"
+         << "  return result;\n"
+         << "}\n"
+         << "static int fp_is_integer(const double x) { return fabs(x - floor(x)) <= FP_EPSILON; }\n"
+         << "static double fp_pow(const double x, const double y)\n"
+         << "{\n"
+         << "  const long n = (long)fp_int(y);\n"
+         << "  if(x == 1.) return 1.;\n"
+         << "  if(y == (double)n) return n >= 0 ? fp_powi(x, n) : 1. / fp_powi(x, -n);\n"
+         << "  if(y >= 0.)\n"
+         << "  {\n"
+         << "    if(x > 0.) return exp(log(x) * y);\n"
+         << "    if(x == 0.) return 0.;\n"
+         << "    if(!fp_is_integer(y*16.)) return -exp(log(-x) * y);\n"
+         << "  }\n"
+         << "  else\n"
+         << "  {\n"
+         << "    if(x > 0.) return exp(log(1. / x) * -y);\n"
+         << "    if(x < 0. && !fp_is_integer(y*-16.)) return -exp(log(-1. / x) * -y);\n"
+         << "  }\n"
+         << "  return pow(x, y);\n"
+         << "}\n"
+#ifdef FP_SUPPORT_CBRT
+         << "static double fp_cbrt(const double x) { return cbrt(x); }\n"
+#else
+         << "static double fp_cbrt(const double x) { return x > 0. ? exp(log(x) / 3.) : x < 0. ? -exp(log(-x) / 3.) : 0.; }\n"
+#endif
+#ifdef FP_SUPPORT_ASINH
+         << "static double fp_asinh(const double x) { return asinh(x); }\n"
+         << "static double fp_acosh(const double x) { return acosh(x); }\n"
+         << "static double fp_atanh(const double x) { return atanh(x); }\n"
+#else
+         << "static double fp_asinh(const double x) { return log(x + sqrt(x*x + 1.)); }\n"
+         << "static double fp_acosh(const double x) { return log(x + sqrt(x*x - 1.)); }\n"
+         << "static double fp_atanh(const double x) { return log((1. + x) / (1. - x)) * 0.5; }\n"
+#endif
+#ifdef FP_SUPPORT_HYPOT
+         << "static double fp_hypot(const double x, const double y) { return hypot(x, y); }\n"
+#else
+         << "static double fp_hypot(const double x, const double y) { return sqrt(x*x + y*y); }\n"
+#endif
+#ifdef FP_SUPPORT_LOG2
+         << "static double fp_log2(const double x) { return log2(x); }\n"
+#else
+         << "static double fp_log2(const double x) { return log(x) * " << c_literal(fp_const_log2inv<Real>()) << "; }\n"
+#endif
+         << "static double fp_sinh(const double x) { return 0.5 * (exp(x) - exp(-x)); }\n"
+         << "static double fp_cosh(const double x) { return 0.5 * (exp(x) + exp(-x)); }\n\n"
+         << "double " << name << "(const double* vars)\n"
+         << "{\n"
+         << "  double s[" << std::max(data.mStackSize, 1u) << "];\n"
+         << body.str()
+         << "  return s[" << SP << "];\n"
+         << "failed:\n"
+         << "  return 0.;\n"
+         << "}\n\n"
+         << "void " << name << "_batch(const unsigned nb_points, const double* const* vars, double* result)\n"
+         << "{\n"
+         << "  double point[" << std::max(nb_vars, 1u) << "];\n"
+         << "  unsigned i, v;\n"
+         << "  for(i = 0; i < nb_points; ++i)\n"
+         << "  {\n"
+         << "    for(v = 0; v < " << nb_vars << "; ++v)\n"
+         << "      point[v] = vars[v][i];\n"
+         << "    result[i] = " << name << "(point);\n"
+         << "  }\n"
+         << "}\n";
+  return source.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,86 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_BatchFunctionParser_hpp
+#define cf3_Math_BatchFunctionParser_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+#include "fparser/fparser.hh"
+
+#include "math/LibMath.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Function parser that can also evaluate its bytecode for many points at once.
+///
+/// FunctionParser::Eval interprets the whole bytecode for every point. eval_batch runs each instruction
+/// once for a batch of points instead, on a stack that holds one row of values per stack level, so the
+/// dispatch costs are shared by the batch and the inner loops over the points can be vectorized.
+/// Bytecode with conditional jumps (if) or calls to other functions can't be run in lock step, and is
+/// left to Eval.
+///
+/// c_source translates the bytecode to C, which FunctionCompiler compiles to native code.
+class Math_API BatchFunctionParser : public FunctionParser
+{
+public:
+
+  BatchFunctionParser();
+
+  /// Parse the function like FunctionParser::Parse, and check once if the bytecode can be evaluated by eval_batch
+  int Parse(const std::string& function, const std::string& vars, bool use_degrees = false);
+
+  /// True if the parsed bytecode can be evaluated by eval_batch, as checked by Parse
+  bool is_batchable() const { return m_batchable; }
+
+  /// Number of stack levels used by the bytecode
+  Uint stack_size() const;
+
+  /// Evaluate the function for nb_points points.
+  /// @param nb_points number of points in the batch
+  /// @param var_values one array of nb_points values for each variable
+  /// @param result array of nb_points values receiving the result
+  /// @param stack work space of stack_size()*nb_points values
+  /// @return false if the bytecode isn't batchable, or if the evaluation failed for at least one point
+  ///         (e.g. a division by zero or the square root of a negative number). The result is then
+  ///         undefined, and Eval gives the result of FunctionParser for each point.
+  bool eval_batch(const Uint nb_points, const Real* const* var_values, Real* result, Real* stack) const;
+
+  /// Translate the bytecode to a C source file defining two functions:
+  /// @code
+  /// double name(const double* vars);
+  /// void name_batch(unsigned nb_points, const double* const* vars, double* result);
+  /// @endcode
+  /// The first gives the same result as Eval, including 0 when an evaluation check fails, the second
+  /// evaluates a batch of points like eval_batch, but can't fail.
+  /// @return the source, or an empty string if the bytecode calls other functions
+  std::string c_source(const std::string& name) const;
+
+private:
+
+  /// Scan the bytecode for the instructions that eval_batch can't run
+  bool scan_batchable() const;
+
+  /// Result of scan_batchable for the current bytecode
+  bool m_batchable;
+
+}; // BatchFunctionParser
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_Math_BatchFunctionParser_hpp
@@ -0,0 +1,215 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/BoostFilesystem.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/LibLoader.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/OSystem.hpp"
+#include "common/OSystemLayer.hpp"
+#include "common/StringConversion.hpp"
+
+#include "math/BatchFunctionParser.hpp"
+#include "math/FunctionCompiler.hpp"
+
+#ifndef CF3_OS_WINDOWS
+  #include <cerrno>
+  #include <sys/stat.h>
+  #include <sys/types.h>
+  #include <unistd.h>
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /// 64 bit FNV-1a hash of a string, in hexadecimal
+  std::string hash(const std::string& value)
+  {
+    boost::uint64_t result = 14695981039346656037ULL;
+    for(std::size_t i = 0; i != value.size(); ++i)
+    {
+      result ^= static_cast<unsigned char>(value[i]);
+      result *= 1099511628211ULL;
+    }
+    std::stringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << result;
+    return stream.str();
+  }
+
+  /// Converts the address returned by the library loader to a function pointer
+  template<typename FunctionT>
+  FunctionT function_cast(void* address)
+  {
+    union { void* address; FunctionT function; } result;
+    result.address = address;
+    return result.function;
+  }
+
+  /// Functions compiled or loaded by this process, by symbol name
+  std::map<std::string, FunctionCompiler::Compiled> compiled_functions;
+
+  /// Serializes the compilations, and protects compiled_functions
+  boost::mutex compile_mutex;
+
+  /// Only the first failure is reported, the others have the same cause most of the time
+  bool failure_reported = false;
+
+  /// Default cache directory, one per user so nobody else can put libraries in it
+  boost::filesystem::path default_cache_dir()
+  {
+#ifdef CF3_OS_WINDOWS
+    return boost::filesystem::temp_directory_path() / "coolfluid-functions";
+#else
+    return boost::filesystem::temp_directory_path() / ("coolfluid-functions-" + to_str(static_cast<Uint>(getuid())));
+#endif
+  }
+
+  /// Throws unless path is owned by the current user and not writable by the group or others.
+  /// Libraries must also be regular files, not links to somewhere else
+  void check_private(const boost::filesystem::path& path, const bool is_library)
+  {
+#ifndef CF3_OS_WINDOWS
+    struct stat status;
+    if((is_library ? lstat(path.string().c_str(), &status) : stat(path.string().c_str(), &status)) != 0)
+      throw FileSystemError(FromHere(), "Could not get the status of " + path.string());
+    if(is_library && !S_ISREG(status.st_mode))
+      throw FileSystemError(FromHere(), path.string() + " is not a regular file");
+    if(status.st_uid != getuid())
+      throw FileSystemError(FromHere(), path.string() + " is not owned by the current user");
+    if(status.st_mode & (S_IWGRP | S_IWOTH))
+      throw FileSystemError(FromHere(), path.string() + " is writable by other users");
+#endif
+  }
+
+  /// Create the cache directory if needed, accessible by the current user only
+  void create_cache_dir(const boost::filesystem::path& dir)
+  {
+    if(boost::filesystem::exists(dir))
+      return;
+    if(dir.has_parent_path() && !boost::filesystem::exists(dir.parent_path()))
+      boost::filesystem::create_directories(dir.parent_path());
+#ifdef CF3_OS_WINDOWS
+    boost::filesystem::create_directory(dir);
+#else
+    if(mkdir(dir.string().c_str(), 0700) != 0 && errno != EEXIST)
+      throw FileSystemError(FromHere(), "Could not create " + dir.string());
+#endif
+  }
+
+  /// Compile source into the shared object library, going through temporary files so concurrent
+  /// processes never load a partial library
+  void compile_library(const std::string& source, const boost::filesystem::path& library)
+  {
+    const std::string compiler = Core::instance().environment().options().value<std::string>("function_compiler");
+    const std::string suffix = "." + to_str(OSystem::instance().layer()->process_id());
+    const boost::filesystem::path source_file = library.parent_path() / (library.stem().string() + suffix + ".c");
+    const boost::filesystem::path library_file = library.parent_path() / (library.stem().string() + suffix + library.extension().string());
+    const boost::filesystem::path log_file = library.parent_path() / (library.stem().string() + suffix + ".log");
+
+    {
+      boost::filesystem::ofstream file(source_file);
+      if(!file)
+        throw FileSystemError(FromHere(), "Could not write " + source_file.string());
+      file << source;
+    }
+
+    const std::string command = compiler + " \"" + source_file.string() + "\" -o \"" + library_file.string() + "\" -lm > \"" + log_file.string() + "\" 2>&1";
+    const int status = std::system(command.c_str());
+    boost::filesystem::remove(source_file);
+    if(status != 0 || !boost::filesystem::exists(library_file))
+    {
+      boost::filesystem::remove(library_file);
+      throw FileSystemError(FromHere(), "Command \"" + command + "\" failed, see " + log_file.string());
+    }
+    boost::filesystem::remove(log_file);
+    boost::filesystem::rename(library_file, library);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool FunctionCompiler::enabled()
+{
+  return Core::instance().environment().options().value<bool>("compile_functions");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+FunctionCompiler::Compiled FunctionCompiler::compile(const BatchFunctionParser& parser)
+{
+  // The name of the generated functions doesn't change the hash
+  const std::string reference_source = parser.c_source("f");
+  if(reference_source.empty())
+    return Compiled();
+
+  const std::string compiler = Core::instance().environment().options().value<std::string>("function_compiler");
+  const std::string name = "cf3_function_" + hash(compiler + "\n" + reference_source);
+
+  boost::mutex::scoped_lock lock(compile_mutex);
+
+  std::map<std::string, Compiled>::const_iterator found = compiled_functions.find(name);
+  if(found != compiled_functions.end())
+    return found->second;
+
+  Compiled result;
+  try
+  {
+    std::string cache_dir = Core::instance().environment().options().value<std::string>("function_cache_dir");
+    const boost::filesystem::path dir = cache_dir.empty() ? default_cache_dir() : boost::filesystem::path(cache_dir);
+    create_cache_dir(dir);
+    // Loading a library runs its code, so it may only come from a place nobody else can write to
+    check_private(dir, false);
+
+    const boost::filesystem::path library = dir / (name + ".so");
+    if(!boost::filesystem::exists(library))
+      compile_library(parser.c_source(name), library);
+    check_private(library, true);
+
+    const boost::shared_ptr<LibLoader> loader = OSystem::instance().lib_loader();
+    result.function = function_cast<FunctionT>(loader->system_load_symbol(library.string(), name));
+    result.batch = function_cast<BatchFunctionT>(loader->system_load_symbol(library.string(), name + "_batch"));
+  }
+  catch(std::exception& e)
+  {
+    if(!failure_reported)
+    {
+      CFwarn << "Parsed functions are interpreted, compiling them failed: " << e.what() << CFendl;
+      failure_reported = true;
+    }
+    result = Compiled();
+  }
+
+  compiled_functions[name] = result;
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,71 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_FunctionCompiler_hpp
+#define cf3_Math_FunctionCompiler_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "math/LibMath.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+
+class BatchFunctionParser;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Compiles parsed functions to native code.
+///
+/// The bytecode of the parser is translated to C (see BatchFunctionParser::c_source) and compiled into a
+/// shared object with the command given by the function_compiler option of the environment. The shared
+/// object is named after a hash of the source and the command, and kept in the function_cache_dir of the
+/// environment, so later runs with the same function load it without compiling. It is loaded through
+/// the LibLoader of the operating system, but only if both the library and the cache directory belong to
+/// the current user and nobody else can write to them.
+/// If anything fails (no compiler, a read-only or shared cache directory, a function calling other functions...)
+/// the function is not compiled and the caller keeps interpreting it.
+class Math_API FunctionCompiler
+{
+public:
+
+  /// Compiled function, with the same result as FunctionParser::Eval
+  typedef double (*FunctionT)(const double* vars);
+
+  /// Compiled function for a batch of points, with the variables stored per component
+  typedef void (*BatchFunctionT)(const unsigned nb_points, const double* const* vars, double* result);
+
+  /// Entry points of a compiled function
+  struct Compiled
+  {
+    Compiled() : function(0), batch(0) {}
+
+    /// True if the function was compiled
+    bool is_compiled() const { return function != 0; }
+
+    FunctionT function;
+    BatchFunctionT batch;
+  };
+
+  /// True if the compile_functions option of the environment is set
+  static bool enabled();
+
+  /// Compile the function held by parser, or load it from the cache
+  /// @return the entry points, null if compiling failed
+  static Compiled compile(const BatchFunctionParser& parser);
+
+}; // FunctionCompiler
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // math
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_Math_FunctionCompiler_hpp
@@ -28,6 +28,13 @@ namespace LSS {
 class LSS_API BlockAccumulator {
 public:
 
+  BlockAccumulator() :
+    element_group(0),
+    element_group_size(0),
+    element_idx(0)
+  {
+  }
+
   /// setting up sizes
   void resize(Uint numnodes, Uint numeqs)
   {
@@ -54,6 +61,16 @@ public:
       indices[i]=idx_vector[i];
   };
 
+  /// identify the element the values belong to, allowing matrices to cache where its entries are stored.
+  /// group is any address that is unique for a set of group_size elements with a fixed connectivity, such as their connectivity table
+  void set_element(const void* group, const Uint group_size, const Uint idx)
+  {
+    cf3_assert(idx < group_size);
+    element_group=group;
+    element_group_size=group_size;
+    element_idx=idx;
+  }
+
   /// how many rows/columns
   Uint size() const { return sol.size(); };
 
@@ -73,6 +90,15 @@ public:
   /// local numbering of the unknowns
   std::vector<Uint> indices;
 
+  /// set of elements the current element belongs to, null if the values are not associated with an element
+  const void* element_group;
+
+  /// number of elements in element_group
+  Uint element_group_size;
+
+  /// index of the current element in element_group
+  Uint element_idx;
+
   // rest of the operations should directly be the stuff off eigen
 
 };
@@ -29,6 +29,7 @@ EmptyLSSMatrix::EmptyLSSMatrix ( const std::string& name ) :
   m_is_created(false)
 {
   properties().add("vector_type", std::string("cf3.math.LSS.EmptyLSSVector"));
+  properties().add("solution_strategy", std::string("cf3.math.LSS.EmptyStrategy"));
 }
 
 
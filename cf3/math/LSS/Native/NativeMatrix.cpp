@@ -0,0 +1,785 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <fstream>
+
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+
+#include "common/Assertions.hpp"
+#include "common/Builder.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Tags.hpp"
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+#include "math/LSS/Native/NativeMatrix.hpp"
+#include "math/LSS/Native/NativeVector.hpp"
+#include "math/LSS/Native/ThreadTeam.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /// Minimal number of block rows per thread in the matrix-vector product, below this the threads cost more than they gain
+  const Uint min_rows_per_thread = 512;
+
+  /// Counter to give each exchange buffer a unique name in the commpattern
+  Uint exchange_buffer_counter = 0;
+
+  /// Add the contribution of node j to the equations of node i from the element matrix to the neq x neq block
+  inline void add_block(const BlockAccumulator& values, const Uint i, const Uint j, const Uint neq, Real* block)
+  {
+    const Uint num_entries=values.indices.size()*neq;
+    for (Uint r=0; r!=neq; ++r)
+    {
+      const Real* ba_row=values.mat.data()+(i*neq+r)*num_entries+j*neq;
+      for (Uint c=0; c!=neq; ++c)
+        block[r*neq+c]+=ba_row[c];
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < LSS::NativeMatrix, LSS::Matrix, LSS::LibLSS > NativeMatrix_Builder;
+
+const Uint NativeMatrix::no_block;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+NativeMatrix::NativeMatrix(const std::string& name) :
+  LSS::Matrix(name),
+  m_is_created(false),
+  m_neq(0),
+  m_nb_nodes(0),
+  m_use_scatter_cache(false)
+{
+  properties().add("vector_type", std::string("cf3.math.LSS.NativeVector"));
+  properties().add("solution_strategy", std::string("cf3.math.LSS.NativeStrategy"));
+
+  options().add("scatter_cache", m_use_scatter_cache)
+    .pretty_name("Scatter Cache")
+    .description("Remember where the entries of each element go in the matrix, speeding up repeated assembly at the cost of memory")
+    .attach_trigger(boost::bind(&NativeMatrix::trigger_scatter_cache, this));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+NativeMatrix::~NativeMatrix()
+{
+  // the exchange buffer must not stay registered in the commpattern
+  destroy();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+const bool NativeMatrix::is_swappable(const LSS::Vector& solution, const LSS::Vector& rhs)
+{
+  return dynamic_cast<const NativeVector*>(&solution) != 0 && dynamic_cast<const NativeVector*>(&rhs) != 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs)
+{
+  boost::shared_ptr<VariablesDescriptor> single_var_descriptor = common::allocate_component<VariablesDescriptor>("SingleVariableDescriptor");
+  single_var_descriptor->options().set(common::Tags::dimension(), neq);
+  single_var_descriptor->push_back("LSSvars", VariablesDescriptor::Dimensionalities::VECTOR);
+  create_blocked(cp, *single_var_descriptor, node_connectivity, starting_indices, solution, rhs);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::create_blocked(cf3::common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs)
+{
+  // if already created
+  if (m_is_created) destroy();
+
+  m_neq=vars.size();
+  m_nb_nodes=cp.isUpdatable().size();
+  cf3_assert(starting_indices.size()>m_nb_nodes);
+  const Uint block_size=m_neq*m_neq;
+
+  // Copy node connectivity
+  m_node_connectivity.assign(node_connectivity.begin(), node_connectivity.end());
+  m_starting_indices.assign(starting_indices.begin(), starting_indices.end());
+
+  // block structure, only the owned rows are stored
+  m_is_owned.assign(cp.isUpdatable().begin(), cp.isUpdatable().end());
+  m_row_starts.assign(m_nb_nodes+1, 0);
+  m_diagonal.assign(m_nb_nodes, no_block);
+  m_columns.clear();
+  m_columns.reserve(node_connectivity.size());
+  for (Uint i=0; i!=m_nb_nodes; ++i)
+  {
+    if (m_is_owned[i])
+    {
+      m_owned_rows.push_back(i);
+      m_columns.insert(m_columns.end(), node_connectivity.begin()+starting_indices[i], node_connectivity.begin()+starting_indices[i+1]);
+      const std::vector<Uint>::iterator row_begin=m_columns.begin()+m_row_starts[i];
+      std::sort(row_begin, m_columns.end());
+      m_columns.erase(std::unique(row_begin, m_columns.end()), m_columns.end());
+
+      bool couples_to_ghost=false;
+      for (Uint b=m_row_starts[i]; b!=m_columns.size(); ++b)
+      {
+        if (m_columns[b]==i)
+          m_diagonal[i]=b;
+        if (!m_is_owned[m_columns[b]])
+          couples_to_ghost=true;
+      }
+      if (couples_to_ghost)
+        m_boundary_rows.push_back(i);
+      else
+        m_interior_rows.push_back(i);
+    }
+    m_row_starts[i+1]=m_columns.size();
+  }
+  m_values.assign(m_columns.size()*block_size, 0.);
+
+  // the multiplied vectors are copied in the exchange buffer to update their ghosts
+  m_commpattern=cp.handle<common::PE::CommPattern>();
+  m_exchange.assign(m_nb_nodes*m_neq, 0.);
+  if (is_distributed())
+  {
+    m_exchange_name="NativeMatrix_exchange_"+common::to_str(exchange_buffer_counter++);
+    cp.insert(m_exchange_name, m_exchange, m_neq, true);
+  }
+
+  const Uint requested_threads=common::Core::instance().environment().options().value<Uint>("nb_threads");
+  const Uint nb_threads=std::max(1u, std::min(requested_threads, static_cast<Uint>(m_owned_rows.size()/min_rows_per_thread)));
+  if (nb_threads>1)
+    m_threads.reset(new ThreadTeam(nb_threads));
+
+  m_is_created=true;
+  CFdebug << "Rank " << common::PE::Comm::instance().rank() << ": Created a native block matrix with " << m_owned_rows.size() << " local block rows, "
+          << m_columns.size() << " blocks of size " << m_neq << "x" << m_neq << " and " << this->nb_threads() << " threads" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::destroy()
+{
+  if (is_not_null(m_commpattern) && !m_exchange_name.empty())
+    m_commpattern->clear(m_exchange_name);
+  m_commpattern.reset();
+  m_exchange_name.clear();
+  m_threads.reset();
+  m_scatter_cache.clear();
+
+  std::vector<bool>().swap(m_is_owned);
+  std::vector<Uint>().swap(m_owned_rows);
+  std::vector<Uint>().swap(m_interior_rows);
+  std::vector<Uint>().swap(m_boundary_rows);
+  std::vector<Uint>().swap(m_row_starts);
+  std::vector<Uint>().swap(m_columns);
+  std::vector<Real>().swap(m_values);
+  std::vector<Uint>().swap(m_diagonal);
+  std::vector<Uint>().swap(m_node_connectivity);
+  std::vector<Uint>().swap(m_starting_indices);
+  std::vector<Real>().swap(m_exchange);
+  m_neq=0;
+  m_nb_nodes=0;
+  m_is_created=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint NativeMatrix::find_block(const Uint iblockrow, const Uint iblockcol) const
+{
+  cf3_assert(iblockrow<m_nb_nodes);
+  const std::vector<Uint>::const_iterator row_begin=m_columns.begin()+m_row_starts[iblockrow];
+  const std::vector<Uint>::const_iterator row_end=m_columns.begin()+m_row_starts[iblockrow+1];
+  const std::vector<Uint>::const_iterator it=std::lower_bound(row_begin, row_end, iblockcol);
+  if (it==row_end || *it!=iblockcol)
+    return no_block;
+  return it-m_columns.begin();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Real* NativeMatrix::entry(const Uint icol, const Uint irow)
+{
+  const Uint b=find_block(irow/m_neq, icol/m_neq);
+  if (b==no_block)
+    return nullptr;
+  return &m_values[b*m_neq*m_neq + (irow%m_neq)*m_neq + icol%m_neq];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::set_value(const Uint icol, const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  Real* v=entry(icol,irow);
+  if (is_null(v))
+    throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  *v=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::add_value(const Uint icol, const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  Real* v=entry(icol,irow);
+  if (is_null(v))
+    throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  *v+=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::get_value(const Uint icol, const Uint irow, Real& value)
+{
+  cf3_assert(m_is_created);
+  Real* v=entry(icol,irow);
+  if (is_null(v))
+    throw common::BadValue(FromHere(),"Trying to access an illegal entry.");
+  value=*v;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::set_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes=values.indices.size();
+  const Uint num_entries=nb_nodes*m_neq;
+  cf3_assert(values.mat.rows()==num_entries);
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    const Uint row=values.indices[i];
+    if (!m_is_owned[row])
+      continue;
+    for (Uint j=0; j!=nb_nodes; ++j)
+    {
+      const Uint b=find_block(row,values.indices[j]);
+      if (b==no_block)
+        throw common::BadValue(FromHere(),"Block (" + common::to_str(row) + "," + common::to_str(values.indices[j]) + ") is not in the sparsity pattern.");
+      Real* block=&m_values[b*m_neq*m_neq];
+      for (Uint r=0; r!=m_neq; ++r)
+      {
+        const Real* ba_row=values.mat.data()+(i*m_neq+r)*num_entries+j*m_neq;
+        for (Uint c=0; c!=m_neq; ++c)
+          block[r*m_neq+c]=ba_row[c];
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::add_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes=values.indices.size();
+  cf3_assert(values.mat.rows()==nb_nodes*m_neq);
+  const Uint block_size=m_neq*m_neq;
+
+  if (m_use_scatter_cache && values.element_group!=0)
+  {
+    const int* blocks=m_scatter_cache.find(values);
+    if (is_null(blocks))
+      blocks=cache_blocks(values);
+    for (Uint i=0; i!=nb_nodes; ++i)
+    {
+      if (blocks[i*nb_nodes]<0)
+        continue;
+      for (Uint j=0; j!=nb_nodes; ++j)
+        add_block(values, i, j, m_neq, &m_values[blocks[i*nb_nodes+j]*block_size]);
+    }
+    return;
+  }
+
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    const Uint row=values.indices[i];
+    if (!m_is_owned[row])
+      continue;
+    for (Uint j=0; j!=nb_nodes; ++j)
+    {
+      const Uint b=find_block(row,values.indices[j]);
+      if (b==no_block)
+        throw common::BadValue(FromHere(),"Block (" + common::to_str(row) + "," + common::to_str(values.indices[j]) + ") is not in the sparsity pattern.");
+      add_block(values, i, j, m_neq, &m_values[b*block_size]);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+const int* NativeMatrix::cache_blocks(const BlockAccumulator& values)
+{
+  const Uint nb_nodes=values.indices.size();
+  int* blocks=m_scatter_cache.insert(values, nb_nodes*nb_nodes);
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    const Uint row=values.indices[i];
+    for (Uint j=0; j!=nb_nodes; ++j)
+    {
+      if (!m_is_owned[row])
+      {
+        blocks[i*nb_nodes+j]=-1;
+        continue;
+      }
+      const Uint b=find_block(row,values.indices[j]);
+      if (b==no_block)
+      {
+        // the element was already marked as cached
+        m_scatter_cache.clear();
+        throw common::BadValue(FromHere(),"Block (" + common::to_str(row) + "," + common::to_str(values.indices[j]) + ") is not in the sparsity pattern.");
+      }
+      blocks[i*nb_nodes+j]=static_cast<int>(b);
+    }
+  }
+  return blocks;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::trigger_scatter_cache()
+{
+  m_use_scatter_cache=options().value<bool>("scatter_cache");
+  if (!m_use_scatter_cache)
+    m_scatter_cache.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::get_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  values.mat.setZero();
+  const Uint nb_nodes=values.indices.size();
+  const Uint num_entries=nb_nodes*m_neq;
+  cf3_assert(values.mat.rows()==num_entries);
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    const Uint row=values.indices[i];
+    if (!m_is_owned[row])
+      continue;
+    for (Uint j=0; j!=nb_nodes; ++j)
+    {
+      const Uint b=find_block(row,values.indices[j]);
+      if (b==no_block)
+        continue;
+      const Real* block=&m_values[b*m_neq*m_neq];
+      for (Uint r=0; r!=m_neq; ++r)
+      {
+        Real* ba_row=values.mat.data()+(i*m_neq+r)*num_entries+j*m_neq;
+        for (Uint c=0; c!=m_neq; ++c)
+          ba_row[c]=block[r*m_neq+c];
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval)
+{
+  cf3_assert(m_is_created);
+  if (!m_is_owned[iblockrow])
+    return;
+
+  for (Uint b=m_row_starts[iblockrow]; b!=m_row_starts[iblockrow+1]; ++b)
+  {
+    Real* block_row=&m_values[b*m_neq*m_neq+ieq*m_neq];
+    for (Uint c=0; c!=m_neq; ++c)
+      block_row[c]=offdiagval;
+    if (b==m_diagonal[iblockrow])
+      block_row[ieq]=diagval;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values)
+{
+  cf3_assert(m_is_created);
+  values.assign(m_nb_nodes*m_neq, 0.);
+  BOOST_FOREACH(const Uint row, m_owned_rows)
+  {
+    const Uint b=find_block(row,iblockcol);
+    if (b==no_block)
+      continue;
+    Real* block=&m_values[b*m_neq*m_neq];
+    for (Uint r=0; r!=m_neq; ++r)
+    {
+      values[row*m_neq+r]=block[r*m_neq+ieq];
+      block[r*m_neq+ieq]=0.;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, LSS::Vector& rhs)
+{
+  cf3_assert(m_is_created);
+  const Uint bc_col=blockrow*m_neq+ieq;
+
+  // the connectivity of the boundary node is used for its column, also if the node is a ghost
+  for (Uint col_idx=m_starting_indices[blockrow]; col_idx!=m_starting_indices[blockrow+1]; ++col_idx)
+  {
+    const Uint col=m_node_connectivity[col_idx];
+    if (!m_is_owned[col])
+      continue;
+    for (Uint j=0; j!=m_neq; ++j)
+    {
+      const Uint other_row=col*m_neq+j;
+      if (other_row!=bc_col)
+      {
+        Real* v=entry(bc_col,other_row);
+        cf3_assert(is_not_null(v));
+        rhs.add_value(col, j, -(*v) * value);
+        *v=0.;
+      }
+      else
+      {
+        set_row(blockrow, ieq, 1., 0.);
+      }
+    }
+  }
+
+  rhs.set_value(blockrow, ieq, value);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from)
+{
+  cf3_assert(m_is_created);
+  if (!m_is_owned[iblockrow_from] || !m_is_owned[iblockrow_to])
+    return;
+
+  const Uint from_begin=m_row_starts[iblockrow_from];
+  const Uint to_begin=m_row_starts[iblockrow_to];
+  const Uint nb_blocks=m_row_starts[iblockrow_from+1]-from_begin;
+  if (m_row_starts[iblockrow_to+1]-to_begin != nb_blocks)
+    throw common::BadValue(FromHere(),"Number of entries do not match for the two block rows to be tied together.");
+  if (!std::equal(m_columns.begin()+from_begin, m_columns.begin()+from_begin+nb_blocks, m_columns.begin()+to_begin))
+    throw common::BadValue(FromHere(),"Indices of the entries do not match for the two block rows to be tied together.");
+
+  // position within the rows of the blocks coupling to the from and to nodes
+  const Uint diag=find_block(iblockrow_from,iblockrow_from)-from_begin;
+  const Uint pair=find_block(iblockrow_from,iblockrow_to)-from_begin;
+  if (diag>=nb_blocks || pair>=nb_blocks)
+    throw common::BadValue(FromHere(),"The block rows to be tied together must couple to each other.");
+
+  const Uint block_size=m_neq*m_neq;
+  Real* from=&m_values[from_begin*block_size];
+  Real* to=&m_values[to_begin*block_size];
+  for (Uint i=0; i!=m_neq; ++i)
+  {
+    for (Uint b=0; b!=nb_blocks; ++b)
+    {
+      for (Uint k=0; k!=m_neq; ++k)
+      {
+        to[b*block_size+i*m_neq+k]+=from[b*block_size+i*m_neq+k];
+        from[b*block_size+i*m_neq+k]=0.;
+      }
+    }
+    from[diag*block_size+i*m_neq+i]=1.;
+    from[pair*block_size+i*m_neq+i]=-1.;
+    for (Uint k=0; k!=m_neq; ++k)
+    {
+      to[pair*block_size+i*m_neq+k]+=to[diag*block_size+i*m_neq+k];
+      to[diag*block_size+i*m_neq+k]=0.;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::set_diagonal(const std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(diag.size()==m_nb_nodes*m_neq);
+  BOOST_FOREACH(const Uint row, m_owned_rows)
+  {
+    if (m_diagonal[row]==no_block)
+      continue;
+    Real* block=&m_values[m_diagonal[row]*m_neq*m_neq];
+    for (Uint i=0; i!=m_neq; ++i)
+      block[i*m_neq+i]=diag[row*m_neq+i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::add_diagonal(const std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(diag.size()==m_nb_nodes*m_neq);
+  BOOST_FOREACH(const Uint row, m_owned_rows)
+  {
+    if (m_diagonal[row]==no_block)
+      continue;
+    Real* block=&m_values[m_diagonal[row]*m_neq*m_neq];
+    for (Uint i=0; i!=m_neq; ++i)
+      block[i*m_neq+i]+=diag[row*m_neq+i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::get_diagonal(std::vector<Real>& diag)
+{
+  cf3_assert(m_is_created);
+  diag.assign(m_nb_nodes*m_neq, 0.);
+  BOOST_FOREACH(const Uint row, m_owned_rows)
+  {
+    if (m_diagonal[row]==no_block)
+      continue;
+    const Real* block=&m_values[m_diagonal[row]*m_neq*m_neq];
+    for (Uint i=0; i!=m_neq; ++i)
+      diag[row*m_neq+i]=block[i*m_neq+i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::reset(Real reset_to)
+{
+  cf3_assert(m_is_created);
+  std::fill(m_values.begin(), m_values.end(), reset_to);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+bool NativeMatrix::is_distributed() const
+{
+  return common::PE::Comm::instance().is_active() && common::PE::Comm::instance().size()>1;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint NativeMatrix::nb_threads() const
+{
+  return m_threads ? m_threads->size() : 1u;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::multiply_rows(const std::vector<Uint>* rows, const Real* x, Real* y, const Uint thread_idx)
+{
+  const Uint nb_rows=rows->size();
+  const Uint begin=m_threads ? m_threads->chunk_begin(nb_rows,thread_idx) : 0;
+  const Uint end=m_threads ? m_threads->chunk_end(nb_rows,thread_idx) : nb_rows;
+  const Uint* row_starts=&m_row_starts[0];
+  const Uint* columns=m_columns.empty() ? 0 : &m_columns[0];
+  const Real* values=m_values.empty() ? 0 : &m_values[0];
+
+  if (m_neq==1)
+  {
+    for (Uint i=begin; i!=end; ++i)
+    {
+      const Uint row=(*rows)[i];
+      Real sum=0.;
+      for (Uint b=row_starts[row]; b!=row_starts[row+1]; ++b)
+        sum+=values[b]*x[columns[b]];
+      y[row]=sum;
+    }
+    return;
+  }
+
+  const Uint neq=m_neq;
+  const Uint block_size=neq*neq;
+  for (Uint i=begin; i!=end; ++i)
+  {
+    const Uint row=(*rows)[i];
+    Real* y_row=y+row*neq;
+    for (Uint r=0; r!=neq; ++r)
+      y_row[r]=0.;
+    for (Uint b=row_starts[row]; b!=row_starts[row+1]; ++b)
+    {
+      const Real* block=values+b*block_size;
+      const Real* x_col=x+columns[b]*neq;
+      for (Uint r=0; r!=neq; ++r)
+      {
+        Real sum=0.;
+        for (Uint c=0; c!=neq; ++c)
+          sum+=block[r*neq+c]*x_col[c];
+        y_row[r]+=sum;
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::multiply(const std::vector<Uint>& rows, const Real* x, Real* y)
+{
+  if (m_threads)
+    m_threads->run(boost::bind(&NativeMatrix::multiply_rows, this, &rows, x, y, _1));
+  else
+    multiply_rows(&rows, x, y, 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::apply(const Real* x, Real* y)
+{
+  cf3_assert(m_is_created);
+
+  for (Uint i=0; i!=m_nb_nodes; ++i)
+    if (!m_is_owned[i])
+      for (Uint j=0; j!=m_neq; ++j)
+        y[i*m_neq+j]=0.;
+
+  if (!is_distributed())
+  {
+    multiply(m_owned_rows, x, y);
+    return;
+  }
+
+  // the rows that only couple to owned nodes are computed while the ghosts are in transit
+  std::copy(x, x+m_exchange.size(), m_exchange.begin());
+  m_commpattern->start_synchronize(m_exchange_name);
+  multiply(m_interior_rows, &m_exchange[0], y);
+  m_commpattern->finish_synchronize(m_exchange_name);
+  multiply(m_boundary_rows, &m_exchange[0], y);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::update_ghosts(Real* x)
+{
+  cf3_assert(m_is_created);
+  if (!is_distributed())
+    return;
+
+  std::copy(x, x+m_exchange.size(), m_exchange.begin());
+  m_commpattern->synchronize(m_exchange_name);
+  std::copy(m_exchange.begin(), m_exchange.end(), x);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::print(common::LogStream& stream)
+{
+  if (m_is_created)
+  {
+    BOOST_FOREACH(const Uint row, m_owned_rows)
+      for (Uint r=0; r!=m_neq; ++r)
+        for (Uint b=m_row_starts[row]; b!=m_row_starts[row+1]; ++b)
+          for (Uint c=0; c!=m_neq; ++c)
+            stream << m_columns[b]*m_neq+c << " " << -(int)(row*m_neq+r) << " " << m_values[b*m_neq*m_neq+r*m_neq+c] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_owned_rows.size()*m_neq << "\n";
+    stream << "# number of cols:       " << m_nb_nodes*m_neq << "\n";
+    stream << "# number of block rows: " << m_owned_rows.size() << "\n";
+    stream << "# number of block cols: " << m_nb_nodes << "\n";
+    stream << "# number of entries:    " << m_values.size() << "\n";
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::print(std::ostream& stream)
+{
+  if (m_is_created)
+  {
+    BOOST_FOREACH(const Uint row, m_owned_rows)
+      for (Uint r=0; r!=m_neq; ++r)
+        for (Uint b=m_row_starts[row]; b!=m_row_starts[row+1]; ++b)
+          for (Uint c=0; c!=m_neq; ++c)
+            stream << m_columns[b]*m_neq+c << " " << -(int)(row*m_neq+r) << " " << m_values[b*m_neq*m_neq+r*m_neq+c] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_owned_rows.size()*m_neq << "\n";
+    stream << "# number of cols:       " << m_nb_nodes*m_neq << "\n";
+    stream << "# number of block rows: " << m_owned_rows.size() << "\n";
+    stream << "# number of block cols: " << m_nb_nodes << "\n";
+    stream << "# number of entries:    " << m_values.size() << "\n" << std::flush;
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::print(const std::string& filename, std::ios_base::openmode mode )
+{
+  std::ofstream stream(filename.c_str(),mode);
+  stream << "VARIABLES=COL,ROW,VAL\n" << std::flush;
+  stream << "ZONE T=\"" << type_name() << "::" << name() <<  "\"\n" << std::flush;
+  print(stream);
+  stream.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::print_native(std::ostream& stream)
+{
+  stream << type_name() << " " << name() << ": " << m_owned_rows.size() << " block rows, " << m_nb_nodes << " block columns, "
+         << m_columns.size() << " blocks of size " << m_neq << "x" << m_neq << "\n";
+  BOOST_FOREACH(const Uint row, m_owned_rows)
+  {
+    stream << row << ":";
+    for (Uint b=m_row_starts[row]; b!=m_row_starts[row+1]; ++b)
+    {
+      stream << " " << m_columns[b] << "[";
+      for (Uint i=0; i!=m_neq*m_neq; ++i)
+        stream << (i==0 ? "" : " ") << m_values[b*m_neq*m_neq+i];
+      stream << "]";
+    }
+    stream << "\n";
+  }
+  stream << std::flush;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeMatrix::debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values)
+{
+  row_indices.clear(); col_indices.clear(); values.clear();
+  const Uint nnz=m_values.size();
+  row_indices.reserve(nnz); col_indices.reserve(nnz); values.reserve(nnz);
+  BOOST_FOREACH(const Uint row, m_owned_rows)
+  {
+    for (Uint r=0; r!=m_neq; ++r)
+    {
+      for (Uint b=m_row_starts[row]; b!=m_row_starts[row+1]; ++b)
+      {
+        for (Uint c=0; c!=m_neq; ++c)
+        {
+          row_indices.push_back(row*m_neq+r);
+          col_indices.push_back(m_columns[b]*m_neq+c);
+          values.push_back(m_values[b*m_neq*m_neq+r*m_neq+c]);
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,295 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_NativeMatrix_hpp
+#define cf3_Math_LSS_NativeMatrix_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/scoped_ptr.hpp>
+
+#include "math/LSS/LibLSS.hpp"
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/Matrix.hpp"
+#include "math/LSS/ScatterCache.hpp"
+#include "math/LSS/Vector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file NativeMatrix.hpp LSS::Matrix of the built-in linear solver, independent of Trilinos
+
+  The matrix is stored in block compressed sparse row format, using the process local numbering of the nodes:
+  * one block row per node, ghost nodes have an empty block row
+  * the block columns of each block row are sorted
+  * each block is a dense neq x neq matrix stored row-major, so all equations of a node coupling to another node are contiguous in memory
+
+  Matrix-vector products are threaded over the block rows, using the nb_threads option of the environment.
+  The ghost values of the multiplied vector are synchronized through the commpattern, while the block rows that
+  do not couple to ghost nodes are computed.
+
+  When the scatter_cache option is set, add_values remembers the block index of each node pair of the elements
+  it receives, skipping the search in the block rows when the same element is assembled again.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class ThreadTeam;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API NativeMatrix : public LSS::Matrix {
+public:
+
+  /// @name CREATION, DESTRUCTION AND COMPONENT SYSTEM
+  //@{
+
+  /// name of the type
+  static std::string type_name () { return "NativeMatrix"; }
+
+  /// Accessor to solver type
+  const std::string solvertype() { return "Native"; }
+
+  /// Accessor to the flag if matrix, solution and rhs are tied together or not
+  const bool is_swappable(const LSS::Vector& solution, const LSS::Vector& rhs);
+
+  /// Default constructor
+  NativeMatrix(const std::string& name);
+
+  ~NativeMatrix();
+
+  /// Setup sparsity structure
+  void create(cf3::common::PE::CommPattern& cp, const Uint neq, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs);
+
+  /// The variables are not reordered, all equations of a node form one block
+  void create_blocked(cf3::common::PE::CommPattern& cp, const VariablesDescriptor& vars, const std::vector<Uint>& node_connectivity, const std::vector<Uint>& starting_indices, LSS::Vector& solution, LSS::Vector& rhs);
+
+  /// Deallocate underlying data
+  void destroy();
+
+  //@} END CREATION, DESTRUCTION AND COMPONENT SYSTEM
+
+  /// @name INDIVIDUAL ACCESS
+  //@{
+
+  /// Set value at given location in the matrix
+  void set_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Add value at given location in the matrix
+  void add_value(const Uint icol, const Uint irow, const Real value);
+
+  /// Get value at given location in the matrix
+  void get_value(const Uint icol, const Uint irow, Real& value);
+
+  //@} END INDIVIDUAL ACCESS
+
+  /// @name EFFICCIENT ACCESS
+  //@{
+
+  /// Set a list of values
+  void set_values(const BlockAccumulator& values);
+
+  /// Add a list of values.
+  /// Only the block rows of the nodes in values are modified, so calls on disjoint sets of nodes may run concurrently.
+  void add_values(const BlockAccumulator& values);
+
+  /// Get a list of values
+  void get_values(BlockAccumulator& values);
+
+  /// Set a row, diagonal and off-diagonals values separately (dirichlet-type boundaries)
+  void set_row(const Uint iblockrow, const Uint ieq, Real diagval, Real offdiagval);
+
+  /// Get a column and replace it to zero (dirichlet-type boundaries, when trying to preserve symmetry)
+  void get_column_and_replace_to_zero(const Uint iblockcol, Uint ieq, std::vector<Real>& values);
+
+  /// Apply a dirichlet boundary condition, preserving symmetry by moving entries to the RHS
+  void symmetric_dirichlet(const Uint blockrow, const Uint ieq, const Real value, LSS::Vector& rhs);
+
+  /// Add one line to another and tie to it via dirichlet-style (applying periodicity)
+  void tie_blockrow_pairs (const Uint iblockrow_to, const Uint iblockrow_from);
+
+  /// Set the diagonal
+  void set_diagonal(const std::vector<Real>& diag);
+
+  /// Add to the diagonal
+  void add_diagonal(const std::vector<Real>& diag);
+
+  /// Get the diagonal
+  void get_diagonal(std::vector<Real>& diag);
+
+  /// Reset Matrix
+  void reset(Real reset_to=0.);
+
+  //@} END EFFICCIENT ACCESS
+
+  /// @name MISCELLANEOUS
+  //@{
+
+  /// Print to wherever
+  void print(common::LogStream& stream);
+
+  /// Print to wherever
+  void print(std::ostream& stream);
+
+  /// Print to file given by filename
+  void print(const std::string& filename, std::ios_base::openmode mode = std::ios_base::out );
+
+  /// Print the block structure
+  void print_native(std::ostream& stream);
+
+  /// Accessor to the state of create
+  const bool is_created() { return m_is_created; }
+
+  /// Accessor to the number of equations
+  const Uint neq() { cf3_assert(m_is_created); return m_neq; }
+
+  /// Accessor to the number of block rows
+  const Uint blockrow_size() { cf3_assert(m_is_created); return m_owned_rows.size(); }
+
+  /// Accessor to the number of block columns
+  const Uint blockcol_size() { cf3_assert(m_is_created); return m_nb_nodes; }
+
+  //@} END MISCELLANEOUS
+
+  /// @name NATIVE ACCESS
+  /// Used by the solution strategy and the preconditioners. Vectors are raw arrays of blockcol_size()*neq() entries.
+  //@{
+
+  /// Marks a missing block
+  static const Uint no_block = static_cast<Uint>(-1);
+
+  /// Compute y = A*x for the owned rows. The ghost entries of x are taken from their owners, the ghost entries of y are set to zero.
+  /// This is collective when running in parallel.
+  void apply(const Real* x, Real* y);
+
+  /// Copy the values of the ghost entries of x from their owners. Collective when running in parallel.
+  void update_ghosts(Real* x);
+
+  /// Block rows of the nodes owned by this process
+  const std::vector<Uint>& owned_rows() const { return m_owned_rows; }
+
+  /// True if the node is owned by this process
+  bool is_owned(const Uint node) const { return m_is_owned[node]; }
+
+  /// Start of each block row in block_columns(), with an extra entry for the end
+  const std::vector<Uint>& row_starts() const { return m_row_starts; }
+
+  /// Block column indices, sorted within each block row
+  const std::vector<Uint>& block_columns() const { return m_columns; }
+
+  /// Values of all blocks, neq()*neq() per block
+  const std::vector<Real>& block_values() const { return m_values; }
+
+  /// Index of the diagonal block of each block row, or no_block
+  const std::vector<Uint>& diagonal_blocks() const { return m_diagonal; }
+
+  /// Index of the block (iblockrow, iblockcol) or no_block if it is not in the sparsity pattern
+  Uint find_block(const Uint iblockrow, const Uint iblockcol) const;
+
+  /// Number of threads used in the matrix-vector product
+  Uint nb_threads() const;
+
+  /// Memory used by the cached element block indices, in bytes
+  Uint scatter_cache_size() const { return m_scatter_cache.memory_size(); }
+
+  //@} END NATIVE ACCESS
+
+  /// @name TEST ONLY
+  //@{
+
+  /// exports the matrix into big linear arrays
+  /// @attention only for debug and utest purposes
+  void debug_data(std::vector<Uint>& row_indices, std::vector<Uint>& col_indices, std::vector<Real>& values);
+
+  //@} END TEST ONLY
+
+private:
+
+  /// Pointer to the value at (icol, irow), or a null pointer if the entry is not in a local block row of the sparsity pattern
+  Real* entry(const Uint icol, const Uint irow);
+
+  /// Multiply the chunk of the given block rows that is assigned to thread_idx
+  void multiply_rows(const std::vector<Uint>* rows, const Real* x, Real* y, const Uint thread_idx);
+
+  /// Multiply the given rows, threaded when there are enough of them
+  void multiply(const std::vector<Uint>& rows, const Real* x, Real* y);
+
+  /// True if the ghosts need to be exchanged with other processes
+  bool is_distributed() const;
+
+  /// Compute and cache the block index of each node pair of the element in values
+  const int* cache_blocks(const BlockAccumulator& values);
+
+  /// Called when the scatter_cache option changes
+  void trigger_scatter_cache();
+
+  /// state of creation
+  bool m_is_created;
+
+  /// number of equations
+  Uint m_neq;
+
+  /// number of nodes, including ghosts
+  Uint m_nb_nodes;
+
+  /// ownership of the nodes
+  std::vector<bool> m_is_owned;
+
+  /// owned block rows
+  std::vector<Uint> m_owned_rows;
+
+  /// owned block rows that do not couple to ghost nodes
+  std::vector<Uint> m_interior_rows;
+
+  /// owned block rows that couple to at least one ghost node
+  std::vector<Uint> m_boundary_rows;
+
+  /// start of each block row in m_columns
+  std::vector<Uint> m_row_starts;
+
+  /// block column indices
+  std::vector<Uint> m_columns;
+
+  /// block values, row-major within each block
+  std::vector<Real> m_values;
+
+  /// index of the diagonal block of each block row
+  std::vector<Uint> m_diagonal;
+
+  /// Copy of the connectivity data, including the rows of the ghost nodes
+  std::vector<Uint> m_node_connectivity, m_starting_indices;
+
+  /// commpattern used to update ghost values
+  Handle<common::PE::CommPattern> m_commpattern;
+
+  /// name of the exchange buffer in the commpattern
+  std::string m_exchange_name;
+
+  /// exchange buffer registered in the commpattern, holding the vector that is multiplied
+  std::vector<Real> m_exchange;
+
+  /// Threads for the matrix-vector product
+  boost::scoped_ptr<ThreadTeam> m_threads;
+
+  /// Value of the scatter_cache option
+  bool m_use_scatter_cache;
+
+  /// Block indices of the assembled elements, nb_nodes*nb_nodes per element, -1 for the rows of ghost nodes
+  ScatterCache m_scatter_cache;
+
+}; // end of class NativeMatrix
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_NativeMatrix_hpp
@@ -0,0 +1,255 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include <Eigen/Dense>
+
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
+
+#include "math/LSS/Native/NativeMatrix.hpp"
+#include "math/LSS/Native/NativePreconditioner.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+typedef Eigen::Matrix<Real, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMajorMatrixT;
+typedef Eigen::Map<RowMajorMatrixT> BlockT;
+typedef Eigen::Map<const RowMajorMatrixT> ConstBlockT;
+
+/// Invert the neq x neq block a into inverse, throwing if the block of the given row is singular
+void invert_block(const Real* a, Real* inverse, const Uint neq, const Uint row)
+{
+  const Eigen::FullPivLU<RowMajorMatrixT> lu(ConstBlockT(a, neq, neq));
+  if(!lu.isInvertible())
+    throw common::BadValue(FromHere(), "Singular diagonal block in row " + common::to_str(row) + " of the native matrix, it can not be preconditioned");
+  BlockT(inverse, neq, neq) = lu.inverse();
+}
+
+/// y -= a*x for the neq x neq block a
+inline void subtract_product(const Real* a, const Real* x, Real* y, const Uint neq)
+{
+  for(Uint r = 0; r != neq; ++r)
+  {
+    Real sum = 0.;
+    for(Uint c = 0; c != neq; ++c)
+      sum += a[r*neq+c] * x[c];
+    y[r] -= sum;
+  }
+}
+
+/// y = a*x for the neq x neq block a
+inline void product(const Real* a, const Real* x, Real* y, const Uint neq)
+{
+  for(Uint r = 0; r != neq; ++r)
+  {
+    Real sum = 0.;
+    for(Uint c = 0; c != neq; ++c)
+      sum += a[r*neq+c] * x[c];
+    y[r] = sum;
+  }
+}
+
+} // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+boost::shared_ptr<NativePreconditioner> NativePreconditioner::create(const std::string& name)
+{
+  if(name == "None")
+    return boost::shared_ptr<NativePreconditioner>(new NativeIdentityPreconditioner());
+  if(name == "Jacobi")
+    return boost::shared_ptr<NativePreconditioner>(new NativeJacobiPreconditioner(false));
+  if(name == "BlockJacobi")
+    return boost::shared_ptr<NativePreconditioner>(new NativeJacobiPreconditioner(true));
+  if(name == "ILU0")
+    return boost::shared_ptr<NativePreconditioner>(new NativeILU0Preconditioner());
+
+  throw common::ValueNotFound(FromHere(), "Unknown native preconditioner " + name + ", valid choices are None, Jacobi, BlockJacobi and ILU0");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeIdentityPreconditioner::setup(const NativeMatrix& matrix)
+{
+  NativeMatrix& mat = const_cast<NativeMatrix&>(matrix);
+  m_size = mat.blockcol_size() * mat.neq();
+}
+
+void NativeIdentityPreconditioner::apply(const Real* r, Real* z) const
+{
+  std::copy(r, r+m_size, z);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+NativeJacobiPreconditioner::NativeJacobiPreconditioner(const bool block) :
+  m_block(block)
+{
+}
+
+void NativeJacobiPreconditioner::setup(const NativeMatrix& matrix)
+{
+  NativeMatrix& mat = const_cast<NativeMatrix&>(matrix);
+  m_neq = mat.neq();
+  m_size = mat.blockcol_size() * m_neq;
+  m_owned_rows = &matrix.owned_rows();
+
+  const Uint block_size = m_neq*m_neq;
+  const std::vector<Real>& values = matrix.block_values();
+  m_inverse_diagonal.assign(m_block ? m_size*m_neq : m_size, 0.);
+  BOOST_FOREACH(const Uint row, *m_owned_rows)
+  {
+    const Uint diag = matrix.diagonal_blocks()[row];
+    if(diag == NativeMatrix::no_block)
+      throw common::BadValue(FromHere(), "Missing diagonal block in row " + common::to_str(row) + " of the native matrix");
+
+    const Real* block = &values[diag*block_size];
+    if(m_block)
+    {
+      detail::invert_block(block, &m_inverse_diagonal[row*block_size], m_neq, row);
+      continue;
+    }
+
+    for(Uint i = 0; i != m_neq; ++i)
+    {
+      const Real d = block[i*m_neq+i];
+      if(d == 0.)
+        throw common::BadValue(FromHere(), "Zero diagonal entry in row " + common::to_str(row*m_neq+i) + " of the native matrix");
+      m_inverse_diagonal[row*m_neq+i] = 1. / d;
+    }
+  }
+}
+
+void NativeJacobiPreconditioner::apply(const Real* r, Real* z) const
+{
+  std::fill(z, z+m_size, 0.);
+  const Uint block_size = m_neq*m_neq;
+  BOOST_FOREACH(const Uint row, *m_owned_rows)
+  {
+    if(m_block)
+    {
+      detail::product(&m_inverse_diagonal[row*block_size], r+row*m_neq, z+row*m_neq, m_neq);
+      continue;
+    }
+    for(Uint i = 0; i != m_neq; ++i)
+      z[row*m_neq+i] = m_inverse_diagonal[row*m_neq+i] * r[row*m_neq+i];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeILU0Preconditioner::setup(const NativeMatrix& matrix)
+{
+  NativeMatrix& mat = const_cast<NativeMatrix&>(matrix);
+  m_neq = mat.neq();
+  const Uint nb_nodes = mat.blockcol_size();
+  m_size = nb_nodes * m_neq;
+  m_owned_rows = &matrix.owned_rows();
+  m_row_starts = &matrix.row_starts();
+  m_columns = &matrix.block_columns();
+  m_diagonal = matrix.diagonal_blocks();
+
+  const Uint block_size = m_neq*m_neq;
+  const std::vector<Uint>& row_starts = *m_row_starts;
+  const std::vector<Uint>& columns = *m_columns;
+  m_factors = matrix.block_values();
+  m_inverse_diagonal.assign(nb_nodes*block_size, 0.);
+
+  // position of the blocks of the current row, indexed by block column
+  std::vector<Uint> marker(nb_nodes, NativeMatrix::no_block);
+  detail::RowMajorMatrixT l_block(m_neq, m_neq);
+
+  // the owned rows are in increasing order, so the rows above the current one are already factored
+  BOOST_FOREACH(const Uint i, *m_owned_rows)
+  {
+    if(m_diagonal[i] == NativeMatrix::no_block)
+      throw common::BadValue(FromHere(), "Missing diagonal block in row " + common::to_str(i) + " of the native matrix");
+
+    for(Uint b = row_starts[i]; b != row_starts[i+1]; ++b)
+    {
+      if(matrix.is_owned(columns[b]))
+        marker[columns[b]] = b;
+      else
+        std::fill(m_factors.begin()+b*block_size, m_factors.begin()+(b+1)*block_size, 0.);
+    }
+
+    for(Uint b = row_starts[i]; b != m_diagonal[i]; ++b)
+    {
+      const Uint k = columns[b];
+      if(!matrix.is_owned(k))
+        continue;
+
+      // L_ik = A_ik * U_kk^-1
+      detail::BlockT a_ik(&m_factors[b*block_size], m_neq, m_neq);
+      l_block.noalias() = a_ik * detail::ConstBlockT(&m_inverse_diagonal[k*block_size], m_neq, m_neq);
+      a_ik = l_block;
+
+      // A_ij -= L_ik * U_kj for the blocks of row k right of the diagonal that are also in row i
+      for(Uint c = m_diagonal[k]+1; c != row_starts[k+1]; ++c)
+      {
+        const Uint j = columns[c];
+        if(marker[j] == NativeMatrix::no_block)
+          continue;
+        detail::BlockT(&m_factors[marker[j]*block_size], m_neq, m_neq).noalias() -= l_block * detail::ConstBlockT(&m_factors[c*block_size], m_neq, m_neq);
+      }
+    }
+
+    detail::invert_block(&m_factors[m_diagonal[i]*block_size], &m_inverse_diagonal[i*block_size], m_neq, i);
+
+    for(Uint b = row_starts[i]; b != row_starts[i+1]; ++b)
+      marker[columns[b]] = NativeMatrix::no_block;
+  }
+}
+
+void NativeILU0Preconditioner::apply(const Real* r, Real* z) const
+{
+  const Uint block_size = m_neq*m_neq;
+  const std::vector<Uint>& owned_rows = *m_owned_rows;
+  const std::vector<Uint>& row_starts = *m_row_starts;
+  const std::vector<Uint>& columns = *m_columns;
+  std::fill(z, z+m_size, 0.);
+
+  // forward substitution with the unit lower factor, the ghost entries of z stay zero so the dropped blocks do not contribute
+  BOOST_FOREACH(const Uint i, owned_rows)
+  {
+    Real* z_i = z + i*m_neq;
+    std::copy(r + i*m_neq, r + (i+1)*m_neq, z_i);
+    for(Uint b = row_starts[i]; b != m_diagonal[i]; ++b)
+      detail::subtract_product(&m_factors[b*block_size], z + columns[b]*m_neq, z_i, m_neq);
+  }
+
+  // backward substitution with the upper factor
+  std::vector<Real> tmp(m_neq);
+  for(std::vector<Uint>::const_reverse_iterator it = owned_rows.rbegin(); it != owned_rows.rend(); ++it)
+  {
+    const Uint i = *it;
+    Real* z_i = z + i*m_neq;
+    for(Uint b = m_diagonal[i]+1; b != row_starts[i+1]; ++b)
+      detail::subtract_product(&m_factors[b*block_size], z + columns[b]*m_neq, z_i, m_neq);
+    detail::product(&m_inverse_diagonal[i*block_size], z_i, &tmp[0], m_neq);
+    std::copy(tmp.begin(), tmp.end(), z_i);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
@@ -0,0 +1,112 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_NativePreconditioner_hpp
+#define cf3_Math_LSS_NativePreconditioner_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "math/LSS/LibLSS.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file NativePreconditioner.hpp Preconditioners for the built-in Krylov solvers
+
+  All preconditioners act on the blocks of the NativeMatrix. In parallel, the couplings to ghost nodes are dropped,
+  so each process only preconditions its own part of the system (additive Schwarz without overlap).
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class NativeMatrix;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Base class for the preconditioners used by NativeStrategy
+class LSS_API NativePreconditioner : boost::noncopyable
+{
+public:
+  virtual ~NativePreconditioner() {}
+
+  /// Compute the preconditioner for the current values of the matrix
+  virtual void setup(const NativeMatrix& matrix) = 0;
+
+  /// Compute z = M^-1 r for the owned entries, the ghost entries of z have no meaning
+  virtual void apply(const Real* r, Real* z) const = 0;
+
+  /// Build the preconditioner with the given name: None, Jacobi, BlockJacobi or ILU0
+  static boost::shared_ptr<NativePreconditioner> create(const std::string& name);
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Copies the vector
+class LSS_API NativeIdentityPreconditioner : public NativePreconditioner
+{
+public:
+  void setup(const NativeMatrix& matrix);
+  void apply(const Real* r, Real* z) const;
+private:
+  Uint m_size;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Divides by the diagonal. If block is true, the inverses of the diagonal blocks are used instead.
+class LSS_API NativeJacobiPreconditioner : public NativePreconditioner
+{
+public:
+  NativeJacobiPreconditioner(const bool block);
+  void setup(const NativeMatrix& matrix);
+  void apply(const Real* r, Real* z) const;
+private:
+  const bool m_block;
+  Uint m_neq;
+  Uint m_size;
+  const std::vector<Uint>* m_owned_rows;
+  /// inverse of the (block) diagonal of each owned row
+  std::vector<Real> m_inverse_diagonal;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Block incomplete LU factorization, keeping the sparsity pattern of the matrix
+class LSS_API NativeILU0Preconditioner : public NativePreconditioner
+{
+public:
+  void setup(const NativeMatrix& matrix);
+  void apply(const Real* r, Real* z) const;
+private:
+  Uint m_neq;
+  Uint m_size;
+  const std::vector<Uint>* m_owned_rows;
+  const std::vector<Uint>* m_row_starts;
+  const std::vector<Uint>* m_columns;
+  /// L and U factors in the block layout of the matrix, blocks coupling to ghosts are zero
+  std::vector<Real> m_factors;
+  /// inverse of the diagonal blocks of U
+  std::vector<Real> m_inverse_diagonal;
+  /// position of the diagonal block in each row
+  std::vector<Uint> m_diagonal;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_NativePreconditioner_hpp
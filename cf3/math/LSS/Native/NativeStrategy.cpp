@@ -0,0 +1,419 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include <boost/foreach.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/LSS/Native/NativeMatrix.hpp"
+#include "math/LSS/Native/NativePreconditioner.hpp"
+#include "math/LSS/Native/NativeStrategy.hpp"
+#include "math/LSS/Native/NativeVector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder<NativeStrategy, SolutionStrategy, LibLSS> NativeStrategy_builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+NativeStrategy::NativeStrategy(const std::string& name) :
+  SolutionStrategy(name),
+  m_verbosity(1)
+{
+  std::vector<boost::any> solvers;
+  solvers.push_back(std::string("GMRES"));
+  solvers.push_back(std::string("BiCGStab"));
+  solvers.push_back(std::string("CG"));
+  options().add("solver", std::string("GMRES"))
+    .pretty_name("Solver")
+    .description("Krylov method: GMRES, BiCGStab or CG (for symmetric positive definite systems only)")
+    .mark_basic()
+    .restricted_list() = solvers;
+
+  std::vector<boost::any> preconditioners;
+  preconditioners.push_back(std::string("None"));
+  preconditioners.push_back(std::string("Jacobi"));
+  preconditioners.push_back(std::string("BlockJacobi"));
+  preconditioners.push_back(std::string("ILU0"));
+  options().add("preconditioner", std::string("ILU0"))
+    .pretty_name("Preconditioner")
+    .description("Preconditioner: None, Jacobi, BlockJacobi or ILU0. In parallel, the couplings between processes are ignored by the preconditioner")
+    .mark_basic()
+    .restricted_list() = preconditioners;
+
+  options().add("max_iterations", 1000u)
+    .pretty_name("Maximum Iterations")
+    .description("Maximum number of iterations")
+    .mark_basic();
+
+  options().add("tolerance", 1e-8)
+    .pretty_name("Tolerance")
+    .description("Convergence is reached when the norm of the residual is reduced by this factor with respect to the norm of the right hand side")
+    .mark_basic();
+
+  options().add("gmres_restart", 30u)
+    .pretty_name("GMRES Restart")
+    .description("Number of GMRES iterations before restarting")
+    .mark_basic();
+
+  options().add("verbosity_level", 1)
+    .pretty_name("Verbosity Level")
+    .description("0: no output, 1: print a summary after each solve, 2: also print the residual at each iteration")
+    .mark_basic();
+
+  options().add("compute_residual", false)
+    .pretty_name("Compute Residual")
+    .description("Indicate if the residual should be computed after each solve. This incurs an extra matrix application")
+    .mark_basic();
+}
+
+NativeStrategy::~NativeStrategy()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeStrategy::set_matrix(const Handle<LSS::Matrix>& matrix)
+{
+  m_matrix = Handle<NativeMatrix>(matrix);
+  if(is_null(m_matrix) && is_not_null(matrix))
+    throw common::SetupError(FromHere(), "Matrix " + matrix->uri().path() + " is not a NativeMatrix, it can not be solved by " + uri().path());
+}
+
+void NativeStrategy::set_rhs(const Handle<LSS::Vector>& rhs)
+{
+  m_rhs = Handle<NativeVector>(rhs);
+  if(is_null(m_rhs) && is_not_null(rhs))
+    throw common::SetupError(FromHere(), "RHS " + rhs->uri().path() + " is not a NativeVector, it can not be solved by " + uri().path());
+}
+
+void NativeStrategy::set_solution(const Handle<LSS::Vector>& solution)
+{
+  m_solution = Handle<NativeVector>(solution);
+  if(is_null(m_solution) && is_not_null(solution))
+    throw common::SetupError(FromHere(), "Solution " + solution->uri().path() + " is not a NativeVector, it can not be solved by " + uri().path());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeStrategy::solve()
+{
+  if(is_null(m_matrix))
+    throw common::SetupError(FromHere(), "Null matrix for " + uri().path());
+
+  if(is_null(m_rhs))
+    throw common::SetupError(FromHere(), "Null RHS for " + uri().path());
+
+  if(is_null(m_solution))
+    throw common::SetupError(FromHere(), "Null solution vector for " + uri().path());
+
+  m_verbosity = options().value<int>("verbosity_level");
+  const std::string solver = options().value<std::string>("solver");
+  const std::string preconditioner = options().value<std::string>("preconditioner");
+  const Uint max_iterations = options().value<Uint>("max_iterations");
+
+  if(is_null(m_preconditioner) || preconditioner != m_preconditioner_name)
+  {
+    m_preconditioner = NativePreconditioner::create(preconditioner);
+    m_preconditioner_name = preconditioner;
+  }
+  m_preconditioner->setup(*m_matrix);
+
+  std::vector<Real>& x = m_solution->data();
+  const Real rhs_norm = norm(m_rhs->data());
+  if(rhs_norm == 0.)
+  {
+    std::fill(x.begin(), x.end(), 0.);
+    if(m_verbosity > 0)
+      CFinfo << "Native " << solver << " solve: zero right hand side, solution set to zero" << CFendl;
+    return;
+  }
+
+  const Real target = options().value<Real>("tolerance") * rhs_norm;
+  Real residual_norm = 0.;
+  Uint nb_iterations = 0;
+  if(solver == "GMRES")
+    nb_iterations = gmres(x, target, max_iterations, residual_norm);
+  else if(solver == "BiCGStab")
+    nb_iterations = bicgstab(x, target, max_iterations, residual_norm);
+  else if(solver == "CG")
+    nb_iterations = cg(x, target, max_iterations, residual_norm);
+  else
+    throw common::ValueNotFound(FromHere(), "Unknown native solver " + solver + ", valid choices are GMRES, BiCGStab and CG");
+
+  m_matrix->update_ghosts(&x[0]);
+
+  if(residual_norm > target)
+    CFwarn << "Native " << solver << " solve did not converge after " << nb_iterations << " iterations, relative residual is " << residual_norm / rhs_norm << CFendl;
+  else if(m_verbosity > 0)
+    CFinfo << "Native " << solver << " solve converged after " << nb_iterations << " iterations, relative residual is " << residual_norm / rhs_norm << CFendl;
+
+  if(options().value<bool>("compute_residual"))
+    CFinfo << "Solver residual: " << compute_residual() << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Real NativeStrategy::compute_residual()
+{
+  if(is_null(m_matrix))
+    throw common::SetupError(FromHere(), "Null matrix for " + uri().path());
+
+  if(is_null(m_rhs))
+    throw common::SetupError(FromHere(), "Null RHS for " + uri().path());
+
+  if(is_null(m_solution))
+    throw common::SetupError(FromHere(), "Null solution vector for " + uri().path());
+
+  std::vector<Real> r(m_rhs->data().size());
+  return residual(m_solution->data(), r);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Real NativeStrategy::dot(const std::vector<Real>& a, const std::vector<Real>& b) const
+{
+  const Uint neq = m_matrix->neq();
+  Real local_result = 0.;
+  BOOST_FOREACH(const Uint row, m_matrix->owned_rows())
+  {
+    for(Uint i = row*neq; i != (row+1)*neq; ++i)
+      local_result += a[i]*b[i];
+  }
+
+  if(!common::PE::Comm::instance().is_active())
+    return local_result;
+
+  Real result = 0.;
+  common::PE::Comm::instance().all_reduce(common::PE::plus(), &local_result, 1, &result);
+  return result;
+}
+
+Real NativeStrategy::norm(const std::vector<Real>& a) const
+{
+  return std::sqrt(dot(a, a));
+}
+
+Real NativeStrategy::residual(const std::vector<Real>& x, std::vector<Real>& r)
+{
+  const std::vector<Real>& b = m_rhs->data();
+  m_matrix->apply(&x[0], &r[0]);
+  for(Uint i = 0; i != r.size(); ++i)
+    r[i] = b[i] - r[i];
+  return norm(r);
+}
+
+void NativeStrategy::print_iteration(const Uint iteration, const Real residual_norm) const
+{
+  if(m_verbosity > 1)
+    CFinfo << "  iteration " << iteration << ": residual " << residual_norm << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint NativeStrategy::gmres(std::vector<Real>& x, const Real target, const Uint max_iterations, Real& residual_norm)
+{
+  const Uint n = x.size();
+  const Uint restart = std::max(1u, options().value<Uint>("gmres_restart"));
+
+  // Krylov basis, Hessenberg matrix (column-wise), Givens rotations and the rotated residual
+  std::vector< std::vector<Real> > basis(restart+1, std::vector<Real>(n, 0.));
+  std::vector< std::vector<Real> > h(restart, std::vector<Real>(restart+1, 0.));
+  std::vector<Real> cs(restart), sn(restart), g(restart+1), y(restart);
+  std::vector<Real> z(n), w(n);
+
+  residual_norm = residual(x, basis[0]);
+  Uint iteration = 0;
+  while(residual_norm > target && iteration < max_iterations)
+  {
+    for(Uint i = 0; i != n; ++i)
+      basis[0][i] /= residual_norm;
+    std::fill(g.begin(), g.end(), 0.);
+    g[0] = residual_norm;
+
+    Uint j = 0;
+    while(j != restart && iteration < max_iterations)
+    {
+      ++iteration;
+      m_preconditioner->apply(&basis[j][0], &z[0]);
+      m_matrix->apply(&z[0], &w[0]);
+
+      // modified Gram-Schmidt
+      for(Uint k = 0; k <= j; ++k)
+      {
+        const Real hkj = dot(w, basis[k]);
+        h[j][k] = hkj;
+        for(Uint i = 0; i != n; ++i)
+          w[i] -= hkj * basis[k][i];
+      }
+      const Real w_norm = norm(w);
+      h[j][j+1] = w_norm;
+      if(w_norm != 0.)
+        for(Uint i = 0; i != n; ++i)
+          basis[j+1][i] = w[i] / w_norm;
+
+      // eliminate the subdiagonal using the previous rotations and a new one
+      for(Uint k = 0; k != j; ++k)
+      {
+        const Real tmp = cs[k]*h[j][k] + sn[k]*h[j][k+1];
+        h[j][k+1] = -sn[k]*h[j][k] + cs[k]*h[j][k+1];
+        h[j][k] = tmp;
+      }
+      const Real denominator = std::sqrt(h[j][j]*h[j][j] + h[j][j+1]*h[j][j+1]);
+      cs[j] = denominator == 0. ? 1. : h[j][j] / denominator;
+      sn[j] = denominator == 0. ? 0. : h[j][j+1] / denominator;
+      h[j][j] = cs[j]*h[j][j] + sn[j]*h[j][j+1];
+      h[j][j+1] = 0.;
+      g[j+1] = -sn[j]*g[j];
+      g[j] = cs[j]*g[j];
+
+      ++j;
+      print_iteration(iteration, std::abs(g[j]));
+      if(std::abs(g[j]) <= target || w_norm == 0.)
+        break;
+    }
+
+    // solve the triangular system and update x with the preconditioned combination of the basis vectors
+    for(int k = j-1; k >= 0; --k)
+    {
+      Real sum = g[k];
+      for(Uint l = k+1; l != j; ++l)
+        sum -= h[l][k] * y[l];
+      y[k] = sum / h[k][k];
+    }
+    std::fill(w.begin(), w.end(), 0.);
+    for(Uint k = 0; k != j; ++k)
+      for(Uint i = 0; i != n; ++i)
+        w[i] += y[k] * basis[k][i];
+    m_preconditioner->apply(&w[0], &z[0]);
+    for(Uint i = 0; i != n; ++i)
+      x[i] += z[i];
+
+    const Real previous_norm = residual_norm;
+    residual_norm = residual(x, basis[0]);
+    if(residual_norm == previous_norm)
+      break; // stagnation, no progress is possible anymore
+  }
+
+  return iteration;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint NativeStrategy::bicgstab(std::vector<Real>& x, const Real target, const Uint max_iterations, Real& residual_norm)
+{
+  const Uint n = x.size();
+  std::vector<Real> r(n), r_hat(n), p(n, 0.), v(n, 0.), p_hat(n), s(n), s_hat(n), t(n);
+
+  residual_norm = residual(x, r);
+  r_hat = r;
+  Real rho = 1., alpha = 1., omega = 1.;
+  Uint iteration = 0;
+  while(residual_norm > target && iteration < max_iterations)
+  {
+    ++iteration;
+    const Real rho_new = dot(r_hat, r);
+    if(rho_new == 0.)
+      break;
+
+    const Real beta = (rho_new/rho) * (alpha/omega);
+    for(Uint i = 0; i != n; ++i)
+      p[i] = r[i] + beta*(p[i] - omega*v[i]);
+    m_preconditioner->apply(&p[0], &p_hat[0]);
+    m_matrix->apply(&p_hat[0], &v[0]);
+    alpha = rho_new / dot(r_hat, v);
+    for(Uint i = 0; i != n; ++i)
+      s[i] = r[i] - alpha*v[i];
+
+    const Real s_norm = norm(s);
+    if(s_norm <= target)
+    {
+      for(Uint i = 0; i != n; ++i)
+        x[i] += alpha*p_hat[i];
+      residual_norm = s_norm;
+      print_iteration(iteration, residual_norm);
+      break;
+    }
+
+    m_preconditioner->apply(&s[0], &s_hat[0]);
+    m_matrix->apply(&s_hat[0], &t[0]);
+    const Real tt = dot(t, t);
+    omega = tt == 0. ? 0. : dot(t, s) / tt;
+    for(Uint i = 0; i != n; ++i)
+    {
+      x[i] += alpha*p_hat[i] + omega*s_hat[i];
+      r[i] = s[i] - omega*t[i];
+    }
+    residual_norm = norm(r);
+    print_iteration(iteration, residual_norm);
+    rho = rho_new;
+    if(omega == 0.)
+      break;
+  }
+
+  return iteration;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint NativeStrategy::cg(std::vector<Real>& x, const Real target, const Uint max_iterations, Real& residual_norm)
+{
+  const Uint n = x.size();
+  std::vector<Real> r(n), z(n), p(n), q(n);
+
+  residual_norm = residual(x, r);
+  m_preconditioner->apply(&r[0], &z[0]);
+  p = z;
+  Real rz = dot(r, z);
+  Uint iteration = 0;
+  while(residual_norm > target && iteration < max_iterations)
+  {
+    ++iteration;
+    m_matrix->apply(&p[0], &q[0]);
+    const Real pq = dot(p, q);
+    if(pq == 0.)
+      break;
+    const Real alpha = rz / pq;
+    for(Uint i = 0; i != n; ++i)
+    {
+      x[i] += alpha*p[i];
+      r[i] -= alpha*q[i];
+    }
+    residual_norm = norm(r);
+    print_iteration(iteration, residual_norm);
+    if(residual_norm <= target)
+      break;
+
+    m_preconditioner->apply(&r[0], &z[0]);
+    const Real rz_new = dot(r, z);
+    const Real beta = rz_new / rz;
+    rz = rz_new;
+    for(Uint i = 0; i != n; ++i)
+      p[i] = z[i] + beta*p[i];
+  }
+
+  return iteration;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
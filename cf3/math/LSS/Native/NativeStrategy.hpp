@@ -0,0 +1,92 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_NativeStrategy_hpp
+#define cf3_Math_LSS_NativeStrategy_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/shared_ptr.hpp>
+
+#include "math/LSS/SolutionStrategy.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file NativeStrategy.hpp Built-in Krylov solvers for the NativeMatrix
+
+  Available solvers are restarted GMRES, BiCGStab (both right preconditioned) and preconditioned CG.
+  The initial guess is the content of the solution vector, and the ghost entries of the solution are
+  updated after the solve.
+**/
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class NativeMatrix;
+class NativePreconditioner;
+class NativeVector;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API NativeStrategy : public SolutionStrategy
+{
+public:
+
+  /// Default constructor
+  NativeStrategy(const std::string& name);
+
+  ~NativeStrategy();
+
+  /// name of the type
+  static std::string type_name () { return "NativeStrategy"; }
+
+  void set_matrix(const Handle<LSS::Matrix>& matrix);
+  void set_rhs(const Handle<LSS::Vector>& rhs);
+  void set_solution(const Handle<LSS::Vector>& solution);
+  void solve();
+  Real compute_residual();
+
+private:
+  /// Global dot product over the owned entries
+  Real dot(const std::vector<Real>& a, const std::vector<Real>& b) const;
+
+  /// Global 2-norm over the owned entries
+  Real norm(const std::vector<Real>& a) const;
+
+  /// r = b - A*x, returning the global norm of r
+  Real residual(const std::vector<Real>& x, std::vector<Real>& r);
+
+  /// Krylov methods, iterating until the residual norm drops below target. Return the number of iterations and set residual_norm to the norm of the final residual
+  Uint gmres(std::vector<Real>& x, const Real target, const Uint max_iterations, Real& residual_norm);
+  Uint bicgstab(std::vector<Real>& x, const Real target, const Uint max_iterations, Real& residual_norm);
+  Uint cg(std::vector<Real>& x, const Real target, const Uint max_iterations, Real& residual_norm);
+
+  /// Print the residual of an iteration if the verbosity level asks for it
+  void print_iteration(const Uint iteration, const Real residual_norm) const;
+
+  Handle<NativeMatrix> m_matrix;
+  Handle<NativeVector> m_rhs;
+  Handle<NativeVector> m_solution;
+
+  /// Preconditioner, created on the first solve after the preconditioner option changed
+  boost::shared_ptr<NativePreconditioner> m_preconditioner;
+  std::string m_preconditioner_name;
+
+  /// verbosity level during the current solve
+  int m_verbosity;
+
+}; // end of class NativeStrategy
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_NativeStrategy_hpp
@@ -0,0 +1,310 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+
+#include "common/Assertions.hpp"
+#include "common/Builder.hpp"
+#include "common/Log.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+#include "math/LSS/Native/NativeVector.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+
+common::ComponentBuilder < LSS::NativeVector, LSS::Vector, LSS::LibLSS > NativeVector_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+NativeVector::NativeVector(const std::string& name) :
+  LSS::Vector(name),
+  m_is_created(false),
+  m_neq(0),
+  m_blockrow_size(0)
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::create(common::PE::CommPattern& cp, Uint neq)
+{
+  if (m_is_created) destroy();
+  m_neq=neq;
+  m_blockrow_size=cp.isUpdatable().size();
+  m_data.assign(m_blockrow_size*m_neq,0.);
+  m_is_created=true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::create_blocked(common::PE::CommPattern& cp, const VariablesDescriptor& vars)
+{
+  create(cp,vars.size());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::destroy()
+{
+  std::vector<Real>().swap(m_data);
+  m_neq=0;
+  m_blockrow_size=0;
+  m_is_created=false;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_value(const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  m_data[irow]=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_value(const Uint irow, const Real value)
+{
+  cf3_assert(m_is_created);
+  m_data[irow]+=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_value(const Uint irow, Real& value)
+{
+  cf3_assert(m_is_created);
+  value=m_data[irow];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_value(const Uint iblockrow, const Uint ieq, const Real value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  m_data[iblockrow*m_neq+ieq]=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_value(const Uint iblockrow, const Uint ieq, const Real value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  m_data[iblockrow*m_neq+ieq]+=value;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_value(const Uint iblockrow, const Uint ieq, Real& value)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(iblockrow<m_blockrow_size);
+  value=m_data[iblockrow*m_neq+ieq];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_rhs_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes=values.indices.size();
+  const Real* vals=values.rhs.data();
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    Real* entries=&m_data[values.indices[i]*m_neq];
+    for (Uint j=0; j!=m_neq; ++j)
+      entries[j]=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_rhs_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes=values.indices.size();
+  const Real* vals=values.rhs.data();
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    Real* entries=&m_data[values.indices[i]*m_neq];
+    for (Uint j=0; j!=m_neq; ++j)
+      entries[j]+=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_rhs_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes=values.indices.size();
+  Real* vals=values.rhs.data();
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    const Real* entries=&m_data[values.indices[i]*m_neq];
+    for (Uint j=0; j!=m_neq; ++j)
+      *vals++=entries[j];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set_sol_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes=values.indices.size();
+  const Real* vals=values.sol.data();
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    Real* entries=&m_data[values.indices[i]*m_neq];
+    for (Uint j=0; j!=m_neq; ++j)
+      entries[j]=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::add_sol_values(const BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes=values.indices.size();
+  const Real* vals=values.sol.data();
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    Real* entries=&m_data[values.indices[i]*m_neq];
+    for (Uint j=0; j!=m_neq; ++j)
+      entries[j]+=*vals++;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get_sol_values(BlockAccumulator& values)
+{
+  cf3_assert(m_is_created);
+  const Uint nb_nodes=values.indices.size();
+  Real* vals=values.sol.data();
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    const Real* entries=&m_data[values.indices[i]*m_neq];
+    for (Uint j=0; j!=m_neq; ++j)
+      *vals++=entries[j];
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::reset(Real reset_to)
+{
+  cf3_assert(m_is_created);
+  std::fill(m_data.begin(),m_data.end(),reset_to);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::get( boost::multi_array<Real, 2>& data)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(data.shape()[0]==m_blockrow_size);
+  cf3_assert(data.shape()[1]==m_neq);
+  for (Uint i=0; i!=m_blockrow_size; ++i)
+    for (Uint j=0; j!=m_neq; ++j)
+      data[i][j]=m_data[i*m_neq+j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::set( boost::multi_array<Real, 2>& data)
+{
+  cf3_assert(m_is_created);
+  cf3_assert(data.shape()[0]==m_blockrow_size);
+  cf3_assert(data.shape()[1]==m_neq);
+  for (Uint i=0; i!=m_blockrow_size; ++i)
+    for (Uint j=0; j!=m_neq; ++j)
+      m_data[i*m_neq+j]=data[i][j];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::print(common::LogStream& stream)
+{
+  if (m_is_created)
+  {
+    for (Uint i=0; i!=m_data.size(); ++i)
+      stream << 0 << " " << -(int)i << " " << m_data[i] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_blockrow_size*m_neq << "\n";
+    stream << "# number of block rows: " << m_blockrow_size << "\n";
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::print(std::ostream& stream)
+{
+  if (m_is_created)
+  {
+    for (Uint i=0; i!=m_data.size(); ++i)
+      stream << 0 << " " << -(int)i << " " << m_data[i] << "\n";
+    stream << "# name:                 " << name() << "\n";
+    stream << "# type_name:            " << type_name() << "\n";
+    stream << "# process:              " << common::PE::Comm::instance().rank() << "\n";
+    stream << "# number of equations:  " << m_neq << "\n";
+    stream << "# number of rows:       " << m_blockrow_size*m_neq << "\n";
+    stream << "# number of block rows: " << m_blockrow_size << "\n" << std::flush;
+  } else {
+    stream << name() << " of type " << type_name() << "::is_created() is false, nothing is printed.";
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::print(const std::string& filename, std::ios_base::openmode mode)
+{
+  std::ofstream stream(filename.c_str(),mode);
+  stream << "VARIABLES=COL,ROW,VAL\n" << std::flush;
+  stream << "ZONE T=\"" << type_name() << "::" << name() <<  "\"\n" << std::flush;
+  print(stream);
+  stream.close();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::print_native(std::ostream& stream)
+{
+  stream << type_name() << " " << name() << ": " << m_blockrow_size << " block rows of " << m_neq << " equations\n";
+  for (Uint i=0; i!=m_blockrow_size; ++i)
+  {
+    stream << i << ":";
+    for (Uint j=0; j!=m_neq; ++j)
+      stream << " " << m_data[i*m_neq+j];
+    stream << "\n";
+  }
+  stream << std::flush;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void NativeVector::debug_data(std::vector<Real>& values)
+{
+  cf3_assert(m_is_created);
+  values.assign(m_data.begin(),m_data.end());
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,104 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/bind.hpp>
+
+#include "common/BasicExceptions.hpp"
+
+#include "math/LSS/Native/ThreadTeam.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadTeam::ThreadTeam(const Uint nb_threads) :
+  m_nb_threads(nb_threads == 0 ? 1 : nb_threads),
+  m_stop(false)
+{
+  if(m_nb_threads == 1)
+    return;
+
+  m_barrier.reset(new boost::barrier(m_nb_threads));
+  for(Uint i = 1; i != m_nb_threads; ++i)
+    m_workers.create_thread(boost::bind(&ThreadTeam::work, this, i));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+ThreadTeam::~ThreadTeam()
+{
+  if(m_nb_threads == 1)
+    return;
+
+  m_stop = true;
+  m_barrier->wait();
+  m_workers.join_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadTeam::run(const TaskT& task)
+{
+  if(m_nb_threads == 1)
+  {
+    task(0);
+    return;
+  }
+
+  m_task = task;
+  m_error.clear();
+
+  // release the workers, do our own part and wait for the others
+  m_barrier->wait();
+  execute(0);
+  m_barrier->wait();
+
+  m_task.clear();
+  if(!m_error.empty())
+    throw common::ParallelError(FromHere(), "Error in threaded linear solver kernel: " + m_error);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadTeam::work(const Uint thread_idx)
+{
+  while(true)
+  {
+    m_barrier->wait();
+    if(m_stop)
+      return;
+    execute(thread_idx);
+    m_barrier->wait();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void ThreadTeam::execute(const Uint thread_idx)
+{
+  try
+  {
+    m_task(thread_idx);
+  }
+  catch(std::exception& e)
+  {
+    boost::mutex::scoped_lock lock(m_error_mutex);
+    if(m_error.empty())
+      m_error = e.what();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
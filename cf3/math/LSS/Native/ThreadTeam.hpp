@@ -0,0 +1,100 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_ThreadTeam_hpp
+#define cf3_Math_LSS_ThreadTeam_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "common/CF.hpp"
+
+#include "math/LSS/LibLSS.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file ThreadTeam.hpp persistent group of threads for the kernels of the native linear solver
+
+  The threads are started once and wait on a barrier between tasks, so the overhead of a threaded
+  matrix-vector product is two barrier synchronizations instead of starting and joining threads.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+class LSS_API ThreadTeam : public boost::noncopyable
+{
+public:
+
+  /// Task executed by every thread of the team, the argument is the index of the thread in the team
+  typedef boost::function<void (const Uint)> TaskT;
+
+  /// Start nb_threads-1 worker threads, the calling thread is the first member of the team
+  ThreadTeam(const Uint nb_threads);
+
+  /// Stop and join the worker threads
+  ~ThreadTeam();
+
+  /// Number of threads, including the calling thread
+  Uint size() const { return m_nb_threads; }
+
+  /// Execute task on all threads of the team and return when all are done.
+  /// Exceptions thrown by the task are rethrown as ParallelError on the calling thread.
+  void run(const TaskT& task);
+
+  /// Begin of the chunk of [0, n) assigned to thread thread_idx
+  Uint chunk_begin(const Uint n, const Uint thread_idx) const { return (n*thread_idx)/m_nb_threads; }
+
+  /// End of the chunk of [0, n) assigned to thread thread_idx
+  Uint chunk_end(const Uint n, const Uint thread_idx) const { return (n*(thread_idx+1))/m_nb_threads; }
+
+private:
+
+  /// Loop executed by the worker threads
+  void work(const Uint thread_idx);
+
+  /// Execute the current task, catching errors
+  void execute(const Uint thread_idx);
+
+  const Uint m_nb_threads;
+
+  /// The task to execute, set before releasing the workers
+  TaskT m_task;
+
+  /// True when the workers must exit
+  bool m_stop;
+
+  /// Synchronization point at the start and the end of each task
+  boost::scoped_ptr<boost::barrier> m_barrier;
+
+  boost::thread_group m_workers;
+
+  /// Error reported by a thread
+  boost::mutex m_error_mutex;
+  std::string m_error;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_ThreadTeam_hpp
@@ -0,0 +1,116 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include <boost/foreach.hpp>
+
+#include "common/Assertions.hpp"
+
+#include "math/LSS/BlockAccumulator.hpp"
+#include "math/LSS/ScatterCache.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+const int* ScatterCache::find(const BlockAccumulator& values)
+{
+  if(values.element_group == 0)
+    return 0;
+
+  Group* group = 0;
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    const GroupsT::const_iterator it = m_groups.find(values.element_group);
+    if(it == m_groups.end())
+      return 0;
+    group = it->second.get();
+  }
+
+  const Uint nb_nodes = values.indices.size();
+  const Uint elem = values.element_idx;
+  if(group->nb_nodes != nb_nodes || elem >= group->filled.size() || !group->filled[elem])
+    return 0;
+  if(!std::equal(values.indices.begin(), values.indices.end(), group->indices.begin() + elem*nb_nodes))
+    return 0;
+
+  return &group->positions[elem*group->stride];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+int* ScatterCache::insert(const BlockAccumulator& values, const Uint stride)
+{
+  cf3_assert(values.element_group != 0);
+  const Uint nb_nodes = values.indices.size();
+  const Uint nb_elems = values.element_group_size;
+  const Uint elem = values.element_idx;
+
+  Group* group = 0;
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    boost::shared_ptr<Group>& group_ptr = m_groups[values.element_group];
+
+    // Replace the group if it is new or changed shape. The old group stays allocated, so pointers into it remain valid.
+    if(!group_ptr || group_ptr->nb_nodes != nb_nodes || group_ptr->stride != stride || group_ptr->filled.size() != nb_elems)
+    {
+      if(group_ptr)
+        m_replaced_groups.push_back(group_ptr);
+      group_ptr.reset(new Group(nb_nodes, stride, nb_elems));
+    }
+    group = group_ptr.get();
+  }
+
+  std::copy(values.indices.begin(), values.indices.end(), group->indices.begin() + elem*nb_nodes);
+  group->filled[elem] = 1;
+  return &group->positions[elem*stride];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void ScatterCache::clear()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  m_groups.clear();
+  m_replaced_groups.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint ScatterCache::memory_size() const
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  Uint result = 0;
+  BOOST_FOREACH(const GroupsT::value_type& group, m_groups)
+  {
+    result += group_memory_size(*group.second);
+  }
+  BOOST_FOREACH(const boost::shared_ptr<Group>& group, m_replaced_groups)
+  {
+    result += group_memory_size(*group);
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+Uint ScatterCache::group_memory_size(const Group& group)
+{
+  return group.indices.size()*sizeof(Uint) + group.positions.size()*sizeof(int) + group.filled.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
@@ -0,0 +1,102 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_Math_LSS_ScatterCache_hpp
+#define cf3_Math_LSS_ScatterCache_hpp
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+#include <map>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "math/LSS/LibLSS.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+  @file ScatterCache.hpp Storage for the positions of element contributions in the matrix
+
+  Assembling an element matrix requires looking up where each of its entries lives in the sparse storage of
+  the matrix. Since the sparsity pattern does not change between assemblies, these positions can be computed
+  once per element and reused afterwards, so add_values becomes a plain scatter-add.
+**/
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace math {
+namespace LSS {
+
+class BlockAccumulator;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+/// Positions in the matrix storage for each element passed to add_values, as computed by the matrix.
+/// Elements are identified by the element_group and element_idx of the BlockAccumulator. The cached positions are
+/// only returned if the nodes of the element are the same as when they were stored, so a changed mesh is detected.
+/// Different elements may be handled concurrently by different threads.
+class LSS_API ScatterCache : boost::noncopyable
+{
+public:
+  /// The stored positions for the element in values, or a null pointer if they are unknown
+  const int* find(const BlockAccumulator& values);
+
+  /// Storage for the stride positions of the element in values, to be filled in by the caller
+  int* insert(const BlockAccumulator& values, const Uint stride);
+
+  /// Forget all elements. Must not be called while another thread uses the cache.
+  void clear();
+
+  /// Memory used by the cache, in bytes
+  Uint memory_size() const;
+
+private:
+  /// Cached data for a group of elements. The storage is allocated once in the constructor and never resized, so
+  /// threads can use it without locking while other threads insert into other groups.
+  struct Group
+  {
+    Group(const Uint a_nb_nodes, const Uint a_stride, const Uint nb_elems) :
+      nb_nodes(a_nb_nodes),
+      stride(a_stride),
+      indices(nb_elems*a_nb_nodes, 0),
+      positions(nb_elems*a_stride, -1),
+      filled(nb_elems, 0)
+    {
+    }
+
+    const Uint nb_nodes;
+    const Uint stride;
+    /// nodes of each element when its positions were computed
+    std::vector<Uint> indices;
+    std::vector<int> positions;
+    /// 1 if the positions of the element are valid
+    std::vector<char> filled;
+  };
+
+  static Uint group_memory_size(const Group& group);
+
+  typedef std::map< const void*, boost::shared_ptr<Group> > GroupsT;
+  GroupsT m_groups;
+
+  /// Groups that were replaced because their shape changed. They are kept until clear() is called, since
+  /// other threads may still hold positions obtained from them.
+  std::vector< boost::shared_ptr<Group> > m_replaced_groups;
+
+  /// Protects m_groups and m_replaced_groups
+  mutable boost::mutex m_mutex;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+} // namespace LSS
+} // namespace math
+} // namespace cf3
+
+#endif // cf3_Math_LSS_ScatterCache_hpp
@@ -50,7 +50,11 @@ common::ComponentBuilder < LSS::System, LSS::System, LSS::LibLSS > System_Builde
 LSS::System::System(const std::string& name) :
   Component(name)
 {
+#ifdef CF3_HAVE_TRILINOS
   options().add( "matrix_builder" , "cf3.math.LSS.TrilinosFEVbrMatrix")
+#else
+  options().add( "matrix_builder" , "cf3.math.LSS.NativeMatrix")
+#endif
     .pretty_name("Matrix Builder")
     .description("Name for the builder used to create the LSS matrix")
     .mark_basic();
@@ -60,9 +64,9 @@ LSS::System::System(const std::string& name) :
     .description("Name for the builder used for the vectors. If left empty, this is obtained from the vector_type property of the matrix")
     .mark_basic();
 
-  options().add("solution_strategy", "cf3.math.LSS.TrilinosStratimikosStrategy")
+  options().add("solution_strategy", "")
     .pretty_name("Solution Strategy")
-    .description("Name of the builder that will be used to create the solution strategy")
+    .description("Name of the builder that will be used to create the solution strategy. If left empty, this is obtained from the solution_strategy property of the matrix")
     .mark_basic();
 
   regist_signal("print_system")
@@ -97,7 +101,11 @@ void LSS::System::create(cf3::common::PE::CommPattern& cp, Uint neq, std::vector
   m_sol->mark_basic();
   m_mat->mark_basic();
 
-  m_solution_strategy = create_component<SolutionStrategy>("SolutionStrategy", options().option("solution_strategy").value<std::string>());
+  std::string solution_strategy = options().option("solution_strategy").value_str();
+  if(solution_strategy.empty())
+    solution_strategy = m_mat->properties().value_str("solution_strategy");
+
+  m_solution_strategy = create_component<SolutionStrategy>("SolutionStrategy", solution_strategy);
   m_solution_strategy->set_matrix(m_mat);
   m_solution_strategy->set_solution(m_sol);
   m_solution_strategy->set_rhs(m_rhs);
@@ -129,7 +137,11 @@ void LSS::System::create_blocked(common::PE::CommPattern& cp, const VariablesDes
   m_sol->mark_basic();
   m_mat->mark_basic();
 
-  m_solution_strategy = create_component<SolutionStrategy>("SolutionStrategy", options().option("solution_strategy").value<std::string>());
+  std::string solution_strategy = options().option("solution_strategy").value_str();
+  if(solution_strategy.empty())
+    solution_strategy = m_mat->properties().value_str("solution_strategy");
+
+  m_solution_strategy = create_component<SolutionStrategy>("SolutionStrategy", solution_strategy);
   m_solution_strategy->set_matrix(m_mat);
   m_solution_strategy->set_solution(m_sol);
   m_solution_strategy->set_rhs(m_rhs);
@@ -6,8 +6,10 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
 #include <iostream>
 
+#include <boost/bind.hpp>
 #include <boost/pointer_cast.hpp>
 
 #include "Teuchos_ConfigDefs.hpp"
@@ -36,6 +38,7 @@
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
 #include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
 #include "math/LSS/Trilinos/TrilinosCrsMatrix.hpp"
 #include "math/LSS/Trilinos/TrilinosDetail.hpp"
 #include "math/LSS/Trilinos/TrilinosVector.hpp"
@@ -97,10 +100,16 @@ TrilinosCrsMatrix::TrilinosCrsMatrix(const std::string& name) :
   m_neq(0),
   m_num_my_elements(0),
   m_p2m(0),
-  m_converted_indices(0),
-  m_comm(common::PE::Comm::instance().communicator())
+  m_comm(common::PE::Comm::instance().communicator()),
+  m_use_scatter_cache(false)
 {
   properties().add("vector_type", std::string("cf3.math.LSS.TrilinosVector"));
+  properties().add("solution_strategy", std::string("cf3.math.LSS.TrilinosStratimikosStrategy"));
+
+  options().add("scatter_cache", m_use_scatter_cache)
+    .pretty_name("Scatter Cache")
+    .description("Remember where the entries of each element go in the matrix, speeding up repeated assembly at the cost of memory")
+    .attach_trigger(boost::bind(&TrilinosCrsMatrix::trigger_scatter_cache, this));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -153,7 +162,7 @@ void TrilinosCrsMatrix::create_blocked(common::PE::CommPattern& cp, const Variab
     const int nb_row_nodes = starting_indices[i+1] - starting_indices[i];
     max_nb_row_entries = nb_row_nodes > max_nb_row_entries ? nb_row_nodes : max_nb_row_entries;
   }
-  m_converted_indices.resize(max_nb_row_entries*total_nb_eq);
+  std::vector<int> converted_indices(max_nb_row_entries*total_nb_eq);
   for(int i = 0; i != nb_nodes_for_rank; ++i)
   {
     if(cp.isUpdatable()[i])
@@ -166,13 +175,13 @@ void TrilinosCrsMatrix::create_blocked(common::PE::CommPattern& cp, const Variab
         const Uint node_idx = node_connectivity[j]*total_nb_eq;
         for(int k = 0; k != total_nb_eq; ++k)
         {
-          m_converted_indices[column*total_nb_eq+k] = m_p2m[node_idx+k];
+          converted_indices[column*total_nb_eq+k] = m_p2m[node_idx+k];
         }
       }
       for(int k = 0; k != total_nb_eq; ++k)
       {
         const int row = m_p2m[i*total_nb_eq+k];
-        TRILINOS_THROW(graph.InsertMyIndices(row, static_cast<int>(total_nb_eq*(columns_end - columns_begin)), &m_converted_indices[0]));
+        TRILINOS_THROW(graph.InsertMyIndices(row, static_cast<int>(total_nb_eq*(columns_end - columns_begin)), &converted_indices[0]));
       }
     }
   }
@@ -199,6 +208,7 @@ void TrilinosCrsMatrix::destroy()
   {
     m_mat.reset();
   }
+  m_scatter_cache.clear();
   m_p2m.resize(0);
   m_p2m.reserve(0);
   m_neq=0;
@@ -251,19 +261,20 @@ void TrilinosCrsMatrix::set_values(const BlockAccumulator& values)
   const int num_entries = nb_nodes*m_neq;
   cf3_assert(values.mat.rows() == num_entries);
   // Convert the index vector
+  ConvertedIndices converted_indices(num_entries);
   for(Uint i = 0; i != nb_nodes; ++i)
   {
     const Uint local_start_idx = values.indices[i]*m_neq;
     for(int j = 0; j != m_neq; ++j)
-      m_converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+      converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
   }
   // insert the values
   for(Uint i = 0; i != nb_nodes; ++i)
   {
     for(int j = 0; j != m_neq; ++j)
     {
-      if(m_converted_indices[i*m_neq+j] < m_num_my_elements)
-        TRILINOS_THROW(m_mat->ReplaceMyValues(m_converted_indices[i*m_neq+j], num_entries, values.mat.data()+(num_entries*(i*m_neq+j)),&m_converted_indices[0]));
+      if(converted_indices[i*m_neq+j] < m_num_my_elements)
+        TRILINOS_THROW(m_mat->ReplaceMyValues(converted_indices[i*m_neq+j], num_entries, values.mat.data()+(num_entries*(i*m_neq+j)),converted_indices.data()));
     }
   }
 }
@@ -276,22 +287,96 @@ void TrilinosCrsMatrix::add_values(const BlockAccumulator& values)
   const Uint nb_nodes = values.indices.size();
   const int num_entries = nb_nodes*m_neq;
   cf3_assert(values.mat.rows() == num_entries);
+  if(m_use_scatter_cache && values.element_group != 0)
+  {
+    const int* positions = m_scatter_cache.find(values);
+    if(positions == 0)
+      positions = cache_positions(values);
+    int* row_offsets;
+    int* column_indices;
+    double* matrix_values;
+    TRILINOS_THROW(m_mat->ExtractCrsDataPointers(row_offsets, column_indices, matrix_values));
+    for(Uint i = 0; i != nb_nodes; ++i)
+    {
+      const int* row_positions = positions + i*num_entries;
+      if(row_positions[0] < 0)
+        continue;
+      const Uint local_start_idx = values.indices[i]*m_neq;
+      for(int j = 0; j != m_neq; ++j)
+      {
+        double* row_values = matrix_values + row_offsets[m_p2m[local_start_idx+j]];
+        const Real* element_row = values.mat.data()+(num_entries*(i*m_neq+j));
+        for(int k = 0; k != num_entries; ++k)
+          row_values[row_positions[k]] += element_row[k];
+      }
+    }
+    return;
+  }
   // Convert the index vector
+  ConvertedIndices converted_indices(num_entries);
   for(Uint i = 0; i != nb_nodes; ++i)
   {
     const Uint local_start_idx = values.indices[i]*m_neq;
     for(int j = 0; j != m_neq; ++j)
-      m_converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+      converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
   }
   // insert the values
   for(Uint i = 0; i != nb_nodes; ++i)
   {
     for(int j = 0; j != m_neq; ++j)
     {
-      if(m_converted_indices[i*m_neq+j] < m_num_my_elements)
-        TRILINOS_THROW(m_mat->SumIntoMyValues(m_converted_indices[i*m_neq+j], num_entries, values.mat.data()+(num_entries*(i*m_neq+j)),&m_converted_indices[0]));
+      if(converted_indices[i*m_neq+j] < m_num_my_elements)
+        TRILINOS_THROW(m_mat->SumIntoMyValues(converted_indices[i*m_neq+j], num_entries, values.mat.data()+(num_entries*(i*m_neq+j)),converted_indices.data()));
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+const int* TrilinosCrsMatrix::cache_positions(const BlockAccumulator& values)
+{
+  const Uint nb_nodes = values.indices.size();
+  const int num_entries = nb_nodes*m_neq;
+  int* positions = m_scatter_cache.insert(values, nb_nodes*num_entries);
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    int* row_positions = positions + i*num_entries;
+    const int row = m_p2m[values.indices[i]*m_neq];
+    if(row >= m_num_my_elements)
+    {
+      std::fill(row_positions, row_positions + num_entries, -1);
+      continue;
+    }
+    int row_num_entries;
+    double* row_values;
+    int* row_indices;
+    TRILINOS_THROW(m_mat->ExtractMyRowView(row, row_num_entries, row_values, row_indices));
+    for(Uint j = 0; j != nb_nodes; ++j)
+    {
+      for(int k = 0; k != m_neq; ++k)
+      {
+        const int column = m_p2m[values.indices[j]*m_neq+k];
+        const int* found = std::find(row_indices, row_indices + row_num_entries, column);
+        if(found == row_indices + row_num_entries)
+        {
+          // the element was already marked as cached
+          m_scatter_cache.clear();
+          throw common::BadValue(FromHere(), "Entry (" + common::to_str(row) + "," + common::to_str(column) + ") is not in the sparsity pattern.");
+        }
+        row_positions[j*m_neq+k] = found - row_indices;
+      }
     }
   }
+  return positions;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void TrilinosCrsMatrix::trigger_scatter_cache()
+{
+  m_use_scatter_cache = options().value<bool>("scatter_cache");
+  if(!m_use_scatter_cache)
+    m_scatter_cache.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -308,12 +393,13 @@ void TrilinosCrsMatrix::get_values(BlockAccumulator& values)
   cf3_assert(values.mat.rows() == num_entries);
   std::map<int, int> reverse_idx_map;
   // Convert the index vector
+  ConvertedIndices converted_indices(num_entries);
   for(Uint i = 0; i != nb_nodes; ++i)
   {
     const Uint local_start_idx = values.indices[i]*m_neq;
     for(int j = 0; j != m_neq; ++j)
     {
-      m_converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
+      converted_indices[i*m_neq+j] = m_p2m[local_start_idx+j];
       reverse_idx_map[m_p2m[local_start_idx+j]] = i*m_neq + j;
     }
   }
@@ -322,9 +408,9 @@ void TrilinosCrsMatrix::get_values(BlockAccumulator& values)
   {
     for(int j = 0; j != m_neq; ++j)
     {
-      if(m_converted_indices[i*m_neq+j] >= m_num_my_elements)
+      if(converted_indices[i*m_neq+j] >= m_num_my_elements)
         continue;
-      TRILINOS_THROW(m_mat->ExtractMyRowView(m_converted_indices[i*m_neq+j], extracted_num_entries, extracted_values, extracted_indices));
+      TRILINOS_THROW(m_mat->ExtractMyRowView(converted_indices[i*m_neq+j], extracted_num_entries, extracted_values, extracted_indices));
       for(int k = 0; k != extracted_num_entries; ++k)
       {
         const std::map<int,int>::const_iterator it = reverse_idx_map.find(extracted_indices[k]);
@@ -17,6 +17,7 @@
 #include "math/LSS/BlockAccumulator.hpp"
 #include "math/LSS/Vector.hpp"
 #include "math/LSS/Matrix.hpp"
+#include "math/LSS/ScatterCache.hpp"
 
 #include "ThyraOperator.hpp"
 
@@ -27,6 +28,9 @@
   @author Tamas Banyai
 
   It is based on Trilinos's FEVbrMatrix.
+
+  When the scatter_cache option is set, add_values stores for each element the position of its entries within the
+  rows of the matrix, so assembling the same element again adds directly into the value array of the matrix.
 **/
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -156,6 +160,9 @@ public:
     return m_mat;
   }
 
+  /// Memory used by the cached element positions, in bytes
+  Uint scatter_cache_size() const { return m_scatter_cache.memory_size(); }
+
   /// Get the index for the given node and equation in matrix local format
   inline int matrix_index(const Uint inode, const Uint ieq)
   {
@@ -178,6 +185,12 @@ public:
 
 private:
 
+  /// Compute and cache the position of each entry of the element in values within its row
+  const int* cache_positions(const BlockAccumulator& values);
+
+  /// Called when the scatter_cache option changes
+  void trigger_scatter_cache();
+
   /// teuchos style smart pointer wrapping the matrix
   Teuchos::RCP<Epetra_CrsMatrix> m_mat;
 
@@ -196,11 +209,15 @@ private:
   /// mapper array, maps from process local numbering to matrix local numbering (because ghost nodes need to be ordered to the back)
   std::vector<int> m_p2m;
 
-  /// a helper array used in set/add/get_values to avoid frequent new+free combo
-  std::vector<int> m_converted_indices;
-
   /// Copy of the connectivity data
   std::vector<int> m_node_connectivity, m_starting_indices;
+
+  /// Value of the scatter_cache option
+  bool m_use_scatter_cache;
+
+  /// Positions of the entries of the assembled elements within their rows, nb_nodes*nb_nodes*neq per element.
+  /// All rows of a node share the same columns, so one position per node row and column suffices. Ghost rows are marked by -1.
+  ScatterCache m_scatter_cache;
 }; // end of class Matrix
 
 ////////////////////////////////////////////////////////////////////////////////////////////
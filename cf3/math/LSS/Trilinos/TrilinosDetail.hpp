@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////////////////
 
+#include <vector>
+
 #include "common/CF.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -39,6 +41,38 @@ void create_map_data(cf3::common::PE::CommPattern& cp,
                       std::vector<int>& my_global_elements,
                       int& num_my_elements);
 
+/// Scratch space for the matrix indices of the entries of a BlockAccumulator. It lives on the stack of set/add/get_values,
+/// so these can be called concurrently on disjoint rows from the threads of an element loop.
+class ConvertedIndices
+{
+public:
+  ConvertedIndices(const Uint size) : m_data(m_stack)
+  {
+    if(size > stack_size)
+    {
+      m_heap.resize(size);
+      m_data = &m_heap[0];
+    }
+  }
+
+  int& operator[](const Uint i)
+  {
+    return m_data[i];
+  }
+
+  int* data()
+  {
+    return m_data;
+  }
+
+private:
+  /// Large enough for the usual element matrices, so no allocation is needed
+  static const Uint stack_size = 128;
+  int m_stack[stack_size];
+  std::vector<int> m_heap;
+  int* m_data;
+};
+
 } // namespace LSS
 } // namespace math
 } // namespace cf3
@@ -28,6 +28,7 @@
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
 #include "common/PropertyList.hpp"
+#include "math/LSS/Trilinos/TrilinosDetail.hpp"
 #include "math/LSS/Trilinos/TrilinosFEVbrMatrix.hpp"
 #include "math/LSS/Trilinos/TrilinosVector.hpp"
 
@@ -58,10 +59,10 @@ TrilinosFEVbrMatrix::TrilinosFEVbrMatrix(const std::string& name) :
   m_blockrow_size(0),
   m_blockcol_size(0),
   m_p2m(0),
-  m_converted_indices(0),
   m_comm(common::PE::Comm::instance().communicator())
 {
   properties().add("vector_type", std::string("cf3.math.LSS.TrilinosVector"));
+  properties().add("solution_strategy", std::string("cf3.math.LSS.TrilinosStratimikosStrategy"));
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -280,9 +281,9 @@ void TrilinosFEVbrMatrix::set_values(const BlockAccumulator& values)
   const int numblocks=values.indices.size();
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  for (int i=0; i<(const int)numblocks; i++) m_converted_indices[i]=m_p2m[values.indices[i]];
-  int* idxs=(int*)&m_converted_indices[0];
+  ConvertedIndices converted_indices(numblocks);
+  for (int i=0; i<(const int)numblocks; i++) converted_indices[i]=m_p2m[values.indices[i]];
+  int* idxs=converted_indices.data();
   for (int irow=0; irow<(const int)numblocks; irow++)
   {
     if (idxs[irow]<m_blockrow_size)
@@ -319,9 +320,9 @@ void TrilinosFEVbrMatrix::add_values(const BlockAccumulator& values)
 /* TRILINOS-ADVICED
   cf3_assert(m_is_created);
   const int numblocks=values.indices.size();
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  for (int i=0; i<(const int)numblocks; i++) m_converted_indices[i]=m_p2m[values.indices[i]];
-  int* idxs=(int*)&m_converted_indices[0];
+  ConvertedIndices converted_indices(numblocks);
+  for (int i=0; i<(const int)numblocks; i++) converted_indices[i]=m_p2m[values.indices[i]];
+  int* idxs=converted_indices.data();
   for (int irow=0; irow<(const int)numblocks; irow++)
     if (idxs[irow]<m_blockrow_size)
     {
@@ -339,9 +340,9 @@ void TrilinosFEVbrMatrix::add_values(const BlockAccumulator& values)
   int dummyneq;
   int hits=0;
   const int numblocks=values.indices.size();
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  for (int i=0; i<(const int)numblocks; i++) m_converted_indices[i]=m_p2m[values.indices[i]];
-  int* idxs=(int*)&m_converted_indices[0];
+  ConvertedIndices converted_indices(numblocks);
+  for (int i=0; i<(const int)numblocks; i++) converted_indices[i]=m_p2m[values.indices[i]];
+  int* idxs=converted_indices.data();
   for (int irow=0; irow<(const int)numblocks; irow++)
   {
     if (idxs[irow]<m_blockrow_size)
@@ -368,9 +369,9 @@ void TrilinosFEVbrMatrix::add_values(const BlockAccumulator& values)
   const int numblocks=values.indices.size();
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  for (int i=0; i<(const int)numblocks; i++) m_converted_indices[i]=m_p2m[values.indices[i]];
-  int* idxs=(int*)&m_converted_indices[0];
+  ConvertedIndices converted_indices(numblocks);
+  for (int i=0; i<(const int)numblocks; i++) converted_indices[i]=m_p2m[values.indices[i]];
+  int* idxs=converted_indices.data();
   for (int irow=0; irow<(const int)numblocks; irow++)
   {
     if (idxs[irow]<m_blockrow_size)
@@ -413,9 +414,9 @@ void TrilinosFEVbrMatrix::get_values(BlockAccumulator& values)
   const int numblocks=values.indices.size();
   const int rowoffset=(numblocks-1)*m_neq;
   const int neqneq=m_neq*m_neq;
-  if (m_converted_indices.size()<numblocks) m_converted_indices.resize(numblocks);
-  for (int i=0; i<(const int)numblocks; i++) m_converted_indices[i]=m_p2m[values.indices[i]];
-  int* idxs=(int*)&m_converted_indices[0];
+  ConvertedIndices converted_indices(numblocks);
+  for (int i=0; i<(const int)numblocks; i++) converted_indices[i]=m_p2m[values.indices[i]];
+  int* idxs=converted_indices.data();
   values.mat.setConstant(0.);
   for (int irow=0; irow<(const int)numblocks; irow++)
   {
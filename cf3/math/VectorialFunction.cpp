@@ -4,10 +4,17 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/tokenizer.hpp>
 
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
 #include "common/Log.hpp"
 #include "common/BasicExceptions.hpp"
+#include "common/OptionList.hpp"
 #include "common/StringConversion.hpp"
 
 #include "math/VectorialFunction.hpp"
@@ -25,12 +32,83 @@ namespace math {
 
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+/// Number of points evaluated by one pass over the bytecode. Large enough to share the
+/// dispatch of the instructions, small enough for the stack to stay in the cache.
+const Uint chunk_size = 256;
+
+/// Minimum number of chunks handled by each thread
+const Uint min_chunks_per_thread = 16;
+
+/// Evaluate function f for the points [begin,end) one by one, like evaluate()
+void evaluate_points(BatchFunctionParser& parser, const Uint nb_vars, const Real* const* var_values, Real* ret_values, const Uint begin, const Uint end)
+{
+  std::vector<Real> point(std::max(nb_vars, 1u));
+  for(Uint p = begin; p != end; ++p)
+  {
+    for(Uint v = 0; v != nb_vars; ++v)
+      point[v] = var_values[v][p];
+    ret_values[p] = parser.Eval(&point[0]);
+  }
+}
+
+/// Evaluates the batchable functions for a range of chunks, and records the chunks
+/// that failed so they can be evaluated point by point afterwards
+struct ChunkEvaluation
+{
+  ChunkEvaluation(const std::vector<BatchFunctionParser*>& parsers, const std::vector<FunctionCompiler::Compiled>& compiled, const std::vector<bool>& batchable,
+                  const Uint nb_vars, const Uint nb_points, const Real* const* var_values, Real* const* ret_values, std::vector< std::vector< std::pair<Uint,Uint> > >& failed) :
+    m_parsers(parsers), m_compiled(compiled), m_batchable(batchable), m_nb_vars(nb_vars), m_nb_points(nb_points), m_var_values(var_values), m_ret_values(ret_values), m_failed(failed)
+  {
+  }
+
+  void operator()(const Uint t, const Uint chunk_begin, const Uint chunk_end) const
+  {
+    Uint stack_size = 0;
+    for(Uint f = 0; f != m_parsers.size(); ++f)
+      stack_size = std::max(stack_size, m_parsers[f]->stack_size());
+    std::vector<Real> stack(std::max(stack_size, 1u)*chunk_size);
+    std::vector<const Real*> chunk_vars(std::max(m_nb_vars, 1u));
+
+    for(Uint chunk = chunk_begin; chunk != chunk_end; ++chunk)
+    {
+      const Uint begin = chunk*chunk_size;
+      const Uint nb_chunk_points = std::min(chunk_size, m_nb_points - begin);
+      for(Uint v = 0; v != m_nb_vars; ++v)
+        chunk_vars[v] = m_var_values[v] + begin;
+      for(Uint f = 0; f != m_parsers.size(); ++f)
+      {
+        // Compiled functions handle the failing points themselves
+        if(m_compiled[f].is_compiled())
+          m_compiled[f].batch(nb_chunk_points, &chunk_vars[0], m_ret_values[f] + begin);
+        else if(m_batchable[f] && !m_parsers[f]->eval_batch(nb_chunk_points, &chunk_vars[0], m_ret_values[f] + begin, &stack[0]))
+          m_failed[t].push_back(std::make_pair(f, chunk));
+      }
+    }
+  }
+
+  const std::vector<BatchFunctionParser*>& m_parsers;
+  const std::vector<FunctionCompiler::Compiled>& m_compiled;
+  const std::vector<bool>& m_batchable;
+  const Uint m_nb_vars;
+  const Uint m_nb_points;
+  const Real* const* m_var_values;
+  Real* const* m_ret_values;
+  std::vector< std::vector< std::pair<Uint,Uint> > >& m_failed;
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
 VectorialFunction::VectorialFunction()
   : m_is_parsed(false),
     m_vars(""),
     m_nbvars(0),
     m_functions(0),
     m_parsers(),
+    m_compiled(),
     m_result()
 {
 }
@@ -41,6 +119,7 @@ VectorialFunction::VectorialFunction( const std::string& funcs, const std::strin
     m_nbvars(0),
     m_functions(0),
     m_parsers(),
+    m_compiled(),
     m_result()
 {
   functions( funcs );
@@ -65,7 +144,8 @@ void VectorialFunction::clear()
   for(Uint i = 0; i < m_parsers.size(); i++) {
       delete_ptr(m_parsers[i]);
   }
-  vector<FunctionParser*>().swap(m_parsers);
+  vector<BatchFunctionParser*>().swap(m_parsers);
+  m_compiled.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -156,7 +236,7 @@ void VectorialFunction::parse()
 
   for(Uint i = 0; i < m_functions.size(); ++i)
   {
-    FunctionParser* ptr = new FunctionParser();
+    BatchFunctionParser* ptr = new BatchFunctionParser();
     ptr->AddConstant("pi", Consts::pi());
     m_parsers.push_back(ptr);
 
@@ -174,7 +254,26 @@ void VectorialFunction::parse()
   }
 
   m_result.resize(m_functions.size());
+  m_compiled.resize(m_functions.size());
   m_is_parsed = true;
+
+  if(FunctionCompiler::enabled())
+    compile();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool VectorialFunction::compile()
+{
+  cf3_assert(m_is_parsed);
+
+  bool all_compiled = true;
+  for(Uint i = 0; i != m_parsers.size(); ++i)
+  {
+    m_compiled[i] = FunctionCompiler::compile(*m_parsers[i]);
+    all_compiled = all_compiled && m_compiled[i].is_compiled();
+  }
+  return all_compiled;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -185,11 +284,11 @@ RealVector& VectorialFunction::operator()( const VariablesT& var_values)
   cf3_assert(var_values.size() == m_nbvars);
 
   // evaluate and store the functions line by line in the result vector
-  std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
-  std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
+  std::vector<BatchFunctionParser*>::const_iterator parser = m_parsers.begin();
+  std::vector<BatchFunctionParser*>::const_iterator end = m_parsers.end();
   Uint i = 0;
   for( ; parser != end ; ++parser, ++i )
-    m_result[i] = (*parser)->Eval(&var_values[0]);
+    m_result[i] = m_compiled[i].is_compiled() ? m_compiled[i].function(&var_values[0]) : (*parser)->Eval(&var_values[0]);
 
   return m_result;
 }
@@ -202,17 +301,57 @@ RealVector& VectorialFunction::operator()( const RealVector& var_values)
   cf3_assert(var_values.size() == m_nbvars);
 
   // evaluate and store the functions line by line in the result vector
-  std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
-  std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
+  std::vector<BatchFunctionParser*>::const_iterator parser = m_parsers.begin();
+  std::vector<BatchFunctionParser*>::const_iterator end = m_parsers.end();
   Uint i = 0;
   for( ; parser != end ; ++parser, ++i )
-    m_result[i] = (*parser)->Eval(&var_values[0]);
+    m_result[i] = m_compiled[i].is_compiled() ? m_compiled[i].function(&var_values[0]) : (*parser)->Eval(&var_values[0]);
 
   return m_result;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void VectorialFunction::evaluate_batch(const Uint nb_points, const Real* const* var_values, Real* const* ret_values) const
+{
+  cf3_assert(m_is_parsed);
+
+  const Uint nb_funcs = m_parsers.size();
+  std::vector<bool> batchable(nb_funcs);
+  for(Uint f = 0; f != nb_funcs; ++f)
+    batchable[f] = m_parsers[f]->is_batchable();
+
+  // Chunk 0 is evaluated by the calling thread
+  const Uint nb_chunks = (nb_points + chunk_size - 1) / chunk_size;
+  const Uint requested_threads = Core::instance().environment().options().value<Uint>("nb_threads");
+  const Uint nb_threads = std::max(1u, std::min(requested_threads, nb_chunks/min_chunks_per_thread));
+  std::vector< std::vector< std::pair<Uint,Uint> > > failed(nb_threads);
+  const ChunkEvaluation evaluation(m_parsers, m_compiled, batchable, m_nbvars, nb_points, var_values, ret_values, failed);
+  boost::thread_group threads;
+  for(Uint t = 1; t < nb_threads; ++t)
+    threads.create_thread(boost::bind<void>(evaluation, t, (nb_chunks*t)/nb_threads, (nb_chunks*(t+1))/nb_threads));
+  evaluation(0, 0, nb_chunks/nb_threads);
+  threads.join_all();
+
+  // FunctionParser::Eval is not reentrant, so the rest is done here
+  for(Uint t = 0; t != nb_threads; ++t)
+  {
+    for(Uint i = 0; i != failed[t].size(); ++i)
+    {
+      const Uint f = failed[t][i].first;
+      const Uint begin = failed[t][i].second*chunk_size;
+      evaluate_points(*m_parsers[f], m_nbvars, var_values, ret_values[f], begin, std::min(begin+chunk_size, nb_points));
+    }
+  }
+  for(Uint f = 0; f != nb_funcs; ++f)
+  {
+    if(!batchable[f] && !m_compiled[f].is_compiled())
+      evaluate_points(*m_parsers[f], m_nbvars, var_values, ret_values[f], 0, nb_points);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // math
 } // cf3
 
@@ -9,10 +9,10 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
-#include "fparser/fparser.hh"
-
 #include "common/BasicExceptions.hpp"
 
+#include "math/BatchFunctionParser.hpp"
+#include "math/FunctionCompiler.hpp"
 #include "math/LibMath.hpp"
 #include "math/MatrixTypes.hpp"
 
@@ -71,6 +71,17 @@ public: // functions
   /// @param var_values values of the variables to substitute in the function.
   RealVector& operator()(const RealVector& var_values);
 
+  /// Evaluate the Vectorial Function for many points at once, with the variables and the results
+  /// stored per component: var_values[v][p] is the value of variable v at point p, and
+  /// ret_values[f][p] receives the value of function f at point p.
+  /// The points are evaluated in chunks, each instruction of the bytecode running over a whole chunk,
+  /// and the chunks are divided over the threads set by the nb_threads option of the environment.
+  /// The results are the same as those of evaluate() for each point.
+  /// @param nb_points number of points
+  /// @param var_values nbvars() arrays of nb_points values
+  /// @param ret_values nbfuncs() arrays of nb_points values
+  void evaluate_batch(const Uint nb_points, const Real* const* var_values, Real* const* ret_values) const;
+
   /// @return if the VectorialFunctionParser has been parsed yet.
   bool is_parsed() const { return m_is_parsed; }
 
@@ -87,9 +98,16 @@ public: // functions
   void variables( const std::string& vars );
 
   /// Parse the strings to extract the functions for each line of the vector.
+  /// The functions are also compiled if the compile_functions option of the environment is set.
   /// @throw ParsingFailed if there is an error while parsing
   void parse ();
 
+  /// Compile the parsed functions to native code, see FunctionCompiler.
+  /// The functions that can't be compiled keep being interpreted.
+  /// @pre only call this function if already parsed
+  /// @return true if all functions were compiled
+  bool compile();
+
   /// Gets the number of variables
   /// @pre only call this function if already parsed
   /// @returns the number of varibles
@@ -120,7 +138,10 @@ private: // data
   std::vector<std::string> m_functions;
 
   /// vector holding the parsers, one for each entry in the vector
-  std::vector<FunctionParser*> m_parsers;
+  std::vector<BatchFunctionParser*> m_parsers;
+
+  /// compiled versions of the parsers, null if the function is interpreted
+  std::vector<FunctionCompiler::Compiled> m_compiled;
 
   /// storage of the result for using the class as functor
   RealVector m_result;
@@ -136,12 +157,12 @@ void VectorialFunction::evaluate(const var_t& var_values, ret_t& ret_value) cons
   cf3_assert(var_values.size() == m_nbvars);
 
   // evaluate and store the functions line by line in the vector
-  std::vector<FunctionParser*>::const_iterator parser = m_parsers.begin();
-  std::vector<FunctionParser*>::const_iterator end = m_parsers.end();
+  std::vector<BatchFunctionParser*>::const_iterator parser = m_parsers.begin();
+  std::vector<BatchFunctionParser*>::const_iterator end = m_parsers.end();
   for(Uint i=0 ; parser != end ; ++parser, ++i )
   {
     // It is possible this function signals a FloatingPointException (FPE)
-    ret_value[i] = (*parser)->Eval(&var_values[0]);
+    ret_value[i] = m_compiled[i].is_compiled() ? m_compiled[i].function(&var_values[0]) : (*parser)->Eval(&var_values[0]);
   }
 }
 
@@ -0,0 +1,388 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/thread/thread.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/Log.hpp"
+#include "common/OptionComponent.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+
+#include "mesh/AsyncWriteMesh.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/ContinuousDictionary.hpp"
+#include "mesh/DiscontinuousDictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/MeshWriter.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/ShapeFunction.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/WriteMesh.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+using namespace common;
+
+common::ComponentBuilder < AsyncWriteMesh, Component, LibMesh > AsyncWriteMesh_Builder;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /// Path of the component, relative to the mesh
+  std::string relative_path(const Component& component, const Mesh& mesh)
+  {
+    std::string path = component.name();
+    for(Handle<Component const> parent = component.parent(); is_not_null(parent) && parent.get() != &mesh; parent = parent->parent())
+      path = parent->name() + "/" + path;
+    return path;
+  }
+
+  /// True if the staging mesh has the same dictionaries and entities as the source
+  bool same_structure(const Mesh& source, const Mesh& staging)
+  {
+    if(source.dimension() != staging.dimension()
+       || source.dictionaries().size() != staging.dictionaries().size()
+       || source.elements().size() != staging.elements().size())
+      return false;
+
+    boost_foreach(const Handle<Dictionary>& dict, source.dictionaries())
+    {
+      Handle<Dictionary const> staging_dict(staging.get_child(dict->name()));
+      if(is_null(staging_dict) || staging_dict->size() != dict->size() || staging_dict->continuous() != dict->continuous())
+        return false;
+    }
+
+    boost_foreach(const Handle<Entities>& entities, source.elements())
+    {
+      Handle<Entities const> staging_entities(staging.access_component(relative_path(*entities, source)));
+      if(is_null(staging_entities)
+         || staging_entities->size() != entities->size()
+         || staging_entities->element_type().derived_type_name() != entities->element_type().derived_type_name())
+        return false;
+    }
+
+    return true;
+  }
+
+  /// Copy the nodes, dictionaries and entities of source into the empty mesh target
+  void copy_structure(const Mesh& source, Mesh& target)
+  {
+    const Dictionary& geometry = source.geometry_fields();
+    target.initialize_nodes(geometry.size(), source.dimension());
+    target.geometry_fields().glb_idx().array() = geometry.glb_idx().array();
+    target.geometry_fields().rank().array() = geometry.rank().array();
+
+    boost_foreach(const Handle<Dictionary>& dict, source.dictionaries())
+    {
+      if(dict.get() == &geometry)
+        continue;
+      Handle<Dictionary> copy;
+      if(dict->continuous())
+        copy = target.create_component<ContinuousDictionary>(dict->name());
+      else
+        copy = target.create_component<DiscontinuousDictionary>(dict->name());
+      copy->resize(dict->size());
+      copy->glb_idx().array() = dict->glb_idx().array();
+      copy->rank().array() = dict->rank().array();
+    }
+
+    boost_foreach(const Handle<Entities>& entities, source.elements())
+    {
+      // create the regions leading up to the entities
+      Handle<Component> parent = target.handle();
+      std::vector< Handle<Component const> > regions;
+      for(Handle<Component const> region = entities->parent(); region.get() != &source; region = region->parent())
+        regions.push_back(region);
+      for(std::vector< Handle<Component const> >::reverse_iterator region = regions.rbegin(); region != regions.rend(); ++region)
+      {
+        Handle<Component> child = parent->get_child((*region)->name());
+        parent = is_null(child) ? Handle<Component>(parent->create_component<Region>((*region)->name())) : child;
+      }
+
+      Handle<Entities> copy(parent->create_component(entities->name(), entities->derived_type_name()));
+      copy->initialize(entities->element_type().derived_type_name(), target.geometry_fields());
+      copy->resize(entities->size());
+      copy->glb_idx().array() = entities->glb_idx().array();
+      copy->rank().array() = entities->rank().array();
+
+      boost_foreach(const Handle<Space>& space, entities->spaces())
+      {
+        Dictionary& dict = *Handle<Dictionary>(target.get_child(space->dict().name()));
+        Space& space_copy = &dict == &target.geometry_fields() ? copy->geometry_space() : copy->create_space(space->shape_function().derived_type_name(), dict);
+        Connectivity& connectivity = space_copy.connectivity();
+        connectivity.set_row_size(space->connectivity().row_size());
+        connectivity.resize(space->connectivity().size());
+        connectivity.array() = space->connectivity().array();
+      }
+    }
+
+    target.update_structures();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+AsyncWriteMesh::AsyncWriteMesh ( const std::string& name  ) :
+  Component ( name ),
+  m_stop(false)
+{
+  properties()["brief"] = std::string("Write meshes on a background thread");
+  mark_basic();
+
+  options().add("writer", m_writer)
+      .description("Mesh writer to use. If not set, the writer is chosen based on the file extension")
+      .pretty_name("Writer")
+      .link_to(&m_writer);
+
+  options().add("max_in_flight", 2u)
+      .description("Maximum number of snapshots that are queued or being written. Taking a new snapshot blocks when this is reached.")
+      .pretty_name("Maximum In Flight")
+      .mark_basic();
+
+  m_write_mesh = create_static_component<WriteMesh>("WriteMesh");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+AsyncWriteMesh::~AsyncWriteMesh()
+{
+  if(!m_thread)
+    return;
+
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_stop = true;
+  }
+  m_condition.notify_all();
+  m_thread->join();
+
+  if(!m_error.empty())
+    CFerror << "Error writing mesh asynchronously: " << m_error << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void AsyncWriteMesh::write_mesh( const Mesh& mesh, const URI& file, const std::vector<URI>& fields)
+{
+  const Uint slot = acquire_snapshot();
+  Snapshot& snapshot = m_snapshots[slot];
+
+  try
+  {
+    snapshot.file = WriteMesh::expand_file_path(mesh, file);
+    snapshot.writer = is_null(m_writer) ? writer_for(snapshot.file) : m_writer;
+    // MPI is not initialized for calls from other threads
+    if(snapshot.writer->is_collective() && PE::Comm::instance().is_active())
+      throw NotSupported(FromHere(), "The " + snapshot.writer->get_format() + " writer makes collective MPI calls, so "
+                         + uri().string() + " can not write " + snapshot.file.path() + " in the background when running in parallel");
+    take_snapshot(mesh, fields, slot);
+    CFinfo << "Writing mesh " << snapshot.file.path() << " in the background" << CFendl;
+  }
+  catch(...)
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_free_snapshots.push_back(slot);
+    throw;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    m_queue.push_back(slot);
+  }
+  m_condition.notify_all();
+
+  if(!m_thread)
+    m_thread.reset(new boost::thread(boost::bind(&AsyncWriteMesh::run, this)));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void AsyncWriteMesh::wait()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  while(!m_queue.empty())
+    m_condition.wait(lock);
+  rethrow_error();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint AsyncWriteMesh::nb_in_flight()
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  return m_queue.size();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void AsyncWriteMesh::run()
+{
+  // The log streams are not thread-safe
+  Logger::instance().set_thread_muted(true);
+
+  while(true)
+  {
+    Snapshot snapshot;
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      while(m_queue.empty() && !m_stop)
+        m_condition.wait(lock);
+      if(m_queue.empty())
+        return;
+      snapshot = m_snapshots[m_queue.front()];
+    }
+
+    std::string error;
+    try
+    {
+      snapshot.writer->options().set("fields", snapshot.fields);
+      snapshot.writer->options().set("mesh", snapshot.mesh->handle<Mesh const>());
+      snapshot.writer->options().set("file", snapshot.file);
+      snapshot.writer->execute();
+    }
+    catch(std::exception& e)
+    {
+      error = snapshot.file.path() + ": " + e.what();
+    }
+    catch(...)
+    {
+      error = snapshot.file.path() + ": unknown error";
+    }
+
+    // The staging mesh is only released by the main thread
+    snapshot = Snapshot();
+
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      if(!error.empty() && m_error.empty())
+        m_error = error;
+      m_free_snapshots.push_back(m_queue.front());
+      m_queue.pop_front();
+    }
+    m_condition.notify_all();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint AsyncWriteMesh::acquire_snapshot()
+{
+  const Uint max_in_flight = options().value<Uint>("max_in_flight");
+  if(max_in_flight == 0)
+    throw BadValue(FromHere(), "Option max_in_flight of " + uri().string() + " must be at least 1");
+
+  boost::mutex::scoped_lock lock(m_mutex);
+  rethrow_error();
+
+  // backpressure: wait for the writer thread to release a snapshot
+  while(m_free_snapshots.empty() && m_snapshots.size() >= max_in_flight)
+  {
+    m_condition.wait(lock);
+    rethrow_error();
+  }
+
+  if(m_free_snapshots.empty())
+  {
+    m_snapshots.push_back(Snapshot());
+    return m_snapshots.size() - 1;
+  }
+
+  const Uint slot = m_free_snapshots.back();
+  m_free_snapshots.pop_back();
+  return slot;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void AsyncWriteMesh::take_snapshot(const Mesh& mesh, const std::vector<URI>& fields, const Uint slot)
+{
+  Snapshot& snapshot = m_snapshots[slot];
+
+  // The staging mesh is only rebuilt when the structure of the mesh changed
+  if(!snapshot.mesh || !same_structure(mesh, *snapshot.mesh))
+  {
+    snapshot.mesh = allocate_component<Mesh>("snapshot_" + to_str(slot));
+    copy_structure(mesh, *snapshot.mesh);
+  }
+  Mesh& staging = *snapshot.mesh;
+
+  const PropertyList& metadata = mesh.metadata().properties();
+  for(PropertyList::const_iterator it = metadata.begin(); it != metadata.end(); ++it)
+    staging.metadata()[it->first] = it->second;
+
+  staging.geometry_fields().coordinates().array() = mesh.geometry_fields().coordinates().array();
+
+  snapshot.fields.clear();
+  boost_foreach(const URI& field_uri, fields)
+  {
+    const Field& field = *Handle<Field const>(mesh.access_component_checked(field_uri));
+    Dictionary& dict = *Handle<Dictionary>(staging.get_child(field.dict().name()));
+
+    Handle<Field> copy(dict.get_child(field.name()));
+    if(is_not_null(copy) && copy->row_size() != field.row_size())
+    {
+      dict.remove_component(*copy);
+      copy.reset();
+    }
+    if(is_null(copy))
+    {
+      copy = dict.create_field(field.name(), field.descriptor().description()).handle<Field>();
+      boost_foreach(const std::string& tag, field.get_tags())
+      {
+        if(!copy->has_tag(tag))
+          copy->add_tag(tag);
+      }
+    }
+
+    copy->array() = field.array();
+    snapshot.fields.push_back(URI(dict.name() + "/" + field.name(), URI::Scheme::CPATH));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Handle<MeshWriter> AsyncWriteMesh::writer_for(const URI& file)
+{
+  // Look up the writer type once per extension, and build a writer that is only used by the writer thread
+  boost::shared_ptr<MeshWriter>& writer = m_writers[file.extension()];
+  if(!writer)
+  {
+    const std::string builder_name = m_write_mesh->find_writer(file)->derived_type_name();
+    writer = build_component_abstract_type<MeshWriter>(builder_name, builder_name);
+  }
+  return writer->handle<MeshWriter>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void AsyncWriteMesh::rethrow_error()
+{
+  if(m_error.empty())
+    return;
+
+  const std::string error = m_error;
+  m_error.clear();
+  throw FileSystemError(FromHere(), "Error writing mesh asynchronously: " + error);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
@@ -0,0 +1,131 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_AsyncWriteMesh_hpp
+#define cf3_mesh_AsyncWriteMesh_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <deque>
+#include <map>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "common/Component.hpp"
+#include "common/URI.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+namespace boost { class thread; }
+
+namespace cf3 {
+namespace mesh {
+  class Mesh;
+  class MeshWriter;
+  class WriteMesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Writes meshes on a background thread, so the solver can continue while the files are written.
+///
+/// write_mesh() copies the selected fields into a staging mesh and returns as soon as the copy is
+/// queued for the writer thread. The staging meshes are kept in a pool of at most "max_in_flight"
+/// entries: the default of 2 lets one snapshot be written while the next is taken. When all of them
+/// are in use write_mesh() blocks until the writer thread releases one. A staging mesh copies the
+/// topology of the mesh once, and only copies the field values afterwards, unless the number or size
+/// of the dictionaries or entities changes.
+///
+/// The staging meshes, and the writers chosen from the file extension like in WriteMesh, are not part
+/// of the component tree, so the writer thread never touches the tree while the main thread changes it.
+/// A writer set in the "writer" option is used as is, and is reconfigured by the writer thread.
+/// Writers are executed outside the main thread, so they must not communicate with the other processes:
+/// when running in parallel, write_mesh() refuses writers that report MeshWriter::is_collective().
+/// The writer thread is muted in the Logger, so messages logged by the writers are discarded.
+/// Errors raised by the writer are rethrown by the next call to write_mesh() or wait().
+class Mesh_API AsyncWriteMesh : public common::Component {
+
+public: // functions
+
+  /// Contructor
+  /// @param name of the component
+  AsyncWriteMesh ( const std::string& name );
+
+  /// Virtual destructor, waits for the queued snapshots to be written
+  virtual ~AsyncWriteMesh();
+
+  /// Get the class name
+  static std::string type_name () { return "AsyncWriteMesh"; }
+
+  /// Take a snapshot of the given fields and queue it for writing
+  /// @param file file to write, in which ${iter} and ${time} are substituted at the time of the call
+  /// @param fields selection of the fields of data to write
+  void write_mesh( const Mesh& mesh, const common::URI& file, const std::vector<common::URI>& fields);
+
+  /// Block until all queued snapshots are written
+  void wait();
+
+  /// Number of snapshots that are queued or being written
+  Uint nb_in_flight();
+
+private: // helper functions
+
+  /// A staging mesh, and the request to write it
+  struct Snapshot
+  {
+    boost::shared_ptr<Mesh> mesh;
+    Handle<MeshWriter> writer;
+    common::URI file;
+    std::vector<common::URI> fields;
+  };
+
+  /// Writer thread main loop
+  void run();
+
+  /// Get a free snapshot, growing the pool up to max_in_flight or waiting for the writer thread
+  Uint acquire_snapshot();
+
+  /// Copy the selected fields of the mesh into the staging mesh of the snapshot
+  void take_snapshot(const Mesh& mesh, const std::vector<common::URI>& fields, const Uint slot);
+
+  /// Writer to use for the given file
+  Handle<MeshWriter> writer_for(const common::URI& file);
+
+  /// Throw the error raised by the writer thread, if any. The lock must be held.
+  void rethrow_error();
+
+private: // data
+
+  Handle<MeshWriter> m_writer;
+
+  Handle<WriteMesh> m_write_mesh; ///< Used for the lookup of writers by file extension
+
+  /// Writers built for the file extensions, indexed by extension
+  std::map<std::string, boost::shared_ptr<MeshWriter> > m_writers;
+
+  boost::mutex m_mutex;
+  boost::condition_variable m_condition;
+
+  std::vector<Snapshot> m_snapshots;
+  std::vector<Uint> m_free_snapshots;
+  std::deque<Uint> m_queue; ///< Snapshots waiting to be written, the front one is being written
+
+  std::string m_error;
+  bool m_stop;
+
+  boost::scoped_ptr<boost::thread> m_thread;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_AsyncWriteMesh_hpp
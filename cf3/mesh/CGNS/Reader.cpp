@@ -5,6 +5,7 @@
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
 #include <boost/algorithm/string/replace.hpp>
+#include <boost/bind.hpp>
 #include <boost/foreach.hpp>
 #include <boost/progress.hpp>
 
@@ -17,6 +18,7 @@
 #include "common/FindComponents.hpp"
 #include "common/BasicExceptions.hpp"
 #include "common/StringConversion.hpp"
+#include "common/PE/Comm.hpp"
 
 #include "math/VariablesDescriptor.hpp"
 
@@ -28,6 +30,8 @@
 #include "mesh/MeshElements.hpp"
 #include "mesh/Space.hpp"
 #include "mesh/MeshTransformer.hpp"
+#include "mesh/MergedParallelDistribution.hpp"
+#include "mesh/ParallelDistribution.hpp"
 
 #include "mesh/CGNS/Reader.hpp"
 
@@ -45,6 +49,28 @@ common::ComponentBuilder< Reader, MeshReader, LibCGNS > aCGNSReader_Builder;
 
 //////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+bool is_parallel()
+{
+  return PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1;
+}
+
+/// Number of nodes of an element of the given CGNS type
+cgsize_t nb_element_nodes(const CGNS_ENUMT( ElementType_t ) type)
+{
+  int npe;
+  CALL_CGNS(cg_npe(type,&npe));
+  if (npe <= 0)
+    throw NotSupported(FromHere(), "CGNS: element type " + to_str<int>(type) + " is not supported");
+  return npe;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+
 Reader::Reader(const std::string& name)
 : MeshReader(name), Shared()
 {
@@ -54,6 +80,14 @@ Reader::Reader(const std::string& name)
   options().add( "zone_handling", false )
       .description("If zero, and there is only 1 zone, the zone is skipped"
                    " as nested region, and the zone's sections are added immediately.");
+
+  options().add("part", PE::Comm::instance().rank() )
+      .description("Number of the part of the mesh to read. (e.g. rank of processor)")
+      .pretty_name("Part");
+
+  options().add("nb_parts", PE::Comm::instance().size() )
+      .description("Total number of parts. (e.g. number of processors)")
+      .pretty_name("nb_parts");
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -72,6 +106,20 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
   // Set the internal mesh pointer
   m_mesh = Handle<Mesh>(mesh.handle());
 
+  m_part = options().value<Uint>("part");
+  m_nb_parts = options().value<Uint>("nb_parts");
+  if (m_part >= m_nb_parts)
+    throw BadValue(FromHere(), "CGNS: part " + to_str(m_part) + " does not exist, there are only " + to_str(m_nb_parts) + " parts");
+  // Ghost node values are exchanged between the processes, so each process must read the part matching its rank
+  if (is_parallel() && (m_nb_parts != PE::Comm::instance().size() || m_part != PE::Comm::instance().rank()))
+    throw BadValue(FromHere(), "CGNS: when running on " + to_str(PE::Comm::instance().size()) + " processes, nb_parts must be "
+                   + to_str(PE::Comm::instance().size()) + " and part must be the rank of the process, but they are "
+                   + to_str(m_nb_parts) + " and " + to_str(m_part));
+
+  m_nodes_glb_offset = 0;
+  m_elements_glb_offset = 0;
+  m_has_structured_zones = false;
+
   // open file in read mode
   CALL_CGNS(cg_open(file.path().c_str(),CG_MODE_READ,&m_file.idx));
 
@@ -88,9 +136,9 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
   // close the CGNS file
   CALL_CGNS(cg_close(m_file.idx));
 
-  // Fix global numbering
-  /// @todo remove this and read glb_index ourself
-  build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalNumbering","glb_numbering")->transform(m_mesh);
+  // Unstructured zones are numbered from their CGNS indices, structured zones still need a global numbering
+  if (m_has_structured_zones)
+    build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalNumbering","glb_numbering")->transform(m_mesh);
 
   mesh.raise_mesh_loaded();
 }
@@ -189,14 +237,22 @@ void Reader::read_zone(Mesh& mesh)
     this_region->add_tag("grid_zone");
     m_zone_map[m_zone.idx] = this_region.get();
 
+    // Each process reads a contiguous range of the elements and of the nodes of this zone
+    create_distribution();
+
+    // read the elements of this process first, as they determine which ghost nodes are needed
+    read_section_elements();
+
     // read coordinates in this zone
     for (int i=1; i<=m_zone.nbGrids; ++i)
       read_coordinates_unstructured(*this_region);
 
-    // read sections (or subregions) in this zone
-    m_global_to_region.reserve(m_zone.total_nbElements);
-    for (m_section.idx=1; m_section.idx<=m_zone.nbSections; ++m_section.idx)
-      read_section(*this_region);
+    // create the sections (or subregions) in this zone
+    m_global_to_region.reserve(m_elements_end-m_elements_begin);
+    BOOST_FOREACH(SectionElements& section, m_sections)
+    {
+      create_section(section, *this_region);
+    }
 
 //    // Only read boco's if sections are not defined as BC's
 //    if (!option("SectionsAreBCs")->value<bool>())
@@ -217,10 +273,7 @@ void Reader::read_zone(Mesh& mesh)
     // truely deallocate the global_to_region vector
     m_global_to_region.resize(0);
     std::vector<Region_TableIndex_pair>().swap (m_global_to_region);
-
-
-
-
+    std::vector<SectionElements>().swap(m_sections);
   }
   else if(m_zone.type == CGNS_ENUMV( Structured ))
   {
@@ -283,10 +336,98 @@ void Reader::read_zone(Mesh& mesh)
     for (m_boco.idx=1; m_boco.idx<=m_zone.nbBocos; ++m_boco.idx)
       read_boco_structured(*this_region);
 
+    m_has_structured_zones = true;
+
   }
 
   m_mesh->geometry_fields().update_structures();
   read_flowsolution();
+
+  if (is_not_null(m_hash))
+  {
+    remove_component(*m_hash);
+    m_hash.reset();
+  }
+  m_nodes_glb_offset += m_zone.total_nbVertices;
+  m_elements_glb_offset += m_zone.total_nbElements;
+  std::vector<Uint>().swap(m_node_ids);
+  std::vector< std::vector<Uint> >().swap(m_ghost_sends);
+  std::vector< std::vector<Uint> >().swap(m_ghost_positions);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::create_distribution()
+{
+  if (is_not_null(get_child("hash")))
+    remove_component("hash");
+  m_hash = create_component<MergedParallelDistribution>("hash");
+  std::vector<Uint> num_obj(2);
+  num_obj[NODES] = m_zone.total_nbVertices;
+  num_obj[ELEMS] = m_zone.total_nbElements;
+  m_hash->options().set("nb_parts",m_nb_parts);
+  m_hash->options().set("nb_obj",num_obj);
+
+  m_elements_begin = m_hash->subhash(ELEMS).start_idx_in_proc(m_part);
+  m_elements_end = m_hash->subhash(ELEMS).end_idx_in_proc(m_part);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_section_elements()
+{
+  m_sections.clear();
+  m_sections.reserve(m_zone.nbSections);
+  for (m_section.idx=1; m_section.idx<=m_zone.nbSections; ++m_section.idx)
+  {
+    char section_name_char[CGNS_CHAR_MAX];
+
+    // read section information
+    CALL_CGNS(cg_section_read(m_file.idx, m_base.idx, m_zone.idx, m_section.idx, section_name_char, &m_section.type,
+                              &m_section.eBegin, &m_section.eEnd, &m_section.nbBdry, &m_section.parentFlag));
+
+    m_sections.push_back(SectionElements());
+    SectionElements& section = m_sections.back();
+    section.name = section_name_char;
+
+    // replace whitespace by underscore
+    boost::algorithm::replace_all(section.name," ","_");
+    boost::algorithm::replace_all(section.name,".","_");
+    boost::algorithm::replace_all(section.name,":","_");
+    boost::algorithm::replace_all(section.name,"/","_");
+
+    section.type = m_section.type;
+    section.eBegin = m_section.eBegin;
+    section.eEnd = m_section.eEnd;
+
+    // The part of this section within the range of elements of this process
+    section.begin = std::max(section.eBegin, static_cast<cgsize_t>(m_elements_begin+1));
+    section.end = std::min(section.eEnd, static_cast<cgsize_t>(m_elements_end));
+    if (section.begin > section.end)
+      continue;
+
+    cgsize_t size;
+    if (section.type == CGNS_ENUMV( MIXED ))
+    {
+      CALL_CGNS(cg_ElementPartialSize(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,section.begin,section.end,&size));
+    }
+    else
+    {
+      size = nb_element_nodes(section.type) * (section.end-section.begin+1);
+    }
+
+    section.nodes.resize(size);
+#if CGNS_VERSION >= 4000
+    // Since CGNS 4, MIXED sections store the start of each element in a separate offsets array, and can only be read with the poly interface
+    if (section.type == CGNS_ENUMV( MIXED ))
+    {
+      std::vector<cgsize_t> offsets(section.end-section.begin+2);
+      CALL_CGNS(cg_poly_elements_partial_read(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,section.begin,section.end,&section.nodes[0],&offsets[0],NULL));
+      continue;
+    }
+#endif
+    CALL_CGNS(cg_elements_partial_read(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,section.begin,section.end,&section.nodes[0],NULL));
+  }
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -300,53 +441,172 @@ void Reader::read_coordinates_unstructured(Region& parent_region)
   m_zone.nodes = &nodes;
   m_zone.nodes_start_idx = nodes.size();
 
-  // read coordinates
-  cgsize_t one = 1;
-  Real *xCoord;
-  Real *yCoord;
-  Real *zCoord;
-    
-  switch (m_zone.coord_dim)
+  const ParallelDistribution& node_distribution = m_hash->subhash(NODES);
+  const Uint begin = node_distribution.start_idx_in_proc(m_part);
+  const Uint end = node_distribution.end_idx_in_proc(m_part);
+
+  // The nodes used by the elements of this process and owned by another process
+  std::vector<Uint> ghosts;
+  BOOST_FOREACH(const SectionElements& section, m_sections)
   {
-    case 3:
-      zCoord = new Real[m_zone.total_nbVertices];
-      CALL_CGNS(cg_coord_read(m_file.idx,m_base.idx,m_zone.idx, "CoordinateZ", CGNS_ENUMV( RealDouble ), &one, &m_zone.total_nbVertices, zCoord));
-    case 2:
-      yCoord = new Real[m_zone.total_nbVertices];
-      CALL_CGNS(cg_coord_read(m_file.idx,m_base.idx,m_zone.idx, "CoordinateY", CGNS_ENUMV( RealDouble ), &one, &m_zone.total_nbVertices, yCoord));
-    case 1:
-      xCoord = new Real[m_zone.total_nbVertices];
-      CALL_CGNS(cg_coord_read(m_file.idx,m_base.idx,m_zone.idx, "CoordinateX", CGNS_ENUMV( RealDouble ), &one, &m_zone.total_nbVertices, xCoord));
+    const bool mixed = section.type == CGNS_ENUMV( MIXED );
+    for (Uint i=0; i<section.nodes.size(); )
+    {
+      const cgsize_t nb_nodes = mixed ? nb_element_nodes(static_cast<CGNS_ENUMT( ElementType_t )>(section.nodes[i++])) : nb_element_nodes(section.type);
+      for (cgsize_t n=0; n<nb_nodes; ++n, ++i)
+      {
+        const cgsize_t node = section.nodes[i]-1; // -1 because cgns has index-base 1 instead of 0
+        if (node < 0 || node >= m_zone.total_nbVertices)
+          throw ParsingFailed(FromHere(), "CGNS: section " + section.name + " refers to node " + to_str(node+1) + ", which is not in zone " + m_zone.name);
+        if (static_cast<Uint>(node) < begin || static_cast<Uint>(node) >= end)
+          ghosts.push_back(node);
+      }
+    }
   }
+  std::sort(ghosts.begin(), ghosts.end());
+  ghosts.erase(std::unique(ghosts.begin(), ghosts.end()), ghosts.end());
+
+  // Local nodes are numbered in the order of their CGNS index
+  m_node_ids.clear();
+  m_node_ids.reserve(end-begin+ghosts.size());
+  std::vector<Uint>::const_iterator first_after = std::lower_bound(ghosts.begin(), ghosts.end(), end);
+  m_node_ids.insert(m_node_ids.end(), ghosts.begin(), std::lower_bound(ghosts.begin(), ghosts.end(), begin));
+  for (Uint node=begin; node<end; ++node)
+    m_node_ids.push_back(node);
+  m_node_ids.insert(m_node_ids.end(), first_after, std::vector<Uint>::const_iterator(ghosts.end()));
+
+  // Ask the owners of the ghost nodes which values they will have to send
+  const Uint nb_procs = m_nb_parts;
+  std::vector< std::vector<Uint> > requests(nb_procs);
+  BOOST_FOREACH(const Uint node, ghosts)
+  {
+    requests[node_distribution.proc_of_obj(node)].push_back(node);
+  }
+  m_ghost_positions.assign(nb_procs, std::vector<Uint>());
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    m_ghost_positions[p].reserve(requests[p].size());
+    BOOST_FOREACH(const Uint node, requests[p])
+    {
+      m_ghost_positions[p].push_back(std::lower_bound(m_node_ids.begin(), m_node_ids.end(), node) - m_node_ids.begin());
+    }
+  }
+  if (is_parallel())
+    PE::Comm::instance().all_to_all(requests, m_ghost_sends);
+  else
+    m_ghost_sends.assign(nb_procs, std::vector<Uint>());
 
-  m_mesh->initialize_nodes(m_zone.total_nbVertices, (Uint)m_zone.coord_dim);
+  m_mesh->initialize_nodes(m_zone.nodes_start_idx+m_node_ids.size(), (Uint)m_zone.coord_dim);
   common::Table<Real>& coords = nodes.coordinates();
-  common::List<Uint>& rank = nodes.rank();
+  common::List<Uint>& rank_list = nodes.rank();
+  common::List<Uint>& glb_idx = nodes.glb_idx();
 
-  for (int i=0; i<m_zone.total_nbVertices; ++i)
+  // read coordinates
+  const char* coordinate_names[] = { "CoordinateX", "CoordinateY", "CoordinateZ" };
+  std::vector<Real> values;
+  for (int d=0; d<m_zone.coord_dim; ++d)
   {
-    switch (m_zone.coord_dim)
-    {
-      case 3:
-        coords[i][2] = zCoord[i];
-       case 2:
-        coords[i][1] = yCoord[i];
-       case 1:
-        coords[i][0] = xCoord[i];
-     }
-    rank[i] = 0;
+    read_local_node_values(boost::bind(&Reader::read_coordinate_range, this, std::string(coordinate_names[d]), _1, _2, _3), values);
+    for (Uint i=0; i<m_node_ids.size(); ++i)
+      coords[m_zone.nodes_start_idx+i][d] = values[i];
   }
 
-  switch (m_zone.coord_dim)
+  for (Uint i=0; i<m_node_ids.size(); ++i)
   {
-    case 3:
-      delete_ptr_array(zCoord);
-    case 2:
-      delete_ptr_array(yCoord);
-    case 1:
-      delete_ptr_array(xCoord);
+    rank_list[m_zone.nodes_start_idx+i] = node_distribution.part_of_obj(m_node_ids[i]);
+    glb_idx[m_zone.nodes_start_idx+i] = m_nodes_glb_offset + m_node_ids[i];
   }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_local_node_values(const boost::function<void (cgsize_t, cgsize_t, Real*)>& read_range, std::vector<Real>& values)
+{
+  const ParallelDistribution& node_distribution = m_hash->subhash(NODES);
+  const Uint begin = node_distribution.start_idx_in_proc(m_part);
+  const Uint end = node_distribution.end_idx_in_proc(m_part);
+
+  // The owned nodes are consecutive in m_node_ids, preceded by the ghosts with a lower index
+  values.resize(m_node_ids.size());
+  const Uint owned_start = std::lower_bound(m_node_ids.begin(), m_node_ids.end(), begin) - m_node_ids.begin();
+  if (end > begin)
+    read_range(begin+1, end, &values[owned_start]);
+
+  if (is_parallel())
+  {
+    const Uint nb_procs = PE::Comm::instance().size();
+    std::vector< std::vector<Real> > answers(nb_procs);
+    for (Uint p=0; p<nb_procs; ++p)
+    {
+      answers[p].reserve(m_ghost_sends[p].size());
+      BOOST_FOREACH(const Uint node, m_ghost_sends[p])
+      {
+        answers[p].push_back(values[owned_start+node-begin]);
+      }
+    }
+    std::vector< std::vector<Real> > received_answers;
+    PE::Comm::instance().all_to_all(answers, received_answers);
 
+    for (Uint p=0; p<nb_procs; ++p)
+      for (Uint i=0; i<m_ghost_positions[p].size(); ++i)
+        values[m_ghost_positions[p][i]] = received_answers[p][i];
+  }
+  else
+  {
+    // A single process reading one part of the mesh reads its ghost values from the file as well
+    for (Uint p=0; p<m_ghost_positions.size(); ++p)
+    {
+      BOOST_FOREACH(const Uint position, m_ghost_positions[p])
+      {
+        const cgsize_t node = m_node_ids[position]+1;
+        read_range(node, node, &values[position]);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_coordinate_range(const std::string& name, cgsize_t min, cgsize_t max, Real* data)
+{
+  CALL_CGNS(cg_coord_read(m_file.idx,m_base.idx,m_zone.idx, name.c_str(), CGNS_ENUMV( RealDouble ), &min, &max, data));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_field_range(const std::string& name, cgsize_t min, cgsize_t max, Real* data)
+{
+  CALL_CGNS(cg_field_read(m_file.idx,m_base.idx,m_zone.idx,m_flowsol.idx, name.c_str(), CGNS_ENUMV( RealDouble ), &min, &max, data));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Uint Reader::local_node(const cgsize_t node) const
+{
+  std::vector<Uint>::const_iterator it = std::lower_bound(m_node_ids.begin(), m_node_ids.end(), static_cast<Uint>(node));
+  cf3_assert(it != m_node_ids.end() && *it == static_cast<Uint>(node));
+  return m_zone.nodes_start_idx + (it - m_node_ids.begin());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Reader::Region_TableIndex_pair Reader::local_element(const cgsize_t element) const
+{
+  if (element <= static_cast<cgsize_t>(m_elements_begin) || element > static_cast<cgsize_t>(m_elements_end))
+    return Region_TableIndex_pair(Handle<Elements>(),0u);
+  return m_global_to_region[element-1-m_elements_begin];
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Handle<Region> Reader::section_with_range(const cgsize_t first, const cgsize_t last) const
+{
+  BOOST_FOREACH(const SectionElements& section, m_sections)
+  {
+    if (section.eBegin == first && section.eEnd == last)
+      return section.region;
+  }
+  return Handle<Region>();
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -421,29 +681,15 @@ void Reader::read_coordinates_structured(Region& parent_region)
 
 //////////////////////////////////////////////////////////////////////////////
 
-void Reader::read_section(Region& parent_region)
+void Reader::create_section(SectionElements& section, Region& parent_region)
 {
-
-  char section_name_char[CGNS_CHAR_MAX];
-
-  // read section information
-  cg_section_read(m_file.idx, m_base.idx, m_zone.idx, m_section.idx, section_name_char, &m_section.type,
-                          &m_section.eBegin, &m_section.eEnd, &m_section.nbBdry, &m_section.parentFlag);
-  m_section.name=section_name_char;
-
-  // replace whitespace by underscore
-  boost::algorithm::replace_all(m_section.name," ","_");
-  boost::algorithm::replace_all(m_section.name,".","_");
-  boost::algorithm::replace_all(m_section.name,":","_");
-  boost::algorithm::replace_all(m_section.name,"/","_");
-
-  // Create a new region for this section
-  Region& this_region = parent_region.create_region(m_section.name);
+  // Create a new region for this section, on every process
+  Region& this_region = parent_region.create_region(section.name);
+  section.region = this_region.handle<Region>();
 
   Dictionary& all_nodes = *m_zone.nodes;
-  Uint start_idx = m_zone.nodes_start_idx;
 
-  if (m_section.type == CGNS_ENUMV( MIXED )) // Different element types, Can also be faces
+  if (section.type == CGNS_ENUMV( MIXED )) // Different element types, Can also be faces
   {
     // Create Elements component for each element type.
     std::map<std::string,Handle< Elements > > cells = create_cells_in_region(this_region,all_nodes,get_supported_element_types());
@@ -454,103 +700,92 @@ void Reader::read_section(Region& parent_region)
     std::map<std::string, boost::shared_ptr< ArrayBufferT<Uint> > > buffer = create_connectivity_buffermap(elements);
 
     // Handle each element of this section separately to see in which Elements component it will be written
-    for (int elem=m_section.eBegin;elem<=m_section.eEnd;++elem)
+    std::vector<Uint> row;
+    Uint i=0;
+    for (cgsize_t elem=section.begin; elem<=section.end; ++elem)
     {
-      // Read the amount of nodes this 1 element contains
-      CALL_CGNS(cg_ElementPartialSize(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,elem,elem,(cgsize_t*)&m_section.elemNodeCount));
-      m_section.elemNodeCount--; // subtract 1 as there is one index too many storing the element type
-
-      // Storage for element type (index 0) and element nodes (index 1->elemNodeCount)
-      cgsize_t elemNodes[1][1+m_section.elemNodeCount];
-
-      // Read nodes of 1 element
-      CALL_CGNS(cg_elements_partial_read(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,elem,elem,*elemNodes,&m_section.parentData));
-
-      // Store the cgns element type
-      CGNS_ENUMT( ElementType_t ) etype_cgns = static_cast<CGNS_ENUMT( ElementType_t )>(elemNodes[0][0]);
+      // Store the cgns element type, which precedes the element nodes
+      CGNS_ENUMT( ElementType_t ) etype_cgns = static_cast<CGNS_ENUMT( ElementType_t )>(section.nodes[i++]);
 
       // Put the element nodes in a vector
-      std::vector<Uint> row(m_section.elemNodeCount);
-      for (int n=1;n<=m_section.elemNodeCount;++n)  // n=0 is the cell type
-        row[n-1]=start_idx+(elemNodes[0][n]-1); // -1 because cgns has index-base 1 instead of 0
+      row.resize(nb_element_nodes(etype_cgns));
+      for (Uint n=0; n<row.size(); ++n)
+        row[n]=local_node(section.nodes[i++]-1); // -1 because cgns has index-base 1 instead of 0
 
       // Convert the cgns element type to the CF element type
       const std::string& etype_CF = m_elemtype_CGNS_to_CF[etype_cgns]+to_str(m_zone.coord_dim)+"D";
+      if ( elements.find(etype_CF) == elements.end() )
+      {
+        throw BadValue(FromHere(), etype_CF+" not found in "+this_region.uri().string());
+      }
+
       // Add the nodes to the correct Elements component using its buffer
-      cf3_assert(buffer[etype_CF]);
       Uint table_idx = buffer[etype_CF]->add_row(row);
 
       // Store the global element number to a pair of (region , local element number)
-      m_global_to_region.push_back(Region_TableIndex_pair(find_component_ptr_with_name<Elements>(this_region, "elements_"+etype_CF),table_idx));
-      if ( ! m_global_to_region.back().first )
-      {
-        throw BadValue(FromHere(), etype_CF+" not found in "+this_region.uri().string());
-      }
-      cf3_assert( m_global_to_region.back().first );
+      m_global_to_region.push_back(Region_TableIndex_pair(elements[etype_CF],table_idx));
     } // for elem
+
+    // Flush all buffers
+    for (BufferMap::iterator it=buffer.begin(); it!=buffer.end(); ++it)
+      it->second->flush();
+    buffer.clear();
+
+    for (std::map<std::string,Handle< Elements > >::iterator it=elements.begin(); it!=elements.end(); ++it)
+    {
+      it->second->rank().resize(it->second->size());
+      for (Uint e=0; e<it->second->size(); ++e)
+        it->second->rank()[e] = m_part;
+    }
   } // if mixed
   else // Single element type in this section
   {
     // Read the number of nodes in this section
-    CALL_CGNS(cg_npe(m_section.type,&m_section.elemNodeCount));
-
-    // Read the size of all elements
-    CALL_CGNS(cg_ElementDataSize(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,&m_section.elemDataSize	));
+    const cgsize_t nb_nodes = nb_element_nodes(section.type);
 
     // Calculate the number of elements
-    int nbElems = m_section.elemDataSize/m_section.elemNodeCount;
+    const Uint nbElems = section.nodes.size()/nb_nodes;
 
     // Convert the CGNS element type to the CF element type
-    const std::string& etype_CF = m_elemtype_CGNS_to_CF[m_section.type]+to_str<int>(m_base.phys_dim)+"D";
+    const std::string& etype_CF = m_elemtype_CGNS_to_CF[section.type]+to_str<int>(m_base.phys_dim)+"D";
 
     // Create element component in this region for this CF element type, automatically creates connectivity_table
-    this_region.create_elements(etype_CF,all_nodes);
-
-    Elements& element_region= *Handle<Elements>(this_region.get_child("elements_"+etype_CF));
-
-    // Create a buffer for this element component, to start filling in the elements we will read.
-    Connectivity& node_connectivity = element_region.geometry_space().connectivity();
-
-    // Create storage for element nodes
-    cgsize_t* elemNodes = new cgsize_t [m_section.elemDataSize];
-
-    // Read in the element nodes
-    cg_elements_read	(m_file.idx,m_base.idx,m_zone.idx,m_section.idx, elemNodes,&m_section.parentData);
+    Elements& element_region = this_region.create_elements(etype_CF,all_nodes);
 
     // --------------------------------------------- Fill connectivity table
-    std::vector<Uint> coords_added;
-    std::vector<Uint> row(m_section.elemNodeCount);
+    Connectivity& node_connectivity = element_region.geometry_space().connectivity();
     node_connectivity.resize(nbElems);
+    element_region.rank().resize(nbElems);
 
-    for (int elem=0; elem<nbElems; ++elem) //, ++progress)
+    for (Uint elem=0; elem<nbElems; ++elem)
     {
-      for (int node=0;node<m_section.elemNodeCount;++node)
-        node_connectivity[elem][node] = start_idx + elemNodes[node+elem*m_section.elemNodeCount]-1;  // -1 because cgns has index-base 1 instead of 0;
+      for (cgsize_t node=0;node<nb_nodes;++node)
+        node_connectivity[elem][node] = local_node(section.nodes[node+elem*nb_nodes]-1);  // -1 because cgns has index-base 1 instead of 0;
+      element_region.rank()[elem] = m_part;
 
       // Store the global element number to a pair of (region , local element number)
       m_global_to_region.push_back(Region_TableIndex_pair(element_region.handle<Elements>(),elem));
     } // for elem
+  } // else not mixed
 
+  // The elements of this section are the last ones added to m_global_to_region, in the order of their CGNS index
+  if (section.begin <= section.end)
+  {
+    const Uint first = m_global_to_region.size() - (section.end-section.begin+1);
+    for (cgsize_t elem=section.begin; elem<=section.end; ++elem)
+    {
+      const Region_TableIndex_pair& location = m_global_to_region[first+elem-section.begin];
+      common::List<Uint>& glb_idx = location.first->glb_idx();
+      if (glb_idx.size() != location.first->size())
+        glb_idx.resize(location.first->size());
+      glb_idx[location.second] = m_elements_glb_offset + elem-1; // -1 because cgns has index-base 1 instead of 0
+    }
+  }
 
-
-    // Delete storage for element nodes
-    delete_ptr(elemNodes);
-  } // else not mixed
+  // The element nodes as read from the file are no longer needed
+  std::vector<cgsize_t>().swap(section.nodes);
 
   remove_empty_element_regions(this_region);
-
-//  // Mark BC regions as temporary if option SectionsAreBCs is false
-//  if (!option("SectionsAreBCs")->value<bool>() && option("SharedCoordinates")->value<bool>())
-//  {
-//    bool is_bc_region = false;
-//    BOOST_FOREACH(const Elements& element_region, find_components<Elements>(this_region))
-//    {
-//      if (element_region.element_type().dimensionality() < static_cast<Uint>(m_base.cell_dim))
-//        is_bc_region = is_bc_region || true;
-//    }
-//    if (is_bc_region)
-//      this_region.add_tag("remove_this_tmp_component");
-//  }
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -676,19 +911,12 @@ void Reader::read_boco_unstructured(Region& parent_region)
       if (m_zone.type != CGNS_ENUMV( Unstructured ))
         throw NotSupported(FromHere(),"CGNS: Boundary with pointset_type \"CGNS_ENUMV( ElementRange )\" is only supported for CGNS_ENUMV( Unstructured ) grids");
 
-      // First do some simple checks to see if an entire region can be taken as a BC.
-      Handle< Elements > first_elements = m_global_to_region[boco_elems[0]-1].first;
-      Handle< Elements > last_elements = m_global_to_region[boco_elems[1]-1].first;
-      if (first_elements->parent() == last_elements->parent())
+      // If the range is exactly a section, the entire section region is taken as BC.
+      if (Handle< Region > group_region = section_with_range(boco_elems[0],boco_elems[1]))
       {
-        Handle< Region > group_region = Handle<Region>(first_elements->parent());
-        Uint prev_elm_count = group_region->properties().check("previous_elem_count") ? group_region->properties().value<Uint>("previous_elem_count") : 0;
-        if (group_region->recursive_elements_count(true) == prev_elm_count + Uint(boco_elems[1]-boco_elems[0]+1))
-        {
-          group_region->properties()["cgns_section_name"] = group_region->name();
-          group_region->rename(m_boco.name);
-          break;
-        }
+        group_region->properties()["cgns_section_name"] = group_region->name();
+        group_region->rename(m_boco.name);
+        break;
       }
 
 
@@ -706,18 +934,16 @@ void Reader::read_boco_unstructured(Region& parent_region)
       std::map<std::string,Handle< Elements > > elements = create_faces_in_region(this_region,nodes,get_supported_element_types());
       std::map<std::string,boost::shared_ptr< ArrayBufferT<Uint > > > buffer = create_connectivity_buffermap(elements);
 
-      for (int global_element=boco_elems[0]-1;global_element<boco_elems[1];++global_element)
+      for (cgsize_t global_element=boco_elems[0];global_element<=boco_elems[1];++global_element)
       {
-        // Check which region this global_element belongs to
-        Handle< Elements > element_region = m_global_to_region[global_element].first;
-
-        // Check the local element number in this region
-        Uint local_element = m_global_to_region[global_element].second;
+        // Check which region this global_element belongs to, skipping elements of other processes
+        Region_TableIndex_pair element = local_element(global_element);
+        if (is_null(element.first))
+          continue;
 
         // Add the local element to the correct Elements component through its buffer
-        std::cout << "element_region->element_type().derived_type_name() = " << element_region->element_type().derived_type_name() << std::endl;
-        cf3_assert(buffer[element_region->element_type().derived_type_name()]);
-        buffer[element_region->element_type().derived_type_name()]->add_row(element_region->geometry_space().connectivity()[local_element]);
+        cf3_assert(buffer[element.first->element_type().derived_type_name()]);
+        buffer[element.first->element_type().derived_type_name()]->add_row(element.first->geometry_space().connectivity()[element.second]);
       }
 
       // Flush all buffers and remove empty element regions
@@ -734,23 +960,15 @@ void Reader::read_boco_unstructured(Region& parent_region)
       if (m_zone.type != CGNS_ENUMV( Unstructured ))
         throw NotSupported(FromHere(),"CGNS: Boundary with pointset_type \"ElementList\" is only supported for CGNS_ENUMV( Unstructured ) grids");
 
-      // First do some simple checks to see if an entire region can be taken as a BC.
-      std::cout << "boco_elems[0]-1 = " << boco_elems[0]-1 << std::endl;
-      std::cout << m_global_to_region[boco_elems[0]-1].second << std::endl;
-      cf3_assert(m_global_to_region[boco_elems[0]-1].first);
-      Handle< Elements > first_elements = m_global_to_region[boco_elems[0]-1].first;
-      cf3_assert(m_global_to_region[boco_elems[m_boco.nBC_elem-1]-1].first);
-      Handle< Elements > last_elements = m_global_to_region[boco_elems[m_boco.nBC_elem-1]-1].first;
-      if (first_elements->parent() == last_elements->parent())
+      // If the list covers exactly a section, the entire section region is taken as BC.
+      const cgsize_t first = *std::min_element(boco_elems,boco_elems+m_boco.nBC_elem);
+      const cgsize_t last = *std::max_element(boco_elems,boco_elems+m_boco.nBC_elem);
+      if (Handle< Region > group_region = section_with_range(first,last))
       {
-        Handle< Region > group_region = Handle<Region>(first_elements->parent());
-        if (group_region->name() != m_boco.name)
+        if (last-first+1 == m_boco.nBC_elem)
         {
-          if (group_region->recursive_elements_count(true) == Uint(boco_elems[m_boco.nBC_elem-1]-boco_elems[0]+1))
-          {
-            group_region->rename(m_boco.name);
-            break;  // EXIT switch
-          }
+          group_region->rename(m_boco.name);
+          break;  // EXIT switch
         }
       }
 
@@ -771,18 +989,14 @@ void Reader::read_boco_unstructured(Region& parent_region)
 
       for (int i=0; i<m_boco.nBC_elem; ++i)
       {
-        Uint global_element = boco_elems[i]-1;
-
-        // Check which region this global_element belongs to
-        Handle< Elements > element_region = m_global_to_region[global_element].first;
-
-        // Check the local element number in this region
-        Uint local_element = m_global_to_region[global_element].second;
+        // Check which region this global_element belongs to, skipping elements of other processes
+        Region_TableIndex_pair element = local_element(boco_elems[i]);
+        if (is_null(element.first))
+          continue;
 
         // Add the local element to the correct Elements component through its buffer
-        std::cout << "element_region->element_type().derived_type_name() = " << element_region->element_type().derived_type_name() << std::endl;
-        cf3_assert(buffer[element_region->element_type().derived_type_name()]);
-        buffer[element_region->element_type().derived_type_name()]->add_row(element_region->geometry_space().connectivity()[local_element]);
+        cf3_assert(buffer[element.first->element_type().derived_type_name()]);
+        buffer[element.first->element_type().derived_type_name()]->add_row(element.first->geometry_space().connectivity()[element.second]);
       }
 
       // Flush all buffers and remove empty element regions
@@ -798,7 +1012,7 @@ void Reader::read_boco_unstructured(Region& parent_region)
       throw NotImplemented(FromHere(),"CGNS: pointset_type " + to_str<int>(m_boco.ptset_type) + " for boundary "+m_boco.name+" not supported in CF yet");
   }
 
-  delete_ptr(boco_elems);
+  delete_ptr_array(boco_elems);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -997,19 +1211,14 @@ void Reader::read_flowsolution()
         dict = m_mesh->geometry_fields().handle<Dictionary>();
         break;
       case CGNS_ENUMV( CellCenter ):
-        throw NotImplemented(FromHere(), "CellCenter not implemented yet");
-        datasize = m_zone.total_nbElements;
-        if ( Handle<Component> found = m_mesh->get_child("CellCenter") )
-          dict = found->handle<Dictionary>();
-        else
-          dict = m_mesh->create_discontinuous_space("CellCenter","cf3.mesh.LagrangeP0").handle<Dictionary>();
-        break;
+        // Only vertex solutions are read, cell-centred solutions are skipped
+        CFwarn << "CGNS: Flow solution " << m_flowsol.name << " at CellCenter is skipped" << CFendl;
+        continue;
       default:
         throw NotSupported(FromHere(), "Flow solution Grid location ["+to_str((int)m_flowsol.grid_loc)+"] is not supported");
     }
 
     cf3_assert(datasize == m_zone.total_nbVertices);
-    cf3_assert(datasize == m_mesh->geometry_fields().size());
 
     boost::shared_ptr<math::VariablesDescriptor> variables = allocate_component<math::VariablesDescriptor>("variables");
     variables->options().set("dimension",static_cast<Uint>(m_base.phys_dim));
@@ -1036,18 +1245,24 @@ void Reader::read_flowsolution()
       CALL_CGNS(cg_field_info(m_file.idx,m_base.idx,m_zone.idx,m_flowsol.idx,m_field.idx,&m_field.datatype,field_name_char));
       m_field.name=field_name_char;
 
-      std::vector<double> field_data(datasize);
-      cgsize_t imin = 1;
-      cgsize_t imax = datasize;
-      CALL_CGNS(cg_field_read( m_file.idx,m_base.idx,m_zone.idx,m_flowsol.idx,
-                               field_name_char,CGNS_ENUMV( RealDouble ),&imin,&imax,(void*)(&field_data[0]) ));
+      // Unstructured zones are distributed, structured zones are read entirely
+      std::vector<double> field_data;
+      if (is_not_null(m_hash))
+      {
+        read_local_node_values(boost::bind(&Reader::read_field_range, this, m_field.name, _1, _2, _3), field_data);
+      }
+      else
+      {
+        field_data.resize(datasize);
+        read_field_range(m_field.name, 1, datasize, &field_data[0]);
+      }
 
-      cf3_assert(field_data.size() == flowsol_field.size());
+      cf3_assert(m_zone.nodes_start_idx + field_data.size() <= flowsol_field.size());
       cf3_assert(flowsol_field.nb_vars() == m_flowsol.nbFields);
       cf3_assert(flowsol_field.row_size() == m_flowsol.nbFields);
       for (Uint i=0; i< field_data.size(); ++i)
       {
-        flowsol_field[i][m_field.idx-1] = field_data[i];
+        flowsol_field[m_zone.nodes_start_idx+i][m_field.idx-1] = field_data[i];
       }
     }
   }
@@ -14,11 +14,15 @@
 #include "mesh/CGNS/Shared.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/function.hpp>
+
 #include "mesh/Elements.hpp"
 
 namespace cf3 {
 namespace mesh {
   class Region;
+  class MergedParallelDistribution;
 namespace CGNS {
 
 //////////////////////////////////////////////////////////////////////////////
@@ -31,6 +35,22 @@ private: // typedefs
 
   typedef std::pair<Handle<Elements>,Uint> Region_TableIndex_pair;
 
+  /// The part of a section of the current zone that is read by this process
+  struct SectionElements
+  {
+    std::string name;
+    CGNS_ENUMT( ElementType_t ) type;
+    /// Range of the whole section
+    cgsize_t eBegin;
+    cgsize_t eEnd;
+    /// Range read by this process, empty if begin > end
+    cgsize_t begin;
+    cgsize_t end;
+    /// Element nodes as read from the file, preceded by the element type in MIXED sections
+    std::vector<cgsize_t> nodes;
+    Handle<Region> region;
+  };
+
 public: // functions
 
   /// Contructor
@@ -50,15 +70,33 @@ private: // functions
 
   void read_base(Mesh& parent_region);
   void read_zone(Mesh& parent_region);
+  void create_distribution();
   void read_coordinates_unstructured(Region& parent_region);
   void read_coordinates_structured(Region& parent_region);
-  void read_section(Region& parent_region);
+  void read_section_elements();
+  void create_section(SectionElements& section, Region& parent_region);
   void create_structured_elements(Region& parent_region);
   void read_boco_unstructured(Region& parent_region);
   void read_boco_structured(Region& parent_region);
   void read_flowsolution();
   Uint get_total_nbElements();
 
+  /// Read the values of the local nodes of the current zone, given a function that reads a 1-based range of nodes.
+  /// Each process reads the range it owns, and receives the values of its ghost nodes from their owners.
+  void read_local_node_values(const boost::function<void (cgsize_t, cgsize_t, Real*)>& read_range, std::vector<Real>& values);
+  void read_coordinate_range(const std::string& name, cgsize_t min, cgsize_t max, Real* data);
+  void read_field_range(const std::string& name, cgsize_t min, cgsize_t max, Real* data);
+
+  /// Index in the geometry dictionary of a node of the current zone, given its 0-based CGNS index
+  Uint local_node(const cgsize_t node) const;
+
+  /// Region and row of an element of the current zone read by this process, given its 1-based CGNS index.
+  /// The handle is null if another process reads the element.
+  Region_TableIndex_pair local_element(const cgsize_t element) const;
+
+  /// Region of the section that holds exactly the given range of elements, or a null handle if there is none
+  Handle<Region> section_with_range(const cgsize_t first, const cgsize_t last) const;
+
   Uint structured_node_idx(Uint i, Uint j, Uint k)
   {
     return i + j*m_zone.nbVertices[XX] + k*m_zone.nbVertices[XX]*m_zone.nbVertices[YY];
@@ -70,10 +108,41 @@ private: // functions
 
 private: // data
 
+  enum HashType { NODES=0, ELEMS=1 };
+
+  /// Elements of this process, indexed by their 0-based CGNS index minus m_elements_begin
   std::vector<Region_TableIndex_pair> m_global_to_region;
   Handle<Mesh> m_mesh;
   Uint m_coord_start_idx;
 
+  /// Distribution of the nodes and elements of the current unstructured zone over the processes
+  Handle<MergedParallelDistribution> m_hash;
+
+  /// Part of the mesh read by this process and total number of parts, from the "part" and "nb_parts" options
+  Uint m_part;
+  Uint m_nb_parts;
+
+  /// 0-based range of the elements of the current zone read by this process
+  Uint m_elements_begin;
+  Uint m_elements_end;
+
+  /// Global index of the first node and element of the current zone, as zones are numbered one after the other
+  Uint m_nodes_glb_offset;
+  Uint m_elements_glb_offset;
+
+  /// True if a structured zone was read, whose nodes and elements are numbered afterwards by GlobalNumbering
+  bool m_has_structured_zones;
+
+  /// Sorted 0-based CGNS indices of the nodes of the current zone on this process: the owned range and the ghosts
+  std::vector<Uint> m_node_ids;
+
+  /// For each process, the owned nodes whose values it receives as ghosts
+  std::vector< std::vector<Uint> > m_ghost_sends;
+  /// For each process, the positions in m_node_ids of the ghost nodes whose values it sends
+  std::vector< std::vector<Uint> > m_ghost_positions;
+
+  std::vector<SectionElements> m_sections;
+
 }; // end Reader
 
 
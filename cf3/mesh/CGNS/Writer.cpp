@@ -4,11 +4,18 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <iomanip>
+#include <set>
+
 #include "common/BoostFilesystem.hpp"
 
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
 #include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
 #include "common/Table.hpp"
 
 #include "mesh/CGNS/Writer.hpp"
@@ -18,6 +25,7 @@
 #include "mesh/Field.hpp"
 #include "mesh/Connectivity.hpp"
 #include "mesh/Space.hpp"
+#include "mesh/MeshMetadata.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -38,7 +46,9 @@ Writer::Writer( const std::string& name )
 : MeshWriter(name),
   Shared()
 {
-
+  options().add("time_series", false)
+      .description("Append a step to the file if it exists, instead of overwriting it. "
+                   "The time and iteration of each step are taken from the mesh metadata.");
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -56,11 +66,47 @@ void Writer::write()
 {
   m_fileBasename = m_file_path.base_name(); // filename without extension
 
+  const bool time_series = options().value<bool>("time_series");
+  std::vector<Real> times;
+  std::vector<int> iterations;
+  std::vector<std::string> vertex_solutions;
+  std::vector<std::string> cell_solutions;
 
-  CFdebug << "Opening file " << m_file_path.path() << CFendl;
-  CALL_CGNS(cg_open(m_file_path.path().c_str(),CG_MODE_WRITE,&m_file.idx));
+  if (time_series && boost::filesystem::exists(m_file_path.path()))
+  {
+    CFdebug << "Opening file " << m_file_path.path() << " to append a step" << CFendl;
+    CALL_CGNS(cg_open(m_file_path.path().c_str(),CG_MODE_MODIFY,&m_file.idx));
+    open_time_series(*m_mesh);
+    read_iterative_data(times,iterations,vertex_solutions,cell_solutions);
+  }
+  else
+  {
+    CFdebug << "Opening file " << m_file_path.path() << CFendl;
+    CALL_CGNS(cg_open(m_file_path.path().c_str(),CG_MODE_WRITE,&m_file.idx));
+    write_base(*m_mesh);
+  }
 
-  write_base(*m_mesh);
+  // Each step of a time series has its own solutions
+  std::string suffix;
+  if (time_series)
+  {
+    std::stringstream step;
+    step << "_" << std::setw(4) << std::setfill('0') << times.size()+1;
+    suffix = step.str();
+  }
+  const std::string vertex_solution = "FlowSolution"+suffix;
+  const std::string cell_solution = "FlowSolutionCellCenter"+suffix;
+  const bool vertex_written = write_solution(CGNS_ENUMV( Vertex ), vertex_solution);
+  const bool cell_written = write_solution(CGNS_ENUMV( CellCenter ), cell_solution);
+
+  if (time_series)
+  {
+    times.push_back(m_mesh->metadata().properties().value<Real>("time"));
+    iterations.push_back(m_mesh->metadata().properties().value<Uint>("iter"));
+    vertex_solutions.push_back(vertex_written ? vertex_solution : "Null");
+    cell_solutions.push_back(cell_written ? cell_solution : "Null");
+    write_iterative_data(times,iterations,vertex_solutions,cell_solutions);
+  }
 
   CFdebug << "Closing file " << m_file_path.path() << CFendl;
   CALL_CGNS(cg_close(m_file.idx));
@@ -93,9 +139,7 @@ void Writer::write_zone(const Region& region, const Mesh& mesh)
 
   m_zone.coord_dim = mesh.dimension();
 
-  m_zone.total_nbVertices = 0;
-  BOOST_FOREACH(const common::Table<Real>& coordinates, find_components_recursively_with_tag<common::Table<Real> >(mesh.geometry_fields(),mesh::Tags::coordinates()))
-    m_zone.total_nbVertices += coordinates.size();
+  m_zone.total_nbVertices = number_nodes(mesh);
 
   m_zone.nbElements = region.recursive_filtered_elements_count(IsElementsVolume(),true);
 
@@ -123,10 +167,9 @@ void Writer::write_zone(const Region& region, const Mesh& mesh)
       xCoord = new Real[m_zone.total_nbVertices];
   }
 
-  Uint idx=0;
   BOOST_FOREACH(const common::Table<Real>& coordinates, find_components_recursively_with_tag<common::Table<Real> >(mesh.geometry_fields(),mesh::Tags::coordinates()))
   {
-    m_global_start_idx[&coordinates] = idx;
+    Uint idx = m_global_start_idx[&coordinates];
 
     switch (m_zone.coord_dim)
     {
@@ -184,19 +227,71 @@ void Writer::write_zone(const Region& region, const Mesh& mesh)
     }
   }
 
+  const std::vector<GroupedElements> groups = grouped_elements(region);
+  number_elements(groups);
+
+  m_section.elemStartIdx = 0;
+  m_section.elemEndIdx = 0;
+  BOOST_FOREACH(const GroupedElements& group, groups)
+  {
+    write_section(group);
+  }
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<Writer::GroupedElements> Writer::grouped_elements(const Region& region) const
+{
   GroupsMapType grouped_elements_map;
   BOOST_FOREACH(const Elements& elements, find_components_recursively<Elements>(region))
   {
     grouped_elements_map[elements.parent()->uri().path()].push_back(elements.handle<Elements>());
   }
 
-  m_section.elemStartIdx = 0;
-  m_section.elemEndIdx = 0;
+  std::vector<GroupedElements> groups;
+  groups.reserve(grouped_elements_map.size());
   BOOST_FOREACH(const GroupsMapType::value_type& grouped_elements, grouped_elements_map)
   {
-    write_section(grouped_elements.second);
+    if (IsElementsVolume()(*grouped_elements.second[0]))
+      groups.push_back(grouped_elements.second);
   }
+  BOOST_FOREACH(const GroupsMapType::value_type& grouped_elements, grouped_elements_map)
+  {
+    if (!IsElementsVolume()(*grouped_elements.second[0]))
+      groups.push_back(grouped_elements.second);
+  }
+  return groups;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+Uint Writer::number_nodes(const Mesh& mesh)
+{
+  m_global_start_idx.clear();
+  Uint idx=0;
+  BOOST_FOREACH(const common::Table<Real>& coordinates, find_components_recursively_with_tag<common::Table<Real> >(mesh.geometry_fields(),mesh::Tags::coordinates()))
+  {
+    m_global_start_idx[&coordinates] = idx;
+    idx += coordinates.size();
+  }
+  return idx;
+}
+
+/////////////////////////////////////////////////////////////////////////////
 
+void Writer::number_elements(const std::vector<GroupedElements>& groups)
+{
+  m_elements_start_idx.clear();
+  Uint idx=0;
+  BOOST_FOREACH(const GroupedElements& group, groups)
+  {
+    BOOST_FOREACH(const Handle< Elements const>& elements, group)
+    {
+      m_elements_start_idx[elements.get()] = idx;
+      idx += elements->size();
+    }
+  }
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -266,7 +361,15 @@ void Writer::write_section(const GroupedElements& grouped_elements)
           }
         }
 
+#if CGNS_VERSION >= 4000
+        // Since CGNS 4, MIXED elements are written together with the start of each element
+        std::vector<cgsize_t> offsets(nbElems+1);
+        for (int iElem=0; iElem<=nbElems; ++iElem)
+          offsets[iElem] = iElem*(m_section.elemNodeCount+1);
+        CALL_CGNS(cg_poly_elements_partial_write(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,m_section.elemStartIdx,m_section.elemEndIdx,elemNodes,&offsets[0]));
+#else
         CALL_CGNS(cg_elements_partial_write(m_file.idx,m_base.idx,m_zone.idx,m_section.idx,m_section.elemStartIdx,m_section.elemEndIdx,elemNodes));
+#endif
 
         delete_ptr(elemNodes);
       }
@@ -321,6 +424,214 @@ void Writer::write_section(const GroupedElements& grouped_elements)
 
 //////////////////////////////////////////////////////////////////////////////
 
+void Writer::open_time_series(const Mesh& mesh)
+{
+  CALL_CGNS(cg_nbases(m_file.idx,&m_file.nbBases));
+  if (m_file.nbBases != 1)
+    throw FileFormatError(FromHere(), "CGNS: cannot append a step to "+m_file_path.path()+", which does not have exactly 1 base");
+
+  char name_char[CGNS_CHAR_MAX];
+  m_base.idx = 1;
+  CALL_CGNS(cg_base_read(m_file.idx,m_base.idx,name_char,&m_base.cell_dim,&m_base.phys_dim));
+  m_base.name = name_char;
+  CALL_CGNS(cg_nzones(m_file.idx,m_base.idx,&m_base.nbZones));
+  if (m_base.nbZones != 1)
+    throw FileFormatError(FromHere(), "CGNS: cannot append a step to "+m_file_path.path()+", which does not have exactly 1 zone");
+
+  m_zone.idx = 1;
+  cgsize_t size[3][1];
+  CALL_CGNS(cg_zone_read(m_file.idx,m_base.idx,m_zone.idx,name_char,size[0]));
+  m_zone.name = name_char;
+  m_zone.coord_dim = mesh.dimension();
+  m_zone.total_nbVertices = number_nodes(mesh);
+  m_zone.nbElements = mesh.topology().recursive_filtered_elements_count(IsElementsVolume(),true);
+  if (size[0][0] != m_zone.total_nbVertices || size[1][0] != m_zone.nbElements)
+    throw FileFormatError(FromHere(), "CGNS: cannot append a step to "+m_file_path.path()+", which contains a different grid");
+
+  number_elements(grouped_elements(mesh.topology()));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+bool Writer::write_solution(const CGNS_ENUMT( GridLocation_t ) location, const std::string& name)
+{
+  const Dictionary& geometry = m_mesh->geometry_fields();
+
+  // Fields of the geometry dictionary are vertex data, discontinuous fields are cell data
+  std::vector<Handle<Field const> > fields;
+  std::set<std::string> added_fields;
+  BOOST_FOREACH(const Handle<Field const>& field, m_fields)
+  {
+    if (!added_fields.insert(field->uri().string()).second)
+      continue;
+    const bool vertex_data = &field->dict() == &geometry;
+    if (location == CGNS_ENUMV( Vertex ) && vertex_data)
+      fields.push_back(field);
+    else if (location == CGNS_ENUMV( CellCenter ) && !vertex_data && !field->continuous())
+      fields.push_back(field);
+    else if (location == CGNS_ENUMV( Vertex ) && !vertex_data && field->continuous())
+      CFwarn << "CGNS writer skips field " << field->uri().string() << ", which is neither defined on the geometry nodes nor discontinuous" << CFendl;
+  }
+  if (fields.empty())
+    return false;
+
+  CFdebug << "Writing FlowSolution " << name << CFendl;
+  CALL_CGNS(cg_sol_write(m_file.idx,m_base.idx,m_zone.idx,name.c_str(),location,&m_flowsol.idx));
+
+  const char* components[] = { "X", "Y", "Z" };
+  std::vector<Real> values(location == CGNS_ENUMV( Vertex ) ? m_zone.total_nbVertices : m_zone.nbElements);
+  BOOST_FOREACH(const Handle<Field const>& field_ptr, fields)
+  {
+    const Field& field = *field_ptr;
+    for (Uint var_idx=0; var_idx<field.nb_vars(); ++var_idx)
+    {
+      const Uint var_begin = field.var_offset(var_idx);
+      const Uint var_length = field.var_length(var_idx);
+      for (Uint j=0; j<var_length; ++j)
+      {
+        // Vectors follow the CGNS convention of naming their components with X, Y and Z
+        m_field.name = field.var_name(var_idx);
+        if (var_length > 1)
+          m_field.name += (var_length == static_cast<Uint>(m_zone.coord_dim) ? std::string(components[j]) : to_str(j));
+
+        std::fill(values.begin(),values.end(),0.);
+        if (location == CGNS_ENUMV( Vertex ))
+        {
+          const Uint start_idx = m_global_start_idx[&geometry.coordinates()];
+          for (Uint node=0; node<field.size(); ++node)
+            values[start_idx+node] = field[node][var_begin+j];
+        }
+        else
+        {
+          // Cell value is the average over the points of the element, zero where the field is not defined
+          for (std::map<const Elements*, Uint>::const_iterator it=m_elements_start_idx.begin(); it!=m_elements_start_idx.end(); ++it)
+          {
+            const Elements& elements = *it->first;
+            if (!IsElementsVolume()(elements) || !field.dict().defined_for_entities(elements.handle<Entities const>()))
+              continue;
+            const Connectivity& connectivity = field.dict().space(elements).connectivity();
+            for (Uint e=0; e<elements.size(); ++e)
+            {
+              cf3_assert(it->second+e < values.size());
+              Real value = 0.;
+              BOOST_FOREACH(const Uint point, connectivity[e])
+                value += field[point][var_begin+j];
+              values[it->second+e] = value / static_cast<Real>(connectivity.row_size());
+            }
+          }
+        }
+
+        CALL_CGNS(cg_field_write(m_file.idx,m_base.idx,m_zone.idx,m_flowsol.idx,CGNS_ENUMV( RealDouble ),m_field.name.c_str(),&values[0],&m_field.idx));
+      }
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Length of the names in FlowSolutionPointers, as prescribed by CGNS
+const int pointer_length = 32;
+
+/// Solution names of all steps, as read from an array of ZoneIterativeData
+std::vector<std::string> read_pointers(const int array_idx, const cgsize_t nb_steps)
+{
+  std::vector<char> data(pointer_length*nb_steps);
+  CALL_CGNS(cg_array_read(array_idx,&data[0]));
+  std::vector<std::string> names(nb_steps);
+  for (cgsize_t step=0; step<nb_steps; ++step)
+  {
+    names[step].assign(&data[pointer_length*step],pointer_length);
+    names[step].erase(names[step].find_last_not_of(std::string(" \0",2))+1);
+  }
+  return names;
+}
+
+/// Write solution names of all steps as an array of ZoneIterativeData, padded with blanks
+void write_pointers(const std::string& array_name, const std::vector<std::string>& names)
+{
+  std::vector<char> data(pointer_length*names.size(),' ');
+  for (Uint step=0; step<names.size(); ++step)
+    std::copy(names[step].begin(),names[step].begin()+std::min<std::size_t>(names[step].size(),pointer_length),data.begin()+pointer_length*step);
+  cgsize_t dims[2] = { pointer_length, static_cast<cgsize_t>(names.size()) };
+  CALL_CGNS(cg_array_write(array_name.c_str(),CGNS_ENUMV( Character ),2,dims,&data[0]));
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Writer::read_iterative_data(std::vector<Real>& times, std::vector<int>& iterations,
+                                 std::vector<std::string>& vertex_solutions, std::vector<std::string>& cell_solutions)
+{
+  char name_char[CGNS_CHAR_MAX];
+  int nb_steps;
+  if (cg_biter_read(m_file.idx,m_base.idx,name_char,&nb_steps) != CG_OK)
+    throw FileFormatError(FromHere(), "CGNS: cannot append a step to "+m_file_path.path()+", which has no BaseIterativeData");
+
+  times.assign(nb_steps,0.);
+  iterations.assign(nb_steps,0);
+  vertex_solutions.assign(nb_steps,"Null");
+  cell_solutions.assign(nb_steps,"Null");
+
+  CGNS_ENUMT( DataType_t ) datatype;
+  int data_dim;
+  cgsize_t dims[2];
+  int nb_arrays;
+  CALL_CGNS(cg_goto(m_file.idx,m_base.idx,"BaseIterativeData_t",1,"end"));
+  CALL_CGNS(cg_narrays(&nb_arrays));
+  for (int array_idx=1; array_idx<=nb_arrays; ++array_idx)
+  {
+    CALL_CGNS(cg_array_info(array_idx,name_char,&datatype,&data_dim,dims));
+    if (std::string(name_char) == "TimeValues")
+    {
+      CALL_CGNS(cg_array_read_as(array_idx,CGNS_ENUMV( RealDouble ),&times[0]));
+    }
+    else if (std::string(name_char) == "IterationValues")
+    {
+      CALL_CGNS(cg_array_read_as(array_idx,CGNS_ENUMV( Integer ),&iterations[0]));
+    }
+  }
+
+  if (cg_goto(m_file.idx,m_base.idx,"Zone_t",m_zone.idx,"ZoneIterativeData_t",1,"end") != CG_OK)
+    return;
+  CALL_CGNS(cg_narrays(&nb_arrays));
+  for (int array_idx=1; array_idx<=nb_arrays; ++array_idx)
+  {
+    CALL_CGNS(cg_array_info(array_idx,name_char,&datatype,&data_dim,dims));
+    if (std::string(name_char) == "FlowSolutionPointers")
+      vertex_solutions = read_pointers(array_idx,nb_steps);
+    else if (std::string(name_char) == "FlowSolutionCellCenterPointers")
+      cell_solutions = read_pointers(array_idx,nb_steps);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_iterative_data(const std::vector<Real>& times, const std::vector<int>& iterations,
+                                  const std::vector<std::string>& vertex_solutions, const std::vector<std::string>& cell_solutions)
+{
+  CFdebug << "Writing BaseIterativeData with " << times.size() << " steps" << CFendl;
+  CALL_CGNS(cg_simulation_type_write(m_file.idx,m_base.idx,CGNS_ENUMV( TimeAccurate )));
+  CALL_CGNS(cg_biter_write(m_file.idx,m_base.idx,"BaseIterativeData",static_cast<int>(times.size())));
+  CALL_CGNS(cg_goto(m_file.idx,m_base.idx,"BaseIterativeData_t",1,"end"));
+  cgsize_t nb_steps = times.size();
+  CALL_CGNS(cg_array_write("TimeValues",CGNS_ENUMV( RealDouble ),1,&nb_steps,&times[0]));
+  CALL_CGNS(cg_array_write("IterationValues",CGNS_ENUMV( Integer ),1,&nb_steps,&iterations[0]));
+
+  // Vertex and cell-centred solutions are referred to by separate arrays
+  CALL_CGNS(cg_ziter_write(m_file.idx,m_base.idx,m_zone.idx,"ZoneIterativeData"));
+  CALL_CGNS(cg_goto(m_file.idx,m_base.idx,"Zone_t",m_zone.idx,"ZoneIterativeData_t",1,"end"));
+  if (std::count(vertex_solutions.begin(),vertex_solutions.end(),"Null") != nb_steps)
+    write_pointers("FlowSolutionPointers",vertex_solutions);
+  if (std::count(cell_solutions.begin(),cell_solutions.end(),"Null") != nb_steps)
+    write_pointers("FlowSolutionCellCenterPointers",cell_solutions);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 
 } // CGNS
 } // mesh
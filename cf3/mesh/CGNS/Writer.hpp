@@ -27,6 +27,12 @@ namespace CGNS {
 //////////////////////////////////////////////////////////////////////////////
 
 /// This class defines CGNS mesh format writer
+/// Fields of the geometry dictionary are written as a Vertex FlowSolution, discontinuous fields as a
+/// CellCenter FlowSolution, averaged over the element. Vector variables are split in components with
+/// the suffixes X, Y and Z.
+/// With the option time_series, writing to an existing file appends a step: the grid is not written again,
+/// the solutions of the step are added, and BaseIterativeData and ZoneIterativeData are updated with the time
+/// and iteration of the mesh metadata.
 /// @author Willem Deconinck
 class Mesh_CGNS_API Writer : public MeshWriter, public Shared
 {
@@ -58,7 +64,29 @@ private: // functions
 
   void write_section(const GroupedElements& grouped_elements);
 
-//  void write_boco(const GroupedElements& grouped_elements);
+  /// Groups of elements per region, the groups of volume elements first, so that cells are numbered first
+  std::vector<GroupedElements> grouped_elements(const Region& region) const;
+
+  /// Compute the CGNS index of the first node of each coordinates table, and return the number of nodes
+  Uint number_nodes(const Mesh& mesh);
+
+  /// Compute the CGNS index of the first element of each Elements component
+  void number_elements(const std::vector<GroupedElements>& groups);
+
+  /// Open an existing file to add a step of a time series, checking that it contains the grid of the mesh
+  void open_time_series(const Mesh& mesh);
+
+  /// Write the fields at the given grid location in a new FlowSolution with the given name.
+  /// Returns false, and writes nothing, if there are no fields at this location.
+  bool write_solution(const CGNS_ENUMT( GridLocation_t ) location, const std::string& name);
+
+  /// Read the time, iteration and solution names of the steps already written to the file
+  void read_iterative_data(std::vector<Real>& times, std::vector<int>& iterations,
+                           std::vector<std::string>& vertex_solutions, std::vector<std::string>& cell_solutions);
+
+  /// Write BaseIterativeData and ZoneIterativeData for all steps, replacing the existing ones
+  void write_iterative_data(const std::vector<Real>& times, const std::vector<int>& iterations,
+                            const std::vector<std::string>& vertex_solutions, const std::vector<std::string>& cell_solutions);
 
 private: // data
 
@@ -66,6 +94,10 @@ private: // data
 
   std::map<const common::Table<Real>*, Uint> m_global_start_idx;
 
+  /// 0-based CGNS index of the first element of each Elements component. Cells come first, so for volume
+  /// elements this is also the index in CellCenter solutions.
+  std::map<const Elements*, Uint> m_elements_start_idx;
+
 }; // end Writer
 
 
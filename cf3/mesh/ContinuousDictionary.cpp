@@ -16,7 +16,7 @@
 #include "common/EventHandler.hpp"
 #include "common/StringConversion.hpp"
 #include "common/Tags.hpp"
-#include "common/DynTable.hpp"
+#include "common/CSRTable.hpp"
 #include "common/List.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/PE/CommPattern.hpp"
@@ -309,9 +309,7 @@ void ContinuousDictionary::rebuild_spaces_from_geometry()
 
 void ContinuousDictionary::rebuild_node_to_element_connectivity()
 {
-  // Reserve memory in m_connectivity->array()
-  m_connectivity->array().resize(size());
-
+  // count the number of elements connected to each node
   std::vector<Uint> connectivity_sizes(size());
   boost_foreach (const Handle<Space>& space, spaces() )
   {
@@ -324,19 +322,17 @@ void ContinuousDictionary::rebuild_node_to_element_connectivity()
       }
     }
   }
-  for (Uint i=0; i<size(); ++i)
-  {
-    m_connectivity->array()[i].clear();
-    m_connectivity->array()[i].reserve(connectivity_sizes[i]);
-  }
+  m_connectivity->set_row_sizes(connectivity_sizes);
 
+  // fill m_connectivity, reusing connectivity_sizes as the fill position in each row
+  std::fill(connectivity_sizes.begin(), connectivity_sizes.end(), 0u);
   boost_foreach (const Handle<Space>& space, spaces())
   {
     for (Uint elem_idx=0; elem_idx<space->size(); ++elem_idx)
     {
       boost_foreach (const Uint node_idx, space->connectivity()[elem_idx])
       {
-        m_connectivity->array()[node_idx].push_back(SpaceElem(*space,elem_idx));
+        (*m_connectivity)[node_idx][connectivity_sizes[node_idx]++] = SpaceElem(*space,elem_idx);
       }
     }
   }
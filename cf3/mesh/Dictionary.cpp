@@ -19,7 +19,7 @@
 #include "common/EventHandler.hpp"
 #include "common/StringConversion.hpp"
 #include "common/Tags.hpp"
-#include "common/DynTable.hpp"
+#include "common/CSRTable.hpp"
 #include "common/List.hpp"
 
 #include "common/XML/SignalOptions.hpp"
@@ -69,7 +69,7 @@ Dictionary::Dictionary ( const std::string& name  ) :
   m_glb_to_loc = create_static_component< common::Map<boost::uint64_t,Uint> >(mesh::Tags::map_global_to_local());
   m_glb_to_loc->add_tag(mesh::Tags::map_global_to_local());
 
-  m_connectivity = create_static_component< common::DynTable<SpaceElem> >("element_connectivity");
+  m_connectivity = create_static_component< common::CSRTable<SpaceElem> >("element_connectivity");
 
   options().add("dimension",m_dim).link_to(&m_dim);
 
@@ -510,11 +510,11 @@ Field& Dictionary::create_coordinates()
 
 ////////////////////////////////////////////////////////////////////////////////
 
-DynTable<Uint>& Dictionary::glb_elem_connectivity()
+CSRTable<Uint>& Dictionary::glb_elem_connectivity()
 {
   if (is_null(m_glb_elem_connectivity))
   {
-    m_glb_elem_connectivity = create_static_component< DynTable<Uint> >("glb_elem_connectivity");
+    m_glb_elem_connectivity = create_static_component< CSRTable<Uint> >("glb_elem_connectivity");
     m_glb_elem_connectivity->add_tag("glb_elem_connectivity");
     m_glb_elem_connectivity->resize(size());
   }
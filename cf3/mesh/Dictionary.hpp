@@ -17,7 +17,7 @@ namespace cf3 {
 namespace common {
   class Link;
   template <typename T> class List;
-  template <typename T> class DynTable;
+  template <typename T> class CSRTable;
   namespace PE { class CommPattern; }
 }
 namespace math { class VariablesDescriptor; }
@@ -96,7 +96,7 @@ public: // functions
   const common::Map<boost::uint64_t,Uint>& glb_to_loc() const { return *m_glb_to_loc; }
 
   /// Node to space-element connectivity
-  const common::DynTable<SpaceElem>& connectivity() const { return *m_connectivity; }
+  const common::CSRTable<SpaceElem>& connectivity() const { return *m_connectivity; }
 
   /// Return the comm pattern valid for this field group. Created based on the glb_idx and rank if it didn't exist already
   common::PE::CommPattern& comm_pattern();
@@ -120,7 +120,7 @@ public: // functions
 
   const std::vector< Handle<Field> >& fields() const { return m_fields; }
 
-  common::DynTable<Uint>& glb_elem_connectivity();
+  common::CSRTable<Uint>& glb_elem_connectivity();
 
   void signal_create_field ( common::SignalArgs& node );
 
@@ -165,13 +165,13 @@ protected:
   Handle<common::List<Uint> > m_glb_idx;
   Handle<common::List<Uint> > m_rank;
   Handle<Field> m_coordinates;
-  Handle<common::DynTable<Uint> > m_glb_elem_connectivity;
+  Handle<common::CSRTable<Uint> > m_glb_elem_connectivity;
   Handle<common::PE::CommPattern> m_comm_pattern;
   Handle<common::Map<boost::uint64_t,Uint> > m_glb_to_loc;
   bool m_is_continuous;
 
   /// Connectivity with the element of the space
-  Handle<common::DynTable<SpaceElem> > m_connectivity;
+  Handle<common::CSRTable<SpaceElem> > m_connectivity;
 
 private:
 
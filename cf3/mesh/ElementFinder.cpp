@@ -11,6 +11,7 @@
 
 #include "mesh/ElementFinder.hpp"
 #include "mesh/Dictionary.hpp"
+#include "mesh/Space.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -28,5 +29,24 @@ ElementFinder::ElementFinder(const std::string &name) : common::Component(name)
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Uint ElementFinder::find_elements(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found)
+{
+  const Uint nb_points = coordinates.rows();
+  elements.resize(nb_points);
+  found.assign(nb_points, false);
+  Uint nb_found = 0;
+  RealVector coord(coordinates.cols());
+  for (Uint i=0; i<nb_points; ++i)
+  {
+    coord = coordinates.row(i);
+    found[i] = find_element(coord,elements[i]);
+    if (found[i])
+      ++nb_found;
+  }
+  return nb_found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
@@ -40,6 +40,14 @@ public:
   /// @return if element was found
   virtual bool find_element(const RealVector& target_coord, SpaceElem& element) = 0;
 
+  /// @brief Find which elements contain a batch of coordinates
+  /// @param [in]  coordinates    One coordinate per row
+  /// @param [out] elements       The found element for each row
+  /// @param [out] found          If the element was found for each row
+  /// @return the number of found elements
+  /// @note The default implementation calls find_element for each row
+  virtual Uint find_elements(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found);
+
 protected:
   Handle<Dictionary> m_dict;
 };
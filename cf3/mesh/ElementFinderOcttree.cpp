@@ -88,93 +88,105 @@ bool ElementFinderOcttree::find_element(const RealVector& target_coord, SpaceEle
   for (Uint d=0; d<target_coord.size(); ++d)
     t_coord[d] = target_coord[d];
 
+  // The octtree stores each element in all the cells its bounding box overlaps, so an element containing the point is always found here
+  if (m_octtree->find_element(t_coord,m_tmp))
+  {
+    element = SpaceElem(*const_cast<Space*>(&m_dict->space(*m_tmp.comp)),m_tmp.idx);
+    return true;
+  }
+
+  if (m_closest && find_closest_element(t_coord,element))
+    return true;
+
+  // if arrived here, it means no element has been found in the octtree cell. Give up.
+  CFdebug << "coord " << t_coord.transpose() << " has not been found in the octtree cell" << CFendl;
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool ElementFinderOcttree::find_closest_element(const RealVector& t_coord, SpaceElem& element)
+{
   m_elements_pool.clear();
+  if (!m_octtree->find_octtree_cell(t_coord,m_octtree_idx))
+    return false;
 
-  if (m_octtree->find_octtree_cell(t_coord,m_octtree_idx))
+  // gather the rings up to the first one that contains elements, and some more rings for possible misses
+  Uint pool_size = 0;
+  Uint rings=0;
+  for ( ; pool_size==0 && rings<=m_octtree->max_ring() ; ++rings)
   {
-    Uint pool_size = 0;
-    Uint rings=0;
-    for ( ; pool_size==0 ; ++rings)
-    {
-      pool_size=m_elements_pool.size();
-      m_octtree->gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
-      boost_foreach(const Entity& pool_elem, boost::make_iterator_range(m_elements_pool.begin()+pool_size,m_elements_pool.end()))
-      {
-        cf3_assert(is_not_null(pool_elem.comp));
-        const RealMatrix elem_coordinates = pool_elem.get_coordinates();
-        if (pool_elem.element_type().is_coord_in_element(t_coord,elem_coordinates))
-        {
-          element = SpaceElem(*const_cast<Space*>(&m_dict->space(*pool_elem.comp)),pool_elem.idx);
-          return true;
-        }
-      }
-    }
-    // if arrived here, keep searching
-    // it means no element has been found. The search is enlarged with one more ring, for possible misses.
+    pool_size=m_elements_pool.size();
     m_octtree->gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
-    boost_foreach(const Entity& pool_elem, boost::make_iterator_range(m_elements_pool.begin()+pool_size,m_elements_pool.end()))
-    {
-      cf3_assert(is_not_null(pool_elem.comp));
-      const RealMatrix elem_coordinates = pool_elem.get_coordinates();
-      if (pool_elem.element_type().is_coord_in_element(t_coord,elem_coordinates))
-      {
-        element = SpaceElem(*const_cast<Space*>(&m_dict->space(*pool_elem.comp)),pool_elem.idx);
-        return true;
-      }
-    }
   }
-  if (m_closest)
+  m_octtree->gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
+
+  Real distance=math::Consts::real_max();
+  int closest_idx=-1;
+  RealVector s_elem_centroid = t_coord;
+  for (Uint i=0; i<m_elements_pool.size(); ++i)
   {
-//    std::cout << "didnt find element ... will look more in a pool of " << m_elements_pool.size() << std::endl;
-    Real distance=math::Consts::real_max();
-    int closest_idx=-1;
-    RealVector s_elem_centroid = t_coord;
-    for (Uint i=0; i<m_elements_pool.size(); ++i)
+    m_elements_pool[i].allocate_coordinates(m_coordinates);
+    m_elements_pool[i].put_coordinates(m_coordinates);
+    m_elements_pool[i].element_type().compute_centroid( m_coordinates , s_elem_centroid);
+
+    Real newdistance = math::Functions::get_distance(s_elem_centroid,t_coord);
+    if (newdistance < distance)
     {
-      int elem_dim=m_elements_pool[i].element_type().dimension();
-      m_elements_pool[i].allocate_coordinates(m_coordinates);
-      m_elements_pool[i].put_coordinates(m_coordinates);
-      m_elements_pool[i].element_type().compute_centroid( m_elements_pool[i].get_coordinates() , s_elem_centroid);
+      distance = newdistance;
 
-      Real newdistance = math::Functions::get_distance(s_elem_centroid,t_coord);
-      if (newdistance < distance)
+      for (Uint n=0; n<m_elements_pool[i].element_type().nb_nodes(); ++n)
       {
-        distance = newdistance;
-
-        for (Uint n=0; n<m_elements_pool[i].element_type().nb_nodes(); ++n)
+        newdistance = math::Functions::get_distance(s_elem_centroid,m_coordinates.row(n));
+        if (newdistance>distance)
         {
-          newdistance = math::Functions::get_distance(s_elem_centroid,m_coordinates.row(n));
-          if (newdistance>distance)
-          {
-            closest_idx = i; break;
-          }
+          closest_idx = i; break;
         }
       }
     }
-    if (closest_idx>=0)
-    {
-//      int elem_dim=m_elements_pool[closest_idx].element_type().dimension();
-//      m_elements_pool[closest_idx].allocate_coordinates(m_coordinates);
-//      m_elements_pool[closest_idx].put_coordinates(m_coordinates);
-
-//      Real volume = m_elements_pool[closest_idx].element_type().volume( m_coordinates );
-//      Real dx3 = std::pow(distance, elem_dim);
-//      std::cout << "---> found at distance " << distance << "    vol="<<volume<<"   dx3="<<dx3<< std::endl;
-      element = SpaceElem(*const_cast<Space*>(&m_dict->space(*m_elements_pool[closest_idx].comp)),m_elements_pool[closest_idx].idx);
-      return true;
-    }
   }
-//  std::cout << "---> not found" << std::endl;
-  // if arrived here, it means no element has been found in the octtree cell. Give up.
-  CFdebug << "coord " << t_coord.transpose() << " has not been found in the octtree cell" << CFendl;
+  if (closest_idx>=0)
+  {
+    element = SpaceElem(*const_cast<Space*>(&m_dict->space(*m_elements_pool[closest_idx].comp)),m_elements_pool[closest_idx].idx);
+    return true;
+  }
   return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
 
-//  bool found = m_octtree->find_element(target_coord,m_tmp);
-//  if (!found)
-//    return false;
+Uint ElementFinderOcttree::find_elements(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found)
+{
+  cf3_assert(m_octtree);
 
-//  element = SpaceElem(*const_cast<Space*>(&m_dict->space(*m_tmp.comp)),m_tmp.idx);
-//  return true;
+  if (m_octtree->is_created() == false)
+      m_octtree->create_octtree();
+
+  const Uint nb_points = coordinates.rows();
+  Uint nb_found = m_octtree->find_elements(coordinates,m_found_entities);
+
+  elements.resize(nb_points);
+  found.assign(nb_points,false);
+  RealVector t_coord(m_octtree->dimension());
+  t_coord.setZero();
+  for (Uint i=0; i<nb_points; ++i)
+  {
+    const Entity& entity = m_found_entities[i];
+    if (is_not_null(entity.comp))
+    {
+      elements[i] = SpaceElem(*const_cast<Space*>(&m_dict->space(*entity.comp)),entity.idx);
+      found[i] = true;
+    }
+    else if (m_closest)
+    {
+      for (Uint d=0; d<(Uint)coordinates.cols(); ++d)
+        t_coord[d] = coordinates(i,d);
+      found[i] = find_closest_element(t_coord,elements[i]);
+      if (found[i])
+        ++nb_found;
+    }
+  }
+  return nb_found;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
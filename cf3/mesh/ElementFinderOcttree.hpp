@@ -32,12 +32,19 @@ public:
 
   virtual bool find_element(const RealVector& target_coord, SpaceElem& element);
 
+  /// Locates all points in one threaded pass through the octtree, only the points that are not
+  /// inside any element go through find_element to look for the closest element.
+  virtual Uint find_elements(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector<bool>& found);
+
   EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
 private:
 
   void configure_octtree();
 
+  /// Look for the element closest to t_coord in the cells around it
+  bool find_closest_element(const RealVector& t_coord, SpaceElem& element);
+
 private:
 
   Handle<Octtree> m_octtree;
@@ -48,6 +55,9 @@ private:
 
   std::vector<Entity> m_elements_pool;
 
+  /// elements found by the batched search
+  std::vector<Entity> m_found_entities;
+
   RealMatrix m_coordinates;
 
 
@@ -89,6 +89,18 @@ std::vector<Handle< Component > > FaceCellConnectivity::used()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+std::vector<Handle< Component const > > FaceCellConnectivity::used() const
+{
+  std::vector<Handle< Component const > > vec;
+  boost_foreach( const Link& link, find_components<Link>(*m_used_components) )
+  {
+    vec.push_back(link.follow());
+  }
+  return vec;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void FaceCellConnectivity::add_used (Component& used_comp)
 {
   bool found = false;
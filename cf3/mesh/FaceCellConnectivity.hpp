@@ -93,6 +93,8 @@ public:
 
   std::vector<Handle< Component > > used();
 
+  std::vector<Handle< Component const > > used() const;
+
   void add_used (Component& used_comp);
 
 private: // data
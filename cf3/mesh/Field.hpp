@@ -124,6 +124,13 @@ public: // functions
 
   void synchronize();
 
+  /// Start synchronizing the ghost values, without waiting for the data to arrive.
+  /// Owned values must not change and ghost values must not be used until finish_synchronize() is called.
+  void start_synchronize();
+
+  /// Wait for a synchronization started with start_synchronize() to complete
+  void finish_synchronize();
+
   math::VariablesDescriptor& descriptor() const { return *m_descriptor; }
 
   void set_descriptor(math::VariablesDescriptor& descriptor);
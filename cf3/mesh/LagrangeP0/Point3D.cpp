@@ -24,15 +24,21 @@ common::ComponentBuilder < ElementTypeT<Point3D>, ElementType , LibLagrangeP0 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Point3D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0);
     connectivity.stride.assign(1, 1);
     connectivity.nodes = boost::assign::list_of(0);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Point3D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
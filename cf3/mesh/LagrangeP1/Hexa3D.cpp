@@ -23,23 +23,18 @@ namespace LagrangeP1 {
 
 ////////////////////////////////////////////////////////////////////////////////
 
-Eigen::Matrix<Real,Hexa3D::nb_nodes,1> Hexa3D::m_shapeFunc;
-Eigen::Matrix<Real,Hexa3D::nb_nodes,Hexa3D::dimensionality> Hexa3D::m_shapeFuncDerivs;
-Eigen::Matrix<Real,Hexa3D::dimension,1> Hexa3D::m_vec1;
-Eigen::Matrix<Real,Hexa3D::dimension,1> Hexa3D::m_vec2;
-
 common::ComponentBuilder < ElementTypeT<Hexa3D>, ElementType , LibLagrangeP1 >
    Hexa3D_Builder(LibLagrangeP1::library_namespace()+"."+Hexa3D::type_name());
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Hexa3D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0)(4)(8)(12)(16)(20);
-    connectivity.stride.assign(nb_faces, 4);
+    connectivity.stride.assign(Hexa3D::nb_faces, 4);
     connectivity.nodes = boost::assign::list_of
         (0)(3)(2)(1)
         (4)(5)(6)(7)
@@ -47,7 +42,13 @@ const cf3::mesh::ElementType::FaceConnectivity& Hexa3D::faces()
         (1)(2)(6)(5)
         (3)(7)(6)(2)
         (0)(4)(7)(3);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Hexa3D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -401,92 +402,95 @@ void Hexa3D::compute_plane_jacobian_normal(const MappedCoordsT& mapped_coord, co
   const Real c1 = 1. + zta;
   const Real c2 = 1. - zta;
 
+  Eigen::Matrix<Real,nb_nodes,dimensionality> sf_derivs;
+  CoordsT vec1, vec2;
+
   switch (orientation)
   {
     case KSI:
 
-      m_shapeFuncDerivs(0,ETA) = -a2*c2;
-      m_shapeFuncDerivs(1,ETA) = -a1*c2;
-      m_shapeFuncDerivs(2,ETA) =  a1*c2;
-      m_shapeFuncDerivs(3,ETA) =  a2*c2;
-      m_shapeFuncDerivs(4,ETA) = -a2*c1;
-      m_shapeFuncDerivs(5,ETA) = -a1*c1;
-      m_shapeFuncDerivs(6,ETA) =  a1*c1;
-      m_shapeFuncDerivs(7,ETA) =  a2*c1;
-
-      m_shapeFuncDerivs(0,ZTA) = -a2*b2;
-      m_shapeFuncDerivs(1,ZTA) = -a1*b2;
-      m_shapeFuncDerivs(2,ZTA) = -a1*b1;
-      m_shapeFuncDerivs(3,ZTA) = -a2*b1;
-      m_shapeFuncDerivs(4,ZTA) =  b2*a2;
-      m_shapeFuncDerivs(5,ZTA) =  b2*a1;
-      m_shapeFuncDerivs(6,ZTA) =  b1*a1;
-      m_shapeFuncDerivs(7,ZTA) =  b1*a2;
-
-      m_vec1 = m_shapeFuncDerivs(0,ETA)*(nodes.row(0));
-      m_vec2 = m_shapeFuncDerivs(0,ZTA)*(nodes.row(0));
+      sf_derivs(0,ETA) = -a2*c2;
+      sf_derivs(1,ETA) = -a1*c2;
+      sf_derivs(2,ETA) =  a1*c2;
+      sf_derivs(3,ETA) =  a2*c2;
+      sf_derivs(4,ETA) = -a2*c1;
+      sf_derivs(5,ETA) = -a1*c1;
+      sf_derivs(6,ETA) =  a1*c1;
+      sf_derivs(7,ETA) =  a2*c1;
+
+      sf_derivs(0,ZTA) = -a2*b2;
+      sf_derivs(1,ZTA) = -a1*b2;
+      sf_derivs(2,ZTA) = -a1*b1;
+      sf_derivs(3,ZTA) = -a2*b1;
+      sf_derivs(4,ZTA) =  b2*a2;
+      sf_derivs(5,ZTA) =  b2*a1;
+      sf_derivs(6,ZTA) =  b1*a1;
+      sf_derivs(7,ZTA) =  b1*a2;
+
+      vec1 = sf_derivs(0,ETA)*(nodes.row(0));
+      vec2 = sf_derivs(0,ZTA)*(nodes.row(0));
       for (Uint in = 1; in < 8; ++in)
       {
-        m_vec1 += m_shapeFuncDerivs(in,ETA)*(nodes.row(in));
-        m_vec2 += m_shapeFuncDerivs(in,ZTA)*(nodes.row(in));
+        vec1 += sf_derivs(in,ETA)*(nodes.row(in));
+        vec2 += sf_derivs(in,ZTA)*(nodes.row(in));
       }
       break;
 
     case ETA:
 
-      m_shapeFuncDerivs(0,ZTA) = -a2*b2;
-      m_shapeFuncDerivs(1,ZTA) = -a1*b2;
-      m_shapeFuncDerivs(2,ZTA) = -a1*b1;
-      m_shapeFuncDerivs(3,ZTA) = -a2*b1;
-      m_shapeFuncDerivs(4,ZTA) =  b2*a2;
-      m_shapeFuncDerivs(5,ZTA) =  b2*a1;
-      m_shapeFuncDerivs(6,ZTA) =  b1*a1;
-      m_shapeFuncDerivs(7,ZTA) =  b1*a2;
-
-      m_shapeFuncDerivs(0,KSI) = -b2*c2;
-      m_shapeFuncDerivs(1,KSI) =  b2*c2;
-      m_shapeFuncDerivs(2,KSI) =  b1*c2;
-      m_shapeFuncDerivs(3,KSI) = -b1*c2;
-      m_shapeFuncDerivs(4,KSI) = -b2*c1;
-      m_shapeFuncDerivs(5,KSI) =  b2*c1;
-      m_shapeFuncDerivs(6,KSI) =  b1*c1;
-      m_shapeFuncDerivs(7,KSI) = -b1*c1;
-
-      m_vec1 = m_shapeFuncDerivs(0,ZTA)*(nodes.row(0));
-      m_vec2 = m_shapeFuncDerivs(0,KSI)*(nodes.row(0));
+      sf_derivs(0,ZTA) = -a2*b2;
+      sf_derivs(1,ZTA) = -a1*b2;
+      sf_derivs(2,ZTA) = -a1*b1;
+      sf_derivs(3,ZTA) = -a2*b1;
+      sf_derivs(4,ZTA) =  b2*a2;
+      sf_derivs(5,ZTA) =  b2*a1;
+      sf_derivs(6,ZTA) =  b1*a1;
+      sf_derivs(7,ZTA) =  b1*a2;
+
+      sf_derivs(0,KSI) = -b2*c2;
+      sf_derivs(1,KSI) =  b2*c2;
+      sf_derivs(2,KSI) =  b1*c2;
+      sf_derivs(3,KSI) = -b1*c2;
+      sf_derivs(4,KSI) = -b2*c1;
+      sf_derivs(5,KSI) =  b2*c1;
+      sf_derivs(6,KSI) =  b1*c1;
+      sf_derivs(7,KSI) = -b1*c1;
+
+      vec1 = sf_derivs(0,ZTA)*(nodes.row(0));
+      vec2 = sf_derivs(0,KSI)*(nodes.row(0));
       for (Uint in = 1; in < 8; ++in)
       {
-        m_vec1 += m_shapeFuncDerivs(in,ZTA)*(nodes.row(in));
-        m_vec2 += m_shapeFuncDerivs(in,KSI)*(nodes.row(in));
+        vec1 += sf_derivs(in,ZTA)*(nodes.row(in));
+        vec2 += sf_derivs(in,KSI)*(nodes.row(in));
       }
       break;
 
     case ZTA:
 
-      m_shapeFuncDerivs(0,KSI) = -b2*c2;
-      m_shapeFuncDerivs(1,KSI) =  b2*c2;
-      m_shapeFuncDerivs(2,KSI) =  b1*c2;
-      m_shapeFuncDerivs(3,KSI) = -b1*c2;
-      m_shapeFuncDerivs(4,KSI) = -b2*c1;
-      m_shapeFuncDerivs(5,KSI) =  b2*c1;
-      m_shapeFuncDerivs(6,KSI) =  b1*c1;
-      m_shapeFuncDerivs(7,KSI) = -b1*c1;
-
-      m_shapeFuncDerivs(0,ETA) = -a2*c2;
-      m_shapeFuncDerivs(1,ETA) = -a1*c2;
-      m_shapeFuncDerivs(2,ETA) =  a1*c2;
-      m_shapeFuncDerivs(3,ETA) =  a2*c2;
-      m_shapeFuncDerivs(4,ETA) = -a2*c1;
-      m_shapeFuncDerivs(5,ETA) = -a1*c1;
-      m_shapeFuncDerivs(6,ETA) =  a1*c1;
-      m_shapeFuncDerivs(7,ETA) =  a2*c1;
-
-      m_vec1 = m_shapeFuncDerivs(0,KSI)*(nodes.row(0));
-      m_vec2 = m_shapeFuncDerivs(0,ETA)*(nodes.row(0));
+      sf_derivs(0,KSI) = -b2*c2;
+      sf_derivs(1,KSI) =  b2*c2;
+      sf_derivs(2,KSI) =  b1*c2;
+      sf_derivs(3,KSI) = -b1*c2;
+      sf_derivs(4,KSI) = -b2*c1;
+      sf_derivs(5,KSI) =  b2*c1;
+      sf_derivs(6,KSI) =  b1*c1;
+      sf_derivs(7,KSI) = -b1*c1;
+
+      sf_derivs(0,ETA) = -a2*c2;
+      sf_derivs(1,ETA) = -a1*c2;
+      sf_derivs(2,ETA) =  a1*c2;
+      sf_derivs(3,ETA) =  a2*c2;
+      sf_derivs(4,ETA) = -a2*c1;
+      sf_derivs(5,ETA) = -a1*c1;
+      sf_derivs(6,ETA) =  a1*c1;
+      sf_derivs(7,ETA) =  a2*c1;
+
+      vec1 = sf_derivs(0,KSI)*(nodes.row(0));
+      vec2 = sf_derivs(0,ETA)*(nodes.row(0));
       for (Uint in = 1; in < 8; ++in)
       {
-        m_vec1 += m_shapeFuncDerivs(in,KSI)*(nodes.row(in));
-        m_vec2 += m_shapeFuncDerivs(in,ETA)*(nodes.row(in));
+        vec1 += sf_derivs(in,KSI)*(nodes.row(in));
+        vec2 += sf_derivs(in,ETA)*(nodes.row(in));
       }
       break;
 
@@ -495,7 +499,7 @@ void Hexa3D::compute_plane_jacobian_normal(const MappedCoordsT& mapped_coord, co
   }
 
   // compute normal
-  math::Functions::cross_product(m_vec1,m_vec2,result);
+  math::Functions::cross_product(vec1,vec2,result);
   result *= 0.015625;
 }
 ////////////////////////////////////////////////////////////////////////////////
@@ -27,16 +27,22 @@ common::ComponentBuilder < ElementTypeT<Line1D>, ElementType , LibLagrangeP1 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Line1D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0)(1);
-    connectivity.stride.assign(nb_faces, 1);
+    connectivity.stride.assign(Line1D::nb_faces, 1);
     connectivity.nodes = boost::assign::list_of(0)
                                                (1);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Line1D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -27,15 +27,21 @@ common::ComponentBuilder < ElementTypeT<Line2D>, ElementType , LibLagrangeP1 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Line2D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0);
     connectivity.stride.assign(1, 2);
     connectivity.nodes = boost::assign::list_of(0)(1);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Line2D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -29,7 +29,7 @@ common::ComponentBuilder < ElementTypeT<Line3D>, ElementType , LibLagrangeP1 >
 
 const cf3::mesh::ElementType::FaceConnectivity& Line3D::faces()
 {
-  static ElementType::FaceConnectivity connectivity;
+  static const ElementType::FaceConnectivity connectivity;
   return connectivity;
 }
 
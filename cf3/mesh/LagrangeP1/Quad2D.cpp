@@ -30,18 +30,24 @@ common::ComponentBuilder < ElementTypeT<Quad2D>, ElementType , LibLagrangeP1 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Quad2D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0)(2)(4)(6);
-    connectivity.stride.assign(nb_faces, 2);
+    connectivity.stride.assign(Quad2D::nb_faces, 2);
     connectivity.nodes = boost::assign::list_of(0)(1)
                                                (1)(2)
                                                (2)(3)
                                                (3)(0);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Quad2D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -87,19 +93,17 @@ bool Quad2D::is_coord_in_element(const CoordsT& coord, const NodesT& nodes)
     return false;
 
 
-  m_D <<
-      nodes.col(XX).maxCoeff()-nodes.col(XX).minCoeff(),
-      nodes.col(YY).maxCoeff()-nodes.col(YY).minCoeff();
-  m_scale = 1./m_D.minCoeff();
+  const Real scale = 1./std::min(nodes.col(XX).maxCoeff()-nodes.col(XX).minCoeff(),
+                                 nodes.col(YY).maxCoeff()-nodes.col(YY).minCoeff());
 
-  if (scp(nodes.row(0),nodes.row(Quad2D::nb_nodes-1),coord,m_scale) * scp(nodes.row(0),coord,nodes.row(1),m_scale) < -tolerance)
+  if (scp(nodes.row(0),nodes.row(Quad2D::nb_nodes-1),coord,scale) * scp(nodes.row(0),coord,nodes.row(1),scale) < -tolerance)
       return false;
   for (Uint i=1; i<Quad2D::nb_nodes-1; ++i)
   {
-    if (scp(nodes.row(i),nodes.row(i-1),coord,m_scale) * scp(nodes.row(i),coord,nodes.row(i+1),m_scale) < -tolerance)
+    if (scp(nodes.row(i),nodes.row(i-1),coord,scale) * scp(nodes.row(i),coord,nodes.row(i+1),scale) < -tolerance)
         return false;
   }
-  if (scp(nodes.row(Quad2D::nb_nodes-1),nodes.row(Quad2D::nb_nodes-2),coord,m_scale) * scp(nodes.row(Quad2D::nb_nodes-1),coord,nodes.row(0),m_scale) < -tolerance)
+  if (scp(nodes.row(Quad2D::nb_nodes-1),nodes.row(Quad2D::nb_nodes-2),coord,scale) * scp(nodes.row(Quad2D::nb_nodes-1),coord,nodes.row(0),scale) < -tolerance)
       return false;
 
   return true;
@@ -111,22 +115,20 @@ void Quad2D::compute_mapped_coordinate(const CoordsT& coord, const NodesT& nodes
 
   // Description found in http://hal.archives-ouvertes.fr/docs/00/12/27/30/PDF/exact_interpolation.pdf
 
-  m_D <<
-      nodes.col(XX).maxCoeff()-nodes.col(XX).minCoeff(),
-      nodes.col(YY).maxCoeff()-nodes.col(YY).minCoeff();
-  m_scale = 1./m_D.minCoeff();
+  const Real scale = 1./std::min(nodes.col(XX).maxCoeff()-nodes.col(XX).minCoeff(),
+                                 nodes.col(YY).maxCoeff()-nodes.col(YY).minCoeff());
 
-  const Real x = coord[XX] * m_scale;
-  const Real y = coord[YY] * m_scale;
+  const Real x = coord[XX] * scale;
+  const Real y = coord[YY] * scale;
 
-  const Real xn1 = nodes(0, XX)  * m_scale ;
-  const Real yn1 = nodes(0, YY)  * m_scale ;
-  const Real xn2 = nodes(1, XX)  * m_scale ;
-  const Real yn2 = nodes(1, YY)  * m_scale ;
-  const Real xn3 = nodes(2, XX)  * m_scale ;
-  const Real yn3 = nodes(2, YY)  * m_scale ;
-  const Real xn4 = nodes(3, XX)  * m_scale ;
-  const Real yn4 = nodes(3, YY)  * m_scale ;
+  const Real xn1 = nodes(0, XX)  * scale ;
+  const Real yn1 = nodes(0, YY)  * scale ;
+  const Real xn2 = nodes(1, XX)  * scale ;
+  const Real yn2 = nodes(1, YY)  * scale ;
+  const Real xn3 = nodes(2, XX)  * scale ;
+  const Real yn3 = nodes(2, YY)  * scale ;
+  const Real xn4 = nodes(3, XX)  * scale ;
+  const Real yn4 = nodes(3, YY)  * scale ;
 
   const Real a0 = 0.25*( (xn1+xn2) + (xn3+xn4) );
   const Real a1 = 0.25*( (xn2-xn1) + (xn3-xn4) );
@@ -349,11 +351,6 @@ void Quad2D::compute_plane_jacobian_normal(const MappedCoordsT& mapped_coord, co
 
 ////////////////////////////////////////////////////////////////////////////////
 
-RealVector2 Quad2D::m_D;
-Real Quad2D::m_scale;
-
-////////////////////////////////////////////////////////////////////////////////
-
 } // LagrangeP1
 } // mesh
 } // cf3
@@ -24,15 +24,21 @@ common::ComponentBuilder < ElementTypeT<Quad3D>, ElementType , LibLagrangeP1 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Quad3D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0);
-    connectivity.stride.assign(1, nb_nodes);
+    connectivity.stride.assign(1, Quad3D::nb_nodes);
     connectivity.nodes = boost::assign::list_of(0)(1)(2)(3);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Quad3D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -27,18 +27,24 @@ common::ComponentBuilder < ElementTypeT<Tetra3D>, ElementType , LibLagrangeP1 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Tetra3D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0)(3)(6)(9);
-    connectivity.stride.assign(nb_faces, 3);
+    connectivity.stride.assign(Tetra3D::nb_faces, 3);
     connectivity.nodes = boost::assign::list_of(0)(2)(1)
                                                (0)(1)(3)
                                                (1)(2)(3)
                                                (0)(3)(2);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Tetra3D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -54,17 +54,23 @@ Real jacobian_determinant_helper(const Triag2D::NodesT& nodes)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Triag2D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0)(2)(4);
-    connectivity.stride.assign(nb_faces, 2);
+    connectivity.stride.assign(Triag2D::nb_faces, 2);
     connectivity.nodes = boost::assign::list_of(0)(1)
                                                (1)(2)
                                                (2)(0);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Triag2D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -40,15 +40,21 @@ Real jacobian_determinant_helper(const Triag3D::NodesT& nodes)
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Triag3D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0);
-    connectivity.stride.assign(1, nb_nodes);
+    connectivity.stride.assign(1, Triag3D::nb_nodes);
     connectivity.nodes = boost::assign::list_of(0)(1)(2);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Triag3D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
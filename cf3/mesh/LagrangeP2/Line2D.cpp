@@ -24,15 +24,21 @@ common::ComponentBuilder < ElementTypeT<Line2D>, ElementType , LibLagrangeP2 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Line2D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0);
-    connectivity.stride.assign(1, nb_nodes);
+    connectivity.stride.assign(1, Line2D::nb_nodes);
     connectivity.nodes = boost::assign::list_of(0)(1)(2);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Line2D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -63,14 +63,6 @@ struct Mesh_LagrangeP2_API Quad2D : public ElementTypeBase<Quad2D,Quad2D_traits>
 
 
   //@}
-
-private:
-
-  static Eigen::Matrix<Real,nb_nodes,1> m_shapeFunc;
-  static Eigen::Matrix<Real,nb_nodes,dimensionality> m_shapeFuncDerivs;
-
-  static RealVector2 m_D;
-  static Real m_scale;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
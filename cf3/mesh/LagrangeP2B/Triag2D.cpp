@@ -27,17 +27,23 @@ common::ComponentBuilder < ElementTypeT<Triag2D>, ElementType , LibLagrangeP2B >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Triag2D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0)(3)(6);
-    connectivity.stride.assign(nb_faces, 3);
+    connectivity.stride.assign(Triag2D::nb_faces, 3);
     connectivity.nodes = boost::assign::list_of(0)(1)(3)
                                                (1)(2)(4)
                                                (2)(0)(5);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Triag2D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
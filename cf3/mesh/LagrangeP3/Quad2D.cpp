@@ -25,18 +25,24 @@ common::ComponentBuilder < ElementTypeT<Quad2D>, ElementType , LibLagrangeP3 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Quad2D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0)(4)(8)(12);
-    connectivity.stride.assign(nb_faces, 4);
+    connectivity.stride.assign(Quad2D::nb_faces, 4);
     connectivity.nodes = boost::assign::list_of(0)(4)(5)(1)
                                                (1)(6)(7)(2)
                                                (2)(8)(9)(3)
                                                (3)(10)(11)(0);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Quad2D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -25,17 +25,23 @@ common::ComponentBuilder < ElementTypeT<Triag2D>, ElementType , LibLagrangeP3 >
 
 ////////////////////////////////////////////////////////////////////////////////
 
-const cf3::mesh::ElementType::FaceConnectivity& Triag2D::faces()
+namespace
 {
-  static ElementType::FaceConnectivity connectivity;
-  if(connectivity.displs.empty())
+  ElementType::FaceConnectivity make_faces()
   {
+    ElementType::FaceConnectivity connectivity;
     connectivity.displs = boost::assign::list_of(0)(4)(8);
-    connectivity.stride.assign(nb_faces, 4);
+    connectivity.stride.assign(Triag2D::nb_faces, 4);
     connectivity.nodes = boost::assign::list_of(0)(1)(3)(4)
                                                (1)(2)(5)(6)
                                                (2)(0)(7)(8);
+    return connectivity;
   }
+}
+
+const cf3::mesh::ElementType::FaceConnectivity& Triag2D::faces()
+{
+  static const ElementType::FaceConnectivity connectivity = make_faces();
   return connectivity;
 }
 
@@ -82,7 +82,8 @@ void LoadMesh::update_list_of_available_readers()
     ("cf3.mesh.CGNS.Reader")
   #endif
     ("cf3.mesh.gmsh.Reader")
-    ("cf3.mesh.neu.Reader");
+    ("cf3.mesh.neu.Reader")
+    ("cf3.mesh.cf3mesh.Reader");
 
   boost_foreach(const std::string& reader_name, known_readers)
   {
@@ -49,6 +49,10 @@ public: // functions
 
   virtual std::vector<std::string> get_extensions() = 0;
 
+  /// True if writing makes collective calls on the communicator, so all processes
+  /// must call the writer together, from their main thread
+  virtual bool is_collective() { return false; }
+
 //  virtual void write_from_to(const Mesh& mesh, const common::URI& filepath) = 0;
 
   virtual void execute();
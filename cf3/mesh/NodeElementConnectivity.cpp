@@ -5,7 +5,7 @@
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
 #include "common/FindComponents.hpp"
-#include "common/DynTable.hpp"
+#include "common/CSRTable.hpp"
 #include "common/Link.hpp"
 #include "common/Builder.hpp"
 
@@ -31,7 +31,7 @@ NodeElementConnectivity::NodeElementConnectivity ( const std::string& name ) :
 {
   m_nodes = create_static_component<common::Link>(mesh::Tags::nodes());
   m_elements = create_static_component<UnifiedData>("elements");
-  m_connectivity = create_static_component<DynTable<Uint> >(mesh::Tags::connectivity_table());
+  m_connectivity = create_static_component<CSRTable<Uint> >(mesh::Tags::connectivity_table());
   mark_basic();
 }
 
@@ -70,7 +70,7 @@ void NodeElementConnectivity::build_connectivity()
   cf3_assert(m_nodes->follow());
   Dictionary const& nodes = *Handle<Dictionary>(m_nodes->follow());
 
-  // Reserve memory in m_connectivity->array()
+  // count the number of elements connected to each node
   std::vector<Uint> connectivity_sizes(nodes.size());
   boost_foreach(Handle<Component> elements_comp, m_elements->components() )
   {
@@ -84,13 +84,10 @@ void NodeElementConnectivity::build_connectivity()
       }
     }
   }
-  Uint i(0);
-  boost_foreach (DynTable<Uint>::Row row, m_connectivity->array() )
-  {
-    row.reserve(connectivity_sizes[i++]);
-  }
+  m_connectivity->set_row_sizes(connectivity_sizes);
 
-  // fill m_connectivity->array()
+  // fill m_connectivity, reusing connectivity_sizes as the fill position in each row
+  std::fill(connectivity_sizes.begin(), connectivity_sizes.end(), 0u);
   Uint glb_elem_idx = 0;
   boost_foreach(Handle<Component> elements_comp, m_elements->components() )
   {
@@ -99,7 +96,7 @@ void NodeElementConnectivity::build_connectivity()
     {
       boost_foreach (const Uint node_idx, elem_nodes)
       {
-        m_connectivity->array()[node_idx].push_back(glb_elem_idx);
+        (*m_connectivity)[node_idx][connectivity_sizes[node_idx]++] = glb_elem_idx;
       }
       ++glb_elem_idx;
     }
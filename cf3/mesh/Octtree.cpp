@@ -8,7 +8,12 @@
 
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
+#include "common/BasicExceptions.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/Builder.hpp"
@@ -49,6 +54,204 @@ cf3::common::ComponentBuilder < Octtree, Component, LibMesh > Octtree_Builder;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+/// Minimum amount of elements or points handled by each thread
+const Uint min_items_per_thread = 2048;
+
+/// Number of threads to use for nb_items, limited by the nb_threads option of the environment
+Uint nb_threads_for(const Uint nb_items)
+{
+  const Uint requested_threads = Core::instance().environment().options().value<Uint>("nb_threads");
+  return std::max(1u, std::min(requested_threads, nb_items/min_items_per_thread));
+}
+
+/// Start of the chunk of [0,nb_items) handled by thread t
+Uint chunk_begin(const Uint nb_items, const Uint nb_threads, const Uint t)
+{
+  return static_cast<Uint>((static_cast<unsigned long long>(nb_items)*t)/nb_threads);
+}
+
+/// First error raised by the chunks of run_chunked
+struct ChunkErrors
+{
+  void store(const std::string& message)
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    if (m_message.empty())
+      m_message = message;
+  }
+
+  void rethrow() const
+  {
+    if (!m_message.empty())
+      throw ParallelError(FromHere(), "Error in threaded octtree operation: " + m_message);
+  }
+
+  boost::mutex m_mutex;
+  std::string m_message;
+};
+
+/// Call functor(t, begin, end), storing the error instead of letting it escape the thread
+template<typename FunctorT>
+void run_chunk(const FunctorT& functor, const Uint t, const Uint begin, const Uint end, ChunkErrors& errors)
+{
+  try
+  {
+    functor(t, begin, end);
+  }
+  catch (std::exception& e)
+  {
+    errors.store(e.what());
+  }
+  catch (...)
+  {
+    errors.store("unknown error");
+  }
+}
+
+/// Call functor(t, begin, end) for each thread t and its chunk of [0,nb_items). Chunk 0 is handled by the calling thread.
+/// Errors of the chunks are rethrown by the calling thread once all threads are done.
+template<typename FunctorT>
+void run_chunked(const Uint nb_items, const Uint nb_threads, const FunctorT& functor)
+{
+  if (nb_threads == 1)
+  {
+    functor(0, 0, nb_items);
+    return;
+  }
+
+  ChunkErrors errors;
+  boost::thread_group threads;
+  for (Uint t=1; t<nb_threads; ++t)
+    threads.create_thread(boost::bind(&run_chunk<FunctorT>, boost::cref(functor), t, chunk_begin(nb_items,nb_threads,t), chunk_begin(nb_items,nb_threads,t+1), boost::ref(errors)));
+  run_chunk(functor, 0, 0, chunk_begin(nb_items,nb_threads,1), errors);
+  threads.join_all();
+  errors.rethrow();
+}
+
+/// Computes the centroid cell and the bounding box of a range of elements
+struct ElementBoxes
+{
+  ElementBoxes(const std::vector<Entity>& elements, const math::BoundingBox& bounding_box, const std::vector<Real>& D, const std::vector<Uint>& N, const Uint dim,
+               std::vector<Uint>& centroid_cells, std::vector<Real>& boxes) :
+    m_elements(elements), m_bounding_box(bounding_box), m_D(D), m_N(N), m_dim(dim), m_centroid_cells(centroid_cells), m_boxes(boxes)
+  {
+  }
+
+  void operator()(const Uint, const Uint begin, const Uint end) const
+  {
+    RealMatrix coordinates;
+    RealVector centroid(m_dim);
+    const Entities* comp = nullptr;
+    for (Uint e=begin; e<end; ++e)
+    {
+      const Entity& element = m_elements[e];
+      if (element.comp != comp)
+      {
+        comp = element.comp;
+        element.allocate_coordinates(coordinates);
+      }
+      element.put_coordinates(coordinates);
+      element.element_type().compute_centroid(coordinates,centroid);
+
+      // cell index in the flat storage, with at least one cell in each direction
+      Uint cell = 0;
+      Uint stride = 1;
+      for (Uint d=0; d<m_dim; ++d)
+      {
+        cf3_assert((centroid[d] - m_bounding_box.min()[d])/m_D[d] >= 0);
+        cell += stride*std::min((Uint) std::floor( (centroid[d] - m_bounding_box.min()[d])/m_D[d]), m_N[d]-1 );
+        stride *= std::max(Uint(1),m_N[d]);
+      }
+      m_centroid_cells[e] = cell;
+
+      // bounding box, enlarged slightly so the tolerance of is_coord_in_element is respected
+      Real* box = &m_boxes[2*m_dim*e];
+      for (Uint d=0; d<m_dim; ++d)
+      {
+        const Real min = coordinates.col(d).minCoeff();
+        const Real max = coordinates.col(d).maxCoeff();
+        const Real margin = 1e-6*(max-min) + 100*math::Consts::eps();
+        box[d] = min - margin;
+        box[m_dim+d] = max + margin;
+      }
+    }
+  }
+
+  const std::vector<Entity>& m_elements;
+  const math::BoundingBox& m_bounding_box;
+  const std::vector<Real>& m_D;
+  const std::vector<Uint>& m_N;
+  const Uint m_dim;
+  std::vector<Uint>& m_centroid_cells;
+  std::vector<Real>& m_boxes;
+};
+
+/// Visits the cells overlapped by the bounding boxes of a range of elements.
+/// In the counting pass the number of elements per cell is accumulated in a per-thread array,
+/// in the filling pass the elements are written at the position given by a per-thread offset array.
+struct BoxCells
+{
+  BoxCells(const std::vector<Real>& boxes, const math::BoundingBox& bounding_box, const std::vector<Real>& D, const std::vector<Uint>& N, const Uint dim,
+           std::vector< std::vector<Uint> >& thread_counts, Uint* box_elements) :
+    m_boxes(boxes), m_bounding_box(bounding_box), m_D(D), m_N(N), m_dim(dim), m_thread_counts(thread_counts), m_box_elements(box_elements)
+  {
+  }
+
+  /// Clamped cell index along direction d of the coordinate x
+  Uint cell_1d(const Real x, const Uint d) const
+  {
+    const Real scaled = (x - m_bounding_box.min()[d])/m_D[d];
+    if (scaled <= 0.)
+      return 0;
+    return std::min((Uint) std::floor(scaled), m_N[d]-1);
+  }
+
+  void operator()(const Uint t, const Uint begin, const Uint end) const
+  {
+    std::vector<Uint>& counts = m_thread_counts[t];
+    Uint lo[3] = {0,0,0};
+    Uint hi[3] = {0,0,0};
+    const Uint NX = std::max(Uint(1),m_N[XX]);
+    const Uint NY = std::max(Uint(1),m_N[YY]);
+    for (Uint e=begin; e<end; ++e)
+    {
+      const Real* box = &m_boxes[2*m_dim*e];
+      for (Uint d=0; d<m_dim; ++d)
+      {
+        lo[d] = cell_1d(box[d],d);
+        hi[d] = cell_1d(box[m_dim+d],d);
+      }
+      for (Uint k=lo[ZZ]; k<=hi[ZZ]; ++k)
+      {
+        for (Uint j=lo[YY]; j<=hi[YY]; ++j)
+        {
+          for (Uint i=lo[XX]; i<=hi[XX]; ++i)
+          {
+            const Uint cell = (k*NY + j)*NX + i;
+            if (m_box_elements)
+              m_box_elements[counts[cell]] = e;
+            ++counts[cell];
+          }
+        }
+      }
+    }
+  }
+
+  const std::vector<Real>& m_boxes;
+  const math::BoundingBox& m_bounding_box;
+  const std::vector<Real>& m_D;
+  const std::vector<Uint>& m_N;
+  const Uint m_dim;
+  std::vector< std::vector<Uint> >& m_thread_counts;
+  Uint* m_box_elements;
+};
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+
 Octtree::Octtree( const std::string& name )
   : Component(name), m_dim(0), m_N(3), m_D(3), m_octtree_idx(3)
 {
@@ -96,6 +299,7 @@ void Octtree::create_octtree()
   if (options().value<std::vector<Uint> >("nb_cells").size() > 0)
   {
     m_N = options().value<std::vector<Uint> >("nb_cells");
+    m_N.resize(3,0);
     for (Uint d=0; d<m_dim; ++d)
       m_D[d] = (L[d])/static_cast<Real>(m_N[d]);
   }
@@ -120,65 +324,64 @@ void Octtree::create_octtree()
   CFdebug << "V = " << V << CFendl;
 
   // initialize the octtree
-  m_octtree.resize(boost::extents[std::max(Uint(1),m_N[XX])][std::max(Uint(1),m_N[YY])][std::max(Uint(1),m_N[ZZ])]);
+  m_extents.resize(3);
+  Uint nb_cells = 1;
+  for (Uint d=0; d<3; ++d)
+  {
+    m_extents[d] = d < m_dim ? std::max(Uint(1),m_N[d]) : 1u;
+    nb_cells *= m_extents[d];
+  }
 
-  RealVector centroid(m_dim);
-  std::vector<Uint> octtree_idx(3);
+  m_elements.clear();
+  m_elements.reserve(nb_elems);
   boost_foreach (Elements& elements, find_components_recursively_with_filter<Elements>(*m_mesh,IsElementsVolume()))
   {
-    Uint nb_nodes_per_element = elements.geometry_space().connectivity().row_size();
-    RealMatrix coordinates;
-    elements.geometry_space().allocate_coordinates(coordinates);
-
     for (Uint elem_idx=0; elem_idx<elements.size(); ++elem_idx)
+      m_elements.push_back(Entity(elements,elem_idx));
+  }
+
+  const Uint nb_threads = nb_threads_for(m_elements.size());
+
+  // centroid cell and bounding box of each element
+  std::vector<Uint> centroid_cells(m_elements.size());
+  m_element_boxes.resize(2*m_dim*m_elements.size());
+  run_chunked(m_elements.size(), nb_threads, ElementBoxes(m_elements, m_bounding_box, m_D, m_N, m_dim, centroid_cells, m_element_boxes));
+
+  // counting sort of the elements by centroid cell
+  m_cell_starts.assign(nb_cells+1, 0);
+  for (Uint e=0; e<m_elements.size(); ++e)
+    ++m_cell_starts[centroid_cells[e]+1];
+  for (Uint c=0; c<nb_cells; ++c)
+    m_cell_starts[c+1] += m_cell_starts[c];
+  m_cell_elements.resize(m_elements.size());
+  std::vector<Uint> cell_fill(m_cell_starts.begin(), m_cell_starts.end()-1);
+  for (Uint e=0; e<m_elements.size(); ++e)
+    m_cell_elements[cell_fill[centroid_cells[e]]++] = m_elements[e];
+
+  // elements overlapping each cell, first counted per thread and then filled by each thread in its own part of each cell,
+  // which keeps the elements in a cell sorted the same way for any number of threads
+  std::vector< std::vector<Uint> > thread_counts(nb_threads, std::vector<Uint>(nb_cells, 0));
+  run_chunked(m_elements.size(), nb_threads, BoxCells(m_element_boxes, m_bounding_box, m_D, m_N, m_dim, thread_counts, nullptr));
+  m_box_starts.assign(nb_cells+1, 0);
+  for (Uint c=0; c<nb_cells; ++c)
+  {
+    Uint offset = m_box_starts[c];
+    for (Uint t=0; t<nb_threads; ++t)
     {
-      elements.geometry_space().put_coordinates(coordinates,elem_idx);
-      elements.element_type().compute_centroid(coordinates,centroid);
-      for (Uint d=0; d<m_dim; ++d)
-      {
-        cf3_assert((centroid[d] - m_bounding_box.min()[d])/m_D[d] >= 0);
-        octtree_idx[d]=std::min((Uint) std::floor( (centroid[d] - m_bounding_box.min()[d])/m_D[d]), m_N[d]-1 );
-      }
-      m_octtree[octtree_idx[XX]][octtree_idx[YY]][octtree_idx[ZZ]].push_back(Entity(elements,elem_idx));
+      const Uint count = thread_counts[t][c];
+      thread_counts[t][c] = offset;
+      offset += count;
     }
+    m_box_starts[c+1] = offset;
   }
+  m_box_elements.resize(m_box_starts.back());
+  if (!m_box_elements.empty())
+    run_chunked(m_elements.size(), nb_threads, BoxCells(m_element_boxes, m_bounding_box, m_D, m_N, m_dim, thread_counts, &m_box_elements[0]));
 
+  m_elem_coordinates.resize(0,0);
 
-  // Uint total=0;
-  //
-  // switch (m_dim)
-  // {
-  //   case DIM_2D:
-  //     for (Uint i=0; i<m_N[0]; ++i)
-  //       for (Uint j=0; j<m_N[1]; ++j)
-  //       {
-  //         Uint k=0;
-  //         // CFinfo << "("<<i<<","<<j<<") has elems ";
-  //         // if (m_octtree[i][j][k].size())
-  //         //   CFinfo << mesh::to_vector(m_octtree[i][j][k]).transpose() << CFendl;
-  //         // else
-  //         //   CFinfo << CFendl;
-  //         total += m_octtree[i][j][k].size();
-  //       }
-  //     break;
-  //   case DIM_3D:
-  //     for (Uint i=0; i<m_N[0]; ++i)
-  //       for (Uint j=0; j<m_N[1]; ++j)
-  //         for (Uint k=0; k<m_N[2]; ++k)
-  //         {
-  //           // CFinfo << "("<<i<<","<<j<<","<<k<<") has elems ";
-  //           // if (m_octtree[i][j][k].size())
-  //           //   CFinfo << mesh::to_vector(m_octtree[i][j][k]).transpose() << CFendl;
-  //           // else
-  //           //   CFinfo << CFendl;
-  //           total += m_octtree[i][j][k].size();
-  //         }
-  //     break;
-  //   default:
-  //     break;
-  // }
-  //
-  // CFinfo << "total = " << total << " of " << m_nb_elems << CFendl;
+  CFdebug << "Octtree has " << nb_cells << " cells storing " << m_elements.size() << " elements, on average "
+          << static_cast<Real>(m_box_elements.size())/static_cast<Real>(nb_cells) << " elements overlap a cell (built with " << nb_threads << " threads)" << CFendl;
 }
 
 
@@ -273,7 +476,7 @@ void Octtree::find_cell_ranks( const boost::multi_array<Real,2>& coordinates, st
 
 bool Octtree::find_octtree_cell(const RealVector& coordinate, std::vector<Uint>& octtree_idx)
 {
-  if (m_octtree.num_elements() == 0)
+  if ( !is_created() )
     create_octtree();
 
   static const Real tolerance = 100*math::Consts::eps();
@@ -288,7 +491,8 @@ bool Octtree::find_octtree_cell(const RealVector& coordinate, std::vector<Uint>&
       CFdebug << "coord " << coordinate.transpose() << " not found in bounding box" << CFendl;
       return false; // no index found
     }
-    octtree_idx[d] = std::min((Uint) std::floor( (coordinate[d] - m_bounding_box.min()[d])/m_D[d]), m_N[d]-1 );
+    const Real scaled = (coordinate[d] - m_bounding_box.min()[d])/m_D[d];
+    octtree_idx[d] = scaled <= 0. ? 0u : std::min((Uint) std::floor(scaled), m_N[d]-1 );
   }
 
   //CFinfo << " should be in box ("<<m_point_idx[0]<<","<<m_point_idx[1]<<","<<m_point_idx[2]<<")" << CFendl;
@@ -308,11 +512,8 @@ void Octtree::gather_elements_around_idx(const std::vector<Uint>& octtree_idx, c
 
   if (ring == 0)
   {
-    boost_foreach(const Entity& element, m_octtree[octtree_idx[XX]][octtree_idx[YY]][octtree_idx[ZZ]])
-    {
-      cf3_assert(element.comp);
-      elements.push_back(element);
-    }
+    const Uint cell = cell_index(octtree_idx[XX],octtree_idx[YY],octtree_idx[ZZ]);
+    elements.insert(elements.end(), m_cell_elements.begin()+m_cell_starts[cell], m_cell_elements.begin()+m_cell_starts[cell+1]);
     return;
   }
   else
@@ -338,11 +539,8 @@ void Octtree::gather_elements_around_idx(const std::vector<Uint>& octtree_idx, c
             {
               if ( i == irmin || i == irmax || j == jrmin || j == jrmax || k == krmin || k == krmax)
               {
-                boost_foreach(const Entity& element, m_octtree[i][j][k])
-                {
-                  cf3_assert(element.comp);
-                  elements.push_back(element);
-                }
+                const Uint cell = cell_index(i,j,k);
+                elements.insert(elements.end(), m_cell_elements.begin()+m_cell_starts[cell], m_cell_elements.begin()+m_cell_starts[cell+1]);
               }
             }
           }
@@ -363,11 +561,8 @@ void Octtree::gather_elements_around_idx(const std::vector<Uint>& octtree_idx, c
           {
             if ( i == irmin || i == irmax || j == jrmin || j == jrmax )
             {
-              boost_foreach(const Entity& element, m_octtree[i][j][k])
-              {
-                cf3_assert(element.comp);
-                elements.push_back(element);
-              }
+              const Uint cell = cell_index(i,j,k);
+              elements.insert(elements.end(), m_cell_elements.begin()+m_cell_starts[cell], m_cell_elements.begin()+m_cell_starts[cell+1]);
             }
           }
         }
@@ -382,11 +577,8 @@ void Octtree::gather_elements_around_idx(const std::vector<Uint>& octtree_idx, c
         {
           if ( i == irmin || i == irmax)
           {
-            boost_foreach(const Entity& element, m_octtree[i][j][k])
-            {
-              cf3_assert(element.comp);
-              elements.push_back(element);
-            }
+            const Uint cell = cell_index(i,j,k);
+            elements.insert(elements.end(), m_cell_elements.begin()+m_cell_starts[cell], m_cell_elements.begin()+m_cell_starts[cell+1]);
           }
         }
 
@@ -418,49 +610,114 @@ bool Octtree::find_element(const RealVector& target_coord, Entity& element)
 
   cf3_assert(target_coord.size() <= (long)m_dim);
   RealVector t_coord(m_dim);
+  t_coord.setZero();
   for (Uint d=0; d<target_coord.size(); ++d)
     t_coord[d] = target_coord[d];
 
-  for (Uint t=0; t<target_coord.size(); ++t)
-
   if (find_octtree_cell(t_coord,m_octtree_idx))
   {
-    m_elements_pool.clear();
-    Uint pool_size = 0;
-    Uint rings=0;
-    for ( ; pool_size==0 ; ++rings)
+    if (find_in_cell(t_coord,cell_index(m_octtree_idx[XX],m_octtree_idx[YY],m_octtree_idx[ZZ]),element,m_elem_coordinates))
+      return true;
+  }
+  // if arrived here, it means no element has been found in the octtree cell. Give up.
+  element = Entity();
+  CFdebug << "coord " << t_coord.transpose() << " has not been found in the octtree cell" << CFendl;
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+bool Octtree::find_in_cell(const RealVector& t_coord, const Uint cell, Entity& element, RealMatrix& elem_coordinates) const
+{
+  const Entities* comp = nullptr;
+  for (Uint b=m_box_starts[cell]; b<m_box_starts[cell+1]; ++b)
+  {
+    const Uint e = m_box_elements[b];
+
+    // cheap rejection on the bounding box
+    const Real* box = &m_element_boxes[2*m_dim*e];
+    bool in_box = true;
+    for (Uint d=0; d<m_dim; ++d)
     {
-      pool_size=m_elements_pool.size();
-      gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
-      boost_foreach(const Entity& pool_elem, boost::make_iterator_range(m_elements_pool.begin()+pool_size,m_elements_pool.end()))
+      if (t_coord[d] < box[d] || t_coord[d] > box[m_dim+d])
       {
-        cf3_assert(is_not_null(pool_elem.comp));
-        const RealMatrix elem_coordinates = pool_elem.get_coordinates();
-        if (pool_elem.element_type().is_coord_in_element(t_coord,elem_coordinates))
-        {
-          element = pool_elem;
-          return true;
-        }
+        in_box = false;
+        break;
       }
     }
-    // if arrived here, keep searching
-    // it means no element has been found. The search is enlarged with one more ring, for possible misses.
-    gather_elements_around_idx(m_octtree_idx,rings,m_elements_pool);
-    boost_foreach(const Entity& pool_elem, boost::make_iterator_range(m_elements_pool.begin()+pool_size,m_elements_pool.end()))
+    if (!in_box)
+      continue;
+
+    const Entity& candidate = m_elements[e];
+    cf3_assert(is_not_null(candidate.comp));
+    if (candidate.comp != comp)
+    {
+      comp = candidate.comp;
+      candidate.allocate_coordinates(elem_coordinates);
+    }
+    candidate.put_coordinates(elem_coordinates);
+    if (candidate.element_type().is_coord_in_element(t_coord,elem_coordinates))
+    {
+      element = candidate;
+      return true;
+    }
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint Octtree::find_elements(const RealMatrix& coordinates, std::vector<Entity>& elements)
+{
+  if ( !is_created() )
+    create_octtree();
+
+  cf3_assert(coordinates.cols() <= (long)m_dim);
+  const Uint nb_points = coordinates.rows();
+  elements.assign(nb_points, Entity());
+
+  const Uint nb_threads = nb_threads_for(nb_points);
+  std::vector<Uint> found(nb_threads, 0);
+  run_chunked(nb_points, nb_threads, boost::bind(&Octtree::find_elements_range, this, boost::cref(coordinates), boost::ref(elements), boost::ref(found), _1, _2, _3));
+
+  Uint nb_found = 0;
+  boost_foreach(const Uint thread_found, found)
+    nb_found += thread_found;
+  return nb_found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void Octtree::find_elements_range(const RealMatrix& coordinates, std::vector<Entity>& elements, std::vector<Uint>& found, const Uint t, const Uint begin, const Uint end) const
+{
+  static const Real tolerance = 100*math::Consts::eps();
+  RealVector t_coord(m_dim);
+  t_coord.setZero();
+  RealMatrix elem_coordinates;
+  Uint nb_found = 0;
+  for (Uint p=begin; p<end; ++p)
+  {
+    Uint cell = 0;
+    Uint stride = 1;
+    bool in_bounding_box = true;
+    for (Uint d=0; d<m_dim; ++d)
     {
-      cf3_assert(is_not_null(pool_elem.comp));
-      const RealMatrix elem_coordinates = pool_elem.get_coordinates();
-      if (pool_elem.element_type().is_coord_in_element(t_coord,elem_coordinates))
+      if (d < (Uint)coordinates.cols())
+        t_coord[d] = coordinates(p,d);
+      if ( (t_coord[d] > m_bounding_box.max()[d] + tolerance) ||
+           (t_coord[d] < m_bounding_box.min()[d] - tolerance) )
       {
-        element = pool_elem;
-        return true;
+        in_bounding_box = false;
+        break;
       }
+      const Real scaled = (t_coord[d] - m_bounding_box.min()[d])/m_D[d];
+      cell += stride * (scaled <= 0. ? 0u : std::min((Uint) std::floor(scaled), m_N[d]-1));
+      stride *= m_extents[d];
     }
+    if (in_bounding_box && find_in_cell(t_coord,cell,elements[p],elem_coordinates))
+      ++nb_found;
   }
-  // if arrived here, it means no element has been found in the octtree cell. Give up.
-  element = Entity();
-  CFdebug << "coord " << t_coord.transpose() << " has not been found in the octtree cell" << CFendl;
-  return false;
+  found[t] = nb_found;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
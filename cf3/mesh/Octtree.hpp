@@ -26,17 +26,15 @@ namespace mesh {
 
 //////////////////////////////////////////////////////////////////////////////
 
-/// This class defines neutral mesh format reader
+/// Uniform grid of cells over the volume elements of a mesh, used to find the element containing a coordinate.
+/// All storage is flat: the elements of each cell are stored contiguously in compressed sparse row format.
+/// Each element is stored once in the cell of its centroid, for the ring-based neighbourhood searches, and
+/// in all cells overlapped by its bounding box, so point location only has to visit a single cell.
+/// Construction and batched point location are threaded through the nb_threads option of the environment.
 /// @author Willem Deconinck
 class Mesh_API Octtree : public common::Component
 {
 
-private: // typedefs
-
-  typedef std::pair<const Elements*,Uint> Point;
-  typedef boost::multi_array<std::vector<Entity> ,3> ArrayT;
-  typedef std::vector<const Point*> Pointcloud;
-
 public: // functions
   /// constructor
   Octtree( const std::string& name );
@@ -55,6 +53,12 @@ public: // functions
   /// @return if element was found
   virtual bool find_element(const RealVector& target_coord, Entity& element);
 
+  /// @brief Find the elements containing each row of coordinates
+  /// @param coordinates [in]  one coordinate per row
+  /// @param elements    [out] the element for each row, with a null comp if none was found
+  /// @return the number of coordinates for which an element was found
+  Uint find_elements(const RealMatrix& coordinates, std::vector<Entity>& elements);
+
   /// Given a coordinate, find which box in the octtree it is located in
   /// @param coordinate  [in]  The coordinate to look for
   /// @param octtree_idx [out] location of the box (i,j,k) in which the coordinate sits
@@ -69,25 +73,54 @@ public: // functions
   /// @note subsequent calls with increasing value for ring starting from 0, will assemble everything within the last passed ring value.
   void gather_elements_around_idx(const std::vector<Uint>& octtree_idx, const Uint ring, std::vector<Entity>& element_pool);
 
+  /// Largest ring that still contains cells of the octtree, around any cell
+  Uint max_ring() const { return *std::max_element(m_extents.begin(),m_extents.end()); }
+
   void find_cell_ranks( const boost::multi_array<Real,2>& coordinates, std::vector<Uint>& ranks );
 
-  bool is_created() const { return m_octtree.num_elements()!=0; }
+  bool is_created() const { return !m_cell_starts.empty(); }
 
   const Uint dimension() { return m_dim; }
 
-private: // data
+private: // functions
+
+  /// Index of the cell (i,j,k) in the flat storage
+  Uint cell_index(const Uint i, const Uint j, const Uint k) const { return (k*m_extents[YY] + j)*m_extents[XX] + i; }
+
+  /// Look for the element containing t_coord among the elements overlapping the given cell.
+  /// elem_coordinates is used as scratch space, so each thread must pass its own.
+  bool find_in_cell(const RealVector& t_coord, const Uint cell, Entity& element, RealMatrix& elem_coordinates) const;
 
-  ArrayT m_octtree;
+  /// Find the elements for the rows [begin,end) of coordinates, storing the number found by thread t in found[t]
+  void find_elements_range(const RealMatrix& coordinates, std::vector<Entity>& elements, std::vector<Uint>& found, const Uint t, const Uint begin, const Uint end) const;
+
+private: // data
 
   Uint m_dim;
   std::vector<Uint> m_N;
   std::vector<Real> m_D;
 
+  /// number of cells in each direction, at least 1 so unused directions have a single layer
+  std::vector<Uint> m_extents;
+
+  /// Elements by the cell containing their centroid: the elements of cell c are m_cell_elements[m_cell_starts[c]] up to m_cell_elements[m_cell_starts[c+1]]
+  std::vector<Uint> m_cell_starts;
+  std::vector<Entity> m_cell_elements;
+
+  /// All volume elements, with their bounding box (m_dim minima followed by m_dim maxima)
+  std::vector<Entity> m_elements;
+  std::vector<Real> m_element_boxes;
+
+  /// Index in m_elements of the elements whose bounding box overlaps each cell, in the same layout as m_cell_starts
+  std::vector<Uint> m_box_starts;
+  std::vector<Uint> m_box_elements;
+
   Handle<Mesh> m_mesh;
 
   std::vector<Uint> m_octtree_idx;
 
-  std::vector<Entity> m_elements_pool;
+  /// scratch space for find_element
+  RealMatrix m_elem_coordinates;
 
   math::BoundingBox m_bounding_box;
 
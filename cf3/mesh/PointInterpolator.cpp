@@ -58,6 +58,30 @@ void APointInterpolator::configure_dict()
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Uint APointInterpolator::compute_storage_batch(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector< std::vector<SpaceElem> >& stencils,
+                                               std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights, std::vector<bool>& found)
+{
+  const Uint nb_points = coordinates.rows();
+  elements.resize(nb_points);
+  stencils.resize(nb_points);
+  points.resize(nb_points);
+  weights.resize(nb_points);
+  found.assign(nb_points,false);
+
+  Uint nb_found = 0;
+  RealVector coordinate(coordinates.cols());
+  for (Uint i=0; i<nb_points; ++i)
+  {
+    coordinate = coordinates.row(i);
+    found[i] = compute_storage(coordinate,elements[i],stencils[i],points[i],weights[i]);
+    if (found[i])
+      ++nb_found;
+  }
+  return nb_found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 cf3::common::ComponentBuilder<PointInterpolator,APointInterpolator,LibMesh> PointInterpolator_builder;
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -154,5 +178,40 @@ bool PointInterpolator::compute_storage(const RealVector& coordinate, SpaceElem&
 
 ////////////////////////////////////////////////////////////////////////////////
 
+Uint PointInterpolator::compute_storage_batch(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector< std::vector<SpaceElem> >& stencils,
+                                              std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights, std::vector<bool>& found)
+{
+  // 1) Find the elements all coordinates fall in
+  cf3_assert(m_element_finder);
+  const Uint nb_found = m_element_finder->find_elements(coordinates,elements,found);
+
+  const Uint nb_points = coordinates.rows();
+  stencils.resize(nb_points);
+  points.resize(nb_points);
+  weights.resize(nb_points);
+
+  cf3_assert(m_stencil_computer);
+  cf3_assert(m_interpolator_function);
+  RealVector coordinate(coordinates.cols());
+  for (Uint i=0; i<nb_points; ++i)
+  {
+    stencils[i].clear();
+    points[i].clear();
+    weights[i].clear();
+    if (!found[i])
+      continue;
+
+    // 2) Find stencil of elements to use
+    m_stencil_computer->compute_stencil(elements[i],stencils[i]);
+
+    // 3) Find interpolation
+    coordinate = coordinates.row(i);
+    m_interpolator_function->compute_interpolation_weights(coordinate,stencils[i],points[i],weights[i]);
+  }
+  return nb_found;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 } // mesh
 } // cf3
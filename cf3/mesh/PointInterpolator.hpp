@@ -55,6 +55,13 @@ public: // functions
 
   virtual bool compute_storage(const RealVector& coordinate, SpaceElem& element, std::vector<SpaceElem>& stencil, std::vector<Uint>& points, std::vector<Real>& weights) = 0;
 
+  /// Compute the storage for each row of coordinates
+  /// @param [out] found  if the coordinate in each row can be interpolated
+  /// @return the number of coordinates that can be interpolated
+  /// @note The default implementation calls compute_storage for each row
+  virtual Uint compute_storage_batch(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector< std::vector<SpaceElem> >& stencils,
+                                     std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights, std::vector<bool>& found);
+
 private: // functions
 
   void configure_dict();
@@ -119,6 +126,10 @@ public: // functions
 
   virtual bool compute_storage(const RealVector& coordinate, SpaceElem& element, std::vector<SpaceElem>& stencil, std::vector<Uint>& points, std::vector<Real>& weights);
 
+  /// Finds the elements of all coordinates in one call to the element finder
+  virtual Uint compute_storage_batch(const RealMatrix& coordinates, std::vector<SpaceElem>& elements, std::vector< std::vector<SpaceElem> >& stencils,
+                                     std::vector< std::vector<Uint> >& points, std::vector< std::vector<Real> >& weights, std::vector<bool>& found);
+
 private: // functions
 
   void configure_element_finder();
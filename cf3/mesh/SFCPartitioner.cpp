@@ -0,0 +1,199 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <utility>
+
+#include <boost/cstdint.hpp>
+
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/Hilbert.hpp"
+
+#include "mesh/SFCPartitioner.hpp"
+#include "mesh/BoundingBox.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Space.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+using namespace common;
+
+common::ComponentBuilder < SFCPartitioner, MeshTransformer, LibMesh > SFCPartitioner_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+SFCPartitioner::SFCPartitioner ( const std::string& name ) :
+  MeshPartitioner(name)
+{
+  properties()["brief"] = std::string("Partitions the mesh along the Hilbert space filling curve");
+  properties()["description"] = std::string("Sorts the elements by the Hilbert index of their centroid with a parallel sample sort, "
+                                            "and cuts the curve in parts with the same number of volume elements");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void SFCPartitioner::partition_graph()
+{
+  Mesh& mesh = *m_mesh;
+  PE::Comm& comm = PE::Comm::instance();
+  const Uint nb_procs = comm.size();
+  const Uint rank = comm.rank();
+  const Uint nb_parts = options().value<Uint>("nb_parts");
+
+  boost::shared_ptr<BoundingBox> bounding_box = allocate_component<BoundingBox>("bounding_box");
+  bounding_box->build(mesh);
+  bounding_box->make_global();
+  math::Hilbert compute_hilbert_idx(*bounding_box, 20);  // functor
+
+  // Hilbert index of the centroid of every element. Only the volume elements are balanced.
+  std::vector< std::vector<boost::uint64_t> > hilbert_idx(mesh.elements().size());
+  std::vector<boost::uint64_t> volume_idx;
+  for (Uint entities_idx=0; entities_idx<mesh.elements().size(); ++entities_idx)
+  {
+    const Entities& entities = *mesh.elements()[entities_idx];
+    const Space& space = entities.geometry_space();
+    const bool is_volume = IsElementsVolume()(entities);
+
+    RealMatrix element_coordinates;
+    space.allocate_coordinates(element_coordinates);
+    RealVector centroid(entities.element_type().dimension());
+
+    hilbert_idx[entities_idx].resize(space.size());
+    for (Uint e=0; e<space.size(); ++e)
+    {
+      space.put_coordinates(element_coordinates,e);
+      entities.element_type().compute_centroid(element_coordinates,centroid);
+      hilbert_idx[entities_idx][e] = compute_hilbert_idx(centroid);
+      if (is_volume)
+        volume_idx.push_back(hilbert_idx[entities_idx][e]);
+    }
+  }
+  std::sort(volume_idx.begin(),volume_idx.end());
+
+  // The other elements take the index of a volume element that contains all their nodes, so they go to the same part
+  // as that cell even when their own centroid is in the range of the next part. Elements without such a cell on this
+  // process keep the index of their centroid.
+  std::vector< std::vector< std::pair<Uint,Uint> > > node_to_volume(mesh.geometry_fields().size());
+  for (Uint entities_idx=0; entities_idx<mesh.elements().size(); ++entities_idx)
+  {
+    const Entities& entities = *mesh.elements()[entities_idx];
+    if (!IsElementsVolume()(entities))
+      continue;
+    const Connectivity& connectivity = entities.geometry_space().connectivity();
+    for (Uint e=0; e<connectivity.size(); ++e)
+      boost_foreach(const Uint node, connectivity[e])
+        node_to_volume[node].push_back(std::make_pair(entities_idx,e));
+  }
+  for (Uint entities_idx=0; entities_idx<mesh.elements().size(); ++entities_idx)
+  {
+    const Entities& entities = *mesh.elements()[entities_idx];
+    if (IsElementsVolume()(entities))
+      continue;
+    const Connectivity& connectivity = entities.geometry_space().connectivity();
+    for (Uint e=0; e<connectivity.size(); ++e)
+    {
+      const Connectivity::ConstRow nodes = connectivity[e];
+      typedef std::pair<Uint,Uint> VolumeElement;
+      boost_foreach(const VolumeElement& cell, node_to_volume[nodes[0]])
+      {
+        const Connectivity::ConstRow cell_nodes = mesh.elements()[cell.first]->geometry_space().connectivity()[cell.second];
+        bool adjacent = true;
+        for (Uint n=1; n<nodes.size() && adjacent; ++n)
+          adjacent = std::find(cell_nodes.begin(),cell_nodes.end(),nodes[n]) != cell_nodes.end();
+        if (adjacent)
+        {
+          hilbert_idx[entities_idx][e] = hilbert_idx[cell.first][cell.second];
+          break;
+        }
+      }
+    }
+  }
+
+  // Regular samples of the sorted indices on each process choose the splitters,
+  // which give every process a range of the curve to sort
+  std::vector<boost::uint64_t> samples;
+  for (Uint s=0; s<nb_procs && !volume_idx.empty(); ++s)
+    samples.push_back(volume_idx[(s*volume_idx.size())/nb_procs]);
+  std::vector< std::vector<boost::uint64_t> > gathered_samples;
+  comm.all_gather(samples,gathered_samples);
+  std::vector<boost::uint64_t> all_samples;
+  boost_foreach(const std::vector<boost::uint64_t>& proc_samples, gathered_samples)
+    all_samples.insert(all_samples.end(),proc_samples.begin(),proc_samples.end());
+  if (all_samples.empty())
+  {
+    CFwarn << "Mesh " << mesh.uri() << " has no volume elements to partition" << CFendl;
+    return;
+  }
+  std::sort(all_samples.begin(),all_samples.end());
+  std::vector<boost::uint64_t> splitters;
+  for (Uint p=1; p<nb_procs; ++p)
+    splitters.push_back(all_samples[(p*all_samples.size())/nb_procs]);
+
+  std::vector< std::vector<boost::uint64_t> > send(nb_procs);
+  boost_foreach(const boost::uint64_t idx, volume_idx)
+    send[std::upper_bound(splitters.begin(),splitters.end(),idx)-splitters.begin()].push_back(idx);
+  std::vector< std::vector<boost::uint64_t> > recv;
+  comm.all_to_all(send,recv);
+  std::vector<boost::uint64_t> sorted;
+  boost_foreach(const std::vector<boost::uint64_t>& proc_idx, recv)
+    sorted.insert(sorted.end(),proc_idx.begin(),proc_idx.end());
+  std::sort(sorted.begin(),sorted.end());
+
+  // Position of the local range in the globally sorted sequence
+  const Uint nb_sorted = sorted.size();
+  std::vector<Uint> nb_sorted_per_proc(nb_procs);
+  comm.all_gather(nb_sorted,nb_sorted_per_proc);
+  boost::uint64_t offset = 0;
+  boost::uint64_t total = 0;
+  for (Uint p=0; p<nb_procs; ++p)
+  {
+    if (p < rank)
+      offset += nb_sorted_per_proc[p];
+    total += nb_sorted_per_proc[p];
+  }
+
+  // First index of each part, found by the process holding that position of the sequence
+  std::vector<boost::uint64_t> local_part_begin(nb_parts,0);
+  for (Uint p=1; p<nb_parts; ++p)
+  {
+    const boost::uint64_t position = (p*total)/nb_parts;
+    if (offset <= position && position < offset+nb_sorted)
+      local_part_begin[p] = sorted[position-offset];
+  }
+  std::vector<boost::uint64_t> part_begin(nb_parts);
+  comm.all_reduce(PE::max(),local_part_begin,part_begin);
+
+  // Every element goes to the part whose range of the curve contains its index
+  Uint nb_exported = 0;
+  for (Uint entities_idx=0; entities_idx<hilbert_idx.size(); ++entities_idx)
+  {
+    for (Uint e=0; e<hilbert_idx[entities_idx].size(); ++e)
+    {
+      const Uint part = std::upper_bound(part_begin.begin()+1,part_begin.end(),hilbert_idx[entities_idx][e]) - (part_begin.begin()+1);
+      if (part != rank)
+      {
+        m_elements_to_export[part][entities_idx].push_back(e);
+        ++nb_exported;
+      }
+    }
+  }
+  CFdebug << "SFC partitioning exports " << nb_exported << " elements from rank " << rank << CFendl;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
@@ -0,0 +1,58 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_SFCPartitioner_hpp
+#define cf3_mesh_SFCPartitioner_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshPartitioner.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Partitions the mesh along the Hilbert space filling curve, without any external library.
+///
+/// Each element is given the Hilbert index of its centroid in the global bounding box. The indices of the
+/// volume elements are sorted over all processes with a parallel sample sort, and the sorted sequence is cut
+/// in nb_parts pieces of equal length. Every element then goes to the part whose piece of the curve contains
+/// its index. Surface elements use the index of a volume element that contains all their nodes instead of their
+/// own, so boundary elements follow the cells next to them.
+/// The elements are migrated with MeshAdaptor, like for the graph partitioners.
+///
+/// This is much cheaper than graph partitioning and gives compact parts, but does not minimize the
+/// number of cut faces.
+class Mesh_API SFCPartitioner : public MeshPartitioner {
+
+public: // functions
+
+  /// Contructor
+  /// @param name of the component
+  SFCPartitioner ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~SFCPartitioner() {}
+
+  /// Get the class name
+  static std::string type_name () { return "SFCPartitioner"; }
+
+  /// Does nothing, as the partitioning only needs the coordinates
+  virtual void build_graph() {}
+
+  virtual void partition_graph();
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_SFCPartitioner_hpp
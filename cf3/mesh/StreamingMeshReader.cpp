@@ -0,0 +1,57 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/BasicExceptions.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+
+#include "mesh/StreamingMeshReader.hpp"
+#include "mesh/StreamingMeshWriter.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+StreamingMeshReader::StreamingMeshReader ( const std::string& name  ) :
+  common::Component( name )
+{
+  options().add("chunk_size", 1000000u)
+      .pretty_name("Chunk Size")
+      .description("Maximum number of nodes or elements held in memory at once")
+      .mark_basic();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+StreamingMeshReader::~StreamingMeshReader()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+void StreamingMeshReader::convert(const URI& input, const URI& output, StreamingMeshWriter& writer)
+{
+  if(chunk_size() == 0)
+    throw BadValue(FromHere(), "Option chunk_size of " + uri().string() + " must be positive");
+
+  CFinfo << "Converting " << input.path() << " to " << output.path() << " in chunks of " << chunk_size() << CFendl;
+  do_convert(input, output, writer);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+Uint StreamingMeshReader::chunk_size() const
+{
+  return options().value<Uint>("chunk_size");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
@@ -0,0 +1,73 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_StreamingMeshReader_hpp
+#define cf3_mesh_StreamingMeshReader_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Component.hpp"
+#include "common/URI.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+  class StreamingMeshWriter;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Converts a mesh file to another format without building a Mesh.
+/// Nodes and elements are read in chunks of at most "chunk_size" entries and handed to a StreamingMeshWriter,
+/// so the memory use is bounded by the chunk size rather than by the size of the mesh.
+/// This only works for conversions that need no global topology, such as the connectivity between cells and faces.
+class Mesh_API StreamingMeshReader : public common::Component {
+
+public: // functions
+
+  /// Contructor
+  /// @param name of the component
+  StreamingMeshReader ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~StreamingMeshReader();
+
+  /// Get the class name
+  static std::string type_name () { return "StreamingMeshReader"; }
+
+  /// @return the name of the file format
+  virtual std::string get_format() = 0;
+
+  /// @return the list of possible extensions of the file format
+  virtual std::vector<std::string> get_extensions() = 0;
+
+  /// Convert a file. This calls a concrete implementation given by do_convert
+  /// @param [in] input   the file to read
+  /// @param [in] output  the file to write
+  /// @param [in] writer  the writer for the output format
+  void convert(const common::URI& input, const common::URI& output, StreamingMeshWriter& writer);
+
+protected: // functions
+
+  /// Maximum number of nodes or elements held in memory at once
+  Uint chunk_size() const;
+
+private:
+
+  /// this function implements the concrete conversion and is called by convert
+  virtual void do_convert(const common::URI& input, const common::URI& output, StreamingMeshWriter& writer) = 0;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_StreamingMeshReader_hpp
@@ -0,0 +1,28 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "mesh/StreamingMeshWriter.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+StreamingMeshWriter::StreamingMeshWriter ( const std::string& name  ) :
+  common::Component( name )
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+StreamingMeshWriter::~StreamingMeshWriter()
+{
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
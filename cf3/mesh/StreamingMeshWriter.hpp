@@ -0,0 +1,79 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_StreamingMeshWriter_hpp
+#define cf3_mesh_StreamingMeshWriter_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Component.hpp"
+#include "common/URI.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+namespace cf3 {
+namespace mesh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Writes a mesh file from chunks of nodes and elements, as they are produced by a StreamingMeshReader.
+/// No Mesh is built in memory: each chunk is written out before the next one is read.
+/// The calls must come in the order open, write_nodes (all nodes, in increasing order),
+/// write_elements (any order of regions and element types), close.
+class Mesh_API StreamingMeshWriter : public common::Component {
+
+public: // functions
+
+  /// Contructor
+  /// @param name of the component
+  StreamingMeshWriter ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~StreamingMeshWriter();
+
+  /// Get the class name
+  static std::string type_name () { return "StreamingMeshWriter"; }
+
+  /// @return the name of the file format
+  virtual std::string get_format() = 0;
+
+  /// @return the list of possible extensions of the file format
+  virtual std::vector<std::string> get_extensions() = 0;
+
+  /// Start writing a file
+  /// @param [in] path               the file to write
+  /// @param [in] dimension          number of coordinates per node
+  /// @param [in] nb_nodes           total number of nodes that will be written
+  /// @param [in] nb_elements        total number of elements that will be written, over all regions
+  /// @param [in] region_names       name of each region
+  /// @param [in] region_dimensions  dimension of the elements of each region
+  virtual void open(const common::URI& path, const Uint dimension, const Uint nb_nodes, const Uint nb_elements,
+                    const std::vector<std::string>& region_names, const std::vector<Uint>& region_dimensions) = 0;
+
+  /// Write consecutive nodes
+  /// @param [in] first        index of the first node in the chunk
+  /// @param [in] coordinates  dimension coordinates for each node of the chunk
+  virtual void write_nodes(const Uint first, const std::vector<Real>& coordinates) = 0;
+
+  /// Write elements of a single type
+  /// @param [in] region        index of the region the elements belong to
+  /// @param [in] element_type  builder name of the element type, e.g. cf3.mesh.LagrangeP1.Quad2D
+  /// @param [in] connectivity  node indices of each element, in the local numbering of the element type
+  virtual void write_elements(const Uint region, const std::string& element_type, const std::vector<Uint>& connectivity) = 0;
+
+  /// Finish the file
+  virtual void close() = 0;
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_StreamingMeshWriter_hpp
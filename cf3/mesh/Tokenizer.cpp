@@ -0,0 +1,288 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <cstdlib>
+#include <limits>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "common/StringConversion.hpp"
+
+#include "mesh/Tokenizer.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+  using namespace common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+Tokenizer::Tokenizer() :
+  m_begin(0),
+  m_end(0),
+  m_pos(0)
+{
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Tokenizer::open(const boost::filesystem::path& path)
+{
+  close();
+  m_path = path;
+  if(!boost::filesystem::exists(path))
+    throw FileSystemError(FromHere(), path.string() + " does not exist");
+  if(boost::filesystem::file_size(path) == 0)
+    throw FileFormatError(FromHere(), path.string() + " is empty");
+
+  try
+  {
+    m_mapping.open(path.string());
+  }
+  catch(std::exception& e)
+  {
+    throw FileSystemError(FromHere(), "Could not map " + path.string() + " into memory: " + e.what());
+  }
+
+  m_begin = m_mapping.data();
+  m_end = m_begin + m_mapping.size();
+  m_pos = m_begin;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Tokenizer::close()
+{
+  if(m_mapping.is_open())
+    m_mapping.close();
+  m_begin = m_end = m_pos = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Tokenizer::seek(const std::size_t position)
+{
+  cf3_assert(position <= size());
+  m_pos = m_begin + position;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+bool Tokenizer::at_end()
+{
+  skip_whitespace();
+  return m_pos == m_end;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Uint Tokenizer::read_uint()
+{
+  const std::size_t result = read_size();
+  if(result > std::numeric_limits<Uint>::max())
+    throw_parse_error("unsigned integer smaller than " + to_str(std::numeric_limits<Uint>::max()));
+  return static_cast<Uint>(result);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t Tokenizer::read_size()
+{
+  skip_whitespace();
+  if(m_pos == m_end || *m_pos < '0' || *m_pos > '9')
+    throw_parse_error("unsigned integer");
+  std::size_t result = 0;
+  while(m_pos != m_end && *m_pos >= '0' && *m_pos <= '9')
+  {
+    result = 10*result + static_cast<std::size_t>(*m_pos - '0');
+    ++m_pos;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+int Tokenizer::read_int()
+{
+  skip_whitespace();
+  bool negative = false;
+  if(m_pos != m_end && (*m_pos == '-' || *m_pos == '+'))
+  {
+    negative = *m_pos == '-';
+    ++m_pos;
+  }
+  if(m_pos == m_end || *m_pos < '0' || *m_pos > '9')
+    throw_parse_error("integer");
+  int result = 0;
+  while(m_pos != m_end && *m_pos >= '0' && *m_pos <= '9')
+  {
+    result = 10*result + (*m_pos - '0');
+    ++m_pos;
+  }
+  return negative ? -result : result;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Real Tokenizer::read_real()
+{
+  skip_whitespace();
+
+  // strtod needs a terminated string, and the mapping is not terminated
+  char buffer[64];
+  std::size_t length = 0;
+  while(m_pos+length != m_end && length != sizeof(buffer)-1)
+  {
+    const char c = m_pos[length];
+    if(c == ' ' || c == '\n' || c == '\r' || c == '\t')
+      break;
+    buffer[length++] = c;
+  }
+  buffer[length] = '\0';
+
+  char* parsed_end;
+  const Real result = std::strtod(buffer, &parsed_end);
+  if(length == 0 || parsed_end != buffer+length)
+    throw_parse_error("real");
+  m_pos += length;
+  return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::string Tokenizer::read_word()
+{
+  skip_whitespace();
+  const char* word_begin = m_pos;
+  while(m_pos != m_end && *m_pos != ' ' && *m_pos != '\n' && *m_pos != '\r' && *m_pos != '\t')
+    ++m_pos;
+  if(word_begin == m_pos)
+    throw_parse_error("word");
+  return std::string(word_begin, m_pos);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::string Tokenizer::read_quoted()
+{
+  skip_whitespace();
+  if(m_pos == m_end || *m_pos != '"')
+    return read_word();
+
+  const char* string_begin = ++m_pos;
+  while(m_pos != m_end && *m_pos != '"' && *m_pos != '\n')
+    ++m_pos;
+  if(m_pos == m_end || *m_pos != '"')
+    throw_parse_error("closing quote");
+  return std::string(string_begin, m_pos++);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::string Tokenizer::read_line()
+{
+  const char* line_begin = m_pos;
+  const char* line_end = static_cast<const char*>(std::memchr(m_pos, '\n', m_end - m_pos));
+  if(line_end == 0)
+    line_end = m_end;
+  m_pos = line_end == m_end ? m_end : line_end+1;
+  if(line_end != line_begin && *(line_end-1) == '\r')
+    --line_end;
+  return std::string(line_begin, line_end);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Tokenizer::skip_line()
+{
+  seek(find_line(position(), 1));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Tokenizer::skip_lines(const std::size_t nb_lines)
+{
+  seek(find_line(position(), nb_lines));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Tokenizer::skip_bytes(const std::size_t nb_bytes)
+{
+  if(static_cast<std::size_t>(m_end - m_pos) < nb_bytes)
+    throw_parse_error(to_str(nb_bytes) + " more bytes");
+  m_pos += nb_bytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t Tokenizer::count_lines(const std::size_t begin, const std::size_t end) const
+{
+  cf3_assert(begin <= end && end <= size());
+  std::size_t result = 0;
+  const char* pos = m_begin + begin;
+  const char* const stop = m_begin + end;
+  while(pos != stop)
+  {
+    pos = static_cast<const char*>(std::memchr(pos, '\n', stop - pos));
+    if(pos == 0)
+      break;
+    ++pos;
+    ++result;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t Tokenizer::find_line(const std::size_t position, const std::size_t nb_lines) const
+{
+  const char* pos = m_begin + position;
+  for(std::size_t i = 0; i != nb_lines; ++i)
+  {
+    pos = static_cast<const char*>(std::memchr(pos, '\n', m_end - pos));
+    if(pos == 0)
+    {
+      if(i == nb_lines-1)
+        return size();
+      throw ParsingFailed(FromHere(), "Unexpected end of " + m_path.string() + ": the file has less than " + to_str(nb_lines) + " lines after byte " + to_str(position));
+    }
+    ++pos;
+  }
+  return pos - m_begin;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t Tokenizer::find(const std::string& str, const std::size_t position) const
+{
+  cf3_assert(!str.empty());
+  const char* pos = m_begin + position;
+  while(static_cast<std::size_t>(m_end - pos) >= str.size())
+  {
+    pos = static_cast<const char*>(std::memchr(pos, str[0], m_end - pos - str.size() + 1));
+    if(pos == 0)
+      break;
+    if(std::memcmp(pos, str.data(), str.size()) == 0)
+      return pos - m_begin;
+    ++pos;
+  }
+  return size();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Tokenizer::throw_parse_error(const std::string& expected) const
+{
+  throw ParsingFailed(FromHere(), "Expected " + expected + " at byte " + to_str(position()) + " of " + m_path.string());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
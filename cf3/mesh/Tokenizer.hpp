@@ -0,0 +1,135 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_Tokenizer_hpp
+#define cf3_mesh_Tokenizer_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <cstring>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "common/BasicExceptions.hpp"
+
+#include "mesh/LibMesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Reads tokens and binary values from a memory-mapped mesh file.
+/// Only the pages that are parsed are read from disk, so a process can jump to its own part of the file
+/// without reading what comes before it.
+class Mesh_API Tokenizer : public boost::noncopyable
+{
+public:
+
+  Tokenizer();
+
+  /// Map the given file into memory and go to its start
+  void open(const boost::filesystem::path& path);
+
+  /// Release the mapping
+  void close();
+
+  /// Size of the file in bytes
+  std::size_t size() const { return m_end - m_begin; }
+
+  /// Current byte offset
+  std::size_t position() const { return m_pos - m_begin; }
+
+  /// Go to the given byte offset
+  void seek(const std::size_t position);
+
+  /// The mapped file contents
+  const char* data() const { return m_begin; }
+
+  /// True if only whitespace is left
+  bool at_end();
+
+  /// Read an unsigned integer in text format
+  Uint read_uint();
+
+  /// Read an unsigned integer in text format that may exceed the range of Uint
+  std::size_t read_size();
+
+  /// Read a signed integer in text format
+  int read_int();
+
+  /// Read a real in text format
+  Real read_real();
+
+  /// Read a whitespace-separated word
+  std::string read_word();
+
+  /// Read a string between double quotes, which may contain whitespace. A word without quotes is also accepted.
+  std::string read_quoted();
+
+  /// Read the rest of the current line, without the end of line characters
+  std::string read_line();
+
+  /// Go to the start of the next line
+  void skip_line();
+
+  /// Skip the given number of lines
+  void skip_lines(const std::size_t nb_lines);
+
+  /// Read a value in binary format
+  template<typename T>
+  T read_binary()
+  {
+    if(m_end - m_pos < static_cast<std::ptrdiff_t>(sizeof(T)))
+      throw_parse_error("binary value");
+    T result;
+    std::memcpy(&result, m_pos, sizeof(T));
+    m_pos += sizeof(T);
+    return result;
+  }
+
+  /// Skip the given number of bytes
+  void skip_bytes(const std::size_t nb_bytes);
+
+  /// Number of end of line characters in the byte range [begin, end)
+  std::size_t count_lines(const std::size_t begin, const std::size_t end) const;
+
+  /// Offset just after the nb_lines-th end of line character at or after position
+  std::size_t find_line(const std::size_t position, const std::size_t nb_lines) const;
+
+  /// Offset of the first occurrence of str at or after position, or size() if there is none
+  std::size_t find(const std::string& str, const std::size_t position) const;
+
+  /// Throw a ParsingFailed exception, mentioning what was expected and the current position
+  void throw_parse_error(const std::string& expected) const;
+
+private:
+
+  void skip_whitespace()
+  {
+    while(m_pos != m_end && (*m_pos == ' ' || *m_pos == '\n' || *m_pos == '\r' || *m_pos == '\t'))
+      ++m_pos;
+  }
+
+  boost::iostreams::mapped_file_source m_mapping;
+  boost::filesystem::path m_path;
+  const char* m_begin;
+  const char* m_end;
+  const char* m_pos;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_Tokenizer_hpp
@@ -4,6 +4,7 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <iostream>
 
 #include <boost/assign/list_of.hpp>
@@ -11,6 +12,7 @@
 #include "common/BoostFilesystem.hpp"
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
+#include "common/OptionList.hpp"
 #include "common/PE/Comm.hpp"
 #include "common/Builder.hpp"
 #include "common/FindComponents.hpp"
@@ -39,10 +41,53 @@ common::ComponentBuilder < VTKLegacy::Writer, MeshWriter, LibVTKLegacy> aVTKLega
 
 //////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+/// Reverse the bytes of value if this machine is little-endian, since binary VTK legacy files are big-endian
+template<typename T>
+void to_big_endian(T& value)
+{
+  const int one = 1;
+  if(*reinterpret_cast<const char*>(&one) == 0)
+    return;
+  char* bytes = reinterpret_cast<char*>(&value);
+  std::reverse(bytes, bytes + sizeof(T));
+}
+
+/// Write the values in a single block in binary mode, or in rows of row_size values in ASCII mode.
+/// The values are byte-swapped in place in binary mode.
+template<typename T>
+void write_values(std::ostream& file, std::vector<T>& values, const Uint row_size, const bool binary)
+{
+  if(binary)
+  {
+    std::for_each(values.begin(), values.end(), to_big_endian<T>);
+    if(!values.empty())
+      file.write(reinterpret_cast<const char*>(&values[0]), values.size()*sizeof(T));
+    file << "\n";
+    return;
+  }
+
+  const Uint nb_values = values.size();
+  for(Uint i = 0; i != nb_values; i += row_size)
+  {
+    for(Uint j = i; j != i+row_size; ++j)
+      file << " " << values[j];
+    file << "\n";
+  }
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 Writer::Writer( const std::string& name )
 : MeshWriter(name)
 {
-
+  options().add("binary", true)
+    .description("Write the data as big-endian binary. The ASCII format is meant for debugging.")
+    .pretty_name("Binary");
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -58,6 +103,8 @@ std::vector<std::string> Writer::get_extensions()
 
 void Writer::write()
 {
+  const bool binary = options().value<bool>("binary");
+
   // if the file is present open it
   boost::filesystem::fstream file;
   boost::filesystem::path path(m_file_path.path());
@@ -66,7 +113,7 @@ void Writer::write()
     path = boost::filesystem::basename(path) + "_P" + to_str(PE::Comm::instance().rank()) + boost::filesystem::extension(path);
   }
 
-  file.open(path,std::ios_base::out);
+  file.open(path,binary ? std::ios_base::out | std::ios_base::binary : std::ios_base::out);
   if (!file) // didn't open so throw exception
   {
      throw boost::filesystem::filesystem_error( path.string() + " failed to open",
@@ -76,23 +123,23 @@ void Writer::write()
   file
     << "# vtk DataFile Version 2.0\n"
     << "Exported by COOLFLuiD\n"
-    << "ASCII\n"
+    << (binary ? "BINARY\n" : "ASCII\n")
     << "DATASET UNSTRUCTURED_GRID\n";
 
   const Field& coords = m_mesh->geometry_fields().coordinates();
   const Uint npoints = coords.size();
   const Uint dim = coords.row_size();
 
-  // Output point coordinates
+  // Output point coordinates, always in 3D
   file << "POINTS " << npoints << " double\n";
+  std::vector<Real> values(3*npoints, 0.);
   for(Uint i = 0; i != npoints; ++i)
   {
     const Field::ConstRow row = coords[i];
     for(Uint j = 0; j != dim; ++j)
-      file << " " << row[j];
-    if(dim == 2) file << " " << 0.;
-    file << "\n";
+      values[3*i+j] = row[j];
   }
+  write_values(file, values, 3, binary);
 
   // map for element types
   std::map<GeoShape::Type,int> etype_map = boost::assign::map_list_of
@@ -101,20 +148,9 @@ void Writer::write()
     (GeoShape::TETRA, 10)
     (GeoShape::HEXA, 12);
 
-  // Count number of elements, and the total number of connectivity nodes
-  Uint nb_elems = 0;
-  Uint nb_nodes = 0;
-  boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
-  {
-    if(elements.element_type().dimensionality() == dim && elements.element_type().order() == 1 && etype_map.count(elements.element_type().shape()))
-    {
-      nb_elems += elements.size();
-      nb_nodes += elements.size() + elements.size() * elements.element_type().nb_nodes();
-    }
-  }
-
-  // Output connectivity data
-  file << "\nCELLS " << nb_elems << " " << nb_nodes << "\n";
+  // Connectivity, with the number of nodes in front of each element, and element types
+  std::vector<int> connectivity;
+  std::vector<int> cell_types;
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
   {
     if(elements.element_type().dimensionality() == dim && elements.element_type().order() == 1 && etype_map.count(elements.element_type().shape()))
@@ -122,30 +158,38 @@ void Writer::write()
       const Uint n_elems = elements.size();
       const Connectivity& conn_table = elements.geometry_space().connectivity();
       const Uint n_el_nodes = elements.element_type().nb_nodes();
+      const int vtk_e_type = etype_map[elements.element_type().shape()];
+      connectivity.reserve(connectivity.size() + n_elems*(n_el_nodes+1));
+      cell_types.resize(cell_types.size() + n_elems, vtk_e_type);
       for(Uint i = 0; i != n_elems; ++i)
       {
-        file << " " << n_el_nodes;
+        connectivity.push_back(n_el_nodes);
         const Connectivity::ConstRow row = conn_table[i];
         for(Uint j = 0; j != n_el_nodes; ++j)
-          file << " " << row[j];
-        file << "\n";
+          connectivity.push_back(row[j]);
       }
     }
   }
 
-  // Output element types
-  file << "\nCELL_TYPES " << nb_elems << "\n";
-  boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
+  file << "\nCELLS " << cell_types.size() << " " << connectivity.size() << "\n";
+  if(binary)
   {
-    if(elements.element_type().dimensionality() == dim && elements.element_type().order() == 1 && etype_map.count(elements.element_type().shape()))
+    write_values(file, connectivity, 1, true);
+  }
+  else
+  {
+    // one element per line
+    for(Uint i = 0; i != connectivity.size(); i += connectivity[i] + 1)
     {
-      const int vtk_e_type = etype_map[elements.element_type().shape()];
-      const Uint n_elems = elements.size();
-      for(Uint i = 0; i != n_elems; ++i)
-        file << " " << vtk_e_type << "\n";
+      for(int j = 0; j <= connectivity[i]; ++j)
+        file << " " << connectivity[i+j];
+      file << "\n";
     }
   }
 
+  file << "\nCELL_TYPES " << cell_types.size() << "\n";
+  write_values(file, cell_types, 1, binary);
+
   // Output point fields TODO: support cell-centered data
   if(!m_fields.empty())
     file << "\nPOINT_DATA " << npoints << "\n";
@@ -169,21 +213,22 @@ void Writer::write()
       if(field.var_length(var_idx) == SCALAR)
       {
         file << "SCALARS " << var_name << " double\nLOOKUP_TABLE default\n";
+        values.resize(npoints);
         for(Uint i = 0; i != npoints; ++i)
-          file << " " << field[i][var_begin] << "\n";
+          values[i] = field[i][var_begin];
+        write_values(file, values, 1, binary);
       }
       else if(static_cast<Uint>(field.var_length(var_idx)) == dim)
       {
         file << "VECTORS " << var_name << " double\n";
-        const Uint var_end = var_begin+dim;
+        values.assign(3*npoints, 0.);
         for(Uint i = 0; i != npoints; ++i)
         {
           const Field::ConstRow row = field[i];
-          for(Uint j = var_begin; j != var_end; ++j)
-            file << " " << field[i][j];
-          if(dim == 2) file << " " << 0.;
-          file << "\n";
+          for(Uint j = 0; j != dim; ++j)
+            values[3*i+j] = row[var_begin+j];
         }
+        write_values(file, values, 3, binary);
       }
     }
   }
@@ -23,7 +23,8 @@ namespace VTKLegacy {
 
 //////////////////////////////////////////////////////////////////////////////
 
-/// This class defines VTKLegacy mesh format writer
+/// This class defines VTKLegacy mesh format writer.
+/// The binary format is written by default, with the data in big-endian byte order as required by VTK.
 /// @author Bart Janssens
 class VTKLegacy_API Writer : public MeshWriter
 {
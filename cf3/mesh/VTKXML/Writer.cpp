@@ -10,8 +10,15 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/assign/list_of.hpp>
 #include <boost/cstdint.hpp>
+#include <boost/bind.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "rapidxml/rapidxml.hpp"
 
@@ -22,6 +29,8 @@
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
 #include "common/Builder.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
 #include "common/FindComponents.hpp"
 #include "common/StringConversion.hpp"
 
@@ -49,128 +58,217 @@ namespace VTKXML {
 
 namespace detail
 {
-  struct CompressedStreamHeader
+  /// One array of the appended data, with its blocks once compressed
+  struct AppendedArray
   {
-    CompressedStreamHeader() :
-      nb_blocks(1),
-      blocksize(32768), // Same as in ParaView
-      last_blocksize(0)
+    AppendedArray(const XmlNode& array_node, const Uint nb_bytes) :
+      node(array_node)
     {
+      data.reserve(nb_bytes);
     }
 
-    boost::uint32_t nb_blocks;
-    const boost::uint32_t blocksize;
-    boost::uint32_t last_blocksize;
-    std::vector<boost::uint32_t> compressed_blocksizes;
+    /// The DataArray node, which gets the offset once all arrays are compressed
+    XmlNode node;
+
+    /// Uncompressed data, released after compression
+    std::vector<char> data;
+
+    /// Size of the uncompressed data
+    Uint nb_bytes;
+
+    /// Compressed blocks
+    std::vector<std::string> blocks;
   };
 
-  struct CompressedStream
+  /// Size of the uncompressed blocks, same as in ParaView
+  const Uint blocksize = 32768;
+
+  /// Compress blocks [begin, end) of an array with zlib
+  void compress_blocks(AppendedArray& array, const int level, const Uint begin, const Uint end)
   {
-    CompressedStream() :
-      data_stream(std::ios_base::in | std::ios_base::out | std::ios_base::binary),
-      m_current_block(std::ios_base::in | std::ios_base::out | std::ios_base::binary)
+    const Uint nb_bytes = array.data.size();
+    for(Uint block = begin; block != end; ++block)
     {
-      // VTK data starts with a _
-      data_stream.write("_", 1);
+      const Uint block_begin = block*blocksize;
+      boost::iostreams::filtering_ostream compressed_stream;
+      compressed_stream.push(boost::iostreams::zlib_compressor(boost::iostreams::zlib_params(level)));
+      compressed_stream.push(boost::iostreams::back_inserter(array.blocks[block]));
+      compressed_stream.write(&array.data[block_begin], std::min(blocksize, nb_bytes - block_begin));
+      boost::iostreams::close(compressed_stream);
     }
+  }
 
-    /// Start writing a new array
-    void start_array(const Uint nb_elems, const Uint wordsize)
+  /// Collects the arrays in the appended data section of the file. Each finished array is compressed in the background
+  /// by a team of threads while the next array is filled, with the blocks of the array divided over the threads.
+  /// With compression level 0, the arrays are stored raw, each preceded by its size in bytes.
+  class AppendedData : public boost::noncopyable
+  {
+  public:
+    AppendedData(const Uint compression_level, const Uint nb_threads) :
+      m_level(compression_level),
+      m_nb_threads(nb_threads)
     {
-      m_wordsize = wordsize;
-
-      const Uint nb_bytes = nb_elems * wordsize;
-      m_header.last_blocksize = nb_bytes % m_header.blocksize;
-      if(m_header.last_blocksize)
-      {
-        m_header.nb_blocks = nb_bytes / m_header.blocksize + 1;
-      }
-      else
-      {
-        m_header.last_blocksize = m_header.blocksize;
-        m_header.nb_blocks = nb_bytes / m_header.blocksize;
-      }
-
-      m_header.compressed_blocksizes.clear();
-      m_header.compressed_blocksizes.reserve(m_header.nb_blocks);
+    }
 
-      // Write known header info
-      data_stream.write(reinterpret_cast<const char*>(&m_header.nb_blocks), 4);
-      data_stream.write(reinterpret_cast<const char*>(&m_header.blocksize), 4);
-      data_stream.write(reinterpret_cast<const char*>(&m_header.last_blocksize), 4);
+    ~AppendedData()
+    {
+      if(m_compression_thread)
+        m_compression_thread->join();
+    }
 
-      // save filepointer
-      m_compressed_sizes_start = data_stream.tellp();
+    bool compressed() const
+    {
+      return m_level != 0;
+    }
 
-      // Reserve space for compressed block sizes
-      for(Uint i = 0; i != m_header.nb_blocks; ++i)
-        data_stream.write(reinterpret_cast<const char*>(&m_header.nb_blocks), 4);
+    /// Start writing a new array, for the given DataArray node
+    void start_array(XmlNode& array_node, const Uint nb_elems, const Uint wordsize)
+    {
+      // The offset is only known when the preceding arrays are compressed
+      array_node.set_attribute("offset", "0");
+      m_wordsize = wordsize;
+      m_arrays.push_back(boost::shared_ptr<AppendedArray>(new AppendedArray(array_node, nb_elems*wordsize)));
+      m_current_data = &m_arrays.back()->data;
     }
 
-    /// Finish writing the current array
+    /// Finish writing the current array, and start compressing it
     void finish_array()
     {
-      // Write the last block
-      cf3_assert(static_cast<Uint>(m_current_block.tellp()) == static_cast<Uint>(m_header.last_blocksize));
-      compress_block();
+      if(!compressed())
+        return;
 
-      // go back to the header
-      const Uint stream_end = data_stream.tellp();
-      data_stream.seekp(m_compressed_sizes_start);
+      // only one array is compressed at a time
+      wait();
 
-      // Write actual compressed block sizes
-      for(Uint i = 0; i != m_header.nb_blocks; ++i)
-        data_stream.write(reinterpret_cast<const char*>(&m_header.compressed_blocksizes[i]), 4);
-
-      // go back to the stream end
-      data_stream.seekp(stream_end);
+      AppendedArray& array = *m_arrays.back();
+      array.nb_bytes = array.data.size();
+      array.blocks.resize((array.nb_bytes + blocksize - 1) / blocksize);
+      if(m_nb_threads == 1)
+      {
+        compress_blocks(array, m_level, 0, array.blocks.size());
+        array.data = std::vector<char>();
+      }
+      else
+      {
+        m_compression_thread.reset(new boost::thread(boost::bind(&AppendedData::compress_array, this, boost::ref(array))));
+      }
     }
 
     /// Append a value to the stream
     template<typename ValueT>
     void push_back(const ValueT& value)
     {
-      // Block is full, write it to the compressed stream
-      if(m_current_block.tellp() == static_cast<std::streampos>(m_header.blocksize))
-        compress_block();
+      const char* bytes = reinterpret_cast<const char*>(&value);
+      m_current_data->insert(m_current_data->end(), bytes, bytes + m_wordsize);
+    }
+
+    /// Wait for the compression to finish, and set the offset of each array in its DataArray node.
+    /// The offsets are counted from the position after the _ that starts the data.
+    void finish()
+    {
+      wait();
+      Uint offset = 0;
+      boost_foreach(const boost::shared_ptr<AppendedArray>& array, m_arrays)
+      {
+        array->node.set_attribute("offset", to_str(offset));
+        if(compressed())
+        {
+          offset += 4*(3 + array->blocks.size());
+          boost_foreach(const std::string& block, array->blocks)
+            offset += block.size();
+        }
+        else
+        {
+          offset += 4 + array->data.size();
+        }
+      }
+    }
 
-      m_current_block.write(reinterpret_cast<const char*>(&value), m_wordsize);
+    /// Write the data, after finish was called
+    void write(std::ostream& out) const
+    {
+      // VTK data starts with a _
+      out.write("_", 1);
+      boost_foreach(const boost::shared_ptr<AppendedArray>& array, m_arrays)
+      {
+        if(compressed())
+        {
+          const Uint nb_bytes = array->nb_bytes;
+          const boost::uint32_t header[3] = { static_cast<boost::uint32_t>(array->blocks.size()), blocksize, nb_bytes % blocksize ? nb_bytes % blocksize : blocksize };
+          out.write(reinterpret_cast<const char*>(header), 12);
+          boost_foreach(const std::string& block, array->blocks)
+          {
+            const boost::uint32_t compressed_size = block.size();
+            out.write(reinterpret_cast<const char*>(&compressed_size), 4);
+          }
+          boost_foreach(const std::string& block, array->blocks)
+            out.write(block.data(), block.size());
+        }
+        else
+        {
+          const boost::uint32_t nb_bytes = array->data.size();
+          out.write(reinterpret_cast<const char*>(&nb_bytes), 4);
+          if(nb_bytes)
+            out.write(&array->data[0], nb_bytes);
+        }
+      }
     }
 
-    // Offset to put in the VTK XML (= offset after the _)
-    Uint offset()
+  private:
+    /// Compress all blocks of the array, divided over the threads
+    void compress_array(AppendedArray& array)
     {
-      return static_cast<Uint>(data_stream.tellp()) - 1u;
+      const Uint nb_blocks = array.blocks.size();
+      const Uint nb_threads = std::max(1u, std::min(m_nb_threads, nb_blocks));
+      boost::thread_group threads;
+      for(Uint t = 1; t < nb_threads; ++t)
+        threads.create_thread(boost::bind(&AppendedData::compress_chunk, this, boost::ref(array), (nb_blocks*t)/nb_threads, (nb_blocks*(t+1))/nb_threads));
+      compress_chunk(array, 0, nb_blocks/nb_threads);
+      threads.join_all();
+      array.data = std::vector<char>();
     }
 
-    // Compress the current block and append it to the data stream
-    void compress_block()
+    /// Compress blocks [begin, end), keeping the error if there is one
+    void compress_chunk(AppendedArray& array, const Uint begin, const Uint end)
     {
-      // set up zlib compressor
-      boost::iostreams::filtering_stream<boost::iostreams::input> compressed_stream;
-      compressed_stream.push(boost::iostreams::zlib_compressor());
-      compressed_stream.push(m_current_block);
-
-      // write data and store compressed size
-      const Uint before = data_stream.tellp();
-      data_stream << compressed_stream.rdbuf();
-      m_header.compressed_blocksizes.push_back(static_cast<Uint>(data_stream.tellp()) - before);
-
-      // clear current block
-      m_current_block.str(std::string());
+      try
+      {
+        compress_blocks(array, m_level, begin, end);
+      }
+      catch(std::exception& e)
+      {
+        boost::mutex::scoped_lock lock(m_error_mutex);
+        m_error = e.what();
+      }
     }
 
-    CompressedStreamHeader m_header;
+    /// Wait until the array that is being compressed is done
+    void wait()
+    {
+      if(m_compression_thread)
+      {
+        m_compression_thread->join();
+        m_compression_thread.reset();
+      }
+      if(!m_error.empty())
+        throw FileSystemError(FromHere(), "Compression of VTK data failed: " + m_error);
+    }
 
-    /// File pointer where the compressed sizes start
-    Uint m_compressed_sizes_start;
+    const int m_level;
+    const Uint m_nb_threads;
 
     Uint m_wordsize;
 
-    // Uncompressed data for the block that is being appended to
-    std::stringstream m_current_block;
+    std::vector< boost::shared_ptr<AppendedArray> > m_arrays;
+
+    /// Data of the array that is being filled
+    std::vector<char>* m_current_data;
 
-    std::stringstream data_stream;
+    boost::scoped_ptr<boost::thread> m_compression_thread;
+
+    /// Error message from the compression threads
+    boost::mutex m_error_mutex;
+    std::string m_error;
   };
 
   // Recursively transform nodes to their parallel counterparts
@@ -206,6 +304,11 @@ Writer::Writer( const std::string& name )
     options().add("distributed_files", false)
     .pretty_name("Distributed Files")
     .description("Indicate if the filesystem is local to each note. When true, the pvtu file is written on each node.");
+
+    options().add("compression_level", 6u)
+    .pretty_name("Compression Level")
+    .description("zlib compression level of the data, from 1 (fastest) to 9 (smallest). 0 writes the data uncompressed. "
+                 "Blocks are compressed by the number of threads set in the environment.");
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -235,7 +338,8 @@ void Writer::write()
   vtkfile.set_attribute("type", "UnstructuredGrid");
   vtkfile.set_attribute("version", "0.1");
   vtkfile.set_attribute("byte_order", "LittleEndian");
-  vtkfile.set_attribute("compressor", "vtkZLibDataCompressor");
+  if(options().value<Uint>("compression_level") != 0)
+    vtkfile.set_attribute("compressor", "vtkZLibDataCompressor");
 
   XmlNode unstructured_grid = vtkfile.add_node("UnstructuredGrid");
 
@@ -268,15 +372,17 @@ void Writer::write()
   piece.set_attribute("NumberOfCells", to_str(nb_elems));
 
   // Points output
-  detail::CompressedStream appended_data;
+  const Uint compression_level = options().value<Uint>("compression_level");
+  if(compression_level > 9)
+    throw BadValue(FromHere(), "Compression level " + to_str(compression_level) + " is invalid, it must be between 0 and 9");
+  detail::AppendedData appended_data(compression_level, Core::instance().environment().options().value<Uint>("nb_threads"));
 
   XmlNode points_data = piece.add_node("Points").add_node("DataArray");
   points_data.set_attribute("type", sizeof(Real) == 4 ? "Float32" : "Float64");
   points_data.set_attribute("NumberOfComponents", "3");
   points_data.set_attribute("format", "appended");
-  points_data.set_attribute("offset", to_str(appended_data.offset()));
 
-  appended_data.start_array(3*npoints, sizeof(Real));
+  appended_data.start_array(points_data, 3*npoints, sizeof(Real));
   for(Uint i = 0; i != npoints; ++i)
   {
     const Field::ConstRow row = coords[i];
@@ -293,8 +399,7 @@ void Writer::write()
   connectivity.set_attribute("type", "UInt32");
   connectivity.set_attribute("Name", "connectivity");
   connectivity.set_attribute("format", "appended");
-  connectivity.set_attribute("offset", to_str(appended_data.offset()));
-  appended_data.start_array(nb_conn_nodes, 4);
+  appended_data.start_array(connectivity, nb_conn_nodes, 4);
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
   {
     if(elements.element_type().dimensionality() == dim && elements.element_type().order() == 1 && etype_map.count(elements.element_type().shape()))
@@ -317,9 +422,8 @@ void Writer::write()
   offsets.set_attribute("type", "UInt32");
   offsets.set_attribute("Name", "offsets");
   offsets.set_attribute("format", "appended");
-  offsets.set_attribute("offset", to_str(appended_data.offset()));
   boost::uint32_t offset = 0;
-  appended_data.start_array(nb_elems, 4);
+  appended_data.start_array(offsets, nb_elems, 4);
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
   {
     if(elements.element_type().dimensionality() == dim && elements.element_type().order() == 1 && etype_map.count(elements.element_type().shape()))
@@ -339,8 +443,7 @@ void Writer::write()
   types.set_attribute("type", "UInt8");
   types.set_attribute("Name", "types");
   types.set_attribute("format", "appended");
-  types.set_attribute("offset", to_str(appended_data.offset()));
-  appended_data.start_array(nb_elems, 1);
+  appended_data.start_array(types, nb_elems, 1);
   boost_foreach(const Elements& elements, find_components_recursively<Elements>(m_mesh->topology()) )
   {
     if(elements.element_type().dimensionality() == dim && elements.element_type().order() == 1 && etype_map.count(elements.element_type().shape()))
@@ -385,9 +488,8 @@ void Writer::write()
       data_array.set_attribute("NumberOfComponents", to_str(var_size == 2 && dim == 2 ? 3 : var_size));
       data_array.set_attribute("Name", var_name);
       data_array.set_attribute("format", "appended");
-      data_array.set_attribute("offset", to_str(appended_data.offset()));
 
-      appended_data.start_array(field_size*(var_size == 2 && dim == 2 ? 3 : var_size), sizeof(Real));
+      appended_data.start_array(data_array, field_size*(var_size == 2 && dim == 2 ? 3 : var_size), sizeof(Real));
 
       if(field.continuous())
       {
@@ -448,8 +550,10 @@ void Writer::write()
     }
   }
 
+  appended_data.finish();
+
   // Write to file, inserting the binary data at the end
-  std::cout << "writing file " << my_path.path() << std::endl;
+  CFinfo << "writing file " << my_path.path() << CFendl;
   boost::filesystem::fstream fout(my_path.path(), std::ios_base::out | std::ios_base::binary);
 
   // Remove the closing tag
@@ -463,7 +567,7 @@ void Writer::write()
 
   // Append  compressed data
   fout << "\n<AppendedData encoding=\"raw\">\n";
-  fout << appended_data.data_stream.rdbuf();
+  appended_data.write(fout);
   fout << "\n</AppendedData>\n</VTKFile>\n";
 
   fout.close();
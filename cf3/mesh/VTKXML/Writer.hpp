@@ -23,7 +23,9 @@ namespace VTKXML {
 
 //////////////////////////////////////////////////////////////////////////////
 
-/// This class defines VTKXML mesh format writer
+/// This class defines VTKXML mesh format writer.
+/// The data is appended in zlib compressed blocks, which are compressed in the background by nb_threads threads
+/// (an option of the environment) while the next array is collected.
 /// @author Bart Janssens
 class VTKXML_API Writer : public MeshWriter
 {
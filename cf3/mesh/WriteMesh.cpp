@@ -110,9 +110,11 @@ void WriteMesh::update_list_of_available_writers()
 #endif
     ("cf3.mesh.gmsh.Writer")
     ("cf3.mesh.neu.Writer")
+    ("cf3.mesh.cf3mesh.Writer")
     ("cf3.mesh.tecplot.Writer")
     ("cf3.mesh.VTKLegacy.Writer")
-    ("cf3.mesh.VTKXML.Writer");
+    ("cf3.mesh.VTKXML.Writer")
+    ("cf3.mesh.XDMF.Writer");
 
   boost_foreach(const std::string& writer_name, known_writers)
   {
@@ -160,19 +162,29 @@ void WriteMesh::write_mesh( const Mesh& mesh, const URI& file )
 
 void WriteMesh::write_mesh( const Mesh& mesh, const URI& file, const std::vector<URI>& fields)
 {
-  update_list_of_available_writers();
-
   /// @todo this should be improved to allow http(s) which would then upload the mesh
   ///       to a remote location after writing to a temporary file
   ///       uploading can be achieved using the curl library (which we already search for in the build system)
 
-  URI filepath = file;
+  const URI filepath = expand_file_path(mesh, file);
 
-  if( filepath.scheme() != URI::Scheme::FILE )
-    filepath.scheme( URI::Scheme::FILE );
+  // get the correct writer based on the extension
+
+  Handle< MeshWriter > writer = find_writer(filepath);
+  writer->options().set("fields",fields);
+  writer->options().set("mesh",mesh.handle<Mesh>());
+  writer->options().set("file", filepath);
 
+  writer->execute();
+}
 
-  const std::string extension = filepath.extension();
+////////////////////////////////////////////////////////////////////////////////
+
+Handle<MeshWriter> WriteMesh::find_writer(const URI& file)
+{
+  update_list_of_available_writers();
+
+  const std::string extension = file.extension();
 
   if ( m_extensions_to_writers.count(extension) == 0 )
     throw FileFormatError (FromHere(), "No meshwriter exists for files with extension " + extension);
@@ -180,13 +192,25 @@ void WriteMesh::write_mesh( const Mesh& mesh, const URI& file, const std::vector
   if (m_extensions_to_writers[extension].size()>1)
   {
      std::string msg;
-     msg = filepath.string() + " has ambiguous extension " + extension + "\n"
+     msg = file.string() + " has ambiguous extension " + extension + "\n"
        +  "Possible writers for this extension are: \n";
      boost_foreach(const Handle< MeshWriter > writer , m_extensions_to_writers[extension])
        msg += " - " + writer->name() + "\n";
      throw FileFormatError( FromHere(), msg);
    }
 
+  return m_extensions_to_writers[extension][0];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+URI WriteMesh::expand_file_path(const Mesh& mesh, const URI& file)
+{
+  URI filepath = file;
+
+  if( filepath.scheme() != URI::Scheme::FILE )
+    filepath.scheme( URI::Scheme::FILE );
+
   // substitute the regex wildcards in the file name
 
   const MeshMetadata& metadata = mesh.metadata();
@@ -229,15 +253,7 @@ void WriteMesh::write_mesh( const Mesh& mesh, const URI& file, const std::vector
   // change the path in the filepath
 
   filepath.path( file_str );
-
-  // get the correct writer based on the extension
-
-  Handle< MeshWriter > writer = m_extensions_to_writers[extension][0];
-  writer->options().set("fields",fields);
-  writer->options().set("mesh",mesh.handle<Mesh>());
-  writer->options().set("file", filepath);
-
-  writer->execute();
+  return filepath;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
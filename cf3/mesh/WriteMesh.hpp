@@ -60,6 +60,14 @@ public: // functions
   /// writes all the fields on the mesh
   void write_mesh( const Mesh&, const common::URI& file);
 
+  /// Writer registered for the extension of the given file
+  /// @throws FileFormatError if no writer or more than one writer handles the extension
+  Handle<MeshWriter> find_writer(const common::URI& file);
+
+  /// Substitute the ${name} patterns in the file name by the corresponding mesh metadata,
+  /// e.g. ${iter} and ${time}
+  static common::URI expand_file_path(const Mesh& mesh, const common::URI& file);
+
   virtual void execute();
 
 protected: // helper functions
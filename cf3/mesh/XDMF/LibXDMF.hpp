@@ -0,0 +1,73 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_XDMF_LibXDMF_hpp
+#define cf3_mesh_XDMF_LibXDMF_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Library.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Define the macro XDMF_API
+/// @note build system defines COOLFLUID_MESH_XDMF_EXPORTS when compiling XDMF files
+#ifdef COOLFLUID_MESH_XDMF_EXPORTS
+#   define XDMF_API      CF3_EXPORT_API
+#   define XDMF_TEMPLATE
+#else
+#   define XDMF_API      CF3_IMPORT_API
+#   define XDMF_TEMPLATE CF3_TEMPLATE_EXTERN
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+
+/// @brief Library for output in the XDMF format
+namespace XDMF {
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Class defines the XDMF mesh format operations
+class XDMF_API LibXDMF : public common::Library
+{
+public:
+
+  /// Constructor
+  LibXDMF ( const std::string& name) : common::Library(name) {   }
+
+  /// @return string of the library namespace
+  static std::string library_namespace() { return "cf3.mesh.XDMF"; }
+
+  /// Static function that returns the library name.
+  /// Must be implemented for Library registration
+  /// @return name of the library
+  static std::string library_name() { return "XDMF"; }
+
+  /// Static function that returns the description of the library.
+  /// Must be implemented for Library registration
+  /// @return description of the library
+
+  static std::string library_description()
+  {
+    return "This library implements the XDMF mesh format, writing one shared file for all processes with MPI-IO.";
+  }
+
+  /// Gets the Class name
+  static std::string type_name() { return "LibXDMF"; }
+}; // LibXDMF
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // XDMF
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_XDMF_LibXDMF_hpp
@@ -0,0 +1,441 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/Log.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "common/XML/FileOperations.hpp"
+#include "common/XML/XmlDoc.hpp"
+#include "common/XML/XmlNode.hpp"
+
+#include "mesh/XDMF/Writer.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/GeoShape.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/Space.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3::common;
+using namespace cf3::common::XML;
+
+namespace cf3 {
+namespace mesh {
+namespace XDMF {
+
+namespace detail
+{
+  /// Largest number of bytes written by a single MPI call, well below INT_MAX
+  const boost::uint64_t max_chunk_size = 1u << 30;
+
+  /// The binary file shared by all processes. When MPI is running, every process writes its part
+  /// using collective MPI-IO, so every process must make the same sequence of calls.
+  /// Otherwise a plain file stream is used.
+  class SharedFile : public boost::noncopyable
+  {
+  public:
+    SharedFile(const std::string& path) :
+      m_parallel(PE::Comm::instance().is_active())
+    {
+      if(m_parallel)
+      {
+        MPI_CHECK_RESULT(MPI_File_open, (PE::Comm::instance().communicator(), const_cast<char*>(path.c_str()), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &m_file));
+        MPI_CHECK_RESULT(MPI_File_set_size, (m_file, 0));
+      }
+      else
+      {
+        m_stream.open(path.c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        if(!m_stream.is_open())
+          throw FileSystemError(FromHere(), "Could not open file " + path);
+      }
+    }
+
+    ~SharedFile()
+    {
+      if(m_parallel)
+        MPI_File_close(&m_file);
+    }
+
+    /// Write the contiguous values of this process at the given offset in bytes
+    template<typename T>
+    void write_at(const boost::uint64_t offset, const std::vector<T>& values)
+    {
+      const boost::uint64_t nb_bytes = static_cast<boost::uint64_t>(values.size())*sizeof(T);
+      char dummy = 0;
+      char* data = values.empty() ? &dummy : reinterpret_cast<char*>(const_cast<T*>(&values[0]));
+      if(m_parallel)
+      {
+        // MPI counts are int, so the data is written in chunks. The calls are collective, so every process
+        // makes as many calls as the process with the most chunks, writing nothing once its data is exhausted.
+        const Uint local_nb_chunks = static_cast<Uint>((nb_bytes + max_chunk_size - 1) / max_chunk_size);
+        Uint nb_chunks = 0;
+        PE::Comm::instance().all_reduce(PE::max(), &local_nb_chunks, 1, &nb_chunks);
+        for(Uint chunk = 0; chunk != nb_chunks; ++chunk)
+        {
+          const boost::uint64_t chunk_begin = std::min(static_cast<boost::uint64_t>(chunk)*max_chunk_size, nb_bytes);
+          const int chunk_bytes = static_cast<int>(std::min(max_chunk_size, nb_bytes - chunk_begin));
+          MPI_Status status;
+          MPI_CHECK_RESULT(MPI_File_write_at_all, (m_file, static_cast<MPI_Offset>(offset + chunk_begin), chunk_bytes == 0 ? &dummy : data + chunk_begin, chunk_bytes, MPI_BYTE, &status));
+        }
+      }
+      else if(nb_bytes != 0)
+      {
+        m_stream.seekp(offset);
+        m_stream.write(data, nb_bytes);
+      }
+    }
+
+    /// Write rows of row_size values in a table starting at block_offset (in bytes), each row going to the given position
+    /// in the table. The positions must be increasing. This is how the nodes of all processes end up in a single table,
+    /// ordered by global index.
+    void write_rows(const boost::uint64_t block_offset, const std::vector<double>& values, const std::vector<Uint>& positions, const Uint row_size)
+    {
+      cf3_assert(values.size() == positions.size()*row_size);
+      if(m_parallel)
+      {
+        MPI_Datatype filetype = MPI_DOUBLE;
+        if(!positions.empty())
+        {
+          std::vector<MPI_Aint> displacements(positions.size());
+          for(Uint i = 0; i != positions.size(); ++i)
+            displacements[i] = static_cast<MPI_Aint>(positions[i])*row_size*sizeof(double);
+          MPI_CHECK_RESULT(MPI_Type_create_hindexed_block, (static_cast<int>(positions.size()), static_cast<int>(row_size), &displacements[0], MPI_DOUBLE, &filetype));
+          MPI_CHECK_RESULT(MPI_Type_commit, (&filetype));
+        }
+
+        double dummy = 0.;
+        double* data = values.empty() ? &dummy : const_cast<double*>(&values[0]);
+        MPI_Status status;
+        MPI_CHECK_RESULT(MPI_File_set_view, (m_file, static_cast<MPI_Offset>(block_offset), MPI_DOUBLE, filetype, const_cast<char*>("native"), MPI_INFO_NULL));
+        MPI_CHECK_RESULT(MPI_File_write_at_all, (m_file, 0, data, static_cast<int>(values.size()), MPI_DOUBLE, &status));
+        MPI_CHECK_RESULT(MPI_File_set_view, (m_file, 0, MPI_BYTE, MPI_BYTE, const_cast<char*>("native"), MPI_INFO_NULL));
+
+        if(filetype != MPI_DOUBLE)
+          MPI_Type_free(&filetype);
+      }
+      else
+      {
+        for(Uint i = 0; i != positions.size(); ++i)
+        {
+          m_stream.seekp(block_offset + static_cast<boost::uint64_t>(positions[i])*row_size*sizeof(double));
+          m_stream.write(reinterpret_cast<const char*>(&values[i*row_size]), row_size*sizeof(double));
+        }
+      }
+    }
+
+  private:
+    const bool m_parallel;
+    MPI_File m_file;
+    std::ofstream m_stream;
+  };
+
+  /// Orders local node indices by global index
+  struct GlobalIndexLess
+  {
+    GlobalIndexLess(const common::List<Uint>& glb_idx) : m_glb_idx(glb_idx) {}
+
+    bool operator()(const Uint a, const Uint b) const
+    {
+      return m_glb_idx[a] < m_glb_idx[b];
+    }
+
+    const common::List<Uint>& m_glb_idx;
+  };
+
+  /// Element type number in XDMF mixed topologies, 0 if the shape is not supported
+  boost::uint32_t xdmf_type(const GeoShape::Type shape)
+  {
+    switch(shape)
+    {
+      case GeoShape::TRIAG: return 4;
+      case GeoShape::QUAD:  return 5;
+      case GeoShape::TETRA: return 6;
+      case GeoShape::PYRAM: return 7;
+      case GeoShape::PRISM: return 8;
+      case GeoShape::HEXA:  return 9;
+      default:              return 0;
+    }
+  }
+
+  /// XDMF attribute type for a variable with the given number of components
+  std::string attribute_type(const Uint nb_components)
+  {
+    switch(nb_components)
+    {
+      case 1: return "Scalar";
+      case 3: return "Vector";
+      case 6: return "Tensor6";
+      case 9: return "Tensor";
+      default: return "Matrix";
+    }
+  }
+
+  /// Add a DataItem node referring to a block of the binary file
+  void add_data_item(XmlNode& parent, const std::string& dimensions, const std::string& number_type, const Uint precision,
+                     const boost::uint64_t offset, const std::string& filename)
+  {
+    XmlNode data_item = parent.add_node("DataItem", filename);
+    data_item.set_attribute("Dimensions", dimensions);
+    data_item.set_attribute("NumberType", number_type);
+    data_item.set_attribute("Precision", to_str(precision));
+    data_item.set_attribute("Format", "Binary");
+    data_item.set_attribute("Endian", "Native");
+    data_item.set_attribute("Seek", to_str(offset));
+  }
+
+} // namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < XDMF::Writer, MeshWriter, LibXDMF> aXDMFWriter_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+Writer::Writer( const std::string& name )
+: MeshWriter(name)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> Writer::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".xmf");
+  extensions.push_back(".xdmf");
+  return extensions;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write()
+{
+  PE::Comm& comm = PE::Comm::instance();
+  const bool parallel = comm.is_active();
+  const Uint rank = parallel ? comm.rank() : 0;
+
+  const Dictionary& geometry = m_mesh->geometry_fields();
+  const common::List<Uint>& glb_idx = geometry.glb_idx();
+  const Uint dim = m_mesh->dimension();
+
+  // Owned nodes, sorted by global index, which is their position in the file
+  std::vector<Uint> nodes;
+  nodes.reserve(geometry.size());
+  for(Uint i = 0; i != geometry.size(); ++i)
+  {
+    if(!geometry.is_ghost(i))
+      nodes.push_back(i);
+  }
+  std::sort(nodes.begin(), nodes.end(), detail::GlobalIndexLess(glb_idx));
+
+  std::vector<Uint> node_positions(nodes.size());
+  Uint nb_nodes = 0;
+  for(Uint i = 0; i != nodes.size(); ++i)
+  {
+    node_positions[i] = glb_idx[nodes[i]];
+    nb_nodes = std::max(nb_nodes, node_positions[i] + 1);
+  }
+  if(parallel)
+  {
+    const Uint local_nb_nodes = nb_nodes;
+    comm.all_reduce(PE::max(), &local_nb_nodes, 1, &nb_nodes);
+  }
+
+  // Owned elements of the entities that are written
+  std::vector< Handle<Entities const> > written_entities;
+  std::vector< std::vector<Uint> > elements;
+  Uint local_nb_elements = 0;
+  Uint local_topology_size = 0;
+  boost_foreach(const Handle<Entities const>& entities, m_filtered_entities)
+  {
+    const ElementType& etype = entities->element_type();
+    if(etype.dimensionality() != dim || etype.order() != 1 || detail::xdmf_type(etype.shape()) == 0)
+      continue;
+
+    written_entities.push_back(entities);
+    elements.push_back(std::vector<Uint>());
+    for(Uint e = 0; e != entities->size(); ++e)
+    {
+      if(!entities->is_ghost(e))
+        elements.back().push_back(e);
+    }
+    local_nb_elements += elements.back().size();
+    local_topology_size += elements.back().size() * (1 + etype.nb_nodes());
+  }
+
+  // The elements of this process come after the ones of the lower ranks
+  boost::uint64_t element_offset = 0;
+  boost::uint64_t topology_offset = 0;
+  boost::uint64_t nb_elements = local_nb_elements;
+  boost::uint64_t topology_size = local_topology_size;
+  if(parallel)
+  {
+    std::vector<Uint> all_nb_elements;
+    std::vector<Uint> all_topology_sizes;
+    comm.all_gather(local_nb_elements, all_nb_elements);
+    comm.all_gather(local_topology_size, all_topology_sizes);
+    nb_elements = 0;
+    topology_size = 0;
+    for(Uint p = 0; p != all_nb_elements.size(); ++p)
+    {
+      if(p == rank)
+      {
+        element_offset = nb_elements;
+        topology_offset = topology_size;
+      }
+      nb_elements += all_nb_elements[p];
+      topology_size += all_topology_sizes[p];
+    }
+  }
+
+  const std::string data_filename = m_file_path.base_name() + ".bin";
+  detail::SharedFile file((m_file_path.base_path() / URI(data_filename)).path());
+
+  XmlDoc doc("1.0");
+  XmlNode xdmf = doc.add_node("Xdmf");
+  xdmf.set_attribute("Version", "2.0");
+  XmlNode grid = xdmf.add_node("Domain").add_node("Grid");
+  grid.set_attribute("Name", m_mesh->name());
+  grid.set_attribute("GridType", "Uniform");
+  if(m_mesh->metadata().check("time"))
+    grid.add_node("Time").set_attribute("Value", m_mesh->metadata().properties().value_str("time"));
+
+  boost::uint64_t offset = 0;
+  std::vector<double> values;
+
+  // Coordinates, always 3D
+  const Field& coordinates = geometry.coordinates();
+  values.reserve(3*nodes.size());
+  boost_foreach(const Uint node, nodes)
+  {
+    for(Uint j = 0; j != 3; ++j)
+      values.push_back(j < dim ? static_cast<double>(coordinates[node][j]) : 0.);
+  }
+  file.write_rows(offset, values, node_positions, 3);
+
+  XmlNode geometry_node = grid.add_node("Geometry");
+  geometry_node.set_attribute("GeometryType", "XYZ");
+  detail::add_data_item(geometry_node, to_str(nb_nodes) + " 3", "Float", 8, offset, data_filename);
+  offset += static_cast<boost::uint64_t>(nb_nodes)*3*sizeof(double);
+
+  // Mixed topology: each element is its type followed by the global indices of its nodes
+  std::vector<boost::uint32_t> topology;
+  topology.reserve(local_topology_size);
+  for(Uint i = 0; i != written_entities.size(); ++i)
+  {
+    const boost::uint32_t type = detail::xdmf_type(written_entities[i]->element_type().shape());
+    const Connectivity& connectivity = written_entities[i]->geometry_space().connectivity();
+    boost_foreach(const Uint e, elements[i])
+    {
+      topology.push_back(type);
+      boost_foreach(const Uint node, connectivity[e])
+        topology.push_back(glb_idx[node]);
+    }
+  }
+  file.write_at(offset + topology_offset*sizeof(boost::uint32_t), topology);
+
+  XmlNode topology_node = grid.add_node("Topology");
+  topology_node.set_attribute("TopologyType", "Mixed");
+  topology_node.set_attribute("NumberOfElements", to_str(nb_elements));
+  detail::add_data_item(topology_node, to_str(topology_size), "UInt", 4, offset, data_filename);
+  offset += topology_size*sizeof(boost::uint32_t);
+
+  // Fields, one attribute per variable
+  std::set<std::string> added_fields;
+  boost_foreach(const Handle<Field const>& field_ptr, m_fields)
+  {
+    const Field& field = *field_ptr;
+    if(!added_fields.insert(field.uri().string()).second)
+      continue;
+
+    const bool point_data = &field.dict() == &geometry;
+    if(!point_data && field.continuous())
+    {
+      if(rank == 0)
+        CFwarn << "XDMF writer skips field " << field.uri().string() << ", which is neither defined on the geometry nodes nor discontinuous" << CFendl;
+      continue;
+    }
+
+    for(Uint var_idx = 0; var_idx != field.nb_vars(); ++var_idx)
+    {
+      const Uint var_begin = field.var_offset(var_idx);
+      const Uint var_length = field.var_length(var_idx);
+      // 2D vectors are padded to 3 components, as for the coordinates
+      const Uint nb_components = (var_length == 2 && dim == 2) ? 3 : var_length;
+
+      values.clear();
+      boost::uint64_t nb_rows = 0;
+      if(point_data)
+      {
+        values.reserve(nb_components*nodes.size());
+        boost_foreach(const Uint node, nodes)
+        {
+          for(Uint j = 0; j != nb_components; ++j)
+            values.push_back(j < var_length ? static_cast<double>(field[node][var_begin+j]) : 0.);
+        }
+        file.write_rows(offset, values, node_positions, nb_components);
+        nb_rows = nb_nodes;
+      }
+      else
+      {
+        values.reserve(nb_components*local_nb_elements);
+        for(Uint i = 0; i != written_entities.size(); ++i)
+        {
+          // Cell value is the average over the points of the element, zero where the field is not defined
+          const bool defined = field.dict().defined_for_entities(written_entities[i]);
+          boost_foreach(const Uint e, elements[i])
+          {
+            for(Uint j = 0; j != nb_components; ++j)
+            {
+              double value = 0.;
+              if(defined && j < var_length)
+              {
+                const Connectivity::ConstRow points = field.dict().space(*written_entities[i]).connectivity()[e];
+                boost_foreach(const Uint point, points)
+                  value += field[point][var_begin+j];
+                value /= static_cast<double>(points.size());
+              }
+              values.push_back(value);
+            }
+          }
+        }
+        file.write_at(offset + element_offset*nb_components*sizeof(double), values);
+        nb_rows = nb_elements;
+      }
+
+      XmlNode attribute = grid.add_node("Attribute");
+      attribute.set_attribute("Name", field.var_name(var_idx));
+      attribute.set_attribute("AttributeType", detail::attribute_type(nb_components));
+      attribute.set_attribute("Center", point_data ? "Node" : "Cell");
+      detail::add_data_item(attribute, to_str(nb_rows) + " " + to_str(nb_components), "Float", 8, offset, data_filename);
+      offset += nb_rows*nb_components*sizeof(double);
+    }
+  }
+
+  if(rank == 0)
+    to_file(doc, m_file_path);
+}
+
+} // XDMF
+} // mesh
+} // cf3
@@ -0,0 +1,60 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_XDMF_Writer_hpp
+#define cf3_mesh_XDMF_Writer_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshWriter.hpp"
+
+#include "mesh/XDMF/LibXDMF.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace XDMF {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// This class defines the XDMF mesh format writer.
+/// All processes write into a single raw binary file (path.bin), using collective MPI-IO, and the first
+/// process writes the XML description (path.xmf) that refers to it. Nodes are stored at the position given
+/// by their global index, so ghost nodes are written only once, by their owner. Elements and cell data are
+/// stored per process, one after the other.
+/// Only first order volume elements are written. Fields of the geometry dictionary are written as point data,
+/// discontinuous fields as cell data, averaged over the element.
+class XDMF_API Writer : public MeshWriter
+{
+public: // functions
+
+  /// constructor
+  Writer( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "Writer"; }
+
+  virtual void write();
+
+  virtual std::string get_format() { return "XDMF"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+  /// The binary file is written with collective MPI-IO
+  virtual bool is_collective() { return true; }
+
+}; // end Writer
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // XDMF
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_XDMF_Writer_hpp
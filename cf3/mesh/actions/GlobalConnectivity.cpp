@@ -125,7 +125,7 @@ void GlobalConnectivity::execute()
     {
       ghostnode_glb_idx[cnt] = nodes_glb_idx[i];
 
-      DynTable<Uint>::ConstRow elems = node2elem.connectivity()[i];
+      CSRTable<Uint>::ConstRow elems = node2elem.connectivity()[i];
       boost_foreach(const Uint e, elems)
       {
         boost::tie(elem_comp,elem_idx) = node2elem.elements().location(e);
@@ -175,33 +175,34 @@ void GlobalConnectivity::execute()
   }
 
 
-  DynTable<Uint>& nodes_glb_elem_connectivity = mesh.geometry_fields().glb_elem_connectivity();
+  CSRTable<Uint>& nodes_glb_elem_connectivity = mesh.geometry_fields().glb_elem_connectivity();
 //  CFinfo << "nodes_glb_elem_connectivity = " << nodes_glb_elem_connectivity.uri() << CFendl;
-  nodes_glb_elem_connectivity.resize(glb_elem_connectivity.size());
+  std::vector<Uint> nodes_glb_elem_connectivity_sizes(glb_elem_connectivity.size());
   for (Uint i=0; i<glb_elem_connectivity.size(); ++i)
   {
-//    CFinfo << "i = " << i << CFendl;
     cf3_assert(i<node2elem.connectivity().size());
-    DynTable<Uint>::ConstRow elems = node2elem.connectivity()[i];
-    cf3_assert(i<nodes_glb_elem_connectivity.size());
-    cf3_assert(i<glb_elem_connectivity.size());
-    nodes_glb_elem_connectivity[i].resize(glb_elem_connectivity[i].size() + elems.size());
+    nodes_glb_elem_connectivity_sizes[i] = glb_elem_connectivity[i].size() + node2elem.connectivity().row_size(i);
+  }
+  nodes_glb_elem_connectivity.set_row_sizes(nodes_glb_elem_connectivity_sizes);
+  for (Uint i=0; i<glb_elem_connectivity.size(); ++i)
+  {
+//    CFinfo << "i = " << i << CFendl;
+    CSRTable<Uint>::ConstRow elems = node2elem.connectivity()[i];
+    CSRTable<Uint>::Row glb_elems = nodes_glb_elem_connectivity[i];
     cnt = 0;
     boost_foreach(const Uint e, elems)
     {
       cf3_assert(e<node2elem.elements().size());
       boost::tie(elem_comp,elem_idx) = node2elem.elements().location(e);
       cf3_assert(elem_idx < Handle<Elements>(elem_comp)->glb_idx().size());
-      nodes_glb_elem_connectivity[i][cnt++] = Handle<Elements>(elem_comp)->glb_idx()[elem_idx];
+      glb_elems[cnt++] = Handle<Elements>(elem_comp)->glb_idx()[elem_idx];
     }
     for (Uint j=0; j<glb_elem_connectivity[i].size(); ++j)
     {
-      cf3_assert(cnt < nodes_glb_elem_connectivity[i].size());
-      nodes_glb_elem_connectivity[i][cnt++] = glb_elem_connectivity[i][j];
+      cf3_assert(cnt < glb_elems.size());
+      glb_elems[cnt++] = glb_elem_connectivity[i][j];
     }
-
   }
-
 }
 
 //////////////////////////////////////////////////////////////////////////////
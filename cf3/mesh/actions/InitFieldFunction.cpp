@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/function.hpp>
 #include <boost/bind.hpp>
 
@@ -17,7 +19,6 @@
 #include "common/PropertyList.hpp"
 #include "common/Signal.hpp"
 #include "common/XML/SignalOptions.hpp"
-#include "math/AnalyticalFunction.hpp"
 
 #include "mesh/actions/InitFieldFunction.hpp"
 #include "mesh/Elements.hpp"
@@ -185,37 +186,55 @@ void InitFieldFunction::execute()
     }
   }
 
-  // create the functions
-  std::vector<math::AnalyticalFunction> functions(option_functions.size());
-  for (Uint f=0; f<functions.size(); ++f)
+  // check: columns must be of index smaller than index of field
+  for (Uint f=0; f<option_functions.size(); ++f)
   {
-    // check: columns must be of index smaller than index of field
     if (cols[f] >= m_field->row_size()) throw SetupError(FromHere(), "Specified column ["+to_str(cols[f])+"] doesn't exist. (field has only "+to_str(m_field->row_size())+" cols)");
-    functions[f].parse(option_functions[f],variable_names);
   }
 
+  if (option_functions.empty() || dict.size() == 0)
+    return;
+
+  // create the functions
+  m_function.functions(option_functions);
+  m_function.variables(variable_names);
+  m_function.parse();
+
   std::vector<Real> constants;
   constants.push_back( options().value<Real>("time") );
 
-  std::vector<Real> variables(variable_names.size());
-
-  for (Uint pt=0; pt<dict.size(); ++pt)
+  // Evaluate the functions for blocks of points, with the variables and results stored per component
+  const Uint block_size = std::min(dict.size(), 65536u);
+  std::vector< std::vector<Real> > variables(variable_names.size(), std::vector<Real>(block_size));
+  std::vector< std::vector<Real> > results(option_functions.size(), std::vector<Real>(block_size));
+  std::vector<const Real*> variables_ptr(variables.size());
+  std::vector<Real*> results_ptr(results.size());
+  for (Uint v=0; v<variables.size(); ++v)
+    variables_ptr[v] = &variables[v][0];
+  for (Uint f=0; f<results.size(); ++f)
+    results_ptr[f] = &results[f][0];
+
+  for (Uint block_begin=0; block_begin<dict.size(); block_begin+=block_size)
   {
+    const Uint nb_points = std::min(block_size, dict.size()-block_begin);
+
     // Assemble variables per point
-    Uint c=0;
-    for (Uint j=0; j<field_comps.size(); ++j, ++c)
-    {
-      variables[c] = field_comps[j]->array()[pt][field_cols[j]];
-    }
-    for (Uint j=0; j<constants.size(); ++j, ++c)
+    for (Uint j=0; j<field_comps.size(); ++j)
     {
-      variables[c] = constants[j];
+      const Table<Real>::ArrayT& array = field_comps[j]->array();
+      const Uint col = field_cols[j];
+      for (Uint pt=0; pt<nb_points; ++pt)
+        variables[j][pt] = array[block_begin+pt][col];
     }
+    for (Uint j=0; j<constants.size(); ++j)
+      std::fill(variables[field_comps.size()+j].begin(), variables[field_comps.size()+j].begin()+nb_points, constants[j]);
 
     // Evaluate functions
+    m_function.evaluate_batch(nb_points, &variables_ptr[0], &results_ptr[0]);
     for (Uint f=0; f<cols.size(); ++f)
     {
-      m_field->array()[pt][f] = functions[f](variables);
+      for (Uint pt=0; pt<nb_points; ++pt)
+        m_field->array()[block_begin+pt][f] = results[f][pt];
     }
   }
 }
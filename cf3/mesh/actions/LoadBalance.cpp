@@ -9,6 +9,7 @@
 #include "common/Builder.hpp"
 #include "common/Log.hpp"
 #include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
 #include "common/PropertyList.hpp"
 
 #include "common/PE/Comm.hpp"
@@ -16,6 +17,7 @@
 #include "mesh/actions/LoadBalance.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
+#include "mesh/SFCPartitioner.hpp"
 
 //////////////////////////////////////////////////////////////////////////////
 
@@ -34,16 +36,6 @@ common::ComponentBuilder < LoadBalance, MeshTransformer, mesh::actions::LibActio
 
 LoadBalance::LoadBalance( const std::string& name ) :
   MeshTransformer(name)
-#if (defined CF3_HAVE_PTSCOTCH)
-  ,m_partitioner(create_component("partitioner", "cf3.mesh.ptscotch.Partitioner"))
-#elif (defined CF3_HAVE_ZOLTAN)
-  ,m_partitioner(create_component("partitioner", "cf3.mesh.zoltan.Partitioner"))
-#endif
-
-#if ( !defined CF3_HAVE_PTSCOTCH ) && ( !defined CF3_HAVE_ZOLTAN )
-#warning "There is no partitioner available (Zoltan or PT-Scotch). Load-balancing will not be possible."
-#define CF3_MESH_LOADBALANCE_PARTITIONER_UNAVAILABLE
-#endif
 {
 
   properties()["brief"] = std::string("Construct global node and element numbering based on coordinates hash values");
@@ -53,10 +45,36 @@ LoadBalance::LoadBalance( const std::string& name ) :
   properties()["description"] = desc;
 
 #if (defined CF3_HAVE_PTSCOTCH)
-  // no configuration necessary
+  const std::string partitioner = "cf3.mesh.ptscotch.Partitioner";
 #elif (defined CF3_HAVE_ZOLTAN)
-  m_partitioner->options().set("graph_package", std::string("PHG"));
+  const std::string partitioner = "cf3.mesh.zoltan.Partitioner";
+#else
+  const std::string partitioner = "cf3.mesh.SFCPartitioner";
 #endif
+
+  options().add("partitioner", partitioner)
+      .description("Builder name of the partitioner. cf3.mesh.SFCPartitioner partitions along the Hilbert space filling curve, "
+                   "which is fast and needs no external library, while the graph partitioners minimize the communication")
+      .pretty_name("Partitioner")
+      .attach_trigger(boost::bind(&LoadBalance::trigger_partitioner, this));
+
+  trigger_partitioner();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void LoadBalance::trigger_partitioner()
+{
+  if (is_not_null(m_partitioner))
+    remove_component(*m_partitioner);
+
+  const std::string partitioner = options().value<std::string>("partitioner");
+  m_partitioner = Handle<MeshTransformer>(create_component("partitioner", partitioner));
+  if (is_null(m_partitioner))
+    throw SetupError(FromHere(), "Builder " + partitioner + " does not create a MeshTransformer");
+
+  if (partitioner == "cf3.mesh.zoltan.Partitioner")
+    m_partitioner->options().set("graph_package", std::string("PHG"));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -81,20 +99,20 @@ void LoadBalance::execute()
     CFinfo << "  + building joint node & element global numbering ... done" << CFendl;
     Comm::instance().barrier();
 
-    CFinfo << "  + building global node-element connectivity ... " << CFendl;
+    // the space filling curve only needs the coordinates, the graph partitioners need the connectivity
+    if (is_null(Handle<SFCPartitioner>(m_partitioner)))
+    {
+      CFinfo << "  + building global node-element connectivity ... " << CFendl;
 
-    build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalConnectivity","glb_connectivity")->transform(mesh);
+      build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GlobalConnectivity","glb_connectivity")->transform(mesh);
 
-    CFinfo << "  + building global node-element connectivity ... done" << CFendl;
-    Comm::instance().barrier();
+      CFinfo << "  + building global node-element connectivity ... done" << CFendl;
+      Comm::instance().barrier();
+    }
 
-#ifdef CF3_MESH_LOADBALANCE_PARTITIONER_UNAVAILABLE
-    CFwarn << "  Skipping mesh partitioning. (No partitioner available)" << CFendl;
-#else
     CFinfo << "  + partitioning and migrating ..." << CFendl;
     m_partitioner->transform(mesh);
     CFinfo << "  + partitioning and migrating ... done" << CFendl;
-#endif
     Comm::instance().barrier();
     CFinfo << "  + growing overlap layer ..." << CFendl;
     build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.GrowOverlap","grow_overlap")->transform(mesh);
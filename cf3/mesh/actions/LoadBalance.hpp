@@ -23,6 +23,9 @@ namespace actions {
 
 /// @brief Load Balance the mesh
 ///
+/// The partitioner is chosen with the "partitioner" option. It defaults to PT-Scotch or Zoltan when
+/// available, and to the built-in cf3.mesh.SFCPartitioner otherwise.
+///
 /// @post After this, the mesh is ready to be parallellized
 /// @author Willem Deconinck
 class mesh_actions_API LoadBalance : public MeshTransformer
@@ -39,6 +42,9 @@ public: // functions
 
 private:
 
+  /// Create the partitioner set in the "partitioner" option
+  void trigger_partitioner();
+
   Handle<MeshTransformer> m_partitioner;
 
 }; // end LoadBalance
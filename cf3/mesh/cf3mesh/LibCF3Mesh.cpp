@@ -0,0 +1,19 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/RegistLibrary.hpp"
+
+#include "mesh/cf3mesh/LibCF3Mesh.hpp"
+
+namespace cf3 {
+namespace mesh {
+namespace cf3mesh {
+
+cf3::common::RegistLibrary<LibCF3Mesh> libcf3mesh;
+
+} // cf3mesh
+} // mesh
+} // cf3
@@ -0,0 +1,244 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <iomanip>
+#include <sstream>
+
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/Builder.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/Group.hpp"
+#include "common/Log.hpp"
+#include "common/OptionArray.hpp"
+#include "common/OptionComponent.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionT.hpp"
+#include "common/OptionURI.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/cf3mesh/MeshCache.hpp"
+#include "mesh/cf3mesh/Reader.hpp"
+#include "mesh/cf3mesh/Shared.hpp"
+#include "mesh/cf3mesh/Writer.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/LoadMesh.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshTransformer.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace cf3mesh {
+
+using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < cf3mesh::MeshCache, common::Action, LibCF3Mesh> cf3meshMeshCache_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /// 64 bit FNV-1a hash, which is fast and good enough to tell meshes and configurations apart
+  class Hash
+  {
+  public:
+    Hash() : m_value(14695981039346656037ULL) {}
+
+    void add(const void* data, const std::size_t nb_bytes)
+    {
+      const unsigned char* bytes = static_cast<const unsigned char*>(data);
+      for(std::size_t i = 0; i != nb_bytes; ++i)
+      {
+        m_value ^= bytes[i];
+        m_value *= 1099511628211ULL;
+      }
+    }
+
+    /// Add a string, followed by a separator so consecutive strings can't run into each other
+    void add(const std::string& value)
+    {
+      add(value.data(), value.size());
+      add("", 1);
+    }
+
+    void add(const Uint value)
+    {
+      add(to_str(value));
+    }
+
+    std::string hex() const
+    {
+      std::stringstream stream;
+      stream << std::hex << std::setw(16) << std::setfill('0') << m_value;
+      return stream.str();
+    }
+
+  private:
+    boost::uint64_t m_value;
+  };
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+MeshCache::MeshCache( const std::string& name )
+: Action(name),
+  m_loaded_from_cache(false)
+{
+  properties()["brief"] = std::string("Loads a prepared mesh from a cache, or prepares and caches it");
+  properties()["description"] = std::string("Loads the files, applies the transformers and writes the result in the cf3mesh format, "
+                                            "keyed by the file contents and the transformer configuration. Later runs with the same key "
+                                            "read the cached mesh instead.");
+
+  options().add("mesh", m_mesh)
+      .description("Empty mesh to load into")
+      .pretty_name("Mesh")
+      .mark_basic()
+      .link_to(&m_mesh);
+
+  options().add("files", std::vector<URI>())
+      .description("Files to load the mesh from")
+      .pretty_name("Files")
+      .mark_basic();
+
+  options().add("cache_dir", URI(".", URI::Scheme::FILE))
+      .supported_protocol(URI::Scheme::FILE)
+      .description("Directory holding the cached meshes")
+      .pretty_name("Cache Directory")
+      .mark_basic();
+
+  options().add("dimension", 0u)
+      .description("The coordinate dimension (0 --> maximum dimensionality)")
+      .pretty_name("Dimension");
+
+  m_transformers = create_static_component<Group>("transformers");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+MeshTransformer& MeshCache::add_transformer(const std::string& name, const std::string& builder)
+{
+  return *m_transformers->create_component(name, builder)->handle<MeshTransformer>();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::string MeshCache::key() const
+{
+  Hash hash;
+  hash.add(Shared::version);
+  hash.add(static_cast<Uint>(sizeof(Uint)));
+  hash.add(static_cast<Uint>(sizeof(Real)));
+  hash.add(PE::Comm::instance().size());
+  hash.add(options().value<Uint>("dimension"));
+
+  // The contents of the files, not their names, so a moved or copied mesh still finds its cache
+  const std::vector<URI> files = options().value< std::vector<URI> >("files");
+  boost_foreach(const URI& file, files)
+  {
+    const boost::filesystem::path path(file.path());
+    if(!boost::filesystem::exists(path))
+      throw FileSystemError(FromHere(), "File " + path.string() + " does not exist");
+    hash.add(file.extension());
+    const Uint size = boost::filesystem::file_size(path);
+    hash.add(size);
+    if(size != 0)
+    {
+      boost::iostreams::mapped_file_source mapping(path.string());
+      hash.add(mapping.data(), mapping.size());
+    }
+  }
+
+  boost_foreach(const MeshTransformer& transformer, find_components<MeshTransformer>(*m_transformers))
+  {
+    hash.add(transformer.derived_type_name());
+    for(OptionList::const_iterator it = transformer.options().begin(); it != transformer.options().end(); ++it)
+    {
+      // The mesh being transformed is not part of the configuration
+      if(it->first == "mesh")
+        continue;
+      hash.add(it->first);
+      hash.add(it->second->value_str());
+    }
+  }
+
+  return hash.hex();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+URI MeshCache::cache_path() const
+{
+  const boost::filesystem::path dir(options().value<URI>("cache_dir").path());
+  return URI((dir / ("mesh_" + key() + ".cf3mesh")).string(), URI::Scheme::FILE);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void MeshCache::execute()
+{
+  if(is_null(m_mesh))
+    throw SetupError(FromHere(), "Option mesh is not set in " + uri().string());
+
+  const URI path = cache_path();
+  const Uint rank = PE::Comm::instance().rank();
+
+  // The cache is only used if every process has its part
+  const int found = boost::filesystem::exists(Shared::rank_path(path, rank)) ? 1 : 0;
+  int found_everywhere = found;
+  if(PE::Comm::instance().is_active())
+    PE::Comm::instance().all_reduce(PE::min(), &found, 1, &found_everywhere);
+
+  m_loaded_from_cache = found_everywhere != 0;
+  if(m_loaded_from_cache)
+  {
+    CFinfo << "Reading cached mesh " << path.path() << CFendl;
+    boost::shared_ptr<Reader> reader = allocate_component<Reader>("reader");
+    reader->options().set("dimension", options().value<Uint>("dimension"));
+    reader->read_mesh_into(path, *m_mesh);
+    return;
+  }
+
+  boost::shared_ptr<LoadMesh> load_mesh = allocate_component<LoadMesh>("load_mesh");
+  load_mesh->options().set("dimension", options().value<Uint>("dimension"));
+  load_mesh->load_multiple_files(options().value< std::vector<URI> >("files"), *m_mesh);
+
+  boost_foreach(MeshTransformer& transformer, find_components<MeshTransformer>(*m_transformers))
+    transformer.transform(*m_mesh);
+
+  // All fields are kept, in case a transformer created some
+  std::vector<URI> fields;
+  boost_foreach(const Handle<Dictionary>& dict, m_mesh->dictionaries())
+  {
+    boost_foreach(const Field& field, find_components<Field>(*dict))
+      fields.push_back(field.uri());
+  }
+
+  const boost::filesystem::path dir(options().value<URI>("cache_dir").path());
+  if(rank == 0 && !boost::filesystem::exists(dir))
+    boost::filesystem::create_directories(dir);
+  if(PE::Comm::instance().is_active())
+    PE::Comm::instance().barrier();
+
+  CFinfo << "Caching mesh in " << path.path() << CFendl;
+  boost::shared_ptr<Writer> writer = allocate_component<Writer>("writer");
+  writer->options().set("fields", fields);
+  writer->write_from_to(*m_mesh, path);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // cf3mesh
+} // mesh
+} // cf3
@@ -0,0 +1,80 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_cf3mesh_MeshCache_hpp
+#define cf3_mesh_cf3mesh_MeshCache_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "common/Action.hpp"
+#include "common/URI.hpp"
+
+#include "mesh/cf3mesh/LibCF3Mesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace common { class Group; }
+namespace mesh {
+  class Mesh;
+  class MeshTransformer;
+namespace cf3mesh {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Loads a mesh and prepares it with a chain of transformers, caching the prepared mesh in the cf3mesh format.
+///
+/// The cache file is keyed by the contents of the input files, the type and options of each transformer,
+/// the number of processes and the cf3mesh format version. When all processes find their part of a cached
+/// mesh with the same key in "cache_dir", it is read instead of loading and transforming the input files,
+/// so faces, global numbering and partitioning are not recomputed. Otherwise the mesh is loaded, transformed
+/// and written to the cache for the next run.
+///
+/// The transformers are added with add_transformer() and executed in the order they were added.
+class cf3mesh_API MeshCache : public common::Action
+{
+public: // functions
+
+  /// constructor
+  MeshCache( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "MeshCache"; }
+
+  /// Load the mesh from the cache, or from the input files followed by the transformers
+  virtual void execute();
+
+  /// Append a transformer to the chain
+  /// @param name name of the transformer component
+  /// @param builder builder name of the transformer, e.g. cf3.mesh.actions.BuildFaces
+  MeshTransformer& add_transformer(const std::string& name, const std::string& builder);
+
+  /// Hexadecimal key of the current configuration, which names the cache file
+  std::string key() const;
+
+  /// Path of the cache file for the current configuration
+  common::URI cache_path() const;
+
+  /// True if the last execute() read the mesh from the cache
+  bool loaded_from_cache() const { return m_loaded_from_cache; }
+
+private: // data
+
+  Handle<Mesh> m_mesh;
+  Handle<common::Group> m_transformers;
+  bool m_loaded_from_cache;
+
+}; // end MeshCache
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // cf3mesh
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_cf3mesh_MeshCache_hpp
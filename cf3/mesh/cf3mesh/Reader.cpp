@@ -0,0 +1,436 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/classification.hpp>
+
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/List.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/cf3mesh/Reader.hpp"
+#include "mesh/cf3mesh/Shared.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/ContinuousDictionary.hpp"
+#include "mesh/DiscontinuousDictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/FaceCellConnectivity.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace cf3mesh {
+
+using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < cf3mesh::Reader, MeshReader, LibCF3Mesh> cf3meshReader_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /// Copy size entries of the mapped file into the given array
+  template<typename T, typename ArrayT>
+  void read_into(BinaryReader& in, const Uint size, ArrayT& array)
+  {
+    cf3_assert(array.num_elements() == size);
+    const T* data = in.read_array<T>(size);
+    std::copy(data, data+size, array.data());
+  }
+
+  /// Dictionary of the mesh with the given name
+  Dictionary& find_dictionary(Mesh& mesh, const std::string& name)
+  {
+    if(name == mesh.geometry_fields().name())
+      return mesh.geometry_fields();
+    Handle<Dictionary> dict(mesh.get_child(name));
+    if(is_null(dict))
+      throw FileFormatError(FromHere(), "Dictionary " + name + " is used before it is defined");
+    return *dict;
+  }
+
+  /// Parent of the component at the given path relative to the mesh, creating the regions leading up to it
+  Component& create_parent(Mesh& mesh, const std::string& path, std::string& name)
+  {
+    std::vector<std::string> names;
+    boost::algorithm::split(names, path, boost::algorithm::is_any_of("/"));
+    Handle<Component> parent = mesh.handle();
+    for(Uint n = 0; n+1 < names.size(); ++n)
+    {
+      Handle<Component> child = parent->get_child(names[n]);
+      parent = is_null(child) ? Handle<Component>(parent->create_component<Region>(names[n])) : child;
+    }
+    name = names.back();
+    return *parent;
+  }
+
+  /// Component at the given path relative to the mesh
+  Component& find_path(Mesh& mesh, const std::string& path)
+  {
+    std::vector<std::string> names;
+    boost::algorithm::split(names, path, boost::algorithm::is_any_of("/"));
+    Handle<Component> component = mesh.handle();
+    boost_foreach(const std::string& name, names)
+    {
+      component = component->get_child(name);
+      if(is_null(component))
+        throw FileFormatError(FromHere(), "Component " + path + " is used before it is defined");
+    }
+    return *component;
+  }
+
+  void read_tags(BinaryReader& in, Component& component)
+  {
+    const Uint nb_tags = in.read_uint();
+    for(Uint t = 0; t != nb_tags; ++t)
+    {
+      const std::string tag = in.read_string();
+      if(!component.has_tag(tag))
+        component.add_tag(tag);
+    }
+  }
+
+  /// Read a table of element references, stored as pairs of entities index and element index
+  /// @param entities the entities, in the order of the file
+  void read_element_connectivity(BinaryReader& in, const std::vector< Handle<Entities> >& entities, common::Table<Entity>& table)
+  {
+    const Uint rows = in.read_uint();
+    const Uint cols = in.read_uint();
+    table.set_row_size(cols);
+    table.resize(rows);
+    const Uint* pairs = in.read_array<Uint>(2*rows*cols);
+    Entity* entries = table.array().data();
+    for(Uint i = 0; i != rows*cols; ++i)
+    {
+      const Uint entities_idx = pairs[2*i];
+      if(entities_idx == Shared::invalid_entities())
+      {
+        entries[i] = Entity();
+        continue;
+      }
+      if(entities_idx >= entities.size())
+        throw FileFormatError(FromHere(), "Element reference to entities " + to_str(entities_idx) + ", while the file has "
+                              + to_str(entities.size()));
+      entries[i] = Entity(*entities[entities_idx], pairs[2*i+1]);
+    }
+  }
+
+  template<typename T>
+  void read_table(BinaryReader& in, common::Table<T>& table)
+  {
+    const Uint rows = in.read_uint();
+    const Uint cols = in.read_uint();
+    table.set_row_size(cols);
+    table.resize(rows);
+    read_into<T>(in, rows*cols, table.array());
+  }
+
+  /// Tables of bool are stored as Uint
+  template<typename ArrayT>
+  void read_bool_array(BinaryReader& in, ArrayT& array)
+  {
+    const Uint size = array.num_elements();
+    const Uint* data = in.read_array<Uint>(size);
+    for(Uint i = 0; i != size; ++i)
+      array.data()[i] = data[i] != 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Reader::Reader( const std::string& name )
+: MeshReader(name)
+{
+  properties()["brief"] = std::string("Native binary mesh format reader");
+  properties()["description"] = std::string("Reads a mesh with its dictionaries and fields as written by cf3.mesh.cf3mesh.Writer, using the same number of processes");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> Reader::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".cf3mesh");
+  return extensions;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::do_read_mesh_into(const URI& path, Mesh& mesh)
+{
+  const Uint rank = PE::Comm::instance().rank();
+  const boost::filesystem::path fp = Shared::rank_path(path, rank);
+  CFinfo << "Opening file " << fp.string() << CFendl;
+  BinaryReader in(fp);
+
+  if(in.read_string() != Shared::magic())
+    throw FileFormatError(FromHere(), fp.string() + " is not a cf3mesh file");
+  const Uint version = in.read_uint();
+  if(version != Shared::version)
+    throw FileFormatError(FromHere(), fp.string() + " has format version " + to_str(version) + ", while version " + to_str(Shared::version) + " is supported");
+  const Uint uint_size = in.read_uint();
+  const Uint real_size = in.read_uint();
+  if(uint_size != sizeof(Uint) || real_size != sizeof(Real))
+    throw FileFormatError(FromHere(), fp.string() + " was written with " + to_str(uint_size*8) + " bit integers and " + to_str(real_size*8)
+                          + " bit reals, which does not match this build");
+  const Uint nb_ranks = in.read_uint();
+  if(nb_ranks != PE::Comm::instance().size())
+    throw SetupError(FromHere(), fp.string() + " was written by " + to_str(nb_ranks) + " processes and must be read with as many processes, not "
+                     + to_str(PE::Comm::instance().size()));
+  if(in.read_uint() != rank)
+    throw FileFormatError(FromHere(), fp.string() + " was not written by rank " + to_str(rank));
+  const Uint dimension = in.read_uint();
+
+  if(!mesh.elements().empty())
+    throw SetupError(FromHere(), "Mesh " + mesh.uri().string() + " must be empty to read " + fp.string() + " into it");
+
+  read_metadata(in, mesh);
+  read_dictionaries(in, mesh, dimension);
+  read_regions(in, mesh);
+  read_entities(in, mesh);
+  mesh.update_structures();
+  read_face_cells(in, mesh);
+  read_cell_faces(in, mesh);
+  read_fields(in, mesh);
+
+  m_entities.clear();
+
+  if(in.position() != in.size())
+    throw FileFormatError(FromHere(), fp.string() + " has unexpected data at the end");
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_metadata(BinaryReader& in, Mesh& mesh)
+{
+  PropertyList& metadata = mesh.metadata().properties();
+  const Uint nb_entries = in.read_uint();
+  for(Uint i = 0; i != nb_entries; ++i)
+  {
+    const std::string name = in.read_string();
+    const Uint type = in.read_uint();
+    switch(type)
+    {
+      case Shared::REAL:
+        metadata[name] = in.read_real();
+        break;
+      case Shared::UNSIGNED:
+        metadata[name] = static_cast<Uint>(in.read_uint());
+        break;
+      case Shared::INTEGER:
+        metadata[name] = static_cast<int>(static_cast<boost::int64_t>(in.read_uint()));
+        break;
+      case Shared::BOOL:
+        metadata[name] = in.read_uint() != 0;
+        break;
+      case Shared::STRING:
+        metadata[name] = in.read_string();
+        break;
+      default:
+        throw FileFormatError(FromHere(), "Unknown type " + to_str(type) + " for metadata entry " + name);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_dictionaries(BinaryReader& in, Mesh& mesh, const Uint dimension)
+{
+  const Uint nb_dicts = in.read_uint();
+  for(Uint i = 0; i != nb_dicts; ++i)
+  {
+    const std::string name = in.read_string();
+    const bool continuous = in.read_uint() != 0;
+    const Uint size = in.read_uint();
+
+    Handle<Dictionary> dict;
+    if(name == mesh.geometry_fields().name())
+    {
+      mesh.initialize_nodes(size, dimension);
+      dict = mesh.geometry_fields().handle<Dictionary>();
+    }
+    else
+    {
+      if(is_not_null(mesh.get_child(name)))
+        throw SetupError(FromHere(), "Mesh " + mesh.uri().string() + " already has a component named " + name);
+      if(continuous)
+        dict = mesh.create_component<ContinuousDictionary>(name);
+      else
+        dict = mesh.create_component<DiscontinuousDictionary>(name);
+      dict->resize(size);
+    }
+
+    read_into<Uint>(in, size, dict->glb_idx().array());
+    read_into<Uint>(in, size, dict->rank().array());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_regions(BinaryReader& in, Mesh& mesh)
+{
+  const Uint nb_regions = in.read_uint();
+  for(Uint i = 0; i != nb_regions; ++i)
+  {
+    std::string name;
+    Component& parent = create_parent(mesh, in.read_string(), name);
+    Handle<Component> region = parent.get_child(name);
+    if(is_null(region))
+      region = parent.create_component<Region>(name);
+    read_tags(in, *region);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_entities(BinaryReader& in, Mesh& mesh)
+{
+  const Uint nb_entities = in.read_uint();
+  m_entities.clear();
+  m_entities.reserve(nb_entities);
+  for(Uint i = 0; i != nb_entities; ++i)
+  {
+    const std::string path = in.read_string();
+    const std::string entities_type = in.read_string();
+    const std::string element_type = in.read_string();
+
+    std::string name;
+    Component& parent = create_parent(mesh, path, name);
+    Handle<Entities> entities(parent.create_component(name, entities_type));
+    if(is_null(entities))
+      throw FileFormatError(FromHere(), "Builder " + entities_type + " does not create entities");
+    entities->initialize(element_type, mesh.geometry_fields());
+    read_tags(in, *entities);
+    m_entities.push_back(entities);
+
+    const Uint size = in.read_uint();
+    entities->resize(size);
+    read_into<Uint>(in, size, entities->glb_idx().array());
+    read_into<Uint>(in, size, entities->rank().array());
+
+    const Uint nb_spaces = in.read_uint();
+    for(Uint s = 0; s != nb_spaces; ++s)
+    {
+      const std::string dict_name = in.read_string();
+      const std::string shape_function = in.read_string();
+      const Uint rows = in.read_uint();
+      const Uint cols = in.read_uint();
+
+      Dictionary& dict = find_dictionary(mesh, dict_name);
+      Space& space = &dict == &mesh.geometry_fields() ? entities->geometry_space() : entities->create_space(shape_function, dict);
+      Connectivity& connectivity = space.connectivity();
+      connectivity.set_row_size(cols);
+      connectivity.resize(rows);
+      read_into<Uint>(in, rows*cols, connectivity.array());
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_face_cells(BinaryReader& in, Mesh& mesh)
+{
+  const Uint nb_face_cells = in.read_uint();
+  for(Uint i = 0; i != nb_face_cells; ++i)
+  {
+    std::string name;
+    Component& parent = create_parent(mesh, in.read_string(), name);
+    Handle<FaceCellConnectivity> face_cell = parent.create_component<FaceCellConnectivity>(name);
+    read_tags(in, *face_cell);
+
+    const Uint nb_used = in.read_uint();
+    for(Uint u = 0; u != nb_used; ++u)
+      face_cell->add_used(find_path(mesh, in.read_string()));
+
+    read_element_connectivity(in, m_entities, face_cell->connectivity());
+    read_table(in, face_cell->face_number());
+    const Uint nb_faces = in.read_uint();
+    if(in.read_uint() != 1)
+      throw FileFormatError(FromHere(), "Boundary face flags of " + face_cell->uri().string() + " must have one column");
+    face_cell->is_bdry_face().resize(nb_faces);
+    read_bool_array(in, face_cell->is_bdry_face().array());
+    read_table(in, face_cell->cell_rotation());
+    const Uint rows = in.read_uint();
+    face_cell->cell_orientation().set_row_size(in.read_uint());
+    face_cell->cell_orientation().resize(rows);
+    read_bool_array(in, face_cell->cell_orientation().array());
+
+    // Faces built by BuildFaces keep a handle to their connectivity
+    Handle<Entities> faces(parent.handle());
+    if(is_not_null(faces))
+      faces->connectivity_face2cell() = face_cell;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_cell_faces(BinaryReader& in, Mesh& mesh)
+{
+  const Uint nb_cell_faces = in.read_uint();
+  for(Uint i = 0; i != nb_cell_faces; ++i)
+  {
+    std::string name;
+    Component& parent = create_parent(mesh, in.read_string(), name);
+    Handle<Entities> elements(parent.handle());
+    if(is_null(elements))
+      throw FileFormatError(FromHere(), "Cell to face connectivity " + name + " must belong to entities, not to " + parent.uri().string());
+    Handle<ElementConnectivity> cell_face = elements->create_component<ElementConnectivity>(name);
+    read_element_connectivity(in, m_entities, *cell_face);
+    elements->connectivity_cell2face() = cell_face;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_fields(BinaryReader& in, Mesh& mesh)
+{
+  const Uint nb_fields = in.read_uint();
+  for(Uint i = 0; i != nb_fields; ++i)
+  {
+    const std::string dict_name = in.read_string();
+    const std::string name = in.read_string();
+    const std::string description = in.read_string();
+    std::vector<std::string> tags(in.read_uint());
+    boost_foreach(std::string& tag, tags)
+      tag = in.read_string();
+    const Uint rows = in.read_uint();
+    const Uint cols = in.read_uint();
+
+    Dictionary& dict = find_dictionary(mesh, dict_name);
+    Handle<Field> field(dict.get_child(name));
+    if(is_null(field))
+      field = dict.create_field(name, description).handle<Field>();
+    if(field->size() != rows || field->row_size() != cols)
+      throw FileFormatError(FromHere(), "Field " + field->uri().string() + " has " + to_str(field->size()) + "x" + to_str(field->row_size())
+                            + " entries, while the file has " + to_str(rows) + "x" + to_str(cols));
+    boost_foreach(const std::string& tag, tags)
+    {
+      if(!field->has_tag(tag))
+        field->add_tag(tag);
+    }
+    read_into<Real>(in, rows*cols, field->array());
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // cf3mesh
+} // mesh
+} // cf3
@@ -0,0 +1,78 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_cf3mesh_Reader_hpp
+#define cf3_mesh_cf3mesh_Reader_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshReader.hpp"
+
+#include "mesh/cf3mesh/LibCF3Mesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+  class Entities;
+namespace cf3mesh {
+
+  class BinaryReader;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// This class defines the native binary mesh format reader.
+/// Each rank reads the file written by the same rank, path_P<rank>.cf3mesh, so the mesh must be read
+/// with the same number of processes it was written with. The file is mapped in memory, and the tables
+/// are copied straight from the mapping into the mesh without any parsing.
+class cf3mesh_API Reader : public MeshReader
+{
+public: // functions
+
+  /// constructor
+  Reader( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "Reader"; }
+
+  virtual std::string get_format() { return "cf3mesh"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+private: // functions
+
+  virtual void do_read_mesh_into(const common::URI& path, Mesh& mesh);
+
+  void read_metadata(BinaryReader& in, Mesh& mesh);
+
+  void read_dictionaries(BinaryReader& in, Mesh& mesh, const Uint dimension);
+
+  void read_regions(BinaryReader& in, Mesh& mesh);
+
+  void read_entities(BinaryReader& in, Mesh& mesh);
+
+  void read_face_cells(BinaryReader& in, Mesh& mesh);
+
+  void read_cell_faces(BinaryReader& in, Mesh& mesh);
+
+  void read_fields(BinaryReader& in, Mesh& mesh);
+
+private: // data
+
+  /// Entities in the order of the file, which element references refer to
+  std::vector< Handle<Entities> > m_entities;
+
+}; // end Reader
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // cf3mesh
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_cf3mesh_Reader_hpp
@@ -0,0 +1,134 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <ostream>
+
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
+
+#include "mesh/cf3mesh/Shared.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace cf3mesh {
+
+using namespace common;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /// Items are padded to a multiple of this number of bytes
+  const std::size_t alignment = 8;
+
+  std::size_t padded_size(const std::size_t nb_bytes)
+  {
+    return ((nb_bytes + alignment - 1) / alignment) * alignment;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+const Uint Shared::version;
+
+const std::string& Shared::magic()
+{
+  static const std::string magic_string("CF3MESH");
+  return magic_string;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+boost::filesystem::path Shared::rank_path(const URI& path, const Uint rank)
+{
+  const boost::filesystem::path fullpath(path.path());
+  return fullpath.parent_path() / (boost::filesystem::basename(fullpath) + "_P" + to_str(rank) + boost::filesystem::extension(fullpath));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BinaryWriter::BinaryWriter(std::ostream& stream) :
+  m_stream(stream)
+{
+}
+
+void BinaryWriter::write_uint(const boost::uint64_t value)
+{
+  write_bytes(&value, sizeof(value));
+}
+
+void BinaryWriter::write_real(const Real value)
+{
+  write_bytes(&value, sizeof(value));
+}
+
+void BinaryWriter::write_string(const std::string& value)
+{
+  write_uint(value.size());
+  write_bytes(value.data(), value.size());
+}
+
+void BinaryWriter::write_bytes(const void* data, const std::size_t nb_bytes)
+{
+  static const char padding[alignment] = {0,0,0,0,0,0,0,0};
+  m_stream.write(static_cast<const char*>(data), nb_bytes);
+  m_stream.write(padding, padded_size(nb_bytes) - nb_bytes);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BinaryReader::BinaryReader(const boost::filesystem::path& path) :
+  m_position(0),
+  m_path(path.string())
+{
+  if( !boost::filesystem::exists(path) )
+    throw FileSystemError(FromHere(), m_path + " does not exist");
+
+  try
+  {
+    m_file.open(m_path);
+  }
+  catch(std::exception& e)
+  {
+    throw FileSystemError(FromHere(), "Failed to map " + m_path + " in memory: " + e.what());
+  }
+}
+
+boost::uint64_t BinaryReader::read_uint()
+{
+  return *static_cast<const boost::uint64_t*>(read_bytes(sizeof(boost::uint64_t)));
+}
+
+Real BinaryReader::read_real()
+{
+  return *static_cast<const Real*>(read_bytes(sizeof(Real)));
+}
+
+std::string BinaryReader::read_string()
+{
+  const Uint length = read_uint();
+  const char* data = static_cast<const char*>(read_bytes(length));
+  return std::string(data, length);
+}
+
+const void* BinaryReader::read_bytes(const std::size_t nb_bytes)
+{
+  const std::size_t item_size = padded_size(nb_bytes);
+  if(m_position + item_size > m_file.size())
+    throw FileFormatError(FromHere(), m_path + " ends unexpectedly at byte " + to_str(m_position) + ", the file is truncated or corrupt");
+
+  const void* result = m_file.data() + m_position;
+  m_position += item_size;
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // cf3mesh
+} // mesh
+} // cf3
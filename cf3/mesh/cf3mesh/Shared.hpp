@@ -0,0 +1,153 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_cf3mesh_Shared_hpp
+#define cf3_mesh_cf3mesh_Shared_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <iosfwd>
+#include <limits>
+
+#include <boost/cstdint.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/URI.hpp"
+
+#include "mesh/cf3mesh/LibCF3Mesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace cf3mesh {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Definitions shared by the cf3mesh Reader and Writer.
+///
+/// Each rank writes its own part of the mesh to its own file, with this layout:
+/// @verbatim
+/// header        magic string, format version, sizeof(Uint), sizeof(Real), number of ranks, rank, dimension
+/// metadata      number of entries, then for each: name, type, value
+/// dictionaries  number of dictionaries, then for each: name, continuous flag, size, glb_idx, rank
+/// regions       number of regions, then for each: path relative to the mesh, tags
+/// entities      number of entities, then for each: path relative to the mesh, entities type, element type,
+///               tags, size, glb_idx, rank and the number of spaces, then for each space:
+///               dictionary name, shape function, rows, columns and connectivity table
+/// face cells    number of face to cell connectivities, then for each: path relative to the mesh, tags,
+///               paths of the used entities, then the cell, face number, boundary flag, rotation
+///               and orientation tables, each as rows, columns and data
+/// cell faces    number of cell to face connectivities, then for each: path relative to the mesh,
+///               rows, columns and data
+/// fields        number of fields, then for each: dictionary name, field name, variables description,
+///               tags, rows, columns and data table
+/// @endverbatim
+/// Sizes and flags are stored as 64 bit integers, tables in the native Uint and Real representation.
+/// Tables of bool are stored as Uint, and an element reference (Entity) as the pair of the index of its
+/// entities in Mesh::elements() and its index within them, with invalid_entities() for a null reference.
+/// Each item is padded to a multiple of 8 bytes, so the tables are aligned in a memory mapped file.
+class cf3mesh_API Shared
+{
+public:
+
+  /// Type of the metadata entries
+  enum MetadataType { REAL=0, UNSIGNED=1, INTEGER=2, BOOL=3, STRING=4 };
+
+  /// Identifies a cf3mesh file
+  static const std::string& magic();
+
+  /// Version of the layout, to be incremented on any change
+  static const Uint version = 2;
+
+  /// Entities index of a null element reference
+  static Uint invalid_entities() { return std::numeric_limits<Uint>::max(); }
+
+  /// Path of the file holding the part of the given rank
+  static boost::filesystem::path rank_path(const common::URI& path, const Uint rank);
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Writes the items of a cf3mesh file to a stream
+class cf3mesh_API BinaryWriter
+{
+public:
+
+  BinaryWriter(std::ostream& stream);
+
+  void write_uint(const boost::uint64_t value);
+
+  void write_real(const Real value);
+
+  void write_string(const std::string& value);
+
+  /// Write size entries starting at data
+  template<typename T>
+  void write_array(const T* data, const Uint size)
+  {
+    write_bytes(data, sizeof(T)*size);
+  }
+
+private:
+
+  /// Write the bytes, followed by padding up to a multiple of 8 bytes
+  void write_bytes(const void* data, const std::size_t nb_bytes);
+
+  std::ostream& m_stream;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Reads the items of a cf3mesh file, which is mapped in memory instead of read through a stream
+class cf3mesh_API BinaryReader
+{
+public:
+
+  /// Maps the file
+  /// @throws FileSystemError if the file can't be opened
+  BinaryReader(const boost::filesystem::path& path);
+
+  boost::uint64_t read_uint();
+
+  Real read_real();
+
+  std::string read_string();
+
+  /// Access to size entries in the mapped memory, valid as long as this reader exists
+  template<typename T>
+  const T* read_array(const Uint size)
+  {
+    return static_cast<const T*>(read_bytes(sizeof(T)*size));
+  }
+
+  /// Number of bytes in the file
+  std::size_t size() const { return m_file.size(); }
+
+  /// Number of bytes read so far
+  std::size_t position() const { return m_position; }
+
+private:
+
+  /// Access to the next nb_bytes bytes, skipping the padding
+  /// @throws FileFormatError if the file is too short
+  const void* read_bytes(const std::size_t nb_bytes);
+
+  boost::iostreams::mapped_file_source m_file;
+  std::size_t m_position;
+  std::string m_path;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // cf3mesh
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_cf3mesh_Shared_hpp
@@ -0,0 +1,357 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <fstream>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/Builder.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/List.hpp"
+#include "common/PropertyList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+
+#include "mesh/cf3mesh/Writer.hpp"
+#include "mesh/cf3mesh/Shared.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/ShapeFunction.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/FaceCellConnectivity.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace cf3mesh {
+
+using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < cf3mesh::Writer, MeshWriter, LibCF3Mesh> cf3meshWriter_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+  /// Path of the component relative to the mesh
+  std::string relative_path(const Component& component, const Mesh& mesh)
+  {
+    std::string path = component.name();
+    for(const Component* parent = component.parent().get(); parent != &mesh; parent = parent->parent().get())
+    {
+      cf3_assert(is_not_null(parent));
+      path = parent->name() + "/" + path;
+    }
+    return path;
+  }
+
+  void write_tags(BinaryWriter& out, const Component& component)
+  {
+    const std::vector<std::string> tags = component.get_tags();
+    out.write_uint(tags.size());
+    boost_foreach(const std::string& tag, tags)
+      out.write_string(tag);
+  }
+
+  /// Write a table of element references as pairs of entities index and element index
+  void write_element_connectivity(BinaryWriter& out, const common::Table<Entity>& table)
+  {
+    const Uint nb_entries = table.size()*table.row_size();
+    std::vector<Uint> pairs;
+    pairs.reserve(2*nb_entries);
+    const Entity* entries = table.array().data();
+    for(Uint i = 0; i != nb_entries; ++i)
+    {
+      pairs.push_back(is_null(entries[i].comp) ? Shared::invalid_entities() : entries[i].comp->entities_idx());
+      pairs.push_back(entries[i].idx);
+    }
+    out.write_uint(table.size());
+    out.write_uint(table.row_size());
+    out.write_array(pairs.empty() ? 0 : &pairs[0], pairs.size());
+  }
+
+  template<typename T>
+  void write_table(BinaryWriter& out, const common::Table<T>& table)
+  {
+    out.write_uint(table.size());
+    out.write_uint(table.row_size());
+    out.write_array(table.array().data(), table.size()*table.row_size());
+  }
+
+  /// Tables of bool are stored as Uint, to keep the size of bool out of the format
+  template<typename ArrayT>
+  void write_bool_array(BinaryWriter& out, const ArrayT& array)
+  {
+    const std::vector<Uint> values(array.data(), array.data()+array.num_elements());
+    out.write_array(values.empty() ? 0 : &values[0], values.size());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+Writer::Writer( const std::string& name )
+: MeshWriter(name)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> Writer::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".cf3mesh");
+  return extensions;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write()
+{
+  const boost::filesystem::path path = Shared::rank_path(m_file_path, PE::Comm::instance().rank());
+
+  // Write to a temporary file first, so an interrupted write leaves the previous file intact
+  const boost::filesystem::path tmp_path(path.string() + ".tmp");
+  std::ofstream file(tmp_path.string().c_str(), std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+  if (!file)
+    throw FileSystemError(FromHere(), tmp_path.string() + " failed to open");
+
+  BinaryWriter out(file);
+  out.write_string(Shared::magic());
+  out.write_uint(Shared::version);
+  out.write_uint(sizeof(Uint));
+  out.write_uint(sizeof(Real));
+  out.write_uint(PE::Comm::instance().size());
+  out.write_uint(PE::Comm::instance().rank());
+  out.write_uint(m_mesh->dimension());
+
+  write_metadata(out);
+  write_dictionaries(out);
+  write_regions(out);
+  write_entities(out);
+  write_face_cells(out);
+  write_cell_faces(out);
+  write_fields(out);
+
+  file.close();
+  if (file.fail())
+    throw FileSystemError(FromHere(), "Failed to write " + tmp_path.string());
+
+  boost::filesystem::rename(tmp_path, path);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_metadata(BinaryWriter& out)
+{
+  const PropertyList& metadata = m_mesh->metadata().properties();
+
+  // Only the types that can be stored exactly are kept
+  std::vector<PropertyList::const_iterator> entries;
+  for(PropertyList::const_iterator it = metadata.begin(); it != metadata.end(); ++it)
+  {
+    const std::type_info& type = it->second.type();
+    if(type == typeid(Real) || type == typeid(Uint) || type == typeid(int) || type == typeid(bool) || type == typeid(std::string))
+      entries.push_back(it);
+  }
+
+  out.write_uint(entries.size());
+  boost_foreach(const PropertyList::const_iterator& it, entries)
+  {
+    out.write_string(it->first);
+    const std::type_info& type = it->second.type();
+    if(type == typeid(Real))
+    {
+      out.write_uint(Shared::REAL);
+      out.write_real(boost::any_cast<Real>(it->second));
+    }
+    else if(type == typeid(Uint))
+    {
+      out.write_uint(Shared::UNSIGNED);
+      out.write_uint(boost::any_cast<Uint>(it->second));
+    }
+    else if(type == typeid(int))
+    {
+      out.write_uint(Shared::INTEGER);
+      out.write_uint(static_cast<boost::int64_t>(boost::any_cast<int>(it->second)));
+    }
+    else if(type == typeid(bool))
+    {
+      out.write_uint(Shared::BOOL);
+      out.write_uint(boost::any_cast<bool>(it->second));
+    }
+    else
+    {
+      out.write_uint(Shared::STRING);
+      out.write_string(boost::any_cast<std::string>(it->second));
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_dictionaries(BinaryWriter& out)
+{
+  // The geometry comes first, so the reader can initialize the nodes before anything else
+  std::vector<const Dictionary*> dictionaries(1, &m_mesh->geometry_fields());
+  boost_foreach(const Handle<Dictionary>& dict, m_mesh->dictionaries())
+  {
+    if(dict.get() != dictionaries.front())
+      dictionaries.push_back(dict.get());
+  }
+
+  out.write_uint(dictionaries.size());
+  boost_foreach(const Dictionary* dict, dictionaries)
+  {
+    out.write_string(dict->name());
+    out.write_uint(dict->continuous());
+    out.write_uint(dict->size());
+    out.write_array(dict->glb_idx().array().data(), dict->size());
+    out.write_array(dict->rank().array().data(), dict->size());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_regions(BinaryWriter& out)
+{
+  // Regions are written before the entities, so empty regions and region tags survive the round trip
+  std::vector<const Region*> regions;
+  boost_foreach(const Region& region, find_components_recursively<Region>(*m_mesh))
+    regions.push_back(&region);
+
+  out.write_uint(regions.size());
+  boost_foreach(const Region* region, regions)
+  {
+    out.write_string(relative_path(*region, *m_mesh));
+    write_tags(out, *region);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_entities(BinaryWriter& out)
+{
+  const std::vector< Handle<Entities> >& elements = m_mesh->elements();
+  out.write_uint(elements.size());
+  boost_foreach(const Handle<Entities>& entities, elements)
+  {
+    out.write_string(relative_path(*entities, *m_mesh));
+    out.write_string(entities->derived_type_name());
+    out.write_string(entities->element_type().derived_type_name());
+    write_tags(out, *entities);
+    out.write_uint(entities->size());
+    out.write_array(entities->glb_idx().array().data(), entities->size());
+    out.write_array(entities->rank().array().data(), entities->size());
+
+    const std::vector< Handle<Space> > spaces = entities->spaces();
+    out.write_uint(spaces.size());
+    boost_foreach(const Handle<Space>& space, spaces)
+    {
+      const Connectivity& connectivity = space->connectivity();
+      out.write_string(space->dict().name());
+      out.write_string(space->shape_function().derived_type_name());
+      out.write_uint(connectivity.size());
+      out.write_uint(connectivity.row_size());
+      out.write_array(connectivity.array().data(), connectivity.size()*connectivity.row_size());
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_face_cells(BinaryWriter& out)
+{
+  std::vector<const FaceCellConnectivity*> face_cells;
+  boost_foreach(const FaceCellConnectivity& face_cell, find_components_recursively<FaceCellConnectivity>(m_mesh->topology()))
+    face_cells.push_back(&face_cell);
+
+  out.write_uint(face_cells.size());
+  boost_foreach(const FaceCellConnectivity* face_cell, face_cells)
+  {
+    out.write_string(relative_path(*face_cell, *m_mesh));
+    write_tags(out, *face_cell);
+
+    const std::vector< Handle<Component const> > used = face_cell->used();
+    out.write_uint(used.size());
+    boost_foreach(const Handle<Component const>& component, used)
+      out.write_string(relative_path(*component, *m_mesh));
+
+    write_element_connectivity(out, face_cell->connectivity());
+    write_table(out, face_cell->face_number());
+    out.write_uint(face_cell->is_bdry_face().size());
+    out.write_uint(1);
+    write_bool_array(out, face_cell->is_bdry_face().array());
+    write_table(out, face_cell->cell_rotation());
+    out.write_uint(face_cell->cell_orientation().size());
+    out.write_uint(face_cell->cell_orientation().row_size());
+    write_bool_array(out, face_cell->cell_orientation().array());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_cell_faces(BinaryWriter& out)
+{
+  std::vector< Handle<Entities const> > elements;
+  boost_foreach(const Handle<Entities>& entities, m_mesh->elements())
+  {
+    if(is_not_null(entities->connectivity_cell2face()))
+      elements.push_back(entities);
+  }
+
+  out.write_uint(elements.size());
+  boost_foreach(const Handle<Entities const>& entities, elements)
+  {
+    out.write_string(relative_path(*entities->connectivity_cell2face(), *m_mesh));
+    write_element_connectivity(out, *entities->connectivity_cell2face());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_fields(BinaryWriter& out)
+{
+  std::vector<const Field*> fields(1, &m_mesh->geometry_fields().coordinates());
+  boost_foreach(const Handle<Field const>& field, m_fields)
+  {
+    if(field.get() != fields.front())
+      fields.push_back(field.get());
+  }
+
+  out.write_uint(fields.size());
+  boost_foreach(const Field* field, fields)
+  {
+    out.write_string(field->dict().name());
+    out.write_string(field->name());
+    out.write_string(field->descriptor().description());
+    const std::vector<std::string> tags = field->get_tags();
+    out.write_uint(tags.size());
+    boost_foreach(const std::string& tag, tags)
+      out.write_string(tag);
+    out.write_uint(field->size());
+    out.write_uint(field->row_size());
+    out.write_array(field->array().data(), field->size()*field->row_size());
+  }
+
+  CFdebug << "Wrote " << fields.size() << " fields to " << Shared::rank_path(m_file_path, PE::Comm::instance().rank()).string() << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // cf3mesh
+} // mesh
+} // cf3
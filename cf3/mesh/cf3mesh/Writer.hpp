@@ -0,0 +1,73 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_cf3mesh_Writer_hpp
+#define cf3_mesh_cf3mesh_Writer_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include "mesh/MeshWriter.hpp"
+
+#include "mesh/cf3mesh/LibCF3Mesh.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace cf3mesh {
+
+  class BinaryWriter;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// This class defines the native binary mesh format writer.
+/// Each rank writes its part of the mesh to its own file, path_P<rank>.cf3mesh, without communication.
+/// The complete mesh is written, with all dictionaries, the mesh metadata, the region tags and the face to cell
+/// and cell to face connectivities built by BuildFaces, so it can be read back exactly.
+/// Of the fields, only the configured ones are written, together with the coordinates.
+class cf3mesh_API Writer : public MeshWriter
+{
+public: // functions
+
+  /// constructor
+  Writer( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "Writer"; }
+
+  virtual void write();
+
+  virtual std::string get_format() { return "cf3mesh"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+private: // functions
+
+  void write_metadata(BinaryWriter& out);
+
+  void write_dictionaries(BinaryWriter& out);
+
+  void write_regions(BinaryWriter& out);
+
+  void write_entities(BinaryWriter& out);
+
+  void write_face_cells(BinaryWriter& out);
+
+  void write_cell_faces(BinaryWriter& out);
+
+  void write_fields(BinaryWriter& out);
+
+}; // end Writer
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // cf3mesh
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_cf3mesh_Writer_hpp
@@ -4,6 +4,11 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
+#include <boost/cstdint.hpp>
 #include <boost/foreach.hpp>
 #include <boost/tokenizer.hpp>
 
@@ -13,12 +18,12 @@
 #include "common/OptionList.hpp"
 #include "common/OptionT.hpp"
 #include "common/PropertyList.hpp"
-#include "common/StreamHelpers.hpp"
 #include "common/StringConversion.hpp"
 #include "common/Table.hpp"
 #include "common/List.hpp"
 #include "common/DynTable.hpp"
 
+#include "common/PE/Comm.hpp"
 #include "common/PE/debug.hpp"
 
 #include "mesh/Region.hpp"
@@ -50,9 +55,68 @@ cf3::common::ComponentBuilder < gmsh::Reader, MeshReader, LibGmsh> aGmshReader_B
 
 //////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+/// Size of the slices in which ASCII files are scanned for lines
+const std::size_t slice_size = 1 << 22;
+
+bool is_parallel()
+{
+  return PE::Comm::instance().is_active() && PE::Comm::instance().size() > 1;
+}
+
+Uint to_uint(const boost::uint64_t value)
+{
+  if(value > std::numeric_limits<Uint>::max())
+    throw ParsingFailed(FromHere(), "Value " + to_str(static_cast<unsigned long long>(value)) + " is too large for a 32 bit index");
+  return static_cast<Uint>(value);
+}
+
+template<typename BlockT>
+void pack_blocks(const std::vector<BlockT>& blocks, std::vector<std::size_t>& packed)
+{
+  packed.push_back(blocks.size());
+  BOOST_FOREACH(const BlockT& block, blocks)
+  {
+    packed.push_back(block.first);
+    packed.push_back(block.size);
+    packed.push_back(block.offset);
+    packed.push_back(block.data_offset);
+    packed.push_back(block.type);
+    packed.push_back(block.nb_values);
+    packed.push_back(block.entity_dim);
+    packed.push_back(block.entity_tag);
+  }
+}
+
+template<typename BlockT>
+std::size_t unpack_blocks(const std::vector<std::size_t>& packed, std::size_t pos, std::vector<BlockT>& blocks)
+{
+  blocks.resize(packed[pos++]);
+  BOOST_FOREACH(BlockT& block, blocks)
+  {
+    block.first = packed[pos++];
+    block.size = packed[pos++];
+    block.offset = packed[pos++];
+    block.data_offset = packed[pos++];
+    block.type = packed[pos++];
+    block.nb_values = packed[pos++];
+    block.entity_dim = packed[pos++];
+    block.entity_tag = packed[pos++];
+  }
+  return pos;
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 Reader::Reader( const std::string& name )
 : MeshReader(name),
-  Shared()
+  Shared(),
+  m_major_version(2),
+  m_binary(false)
 {
 
   // options
@@ -75,14 +139,13 @@ Reader::Reader( const std::string& name )
   properties()["brief"] = std::string("Gmsh file reader component");
 
   std::string desc;
-  desc += "This component can read in parallel.\n";
+  desc += "This component can read in parallel, each process parsing only its own part of the file.\n";
+  desc += "It reads versions 2.2 and 4.1 of the format, in ASCII and binary.\n";
   desc += "It can also read multiple files in serial, combining them in one large mesh.\n";
   desc += "Available coolfluid-element types are:\n";
   boost_foreach(const std::string& supported_type, m_supported_types)
   desc += "  - " + supported_type + "\n";
   properties()["description"] = desc;
-
-  IO_rank = 0;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -98,18 +161,9 @@ std::vector<std::string> Reader::get_extensions()
 
 void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
 {
-
-  // if the file is present open it
   boost::filesystem::path fp (file.path());
-  if( boost::filesystem::exists(fp) )
-  {
-    CFinfo <<  "Opening file " <<  fp.string() << CFendl;
-    m_file.open(fp,std::ios_base::in); // exists so open it
-  }
-  else // doesnt exist so throw exception
-  {
-     throw boost::filesystem::filesystem_error( fp.string() + " does not exist", boost::system::error_code() );
-  }
+  CFinfo <<  "Opening file " <<  fp.string() << CFendl;
+  m_file.open(fp);
 
   m_file_basename = boost::filesystem::basename(fp);
 
@@ -120,13 +174,25 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
   // NOTE: since gmsh contains several 'physical entities' in one mesh, we create one region per physical entity
   m_region = Handle<Region>(m_mesh->topology().handle<Component>());
 
-  // Read file once and store positions
+  // Locate the sections and the blocks of nodes and elements, without reading them
+  read_format();
   get_file_positions();
-  cf3_assert(m_hash);
+  read_physical_names();
+  read_entities();
+
+  if (is_not_null(get_child("hash")))
+    remove_component("hash");
+  m_hash = create_component<MergedParallelDistribution>("hash");
+  std::vector<Uint> num_obj(2);
+  num_obj[0] = m_total_nb_nodes;
+  num_obj[1] = m_total_nb_elements;
+  m_hash->options().set("nb_parts",options().value<Uint>("nb_parts"));
+  m_hash->options().set("nb_obj",num_obj);
+
+  read_element_records();
 
   m_mesh->initialize_nodes(0, m_mesh_dimension);
 
-  find_used_nodes();
   read_coordinates();
   read_connectivity();
 
@@ -138,15 +204,16 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
     read_node_data();
   }
 
-  m_node_idx_gmsh_to_cf.clear();
-  m_elem_idx_gmsh_to_cf.clear();
-
   // clean-up
-  m_ghost_nodes.clear();
-  m_used_nodes.clear();
-  m_node_idx_gmsh_to_cf.clear();
-  if (is_not_null(m_hash))
-    remove_component(*m_hash);
+  std::vector<Uint>().swap(m_elem_tags);
+  std::vector<Uint>().swap(m_elem_types);
+  std::vector<Uint>().swap(m_elem_regions);
+  std::vector<std::size_t>().swap(m_elem_node_starts);
+  std::vector<Uint>().swap(m_elem_nodes);
+  std::vector<Uint>().swap(m_node_tags);
+  std::vector< std::pair<Uint, std::pair<Uint,Uint> > >().swap(m_elem_locations);
+  m_entities.clear();
+  remove_component(*m_hash);
 
   // close the file
   m_file.close();
@@ -156,109 +223,458 @@ void Reader::do_read_mesh_into(const URI& file, Mesh& mesh)
 
 //////////////////////////////////////////////////////////////////////////////
 
+void Reader::read_format()
+{
+  m_file.seek(0);
+  if (m_file.read_word() != "$MeshFormat")
+    throw FileFormatError(FromHere(), m_file_basename + " is not a gmsh file, it does not start with $MeshFormat");
+
+  const std::string version = m_file.read_word();
+  const Uint file_type = m_file.read_uint();
+  const Uint data_size = m_file.read_uint();
+
+  if (version[0] == '2')
+    m_major_version = 2;
+  else if (version == "4.1")
+    m_major_version = 4;
+  else
+    throw FileFormatError(FromHere(), m_file_basename + " has gmsh format version " + version + ", only versions 2.2 and 4.1 are supported");
+
+  if (data_size != sizeof(Real))
+    throw FileFormatError(FromHere(), m_file_basename + " has data size " + to_str(data_size) + ", only " + to_str(sizeof(Real)) + " is supported");
+
+  m_binary = (file_type == 1);
+  m_file.skip_line();
+  if (m_binary)
+  {
+    // gmsh writes the integer 1 to detect the byte order
+    if (m_file.read_binary<int>() != 1)
+      throw FileFormatError(FromHere(), m_file_basename + " was written on a machine with a different byte order");
+    m_file.skip_line();
+  }
+
+  if (m_file.read_word() != "$EndMeshFormat")
+    m_file.throw_parse_error("$EndMeshFormat");
+  m_file.skip_line();
+
+  CFdebug << "Reading gmsh " << version << (m_binary ? " binary" : " ASCII") << " file" << CFendl;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 void Reader::get_file_positions()
 {
-  std::string region_names("$PhysicalNames");
-  std::string nodes("$Nodes");
-  std::string elements("$Elements");
-  std::string element_data("$ElementData");
-  std::string node_data("$NodeData");
-  std::string element_node_data("$ElementNodeData");
-
-  m_element_data_positions.clear();
-  m_node_data_positions.clear();
-  m_element_node_data_positions.clear();
-  m_elements_position=0;
-  int p;
-  std::string line;
-  while (!m_file.eof())
+  m_sections.clear();
+  m_node_blocks.clear();
+  m_element_blocks.clear();
+
+  if (m_binary)
+    get_binary_file_positions();
+  else
+    get_ascii_file_positions();
+
+  m_total_nb_nodes = 0;
+  BOOST_FOREACH(const Block& block, m_node_blocks)
+    m_total_nb_nodes += block.size;
+  m_total_nb_elements = 0;
+  BOOST_FOREACH(const Block& block, m_element_blocks)
+    m_total_nb_elements += block.size;
+
+  if (m_total_nb_nodes == 0) throw ParsingFailed(FromHere(),"File contains no nodes");
+  if (m_total_nb_elements == 0) throw ParsingFailed(FromHere(),"File does not contain any elements");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::get_ascii_file_positions()
+{
+  const std::size_t nb_slices = (m_file.size() + slice_size - 1) / slice_size;
+  m_slice_offsets.resize(nb_slices+1);
+  for (std::size_t s = 0; s <= nb_slices; ++s)
+    m_slice_offsets[s] = std::min(s*slice_size, m_file.size());
+
+  // Each process counts the lines and finds the section markers in its own slices
+  const Uint nb_procs = is_parallel() ? PE::Comm::instance().size() : 1u;
+  const Uint rank = is_parallel() ? PE::Comm::instance().rank() : 0u;
+  std::vector<std::size_t> first_slice(nb_procs+1);
+  for (Uint p = 0; p <= nb_procs; ++p)
+    first_slice[p] = nb_slices*p/nb_procs;
+
+  std::vector<std::size_t> local;
+  for (std::size_t s = first_slice[rank]; s != first_slice[rank+1]; ++s)
+    local.push_back(m_file.count_lines(m_slice_offsets[s], m_slice_offsets[s+1]));
+  const char* data = m_file.data();
+  for (std::size_t s = first_slice[rank]; s != first_slice[rank+1]; ++s)
   {
-    p = m_file.tellg();
-    getline(m_file,line);
-    if (line.find(region_names)!=std::string::npos) {
-      m_region_names_position=p;
-      m_file >> m_nb_regions;
-      m_region_list.resize(m_nb_regions);
-
-      m_nb_gmsh_elem_in_region.resize(m_nb_regions);
-      for(Uint ir = 0; ir < m_nb_regions; ++ir)
-      {
-        m_nb_gmsh_elem_in_region[ir].resize(Shared::nb_gmsh_types);
-        for(Uint type = 0; type < Shared::nb_gmsh_types; ++ type)
-           (m_nb_gmsh_elem_in_region[ir])[type] = 0;
-      }
+    const char* pos = data + m_slice_offsets[s];
+    const char* const slice_end = data + m_slice_offsets[s+1];
+    while ( (pos = static_cast<const char*>(std::memchr(pos, '$', slice_end - pos))) != 0 )
+    {
+      if (pos == data || *(pos-1) == '\n')
+        local.push_back(pos - data);
+      ++pos;
+    }
+  }
 
-      m_mesh_dimension = options().value<Uint>("dimension");
-      for(Uint ir = 0; ir < m_nb_regions; ++ir)
-      {
-        Uint phys_group_dimensionality;
-        Uint phys_group_index;
-        std::string phys_group_name;
-        m_file >> phys_group_dimensionality >> phys_group_index >> phys_group_name;
-        m_region_list[phys_group_index-1].dim=phys_group_dimensionality;
-        m_region_list[phys_group_index-1].index=phys_group_index;
-        //The original name of the region in the mesh file has quotes, we want to strip them off
-        m_region_list[phys_group_index-1].name=phys_group_name.substr(1,phys_group_name.length()-2);
-        m_region_list[phys_group_index-1].region = create_region(m_region_list[phys_group_index-1].name);
-        m_mesh_dimension = std::max(m_region_list[phys_group_index-1].dim,m_mesh_dimension);
-      }
+  std::vector< std::vector<std::size_t> > received(1, local);
+  if (is_parallel())
+  {
+    std::vector< std::vector<std::size_t> > send(nb_procs, local);
+    PE::Comm::instance().all_to_all(send, received);
+  }
+
+  m_slice_lines.assign(nb_slices+1, 0);
+  std::vector<std::size_t> markers;
+  for (Uint p = 0; p != nb_procs; ++p)
+  {
+    const std::size_t nb_proc_slices = first_slice[p+1] - first_slice[p];
+    for (std::size_t s = 0; s != nb_proc_slices; ++s)
+      m_slice_lines[first_slice[p]+s+1] = received[p][s];
+    markers.insert(markers.end(), received[p].begin()+nb_proc_slices, received[p].end());
+  }
+  for (std::size_t s = 0; s != nb_slices; ++s)
+    m_slice_lines[s+1] += m_slice_lines[s];
+
+  BOOST_FOREACH(const std::size_t marker, markers)
+  {
+    m_file.seek(marker);
+    const std::string name = m_file.read_word().substr(1);
+    if (name.compare(0, 3, "End") == 0 || name == "MeshFormat")
+      continue;
+    Section section;
+    section.name = name;
+    section.begin = m_file.find_line(marker, 1);
+    m_sections.push_back(section);
+  }
+
+  // Only the first process walks the blocks, which may need to skip through the whole section in version 4
+  std::vector<std::size_t> packed;
+  if (!is_parallel() || PE::Comm::instance().rank() == 0)
+  {
+    BOOST_FOREACH(const Section& section, m_sections)
+    {
+      if (section.name == "Nodes")
+        read_node_blocks(section.begin);
+      else if (section.name == "Elements")
+        read_element_blocks(section.begin);
+    }
+    pack_blocks(m_node_blocks, packed);
+    pack_blocks(m_element_blocks, packed);
+  }
+  if (is_parallel())
+  {
+    std::vector<std::size_t> received_blocks;
+    PE::Comm::instance().broadcast(packed, received_blocks, 0);
+    unpack_blocks(received_blocks, unpack_blocks(received_blocks, 0, m_node_blocks), m_element_blocks);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::get_binary_file_positions()
+{
+  while (!m_file.at_end())
+  {
+    const std::string marker = m_file.read_word();
+    if (marker[0] != '$')
+      m_file.throw_parse_error("section marker");
+    Section section;
+    section.name = marker.substr(1);
+    m_file.skip_line();
+    section.begin = m_file.position();
+    m_sections.push_back(section);
+
+    if (section.name == "Nodes")
+      m_file.seek(read_node_blocks(section.begin));
+    else if (section.name == "Elements")
+      m_file.seek(read_element_blocks(section.begin));
+    skip_section(section.name);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::skip_section(const std::string& name)
+{
+  const std::string end_marker = "$End" + name;
+  const std::size_t end = m_file.find(end_marker, m_file.position());
+  if (end == m_file.size())
+    throw ParsingFailed(FromHere(), "Section $" + name + " has no " + end_marker + " in " + m_file_basename);
+  m_file.seek(end);
+  m_file.skip_line();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t Reader::line_offset(const std::size_t line) const
+{
+  if (line == 0)
+    return 0;
+  // the slice containing the end of line before the requested line
+  const std::size_t s = std::upper_bound(m_slice_lines.begin(), m_slice_lines.end(), line-1) - m_slice_lines.begin() - 1;
+  return m_file.find_line(m_slice_offsets[s], line - m_slice_lines[s]);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t Reader::line_index(const std::size_t offset) const
+{
+  const std::size_t s = std::upper_bound(m_slice_offsets.begin(), m_slice_offsets.end(), offset) - m_slice_offsets.begin() - 1;
+  return m_slice_lines[s] + m_file.count_lines(m_slice_offsets[s], offset);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t Reader::read_node_blocks(const std::size_t section_begin)
+{
+  m_file.seek(section_begin);
+  // line index of the current position, for ASCII files
+  std::size_t line = m_binary ? 0 : line_index(section_begin);
+
+  Block block;
+  block.first = 0;
+  block.type = 0;
+  block.nb_values = 3;
+  block.entity_dim = 0;
+  block.entity_tag = 0;
+
+  if (m_major_version == 2)
+  {
+    block.size = m_file.read_size();
+    m_file.skip_line();
+    block.offset = block.data_offset = m_binary ? m_file.position() : line+1;
+    m_node_blocks.push_back(block);
+    return m_binary ? block.offset + block.size*(sizeof(int)+3*sizeof(Real)) : 0;
+  }
+
+  // version 4: entity blocks, each with the node tags followed by the coordinates
+  std::size_t nb_blocks;
+  if (m_binary)
+  {
+    nb_blocks = m_file.read_binary<boost::uint64_t>();
+    m_file.skip_bytes(3*sizeof(boost::uint64_t));
+  }
+  else
+  {
+    nb_blocks = m_file.read_size();
+    m_file.skip_line();
+    ++line;
+  }
+
+  for (std::size_t b = 0; b != nb_blocks; ++b)
+  {
+    int parametric;
+    if (m_binary)
+    {
+      block.entity_dim = m_file.read_binary<int>();
+      block.entity_tag = m_file.read_binary<int>();
+      parametric = m_file.read_binary<int>();
+      block.size = m_file.read_binary<boost::uint64_t>();
     }
-    else if (line.find(nodes)!=std::string::npos) {
-      m_coordinates_position=p;
-      m_file >> m_total_nb_nodes;
-//      CFinfo << "The total number of nodes is " << m_total_nb_nodes << CFendl;
-      if (m_total_nb_nodes == 0) throw ParsingFailed(FromHere(),"File contains no nodes");
+    else
+    {
+      block.entity_dim = m_file.read_uint();
+      block.entity_tag = m_file.read_int();
+      parametric = m_file.read_int();
+      block.size = m_file.read_size();
+      m_file.skip_line();
+      ++line;
     }
-    else if (line.find(elements)!=std::string::npos)
+    block.nb_values = 3 + (parametric ? block.entity_dim : 0);
+
+    if (m_binary)
     {
-      m_elements_position = p;
-      m_file >> m_total_nb_elements;
-//      CFinfo << "The total number of elements is " << m_total_nb_elements << CFendl;
-      if (m_total_nb_elements == 0) throw ParsingFailed(FromHere(),"File contains no elements");
-      //Create a hash
-      m_hash = create_component<MergedParallelDistribution>("hash");
-      std::vector<Uint> num_obj(2);
-      num_obj[0] = m_total_nb_nodes;
-      num_obj[1] = m_total_nb_elements;
-      m_hash->options().set("nb_parts",options().value<Uint>("nb_parts"));
-      m_hash->options().set("nb_obj",num_obj);
-
-
-      Uint elem_idx, elem_type, nb_tags, phys_tag;
-
-      //Let's count how many elements of each type are present
-      for(Uint ie = 0; ie < m_total_nb_elements; ++ie)
-      {
-          m_file >> elem_idx;
-          m_file >> elem_type;
-          m_file >> nb_tags;
-          m_file >> phys_tag;
-          cf3_assert(phys_tag > 0);
-          getline(m_file,line);
-          if (m_hash->subhash(ELEMS).owns(ie))
-            (m_nb_gmsh_elem_in_region[phys_tag-1])[elem_type]++;
-          m_region_list[phys_tag-1].element_types.insert(elem_type);
-      }
+      block.offset = m_file.position();
+      block.data_offset = block.offset + block.size*sizeof(boost::uint64_t);
+      m_file.seek(block.data_offset);
+      m_file.skip_bytes(block.size*block.nb_values*sizeof(Real));
+    }
+    else
+    {
+      block.offset = line;
+      block.data_offset = line + block.size;
+      m_file.skip_lines(2*block.size);
+      line += 2*block.size;
+    }
+    m_node_blocks.push_back(block);
+    block.first += block.size;
+  }
+  return m_file.position();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::size_t Reader::read_element_blocks(const std::size_t section_begin)
+{
+  m_file.seek(section_begin);
+  std::size_t line = m_binary ? 0 : line_index(section_begin);
+
+  Block block;
+  block.first = 0;
+  block.data_offset = 0;
+  block.type = 0;
+  block.nb_values = 0;
+  block.entity_dim = 0;
+  block.entity_tag = 0;
+
+  if (m_major_version == 2 && !m_binary)
+  {
+    // One line per element, each with its own type
+    block.size = m_file.read_size();
+    block.offset = line+1;
+    m_element_blocks.push_back(block);
+    return 0;
+  }
+
+  if (m_major_version == 2)
+  {
+    const std::size_t nb_elements = m_file.read_size();
+    m_file.skip_line();
+    while (block.first != nb_elements)
+    {
+      block.type = m_file.read_binary<int>();
+      block.size = m_file.read_binary<int>();
+      block.nb_values = m_file.read_binary<int>();
+      if (block.type >= nb_gmsh_types || m_nodes_in_gmsh_elem[block.type] == 0)
+        throw ParsingFailed(FromHere(), "Unsupported gmsh element type " + to_str(block.type) + " in " + m_file_basename);
+      block.offset = m_file.position();
+      m_file.skip_bytes(block.size*(1+block.nb_values+m_nodes_in_gmsh_elem[block.type])*sizeof(int));
+      m_element_blocks.push_back(block);
+      block.first += block.size;
     }
-    else if (line.find(element_data)!=std::string::npos)
+    return m_file.position();
+  }
+
+  // version 4: entity blocks of elements of one type
+  std::size_t nb_blocks;
+  if (m_binary)
+  {
+    nb_blocks = m_file.read_binary<boost::uint64_t>();
+    m_file.skip_bytes(3*sizeof(boost::uint64_t));
+  }
+  else
+  {
+    nb_blocks = m_file.read_size();
+    m_file.skip_line();
+    ++line;
+  }
+
+  for (std::size_t b = 0; b != nb_blocks; ++b)
+  {
+    if (m_binary)
     {
-      m_element_data_positions.push_back(p);
+      block.entity_dim = m_file.read_binary<int>();
+      block.entity_tag = m_file.read_binary<int>();
+      block.type = m_file.read_binary<int>();
+      block.size = m_file.read_binary<boost::uint64_t>();
     }
-    else if (line.find(node_data)!=std::string::npos)
+    else
+    {
+      block.entity_dim = m_file.read_uint();
+      block.entity_tag = m_file.read_int();
+      block.type = m_file.read_uint();
+      block.size = m_file.read_size();
+      m_file.skip_line();
+      ++line;
+    }
+    if (block.type >= nb_gmsh_types || m_nodes_in_gmsh_elem[block.type] == 0)
+      throw ParsingFailed(FromHere(), "Unsupported gmsh element type " + to_str(block.type) + " in " + m_file_basename);
+
+    if (m_binary)
     {
-      m_node_data_positions.push_back(p);
+      block.offset = m_file.position();
+      m_file.skip_bytes(block.size*(1+m_nodes_in_gmsh_elem[block.type])*sizeof(boost::uint64_t));
     }
-    else if (line.find(element_node_data)!=std::string::npos)
+    else
     {
-      m_element_node_data_positions.push_back(p);
+      block.offset = line;
+      m_file.skip_lines(block.size);
+      line += block.size;
     }
+    m_element_blocks.push_back(block);
+    block.first += block.size;
+  }
+  return m_file.position();
+}
+
+//////////////////////////////////////////////////////////////////////////////
 
+void Reader::read_physical_names()
+{
+  m_region_list.clear();
+  m_region_of_physical_tag.clear();
+  m_mesh_dimension = options().value<Uint>("dimension");
+
+  BOOST_FOREACH(const Section& section, m_sections)
+  {
+    if (section.name != "PhysicalNames")
+      continue;
+    m_file.seek(section.begin);
+    const Uint nb_regions = m_file.read_uint();
+    for(Uint ir = 0; ir < nb_regions; ++ir)
+    {
+      RegionData region_data;
+      region_data.dim = m_file.read_uint();
+      region_data.index = m_file.read_uint();
+      region_data.name = m_file.read_quoted();
+      region_data.region = create_region(region_data.name);
+      m_region_of_physical_tag[region_data.index] = m_region_list.size();
+      m_region_list.push_back(region_data);
+      m_mesh_dimension = std::max(region_data.dim,m_mesh_dimension);
+    }
   }
-  if (m_elements_position==0)
+  m_nb_regions = m_region_list.size();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void Reader::read_entities()
+{
+  m_entity_physical_tag.clear();
+  if (m_major_version != 4)
+    return;
+
+  BOOST_FOREACH(const Section& section, m_sections)
   {
-    throw ParsingFailed(FromHere(),"File does not contain any elements");
+    if (section.name != "Entities")
+      continue;
+    m_file.seek(section.begin);
+
+    std::size_t nb_entities[4];
+    for (Uint dim = 0; dim != 4; ++dim)
+      nb_entities[dim] = m_binary ? m_file.read_binary<boost::uint64_t>() : m_file.read_size();
+
+    for (Uint dim = 0; dim != 4; ++dim)
+    {
+      // points have their coordinates, the others their bounding box
+      const Uint nb_coords = dim == 0 ? 3 : 6;
+      for (std::size_t e = 0; e != nb_entities[dim]; ++e)
+      {
+        if (m_binary)
+        {
+          const int tag = m_file.read_binary<int>();
+          m_file.skip_bytes(nb_coords*sizeof(Real));
+          const std::size_t nb_physicals = m_file.read_binary<boost::uint64_t>();
+          if (nb_physicals != 0)
+            m_entity_physical_tag[std::make_pair(dim, tag)] = m_file.read_binary<int>();
+          if (nb_physicals > 1)
+            m_file.skip_bytes((nb_physicals-1)*sizeof(int));
+          if (dim != 0)
+            m_file.skip_bytes(m_file.read_binary<boost::uint64_t>()*sizeof(int));
+        }
+        else
+        {
+          const int tag = m_file.read_int();
+          for (Uint c = 0; c != nb_coords; ++c)
+            m_file.read_real();
+          const std::size_t nb_physicals = m_file.read_size();
+          if (nb_physicals != 0)
+            m_entity_physical_tag[std::make_pair(dim, tag)] = m_file.read_int();
+          m_file.skip_line();
+        }
+      }
+    }
   }
-  m_file.clear();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -282,372 +698,373 @@ Handle< Region > Reader::create_region(std::string const& relative_path)
 
 //////////////////////////////////////////////////////////////////////////////
 
-void Reader::find_used_nodes()
+void Reader::read_element_records()
 {
-  m_used_nodes.clear();
-  std::string line;
-
-  m_file.seekg(m_elements_position,std::ios::beg);
-  // skip next line
-  getline(m_file,line);
-//  if (PE::Comm::instance().rank()==IO_rank)
-//    std::cout << "header = " << line << std::endl;
-  //Skip the line containing the actual number of elements
-  getline(m_file,line);
-//  if (PE::Comm::instance().rank()==IO_rank)
-//    std::cout << "nb_elems = " << line << std::endl;
-
-  // read every line and store the connectivity in the correct region through the buffer
-  Uint elementNumber, elementType, nbElementNodes;
-  Uint gmsh_node_number, nb_tags, phys_tag, other_tag;
-
-  std::set<Uint>::iterator it=m_used_nodes.begin();
-
-//  if (PE::Comm::instance().rank()==IO_rank)
-//  {
-//    std::cout << "nb_obj = "   << m_hash->subhash(ELEMS).options()["nb_obj"].value<Uint>() << std::endl;
-//    std::cout << "nb_parts = " <<m_hash->subhash(ELEMS).options()["nb_parts"].value<Uint>() << std::endl;
-//  }
-  for (Uint i=0; i<m_total_nb_elements; ++i)
+  const ParallelDistribution& elem_distribution = m_hash->subhash(ELEMS);
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint begin = elem_distribution.start_idx_in_proc(rank);
+  const Uint end = elem_distribution.end_idx_in_proc(rank);
+
+  m_elem_tags.clear();
+  m_elem_types.clear();
+  m_elem_regions.clear();
+  m_elem_nodes.clear();
+  m_elem_node_starts.assign(1, 0);
+  m_elem_tags.reserve(end-begin);
+  m_elem_types.reserve(end-begin);
+  m_elem_regions.reserve(end-begin);
+  m_elem_node_starts.reserve(end-begin+1);
+  m_nb_elems_of_type.assign(m_nb_regions*nb_gmsh_types, 0);
+
+  BOOST_FOREACH(const Block& block, m_element_blocks)
   {
-//    if (m_total_nb_elements > 100000)
-//    {
-//      if(i%(m_total_nb_elements/20)==0)
-//        CFinfo << 100*i/m_total_nb_elements << "% " << CFflush;
-//    }
-
-    cf3_assert(m_hash);
-    if (m_hash->subhash(ELEMS).owns(i))
+    const std::size_t block_begin = std::max<std::size_t>(begin, block.first);
+    const std::size_t block_end = std::min<std::size_t>(end, block.first+block.size);
+    if (block_begin >= block_end)
+      continue;
+
+    Uint physical_tag = 0;
+    if (m_major_version == 4)
     {
-      // element description
-      m_file >> elementNumber >> elementType;
-      nbElementNodes = Shared::m_nodes_in_gmsh_elem[elementType];
-
-//      if (PE::Comm::instance().rank()==IO_rank)
-//        std::cout << i << ":  elem["<<m_hash->subhash(ELEMS).part_of_obj(i)<<"] " << elementNumber << " :    ";
-      m_file >> nb_tags;
-      m_file >> phys_tag;
-      for(Uint itag = 0; itag < (nb_tags-1); ++itag)
-          m_file >> other_tag;
-
-      for (Uint j=0; j<nbElementNodes; ++j)
+      std::map<std::pair<Uint,int>, Uint>::const_iterator it = m_entity_physical_tag.find(std::make_pair(static_cast<Uint>(block.entity_dim), static_cast<int>(block.entity_tag)));
+      if (it == m_entity_physical_tag.end())
+        throw ParsingFailed(FromHere(), "Elements of entity " + to_str(block.entity_tag) + " of dimension " + to_str(block.entity_dim) + " are not in a physical group in " + m_file_basename);
+      physical_tag = it->second;
+    }
+
+    if (m_major_version == 2 && m_binary)
+      m_file.seek(block.offset + (block_begin-block.first)*(1+block.nb_values+m_nodes_in_gmsh_elem[block.type])*sizeof(int));
+    else if (m_binary)
+      m_file.seek(block.offset + (block_begin-block.first)*(1+m_nodes_in_gmsh_elem[block.type])*sizeof(boost::uint64_t));
+    else
+      m_file.seek(line_offset(block.offset + (block_begin-block.first)));
+
+    for (std::size_t e = block_begin; e != block_end; ++e)
+    {
+      Uint tag;
+      Uint type = block.type;
+      if (m_major_version == 2 && !m_binary)
+      {
+        // elm-number elm-type number-of-tags < tag > ... node-number-list
+        tag = m_file.read_uint();
+        type = m_file.read_uint();
+        const Uint nb_tags = m_file.read_uint();
+        physical_tag = nb_tags != 0 ? m_file.read_uint() : 0u;
+        for (Uint t = 1; t < nb_tags; ++t)
+          m_file.read_int();
+      }
+      else if (m_major_version == 2)
       {
-        m_file >> gmsh_node_number;
-        it = m_used_nodes.insert(it,gmsh_node_number);
-//        if (PE::Comm::instance().rank()==IO_rank)
-//          std::cout << "  " << gmsh_node_number;
+        tag = m_file.read_binary<int>();
+        physical_tag = block.nb_values != 0 ? m_file.read_binary<int>() : 0;
+        if (block.nb_values > 1)
+          m_file.skip_bytes((block.nb_values-1)*sizeof(int));
       }
-//      if (PE::Comm::instance().rank()==IO_rank)
-//        std::cout << "\n";
+      else
+      {
+        tag = m_binary ? to_uint(m_file.read_binary<boost::uint64_t>()) : m_file.read_uint();
+      }
+
+      if (type >= nb_gmsh_types || m_nodes_in_gmsh_elem[type] == 0)
+        throw ParsingFailed(FromHere(), "Unsupported gmsh element type " + to_str(type) + " in " + m_file_basename);
+      std::map<Uint,Uint>::const_iterator region_it = m_region_of_physical_tag.find(physical_tag);
+      if (region_it == m_region_of_physical_tag.end())
+        throw ParsingFailed(FromHere(), "Element " + to_str(tag) + " is in physical group " + to_str(physical_tag) + ", which is not in the $PhysicalNames of " + m_file_basename);
+
+      const Uint nb_nodes = m_nodes_in_gmsh_elem[type];
+      for (Uint n = 0; n != nb_nodes; ++n)
+      {
+        if (m_binary)
+          m_elem_nodes.push_back(m_major_version == 2 ? static_cast<Uint>(m_file.read_binary<int>()) : to_uint(m_file.read_binary<boost::uint64_t>()));
+        else
+          m_elem_nodes.push_back(m_file.read_uint());
+      }
+      if (!m_binary)
+        m_file.skip_line();
+
+      m_elem_tags.push_back(tag);
+      m_elem_types.push_back(type);
+      m_elem_regions.push_back(region_it->second);
+      m_elem_node_starts.push_back(m_elem_nodes.size());
+      ++m_nb_elems_of_type[region_it->second*nb_gmsh_types + type];
     }
-    getline(m_file,line); // finnish the line
   }
 
-  // Now we have all nodes, used by the elements
+  // All processes create the same element components, also the empty ones
+  m_elem_type_present.resize(m_nb_elems_of_type.size());
+  for (Uint i = 0; i != m_nb_elems_of_type.size(); ++i)
+    m_elem_type_present[i] = m_nb_elems_of_type[i] != 0;
+  if (is_parallel())
+  {
+    std::vector<Uint> local_present(m_elem_type_present);
+    PE::Comm::instance().all_reduce(PE::max(), local_present, m_elem_type_present);
+  }
+  for (Uint i = 0; i != m_elem_type_present.size(); ++i)
+  {
+    if (m_elem_type_present[i])
+      m_mesh_dimension = std::max(m_mesh_dimension, m_gmsh_elem_dim[i % nb_gmsh_types]);
+  }
+}
 
-  // Now add owned nodes
-  m_file.seekg(m_coordinates_position,std::ios::beg);
-  //Skip the line with keyword '$Nodes':
-  getline(m_file,line);
-//  if (PE::Comm::instance().rank()==IO_rank)
-//    std::cout << "header = " << line << std::endl;
-  // skip one line, which says how many (total) nodes are  present in the mesh
-  getline(m_file,line);
-//  if (PE::Comm::instance().rank()==IO_rank)
-//    std::cout << "nb_nodes = " << line << std::endl;
+//////////////////////////////////////////////////////////////////////////////
 
-  for (Uint node_idx=0; node_idx<m_total_nb_nodes; ++node_idx)
+void Reader::read_node_records(const Uint begin, const Uint end, std::vector<Uint>& tags, std::vector<Real>& coordinates)
+{
+  BOOST_FOREACH(const Block& block, m_node_blocks)
   {
-//    if (m_total_nb_nodes > 100000)
-//    {
-//      if(node_idx%(m_total_nb_nodes/20)==0)
-//        CFinfo << 100*node_idx/m_total_nb_nodes << "% " << CFflush;
-//      if (node_idx == m_total_nb_nodes-1)
-//        CFinfo << CFendl;
-//    }
-    getline(m_file,line);
-
-    std::stringstream ss(line);
-    ss >> gmsh_node_number;
-    getline(ss,line);
-    if (m_hash->subhash(NODES).owns(node_idx))
+    const std::size_t block_begin = std::max<std::size_t>(begin, block.first);
+    const std::size_t block_end = std::min<std::size_t>(end, block.first+block.size);
+    if (block_begin >= block_end)
+      continue;
+    const std::size_t skipped = block_begin - block.first;
+
+    if (m_major_version == 2)
     {
-//      if (PE::Comm::instance().rank()==IO_rank)
-//        std::cout << "node " << gmsh_node_number << "\n";
+      // node-number x-coord y-coord z-coord
+      if (m_binary)
+        m_file.seek(block.offset + skipped*(sizeof(int)+3*sizeof(Real)));
+      else
+        m_file.seek(line_offset(block.offset + skipped));
+      for (std::size_t n = block_begin; n != block_end; ++n)
+      {
+        tags.push_back(m_binary ? static_cast<Uint>(m_file.read_binary<int>()) : m_file.read_uint());
+        for (Uint d = 0; d != 3; ++d)
+          coordinates.push_back(m_binary ? m_file.read_binary<Real>() : m_file.read_real());
+        if (!m_binary)
+          m_file.skip_line();
+      }
+      continue;
+    }
 
-      it = m_used_nodes.insert(it,gmsh_node_number);
+    // version 4: the tags of the block, followed by the coordinates
+    if (m_binary)
+    {
+      m_file.seek(block.offset + skipped*sizeof(boost::uint64_t));
+      for (std::size_t n = block_begin; n != block_end; ++n)
+        tags.push_back(to_uint(m_file.read_binary<boost::uint64_t>()));
+      m_file.seek(block.data_offset + skipped*block.nb_values*sizeof(Real));
+      for (std::size_t n = block_begin; n != block_end; ++n)
+      {
+        for (Uint d = 0; d != 3; ++d)
+          coordinates.push_back(m_file.read_binary<Real>());
+        m_file.skip_bytes((block.nb_values-3)*sizeof(Real));
+      }
     }
     else
     {
-      it = m_used_nodes.find(gmsh_node_number);
-      if (it != m_used_nodes.end())
+      m_file.seek(line_offset(block.offset + skipped));
+      for (std::size_t n = block_begin; n != block_end; ++n)
+        tags.push_back(m_file.read_uint());
+      m_file.seek(line_offset(block.data_offset + skipped));
+      for (std::size_t n = block_begin; n != block_end; ++n)
       {
-        m_ghost_nodes.insert(node_idx);
-//        if (PE::Comm::instance().rank()==IO_rank)
-//          std::cout << "ghostnode " << gmsh_node_number << "\n";
+        for (Uint d = 0; d != 3; ++d)
+          coordinates.push_back(m_file.read_real());
+        m_file.skip_line();
       }
     }
   }
-//  if (PE::Comm::instance().rank()==IO_rank)
-//    std::cout << std::flush;
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 void Reader::read_coordinates()
 {
-
-  m_file.seekg(m_coordinates_position,std::ios::beg);
-
-  Dictionary& nodes = m_mesh->geometry_fields();
-  nodes.resize(m_used_nodes.size());
-  m_used_nodes.clear();
-
-  Uint part = options().value<Uint>("part");
-
-  std::string line;
-  //Skip the line with keyword '$Nodes':
-  getline(m_file,line);
-//  CFinfo << line << CFendl;
-  // skip one line, which says how many (total) nodes are  present in the mesh
-  getline(m_file,line);
-//  CFinfo << line << CFendl;
-
-
-  // declare and allocate one coordinate row
-//  std::vector<Real> rowVector(m_mesh_dimension);
-
-  std::set<Uint>::const_iterator it;
-
-  Uint coord_idx=0;
-  Uint gmsh_node_number;
-
-  for (Uint node_idx=0; node_idx<m_total_nb_nodes; ++node_idx)
+  const ParallelDistribution& node_distribution = m_hash->subhash(NODES);
+  const Uint rank = PE::Comm::instance().rank();
+  const Uint part = options().value<Uint>("part");
+  const Uint begin = node_distribution.start_idx_in_proc(rank);
+  const Uint end = node_distribution.end_idx_in_proc(rank);
+
+  // The nodes owned by this process
+  std::vector<Uint> tags;
+  std::vector<Real> coordinates;
+  tags.reserve(end-begin);
+  coordinates.reserve(3*(end-begin));
+  read_node_records(begin, end, tags, coordinates);
+  std::vector<Uint> ranks(tags.size(), part);
+
+  // The nodes used by the elements of this process and owned by another process
+  std::vector<Uint> owned_tags(tags);
+  std::sort(owned_tags.begin(), owned_tags.end());
+  std::vector<Uint> used_tags(m_elem_nodes);
+  std::sort(used_tags.begin(), used_tags.end());
+  used_tags.erase(std::unique(used_tags.begin(), used_tags.end()), used_tags.end());
+  std::vector<Uint> ghost_tags;
+  std::set_difference(used_tags.begin(), used_tags.end(), owned_tags.begin(), owned_tags.end(), std::back_inserter(ghost_tags));
+  std::vector<Uint>().swap(used_tags);
+  std::vector<Uint>().swap(owned_tags);
+
+  if (is_parallel())
   {
-//    if (m_total_nb_nodes > 100000)
-//    {
-//      if(node_idx%(m_total_nb_nodes/20)==0)
-//        CFinfo << 100*node_idx/m_total_nb_nodes << "% " << CFflush;
-//      if(node_idx==m_total_nb_nodes-1)
-//        CFinfo << CFendl;
-//    }
-    getline(m_file,line);
-//    CFinfo << line << CFendl;
-    if (m_hash->subhash(NODES).owns(node_idx))
+    // gmsh numbers the nodes consecutively from 1 by default, so the owner of a node follows from its tag
+    int consecutive = 1;
+    for (Uint i = 0; i != tags.size(); ++i)
     {
-      std::stringstream ss(line);
-      ss >> gmsh_node_number;
-      m_node_idx_gmsh_to_cf[gmsh_node_number]=coord_idx;
-
-//      if (PE::Comm::instance().rank()==IO_rank)
-//        std::cout << gmsh_node_number << " --> " << coord_idx << std::endl;
+      if (tags[i] != begin+i+1)
+      {
+        consecutive = 0;
+        break;
+      }
+    }
+    int all_consecutive;
+    PE::Comm::instance().all_reduce(PE::min(), &consecutive, 1, &all_consecutive);
 
-      for (Uint dim=0; dim<m_mesh_dimension; ++dim)
-        ss >> nodes.coordinates()[coord_idx][dim];
-      if(m_mesh_dimension < DIM_3D) getline(ss,line); //Gmsh always stores 3 coordinates, even for 2D meshes
+    const Uint nb_procs = PE::Comm::instance().size();
+    if (all_consecutive)
+    {
+      std::vector< std::vector<Uint> > requests(nb_procs);
+      BOOST_FOREACH(const Uint tag, ghost_tags)
+      {
+        if (tag == 0 || tag > m_total_nb_nodes)
+          throw ParsingFailed(FromHere(), "An element refers to node " + to_str(tag) + ", which is not in the $Nodes section of " + m_file_basename);
+        requests[node_distribution.proc_of_obj(tag-1)].push_back(tag);
+      }
+      std::vector< std::vector<Uint> > received_requests;
+      PE::Comm::instance().all_to_all(requests, received_requests);
 
-      nodes.rank()[coord_idx] = part;
-      nodes.glb_idx()[coord_idx] = gmsh_node_number-1;
+      std::vector< std::vector<Real> > answers(nb_procs);
+      for (Uint p = 0; p != nb_procs; ++p)
+      {
+        answers[p].reserve(3*received_requests[p].size());
+        BOOST_FOREACH(const Uint tag, received_requests[p])
+        {
+          const Uint idx = tag-1-begin;
+          answers[p].insert(answers[p].end(), coordinates.begin()+3*idx, coordinates.begin()+3*idx+3);
+        }
+      }
+      std::vector< std::vector<Real> > received_answers;
+      PE::Comm::instance().all_to_all(answers, received_answers);
 
-      coord_idx++;
+      for (Uint p = 0; p != nb_procs; ++p)
+      {
+        for (Uint i = 0; i != requests[p].size(); ++i)
+        {
+          tags.push_back(requests[p][i]);
+          ranks.push_back(node_distribution.part_of_obj(requests[p][i]-1));
+          coordinates.insert(coordinates.end(), received_answers[p].begin()+3*i, received_answers[p].begin()+3*i+3);
+        }
+      }
     }
     else
     {
-      it = m_ghost_nodes.find(node_idx);
-      if (it != m_ghost_nodes.end())
+      CFwarn << "The nodes in " << m_file_basename << " are not numbered consecutively, each process reads all nodes" << CFendl;
+      std::vector<Uint> other_tags;
+      std::vector<Real> other_coordinates;
+      read_node_records(0, begin, other_tags, other_coordinates);
+      const Uint nb_before = other_tags.size();
+      read_node_records(end, m_total_nb_nodes, other_tags, other_coordinates);
+      for (Uint i = 0; i != other_tags.size(); ++i)
       {
-        std::stringstream ss(line);
-        ss >> gmsh_node_number;
-        m_node_idx_gmsh_to_cf[gmsh_node_number]=coord_idx;
-
-//        if (PE::Comm::instance().rank()==IO_rank)
-//          std::cout << gmsh_node_number << " --> " << coord_idx << std::endl;
-
-        for (Uint dim=0; dim<m_mesh_dimension; ++dim)
-        ss >> nodes.coordinates()[coord_idx][dim];
-        if(m_mesh_dimension < DIM_3D) getline(ss, line);
-
-        nodes.rank()[coord_idx] = m_hash->subhash(NODES).part_of_obj(node_idx);
-        nodes.glb_idx()[coord_idx] = gmsh_node_number-1;
-
-        coord_idx++;
+        if (std::binary_search(ghost_tags.begin(), ghost_tags.end(), other_tags[i]))
+        {
+          tags.push_back(other_tags[i]);
+          ranks.push_back(node_distribution.part_of_obj(i < nb_before ? i : end+i-nb_before));
+          coordinates.insert(coordinates.end(), other_coordinates.begin()+3*i, other_coordinates.begin()+3*i+3);
+        }
       }
     }
+  }
 
+  // Local nodes are numbered in the order of their tags
+  std::vector< std::pair<Uint,Uint> > order(tags.size());
+  for (Uint i = 0; i != tags.size(); ++i)
+    order[i] = std::make_pair(tags[i], i);
+  std::sort(order.begin(), order.end());
 
-  } //loop over nodes
-
-
-
-  /*
-  CFinfo << "Printing all nodal coordinates:" << CFendl;
-  for(Uint i = 0; i < m_total_nb_nodes; ++i)
+  Dictionary& nodes = m_mesh->geometry_fields();
+  nodes.resize(order.size());
+  m_node_tags.resize(order.size());
+  for (Uint n = 0; n != order.size(); ++n)
   {
-      CFinfo << "\t";
-      for(Uint dim = 0; dim < m_mesh_dimension; ++dim)
-        {
-            CFinfo << nodes.coordinates()[i][dim] << " ";
-        }
-      CFinfo << CFendl;
+    const Uint i = order[n].second;
+    if (n != 0 && order[n].first == order[n-1].first)
+      throw ParsingFailed(FromHere(), "Node " + to_str(order[n].first) + " is defined twice in " + m_file_basename);
+    m_node_tags[n] = order[n].first;
+    for (Uint dim=0; dim<m_mesh_dimension; ++dim)
+      nodes.coordinates()[n][dim] = coordinates[3*i+dim];
+    nodes.rank()[n] = ranks[i];
+    nodes.glb_idx()[n] = order[n].first-1;
   }
-  */
+}
+
+//////////////////////////////////////////////////////////////////////////////
 
-  getline(m_file,line);
+Uint Reader::local_node(const Uint tag) const
+{
+  std::vector<Uint>::const_iterator it = std::lower_bound(m_node_tags.begin(), m_node_tags.end(), tag);
+  if (it == m_node_tags.end() || *it != tag)
+    throw ParsingFailed(FromHere(), "An element refers to node " + to_str(tag) + ", which is not in the $Nodes section of " + m_file_basename);
+  return it - m_node_tags.begin();
 }
 
 //////////////////////////////////////////////////////////////////////////////
 
 void Reader::read_connectivity()
 {
-
   Dictionary& nodes = m_mesh->geometry_fields();
+  const Uint part = options().value<Uint>("part");
 
-
-  Uint part = options().value<Uint>("part");
-
-  //Each entry of this vector holds a map (gmsh_type_idx, pointer to connectivity table of this gmsh type).
- //Each row corresponds to one region of the mesh
- std::vector<std::map<Uint, Entities* > > conn_table_idx;
- conn_table_idx.resize(m_nb_regions);
- for(Uint ir = 0; ir < m_nb_regions; ++ir)
- {
-    conn_table_idx[ir].clear();
- }
-
- std::map<Uint, Entities*>::iterator elem_table_iter;
-
-// std::vector<std::map<std::string,Handle< Elements > > > elements(m_nb_regions);
-// std::vector<std::map<std::string,Handle< Connectivity::Buffer > > > buffer(m_nb_regions);
-
-
- m_elem_idx_gmsh_to_cf.clear();
- //Loop over all regions and allocate a connectivity table of proper size for each element type that
- //is present in each region. Counting of elements was done during the first pass in the function
- //get_file_positions
- for(Uint ir = 0; ir < m_nb_regions; ++ir)
- {
-   // create new region
-   Handle< Region > region = m_region_list[ir].region;
-
-//   elements[ir] = create_cells_in_region(*region,m_mesh->geometry_fields(),m_supported_types);
-//   buffer[ir] = create_connectivity_buffermap(elements[ir]);
-
-
-   // Take the gmsh element types present in this region and generate new names of elements which correspond
-   // to coolfuid naming:
-   for(Uint etype = 0; etype < Shared::nb_gmsh_types; ++etype)
-   {
-     if(m_region_list[ir].element_types.find(etype) !=  m_region_list[ir].element_types.end())
-     {
-       const std::string cf_elem_name = Shared::gmsh_name_to_cf_name(m_mesh_dimension,etype);
-
-       boost::shared_ptr< ElementType > allocated_type = build_component_abstract_type<ElementType>(cf_elem_name,"tmp");
-       boost::shared_ptr< Entities > elements;
-       if (allocated_type->dimensionality() == allocated_type->dimension()-1)
-         elements = build_component_abstract_type<Entities>("cf3.mesh.Faces","elements_"+allocated_type->derived_type_name());
-       else if(allocated_type->dimensionality() == allocated_type->dimension())
-         elements = build_component_abstract_type<Entities>("cf3.mesh.Cells","elements_"+allocated_type->derived_type_name());
-       else
-         elements = build_component_abstract_type<Entities>("cf3.mesh.Elements","elements_"+allocated_type->derived_type_name());
-      region->add_component(elements);
-      elements->initialize(cf_elem_name,nodes);
-
-       Connectivity& elem_table = Handle<Elements>(elements)->geometry_space().connectivity();
-       elem_table.set_row_size(Shared::m_nodes_in_gmsh_elem[etype]);
-       elem_table.resize((m_nb_gmsh_elem_in_region[ir])[etype]);
-       elements->rank().resize(m_nb_gmsh_elem_in_region[ir][etype]);
-       elements->glb_idx().resize(m_nb_gmsh_elem_in_region[ir][etype]);
-       conn_table_idx[ir].insert(std::pair<Uint,Entities*>(etype,elements.get()));
-     }
-   }
- }
-
-   std::string etype_CF;
-   std::set<Uint>::const_iterator it;
-   std::vector<Uint> cf_element;
-   Uint element_number, gmsh_element_type, nb_element_nodes;
-   Uint gmsh_node_number, nb_tags, phys_tag, other_tag;
-   Uint cf_node_number;
-   Uint cf_idx;
-
-   m_file.seekg(m_elements_position,std::ios::beg);
-   // skip next line
-   std::string line;
-   //Re-read the line that contains the keyword '$Elements':
-   getline(m_file,line);
-   //Parse the following line (containing the actual number of elements)
-   getline(m_file,line);
-
-   for(Uint ir = 0; ir < m_nb_regions; ++ir)
-     for(Uint etype = 0; etype < Shared::nb_gmsh_types; ++etype)
-      (m_nb_gmsh_elem_in_region[ir])[etype] = 0;
-
-  for (Uint i=0; i<m_total_nb_elements; ++i)
+  // Create the entities for each element type that is present in each region, on all processes
+  m_entities.clear();
+  std::vector<Uint> entities_idx(m_elem_type_present.size(), 0);
+  for(Uint ir = 0; ir < m_nb_regions; ++ir)
   {
-//    if (m_total_nb_elements > 100000)
-//    {
-//      if(i%(m_total_nb_elements/20)==0)
-//        CFinfo << 100*i/m_total_nb_elements << "% " << CFflush;
-//      if(i==m_total_nb_elements-1)
-//        CFinfo << CFendl;
-//    }
-
-    // element description
-    m_file >> element_number >> gmsh_element_type;
+    Handle< Region > region = m_region_list[ir].region;
 
-    nb_element_nodes = Shared::m_nodes_in_gmsh_elem[gmsh_element_type];
-
-    // get element nodes
-    if (m_hash->subhash(ELEMS).owns(i))
+    // Take the gmsh element types present in this region and generate new names of elements which correspond
+    // to coolfuid naming:
+    for(Uint etype = 0; etype < Shared::nb_gmsh_types; ++etype)
     {
-      m_file >> nb_tags;
-      m_file >> phys_tag;
-      for(Uint itag = 0; itag < (nb_tags-1); ++itag)
-          m_file >> other_tag;
-
-//      CFinfo << "Reading element " << element_number << " of type " << gmsh_element_type;
-//      CFinfo << " in region " << phys_tag << " with " << nb_element_nodes << " nodes " << CFendl;
-
-//      if (PE::Comm::instance().rank()==IO_rank)
-//        std::cout << element_number << "   -->   ";
-
-      cf_element.resize(nb_element_nodes);
-      for (Uint j=0; j<nb_element_nodes; ++j)
-      {
-        cf_idx = Shared::m_nodes_gmsh_to_cf[gmsh_element_type][j];
-        m_file >> gmsh_node_number;
-        cf_node_number = m_node_idx_gmsh_to_cf[gmsh_node_number];
-        cf_element[cf_idx] = cf_node_number;
-//        if (PE::Comm::instance().rank()==IO_rank)
-//          std::cout << "  " << gmsh_node_number << "("<<m_node_idx_gmsh_to_cf[gmsh_node_number]<<")";
-      }
-//      if (PE::Comm::instance().rank()==IO_rank)
-//        std::cout << std::endl;
+      if(!m_elem_type_present[ir*nb_gmsh_types + etype])
+        continue;
 
-      elem_table_iter = conn_table_idx[phys_tag-1].find(gmsh_element_type);
-      const Uint row_idx = (m_nb_gmsh_elem_in_region[phys_tag-1])[gmsh_element_type];
+      const std::string cf_elem_name = Shared::gmsh_name_to_cf_name(m_mesh_dimension,etype);
 
-      Handle< Elements > elements_region = Handle<Elements>(elem_table_iter->second->handle<Component>());
-      Connectivity::Row element_nodes = elements_region->geometry_space().connectivity()[row_idx];
+      boost::shared_ptr< ElementType > allocated_type = build_component_abstract_type<ElementType>(cf_elem_name,"tmp");
+      boost::shared_ptr< Entities > elements;
+      if (allocated_type->dimensionality() == allocated_type->dimension()-1)
+        elements = build_component_abstract_type<Entities>("cf3.mesh.Faces","elements_"+allocated_type->derived_type_name());
+      else if(allocated_type->dimensionality() == allocated_type->dimension())
+        elements = build_component_abstract_type<Entities>("cf3.mesh.Cells","elements_"+allocated_type->derived_type_name());
+      else
+        elements = build_component_abstract_type<Entities>("cf3.mesh.Elements","elements_"+allocated_type->derived_type_name());
+      region->add_component(elements);
+      elements->initialize(cf_elem_name,nodes);
 
-      m_elem_idx_gmsh_to_cf[element_number] = std::make_pair( elements_region , row_idx);
+      const Uint nb_elems = m_nb_elems_of_type[ir*nb_gmsh_types + etype];
+      Connectivity& elem_table = Handle<Elements>(elements->handle<Component>())->geometry_space().connectivity();
+      elem_table.set_row_size(Shared::m_nodes_in_gmsh_elem[etype]);
+      elem_table.resize(nb_elems);
+      elements->rank().resize(nb_elems);
+      elements->glb_idx().resize(nb_elems);
 
-      for(Uint node = 0; node < nb_element_nodes; ++node)
-      {
-         element_nodes[node] = cf_element[node];
-      }
+      entities_idx[ir*nb_gmsh_types + etype] = m_entities.size();
+      m_entities.push_back(Handle<Elements>(elements->handle<Component>()));
+    }
+  }
 
-      elements_region->rank()[row_idx] = part;
-      elements_region->glb_idx()[row_idx] = element_number-1;
+  // Fill them with the elements of this process
+  std::vector<Uint> nb_filled(m_elem_type_present.size(), 0);
+  m_elem_locations.resize(m_elem_tags.size());
+  for (Uint e = 0; e != m_elem_tags.size(); ++e)
+  {
+    const Uint type = m_elem_types[e];
+    const Uint key = m_elem_regions[e]*nb_gmsh_types + type;
+    Elements& elements = *m_entities[entities_idx[key]];
+    const Uint row_idx = nb_filled[key]++;
 
-      (m_nb_gmsh_elem_in_region[phys_tag-1])[gmsh_element_type]++;
+    Connectivity::Row element_nodes = elements.geometry_space().connectivity()[row_idx];
+    const Uint* gmsh_nodes = &m_elem_nodes[m_elem_node_starts[e]];
+    for (Uint n = 0; n != m_nodes_in_gmsh_elem[type]; ++n)
+      element_nodes[Shared::m_nodes_gmsh_to_cf[type][n]] = local_node(gmsh_nodes[n]);
 
-    }
+    elements.rank()[row_idx] = part;
+    elements.glb_idx()[row_idx] = m_elem_tags[e]-1;
 
-    // finish the line
-    getline(m_file,line);
+    m_elem_locations[e] = std::make_pair(m_elem_tags[e], std::make_pair(entities_idx[key], row_idx));
   }
-  getline(m_file,line);  // ENDOFSECTION
+  std::sort(m_elem_locations.begin(), m_elem_locations.end());
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -673,9 +1090,11 @@ void Reader::read_element_node_data()
 
   std::map<std::string,Reader::Field> gmsh_fields;
 
-  boost_foreach(Uint element_node_data_position, m_element_node_data_positions)
+  boost_foreach(const Section& section, m_sections)
   {
-    m_file.seekg(element_node_data_position,std::ios::beg);
+    if (section.name != "ElementNodeData")
+      continue;
+    m_file.seek(section.begin);
     read_variable_header(gmsh_fields);
   }
 
@@ -709,48 +1128,52 @@ void Reader::read_element_node_data()
         CFdebug << "Reading " << field.name() << "/" << field.var_name(var) <<"["<<static_cast<Uint>(field.var_length(var))<<"]" << CFendl;
         Uint var_begin = field.var_offset(var);
         Uint var_end = var_begin + static_cast<Uint>(field.var_length(var));
-        m_file.seekg(gmsh_field.file_data_positions[var]);
+        m_file.seek(gmsh_field.file_data_positions[var]);
 
-        std::string line;
         Uint gmsh_elem_idx;
         Uint gmsh_nb_elem_nodes;
-        Uint cf_idx;
-        Handle< Elements > elements;
-        Handle< Space > space;
         Uint d,n;
         std::vector<Real> data(gmsh_field.var_types[var]);
-        std::map<Uint, std::pair<Handle< Elements >,Uint> >::iterator it;
         for (Uint e=0; e<gmsh_field.nb_entries; ++e)
         {
-          m_file >> gmsh_elem_idx >> gmsh_nb_elem_nodes;
+          gmsh_elem_idx = m_binary ? m_file.read_binary<int>() : m_file.read_uint();
+          gmsh_nb_elem_nodes = m_binary ? m_file.read_binary<int>() : m_file.read_uint();
 
-          it = m_elem_idx_gmsh_to_cf.find(gmsh_elem_idx);
-          if (it != m_elem_idx_gmsh_to_cf.end())
+          std::vector< std::pair<Uint, std::pair<Uint,Uint> > >::const_iterator it =
+              std::lower_bound(m_elem_locations.begin(), m_elem_locations.end(), std::make_pair(gmsh_elem_idx, std::make_pair(0u,0u)));
+          if (it == m_elem_locations.end() || it->first != gmsh_elem_idx)
           {
-            boost::tie(elements,cf_idx) = it->second;
-            const Space& space = elements->space(dict);
+            // element of another process
+            if (m_binary)
+              m_file.skip_bytes(gmsh_nb_elem_nodes*data.size()*sizeof(Real));
+            else
+              m_file.skip_line();
+            continue;
+          }
 
-            cf3_assert(elements->element_type().nb_nodes() == gmsh_nb_elem_nodes);
+          const Elements& elements = *m_entities[it->second.first];
+          const Uint cf_idx = it->second.second;
+          const Space& space = elements.space(dict);
 
-            for (n=0; n<gmsh_nb_elem_nodes; ++n)
-            {
+          cf3_assert(elements.element_type().nb_nodes() == gmsh_nb_elem_nodes);
+
+          for (n=0; n<gmsh_nb_elem_nodes; ++n)
+          {
 
-              for (d=0; d<data.size(); ++d)
-                m_file >> data[d];
+            for (d=0; d<data.size(); ++d)
+              data[d] = m_binary ? m_file.read_binary<Real>() : m_file.read_real();
 
-              mesh::Field::Row field_data = field[space.connectivity()[cf_idx][n]] ;
+            mesh::Field::Row field_data = field[space.connectivity()[cf_idx][n]] ;
 
-              if (var_end-var_begin == TENSOR_2D)
-              {
-                data[2]=data[3];
-                data[3]=data[4];
-              }
-              d=0;
-              for(Uint v=var_begin; v<var_end; ++v)
-                field_data[v] = data[d++];
+            if (var_end-var_begin == TENSOR_2D)
+            {
+              data[2]=data[3];
+              data[3]=data[4];
             }
+            d=0;
+            for(Uint v=var_begin; v<var_end; ++v)
+              field_data[v] = data[d++];
           }
-          getline(m_file,line); // finish line
         }
       }
     }
@@ -781,9 +1204,11 @@ void Reader::read_element_data()
 
   std::map<std::string,Reader::Field> fields;
 
-  boost_foreach(Uint element_data_position, m_element_data_positions)
+  boost_foreach(const Section& section, m_sections)
   {
-    m_file.seekg(element_data_position,std::ios::beg);
+    if (section.name != "ElementData")
+      continue;
+    m_file.seek(section.begin);
     read_variable_header(fields);
   }
 
@@ -793,8 +1218,6 @@ void Reader::read_element_data()
 
     foreach_container((const std::string& name) (Reader::Field& gmsh_field) , fields)
     {
-      std::vector<std::string> var_types_str;
-
       mesh::Field& field = dict.create_field(gmsh_field.name,gmsh_field.description());
 
       for (Uint i=0; i<field.nb_vars(); ++i)
@@ -802,27 +1225,26 @@ void Reader::read_element_data()
         CFdebug << "Reading " << field.name() << "/" << field.var_name(i) <<"["<<static_cast<Uint>(field.var_length(i))<<"]" << CFendl;
         Uint var_begin = field.var_offset(i);
         Uint var_end = var_begin + static_cast<Uint>(field.var_length(i));
-        m_file.seekg(gmsh_field.file_data_positions[i]);
-
+        m_file.seek(gmsh_field.file_data_positions[i]);
 
         Uint gmsh_elem_idx;
-        Uint cf_idx;
-        Handle< Elements > elements;
         Uint d;
         std::vector<Real> data(gmsh_field.var_types[i]);
 
         for (Uint e=0; e<gmsh_field.nb_entries; ++e)
         {
-          m_file >> gmsh_elem_idx;
+          gmsh_elem_idx = m_binary ? m_file.read_binary<int>() : m_file.read_uint();
           for (d=0; d<data.size(); ++d)
-            m_file >> data[d];
+            data[d] = m_binary ? m_file.read_binary<Real>() : m_file.read_real();
 
-          std::map<Uint, std::pair<Handle< Elements >,Uint> >::iterator it = m_elem_idx_gmsh_to_cf.find(gmsh_elem_idx);
-          if (it != m_elem_idx_gmsh_to_cf.end())
+          std::vector< std::pair<Uint, std::pair<Uint,Uint> > >::const_iterator it =
+              std::lower_bound(m_elem_locations.begin(), m_elem_locations.end(), std::make_pair(gmsh_elem_idx, std::make_pair(0u,0u)));
+          if (it != m_elem_locations.end() && it->first == gmsh_elem_idx)
           {
-            boost::tie(elements,cf_idx) = it->second;
+            const Elements& elements = *m_entities[it->second.first];
+            const Uint cf_idx = it->second.second;
 
-            mesh::Field::Row field_data = field[field.space(*elements).connectivity()[cf_idx][0]] ;
+            mesh::Field::Row field_data = field[field.space(elements).connectivity()[cf_idx][0]] ;
 
             d=0;
             for(Uint v=var_begin; v<var_end; ++v)
@@ -858,9 +1280,11 @@ void Reader::read_node_data()
 
   std::map<std::string,Field> fields;
 
-  boost_foreach(Uint node_data_position, m_node_data_positions)
+  boost_foreach(const Section& section, m_sections)
   {
-    m_file.seekg(node_data_position,std::ios::beg);
+    if (section.name != "NodeData")
+      continue;
+    m_file.seek(section.begin);
     read_variable_header(fields);
   }
 
@@ -874,24 +1298,22 @@ void Reader::read_node_data()
       CFdebug << "Reading " << field.name() << "/" << field.var_name(i) <<"["<<static_cast<Uint>(field.var_length(i))<<"]" << CFendl;
       Uint var_begin = field.var_offset(i);
       Uint var_end = var_begin + static_cast<Uint>(field.var_length(i));
-      m_file.seekg(gmsh_field.file_data_positions[i]);
+      m_file.seek(gmsh_field.file_data_positions[i]);
 
       Uint gmsh_node_idx;
-      Uint cf_idx;
       Uint d;
       std::vector<Real> data(gmsh_field.var_types[i]);
 
       for (Uint e=0; e<gmsh_field.nb_entries; ++e)
       {
-        m_file >> gmsh_node_idx;
+        gmsh_node_idx = m_binary ? m_file.read_binary<int>() : m_file.read_uint();
         for (d=0; d<data.size(); ++d)
-          m_file >> data[d];
+          data[d] = m_binary ? m_file.read_binary<Real>() : m_file.read_real();
 
-        std::map<Uint, Uint>::iterator it = m_node_idx_gmsh_to_cf.find(gmsh_node_idx);
-        if (it != m_node_idx_gmsh_to_cf.end())
+        std::vector<Uint>::const_iterator it = std::lower_bound(m_node_tags.begin(), m_node_tags.end(), gmsh_node_idx);
+        if (it != m_node_tags.end() && *it == gmsh_node_idx)
         {
-          cf_idx = it->second;
-          mesh::Field::Row field_data = field[cf_idx];
+          mesh::Field::Row field_data = field[it - m_node_tags.begin()];
 
           if (var_end-var_begin == TENSOR_2D)
           {
@@ -911,64 +1333,45 @@ void Reader::read_node_data()
 
 void Reader::read_variable_header(std::map<std::string,Field>& fields)
 {
-  std::string line;
-  std::string dummy;
-
-  Uint nb_string_tags(0);
   std::string var_name("var");
   std::string field_name("field");
-  Uint nb_real_tags(0);
   Real field_time(0.);
-  Uint nb_integer_tags(0);
   Uint field_time_step(0);
   Uint var_type(0);
   Uint nb_entries(0);
 
-  //Re-read the line that contains the keyword '$Elements':
-  getline(m_file,line);
-
   // string tags
-  m_file >> nb_string_tags;
+  const Uint nb_string_tags = m_file.read_uint();
   if (nb_string_tags > 0)
   {
-    m_file >> var_name;
-    var_name = var_name.substr(1,var_name.length()-2);
-
+    var_name = m_file.read_quoted();
     field_name = var_name;
     if (nb_string_tags > 1)
-    {
-      m_file >> field_name;
-      field_name = field_name.substr(1,field_name.length()-2);
-    }
-    if (nb_string_tags > 2)
-    {
-      for (Uint i=1; i<nb_string_tags; ++i)
-        m_file >> dummy;
-    }
+      field_name = m_file.read_quoted();
+    for (Uint i=2; i<nb_string_tags; ++i)
+      m_file.read_quoted();
   }
 
   // real tags
-  m_file >> nb_real_tags;
+  const Uint nb_real_tags = m_file.read_uint();
   if (nb_real_tags > 0)
   {
     if (nb_real_tags != 1)
       throw ParsingFailed(FromHere(),"Data cannot have more than 1 real tag (time)");
 
-    m_file >> field_time;
+    field_time = m_file.read_real();
   }
 
-  // integer tags
-  m_file >> nb_integer_tags;
-  if (nb_integer_tags > 0)
-  {
-    if (nb_integer_tags >= 3)
-    {
-      m_file >> field_time_step >> var_type >> nb_entries;
-    }
-    if (nb_integer_tags < 3)
-      throw ParsingFailed(FromHere(),"Data must have 3 integer tags (time_step, variable_type, nb_entries)");
-  }
-  getline(m_file,line); // finish line
+  // integer tags, version 4 adds the partition as 4th tag
+  const Uint nb_integer_tags = m_file.read_uint();
+  if (nb_integer_tags < 3)
+    throw ParsingFailed(FromHere(),"Data must have 3 integer tags (time_step, variable_type, nb_entries)");
+  field_time_step = m_file.read_uint();
+  var_type = m_file.read_uint();
+  nb_entries = m_file.read_uint();
+  for (Uint i=3; i<nb_integer_tags; ++i)
+    m_file.read_int();
+  m_file.skip_line(); // finish line
 
   Field& field = fields[field_name];
   field.name=field_name;
@@ -977,9 +1380,9 @@ void Reader::read_variable_header(std::map<std::string,Field>& fields)
   field.time=field_time;
   field.time_step=field_time_step;
   field.nb_entries=nb_entries;
-  field.file_data_positions.push_back(m_file.tellg());
+  field.file_data_positions.push_back(m_file.position());
 
-  CFdebug << "    - found variable " << var_name << " from discontinuous field " << field_name << " at time " << field_time << CFendl;
+  CFdebug << "    - found variable " << var_name << " from field " << field_name << " at time " << field_time << CFendl;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -9,13 +9,14 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include <map>
 #include <set>
-#include <boost/tuple/tuple.hpp>
 
 #include "mesh/MeshReader.hpp"
 
 #include "mesh/gmsh/LibGmsh.hpp"
 #include "mesh/gmsh/Shared.hpp"
+#include "mesh/Tokenizer.hpp"
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -33,7 +34,9 @@ namespace gmsh {
 
 //////////////////////////////////////////////////////////////////////////////
 
-/// This class defines gmsh mesh format reader
+/// This class defines gmsh mesh format reader, for versions 2.2 and 4.1 of the ASCII and binary formats.
+/// Each process only parses the nodes and elements it owns. The nodes used by its elements but owned by
+/// other processes are sent by their owners when the nodes are numbered consecutively, as gmsh does by default.
 /// @author Willem Deconinck
 /// @author Martin Vymazal
 class gmsh_API Reader : public MeshReader, public Shared
@@ -51,11 +54,47 @@ public: // functions
 
 private: // functions
 
+  virtual void do_read_mesh_into(const common::URI& fp, Mesh& mesh);
+
+  /// Parse the $MeshFormat section
+  void read_format();
+
+  /// Locate all sections, and the blocks of nodes and elements
   void get_file_positions();
 
+  /// Locate the sections of an ASCII file. Every process scans its own slice of the file.
+  void get_ascii_file_positions();
+
+  /// Locate the sections of a binary file, jumping over the binary data
+  void get_binary_file_positions();
+
+  /// Byte offset of the given line in an ASCII file
+  std::size_t line_offset(const std::size_t line) const;
+
+  /// Index of the line containing the given byte offset in an ASCII file
+  std::size_t line_index(const std::size_t offset) const;
+
+  /// Find the blocks of the $Nodes section, and return the offset of its end
+  std::size_t read_node_blocks(const std::size_t section_begin);
+
+  /// Find the blocks of the $Elements section, and return the offset of its end
+  std::size_t read_element_blocks(const std::size_t section_begin);
+
+  /// Skip past the $End line of the section with the given name
+  void skip_section(const std::string& name);
+
+  void read_physical_names();
+
+  /// Link the entities of a version 4 file to their physical group
+  void read_entities();
+
   Handle<Region> create_region(std::string const& relative_path);
 
-  void find_used_nodes();
+  /// Read the nodes of the given range of records in the $Nodes section
+  void read_node_records(const Uint begin, const Uint end, std::vector<Uint>& tags, std::vector<Real>& coordinates);
+
+  /// Read the elements owned by this process
+  void read_element_records();
 
   void read_coordinates();
 
@@ -67,55 +106,90 @@ private: // functions
 
   void read_node_data();
 
-private: // data
+  /// Local index of the node with the given gmsh tag
+  Uint local_node(const Uint tag) const;
 
-  virtual void do_read_mesh_into(const common::URI& fp, Mesh& mesh);
+private: // data
 
   enum HashType { NODES=0, ELEMS=1 };
   Handle<MergedParallelDistribution> m_hash;
 
-  // map< gmsh index , pair< elements, index in elements > >
-  std::map<Uint, std::pair<Handle<Elements>,Uint> > m_elem_idx_gmsh_to_cf;
-  std::map<Uint, Uint> m_node_idx_gmsh_to_cf;
-
-  boost::filesystem::fstream m_file;
+  Tokenizer m_file;
   Handle<Mesh> m_mesh;
   Handle<Region> m_region;
 
   std::string m_file_basename;
 
+  /// File format version, 2 or 4
+  Uint m_major_version;
+  bool m_binary;
+
+  /// A $Name ... $EndName part of the file
+  struct Section
+  {
+    std::string name;
+    std::size_t begin; ///< offset of the line after the $Name line
+  };
+  std::vector<Section> m_sections;
+
+  /// Start offsets of the slices used to look up lines in ASCII files, and the number of lines before each slice
+  std::vector<std::size_t> m_slice_offsets;
+  std::vector<std::size_t> m_slice_lines;
+
+  /// A contiguous group of records in the $Nodes or $Elements section.
+  /// Offsets are in bytes for binary files, and in lines for ASCII files.
+  struct Block
+  {
+    std::size_t first;       ///< index of the first record in the section
+    std::size_t size;        ///< number of records
+    std::size_t offset;      ///< start of the records, or of the node tags in version 4
+    std::size_t data_offset; ///< start of the node coordinates in version 4
+    std::size_t type;        ///< gmsh element type, or 0 if each record has its own type
+    std::size_t nb_values;   ///< number of tags per element in binary version 2, number of reals per node in version 4
+    std::size_t entity_dim;  ///< dimension of the geometric entity in version 4
+    std::size_t entity_tag;  ///< tag of the geometric entity in version 4
+  };
+  std::vector<Block> m_node_blocks;
+  std::vector<Block> m_element_blocks;
+
+  /// Physical group of each geometric entity in version 4, indexed by (dimension, entity tag)
+  std::map<std::pair<Uint,int>, Uint> m_entity_physical_tag;
+
   struct RegionData
   {
     Uint dim;
     Uint index;
     std::string name;
     Handle<Region> region;
-    std::set<Uint> element_types;
   };
 
   Uint m_nb_regions; // This corresponds to the number of physical groups in
                      // gmsh terminology
   Uint m_mesh_dimension;
 
-
   std::vector<RegionData> m_region_list;
 
-  std::set<Uint> m_ghost_nodes;
-  //std::set<Uint> m_ghost_elems;
-  std::set<Uint> m_used_nodes;
-  
-  std::vector<std::set<Uint> > m_node_to_glb_elements;
+  /// Index in m_region_list of each physical tag
+  std::map<Uint,Uint> m_region_of_physical_tag;
 
-  //Markers for important places in the file to be read
-  Uint m_region_names_position;
-  Uint m_coordinates_position;
-  Uint m_elements_position;
-  std::vector<Uint> m_element_data_positions;
-  std::vector<Uint> m_node_data_positions;
-  std::vector<Uint> m_element_node_data_positions;
+  /// The elements owned by this process, as read from the file
+  std::vector<Uint> m_elem_tags;
+  std::vector<Uint> m_elem_types;
+  std::vector<Uint> m_elem_regions;
+  std::vector<std::size_t> m_elem_node_starts;
+  std::vector<Uint> m_elem_nodes;
 
+  /// Number of elements on this process for each (region, gmsh type), and whether any process has elements of that kind
+  std::vector<Uint> m_nb_elems_of_type;
+  std::vector<Uint> m_elem_type_present;
+
+  /// gmsh tags of the nodes on this process, sorted
+  std::vector<Uint> m_node_tags;
+
+  /// The entities created in the mesh, and the (gmsh tag, (entities, row)) of each element, sorted on the tag
+  std::vector< Handle<Elements> > m_entities;
+  std::vector< std::pair<Uint, std::pair<Uint,Uint> > > m_elem_locations;
 
-  std::vector<std::vector<Uint> > m_nb_gmsh_elem_in_region;
   Uint m_total_nb_elements;
   Uint m_total_nb_nodes;
 
@@ -127,7 +201,7 @@ private: // data
     Uint time_step;
     std::vector<Uint> var_types;
     Uint nb_entries;
-    std::vector<Uint> file_data_positions;
+    std::vector<std::size_t> file_data_positions;
     std::string description() const
     {
       std::stringstream ss;
@@ -159,8 +233,6 @@ private: // data
   void fix_negative_volumes(Mesh& mesh);
 
   void read_variable_header(std::map<std::string,Field>& fields);
-
-  Uint IO_rank;
 }; // end Reader
 
 ////////////////////////////////////////////////////////////////////////////////
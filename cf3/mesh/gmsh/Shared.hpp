@@ -61,6 +61,10 @@ protected:
                      P0POINT=15, P3TRIAG=21, P3LINE=26, P3QUAD = 36 };
   
   std::map<GeoShape::Type,Uint> m_CFelement_to_GmshElement;
+
+  /// gmsh element type for each element type builder name
+  std::map<std::string,Uint> m_elementTypes;
+
   std::vector<std::string> m_supported_types;
 
   /// Faces are not defined in gmsh format
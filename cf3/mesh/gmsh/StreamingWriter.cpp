@@ -0,0 +1,166 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <limits>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/StringConversion.hpp"
+
+#include "mesh/gmsh/StreamingWriter.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3::common;
+
+namespace cf3 {
+namespace mesh {
+namespace gmsh {
+
+////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < gmsh::StreamingWriter, StreamingMeshWriter, LibGmsh> aGmshStreamingWriter_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+StreamingWriter::StreamingWriter( const std::string& name ) :
+  StreamingMeshWriter(name),
+  m_dimension(0),
+  m_nb_nodes(0),
+  m_nb_elements(0),
+  m_nb_regions(0),
+  m_nodes_written(0),
+  m_elements_written(0)
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> StreamingWriter::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".msh");
+  extensions.push_back(".gmsh");
+  return extensions;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void StreamingWriter::open(const URI& path, const Uint dimension, const Uint nb_nodes, const Uint nb_elements,
+                           const std::vector<std::string>& region_names, const std::vector<Uint>& region_dimensions)
+{
+  cf3_assert(region_names.size() == region_dimensions.size());
+
+  m_file.open(path.path().c_str(), std::ios_base::out | std::ios_base::trunc);
+  if (!m_file.is_open())
+    throw FileSystemError(FromHere(), "Could not open file " + path.path());
+
+  m_path = path;
+  m_dimension = dimension;
+  m_nb_nodes = nb_nodes;
+  m_nb_elements = nb_elements;
+  m_nb_regions = region_names.size();
+  m_nodes_written = 0;
+  m_elements_written = 0;
+
+  // Coordinates are written without loss, so a converted mesh is identical to the original
+  m_file.precision(std::numeric_limits<Real>::digits10 + 2);
+
+  m_file << "$MeshFormat\n";
+  m_file << "2.2 0 " << sizeof(Real) << "\n";
+  m_file << "$EndMeshFormat\n";
+
+  m_file << "$PhysicalNames\n";
+  m_file << m_nb_regions << "\n";
+  for (Uint r=0; r<m_nb_regions; ++r)
+    m_file << region_dimensions[r] << " " << r+1 << " \"" << region_names[r] << "\"\n";
+  m_file << "$EndPhysicalNames\n";
+
+  m_file << "$Nodes\n";
+  m_file << m_nb_nodes << "\n";
+
+  // Without nodes, the elements section starts right away
+  if (m_nb_nodes == 0)
+    write_nodes(0, std::vector<Real>());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void StreamingWriter::write_nodes(const Uint first, const std::vector<Real>& coordinates)
+{
+  cf3_assert(coordinates.size() % m_dimension == 0);
+  if (first != m_nodes_written)
+    throw BadValue(FromHere(), "Nodes must be written in order: expected node " + to_str(m_nodes_written) + " but got " + to_str(first));
+
+  const Uint nb_nodes = coordinates.size() / m_dimension;
+  for (Uint n=0; n<nb_nodes; ++n)
+  {
+    m_file << first+n+1;
+    for (Uint d=0; d<3; ++d)
+    {
+      if (d<m_dimension)
+        m_file << " " << coordinates[n*m_dimension+d];
+      else
+        m_file << " " << 0;
+    }
+    m_file << "\n";
+  }
+  m_nodes_written += nb_nodes;
+
+  if (m_nodes_written == m_nb_nodes)
+  {
+    m_file << "$EndNodes\n";
+    m_file << "$Elements\n";
+    m_file << m_nb_elements << "\n";
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void StreamingWriter::write_elements(const Uint region, const std::string& element_type, const std::vector<Uint>& connectivity)
+{
+  if (m_nodes_written != m_nb_nodes)
+    throw BadValue(FromHere(), "All " + to_str(m_nb_nodes) + " nodes must be written before the elements, only " + to_str(m_nodes_written) + " were written");
+  cf3_assert(region < m_nb_regions);
+
+  std::map<std::string,Uint>::const_iterator gmsh_type = m_elementTypes.find(element_type);
+  if (gmsh_type == m_elementTypes.end())
+    throw NotSupported(FromHere(), "Element type " + element_type + " can not be written in gmsh format");
+
+  const Uint nb_element_nodes = m_nodes_in_gmsh_elem[gmsh_type->second];
+  cf3_assert(connectivity.size() % nb_element_nodes == 0);
+  const Uint nb_elements = connectivity.size() / nb_element_nodes;
+
+  // tags: physical group, elementary entity, partition
+  for (Uint e=0; e<nb_elements; ++e)
+  {
+    m_file << ++m_elements_written << " " << gmsh_type->second << " 3 " << region+1 << " " << region+1 << " 0";
+    for (Uint n=0; n<nb_element_nodes; ++n)
+      m_file << " " << connectivity[e*nb_element_nodes+n]+1;
+    m_file << "\n";
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void StreamingWriter::close()
+{
+  if (m_nodes_written != m_nb_nodes)
+    throw BadValue(FromHere(), m_path.path() + ": " + to_str(m_nodes_written) + " nodes were written instead of " + to_str(m_nb_nodes));
+  if (m_elements_written != m_nb_elements)
+    throw BadValue(FromHere(), m_path.path() + ": " + to_str(m_elements_written) + " elements were written instead of " + to_str(m_nb_elements));
+
+  m_file << "$EndElements\n";
+  m_file.close();
+  if (m_file.fail())
+    throw FileSystemError(FromHere(), "Could not write file " + m_path.path());
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // gmsh
+} // mesh
+} // cf3
@@ -0,0 +1,76 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_Gmsh_StreamingWriter_hpp
+#define cf3_mesh_Gmsh_StreamingWriter_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <fstream>
+
+#include "mesh/StreamingMeshWriter.hpp"
+
+#include "mesh/gmsh/LibGmsh.hpp"
+#include "mesh/gmsh/Shared.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace gmsh {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Writes a gmsh 2.2 ASCII file chunk by chunk. Each region becomes a physical group.
+/// Nodes and elements are numbered from 1 in the order they are passed in.
+class gmsh_API StreamingWriter : public StreamingMeshWriter, public gmsh::Shared
+{
+
+public: // functions
+
+  /// constructor
+  StreamingWriter( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "StreamingWriter"; }
+
+  virtual std::string get_format() { return "Gmsh"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+  virtual void open(const common::URI& path, const Uint dimension, const Uint nb_nodes, const Uint nb_elements,
+                    const std::vector<std::string>& region_names, const std::vector<Uint>& region_dimensions);
+
+  virtual void write_nodes(const Uint first, const std::vector<Real>& coordinates);
+
+  virtual void write_elements(const Uint region, const std::string& element_type, const std::vector<Uint>& connectivity);
+
+  virtual void close();
+
+private: // data
+
+  std::ofstream m_file;
+  common::URI m_path;
+
+  Uint m_dimension;
+  Uint m_nb_nodes;
+  Uint m_nb_elements;
+  Uint m_nb_regions;
+
+  /// Number of nodes and elements written so far
+  Uint m_nodes_written;
+  Uint m_elements_written;
+}; // end StreamingWriter
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // gmsh
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_Gmsh_StreamingWriter_hpp
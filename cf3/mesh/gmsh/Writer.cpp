@@ -53,39 +53,6 @@ Writer::Writer( const std::string& name )
       .pretty_name("Serial Format")
       .description("All processors write in 1 file")
       .mark_basic();
-
-  // gmsh types: http://www.geuz.org/gmsh/doc/texinfo/gmsh.html#MSH-ASCII-file-format
-
-  m_elementTypes["cf3.mesh.LagrangeP0.Point1D"]=P0POINT;
-  m_elementTypes["cf3.mesh.LagrangeP0.Point2D"]=P0POINT;
-  m_elementTypes["cf3.mesh.LagrangeP0.Point3D"]=P0POINT;
-
-  m_elementTypes["cf3.mesh.LagrangeP1.Line1D" ]=P1LINE;
-  m_elementTypes["cf3.mesh.LagrangeP1.Line2D" ]=P1LINE;
-  m_elementTypes["cf3.mesh.LagrangeP1.Line3D" ]=P1LINE;
-  m_elementTypes["cf3.mesh.LagrangeP1.Triag2D"]=P1TRIAG;
-  m_elementTypes["cf3.mesh.LagrangeP1.Triag3D"]=P1TRIAG;
-  m_elementTypes["cf3.mesh.LagrangeP1.Quad2D" ]=P1QUAD;
-  m_elementTypes["cf3.mesh.LagrangeP1.Quad3D" ]=P1QUAD;
-  m_elementTypes["cf3.mesh.LagrangeP1.Tetra3D"]=P1TETRA;
-  m_elementTypes["cf3.mesh.LagrangeP1.Hexa3D" ]=P1HEXA;
-
-  m_elementTypes["cf3.mesh.LagrangeP2.Line1D" ]=P2LINE;
-  m_elementTypes["cf3.mesh.LagrangeP2.Line2D" ]=P2LINE;
-  m_elementTypes["cf3.mesh.LagrangeP2.Line3D" ]=P2LINE;
-  m_elementTypes["cf3.mesh.LagrangeP2.Triag2D"]=P2TRIAG;
-  m_elementTypes["cf3.mesh.LagrangeP2.Triag3D"]=P2TRIAG;
-  m_elementTypes["cf3.mesh.LagrangeP2.Quad2D" ]=P2QUAD;
-  m_elementTypes["cf3.mesh.LagrangeP2.Quad3D" ]=P2QUAD;
-
-  m_elementTypes["cf3.mesh.LagrangeP3.Line1D" ]=P3LINE;
-  m_elementTypes["cf3.mesh.LagrangeP3.Line2D" ]=P3LINE;
-  m_elementTypes["cf3.mesh.LagrangeP3.Line3D" ]=P3LINE;
-  m_elementTypes["cf3.mesh.LagrangeP3.Triag2D"]=P3TRIAG;
-  m_elementTypes["cf3.mesh.LagrangeP3.Triag3D"]=P3TRIAG;
-  m_elementTypes["cf3.mesh.LagrangeP3.Quad2D" ]=P3QUAD;
-  m_elementTypes["cf3.mesh.LagrangeP3.Quad3D" ]=P3QUAD;
-
 }
 
 /////////////////////////////////////////////////////////////////////////////
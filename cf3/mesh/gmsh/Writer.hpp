@@ -62,8 +62,6 @@ private: // data
 
   std::map<std::string,Uint> m_groupnumber;
 
-  std::map<std::string,Uint> m_elementTypes;
-
   std::vector< Handle<Entities const> > m_entities_vector;
 }; // end Writer
 
@@ -38,6 +38,9 @@ public:
 protected:
 
   enum neuElement {LINE=1,QUAD=2,TRIAG=3,HEXA=4,TETRA=6};
+
+  /// Builder name of the element type for a neu element type with the given number of nodes
+  static std::string element_type_name(const Uint neu_type, const Uint nb_nodes, const Uint dimension);
   
   std::map<GeoShape::Type,Uint> m_CFelement_to_neuElement;
   std::vector<std::string> m_supported_types;    
@@ -0,0 +1,415 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+#include <sstream>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Builder.hpp"
+#include "common/Foreach.hpp"
+#include "common/Log.hpp"
+#include "common/PropertyList.hpp"
+#include "common/StringConversion.hpp"
+
+#include "mesh/ElementType.hpp"
+#include "mesh/StreamingMeshWriter.hpp"
+
+#include "mesh/neu/StreamingReader.hpp"
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+namespace neu {
+
+  using namespace common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+cf3::common::ComponentBuilder < neu::StreamingReader, StreamingMeshReader, LibNeu > aneuStreamingReader_Builder;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+/// Entry of a boundary condition set
+struct BoundaryEntry
+{
+  Uint element;
+  Uint face;
+
+  bool operator<(const BoundaryEntry& other) const { return element < other.element; }
+};
+
+/// Marks the element group that is made up when the file has none: it holds all elements, in order
+const std::size_t all_elements = std::size_t(-1);
+
+/// Number of elements between two offsets recorded by the sweep over the ELEMENTS/CELLS section
+const Uint element_block_size = 1024;
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+StreamingReader::StreamingReader( const std::string& name )
+: StreamingMeshReader(name),
+  Shared(),
+  m_nodal_coordinates_position(0),
+  m_elements_cells_position(0),
+  m_element_position(0),
+  m_next_element(1)
+{
+  properties()["brief"] = std::string("neutral file streaming conversion component");
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+std::vector<std::string> StreamingReader::get_extensions()
+{
+  std::vector<std::string> extensions;
+  extensions.push_back(".neu");
+  return extensions;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::do_convert(const URI& input, const URI& output, StreamingMeshWriter& writer)
+{
+  m_file.open(input.path());
+
+  read_header();
+  find_sections();
+
+  std::vector<std::string> region_names;
+  std::vector<Uint> region_dimensions;
+  Uint nb_elements = 0;
+  boost_foreach(const RegionData& group, m_groups)
+  {
+    region_names.push_back(group.name);
+    region_dimensions.push_back(m_headerData.NDFCD);
+    nb_elements += group.nb_entries;
+  }
+  boost_foreach(const RegionData& boundary, m_boundaries)
+  {
+    region_names.push_back(boundary.name);
+    region_dimensions.push_back(m_headerData.NDFCD-1);
+    nb_elements += boundary.nb_entries;
+  }
+
+  writer.open(output, m_headerData.NDFCD, m_headerData.NUMNP, nb_elements, region_names, region_dimensions);
+
+  convert_nodes(writer);
+  rewind_elements();
+  convert_groups(writer);
+  convert_boundaries(writer);
+
+  writer.close();
+  m_file.close();
+  m_buffers.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::read_header()
+{
+  m_file.seek(0);
+
+  // skip 2 lines
+  m_file.skip_lines(2);
+
+  m_headerData.mesh_name = m_file.read_word();
+  m_file.skip_line();
+
+  // skip 3 lines
+  m_file.skip_lines(3);
+
+  // read number of points, elements, groups, sets, dimensions, velocitycomponents
+  m_headerData.NUMNP  = m_file.read_uint();
+  m_headerData.NELEM  = m_file.read_uint();
+  m_headerData.NGRPS  = m_file.read_uint();
+  m_headerData.NBSETS = m_file.read_uint();
+  m_headerData.NDFCD  = m_file.read_uint();
+  m_headerData.NDFVL  = m_file.read_uint();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::find_sections()
+{
+  const std::string nodal_coordinates("NODAL COORDINATES");
+  const std::string elements_cells("ELEMENTS/CELLS");
+  const std::string element_group("ELEMENT GROUP");
+  const std::string boundary_condition("BOUNDARY CONDITIONS");
+
+  m_nodal_coordinates_position = m_file.find(nodal_coordinates, 0);
+  if (m_nodal_coordinates_position == m_file.size())
+    throw ParsingFailed(FromHere(), "No " + nodal_coordinates + " section found");
+  m_elements_cells_position = m_file.find(elements_cells, 0);
+  if (m_elements_cells_position == m_file.size())
+    throw ParsingFailed(FromHere(), "No " + elements_cells + " section found");
+
+  m_groups.clear();
+  for (std::size_t p = m_file.find(element_group, 0); p != m_file.size(); p = m_file.find(element_group, p+1))
+  {
+    m_file.seek(m_file.find_line(p, 1));
+
+    RegionData group;
+    m_file.read_word();  // GROUP:
+    m_file.read_uint();  // NGP
+    m_file.read_word();  // ELEMENTS:
+    group.nb_entries = m_file.read_uint();
+    m_file.read_word();  // MATERIAL:
+    m_file.read_uint();  // MTYP
+    m_file.read_word();  // NFLAGS:
+    const Uint NFLAGS = m_file.read_uint();
+    group.name = m_file.read_word();
+    for (Uint i=0; i<NFLAGS; ++i)
+      m_file.read_int();
+    group.entries_position = m_file.position();
+    m_groups.push_back(group);
+  }
+  if (m_groups.size() != m_headerData.NGRPS)
+    throw ParsingFailed(FromHere(), "Found " + to_str(m_groups.size()) + " element groups instead of " + to_str(m_headerData.NGRPS));
+
+  // Without element groups, all elements go in a single region
+  if (m_groups.empty())
+  {
+    RegionData group;
+    group.name = "main";
+    group.nb_entries = m_headerData.NELEM;
+    group.entries_position = all_elements;
+    m_groups.push_back(group);
+  }
+
+  m_boundaries.clear();
+  for (std::size_t p = m_file.find(boundary_condition, 0); p != m_file.size(); p = m_file.find(boundary_condition, p+1))
+  {
+    m_file.seek(m_file.find_line(p, 1));
+
+    RegionData boundary;
+    int ITYPE, NENTRY, NVALUES, IBCODE1;
+    std::stringstream ss(m_file.read_line());
+    ss >> boundary.name >> ITYPE >> NENTRY >> NVALUES >> IBCODE1;
+    if (ITYPE!=1) {
+      throw common::NotSupported(FromHere(),"error: supports only boundary condition data 1 (element/cell): page C-11 of user's guide");
+    }
+    if (IBCODE1!=6) {
+      throw common::NotSupported(FromHere(),"error: supports only IBCODE1 6 (ELEMENT_SIDE)");
+    }
+    boundary.nb_entries = NENTRY;
+    boundary.entries_position = m_file.position();
+    m_boundaries.push_back(boundary);
+  }
+  if (m_boundaries.size() != m_headerData.NBSETS)
+    throw ParsingFailed(FromHere(), "Found " + to_str(m_boundaries.size()) + " boundary condition sets instead of " + to_str(m_headerData.NBSETS));
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::convert_nodes(StreamingMeshWriter& writer)
+{
+  CFinfo << "Converting " << m_headerData.NUMNP << " nodes" << CFendl;
+
+  m_file.seek(m_file.find_line(m_nodal_coordinates_position, 1));
+
+  const Uint dim = m_headerData.NDFCD;
+  std::vector<Real> coordinates;
+  for (Uint first=0; first<m_headerData.NUMNP; first+=chunk_size())
+  {
+    const Uint nb_nodes = std::min(chunk_size(), m_headerData.NUMNP-first);
+    coordinates.resize(nb_nodes*dim);
+    for (Uint n=0; n<nb_nodes; ++n)
+    {
+      const Uint node_number = m_file.read_uint();
+      if (node_number != first+n+1)
+        throw ParsingFailed(FromHere(), "Expected node " + to_str(first+n+1) + " but found node " + to_str(node_number));
+      for (Uint d=0; d<dim; ++d)
+        coordinates[n*dim+d] = m_file.read_real();
+      m_file.skip_line();
+    }
+    writer.write_nodes(first, coordinates);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::convert_groups(StreamingMeshWriter& writer)
+{
+  std::vector<Uint> elements;
+  std::vector<Uint> cf_nodes;
+  Uint neu_type;
+
+  for (Uint g=0; g<m_groups.size(); ++g)
+  {
+    const RegionData& group = m_groups[g];
+    CFinfo << "Converting " << group.nb_entries << " elements of group " << group.name << CFendl;
+
+    std::size_t position = group.entries_position;
+    for (Uint first=0; first<group.nb_entries; first+=chunk_size())
+    {
+      const Uint nb_elements = std::min(chunk_size(), group.nb_entries-first);
+      elements.resize(nb_elements);
+      if (position == all_elements)
+      {
+        for (Uint i=0; i<nb_elements; ++i)
+          elements[i] = first+i+1;
+      }
+      else
+      {
+        m_file.seek(position);
+        for (Uint i=0; i<nb_elements; ++i)
+          elements[i] = m_file.read_uint();
+        position = m_file.position();
+      }
+
+      // One sweep over the elements section picks up the whole chunk
+      std::sort(elements.begin(), elements.end());
+      boost_foreach(const Uint element, elements)
+      {
+        read_element(element, neu_type, cf_nodes);
+        std::vector<Uint>& buffer = m_buffers[element_type_name(neu_type, cf_nodes.size(), m_headerData.NDFCD)];
+        buffer.insert(buffer.end(), cf_nodes.begin(), cf_nodes.end());
+      }
+      flush(writer, g);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::convert_boundaries(StreamingMeshWriter& writer)
+{
+  std::vector<BoundaryEntry> entries;
+  std::vector<Uint> cf_nodes;
+  Uint neu_type;
+
+  for (Uint t=0; t<m_boundaries.size(); ++t)
+  {
+    const RegionData& boundary = m_boundaries[t];
+    CFinfo << "Converting " << boundary.nb_entries << " faces of boundary " << boundary.name << CFendl;
+
+    std::size_t position = boundary.entries_position;
+    for (Uint first=0; first<boundary.nb_entries; first+=chunk_size())
+    {
+      const Uint nb_entries = std::min(chunk_size(), boundary.nb_entries-first);
+      entries.resize(nb_entries);
+      m_file.seek(position);
+      for (Uint i=0; i<nb_entries; ++i)
+      {
+        entries[i].element = m_file.read_uint();
+        m_file.read_uint();  // ETYPE, taken from the element itself
+        entries[i].face = m_file.read_uint();
+        m_file.skip_line();
+      }
+      position = m_file.position();
+
+      std::sort(entries.begin(), entries.end());
+      boost_foreach(const BoundaryEntry& entry, entries)
+      {
+        read_element(entry.element, neu_type, cf_nodes);
+        const ElementType& etype = element_type(element_type_name(neu_type, cf_nodes.size(), m_headerData.NDFCD));
+        if (entry.face >= m_faces_neu_to_cf[neu_type].size())
+          throw ParsingFailed(FromHere(), "Element " + to_str(entry.element) + " has no face " + to_str(entry.face));
+        const Uint face = m_faces_neu_to_cf[neu_type][entry.face];
+
+        std::vector<Uint>& buffer = m_buffers[etype.face_type(face).derived_type_name()];
+        boost_foreach(const Uint node, etype.faces().nodes_range(face))
+          buffer.push_back(cf_nodes[node]);
+      }
+      flush(writer, m_groups.size()+t);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::read_element(const Uint element, Uint& neu_type, std::vector<Uint>& cf_nodes)
+{
+  if (element == 0 || element > m_headerData.NELEM)
+    throw ParsingFailed(FromHere(), "Element " + to_str(element) + " does not exist, there are " + to_str(m_headerData.NELEM) + " elements");
+
+  // Jump to the block of the element if it is behind the sweep, or ahead of it in a block that was already seen
+  const Uint block = (element-1) / element_block_size;
+  if (element < m_next_element || (block < m_element_block_positions.size() && block*element_block_size+1 > m_next_element))
+    seek_element_block(block);
+
+  m_file.seek(m_element_position);
+  for (; m_next_element<element; ++m_next_element)
+  {
+    if ((m_next_element-1) % element_block_size == 0 && (m_next_element-1) / element_block_size == m_element_block_positions.size())
+      m_element_block_positions.push_back(m_file.position());
+    m_file.read_uint();  // element number
+    m_file.read_uint();  // element type
+    const Uint nb_element_nodes = m_file.read_uint();
+    for (Uint j=0; j<nb_element_nodes; ++j)
+      m_file.read_uint();
+  }
+
+  if ((element-1) % element_block_size == 0 && block == m_element_block_positions.size())
+    m_element_block_positions.push_back(m_file.position());
+  const Uint element_number = m_file.read_uint();
+  if (element_number != element)
+    throw ParsingFailed(FromHere(), "Expected element " + to_str(element) + " but found element " + to_str(element_number));
+  neu_type = m_file.read_uint();
+  const Uint nb_element_nodes = m_file.read_uint();
+  if (neu_type >= m_nodes_neu_to_cf.size() || m_nodes_neu_to_cf[neu_type].size() != nb_element_nodes)
+    element_type_name(neu_type, nb_element_nodes, m_headerData.NDFCD); // throws for unsupported types
+
+  cf_nodes.resize(nb_element_nodes);
+  for (Uint j=0; j<nb_element_nodes; ++j)
+    cf_nodes[m_nodes_neu_to_cf[neu_type][j]] = m_file.read_uint()-1;
+
+  ++m_next_element;
+  m_element_position = m_file.position();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::rewind_elements()
+{
+  m_element_position = m_file.find_line(m_elements_cells_position, 1);
+  m_next_element = 1;
+  m_element_block_positions.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::seek_element_block(const Uint block)
+{
+  cf3_assert(block < m_element_block_positions.size());
+  m_element_position = m_element_block_positions[block];
+  m_next_element = block*element_block_size+1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+const ElementType& StreamingReader::element_type(const std::string& name)
+{
+  boost::shared_ptr<ElementType>& etype = m_element_types[name];
+  if (!etype)
+    etype = build_component_abstract_type<ElementType>(name, name);
+  return *etype;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+void StreamingReader::flush(StreamingMeshWriter& writer, const Uint region)
+{
+  for (std::map<std::string,std::vector<Uint> >::iterator it = m_buffers.begin(); it != m_buffers.end(); ++it)
+  {
+    if (!it->second.empty())
+    {
+      writer.write_elements(region, it->first, it->second);
+      it->second.clear();
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+} // neu
+} // mesh
+} // cf3
@@ -0,0 +1,126 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_mesh_neu_StreamingReader_hpp
+#define cf3_mesh_neu_StreamingReader_hpp
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <boost/shared_ptr.hpp>
+
+#include "mesh/StreamingMeshReader.hpp"
+#include "mesh/Tokenizer.hpp"
+
+#include "mesh/neu/LibNeu.hpp"
+#include "mesh/neu/Shared.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh {
+  class ElementType;
+namespace neu {
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Converts a neutral file without building a Mesh.
+/// The file is memory-mapped, and only the positions of its sections are kept. Nodes are passed on in chunks as they appear.
+/// The element groups and boundary sets list element numbers: these are read in sorted chunks, and the elements are
+/// then picked up in a single forward sweep over the ELEMENTS/CELLS section per chunk. The sweep records the offset of
+/// each block of elements it goes through, so a chunk that starts before the previous one jumps back to the block of
+/// its first element instead of restarting from the top of the section.
+/// Each element group becomes a region with the volume elements, each boundary condition set a region with the faces.
+class neu_API StreamingReader : public StreamingMeshReader, public Shared
+{
+public: // functions
+
+  /// constructor
+  StreamingReader( const std::string& name );
+
+  /// Gets the Class name
+  static std::string type_name() { return "StreamingReader"; }
+
+  virtual std::string get_format() { return "neu"; }
+
+  virtual std::vector<std::string> get_extensions();
+
+private: // functions
+
+  virtual void do_convert(const common::URI& input, const common::URI& output, StreamingMeshWriter& writer);
+
+  void read_header();
+
+  void find_sections();
+
+  void convert_nodes(StreamingMeshWriter& writer);
+
+  void convert_groups(StreamingMeshWriter& writer);
+
+  void convert_boundaries(StreamingMeshWriter& writer);
+
+  /// Read the given element, going back to the start of its block if it is before the previous one
+  void read_element(const Uint element, Uint& neu_type, std::vector<Uint>& cf_nodes);
+
+  /// Start the sweep over the ELEMENTS/CELLS section from the top, forgetting the recorded block offsets
+  void rewind_elements();
+
+  /// Go to the recorded start of the given block of elements
+  void seek_element_block(const Uint block);
+
+  /// Element type with the given builder name, built once
+  const ElementType& element_type(const std::string& name);
+
+  /// Pass the buffered connectivity of each element type to the writer, and empty the buffers
+  void flush(StreamingMeshWriter& writer, const Uint region);
+
+private: // data
+
+  Tokenizer m_file;
+
+  struct HeaderData
+  {
+    Uint NUMNP, NELEM, NGRPS, NBSETS, NDFCD, NDFVL;
+    std::string mesh_name;
+  } m_headerData;
+
+  /// A region of the output: an element group or a boundary condition set
+  struct RegionData
+  {
+    std::string name;
+    Uint nb_entries;
+    /// Offset of the first element number or boundary entry
+    std::size_t entries_position;
+  };
+
+  std::vector<RegionData> m_groups;
+  std::vector<RegionData> m_boundaries;
+
+  std::size_t m_nodal_coordinates_position;
+  std::size_t m_elements_cells_position;
+
+  /// Position of the sweep over the ELEMENTS/CELLS section
+  std::size_t m_element_position;
+  Uint m_next_element;
+
+  /// Offset of the first element of each block of elements the sweep went through
+  std::vector<std::size_t> m_element_block_positions;
+
+  /// Connectivity of each element type in the current chunk
+  std::map<std::string,std::vector<Uint> > m_buffers;
+
+  std::map<std::string,boost::shared_ptr<ElementType> > m_element_types;
+
+}; // end StreamingReader
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // neu
+} // mesh
+} // cf3
+
+////////////////////////////////////////////////////////////////////////////////
+
+#endif // cf3_mesh_neu_StreamingReader_hpp
@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 
 #include <boost/date_time/gregorian/gregorian.hpp> //include all types plus i/o
 #include <boost/progress.hpp>
@@ -315,7 +316,10 @@ void Writer::write_boundaries(std::fstream& file, const Mesh& mesh)
   if (total_nbElements > 0)
   {
     /// @todo pass a CFLogStream to progress_display instead of std::cout
-    boost::progress_display progress(total_nbElements,std::cout,"writing boundary conditions\n");
+    // The progress is discarded on threads that are muted in the logger
+    std::ostringstream muted_progress;
+    std::ostream& progress_stream = Logger::instance().is_thread_muted() ? static_cast<std::ostream&>(muted_progress) : std::cout;
+    boost::progress_display progress(total_nbElements,progress_stream,"writing boundary conditions\n");
 
     boost_foreach(Handle< Region const > group, bc_regions) // For each boundary condition
     {
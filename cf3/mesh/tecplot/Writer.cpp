@@ -4,8 +4,12 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
 #include <iostream>
-#include <set>
+
+#include <boost/cstdint.hpp>
+#include <boost/type_traits/is_same.hpp>
+
 #include "common/BoostFilesystem.hpp"
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
@@ -37,20 +41,82 @@ namespace cf3 {
 namespace mesh {
 namespace tecplot {
 
-#define CF3_BREAK_LINE(f,x) { if( x+1 % 10) { f << "\n"; } }
-
 ////////////////////////////////////////////////////////////////////////////////
 
 common::ComponentBuilder < tecplot::Writer, MeshWriter, LibTecplot> atecplotWriter_Builder;
 
 //////////////////////////////////////////////////////////////////////////////
 
+namespace
+{
+
+/// Markers in binary files
+const float zone_marker = 299.f;
+const float end_of_header_marker = 357.f;
+
+template<typename T>
+void write_binary(std::ostream& file, const T value)
+{
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// Strings are written as one 32 bit integer per character, followed by a 0
+void write_binary_string(std::ostream& file, const std::string& str)
+{
+  std::vector<boost::int32_t> chars(str.begin(), str.end());
+  chars.push_back(0);
+  file.write(reinterpret_cast<const char*>(&chars[0]), chars.size()*sizeof(boost::int32_t));
+}
+
+/// Write the values as double precision
+void write_binary_doubles(std::ostream& file, const std::vector<Real>& values)
+{
+  if (values.empty())
+    return;
+  if (boost::is_same<Real,double>::value)
+  {
+    file.write(reinterpret_cast<const char*>(&values[0]), values.size()*sizeof(Real));
+    return;
+  }
+  const std::vector<double> converted(values.begin(), values.end());
+  file.write(reinterpret_cast<const char*>(&converted[0]), converted.size()*sizeof(double));
+}
+
+/// Nodes of the element in the order of the tecplot zone type, repeating nodes for pyramids and prisms, which are
+/// written as bricks
+void tecplot_element_nodes(const ElementType& etype, std::vector<Uint>& nodes)
+{
+  nodes.clear();
+  if (etype.shape() == GeoShape::PYRAM)
+  {
+    const Uint pyram_nodes[] = {0, 1, 2, 3, 4, 4, 4, 4};
+    nodes.assign(pyram_nodes, pyram_nodes+8);
+  }
+  else if (etype.shape() == GeoShape::PRISM)
+  {
+    const Uint prism_nodes[] = {0, 1, 2, 2, 3, 4, 5, 5};
+    nodes.assign(prism_nodes, prism_nodes+8);
+  }
+  else
+  {
+    for (Uint n=0; n<etype.nb_nodes(); ++n)
+      nodes.push_back(n);
+  }
+}
+
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
 Writer::Writer( const std::string& name )
 : MeshWriter(name)
 {
 
   options().add("cell_centred",true)
     .description("True if discontinuous fields are to be plotted as cell-centred fields");
+
+  options().add("binary",true)
+    .description("Write the binary .plt format. The ASCII format is meant for debugging.");
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -74,7 +140,7 @@ void Writer::write()
     path = boost::filesystem::basename(path) + "_P" + to_str(PE::Comm::instance().rank()) + boost::filesystem::extension(path);
   }
 //  CFLog(VERBOSE, "Opening file " <<  path.string() << "\n");
-  file.open(path,std::ios_base::out);
+  file.open(path,options().value<bool>("binary") ? std::ios_base::out | std::ios_base::binary : std::ios_base::out);
   if (!file) // didn't open so throw exception
   {
      throw boost::filesystem::filesystem_error( path.string() + " failed to open",
@@ -91,18 +157,18 @@ void Writer::write()
 
 void Writer::write_file(std::fstream& file)
 {
-  file << "TITLE      = COOLFluiD Mesh Data" << "\n";
-  file << "VARIABLES  = ";
+  const bool binary = options().value<bool>("binary");
+  const bool cell_centred = options().value<bool>("cell_centred");
 
   Uint dimension = m_mesh->geometry_fields().coordinates().row_size();
-  // write the coordinate variable names
+  // the coordinate variable names
+  std::vector<std::string> var_names;
   for (Uint i = 0; i < dimension ; ++i)
   {
-    file << " \"x" << i << "\" ";
+    var_names.push_back("x" + to_str(i));
   }
 
   std::vector<Uint> cell_centered_var_ids;
-  Uint zone_var_id(dimension);
   boost_foreach(Handle<Field const> field_ptr, m_fields)
   {
     const Field& field = *field_ptr;
@@ -115,27 +181,25 @@ void Writer::write_file(std::fstream& file)
       {
         for (Uint i=0; i<static_cast<Uint>(var_type); ++i)
         {
-          file << " \"" << var_name << "["<<i<<"]\"";
-          ++zone_var_id;
+          var_names.push_back(var_name + "[" + to_str(i) + "]");
           if (field.discontinuous())
-            cell_centered_var_ids.push_back(zone_var_id);
+            cell_centered_var_ids.push_back(var_names.size());
         }
       }
       else
       {
-        file << " \"" << var_name <<"\"";
-        ++zone_var_id;
+        var_names.push_back(var_name);
         if (field.discontinuous())
-          cell_centered_var_ids.push_back(zone_var_id);
+          cell_centered_var_ids.push_back(var_names.size());
       }
     }
   }
-  file << "\n";
-
+  if (!cell_centred)
+    cell_centered_var_ids.clear();
 
   // loop over the element types
   // and create a zone in the tecplot file for each element type
-//  std::map<Handle<Component const>,Uint> zone_id;
+  std::vector<Zone> zones;
   Uint zone_idx=0;
   boost_foreach (const Handle<Entities const>& elements_h, m_filtered_entities )
   {
@@ -159,13 +223,7 @@ void Writer::write_file(std::fstream& file)
 
     std::string zone_name = elements.parent()->uri().path();
     boost::algorithm::replace_first(zone_name,m_mesh->topology().uri().path()+"/","");
-    std::set<std::string> zone_names;
-    if (zone_names.count(zone_name) == 0)
-    {
-      zone_idx++;
-      zone_names.insert(zone_name);
-    }
-//    zone_id[elements.handle<Component>()] = zone_idx++;
+    zone_idx++;
 
     // tecplot doesn't handle zones with 0 elements
     // which can happen in parallel, so skip them
@@ -177,27 +235,59 @@ void Writer::write_file(std::fstream& file)
       throw NotImplemented(FromHere(), "Tecplot can only output P1 elements. A new P1 space should be created, and used as geometry space");
     }
 
-    boost::shared_ptr< common::List<Uint> > used_nodes_ptr = mesh::build_used_nodes_list(elements,m_mesh->geometry_fields(),m_enable_overlap);
-    common::List<Uint>& used_nodes = *used_nodes_ptr;
-    std::map<Uint,Uint> zone_node_idx;
-    for (Uint n=0; n<used_nodes.size(); ++n)
-      zone_node_idx[ used_nodes[n] ] = n+1;
+    Zone zone;
+    zone.elements = elements_h;
+    zone.title = "STEP" + to_str(m_mesh->metadata().properties().value<Uint>("iter")) + ":" + zone_name;
+    zone.strand_id = zone_idx;
+    zone.nb_elems = nb_elems;
+    zone.used_nodes = mesh::build_used_nodes_list(elements,m_mesh->geometry_fields(),m_enable_overlap);
+    zones.push_back(zone);
+  }
+
+  const Real time = m_mesh->metadata().properties().value<Real>("time");
 
-    const Uint nbCellsInType  = elements.size();
+  if (binary)
+  {
+    write_binary_header(file, var_names, cell_centered_var_ids, zones, time);
+  }
+  else
+  {
+    file << "TITLE      = COOLFluiD Mesh Data" << "\n";
+    file << "VARIABLES  = ";
+    boost_foreach(const std::string& var_name, var_names)
+    {
+      file << " \"" << var_name << "\"";
+    }
+    file << "\n";
+    file.setf(std::ios::scientific,std::ios::floatfield);
+    file.precision(12);
+  }
 
+  std::vector< std::vector<Real> > values;
+  std::vector<Uint> connectivity;
+  boost_foreach (const Zone& zone, zones)
+  {
+    compute_zone_data(*zone.elements, *zone.used_nodes, values, connectivity);
+    cf3_assert(values.size() == var_names.size());
+
+    if (binary)
+    {
+      write_binary_zone(file, values, connectivity);
+      continue;
+    }
 
     // print zone header,
     // one zone per element type per cpu
     // therefore the title is dependent on those parameters
     file << "ZONE "
-         << "  T=\"STEP"<<m_mesh->metadata().properties().value<Uint>("iter") << ":" << zone_name << "\""
-         << ", STRANDID="<<zone_idx
-         << ", SOLUTIONTIME="<<m_mesh->metadata().properties().value<Real>("time")
-         << ", N=" << used_nodes.size()
-         << ", E=" << nb_elems
+         << "  T=\"" << zone.title << "\""
+         << ", STRANDID="<<zone.strand_id
+         << ", SOLUTIONTIME="<<time
+         << ", N=" << zone.used_nodes->size()
+         << ", E=" << zone.nb_elems
          << ", DATAPACKING=BLOCK"
-         << ", ZONETYPE=" << zone_type(etype);
-    if (cell_centered_var_ids.size() && options().value<bool>("cell_centred"))
+         << ", ZONETYPE=" << zone_type(zone.elements->element_type());
+    if (cell_centered_var_ids.size())
     {
       file << ",VARLOCATION=(["<<cell_centered_var_ids[0];
       for (Uint i=1; i<cell_centered_var_ids.size(); ++i)
@@ -206,163 +296,103 @@ void Writer::write_file(std::fstream& file)
     }
     file << "\n\n";
 
-
-         //    fout << ", VARLOCATION=( [" << init_id << "]=CELLCENTERED )" ;
-         //   else
-         //    fout << ", VARLOCATION=( [" << init_id << "-" << end_id << "]=CELLCENTERED )" ;
-         // }
-
-    file.setf(std::ios::scientific,std::ios::floatfield);
-    file.precision(12);
-
-    // loop over coordinates
-    const common::Table<Real>& coordinates = m_mesh->geometry_fields().coordinates();
-    for (Uint d = 0; d < dimension; ++d)
+    for (Uint var=0; var<var_names.size(); ++var)
     {
-      file << "\n### variable x" << d << "\n\n"; // var name in comment
-      boost_foreach(Uint n, used_nodes.array())
+      file << "\n### variable " << var_names[var] << "\n\n"; // var name in comment
+      boost_foreach(const Real value, values[var])
       {
-        cf3_assert(n<coordinates.size());
-        file << coordinates[n][d] << " ";
-        CF3_BREAK_LINE(file,n);
+        file << value << "\n";
       }
-      file << "\n";
     }
-    file << "\n";
-
 
-    boost_foreach(Handle<Field const> field_ptr, m_fields)
+    file << "\n### connectivity\n\n";
+    const Uint nb_elem_nodes = connectivity.size() / zone.nb_elems;
+    for (Uint i=0; i<connectivity.size(); ++i)
     {
-      const Field& field = *field_ptr;
-      Uint var_idx(0);
-      for (Uint iVar=0; iVar<field.nb_vars(); ++iVar)
-      {
-        VarType var_type = field.var_length(iVar);
-        std::string var_name = field.var_name(iVar);
-        file << "\n### variable " << var_name << "\n\n"; // var name in comment
+      file << connectivity[i]+1 << ((i+1) % nb_elem_nodes ? " " : "\n");
+    }
+    file << "\n\n";
+  }
+}
 
-        for (Uint i=0; i<static_cast<Uint>(var_type); ++i)
-        {
-          if (field.continuous())
-          {
-            // Continuous field with different space than geometry
-            if ( &field.dict() == &m_mesh->geometry_fields() )
-            {
-              boost_foreach(Uint n, used_nodes.array())
-              {
-                file << field[n][var_idx] << " ";
-                CF3_BREAK_LINE(file,n);
-              }
-              file << "\n";
-            }
-            // Continuous field with different space than geometry
-            else
-            {
-              if (field.dict().defined_for_entities(elements.handle<Entities>()) )
-              {
-                const Space& field_space = field.space(elements);
-                RealVector field_data (field_space.shape_function().nb_nodes());
+/////////////////////////////////////////////////////////////////////////////
 
-                std::vector<Real> nodal_data(used_nodes.size(),0.);
+void Writer::compute_zone_data(const Entities& elements, const common::List<Uint>& used_nodes, std::vector< std::vector<Real> >& values, std::vector<Uint>& connectivity)
+{
+  const Uint dimension = m_mesh->geometry_fields().coordinates().row_size();
+  const Uint nb_used_nodes = used_nodes.size();
+  Uint nb_elems = 0;
+  for (Uint e=0; e<elements.size(); ++e)
+  {
+    if (m_enable_overlap || !elements.is_ghost(e))
+      ++nb_elems;
+  }
 
-                RealMatrix interpolation(elements.geometry_space().shape_function().nb_nodes(),field_space.shape_function().nb_nodes());
-                const RealMatrix& geometry_local_coords = elements.geometry_space().shape_function().local_coordinates();
-                const ShapeFunction& sf = field_space.shape_function();
-                for (Uint g=0; g<interpolation.rows(); ++g)
-                {
-                  interpolation.row(g) = sf.value(geometry_local_coords.row(g));
-                }
+  std::map<Uint,Uint> zone_node_idx;
+  for (Uint n=0; n<nb_used_nodes; ++n)
+    zone_node_idx[ used_nodes[n] ] = n+1;
 
-                // Compute interpolated data in the vector nodal_data
-                for (Uint e=0; e<elements.size(); ++e)
-                {
-                  // Skip this element if it is a ghost cell and overlap is disabled
-                  if (m_enable_overlap || !elements.is_ghost(e))
-                  {
-                    // get the node indices of this element
-                    Connectivity::ConstRow field_index = field_space.connectivity()[e];
-
-                    /// set field data
-                    for (Uint iState=0; iState<field_space.shape_function().nb_nodes(); ++iState)
-                    {
-                      field_data[iState] = field[field_index[iState]][var_idx];
-                    }
-
-                    /// evaluate field shape function in P0 space
-                    RealVector geometry_field_data = interpolation*field_data;
-
-                    Connectivity::ConstRow geom_nodes = elements.geometry_space().connectivity()[e];
-                    cf3_assert(geometry_field_data.size()==geom_nodes.size());
-                    /// Average nodal values
-                    for (Uint g=0; g<geom_nodes.size(); ++g)
-                    {
-                      const Uint geom_node = geom_nodes[g];
-                      const Uint node_idx = zone_node_idx[geom_node]-1;
-                      cf3_assert(node_idx < nodal_data.size());
-                      nodal_data[node_idx] = geometry_field_data[g];
-                    }
-                  }
-                }
-                for (Uint n=0; n<nodal_data.size(); ++n)
-                {
-                  file << nodal_data[n] << " ";
-                  CF3_BREAK_LINE(file,n)
-                }
-                file << "\n";
-              }
-            }
+  values.clear();
+
+  // coordinates
+  const common::Table<Real>& coordinates = m_mesh->geometry_fields().coordinates();
+  for (Uint d = 0; d < dimension; ++d)
+  {
+    values.push_back(std::vector<Real>(nb_used_nodes));
+    std::vector<Real>& column = values.back();
+    for (Uint n=0; n<nb_used_nodes; ++n)
+    {
+      cf3_assert(used_nodes[n]<coordinates.size());
+      column[n] = coordinates[used_nodes[n]][d];
+    }
+  }
+
+  boost_foreach(Handle<Field const> field_ptr, m_fields)
+  {
+    const Field& field = *field_ptr;
+    Uint var_idx(0);
+    for (Uint iVar=0; iVar<field.nb_vars(); ++iVar)
+    {
+      VarType var_type = field.var_length(iVar);
+
+      for (Uint i=0; i<static_cast<Uint>(var_type); ++i)
+      {
+        values.push_back(std::vector<Real>());
+        std::vector<Real>& column = values.back();
+        if (field.continuous())
+        {
+          // Continuous field in the geometry space
+          if ( &field.dict() == &m_mesh->geometry_fields() )
+          {
+            column.resize(nb_used_nodes);
+            for (Uint n=0; n<nb_used_nodes; ++n)
+              column[n] = field[used_nodes[n]][var_idx];
           }
-          // Discontinuous fields
+          // Continuous field with different space than geometry
           else
           {
-            if (field.dict().defined_for_entities(elements.handle<Entities>()))
+            if (field.dict().defined_for_entities(elements.handle<Entities>()) )
             {
               const Space& field_space = field.space(elements);
               RealVector field_data (field_space.shape_function().nb_nodes());
 
-              if (options().value<bool>("cell_centred"))
-              {
-                boost::shared_ptr< ShapeFunction > P0_cell_centred = boost::dynamic_pointer_cast<ShapeFunction>(build_component("cf3.mesh.LagrangeP0."+to_str(elements.element_type().shape_name()),"tmp_shape_func"));
+              column.assign(nb_used_nodes,0.);
 
-                for (Uint e=0; e<elements.size(); ++e)
-                {
-                  if (m_enable_overlap || !elements.is_ghost(e))
-                  {
-                    Connectivity::ConstRow field_index = field_space.connectivity()[e];
-                    /// set field data
-                    for (Uint iState=0; iState<field_space.shape_function().nb_nodes(); ++iState)
-                    {
-                      field_data[iState] = field[field_index[iState]][var_idx];
-                    }
-
-                    /// get cell-centred local coordinates
-                    RealVector local_coords = P0_cell_centred->local_coordinates().row(0);
-
-                    /// evaluate field shape function in P0 space
-                    Real cell_centred_data = field_space.shape_function().value(local_coords)*field_data;
-
-                    /// Write cell centred value
-                    file << cell_centred_data << " ";
-                    CF3_BREAK_LINE(file,e);
-                  }
-                }
-                file << "\n";
-              }
-              else
+              RealMatrix interpolation(elements.geometry_space().shape_function().nb_nodes(),field_space.shape_function().nb_nodes());
+              const RealMatrix& geometry_local_coords = elements.geometry_space().shape_function().local_coordinates();
+              const ShapeFunction& sf = field_space.shape_function();
+              for (Uint g=0; g<interpolation.rows(); ++g)
               {
-                std::vector<Real> nodal_data(used_nodes.size(),0.);
-                std::vector<Uint> nodal_data_count(used_nodes.size(),0u);
-
-                RealMatrix interpolation(elements.geometry_space().shape_function().nb_nodes(),field_space.shape_function().nb_nodes());
-                const RealMatrix& geometry_local_coords = elements.geometry_space().shape_function().local_coordinates();
-                const ShapeFunction& sf = field_space.shape_function();
-                for (Uint g=0; g<interpolation.rows(); ++g)
-                {
-                  interpolation.row(g) = sf.value(geometry_local_coords.row(g));
-                }
+                interpolation.row(g) = sf.value(geometry_local_coords.row(g));
+              }
 
-                for (Uint e=0; e<elements.size(); ++e)
+              // Compute interpolated data in the vector nodal_data
+              for (Uint e=0; e<elements.size(); ++e)
+              {
+                // Skip this element if it is a ghost cell and overlap is disabled
+                if (m_enable_overlap || !elements.is_ghost(e))
                 {
+                  // get the node indices of this element
                   Connectivity::ConstRow field_index = field_space.connectivity()[e];
 
                   /// set field data
@@ -380,61 +410,200 @@ void Writer::write_file(std::fstream& file)
                   for (Uint g=0; g<geom_nodes.size(); ++g)
                   {
                     const Uint geom_node = geom_nodes[g];
-                    if (zone_node_idx.find(geom_node) != zone_node_idx.end())
-                    {
-                      const Uint node_idx = zone_node_idx[geom_node]-1;
-                      cf3_assert(node_idx < nodal_data.size());
-                      const Real accumulated_weight = nodal_data_count[node_idx]/(nodal_data_count[node_idx]+1.0);
-                      const Real add_weight = 1.0/(nodal_data_count[node_idx]+1.0);
-                      nodal_data[node_idx] = accumulated_weight*nodal_data[node_idx] + add_weight*geometry_field_data[g];
-                      ++nodal_data_count[node_idx];
-                    }
+                    const Uint node_idx = zone_node_idx[geom_node]-1;
+                    cf3_assert(node_idx < column.size());
+                    column[node_idx] = geometry_field_data[g];
                   }
                 }
+              }
+            }
+            else
+            {
+              // field not defined for this zone, so write zeros
+              column.assign(nb_used_nodes,0.);
+            }
+          }
+        }
+        // Discontinuous fields
+        else
+        {
+          if (field.dict().defined_for_entities(elements.handle<Entities>()))
+          {
+            const Space& field_space = field.space(elements);
+            RealVector field_data (field_space.shape_function().nb_nodes());
 
-                for (Uint n=0; n<nodal_data.size(); ++n)
+            if (options().value<bool>("cell_centred"))
+            {
+              boost::shared_ptr< ShapeFunction > P0_cell_centred = boost::dynamic_pointer_cast<ShapeFunction>(build_component("cf3.mesh.LagrangeP0."+to_str(elements.element_type().shape_name()),"tmp_shape_func"));
+
+              for (Uint e=0; e<elements.size(); ++e)
+              {
+                if (m_enable_overlap || !elements.is_ghost(e))
                 {
-                  file << nodal_data[n] << " ";
-                    CF3_BREAK_LINE(file,n)
-                }
-                file << "\n";
+                  Connectivity::ConstRow field_index = field_space.connectivity()[e];
+                  /// set field data
+                  for (Uint iState=0; iState<field_space.shape_function().nb_nodes(); ++iState)
+                  {
+                    field_data[iState] = field[field_index[iState]][var_idx];
+                  }
+
+                  /// get cell-centred local coordinates
+                  RealVector local_coords = P0_cell_centred->local_coordinates().row(0);
 
+                  /// evaluate field shape function in P0 space
+                  column.push_back(field_space.shape_function().value(local_coords)*field_data);
+                }
               }
             }
             else
             {
-              // field not defined for this zone, so write zeros
-              if (options().value<bool>("cell_centred"))
-                file << nb_elems << "*" << 0.;
-              else
-                file << used_nodes.size() << "*" << 0.;
-              file << "\n";
+              column.assign(nb_used_nodes,0.);
+              std::vector<Uint> nodal_data_count(nb_used_nodes,0u);
+
+              RealMatrix interpolation(elements.geometry_space().shape_function().nb_nodes(),field_space.shape_function().nb_nodes());
+              const RealMatrix& geometry_local_coords = elements.geometry_space().shape_function().local_coordinates();
+              const ShapeFunction& sf = field_space.shape_function();
+              for (Uint g=0; g<interpolation.rows(); ++g)
+              {
+                interpolation.row(g) = sf.value(geometry_local_coords.row(g));
+              }
+
+              for (Uint e=0; e<elements.size(); ++e)
+              {
+                Connectivity::ConstRow field_index = field_space.connectivity()[e];
+
+                /// set field data
+                for (Uint iState=0; iState<field_space.shape_function().nb_nodes(); ++iState)
+                {
+                  field_data[iState] = field[field_index[iState]][var_idx];
+                }
+
+                /// evaluate field shape function in P0 space
+                RealVector geometry_field_data = interpolation*field_data;
+
+                Connectivity::ConstRow geom_nodes = elements.geometry_space().connectivity()[e];
+                cf3_assert(geometry_field_data.size()==geom_nodes.size());
+                /// Average nodal values
+                for (Uint g=0; g<geom_nodes.size(); ++g)
+                {
+                  const Uint geom_node = geom_nodes[g];
+                  if (zone_node_idx.find(geom_node) != zone_node_idx.end())
+                  {
+                    const Uint node_idx = zone_node_idx[geom_node]-1;
+                    cf3_assert(node_idx < column.size());
+                    const Real accumulated_weight = nodal_data_count[node_idx]/(nodal_data_count[node_idx]+1.0);
+                    const Real add_weight = 1.0/(nodal_data_count[node_idx]+1.0);
+                    column[node_idx] = accumulated_weight*column[node_idx] + add_weight*geometry_field_data[g];
+                    ++nodal_data_count[node_idx];
+                  }
+                }
+              }
             }
           }
-          var_idx++;
+          else
+          {
+            // field not defined for this zone, so write zeros
+            column.assign(options().value<bool>("cell_centred") ? nb_elems : nb_used_nodes, 0.);
+          }
         }
+        var_idx++;
       }
     }
+  }
 
-    file << "\n### connectivity\n\n";
-    // write connectivity
-    const Connectivity& connectivity = elements.geometry_space().connectivity();
-    for (Uint e=0; e<elements.size(); ++e)
+  // connectivity, zero-based in the zone, with coalesced nodes for the shapes tecplot doesn't know
+  std::vector<Uint> tecplot_nodes;
+  tecplot_element_nodes(elements.element_type(), tecplot_nodes);
+  connectivity.clear();
+  connectivity.reserve(elements.size()*tecplot_nodes.size());
+  const Connectivity& geometry_connectivity = elements.geometry_space().connectivity();
+  for (Uint e=0; e<elements.size(); ++e)
+  {
+    if (m_enable_overlap || !elements.is_ghost(e))
     {
-      if (m_enable_overlap || !elements.is_ghost(e))
+      Connectivity::ConstRow nodes = geometry_connectivity[e];
+      boost_foreach (const Uint n, tecplot_nodes)
       {
-        boost_foreach ( Uint n, connectivity[e])
-        {
-          file << zone_node_idx[n] << " ";
-        }
-        file << "\n";
+        connectivity.push_back(zone_node_idx[nodes[n]]-1);
       }
     }
-    file << "\n\n";
+  }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_binary_header(std::fstream& file, const std::vector<std::string>& var_names, const std::vector<Uint>& cell_centered_var_ids, const std::vector<Zone>& zones, const Real time)
+{
+  file.write("#!TDV112", 8);
+  write_binary<boost::int32_t>(file, 1);      // byte order
+  write_binary<boost::int32_t>(file, 0);      // full file type, grid and solution
+  write_binary_string(file, "COOLFluiD Mesh Data");
+  write_binary<boost::int32_t>(file, var_names.size());
+  boost_foreach(const std::string& var_name, var_names)
+  {
+    write_binary_string(file, var_name);
+  }
+
+  std::vector<boost::int32_t> var_locations(var_names.size(), 0);
+  boost_foreach(const Uint var_id, cell_centered_var_ids)
+  {
+    var_locations[var_id-1] = 1;
+  }
+
+  boost_foreach (const Zone& zone, zones)
+  {
+    write_binary<float>(file, zone_marker);
+    write_binary_string(file, zone.title);
+    write_binary<boost::int32_t>(file, -1);   // parent zone
+    write_binary<boost::int32_t>(file, zone.strand_id);
+    write_binary<double>(file, time);
+    write_binary<boost::int32_t>(file, -1);   // unused
+    write_binary<boost::int32_t>(file, binary_zone_type(zone.elements->element_type()));
+    write_binary<boost::int32_t>(file, cell_centered_var_ids.empty() ? 0 : 1);
+    if (!cell_centered_var_ids.empty())
+      file.write(reinterpret_cast<const char*>(&var_locations[0]), var_locations.size()*sizeof(boost::int32_t));
+    write_binary<boost::int32_t>(file, 0);    // no face neighbors
+    write_binary<boost::int32_t>(file, 0);    // no user-defined face neighbor connections
+    write_binary<boost::int32_t>(file, zone.used_nodes->size());
+    write_binary<boost::int32_t>(file, zone.nb_elems);
+    write_binary<boost::int32_t>(file, 0);    // I, J and K cell dimensions, unused
+    write_binary<boost::int32_t>(file, 0);
+    write_binary<boost::int32_t>(file, 0);
+    write_binary<boost::int32_t>(file, 0);    // no auxiliary data
+  }
+
+  write_binary<float>(file, end_of_header_marker);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
+void Writer::write_binary_zone(std::fstream& file, const std::vector< std::vector<Real> >& values, const std::vector<Uint>& connectivity)
+{
+  const Uint nb_vars = values.size();
+  write_binary<float>(file, zone_marker);
+  for (Uint var=0; var<nb_vars; ++var)
+    write_binary<boost::int32_t>(file, 2);    // double precision data
+  write_binary<boost::int32_t>(file, 0);      // no passive variables
+  write_binary<boost::int32_t>(file, 0);      // no variable sharing
+  write_binary<boost::int32_t>(file, -1);     // no connectivity sharing
+
+  boost_foreach(const std::vector<Real>& column, values)
+  {
+    write_binary<double>(file, column.empty() ? 0. : *std::min_element(column.begin(), column.end()));
+    write_binary<double>(file, column.empty() ? 0. : *std::max_element(column.begin(), column.end()));
+  }
 
+  boost_foreach(const std::vector<Real>& column, values)
+  {
+    write_binary_doubles(file, column);
   }
+
+  std::vector<boost::int32_t> tecplot_connectivity(connectivity.begin(), connectivity.end());
+  if (!tecplot_connectivity.empty())
+    file.write(reinterpret_cast<const char*>(&tecplot_connectivity[0]), tecplot_connectivity.size()*sizeof(boost::int32_t));
 }
 
+/////////////////////////////////////////////////////////////////////////////
 
 std::string Writer::zone_type(const ElementType& etype) const
 {
@@ -449,6 +618,21 @@ std::string Writer::zone_type(const ElementType& etype) const
   cf3_assert_desc("should not be here",false);
   return "INVALID";
 }
+
+/////////////////////////////////////////////////////////////////////////////
+
+Uint Writer::binary_zone_type(const ElementType& etype) const
+{
+  if ( etype.shape() == GeoShape::LINE)     return 1;
+  if ( etype.shape() == GeoShape::TRIAG)    return 2;
+  if ( etype.shape() == GeoShape::QUAD)     return 3;
+  if ( etype.shape() == GeoShape::TETRA)    return 4;
+  if ( etype.shape() == GeoShape::PYRAM)    return 5;  // brick with coalesced nodes
+  if ( etype.shape() == GeoShape::PRISM)    return 5;  // brick with coalesced nodes
+  if ( etype.shape() == GeoShape::HEXA)     return 5;
+  throw NotImplemented(FromHere(), "Tecplot has no zone type for " + etype.derived_type_name());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 } // tecplot
@@ -9,6 +9,8 @@
 
 ////////////////////////////////////////////////////////////////////////////////
 
+#include "common/Handle.hpp"
+
 #include "mesh/MeshWriter.hpp"
 #include "mesh/GeoShape.hpp"
 
@@ -17,13 +19,15 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace cf3 {
+namespace common { template <typename T> class List; }
 namespace mesh {
   class ElementType;
 namespace tecplot {
 
 //////////////////////////////////////////////////////////////////////////////
 
-/// This class defines tecplot mesh format writer
+/// This class defines tecplot mesh format writer.
+/// By default the binary .plt format (version 112) is written, with each variable in one block.
 /// @author Willem Deconinck
 class tecplot_API Writer : public MeshWriter
 {
@@ -48,10 +52,31 @@ public: // functions
 
 private: // functions
 
+  /// A zone in the file, made of the elements of one Entities component
+  struct Zone
+  {
+    Handle<Entities const> elements;
+    std::string title;
+    Uint strand_id;
+    /// number of elements written, without the ghosts if overlap is disabled
+    Uint nb_elems;
+    boost::shared_ptr< common::List<Uint> > used_nodes;
+  };
+
   void write_file(std::fstream& file);
 
+  /// Compute the values of all variables in the zone, and the zero-based connectivity in the zone nodes
+  void compute_zone_data(const Entities& elements, const common::List<Uint>& used_nodes, std::vector< std::vector<Real> >& values, std::vector<Uint>& connectivity);
+
+  void write_binary_header(std::fstream& file, const std::vector<std::string>& var_names, const std::vector<Uint>& cell_centered_var_ids, const std::vector<Zone>& zones, const Real time);
+
+  void write_binary_zone(std::fstream& file, const std::vector< std::vector<Real> >& values, const std::vector<Uint>& connectivity);
+
   std::string zone_type(const ElementType& etype) const;
 
+  /// Zone type number in the binary format
+  Uint binary_zone_type(const ElementType& etype) const;
+
 private: // data
 
 
@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include "common/Builder.hpp"
 #include "common/FindComponents.hpp"
 #include "common/OptionList.hpp"
@@ -104,8 +106,42 @@ void ComputeRHS::compute_rhs(const Uint elem_idx, std::vector<RealVector>& rhs,
 
 ////////////////////////////////////////////////////////////////////////////////
 
+void ComputeRHS::compute_rhs_block(const Uint begin, const Uint nb_elems, const Uint nb_sol_pts, const Uint nb_eqs,
+                                   Real* rhs, Real* wave_speed)
+{
+  const Uint block_size = TermComputer::block_size;
+  const Uint rhs_size = nb_sol_pts*nb_eqs*block_size;
+  const Uint ws_size = nb_sol_pts*block_size;
+  std::fill(rhs, rhs+rhs_size, 0.);
+  std::fill(wave_speed, wave_speed+ws_size, 0.);
+  m_block_term.resize(rhs_size);
+  m_block_ws.resize(ws_size);
+
+  // The unused columns of the block are summed as well, which keeps the loops contiguous
+  for (Uint t=0; t<m_term_computers.size(); ++t)
+  {
+    if (m_loop_cells[t])
+    {
+      m_term_computers[t]->compute_term_block(begin,nb_elems,nb_sol_pts,nb_eqs,&m_block_term[0],&m_block_ws[0]);
+      const Real* term = &m_block_term[0];
+      for (Uint i=0; i<rhs_size; ++i)
+      {
+        rhs[i] += term[i];
+      }
+      const Real* ws = &m_block_ws[0];
+      for (Uint i=0; i<ws_size; ++i)
+      {
+        wave_speed[i] = std::max(wave_speed[i],ws[i]);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 void ComputeRHS::compute_rhs(mesh::Field& rhs, mesh::Field& wave_speed)
 {
+  const Uint block_size = TermComputer::block_size;
   const Uint nb_eqs = rhs.row_size();
   mesh::Dictionary& dict = rhs.dict();
   boost_foreach(const Handle<mesh::Entities>& cells, dict.entities_range() )
@@ -114,29 +150,40 @@ void ComputeRHS::compute_rhs(mesh::Field& rhs, mesh::Field& wave_speed)
     {
       const Space& space = dict.space(*cells);
 
-      // Element-loop
+      // Element-loop, in blocks of consecutive owned elements
       const Uint nb_elems = cells->size();
       const Uint nb_sol_pts = space.shape_function().nb_nodes();
 
-      std::vector<RealVector> elem_rhs(nb_sol_pts,RealVector(nb_eqs));
-      std::vector<Real> elem_wave_speed(nb_sol_pts);
+      std::vector<Real> block_rhs(block_size*nb_sol_pts*nb_eqs);
+      std::vector<Real> block_wave_speed(block_size*nb_sol_pts);
 
-      for (Uint elem_idx=0; elem_idx<nb_elems; ++elem_idx)
+      Uint begin=0;
+      while (begin<nb_elems)
       {
-        if (cells->is_ghost(elem_idx)==false)
+        if (cells->is_ghost(begin))
         {
-          compute_rhs(elem_idx,elem_rhs,elem_wave_speed);
+          ++begin;
+          continue;
+        }
+        Uint end=begin+1;
+        while (end<nb_elems && end-begin<block_size && cells->is_ghost(end)==false)
+          ++end;
 
-          mesh::Connectivity::ConstRow nodes = space.connectivity()[elem_idx];
+        compute_rhs_block(begin,end-begin,nb_sol_pts,nb_eqs,&block_rhs[0],&block_wave_speed[0]);
+
+        for (Uint e=0; e<end-begin; ++e)
+        {
+          mesh::Connectivity::ConstRow nodes = space.connectivity()[begin+e];
           for (Uint sol_pt=0; sol_pt<nb_sol_pts; ++sol_pt)
           {
             for (Uint eq=0; eq<nb_eqs; ++eq)
             {
-              rhs[nodes[sol_pt]][eq] = elem_rhs[sol_pt][eq];
+              rhs[nodes[sol_pt]][eq] = block_rhs[(sol_pt*nb_eqs+eq)*block_size+e];
             }
-            wave_speed[nodes[sol_pt]][0] = elem_wave_speed[sol_pt];
+            wave_speed[nodes[sol_pt]][0] = block_wave_speed[sol_pt*block_size+e];
           }
         }
+        begin=end;
       }
     }
   }
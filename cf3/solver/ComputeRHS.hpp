@@ -58,6 +58,11 @@ public:
   /// @brief Compute the complete rhs for a given element, as well as the wave-speeds
   virtual void compute_rhs(const Uint elem_idx, std::vector<RealVector>& rhs, std::vector<Real>& wave_speed);
 
+  /// @brief Compute the complete rhs for the elements [begin,begin+nb_elems), as well as the wave-speeds,
+  /// in the structure-of-arrays layout of TermComputer::compute_term_block()
+  virtual void compute_rhs_block(const Uint begin, const Uint nb_elems, const Uint nb_sol_pts, const Uint nb_eqs,
+                                 Real* rhs, Real* wave_speed);
+
   /// @brief Compute the complete rhs in a field, as well as wave speeds
   virtual void compute_rhs(mesh::Field& rhs, mesh::Field& wave_speed);
 
@@ -71,6 +76,9 @@ private:
 
   std::vector< RealVector > m_tmp_term;
   std::vector< Real > m_tmp_ws;
+
+  std::vector< Real > m_block_term;
+  std::vector< Real > m_block_ws;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include "common/Builder.hpp"
 #include "common/OptionList.hpp"
 #include "mesh/Entities.hpp"
@@ -19,6 +21,10 @@ namespace solver {
   
 /////////////////////////////////////////////////////////////////////////////////////
 
+const Uint TermComputer::block_size;
+
+/////////////////////////////////////////////////////////////////////////////////////
+
 TermComputer::TermComputer ( const std::string& name ) 
   : common::Action(name) 
 {
@@ -45,6 +51,7 @@ void TermComputer::execute()
 void TermComputer::compute_term(mesh::Field& term, mesh::Field& wave_speed)
 {
   term = 0.;
+  const Uint nb_eqs = term.row_size();
   boost_foreach( const Handle<mesh::Entities const>& cells, term.entities_range() )
   {
     if (loop_cells(cells))
@@ -52,23 +59,48 @@ void TermComputer::compute_term(mesh::Field& term, mesh::Field& wave_speed)
       const mesh::Space& space = term.space(*cells);
       const Uint nb_elems = space.size();
       const Uint nb_nodes_per_elem = space.shape_function().nb_nodes();
-      for (Uint e=0; e<nb_elems; ++e)
+      m_block_term.resize(block_size*nb_nodes_per_elem*nb_eqs);
+      m_block_ws.resize(block_size*nb_nodes_per_elem);
+      for (Uint begin=0; begin<nb_elems; begin+=block_size)
       {
-        compute_term(e,m_tmp_term,m_tmp_ws);
-        for (Uint s=0; s<nb_nodes_per_elem; ++s)
+        const Uint nb_block_elems = std::min(block_size, nb_elems-begin);
+        compute_term_block(begin,nb_block_elems,nb_nodes_per_elem,nb_eqs,&m_block_term[0],&m_block_ws[0]);
+        for (Uint e=0; e<nb_block_elems; ++e)
         {
-          const Uint p=space.connectivity()[e][s];
-          for (Uint eq=0; eq<m_tmp_term[s].size(); ++eq)
+          for (Uint s=0; s<nb_nodes_per_elem; ++s)
           {
-            term[p][eq] += m_tmp_term[s][eq];
+            const Uint p=space.connectivity()[begin+e][s];
+            for (Uint eq=0; eq<nb_eqs; ++eq)
+            {
+              term[p][eq] += m_block_term[(s*nb_eqs+eq)*block_size+e];
+            }
+            wave_speed[p][0] = m_block_ws[s*block_size+e];
           }
-          wave_speed[p][0] = m_tmp_ws[s]; 
         }
       }
     }
   }
 }
 
+/////////////////////////////////////////////////////////////////////////////////////
+
+void TermComputer::compute_term_block(const Uint begin, const Uint nb_elems, const Uint nb_sol_pts, const Uint nb_eqs,
+                                      Real* term, Real* wave_speed)
+{
+  for (Uint e=0; e<nb_elems; ++e)
+  {
+    compute_term(begin+e,m_tmp_term,m_tmp_ws);
+    for (Uint s=0; s<nb_sol_pts; ++s)
+    {
+      for (Uint eq=0; eq<nb_eqs; ++eq)
+      {
+        term[(s*nb_eqs+eq)*block_size+e] = m_tmp_term[s][eq];
+      }
+      wave_speed[s*block_size+e] = m_tmp_ws[s];
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 } // solver
@@ -8,6 +8,8 @@
 #define cf3_solver_TermComputer_hpp
 
 #include "common/Action.hpp"
+#include "common/BasicExceptions.hpp"
+#include "common/StringConversion.hpp"
 #include "math/MatrixTypes.hpp"
 #include "solver/LibSolver.hpp"
 
@@ -29,10 +31,19 @@ namespace solver {
 /////////////////////////////////////////////////////////////////////////////////////
 
 /// @brief Computes a term of a system of equations by looping over elements
+///
+/// The elements are processed in blocks of block_size elements through compute_term_block(),
+/// which stores the term in structure-of-arrays buffers: the values of one equation in one
+/// solution point are contiguous for all the elements of the block.
+/// The default compute_term_block() calls compute_term() for each element. TermComputerT implements
+/// it with compile-time sizes instead, so the loops over the elements can be vectorized.
 /// @author Willem Deconinck
 class solver_API TermComputer : public common::Action
 {
 public:
+
+  /// Number of elements in a block
+  static const Uint block_size = 32;
   
   /// @brief Constructor
   TermComputer ( const std::string& name );
@@ -55,6 +66,16 @@ public:
   /// @brief Compute the term for given element in given vectors
   virtual void compute_term(const Uint elem_idx, std::vector<RealVector>& term, std::vector<Real>& wave_speed) = 0;
 
+  /// @brief Compute the term for the elements [begin,begin+nb_elems) of the cells given to loop_cells()
+  /// @param nb_elems     number of elements, at most block_size
+  /// @param nb_sol_pts   number of solution points per element
+  /// @param nb_eqs       number of equations
+  /// @param term         block_size*nb_sol_pts*nb_eqs values, term[(sol_pt*nb_eqs+eq)*block_size+e]
+  ///                     receives equation eq in solution point sol_pt of element begin+e
+  /// @param wave_speed   block_size*nb_sol_pts values, wave_speed[sol_pt*block_size+e]
+  virtual void compute_term_block(const Uint begin, const Uint nb_elems, const Uint nb_sol_pts, const Uint nb_eqs,
+                                  Real* term, Real* wave_speed);
+
  private:
 
   Handle<mesh::Field> m_term_field;
@@ -62,6 +83,72 @@ public:
   
   std::vector<RealVector> m_tmp_term;
   std::vector<Real>       m_tmp_ws;
+
+  std::vector<Real> m_block_term;
+  std::vector<Real> m_block_ws;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// @brief TermComputer with the number of solution points and equations known at compile time
+///
+/// Derived classes implement compute_term_block() on fixed-size arrays, where term[sol_pt][eq]
+/// holds the values of all the elements of the block. Loops over the elements in the block then
+/// have a constant trip count and contiguous accesses, and are vectorized by the compiler.
+/// The per-element compute_term() goes through the block version.
+/// @param SF      shape function of the solution space, giving the number of solution points
+/// @param NB_EQS  number of equations
+template < typename SF, Uint NB_EQS >
+class TermComputerT : public TermComputer
+{
+public:
+
+  static const Uint NSOLPTS = SF::nb_nodes;
+  static const Uint NEQS    = NB_EQS;
+
+  /// Term of a block, term[sol_pt][eq][e]
+  typedef Real TermBlockT[NSOLPTS][NEQS][block_size];
+
+  /// Wave speed of a block, wave_speed[sol_pt][e]
+  typedef Real WaveSpeedBlockT[NSOLPTS][block_size];
+
+  TermComputerT ( const std::string& name ) : TermComputer(name) {}
+
+  virtual ~TermComputerT() {}
+
+  static std::string type_name () { return "TermComputerT<"+SF::type_name()+","+common::to_str(NB_EQS)+">"; }
+
+  using TermComputer::compute_term;
+
+  /// @brief Compute the term for the elements [begin,begin+nb_elems) in fixed-size blocks
+  virtual void compute_term_block(const Uint begin, const Uint nb_elems, TermBlockT& term, WaveSpeedBlockT& wave_speed) = 0;
+
+  virtual void compute_term_block(const Uint begin, const Uint nb_elems, const Uint nb_sol_pts, const Uint nb_eqs,
+                                  Real* term, Real* wave_speed)
+  {
+    if (nb_sol_pts != NSOLPTS || nb_eqs != NEQS)
+      throw common::BadValue(FromHere(), type_name()+" can't compute a term with "+common::to_str(nb_sol_pts)+
+                                         " solution points and "+common::to_str(nb_eqs)+" equations");
+    compute_term_block(begin, nb_elems, *reinterpret_cast<TermBlockT*>(term), *reinterpret_cast<WaveSpeedBlockT*>(wave_speed));
+  }
+
+  virtual void compute_term(const Uint elem_idx, std::vector<RealVector>& term, std::vector<Real>& wave_speed)
+  {
+    compute_term_block(elem_idx, 1u, m_term, m_wave_speed);
+    term.resize(NSOLPTS, RealVector(NEQS));
+    wave_speed.resize(NSOLPTS);
+    for (Uint s=0; s<NSOLPTS; ++s)
+    {
+      for (Uint eq=0; eq<NEQS; ++eq)
+        term[s][eq] = m_term[s][eq][0];
+      wave_speed[s] = m_wave_speed[s][0];
+    }
+  }
+
+private:
+
+  TermBlockT      m_term;
+  WaveSpeedBlockT m_wave_speed;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
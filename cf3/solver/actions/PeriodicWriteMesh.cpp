@@ -11,6 +11,7 @@
 #include "common/Foreach.hpp"
 #include "common/FindComponents.hpp"
 
+#include "mesh/AsyncWriteMesh.hpp"
 #include "mesh/WriteMesh.hpp"
 #include "mesh/Mesh.hpp"
 #include "mesh/Field.hpp"
@@ -32,7 +33,8 @@ common::ComponentBuilder < PeriodicWriteMesh, common::Action, LibActions > Perio
 ////////////////////////////////////////////////////////////////////////////////////////////
 
 PeriodicWriteMesh::PeriodicWriteMesh ( const std::string& name ) : solver::Action(name),
-  m_writer( *create_static_component<WriteMesh>("MeshWriter") )
+  m_writer( *create_static_component<WriteMesh>("MeshWriter") ),
+  m_async_writer( *create_static_component<AsyncWriteMesh>("AsyncMeshWriter") )
 {
   mark_basic();
 
@@ -48,6 +50,10 @@ PeriodicWriteMesh::PeriodicWriteMesh ( const std::string& name ) : solver::Actio
   options().add( "filepath", URI() )
       .pretty_name("File Path")
       .description("Path where to save the mesh");
+
+  options().add( "asynchronous", false )
+      .pretty_name("Asynchronous")
+      .description("Write on a background thread, from a copy of the fields. Use AsyncMeshWriter to set the writer and the number of copies. Writers that make collective MPI calls, like XDMF, are refused when running in parallel.");
 }
 
 
@@ -74,8 +80,10 @@ void PeriodicWriteMesh::execute()
       state_fields.push_back(field.uri());
     }
 
-    m_writer.write_mesh( mesh(), filepath, state_fields );
-
+    if(options().value<bool>("asynchronous"))
+      m_async_writer.write_mesh( mesh(), filepath, state_fields );
+    else
+      m_writer.write_mesh( mesh(), filepath, state_fields );
 
   }
 
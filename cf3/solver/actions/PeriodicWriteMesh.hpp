@@ -13,7 +13,7 @@
 /////////////////////////////////////////////////////////////////////////////////////
 
 namespace cf3 {
-namespace mesh   { class Field; class Mesh; class WriteMesh; }
+namespace mesh   { class AsyncWriteMesh; class Field; class Mesh; class WriteMesh; }
 namespace solver {
 namespace actions {
 
@@ -39,6 +39,8 @@ private: // data
 
   mesh::WriteMesh& m_writer; ///< mesh writer
 
+  mesh::AsyncWriteMesh& m_async_writer; ///< mesh writer used when the option "asynchronous" is set
+
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -102,6 +102,7 @@ public:
   void update_block_connectivity(math::LSS::BlockAccumulator& block_accumulator)
   {
     block_accumulator.neighbour_indices(m_connectivity[m_element_idx]);
+    block_accumulator.set_element(&m_connectivity, m_connectivity.size(), m_element_idx);
   }
 
   /// Reference to the current nodes
@@ -358,13 +359,14 @@ public:
     m_connectivity(get_connectivity(placeholder.field_tag(), elements)),
     m_support(support),
     offset(m_field.descriptor().offset(placeholder.name())),
-    m_need_sync(false)
+    m_need_sync(false),
+    m_sync_owner(true)
   {
   }
   
   ~EtypeTVariableData()
   {
-    if(common::PE::Comm::instance().is_active())
+    if(m_sync_owner && common::PE::Comm::instance().is_active())
     {
       const Uint my_sync = m_need_sync ? 1 : 0;
       Uint global_sync = 0;
@@ -425,6 +427,14 @@ public:
     m_need_sync = true;
   }
 
+  /// Hand over the synchronization request to the primary data, which then does the collective check on destruction
+  void merge_sync(EtypeTVariableData& primary)
+  {
+    primary.m_need_sync = primary.m_need_sync || m_need_sync;
+    m_need_sync = false;
+    m_sync_owner = false;
+  }
+
   /// Precompute all the cached values for the given geometric support and mapped coordinates.
   void compute_values(const MappedCoordsT& mapped_coords) const
   {
@@ -511,6 +521,9 @@ private:
   
   bool m_need_sync;
 
+  /// False if the synchronization request was handed over to another data object
+  bool m_sync_owner;
+
 public:
   /// Index of where the variable we need is in the field data row
   const Uint offset;
@@ -550,6 +563,11 @@ public:
     m_field_idx = element_idx + m_elements_begin;
   }
 
+  /// Element-based data is never synchronized
+  void merge_sync(EtypeTVariableData&)
+  {
+  }
+
   ValueResultT value() const
   {
     return ValueResultT(&m_field[m_field_idx][offset]);
@@ -623,6 +641,11 @@ public:
     m_field_idx = element_idx + m_elements_begin;
   }
 
+  /// Element-based data is never synchronized
+  void merge_sync(EtypeTVariableData&)
+  {
+  }
+
   Real& value() const
   {
     cf3_assert(m_field_idx < m_field.size());
@@ -860,6 +883,13 @@ public:
   {
   }
 
+  /// Hand over pending field synchronizations to the primary data. Used after a threaded loop with one data object per thread,
+  /// so that only the primary data takes part in the collective synchronization check.
+  void merge_sync(ElementData& primary)
+  {
+    boost::mpl::for_each< boost::mpl::range_c<int, 0, NbVarsT::value> >(MergeSync(m_variables_data, primary.m_variables_data));
+  }
+
   /// Precompute element matrices, for the variables found in expr
   template<typename ExprT>
   void precompute_element_matrices(const typename SupportEtypeT::MappedCoordsT& mapped_coords, const ExprT& e)
@@ -1064,6 +1094,35 @@ private:
     const Uint element_idx;
   };
 
+  /// Hand over the synchronization requests of each stored data item
+  struct MergeSync
+  {
+    MergeSync(VariablesDataT& vars_data, VariablesDataT& primary_vars_data) :
+      variables_data(vars_data),
+      primary_variables_data(primary_vars_data)
+    {
+    }
+
+    template<typename I>
+    void operator()(const I&)
+    {
+      apply(boost::fusion::at<I>(variables_data), boost::fusion::at<I>(primary_variables_data));
+    }
+
+    void apply(const boost::mpl::void_&, const boost::mpl::void_&)
+    {
+    }
+
+    template<typename T>
+    void apply(T*& d, T*& primary)
+    {
+      d->merge_sync(*primary);
+    }
+
+    VariablesDataT& variables_data;
+    VariablesDataT& primary_variables_data;
+  };
+
   /// Precompute variables data
   template<typename ExprT>
   struct PrecomputeData
@@ -16,9 +16,14 @@
 #include <boost/mpl/for_each.hpp>
 #include <boost/mpl/filter_view.hpp>
 
+#include <boost/ptr_container/ptr_vector.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+
 #include "ElementData.hpp"
 #include "ElementExpressionWrapper.hpp"
 #include "ElementGrammar.hpp"
+#include "ElementThreading.hpp"
 
 #include "mesh/Mesh.hpp"
 #include "mesh/Space.hpp"
@@ -154,15 +159,97 @@ struct ExpressionRunner
 
 
 
+/// Runs a wrapped expression over a part of the colored elements, one color at a time. Each thread has its own data and copy of the expression.
+template<typename FilteredExprT, typename DataT>
+struct ColoredElementWorker
+{
+  ColoredElementWorker(const FilteredExprT& expr, DataT& data, const ElementColoring& coloring, boost::barrier& barrier, ThreadedLoopErrors& errors, const Uint thread_idx, const Uint nb_workers) :
+    m_expr(expr),
+    m_data(data),
+    m_coloring(coloring),
+    m_barrier(barrier),
+    m_errors(errors),
+    m_thread_idx(thread_idx),
+    m_nb_workers(nb_workers)
+  {
+  }
+
+  void operator()() const
+  {
+    ElementThreading::set_thread_index(m_thread_idx);
+    ElementGrammar grammar;
+    const Uint nb_colors = m_coloring.nb_colors();
+    for(Uint color = 0; color != nb_colors; ++color)
+    {
+      // Contiguous chunk of the elements with this color
+      const Uint color_begin = m_coloring.color_begin(color);
+      const Uint color_size = m_coloring.color_end(color) - color_begin;
+      const Uint chunk_begin = color_begin + (color_size * m_thread_idx) / m_nb_workers;
+      const Uint chunk_end = color_begin + (color_size * (m_thread_idx+1)) / m_nb_workers;
+
+      if(!m_errors.failed())
+      {
+        try
+        {
+          for(Uint i = chunk_begin; i != chunk_end; ++i)
+          {
+            const Uint elem = m_coloring.element(i);
+            m_data.set_element(elem);
+            grammar(m_expr, elem, m_data);
+          }
+        }
+        catch(std::exception& e)
+        {
+          m_errors.store(e.what());
+        }
+        catch(...)
+        {
+          m_errors.store("unknown exception");
+        }
+      }
+
+      // Elements of the next color may share nodes with this one, so all threads must be done before continuing
+      m_barrier.wait();
+    }
+  }
+
+private:
+  const FilteredExprT& m_expr;
+  DataT& m_data;
+  const ElementColoring& m_coloring;
+  boost::barrier& m_barrier;
+  ThreadedLoopErrors& m_errors;
+  const Uint m_thread_idx;
+  const Uint m_nb_workers;
+};
+
 /// Helper struct to launch execution once all shape functions have been determined
 template<typename DataT>
 struct ElementLooperImpl
 {
-  template<typename ExprT>
-  void operator()(const ExprT& expr, DataT& data, const Uint nb_elems) const
+  template<typename ExprT, typename VariablesT>
+  void operator()(const ExprT& expr, VariablesT& variables, mesh::Elements& elements) const
   {
     const typename DataT::SupportShapeFunction::MappedCoordsT mapped_coords; // needed to deduce proper return type when wrapping
-    run(WrapExpression()(expr, mapped_coords, data), data, nb_elems);
+    ElementThreading& threading = ElementThreading::instance();
+
+    // The number of data objects must be the same on all ranks, since their destruction may involve collective communication
+    const Uint nb_threads = threading.nb_threads();
+    if(nb_threads == 1)
+    {
+      DataT data(variables, elements);
+      run(WrapExpression()(expr, mapped_coords, data), data, elements.size());
+      return;
+    }
+
+    boost::ptr_vector<DataT> thread_data;
+    for(Uint i = 0; i != nb_threads; ++i)
+      thread_data.push_back(new DataT(variables, elements));
+
+    run_threaded(WrapExpression()(expr, mapped_coords, thread_data[0]), thread_data, elements);
+
+    for(Uint i = 1; i != nb_threads; ++i)
+      thread_data[i].merge_sync(thread_data[0]);
   }
 
 private:
@@ -178,6 +265,38 @@ private:
       grammar(expr, elem, data);
     }
   }
+
+  /// Loop over the elements color by color, with each thread processing a chunk of each color
+  template<typename FilteredExprT>
+  void run_threaded(const FilteredExprT& expr, boost::ptr_vector<DataT>& thread_data, mesh::Elements& elements) const
+  {
+    const Uint nb_workers = ElementThreading::instance().nb_workers(elements.size());
+    if(nb_workers == 1)
+    {
+      run(expr, thread_data[0], elements.size());
+      return;
+    }
+
+    const ElementColoring& coloring = ElementThreading::instance().coloring(elements);
+
+    // The wrapped expression stores intermediate results, so each thread needs its own copy
+    boost::ptr_vector<FilteredExprT> thread_exprs;
+    for(Uint i = 0; i != nb_workers; ++i)
+      thread_exprs.push_back(new FilteredExprT(expr));
+
+    typedef ColoredElementWorker<FilteredExprT, DataT> WorkerT;
+    boost::barrier barrier(nb_workers);
+    ThreadedLoopErrors errors;
+    boost::thread_group threads;
+    for(Uint i = 1; i != nb_workers; ++i)
+      threads.create_thread(WorkerT(thread_exprs[i], thread_data[i], coloring, barrier, errors, i, nb_workers));
+
+    // The calling thread takes the first chunk
+    WorkerT(thread_exprs[0], thread_data[0], coloring, barrier, errors, 0, nb_workers)();
+    threads.join_all();
+
+    errors.rethrow();
+  }
 };
 
 /// When we recursed to the last variable, actually run the expression
@@ -196,9 +315,7 @@ struct ExpressionRunner<ElementTypesT, ExprT, SupportETYPE, VariablesT, Variable
       INVALID_ELEMENT_EXPRESSION,
       (ElementGrammar));
 
-    DataT data(variables, elements);
-
-    ElementLooperImpl<DataT>()(expression, data, elements.size());
+    ElementLooperImpl<DataT>()(expression, variables, elements);
   }
 
 private:
@@ -252,9 +369,7 @@ struct ElementLooper
     // Verify the types match, and throw an error if non-matching fields are found
     boost::fusion::for_each(m_variables, CheckSameEtype<ETYPE>(m_elements));
 
-    DataT data(m_variables, m_elements);
-
-    ElementLooperImpl<DataT>()(m_expr, data, m_elements.size());
+    ElementLooperImpl<DataT>()(m_expr, m_variables, m_elements);
   }
 
   /// Static dispatch in case different ETYPE are possible
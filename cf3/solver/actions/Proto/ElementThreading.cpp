@@ -0,0 +1,235 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/EventHandler.hpp"
+#include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+#include "common/Table.hpp"
+#include "common/XML/SignalOptions.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Tags.hpp"
+
+#include "ElementThreading.hpp"
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+namespace Proto {
+
+namespace detail
+{
+  /// Index of the current thread in the running element loop
+  boost::thread_specific_ptr<Uint>& thread_index_storage()
+  {
+    static boost::thread_specific_ptr<Uint> storage;
+    return storage;
+  }
+}
+
+ElementColoring::ElementColoring(const common::Table<Uint>& connectivity, const Uint nb_nodes)
+{
+  // Colors are assigned in rounds of 64, using a bit mask per node to track the colors of the adjacent elements.
+  // Elements that can't get a color in a round are deferred to the next round, which uses a fresh set of colors.
+  static const Uint colors_per_round = 64;
+
+  const Uint nb_elems = connectivity.size();
+  const Uint nb_elem_nodes = connectivity.row_size();
+
+  std::vector<Uint> colors(nb_elems, 0);
+  std::vector<Uint> uncolored(nb_elems);
+  for(Uint i = 0; i != nb_elems; ++i)
+    uncolored[i] = i;
+
+  std::vector<boost::uint64_t> node_masks(nb_nodes);
+  std::vector<Uint> deferred;
+  Uint nb_colors = 0;
+  for(Uint round_start = 0; !uncolored.empty(); round_start += colors_per_round)
+  {
+    std::fill(node_masks.begin(), node_masks.end(), 0);
+    deferred.clear();
+    Uint round_max_color = 0;
+    const Uint nb_uncolored = uncolored.size();
+    for(Uint i = 0; i != nb_uncolored; ++i)
+    {
+      const Uint elem = uncolored[i];
+      const common::Table<Uint>::ConstRow row = connectivity[elem];
+      boost::uint64_t forbidden = 0;
+      for(Uint j = 0; j != nb_elem_nodes; ++j)
+        forbidden |= node_masks[row[j]];
+
+      if(forbidden == ~boost::uint64_t(0))
+      {
+        deferred.push_back(elem);
+        continue;
+      }
+
+      Uint color = 0;
+      while(forbidden & (boost::uint64_t(1) << color))
+        ++color;
+
+      const boost::uint64_t color_bit = boost::uint64_t(1) << color;
+      for(Uint j = 0; j != nb_elem_nodes; ++j)
+        node_masks[row[j]] |= color_bit;
+
+      colors[elem] = round_start + color;
+      round_max_color = std::max(round_max_color, color+1);
+    }
+    nb_colors = round_start + round_max_color;
+    uncolored.swap(deferred);
+  }
+
+  // Bucket the elements by color, keeping ascending element order within each color
+  m_color_offsets.assign(nb_colors+1, 0);
+  for(Uint i = 0; i != nb_elems; ++i)
+    ++m_color_offsets[colors[i]+1];
+  for(Uint c = 0; c != nb_colors; ++c)
+    m_color_offsets[c+1] += m_color_offsets[c];
+
+  m_elements.resize(nb_elems);
+  std::vector<Uint> fill_positions(m_color_offsets.begin(), m_color_offsets.end()-1);
+  for(Uint i = 0; i != nb_elems; ++i)
+    m_elements[fill_positions[colors[i]]++] = i;
+}
+
+ElementThreading::ElementThreading()
+{
+  common::Core::instance().event_handler().connect_to_event(mesh::Tags::event_mesh_loaded(), this, &ElementThreading::on_mesh_event);
+  common::Core::instance().event_handler().connect_to_event(mesh::Tags::event_mesh_changed(), this, &ElementThreading::on_mesh_event);
+}
+
+ElementThreading& ElementThreading::instance()
+{
+  static ElementThreading instance;
+  return instance;
+}
+
+Uint ElementThreading::nb_threads() const
+{
+  const Uint requested = common::Core::instance().environment().options().value<Uint>("nb_threads");
+  if(requested == 0)
+    return 1;
+  return std::min(requested, static_cast<Uint>(CF3_PROTO_MAX_THREADS));
+}
+
+Uint ElementThreading::nb_workers(const Uint nb_elems) const
+{
+  return std::max(1u, std::min(nb_threads(), nb_elems / min_elements_per_thread));
+}
+
+const ElementColoring& ElementThreading::coloring(const mesh::Elements& elements)
+{
+  const common::Table<Uint>& connectivity = elements.geometry_space().connectivity();
+  const Uint nb_nodes = elements.geometry_fields().size();
+
+  const mesh::Mesh& mesh = common::find_parent_component<mesh::Mesh>(elements);
+  MeshColorings& mesh_colorings = m_colorings[&mesh];
+  if(mesh_colorings.mesh.get() != &mesh)
+  {
+    mesh_colorings.colorings.clear();
+    mesh_colorings.mesh = mesh.handle<mesh::Mesh>();
+  }
+
+  CachedColoring& cached = mesh_colorings.colorings[&elements];
+  if(!cached.coloring || cached.elements.get() != &elements || cached.connectivity != &connectivity
+     || cached.nb_elements != connectivity.size() || cached.nb_nodes != nb_nodes)
+  {
+    cached.elements = elements.handle<mesh::Elements>();
+    cached.connectivity = &connectivity;
+    cached.nb_elements = connectivity.size();
+    cached.nb_nodes = nb_nodes;
+    cached.coloring.reset(new ElementColoring(connectivity, nb_nodes));
+  }
+
+  return *cached.coloring;
+}
+
+void ElementThreading::clear()
+{
+  m_colorings.clear();
+}
+
+Uint ElementThreading::nb_cached_colorings() const
+{
+  Uint result = 0;
+  for(ColoringsT::const_iterator it = m_colorings.begin(); it != m_colorings.end(); ++it)
+    result += it->second.colorings.size();
+  return result;
+}
+
+void ElementThreading::on_mesh_event(common::SignalArgs& args)
+{
+  common::XML::SignalOptions options(args);
+  if(!options.check("mesh_uri"))
+  {
+    clear();
+    return;
+  }
+
+  // Drop the colorings of the mesh that changed, as well as those of meshes that no longer exist
+  const common::URI mesh_uri = options.value<common::URI>("mesh_uri");
+  for(ColoringsT::iterator it = m_colorings.begin(); it != m_colorings.end();)
+  {
+    if(is_null(it->second.mesh) || it->second.mesh->uri() == mesh_uri)
+      m_colorings.erase(it++);
+    else
+      ++it;
+  }
+}
+
+ThreadedLoopErrors::ThreadedLoopErrors() :
+  m_failed(false)
+{
+}
+
+bool ThreadedLoopErrors::failed() const
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  return m_failed;
+}
+
+void ThreadedLoopErrors::store(const std::string& message)
+{
+  boost::mutex::scoped_lock lock(m_mutex);
+  if(!m_failed)
+  {
+    m_failed = true;
+    m_message = message;
+  }
+}
+
+void ThreadedLoopErrors::rethrow() const
+{
+  if(m_failed)
+    throw common::ParallelError(FromHere(), "Error in threaded element loop: " + m_message);
+}
+
+Uint ElementThreading::thread_index()
+{
+  const Uint* idx = detail::thread_index_storage().get();
+  return is_null(idx) ? 0 : *idx;
+}
+
+void ElementThreading::set_thread_index(const Uint idx)
+{
+  detail::thread_index_storage().reset(new Uint(idx));
+}
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
@@ -0,0 +1,226 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_Proto_ElementThreading_hpp
+#define cf3_solver_actions_Proto_ElementThreading_hpp
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "common/CF.hpp"
+#include "common/ConnectionManager.hpp"
+#include "common/Handle.hpp"
+#include "common/SignalHandler.hpp"
+#include "common/Table_fwd.hpp"
+
+#include "math/MatrixTypes.hpp"
+
+#include "solver/actions/LibActions.hpp"
+
+/// @file
+/// Support for shared-memory threaded loops over elements. Threading is opt-in through the nb_threads option of the environment.
+
+// Maximum number of threads that can be used in a threaded element loop
+#ifndef CF3_PROTO_MAX_THREADS
+  #define CF3_PROTO_MAX_THREADS 128
+#endif
+
+namespace cf3 {
+  namespace mesh { class Elements; class Mesh; }
+namespace solver {
+namespace actions {
+namespace Proto {
+
+/// Partition of the elements of a connectivity table into colors, so that no two elements of the same color share a node.
+/// All elements of one color can then be processed concurrently without races on nodal data or matrix rows.
+class solver_actions_API ElementColoring
+{
+public:
+  /// Build a greedy coloring
+  /// @param connectivity The element-to-node connectivity
+  /// @param nb_nodes The number of nodes referred to by the connectivity
+  ElementColoring(const common::Table<Uint>& connectivity, const Uint nb_nodes);
+
+  /// Number of colors
+  Uint nb_colors() const
+  {
+    return m_color_offsets.size() - 1;
+  }
+
+  /// Index in the colored ordering of the first element with the given color
+  Uint color_begin(const Uint color) const
+  {
+    return m_color_offsets[color];
+  }
+
+  /// Index in the colored ordering one past the last element with the given color
+  Uint color_end(const Uint color) const
+  {
+    return m_color_offsets[color+1];
+  }
+
+  /// Element index at position i of the colored ordering
+  Uint element(const Uint i) const
+  {
+    return m_elements[i];
+  }
+
+private:
+  /// Start of each color in m_elements, with one extra entry for the end
+  std::vector<Uint> m_color_offsets;
+  /// Element indices, ordered by color and ascending within a color
+  std::vector<Uint> m_elements;
+};
+
+/// Settings and shared data for threaded element loops.
+/// Colorings are cached per mesh, and dropped when that mesh is loaded or changed.
+class solver_actions_API ElementThreading : public boost::noncopyable, public common::ConnectionManager
+{
+public:
+  /// Singleton implementation
+  static ElementThreading& instance();
+
+  /// Number of threads requested through the nb_threads option of the environment, limited to CF3_PROTO_MAX_THREADS.
+  /// This is the same on all ranks, so it may be used to decide on collective operations.
+  Uint nb_threads() const;
+
+  /// Number of threads that will effectively work on a block of nb_elems elements
+  Uint nb_workers(const Uint nb_elems) const;
+
+  /// Coloring of the given elements, computed on first use and recomputed when the connectivity changed
+  const ElementColoring& coloring(const mesh::Elements& elements);
+
+  /// Forget all colorings
+  void clear();
+
+  /// Number of colorings that are currently cached
+  Uint nb_cached_colorings() const;
+
+  /// Index of the calling thread in the running element loop, 0 for the main thread
+  static Uint thread_index();
+
+  /// Set the index of the calling thread. Used by the element looper when it starts its worker threads
+  static void set_thread_index(const Uint idx);
+
+  /// Minimum number of elements that each thread handles
+  static const Uint min_elements_per_thread = 256;
+
+private:
+  ElementThreading();
+
+  /// Called on mesh_loaded and mesh_changed
+  void on_mesh_event(common::SignalArgs& args);
+
+  /// Coloring cache entry
+  struct CachedColoring
+  {
+    Handle<mesh::Elements const> elements;
+    const common::Table<Uint>* connectivity;
+    Uint nb_elements;
+    Uint nb_nodes;
+    boost::shared_ptr<ElementColoring> coloring;
+  };
+
+  /// Colorings of the elements of one mesh
+  struct MeshColorings
+  {
+    /// Detects a mesh that was deleted and replaced by a new one at the same address
+    Handle<mesh::Mesh const> mesh;
+    std::map<const mesh::Elements*, CachedColoring> colorings;
+  };
+
+  typedef std::map<const mesh::Mesh*, MeshColorings> ColoringsT;
+  ColoringsT m_colorings;
+};
+
+/// Collects the first error raised in any of the threads of a loop, so it can be rethrown from the calling thread
+class solver_actions_API ThreadedLoopErrors : public boost::noncopyable
+{
+public:
+  ThreadedLoopErrors();
+
+  /// True if an error was stored
+  bool failed() const;
+
+  /// Store an error message. Only the first message is kept.
+  void store(const std::string& message);
+
+  /// Throw a ParallelError with the stored message, if any
+  void rethrow() const;
+
+private:
+  mutable boost::mutex m_mutex;
+  bool m_failed;
+  std::string m_message;
+};
+
+/// Value with a separate copy for each thread of an element loop. Use it instead of a plain value to store intermediate
+/// per-element results (i.e. stabilization coefficients) or partial reductions that are referred to in a threaded expression.
+/// Reductions are completed after the loop by combining value(i) for all i < CF3_PROTO_MAX_THREADS.
+template<typename T>
+class ThreadLocal
+{
+public:
+  typedef T value_type;
+
+  ThreadLocal(const T& init = T())
+  {
+    set_all(init);
+  }
+
+  /// Value for the calling thread
+  T& get()
+  {
+    return m_values[ElementThreading::thread_index()].value;
+  }
+
+  /// Value for the calling thread
+  const T& get() const
+  {
+    return m_values[ElementThreading::thread_index()].value;
+  }
+
+  /// Value for the thread with the given index
+  const T& value(const Uint thread_idx) const
+  {
+    return m_values[thread_idx].value;
+  }
+
+  /// Set the value of all threads, i.e. to initialize a reduction
+  void set_all(const T& init)
+  {
+    for(Uint i = 0; i != CF3_PROTO_MAX_THREADS; ++i)
+      m_values[i].value = init;
+  }
+
+private:
+  /// Each value occupies its own cache line, to avoid false sharing between threads
+  struct PaddedValue
+  {
+    T value;
+    char padding[64 - sizeof(T)];
+  };
+
+  PaddedValue m_values[CF3_PROTO_MAX_THREADS];
+};
+
+/// Real value with a copy per thread
+typedef ThreadLocal<Real> ThreadLocalReal;
+
+/// Dynamic-size vector with a copy per thread
+typedef ThreadLocal<RealVector> ThreadLocalVector;
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
+
+#endif // cf3_solver_actions_Proto_ElementThreading_hpp
@@ -30,18 +30,41 @@ void FieldSynchronizer::insert(cf3::mesh::Field& f)
 }
 
 void FieldSynchronizer::synchronize()
+{
+  start_synchronize();
+  finish_synchronize();
+}
+
+void FieldSynchronizer::start_synchronize()
 {
   if(common::PE::Comm::instance().is_active())
   {
     for(FieldsT::iterator field_it = m_fields.begin(); field_it != m_fields.end(); ++field_it)
     {
-      field_it->second->synchronize();
+      // A field that is still in flight must be completed before its new values can be sent
+      FieldsT::iterator pending_it = m_pending_fields.find(field_it->first);
+      if(pending_it != m_pending_fields.end())
+        pending_it->second->finish_synchronize();
+
+      field_it->second->start_synchronize();
+      m_pending_fields[field_it->first] = field_it->second;
     }
   }
 
   m_fields.clear();
 }
 
+void FieldSynchronizer::finish_synchronize()
+{
+  for(FieldsT::iterator field_it = m_pending_fields.begin(); field_it != m_pending_fields.end(); ++field_it)
+  {
+    if(is_not_null(field_it->second))
+      field_it->second->finish_synchronize();
+  }
+
+  m_pending_fields.clear();
+}
+
 } // namespace Proto
 } // namespace actions
 } // namespace solver
@@ -31,6 +31,13 @@ public:
   /// Sync fields and clear the list
   void synchronize();
 
+  /// Start the synchronization of the inserted fields and clear the list, so computations that don't
+  /// use ghost values can proceed while the data is in flight
+  void start_synchronize();
+
+  /// Wait for the synchronizations started by start_synchronize to complete
+  void finish_synchronize();
+
 private:
   FieldSynchronizer();
 
@@ -38,6 +45,9 @@ private:
   // on each cpu.
   typedef std::map< std::string, Handle<mesh::Field> > FieldsT;
   FieldsT m_fields;
+
+  /// Fields for which the synchronization was started but not finished
+  FieldsT m_pending_fields;
 };
 
 
@@ -49,7 +49,9 @@ pow(Arg const &arg)
   );
 }
 
-/// Primitive transform to evaluate a function with the function parser
+/// Primitive transform to evaluate a function with the function parser.
+/// The expressions visit one node or element at a time, so the function is evaluated for one point per call.
+/// VectorialFunction::evaluate_batch is not used here: a function boundary condition still runs the parser once per node.
 struct ParsedVectorFunctionTransform :
   boost::proto::transform< ParsedVectorFunctionTransform >
 {
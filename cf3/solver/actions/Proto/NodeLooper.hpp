@@ -12,6 +12,7 @@
 #include "FieldSync.hpp"
 #include "NodeData.hpp"
 #include "NodeGrammar.hpp"
+#include "UsedNodesCache.hpp"
 
 /// @file
 /// Loop over the nodes for a region
@@ -140,16 +141,7 @@ private:
   {
     NodeGrammar grammar;
 
-    // Build a list of used entities
-    std::vector< Handle<mesh::Entities const> > used_entities;
-    BOOST_FOREACH(const mesh::Entities& entities, common::find_components_recursively<mesh::Entities>(m_region))
-    {
-      used_entities.push_back(entities.handle<mesh::Entities>());
-    }
-
-    boost::shared_ptr< common::List<Uint> > used_nodes_ptr = mesh::build_used_nodes_list(used_entities, dict, true);
-
-    const common::List<Uint>& nodes = *used_nodes_ptr;
+    const common::List<Uint>& nodes = UsedNodesCache::instance().used_nodes(m_region, dict);
     const Uint nb_nodes = nodes.size();
     for(Uint i = 0; i != nb_nodes; ++i)
     {
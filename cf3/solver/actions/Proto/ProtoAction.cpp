@@ -11,6 +11,7 @@
 #include "common/Builder.hpp"
 #include "common/Log.hpp"
 #include "common/OptionComponent.hpp"
+#include "common/PropertyList.hpp"
 #include "common/URI.hpp"
 
 #include "mesh/Region.hpp"
@@ -21,6 +22,7 @@
 
 #include "ProtoAction.hpp"
 #include "Expression.hpp"
+#include "UsedNodesCache.hpp"
 
 namespace cf3 {
 namespace solver {
@@ -107,6 +109,8 @@ ProtoAction::ProtoAction(const std::string& name) :
   Action(name),
   m_implementation(new Implementation(*this, m_physical_model))
 {
+  // Number of times a node loop in this action had to build its list of nodes, should stay constant while the mesh doesn't change
+  properties().add("used_nodes_builds", Uint(0));
 }
 
 ProtoAction::~ProtoAction()
@@ -118,6 +122,8 @@ void ProtoAction::execute()
   if(m_loop_regions.empty())
     CFwarn << "No regions to loop over for action " << uri().string() << CFendl;
 
+  const Uint nb_builds_before = UsedNodesCache::instance().nb_builds();
+
   boost_foreach(const Handle< Region >& region, m_loop_regions)
   {
     if(is_null(m_implementation->m_expression))
@@ -125,6 +131,8 @@ void ProtoAction::execute()
     CFdebug << "  Action " << name() << ": running over region " << region->uri().path() << CFendl;
     m_implementation->m_expression->loop(*region);
   }
+
+  properties()["used_nodes_builds"] = properties().value<Uint>("used_nodes_builds") + UsedNodesCache::instance().nb_builds() - nb_builds_before;
 }
 
 void ProtoAction::set_expression(const boost::shared_ptr< Expression >& expression)
@@ -22,6 +22,7 @@
 #include <boost/proto/context/callable.hpp>
 #include <boost/proto/context/null.hpp>
 
+#include "ElementThreading.hpp"
 #include "Functions.hpp"
 #include "Terminals.hpp"
 
@@ -160,6 +161,30 @@ struct Integers :
 {
 };
 
+/// Returns the value of a ThreadLocal terminal for the current thread
+struct ThreadLocalValue :
+  boost::proto::transform< ThreadLocalValue >
+{
+  template<typename ExprT, typename StateT, typename DataT>
+  struct impl : boost::proto::transform_impl<ExprT, StateT, DataT>
+  {
+    typedef typename boost::remove_const
+    <
+      typename boost::remove_reference
+      <
+        typename boost::proto::result_of::value<ExprT>::type
+      >::type
+    >::type ThreadLocalT;
+
+    typedef typename ThreadLocalT::value_type& result_type;
+
+    result_type operator ()(typename impl::expr_param expr, typename impl::state_param, typename impl::data_param) const
+    {
+      return const_cast<ThreadLocalT&>(boost::proto::value(expr)).get();
+    }
+  };
+};
+
 /// Matches scalar terminals
 struct Scalar :
   boost::proto::or_
@@ -169,6 +194,11 @@ struct Scalar :
     <
       boost::proto::or_< boost::proto::terminal<Real> >, // Plain scalar
       boost::proto::_value
+    >,
+    boost::proto::when
+    <
+      boost::proto::terminal<ThreadLocalReal>, // Scalar with a value per thread
+      ThreadLocalValue
     >
   >
 {
@@ -199,6 +229,11 @@ struct MathTerminals :
     <
       MatVec,
       boost::proto::_value
+    >,
+    boost::proto::when
+    <
+      boost::proto::terminal<ThreadLocalVector>, // Vector with a value per thread
+      ThreadLocalValue
     >
   >
 {
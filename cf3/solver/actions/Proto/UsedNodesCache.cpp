@@ -0,0 +1,78 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <boost/bind.hpp>
+
+#include "common/Core.hpp"
+#include "common/EventHandler.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Log.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Functions.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Tags.hpp"
+
+#include "UsedNodesCache.hpp"
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+namespace Proto {
+
+UsedNodesCache::UsedNodesCache() :
+  m_nb_builds(0)
+{
+  common::Core::instance().event_handler().connect_to_event(mesh::Tags::event_mesh_loaded(), this, &UsedNodesCache::on_mesh_event);
+  common::Core::instance().event_handler().connect_to_event(mesh::Tags::event_mesh_changed(), this, &UsedNodesCache::on_mesh_event);
+}
+
+UsedNodesCache& UsedNodesCache::instance()
+{
+  static UsedNodesCache instance;
+  return instance;
+}
+
+const common::List<Uint>& UsedNodesCache::used_nodes(const mesh::Region& region, const mesh::Dictionary& dict)
+{
+  Entry& entry = m_entries[std::make_pair(&region, &dict)];
+
+  // The handles detect a region or dictionary that was deleted and replaced by a new one at the same address
+  if(is_not_null(entry.nodes) && entry.region.get() == &region && entry.dict.get() == &dict && entry.dict_size == dict.size())
+    return *entry.nodes;
+
+  std::vector< Handle<mesh::Entities const> > used_entities;
+  BOOST_FOREACH(const mesh::Entities& entities, common::find_components_recursively<mesh::Entities>(region))
+  {
+    used_entities.push_back(entities.handle<mesh::Entities>());
+  }
+
+  entry.region = region.handle<mesh::Region>();
+  entry.dict = dict.handle<mesh::Dictionary>();
+  entry.dict_size = dict.size();
+  entry.nodes = mesh::build_used_nodes_list(used_entities, dict, true);
+  ++m_nb_builds;
+
+  CFdebug << "Built the list of " << entry.nodes->size() << " nodes used by " << region.uri().path() << " in " << dict.uri().path() << CFendl;
+
+  return *entry.nodes;
+}
+
+void UsedNodesCache::clear()
+{
+  m_entries.clear();
+}
+
+void UsedNodesCache::on_mesh_event(common::SignalArgs& args)
+{
+  clear();
+}
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
@@ -0,0 +1,75 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_Proto_UsedNodesCache_hpp
+#define cf3_solver_actions_Proto_UsedNodesCache_hpp
+
+#include <map>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "common/ConnectionManager.hpp"
+#include "common/Handle.hpp"
+#include "common/List.hpp"
+#include "common/SignalHandler.hpp"
+
+#include "solver/actions/LibActions.hpp"
+
+/// @file
+/// Cache for the list of nodes visited by node expressions
+
+namespace cf3 {
+namespace mesh { class Dictionary; class Region; }
+namespace solver {
+namespace actions {
+namespace Proto {
+
+/// Keeps the list of nodes used by a region in a dictionary, so node loops don't rebuild it on each execution.
+/// All lists are dropped when a mesh is loaded or changed.
+class solver_actions_API UsedNodesCache : public boost::noncopyable, public common::ConnectionManager
+{
+public:
+
+  /// Singleton implementation
+  static UsedNodesCache& instance();
+
+  /// Sorted list of the nodes in dict that are used by the elements in region, ghost elements included
+  const common::List<Uint>& used_nodes(const mesh::Region& region, const mesh::Dictionary& dict);
+
+  /// Forget all lists
+  void clear();
+
+  /// Number of times a list was built since the start of the program
+  Uint nb_builds() const { return m_nb_builds; }
+
+private:
+  UsedNodesCache();
+
+  /// Called on mesh_loaded and mesh_changed
+  void on_mesh_event(common::SignalArgs& args);
+
+  struct Entry
+  {
+    Handle<mesh::Region const> region;
+    Handle<mesh::Dictionary const> dict;
+    /// size of the dictionary when the list was built
+    Uint dict_size;
+    boost::shared_ptr< common::List<Uint> > nodes;
+  };
+
+  typedef std::map< std::pair<const mesh::Region*, const mesh::Dictionary*>, Entry > EntriesT;
+  EntriesT m_entries;
+
+  Uint m_nb_builds;
+};
+
+} // namespace Proto
+} // namespace actions
+} // namespace solver
+} // namespace cf3
+
+#endif // cf3_solver_actions_Proto_UsedNodesCache_hpp
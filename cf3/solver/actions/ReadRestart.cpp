@@ -0,0 +1,161 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include <algorithm>
+
+#include "common/Builder.hpp"
+#include "common/OptionT.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionComponent.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Foreach.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
+#include "common/Log.hpp"
+
+#include "mesh/MeshReader.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+
+#include "solver/Tags.hpp"
+#include "solver/Time.hpp"
+#include "solver/TimeStepping.hpp"
+
+#include "ReadRestart.hpp"
+
+
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < ReadRestart, common::Action, LibActions > ReadRestart_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+ReadRestart::ReadRestart ( const std::string& name ) : solver::Action(name)
+{
+  mark_basic();
+
+  properties()["brief"] = std::string("Read a restart file");
+  properties()["description"] = std::string("Reads the mesh, its fields and the time state written by WriteRestart");
+
+  options().add( "file", URI("file:restart.cf3mesh") )
+      .pretty_name("File")
+      .description("Path of the restart file, as given to WriteRestart")
+      .mark_basic();
+
+  options().add(solver::Tags::time(), m_time)
+      .pretty_name("Time")
+      .description("Time component to restore, optional")
+      .link_to(&m_time)
+      .mark_basic();
+
+  options().add("time_stepping", m_time_stepping)
+      .pretty_name("Time Stepping")
+      .description("Time stepping component to restore, optional")
+      .link_to(&m_time_stepping);
+
+  m_reader = Handle<MeshReader>(create_component("reader", "cf3.mesh.cf3mesh.Reader"));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void ReadRestart::execute()
+{
+  const URI file = options().value<URI>("file");
+
+  if (mesh().elements().empty())
+  {
+    m_reader->read_mesh_into(file, mesh());
+    restore_time(mesh());
+    CFinfo << "Read restart mesh " << file.path() << " into " << mesh().uri().path() << CFendl;
+    return;
+  }
+
+  // The mesh is already set up, only the field values are taken from the restart file
+  Handle<Mesh> restart_mesh = create_component<Mesh>("restart_mesh");
+  try
+  {
+    m_reader->read_mesh_into(file, *restart_mesh);
+    copy_fields(*restart_mesh);
+    restore_time(*restart_mesh);
+  }
+  catch(...)
+  {
+    remove_component(*restart_mesh);
+    throw;
+  }
+  remove_component(*restart_mesh);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void ReadRestart::copy_fields(const Mesh& restart_mesh)
+{
+  Uint nb_copied = 0;
+  boost_foreach(const Dictionary& restart_dict, find_components<Dictionary>(restart_mesh))
+  {
+    Handle<Dictionary> dict(mesh().get_child(restart_dict.name()));
+    if (is_null(dict))
+    {
+      CFwarn << "Restart file has dictionary " << restart_dict.name() << ", which is not in " << mesh().uri().path() << CFendl;
+      continue;
+    }
+
+    if (dict->size() != restart_dict.size() ||
+        !std::equal(restart_dict.glb_idx().array().begin(), restart_dict.glb_idx().array().end(), dict->glb_idx().array().begin()))
+      throw SetupError(FromHere(), "Dictionary " + dict->uri().string() + " is numbered differently than in the restart file, the partitioning must be the same");
+
+    boost_foreach(const Field& restart_field, find_components<Field>(restart_dict))
+    {
+      Handle<Field> field(dict->get_child(restart_field.name()));
+      if (is_null(field))
+      {
+        CFwarn << "Restart file has field " << restart_field.name() << ", which is not in " << dict->uri().path() << CFendl;
+        continue;
+      }
+      if (field->row_size() != restart_field.row_size())
+        throw SetupError(FromHere(), "Field " + field->uri().string() + " has " + to_str(field->row_size()) + " columns, while the restart file has " + to_str(restart_field.row_size()));
+
+      field->array() = restart_field.array();
+      ++nb_copied;
+    }
+  }
+
+  CFinfo << "Restored " << nb_copied << " fields of " << mesh().uri().path() << " from " << options().value<URI>("file").path() << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void ReadRestart::restore_time(const Mesh& restart_mesh)
+{
+  const MeshMetadata& metadata = restart_mesh.metadata();
+  if (is_not_null(m_time) && metadata.check("time_step"))
+  {
+    m_time->options().set("iteration", metadata.properties().value<Uint>("iter"));
+    m_time->options().set("current_time", metadata.properties().value<Real>("time"));
+    m_time->options().set("time_step", metadata.properties().value<Real>("time_step"));
+  }
+  if (is_not_null(m_time_stepping) && metadata.check("time_stepping.step"))
+  {
+    m_time_stepping->options().set("step", metadata.properties().value<Uint>("time_stepping.step"));
+    m_time_stepping->options().set("time", metadata.properties().value<Real>("time_stepping.time"));
+    m_time_stepping->options().set("walltime", metadata.properties().value<Real>("time_stepping.walltime"));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
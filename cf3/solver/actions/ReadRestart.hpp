@@ -0,0 +1,64 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_ReadRestart_hpp
+#define cf3_solver_actions_ReadRestart_hpp
+
+#include "solver/actions/LibActions.hpp"
+#include "solver/Action.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh   { class Mesh; class MeshReader; }
+namespace solver {
+  class Time;
+  class TimeStepping;
+namespace actions {
+
+/// Reads a checkpoint written by WriteRestart, using the same number of processes.
+/// If the configured mesh is empty, the complete mesh is read into it. Otherwise the mesh must have the
+/// same partitioning as the one that was written, and the values of its fields are overwritten with the
+/// stored ones. The time and time stepping components are reset to the stored time state.
+class solver_actions_API ReadRestart : public solver::Action {
+
+public: // functions
+  /// Contructor
+  /// @param name of the component
+  ReadRestart ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~ReadRestart() {}
+
+  /// Get the class name
+  static std::string type_name () { return "ReadRestart"; }
+
+  /// execute the action
+  virtual void execute ();
+
+private: // functions
+
+  /// Copy the fields of the restart mesh into the fields with the same dictionary and field names in the configured mesh
+  void copy_fields(const mesh::Mesh& restart_mesh);
+
+  /// Restore the time state from the metadata of the given mesh
+  void restore_time(const mesh::Mesh& restart_mesh);
+
+private: // data
+
+  Handle<solver::Time> m_time;                  ///< time state to restore, optional
+  Handle<solver::TimeStepping> m_time_stepping; ///< time stepping state to restore, optional
+  Handle<mesh::MeshReader> m_reader;            ///< the cf3mesh reader
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
+
+#endif // cf3_solver_actions_ReadRestart_hpp
@@ -0,0 +1,113 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#include "common/Builder.hpp"
+#include "common/OptionT.hpp"
+#include "common/OptionList.hpp"
+#include "common/OptionComponent.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Foreach.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Log.hpp"
+
+#include "mesh/MeshWriter.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Field.hpp"
+
+#include "solver/Tags.hpp"
+#include "solver/Time.hpp"
+#include "solver/TimeStepping.hpp"
+
+#include "WriteRestart.hpp"
+
+
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+namespace cf3 {
+namespace solver {
+namespace actions {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+common::ComponentBuilder < WriteRestart, common::Action, LibActions > WriteRestart_Builder;
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+WriteRestart::WriteRestart ( const std::string& name ) : solver::Action(name)
+{
+  mark_basic();
+
+  properties()["brief"] = std::string("Write a restart file");
+  properties()["description"] = std::string("Writes the mesh, all its fields and the time state in the native binary format, one file per process");
+
+  options().add( "file", URI("file:restart.cf3mesh") )
+      .pretty_name("File")
+      .description("Path of the restart file. Each process adds _P<rank> to the file name")
+      .mark_basic();
+
+  options().add(solver::Tags::time(), m_time)
+      .pretty_name("Time")
+      .description("Time component of which the state is stored, optional")
+      .link_to(&m_time)
+      .mark_basic();
+
+  options().add("time_stepping", m_time_stepping)
+      .pretty_name("Time Stepping")
+      .description("Time stepping component of which the state is stored, optional")
+      .link_to(&m_time_stepping);
+
+  options().add( "interval", 1u )
+      .pretty_name("Interval")
+      .description("Number of iterations of the time component between writes. 0 disables writing")
+      .mark_basic();
+
+  m_writer = Handle<MeshWriter>(create_component("writer", "cf3.mesh.cf3mesh.Writer"));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////
+
+void WriteRestart::execute()
+{
+  const Uint interval = options().value<Uint>("interval");
+  if (interval == 0)
+    return;
+  if (is_not_null(m_time) && m_time->iter() % interval != 0)
+    return;
+
+  MeshMetadata& metadata = mesh().metadata();
+  if (is_not_null(m_time))
+  {
+    metadata["time"] = m_time->current_time();
+    metadata["iter"] = m_time->iter();
+    metadata.properties()["time_step"] = m_time->dt();
+  }
+  if (is_not_null(m_time_stepping))
+  {
+    metadata.properties()["time_stepping.step"] = m_time_stepping->options().value<Uint>("step");
+    metadata.properties()["time_stepping.time"] = m_time_stepping->options().value<Real>("time");
+    metadata.properties()["time_stepping.walltime"] = m_time_stepping->options().value<Real>("walltime");
+  }
+
+  std::vector<URI> fields;
+  boost_foreach(const Field& field, find_components_recursively<Field>( mesh() ) )
+  {
+    fields.push_back(field.uri());
+  }
+  m_writer->options().set("fields", fields);
+
+  const URI file = options().value<URI>("file");
+  m_writer->write_from_to(mesh(), file);
+
+  CFinfo << "Wrote restart file " << file.path() << " with " << fields.size() << " fields" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
@@ -0,0 +1,55 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_solver_actions_WriteRestart_hpp
+#define cf3_solver_actions_WriteRestart_hpp
+
+#include "solver/actions/LibActions.hpp"
+#include "solver/Action.hpp"
+
+/////////////////////////////////////////////////////////////////////////////////////
+
+namespace cf3 {
+namespace mesh   { class MeshWriter; }
+namespace solver {
+  class Time;
+  class TimeStepping;
+namespace actions {
+
+/// Writes a checkpoint of the mesh, all its fields and the time state, to be read back by ReadRestart.
+/// Each rank writes its own part in the native binary cf3mesh format. The time state is stored in the
+/// mesh metadata as "time", "iter", "time_step", "time_stepping.step", "time_stepping.time" and "time_stepping.walltime".
+class solver_actions_API WriteRestart : public solver::Action {
+
+public: // functions
+  /// Contructor
+  /// @param name of the component
+  WriteRestart ( const std::string& name );
+
+  /// Virtual destructor
+  virtual ~WriteRestart() {}
+
+  /// Get the class name
+  static std::string type_name () { return "WriteRestart"; }
+
+  /// execute the action
+  virtual void execute ();
+
+private: // data
+
+  Handle<solver::Time> m_time;                  ///< time state to store, optional
+  Handle<solver::TimeStepping> m_time_stepping; ///< time stepping state to store, optional
+  Handle<mesh::MeshWriter> m_writer;            ///< the cf3mesh writer
+
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+} // actions
+} // solver
+} // cf3
+
+#endif // cf3_solver_actions_WriteRestart_hpp
@@ -146,6 +146,9 @@ function( coolfluid_add_test )
   # check if scaling test will be created
 
   set( _TEST_SCALING OFF)
+  if( _PAR_SCALING AND _RUN_MPI AND CF3_MPI_TESTS_RUN_SCALABILITY )
+    set( _TEST_SCALING ON)
+  endif()
 
   # separate the source files and remove them from the orphan list
 
@@ -0,0 +1,105 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+/// @file DataBatch.hpp
+/// @brief Primitive variables and fluid flow parameters of W states, stored per variable
+
+#ifndef cf3_physics_euler_euler2d_DataBatch_hpp
+#define cf3_physics_euler_euler2d_DataBatch_hpp
+
+#include <cmath>
+
+#include "cf3/math/Defs.hpp"
+#include "cf3/physics/euler/euler2d/Data.hpp"
+
+namespace cf3 {
+namespace physics {
+namespace euler {
+namespace euler2d {
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Data of W states in structure-of-arrays layout
+///
+/// Every variable of Data is an array of W lanes, so the loops over the lanes in
+/// FunctionsBatch.hpp are vectorized by the compiler. W is typically the number of
+/// doubles in a SIMD register: 4 for AVX2, 8 for AVX-512.
+template < Uint W >
+struct DataBatch
+{
+  enum { NLANES = W };
+
+  Real cons[NEQS][W];       ///< conservative variables
+
+  /// @name Gas constants
+  //@{
+  Real gamma[W];            ///< specific heat ratio
+  Real R[W];                ///< gas constant
+  //@}
+
+  Real rho[W];              ///< density
+  Real U[NDIM][W];          ///< velocity
+  Real U2[W];               ///< velocity squared
+  Real H[W];                ///< specific enthalpy
+  Real c2[W];               ///< square of speed of sound
+  Real c[W];                ///< speed of sound
+  Real p[W];                ///< pressure
+  Real T[W];                ///< temperature
+  Real E[W];                ///< specific total energy
+  Real M[W];                ///< Mach number
+
+  /// @brief Copy a state into a lane
+  void set(const Uint lane, const Data& data)
+  {
+    for (Uint eq=0; eq<NEQS; ++eq)
+      cons[eq][lane] = data.cons[eq];
+    gamma[lane] = data.gamma;
+    R[lane]     = data.R;
+    rho[lane]   = data.rho;
+    U[XX][lane] = data.U[XX];
+    U[YY][lane] = data.U[YY];
+    U2[lane]    = data.U2;
+    H[lane]     = data.H;
+    c2[lane]    = data.c2;
+    c[lane]     = data.c;
+    p[lane]     = data.p;
+    T[lane]     = data.T;
+    E[lane]     = data.E;
+    M[lane]     = data.M;
+  }
+
+  /// @brief Compute the data of all lanes given conservative states, as Data::compute_from_conservative
+  /// @pre gamma and R must have been set
+  void compute_from_conservative(const Real (&_cons)[NEQS][W])
+  {
+    for (Uint eq=0; eq<NEQS; ++eq)
+      for (Uint i=0; i<W; ++i)
+        cons[eq][i] = _cons[eq][i];
+    for (Uint i=0; i<W; ++i)
+    {
+      rho[i]=cons[0][i];
+      U[XX][i]=cons[1][i]/rho[i];
+      U[YY][i]=cons[2][i]/rho[i];
+      E[i]=cons[3][i]/rho[i];
+      U2[i]=U[XX][i]*U[XX][i] + U[YY][i]*U[YY][i];
+      p[i]=(gamma[i]-1.)*rho[i]*(E[i] - 0.5*U2[i]);
+      H[i]=E[i]+p[i]/rho[i];
+      c2[i]=gamma[i]*p[i]/rho[i];
+      c[i]=std::sqrt(c2[i]);
+      M[i]=std::sqrt(U2[i])/c[i];
+      T[i]=p[i]/(rho[i]*R[i]);
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+} // euler2d
+} // euler
+} // physics
+} // cf3
+
+#endif // cf3_physics_euler_euler2d_DataBatch_hpp
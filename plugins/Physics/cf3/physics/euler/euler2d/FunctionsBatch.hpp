@@ -0,0 +1,225 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+/// @file FunctionsBatch.hpp
+/// @brief Functions describing Euler 2D physics, for W faces at once
+///
+/// Each function computes the same values as its counterpart in Functions.hpp, for W faces
+/// stored in structure-of-arrays layout: normal[d][i] is component d of the normal of face i,
+/// and flux[eq][i] receives equation eq of the flux through face i.
+/// The loops over the faces have a compile-time trip count and no branches, so the compiler
+/// turns them into SIMD instructions of the target architecture; W should be a multiple of
+/// the SIMD width (4 for AVX2, 8 for AVX-512).
+
+#ifndef cf3_physics_euler_euler2d_FunctionsBatch_hpp
+#define cf3_physics_euler_euler2d_FunctionsBatch_hpp
+
+#include <algorithm>
+#include <cmath>
+
+#include "cf3/physics/euler/euler2d/DataBatch.hpp"
+
+namespace cf3 {
+namespace physics {
+namespace euler {
+namespace euler2d {
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Convective flux in conservative form
+template < Uint W >
+void compute_convective_flux( const DataBatch<W>& p, const Real (&normal)[NDIM][W],
+                              Real (&flux)[NEQS][W] )
+{
+  for (Uint i=0; i<W; ++i)
+  {
+    const Real un = p.U[XX][i]*normal[XX][i] + p.U[YY][i]*normal[YY][i];
+    const Real rho_un = p.rho[i] * un;
+    flux[0][i] = rho_un;
+    flux[1][i] = rho_un * p.U[XX][i] + p.p[i] * normal[XX][i];
+    flux[2][i] = rho_un * p.U[YY][i] + p.p[i] * normal[YY][i];
+    flux[3][i] = rho_un * p.H[i];
+  }
+}
+
+/// @brief Maximum absolute wave speed
+template < Uint W >
+void compute_convective_wave_speed( const DataBatch<W>& p, const Real (&normal)[NDIM][W],
+                                    Real (&wave_speed)[W] )
+{
+  for (Uint i=0; i<W; ++i)
+    wave_speed[i] = std::abs(p.U[XX][i]*normal[XX][i] + p.U[YY][i]*normal[YY][i]) + p.c[i];
+}
+
+/// @brief Convective flux in conservative form, and maximum absolute wave speed
+template < Uint W >
+void compute_convective_flux( const DataBatch<W>& p, const Real (&normal)[NDIM][W],
+                              Real (&flux)[NEQS][W], Real (&wave_speed)[W] )
+{
+  compute_convective_flux(p,normal,flux);
+  compute_convective_wave_speed(p,normal,wave_speed);
+}
+
+/// @brief Linearize a left and right state using the Roe average
+/// @note Only gamma, rho, U, H, U2, c2, p and c are computed, as in the single state version
+template < Uint W >
+void compute_roe_average( const DataBatch<W>& left, const DataBatch<W>& right,
+                          DataBatch<W>& roe )
+{
+  for (Uint i=0; i<W; ++i)
+  {
+    const Real sqrt_rhoL = std::sqrt(left.rho[i]);
+    const Real sqrt_rhoR = std::sqrt(right.rho[i]);
+    roe.gamma[i] = 0.5*(left.gamma[i]+right.gamma[i]);
+    roe.rho[i]   = sqrt_rhoL*sqrt_rhoR;
+    roe.U[XX][i] = (sqrt_rhoL*left.U[XX][i] + sqrt_rhoR*right.U[XX][i]) / (sqrt_rhoL + sqrt_rhoR);
+    roe.U[YY][i] = (sqrt_rhoL*left.U[YY][i] + sqrt_rhoR*right.U[YY][i]) / (sqrt_rhoL + sqrt_rhoR);
+    roe.H[i]     = (sqrt_rhoL*left.H[i] + sqrt_rhoR*right.H[i]) / (sqrt_rhoL + sqrt_rhoR);
+    roe.U2[i]    = roe.U[XX][i]*roe.U[XX][i] + roe.U[YY][i]*roe.U[YY][i];
+    roe.c2[i]    = (roe.gamma[i]-1.)*(roe.H[i]-0.5*roe.U2[i]);
+    roe.p[i]     = roe.c2[i] * roe.rho[i] / roe.gamma[i];
+    roe.c[i]     = std::sqrt(roe.c2[i]);
+  }
+}
+
+/// @brief Rusanov Approximate Riemann solver
+/// @note Very fast, but very dissipative
+template < Uint W >
+void compute_rusanov_flux( const DataBatch<W>& left, const DataBatch<W>& right, const Real (&normal)[NDIM][W],
+                           Real (&flux)[NEQS][W], Real (&wave_speed)[W] )
+{
+  Real left_flux[NEQS][W], right_flux[NEQS][W];
+  Real left_wave_speed[W], right_wave_speed[W];
+  compute_convective_flux( left,  normal, left_flux,  left_wave_speed );
+  compute_convective_flux( right, normal, right_flux, right_wave_speed);
+  for (Uint i=0; i<W; ++i)
+    wave_speed[i] = std::max(left_wave_speed[i],right_wave_speed[i]);
+  for (Uint eq=0; eq<NEQS; ++eq)
+  {
+    for (Uint i=0; i<W; ++i)
+    {
+      flux[eq][i]  = 0.5*(left_flux[eq][i]+right_flux[eq][i]);
+      flux[eq][i] -= 0.5*wave_speed[i]*(right.cons[eq][i] - left.cons[eq][i]);
+    }
+  }
+}
+
+/// @brief Roe Approximate Riemann solver
+/// @note Performs very well, but computationally expensive
+template < Uint W >
+void compute_roe_flux( const DataBatch<W>& left, const DataBatch<W>& right, const Real (&normal)[NDIM][W],
+                       Real (&flux)[NEQS][W], Real (&wave_speed)[W] )
+{
+  // Compute Roe average
+  DataBatch<W> roe;
+  compute_roe_average(left,right,roe);
+
+  Real flux_left[NEQS][W], flux_right[NEQS][W];
+  compute_convective_flux(left,normal,flux_left);
+  compute_convective_flux(right,normal,flux_right);
+
+  for (Uint i=0; i<W; ++i)
+  {
+    const Real nx = normal[XX][i];
+    const Real ny = normal[YY][i];
+    const Real u  = roe.U[XX][i];
+    const Real v  = roe.U[YY][i];
+    const Real c  = roe.c[i];
+
+    // Compute the wave strengths dW
+    const Real dUx  = right.U[XX][i] - left.U[XX][i];
+    const Real dUy  = right.U[YY][i] - left.U[YY][i];
+    const Real drho = right.rho[i] - left.rho[i];
+    const Real dp   = right.p[i]   - left.p[i];
+    const Real dun  = dUx*nx + dUy*ny;
+    const Real dus  = dUx*ny + dUy*(-nx);
+
+    Real dW[NEQS];
+    dW[0] = drho - dp/roe.c2[i];
+    dW[1] = dus * roe.rho[i];
+    dW[2] = 0.5*(dp/roe.c2[i] + dun*roe.rho[i]/c);
+    dW[3] = 0.5*(dp/roe.c2[i] - dun*roe.rho[i]/c);
+
+    // Compute the wave speeds
+    const Real un = u*nx + v*ny;
+    const Real us = u*ny - v*nx;
+    Real lambda[NEQS];
+    lambda[0] = un;
+    lambda[1] = un;
+    lambda[2] = un+c;
+    lambda[3] = un-c;
+
+    // Right eigenvectors, column by column
+    const Real R[NEQS][NEQS] = {
+      { 1.,              u,          v,          0.5*roe.U2[i]     },
+      { 0.,              ny,        -nx,         us                },
+      { 1.,              u+c*nx,     v+c*ny,     roe.H[i]+c*un     },
+      { 1.,              u-c*nx,     v-c*ny,     roe.H[i]-c*un     } };
+
+    Real f[NEQS];
+    for (Uint eq=0; eq<NEQS; ++eq)
+      f[eq] = 0.5*(flux_left[eq][i]+flux_right[eq][i]);
+    for (Uint k=0; k<NEQS; ++k)
+    {
+      for (Uint eq=0; eq<NEQS; ++eq)
+        f[eq] -= 0.5*std::abs(lambda[k]) * dW[k] * R[k][eq];
+    }
+    for (Uint eq=0; eq<NEQS; ++eq)
+      flux[eq][i] = f[eq];
+
+    wave_speed[i] = std::abs(un) + c;
+  }
+}
+
+/// @brief HLLE Approximate Riemann solver
+/// @note Performs reasonably well, and reasonably performant
+template < Uint W >
+void compute_hlle_flux( const DataBatch<W>& left, const DataBatch<W>& right, const Real (&normal)[NDIM][W],
+                        Real (&flux)[NEQS][W], Real (&wave_speed)[W] )
+{
+  // Compute Roe average
+  DataBatch<W> roe;
+  compute_roe_average(left,right,roe);
+
+  Real flux_left[NEQS][W], flux_right[NEQS][W];
+  compute_convective_flux(left,  normal, flux_left );
+  compute_convective_flux(right, normal, flux_right);
+
+  for (Uint i=0; i<W; ++i)
+  {
+    const Real nx = normal[XX][i];
+    const Real ny = normal[YY][i];
+    const Real un_left  = left.U[XX][i]*nx  + left.U[YY][i]*ny;
+    const Real un_right = right.U[XX][i]*nx + right.U[YY][i]*ny;
+    const Real un_roe   = roe.U[XX][i]*nx   + roe.U[YY][i]*ny;
+
+    // The smallest and largest eigenvalues are u-c and u+c
+    const Real wave_speed_left  = std::min(un_left-left.c[i],   un_roe-roe.c[i]);
+    const Real wave_speed_right = std::max(un_right+right.c[i], un_roe+roe.c[i]);
+
+    // Both supersonic cases are selected per face instead of branching
+    const bool supersonic_right = wave_speed_left >= 0.;
+    const bool supersonic_left  = wave_speed_right <= 0.;
+    for (Uint eq=0; eq<NEQS; ++eq)
+    {
+      Real f = (wave_speed_right*flux_left[eq][i]-wave_speed_left*flux_right[eq][i]);
+      f += (wave_speed_left*wave_speed_right)*(right.cons[eq][i]-left.cons[eq][i]);
+      f /= (wave_speed_right-wave_speed_left);
+      flux[eq][i] = supersonic_right ? flux_left[eq][i] : ( supersonic_left ? flux_right[eq][i] : f );
+    }
+
+    wave_speed[i] = std::abs(un_roe) + roe.c[i];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+} // euler2d
+} // euler
+} // physics
+} // cf3
+
+#endif // cf3_physics_euler_euler2d_FunctionsBatch_hpp
@@ -0,0 +1,62 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+/// @file DataBatch.hpp
+/// @brief Navier-Stokes 2D data of W states, stored per variable
+
+#ifndef cf3_physics_navierstokes_navierstokes2d_DataBatch_hpp
+#define cf3_physics_navierstokes_navierstokes2d_DataBatch_hpp
+
+#include "cf3/physics/navierstokes/navierstokes2d/Data.hpp"
+#include "cf3/physics/euler/euler2d/DataBatch.hpp"
+
+namespace cf3 {
+namespace physics {
+namespace navierstokes {
+namespace navierstokes2d {
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+/// @brief Data of W states in structure-of-arrays layout
+/// @see euler::euler2d::DataBatch, whose batched Riemann solvers apply to this data as well
+template < Uint W >
+struct DataBatch : euler::euler2d::DataBatch<W>
+{
+  /// @name Gas constants
+  //@{
+  Real mu[W];               ///< dynamic viscosity
+  Real k[W];                ///< heat conductivity
+  Real Cp[W];               ///< Heat capacity
+  //@}
+
+  Real grad_u[NDIM][W];     ///< gradient of x velocity
+  Real grad_v[NDIM][W];     ///< gradient of y velocity
+  Real grad_T[NDIM][W];     ///< gradient of temperature
+
+  /// @brief Copy a state into a lane
+  void set(const Uint lane, const Data& data)
+  {
+    euler::euler2d::DataBatch<W>::set(lane,data);
+    mu[lane] = data.mu;
+    k[lane]  = data.k;
+    Cp[lane] = data.Cp;
+    for (Uint d=0; d<NDIM; ++d)
+    {
+      grad_u[d][lane] = data.grad_u[d];
+      grad_v[d][lane] = data.grad_v[d];
+      grad_T[d][lane] = data.grad_T[d];
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+} // navierstokes2d
+} // navierstokes
+} // physics
+} // cf3
+
+#endif // cf3_physics_navierstokes_navierstokes2d_DataBatch_hpp
@@ -0,0 +1,97 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+/// @file FunctionsBatch.hpp
+/// @brief Functions describing navierstokes 3D physics, for W faces at once
+///
+/// The layout is the one of euler/euler3d/FunctionsBatch.hpp, whose convective fluxes and
+/// Riemann solvers are made available in this namespace.
+
+#ifndef cf3_physics_navierstokes_navierstokes3d_FunctionsBatch_hpp
+#define cf3_physics_navierstokes_navierstokes3d_FunctionsBatch_hpp
+
+#include <algorithm>
+
+#include "cf3/physics/navierstokes/navierstokes3d/DataBatch.hpp"
+#include "cf3/physics/euler/euler3d/FunctionsBatch.hpp"
+
+namespace cf3 {
+namespace physics {
+namespace navierstokes {
+namespace navierstokes3d {
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+using euler::euler3d::compute_convective_flux;
+using euler::euler3d::compute_convective_wave_speed;
+using euler::euler3d::compute_rusanov_flux;
+using euler::euler3d::compute_roe_flux;
+using euler::euler3d::compute_hlle_flux;
+
+/// @brief Diffusive flux in conservative form
+template < Uint W >
+void compute_diffusive_flux( const DataBatch<W>& p, const Real (&normal)[NDIM][W],
+                             Real (&flux)[NEQS][W] )
+{
+  for (Uint i=0; i<W; ++i)
+  {
+    const Real nx = normal[XX][i];
+    const Real ny = normal[YY][i];
+    const Real nz = normal[ZZ][i];
+
+    const Real two_third_divergence_U = 2./3.*(p.grad_u[XX][i] + p.grad_v[YY][i] + p.grad_w[ZZ][i]);
+
+    // Viscous stress tensor
+    const Real tau_xx = p.mu[i]*(2.*p.grad_u[XX][i] - two_third_divergence_U);
+    const Real tau_yy = p.mu[i]*(2.*p.grad_v[YY][i] - two_third_divergence_U);
+    const Real tau_zz = p.mu[i]*(2.*p.grad_w[ZZ][i] - two_third_divergence_U);
+    const Real tau_xy = p.mu[i]*(p.grad_u[YY][i] + p.grad_v[XX][i]);
+    const Real tau_xz = p.mu[i]*(p.grad_u[ZZ][i] + p.grad_w[XX][i]);
+    const Real tau_yz = p.mu[i]*(p.grad_v[ZZ][i] + p.grad_w[YY][i]);
+
+    // Heat flux
+    const Real heat_flux = -p.k[i]*(p.grad_T[XX][i]*nx + p.grad_T[YY][i]*ny + p.grad_T[ZZ][i]*nz);
+
+    const Real u = p.U[XX][i];
+    const Real v = p.U[YY][i];
+    const Real w = p.U[ZZ][i];
+    flux[0][i] = 0.;
+    flux[1][i] = tau_xx*nx + tau_xy*ny + tau_xz*nz;
+    flux[2][i] = tau_xy*nx + tau_yy*ny + tau_yz*nz;
+    flux[3][i] = tau_xz*nx + tau_yz*ny + tau_zz*nz;
+    flux[4][i] = (tau_xx*u + tau_xy*v + tau_xz*w)*nx
+               + (tau_xy*u + tau_yy*v + tau_yz*w)*ny
+               + (tau_xz*u + tau_yz*v + tau_zz*w)*nz - heat_flux;
+  }
+}
+
+/// @brief Maximum absolute wave speed
+template < Uint W >
+void compute_diffusive_wave_speed( const DataBatch<W>& p, const Real (&normal)[NDIM][W],
+                                   Real (&wave_speed)[W] )
+{
+  // maximum of kinematic viscosity nu and thermal diffusivity alpha
+  for (Uint i=0; i<W; ++i)
+    wave_speed[i] = std::max(p.mu[i]/p.rho[i], p.k[i]/(p.rho[i]*p.Cp[i]));
+}
+
+/// @brief Diffusive flux in conservative form
+template < Uint W >
+void compute_diffusive_flux( const DataBatch<W>& p, const Real (&normal)[NDIM][W],
+                             Real (&flux)[NEQS][W], Real (&wave_speed)[W] )
+{
+  compute_diffusive_flux(p,normal,flux);
+  compute_diffusive_wave_speed(p,normal,wave_speed);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+
+} // navierstokes3d
+} // navierstokes
+} // physics
+} // cf3
+
+#endif // cf3_physics_navierstokes_navierstokes3d_FunctionsBatch_hpp
@@ -0,0 +1,122 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the batched functions of cf3::physics::navierstokes::navierstokes3d"
+
+#include <cmath>
+#include <limits>
+
+#include <boost/test/unit_test.hpp>
+
+#include "cf3/physics/euler/euler3d/Functions.hpp"
+#include "cf3/physics/navierstokes/navierstokes3d/Functions.hpp"
+#include "cf3/physics/navierstokes/navierstokes3d/FunctionsBatch.hpp"
+
+using namespace cf3;
+using namespace cf3::physics::navierstokes::navierstokes3d;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Tolerance relative to the magnitude of the terms, for compilers contracting to FMA instructions
+const Real tolerance = 16.*std::numeric_limits<Real>::epsilon();
+
+void make_state(const Uint i, Data& p)
+{
+  p.gamma = 1.4;
+  p.R = 287.05;
+  p.mu = 1.8e-5*(1.+0.1*std::sin(Real(i)));
+  p.k = 2.6e-2;
+  p.Cp = 1005.;
+  RowVector_NEQS prim;
+  prim << 1.+0.5*std::sin(0.3*i), 100.*std::cos(0.7*i), 50.*std::sin(1.1*i), 20.*std::cos(0.4*i), 1e5;
+  p.compute_from_primitive(prim);
+  p.grad_u << 3.*std::sin(0.5*i), 2., 0.5;
+  p.grad_v << -1., 4.*std::cos(0.2*i), -2.;
+  p.grad_w << 1.5, -0.5, 2.*std::sin(0.8*i);
+  p.grad_T << 30.*std::sin(1.3*i), -10., 5.;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( NavierStokes_Batch3D_Suite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( diffusive_flux )
+{
+  const Uint W = 8;
+  DataBatch<W> batch;
+  Real normal[NDIM][W];
+  Data single[W];
+  ColVector_NDIM single_normal[W];
+  for (Uint i=0; i<W; ++i)
+  {
+    make_state(i,single[i]);
+    batch.set(i,single[i]);
+    single_normal[i] << std::cos(0.9*i)*std::sin(0.6*i+0.2), std::sin(0.9*i)*std::sin(0.6*i+0.2), std::cos(0.6*i+0.2);
+    normal[XX][i] = single_normal[i][XX];
+    normal[YY][i] = single_normal[i][YY];
+    normal[ZZ][i] = single_normal[i][ZZ];
+  }
+
+  Real flux[NEQS][W];
+  Real wave_speed[W];
+  compute_diffusive_flux(batch,normal,flux,wave_speed);
+
+  for (Uint i=0; i<W; ++i)
+  {
+    RowVector_NEQS single_flux;
+    Real single_wave_speed;
+    compute_diffusive_flux(single[i],single_normal[i],single_flux,single_wave_speed);
+    const Real scale = single_flux.cwiseAbs().maxCoeff();
+    for (Uint eq=0; eq<NEQS; ++eq)
+      BOOST_CHECK_SMALL( flux[eq][i]-single_flux[eq], tolerance*scale );
+    BOOST_CHECK_EQUAL( wave_speed[i], single_wave_speed );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( convective_flux )
+{
+  // The Euler Riemann solvers take the Navier-Stokes data
+  const Uint W = 4;
+  DataBatch<W> left, right;
+  Real normal[NDIM][W];
+  Data single_left[W], single_right[W];
+  ColVector_NDIM single_normal[W];
+  for (Uint i=0; i<W; ++i)
+  {
+    make_state(i,single_left[i]);
+    make_state(i+W,single_right[i]);
+    left.set(i,single_left[i]);
+    right.set(i,single_right[i]);
+    single_normal[i] << std::cos(0.9*i)*std::sin(0.6*i+0.2), std::sin(0.9*i)*std::sin(0.6*i+0.2), std::cos(0.6*i+0.2);
+    normal[XX][i] = single_normal[i][XX];
+    normal[YY][i] = single_normal[i][YY];
+    normal[ZZ][i] = single_normal[i][ZZ];
+  }
+
+  Real flux[NEQS][W];
+  Real wave_speed[W];
+  compute_roe_flux(left,right,normal,flux,wave_speed);
+
+  for (Uint i=0; i<W; ++i)
+  {
+    RowVector_NEQS single_flux;
+    Real single_wave_speed;
+    cf3::physics::euler::euler3d::compute_roe_flux(single_left[i],single_right[i],single_normal[i],single_flux,single_wave_speed);
+    const Real scale = single_left[i].p + single_left[i].rho*single_left[i].H*single_left[i].U.norm();
+    for (Uint eq=0; eq<NEQS; ++eq)
+      BOOST_CHECK_SMALL( flux[eq][i]-single_flux[eq], tolerance*scale );
+    BOOST_CHECK_CLOSE( wave_speed[i], single_wave_speed, 1e-12 );
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,85 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::physics::NavierStokes::Cons3D"
+
+#include <boost/test/unit_test.hpp>
+
+#include "cf3/common/Log.hpp"
+#include "cf3/common/Core.hpp"
+#include "cf3/common/Environment.hpp"
+
+#include "cf3/physics/navierstokes/navierstokes2d/Functions.hpp"
+#include "cf3/physics/navierstokes/navierstokes3d/Functions.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::physics::navierstokes::navierstokes3d;
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( NavierStokes_Cons3D_Suite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( test_navierstokes3d )
+{
+    Data p;
+
+    p.mu = 4.;
+    p.k = 0.5;
+    p.U[0] = 2.;
+    p.U[1] = 2.;
+    p.U[2] = 2.;
+    p.grad_u << 3., 2., 1.;
+    p.grad_v << 2., 3., 1.;
+    p.grad_w << 1., 1., 3.;
+    p.grad_T << 3., 3., 3.;
+
+    RowVector_NEQS flux;
+    ColVector_NDIM normal;
+    normal << 1., 1., 1.;
+    compute_diffusive_flux(p,normal,flux);
+    RowVector_NEQS check; check << 0, 24, 24, 16, 132.5;
+    BOOST_CHECK(flux == check);
+}
+
+BOOST_AUTO_TEST_CASE( test_navierstokes3d_planar )
+{
+    // Without z-component the 2D flux is recovered
+    physics::navierstokes::navierstokes2d::Data p2;
+    Data p3;
+
+    p2.mu = 4.;          p3.mu = 4.;
+    p2.k = 0.5;          p3.k = 0.5;
+    p2.U << 2., -1.;     p3.U << 2., -1., 0.;
+    p2.grad_u << 3., 2.; p3.grad_u << 3., 2., 0.;
+    p2.grad_v << 2., 3.; p3.grad_v << 2., 3., 0.;
+                         p3.grad_w << 0., 0., 0.;
+    p2.grad_T << 3., 1.; p3.grad_T << 3., 1., 0.;
+
+    physics::navierstokes::navierstokes2d::ColVector_NDIM normal2;
+    normal2 << 0.6, 0.8;
+    ColVector_NDIM normal3;
+    normal3 << 0.6, 0.8, 0.;
+
+    physics::navierstokes::navierstokes2d::RowVector_NEQS flux2;
+    RowVector_NEQS flux3;
+    compute_diffusive_flux(p2,normal2,flux2);
+    compute_diffusive_flux(p3,normal3,flux3);
+    BOOST_CHECK_EQUAL(flux3[0], flux2[0]);
+    BOOST_CHECK_EQUAL(flux3[1], flux2[1]);
+    BOOST_CHECK_EQUAL(flux3[2], flux2[2]);
+    BOOST_CHECK_EQUAL(flux3[3], 0.);
+    BOOST_CHECK_EQUAL(flux3[4], flux2[3]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
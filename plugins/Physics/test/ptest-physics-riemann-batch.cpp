@@ -0,0 +1,304 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Throughput of the Euler 2D, Euler 3D and Navier-Stokes 2D Riemann solvers, face by face and batched"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <Eigen/StdVector>
+
+#include "common/Timer.hpp"
+
+#include "cf3/physics/euler/euler2d/Functions.hpp"
+#include "cf3/physics/euler/euler2d/FunctionsBatch.hpp"
+#include "cf3/physics/euler/euler3d/Functions.hpp"
+#include "cf3/physics/euler/euler3d/FunctionsBatch.hpp"
+#include "cf3/physics/navierstokes/navierstokes2d/Functions.hpp"
+#include "cf3/physics/navierstokes/navierstokes2d/FunctionsBatch.hpp"
+
+#include "Tools/Testing/DartMeasurement.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::physics;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Euler 2D states
+struct Euler2D
+{
+  typedef euler::euler2d::Data Data;
+  typedef euler::euler2d::Data FluxData;
+  template < Uint W > struct Batch { typedef euler::euler2d::DataBatch<W> type; };
+  typedef euler::euler2d::ColVector_NDIM ColVector_NDIM;
+  typedef euler::euler2d::RowVector_NEQS RowVector_NEQS;
+  enum { NDIM = euler::euler2d::NDIM, NEQS = euler::euler2d::NEQS };
+
+  static void make_face(const Uint f, euler::euler2d::Data& left, euler::euler2d::Data& right, ColVector_NDIM& normal)
+  {
+    left.gamma=1.4;  right.gamma=1.4;
+    left.R=287.05;   right.R=287.05;
+    RowVector_NEQS prim_left, prim_right;
+    prim_left  << 1.+0.5*std::sin(1.+f), 300.*std::sin(0.7*f), 100.*std::cos(1.3*f), 1e5*(1.+0.2*std::cos(0.3*f));
+    prim_right << 1.+0.5*std::cos(2.+f), 300.*std::sin(0.9*f), 100.*std::sin(1.1*f), 1e5*(1.+0.2*std::sin(0.5*f));
+    left.compute_from_primitive(prim_left);
+    right.compute_from_primitive(prim_right);
+    normal << std::cos(0.37*f), std::sin(0.37*f);
+  }
+};
+
+/// Euler 3D states
+struct Euler3D
+{
+  typedef euler::euler3d::Data Data;
+  typedef euler::euler3d::Data FluxData;
+  template < Uint W > struct Batch { typedef euler::euler3d::DataBatch<W> type; };
+  typedef euler::euler3d::ColVector_NDIM ColVector_NDIM;
+  typedef euler::euler3d::RowVector_NEQS RowVector_NEQS;
+  enum { NDIM = euler::euler3d::NDIM, NEQS = euler::euler3d::NEQS };
+
+  static void make_face(const Uint f, Data& left, Data& right, ColVector_NDIM& normal)
+  {
+    left.gamma=1.4;  right.gamma=1.4;
+    left.R=287.05;   right.R=287.05;
+    RowVector_NEQS prim_left, prim_right;
+    prim_left  << 1.+0.5*std::sin(1.+f), 300.*std::sin(0.7*f), 100.*std::cos(1.3*f), 50.*std::sin(0.4*f), 1e5*(1.+0.2*std::cos(0.3*f));
+    prim_right << 1.+0.5*std::cos(2.+f), 300.*std::sin(0.9*f), 100.*std::sin(1.1*f), 50.*std::cos(0.6*f), 1e5*(1.+0.2*std::sin(0.5*f));
+    left.compute_from_primitive(prim_left);
+    right.compute_from_primitive(prim_right);
+    normal << std::cos(0.37*f)*std::sin(0.23*f+0.1), std::sin(0.37*f)*std::sin(0.23*f+0.1), std::cos(0.23*f+0.1);
+  }
+};
+
+/// Navier-Stokes 2D states, which add the viscous data to the Euler 2D states
+struct NavierStokes2D
+{
+  typedef navierstokes::navierstokes2d::Data Data;
+  typedef Euler2D::FluxData FluxData;
+  template < Uint W > struct Batch { typedef navierstokes::navierstokes2d::DataBatch<W> type; };
+  typedef Euler2D::ColVector_NDIM ColVector_NDIM;
+  typedef Euler2D::RowVector_NEQS RowVector_NEQS;
+  enum { NDIM = Euler2D::NDIM, NEQS = Euler2D::NEQS };
+
+  static void make_face(const Uint f, Data& left, Data& right, ColVector_NDIM& normal)
+  {
+    Euler2D::make_face(f,left,right,normal);
+    Data* states[2] = { &left, &right };
+    for (Uint s=0; s<2; ++s)
+    {
+      Data& p = *states[s];
+      p.mu = 1.8e-5*(1.+0.1*std::sin(Real(f+s)));
+      p.k = 2.6e-2;
+      p.Cp = 1005.;
+      p.grad_u << 3.*std::sin(0.5*f), 2.;
+      p.grad_v << -1., 4.*std::cos(0.2*f);
+      p.grad_T << 30.*std::sin(1.3*f), -10.;
+    }
+  }
+};
+
+/// Diffusive flux through a face, with the signature of the Riemann solvers so it is timed the same way.
+/// The fixture only passes Navier-Stokes states.
+void diffusive_flux_single(const NavierStokes2D::FluxData& left, const NavierStokes2D::FluxData& right, const NavierStokes2D::ColVector_NDIM& normal,
+                           NavierStokes2D::RowVector_NEQS& flux, Real& wave_speed)
+{
+  navierstokes::navierstokes2d::compute_diffusive_flux(static_cast<const NavierStokes2D::Data&>(left),normal,flux,wave_speed);
+}
+
+template < Uint W >
+void diffusive_flux_batch(const navierstokes::navierstokes2d::DataBatch<W>& left, const navierstokes::navierstokes2d::DataBatch<W>& right,
+                          const Real (&normal)[NavierStokes2D::NDIM][W], Real (&flux)[NavierStokes2D::NEQS][W], Real (&wave_speed)[W])
+{
+  navierstokes::navierstokes2d::compute_diffusive_flux(left,normal,flux,wave_speed);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Computes the fluxes through a number of faces given as first argument
+template < typename PhysicsT >
+struct RiemannBatchFixture
+{
+  typedef typename PhysicsT::Data Data;
+  typedef typename PhysicsT::ColVector_NDIM ColVector_NDIM;
+  typedef typename PhysicsT::RowVector_NEQS RowVector_NEQS;
+  enum { NDIM = PhysicsT::NDIM, NEQS = PhysicsT::NEQS };
+
+  RiemannBatchFixture()
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    nb_faces = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 1000000u;
+    nb_faces -= nb_faces % 8;
+
+    left.resize(nb_faces);
+    right.resize(nb_faces);
+    normal.resize(nb_faces);
+    for (Uint f=0; f<nb_faces; ++f)
+      PhysicsT::make_face(f,left[f],right[f],normal[f]);
+  }
+
+  typedef void (*SingleFluxT)(const typename PhysicsT::FluxData&, const typename PhysicsT::FluxData&, const ColVector_NDIM&, RowVector_NEQS&, Real&);
+
+  void run_single(const std::string& name, SingleFluxT flux_function)
+  {
+    RowVector_NEQS flux;
+    Real wave_speed;
+    Real checksum = 0.;
+    Timer timer;
+    for (Uint f=0; f<nb_faces; ++f)
+    {
+      flux_function(left[f],right[f],normal[f],flux,wave_speed);
+      checksum += flux[0] + wave_speed;
+    }
+    const Real elapsed = timer.elapsed();
+    dart_measurement(name+" Mfaces/s", nb_faces / elapsed * 1e-6);
+    BOOST_CHECK(checksum == checksum);
+  }
+
+  template < Uint W, typename BatchFluxT >
+  void run_batch(const std::string& name, BatchFluxT flux_function)
+  {
+    typedef typename PhysicsT::template Batch<W>::type DataBatchT;
+
+    // Convert to the batch layout beforehand, as the face data would be stored
+    const Uint nb_batches = nb_faces / W;
+    std::vector< DataBatchT > left_batch(nb_batches), right_batch(nb_batches);
+    std::vector<Real> normal_batch(nb_batches*NDIM*W);
+    for (Uint b=0; b<nb_batches; ++b)
+    {
+      for (Uint i=0; i<W; ++i)
+      {
+        left_batch[b].set(i,left[b*W+i]);
+        right_batch[b].set(i,right[b*W+i]);
+        for (Uint d=0; d<NDIM; ++d)
+          normal_batch[(b*NDIM+d)*W+i] = normal[b*W+i][d];
+      }
+    }
+
+    Real flux[NEQS][W];
+    Real wave_speed[W];
+    Real checksum = 0.;
+    Timer timer;
+    for (Uint b=0; b<nb_batches; ++b)
+    {
+      typedef Real NormalT[NDIM][W];
+      flux_function(left_batch[b],right_batch[b],*reinterpret_cast<const NormalT*>(&normal_batch[b*NDIM*W]),flux,wave_speed);
+      for (Uint i=0; i<W; ++i)
+        checksum += flux[0][i] + wave_speed[i];
+    }
+    const Real elapsed = timer.elapsed();
+    dart_measurement(name+" Mfaces/s", nb_faces / elapsed * 1e-6);
+    BOOST_CHECK(checksum == checksum);
+  }
+
+  Uint nb_faces;
+  std::vector< Data, Eigen::aligned_allocator<Data> > left;
+  std::vector< Data, Eigen::aligned_allocator<Data> > right;
+  std::vector< ColVector_NDIM, Eigen::aligned_allocator<ColVector_NDIM> > normal;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( RiemannBatchSuite, RiemannBatchFixture<Euler2D> )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Rusanov )
+{
+  using namespace euler::euler2d;
+  run_single("rusanov single", &compute_rusanov_flux);
+  run_batch<4>("rusanov batch 4", &compute_rusanov_flux<4>);
+  run_batch<8>("rusanov batch 8", &compute_rusanov_flux<8>);
+}
+
+BOOST_AUTO_TEST_CASE( Roe )
+{
+  using namespace euler::euler2d;
+  run_single("roe single", &compute_roe_flux);
+  run_batch<4>("roe batch 4", &compute_roe_flux<4>);
+  run_batch<8>("roe batch 8", &compute_roe_flux<8>);
+}
+
+BOOST_AUTO_TEST_CASE( HLLE )
+{
+  using namespace euler::euler2d;
+  run_single("hlle single", &compute_hlle_flux);
+  run_batch<4>("hlle batch 4", &compute_hlle_flux<4>);
+  run_batch<8>("hlle batch 8", &compute_hlle_flux<8>);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( Euler3DBatchSuite, RiemannBatchFixture<Euler3D> )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Rusanov )
+{
+  using namespace euler::euler3d;
+  run_single("euler3d rusanov single", &compute_rusanov_flux);
+  run_batch<4>("euler3d rusanov batch 4", &compute_rusanov_flux<4>);
+  run_batch<8>("euler3d rusanov batch 8", &compute_rusanov_flux<8>);
+}
+
+BOOST_AUTO_TEST_CASE( Roe )
+{
+  using namespace euler::euler3d;
+  run_single("euler3d roe single", &compute_roe_flux);
+  run_batch<4>("euler3d roe batch 4", &compute_roe_flux<4>);
+  run_batch<8>("euler3d roe batch 8", &compute_roe_flux<8>);
+}
+
+BOOST_AUTO_TEST_CASE( HLLE )
+{
+  using namespace euler::euler3d;
+  run_single("euler3d hlle single", &compute_hlle_flux);
+  run_batch<4>("euler3d hlle batch 4", &compute_hlle_flux<4>);
+  run_batch<8>("euler3d hlle batch 8", &compute_hlle_flux<8>);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
+
+// The Euler Riemann solvers on the larger Navier-Stokes states, and the diffusive flux
+BOOST_FIXTURE_TEST_SUITE( NavierStokesBatchSuite, RiemannBatchFixture<NavierStokes2D> )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Roe )
+{
+  using namespace euler::euler2d;
+  run_single("navierstokes roe single", &compute_roe_flux);
+  run_batch<4>("navierstokes roe batch 4", &compute_roe_flux<4>);
+  run_batch<8>("navierstokes roe batch 8", &compute_roe_flux<8>);
+}
+
+BOOST_AUTO_TEST_CASE( Diffusive )
+{
+  run_single("navierstokes diffusive single", &diffusive_flux_single);
+  run_batch<4>("navierstokes diffusive batch 4", &diffusive_flux_batch<4>);
+  run_batch<8>("navierstokes diffusive batch 8", &diffusive_flux_batch<8>);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
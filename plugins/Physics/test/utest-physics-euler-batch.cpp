@@ -0,0 +1,325 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the batched Riemann solvers of cf3::physics::euler::euler2d and euler3d"
+
+#include <cmath>
+#include <limits>
+
+#include <boost/test/unit_test.hpp>
+
+#include "math/Defs.hpp"
+
+#include "cf3/physics/euler/euler2d/Functions.hpp"
+#include "cf3/physics/euler/euler2d/FunctionsBatch.hpp"
+#include "cf3/physics/euler/euler3d/Functions.hpp"
+#include "cf3/physics/euler/euler3d/FunctionsBatch.hpp"
+
+using namespace cf3;
+using namespace cf3::physics::euler;
+
+//////////////////////////////////////////////////////////////////////////////
+
+/// Tolerance on the difference between the batched and single face results, in units of
+/// the machine epsilon relative to the magnitude of the terms summed in the flux.
+/// Both compute the same operations in the same order and agree to the bit, unless the compiler
+/// contracts multiplications and additions into FMA instructions differently in the vectorized loops.
+const Real max_ulps = 16.;
+
+/// Euler 2D states
+struct Euler2D
+{
+  typedef euler2d::Data Data;
+  template < Uint W > struct Batch { typedef euler2d::DataBatch<W> type; };
+  typedef euler2d::ColVector_NDIM ColVector_NDIM;
+  typedef euler2d::RowVector_NEQS RowVector_NEQS;
+  enum { NDIM = euler2d::NDIM, NEQS = euler2d::NEQS };
+
+  /// Set left and right states and normals of face f, covering subsonic and supersonic
+  /// flows in both directions
+  static void make_face(const Uint f, Data& left, Data& right, ColVector_NDIM& normal)
+  {
+    left.gamma=1.4;  right.gamma=1.4;
+    left.R=287.05;   right.R=287.05;
+
+    RowVector_NEQS prim_left, prim_right;
+    prim_left  << 1.+std::abs(std::sin(1.+f)), 800.*std::sin(0.7*f), 300.*std::cos(1.3*f), 1e5*(1.+std::abs(std::cos(0.3*f)));
+    prim_right << 1.+std::abs(std::cos(2.+f)), 800.*std::sin(0.9*f+0.5), 300.*std::sin(1.1*f), 1e5*(1.+std::abs(std::sin(0.5*f)));
+    left.compute_from_primitive(prim_left);
+    right.compute_from_primitive(prim_right);
+
+    normal << std::cos(0.37*f), std::sin(0.37*f);
+  }
+
+  /// Light and fast state, so the kinetic energy dominates the total enthalpy
+  static void make_light_fast_state(Data& p)
+  {
+    p.gamma=1.4;
+    p.R=287.05;
+    RowVector_NEQS prim;
+    prim << 0.1, 180., 240., 1e4;
+    p.compute_from_primitive(prim);
+  }
+};
+
+/// Euler 3D states
+struct Euler3D
+{
+  typedef euler3d::Data Data;
+  template < Uint W > struct Batch { typedef euler3d::DataBatch<W> type; };
+  typedef euler3d::ColVector_NDIM ColVector_NDIM;
+  typedef euler3d::RowVector_NEQS RowVector_NEQS;
+  enum { NDIM = euler3d::NDIM, NEQS = euler3d::NEQS };
+
+  /// Set left and right states and normals of face f, covering subsonic and supersonic
+  /// flows in both directions
+  static void make_face(const Uint f, Data& left, Data& right, ColVector_NDIM& normal)
+  {
+    left.gamma=1.4;  right.gamma=1.4;
+    left.R=287.05;   right.R=287.05;
+
+    RowVector_NEQS prim_left, prim_right;
+    prim_left  << 1.+std::abs(std::sin(1.+f)), 800.*std::sin(0.7*f), 300.*std::cos(1.3*f), 200.*std::sin(0.4*f), 1e5*(1.+std::abs(std::cos(0.3*f)));
+    prim_right << 1.+std::abs(std::cos(2.+f)), 800.*std::sin(0.9*f+0.5), 300.*std::sin(1.1*f), 200.*std::cos(0.6*f), 1e5*(1.+std::abs(std::sin(0.5*f)));
+    left.compute_from_primitive(prim_left);
+    right.compute_from_primitive(prim_right);
+
+    // Normals in all directions, to cover each choice of tangent vectors
+    normal << std::cos(0.37*f)*std::sin(0.23*f+0.1), std::sin(0.37*f)*std::sin(0.23*f+0.1), std::cos(0.23*f+0.1);
+  }
+
+  /// Light and fast state, so the kinetic energy dominates the total enthalpy
+  static void make_light_fast_state(Data& p)
+  {
+    p.gamma=1.4;
+    p.R=287.05;
+    RowVector_NEQS prim;
+    prim << 0.1, 180., 240., 0., 1e4;
+    p.compute_from_primitive(prim);
+  }
+};
+
+void check_ulps(const Real batch, const Real single, const Real scale)
+{
+  BOOST_CHECK_LE( std::abs(batch-single), max_ulps*std::numeric_limits<Real>::epsilon()*scale );
+}
+
+void check_ulps(const Real batch, const Real single)
+{
+  check_ulps(batch,single,std::abs(single));
+}
+
+/// Compare a batched Riemann solver with the single face version, for nb_batches batches of W faces
+template < typename PhysicsT, Uint W, typename BatchFluxT >
+void check_riemann_solver(void (*single_flux)(const typename PhysicsT::Data&, const typename PhysicsT::Data&, const typename PhysicsT::ColVector_NDIM&, typename PhysicsT::RowVector_NEQS&, Real&),
+                          BatchFluxT batch_flux, const Uint nb_batches)
+{
+  typedef typename PhysicsT::Data Data;
+  typedef typename PhysicsT::ColVector_NDIM ColVector_NDIM;
+  typedef typename PhysicsT::RowVector_NEQS RowVector_NEQS;
+  enum { NDIM = PhysicsT::NDIM, NEQS = PhysicsT::NEQS };
+
+  for (Uint b=0; b<nb_batches; ++b)
+  {
+    typename PhysicsT::template Batch<W>::type left, right;
+    Real normal[NDIM][W];
+    Real flux[NEQS][W];
+    Real wave_speed[W];
+
+    Data face_left[W], face_right[W];
+    ColVector_NDIM face_normal[W];
+    for (Uint i=0; i<W; ++i)
+    {
+      PhysicsT::make_face(b*W+i, face_left[i], face_right[i], face_normal[i]);
+      left.set(i,face_left[i]);
+      right.set(i,face_right[i]);
+      for (Uint d=0; d<NDIM; ++d)
+        normal[d][i] = face_normal[i][d];
+    }
+
+    batch_flux(left,right,normal,flux,wave_speed);
+
+    for (Uint i=0; i<W; ++i)
+    {
+      RowVector_NEQS single;
+      Real single_wave_speed;
+      single_flux(face_left[i],face_right[i],face_normal[i],single,single_wave_speed);
+
+      // The fluxes cancel out, so the errors are relative to the magnitude of the terms
+      RowVector_NEQS flux_left, flux_right;
+      compute_convective_flux(face_left[i],face_normal[i],flux_left);
+      compute_convective_flux(face_right[i],face_normal[i],flux_right);
+      for (Uint eq=0; eq<NEQS; ++eq)
+      {
+        const Real scale = std::abs(flux_left[eq]) + std::abs(flux_right[eq]) +
+                           single_wave_speed*std::abs(face_right[i].cons[eq]-face_left[i].cons[eq]);
+        check_ulps(flux[eq][i],single[eq],scale);
+      }
+      check_ulps(wave_speed[i],single_wave_speed);
+    }
+  }
+}
+
+/// Compare the batched and single face computation of the state from the conservative variables
+template < typename PhysicsT >
+void check_data_from_conservative()
+{
+  typedef typename PhysicsT::Data Data;
+  typedef typename PhysicsT::ColVector_NDIM ColVector_NDIM;
+  enum { NDIM = PhysicsT::NDIM, NEQS = PhysicsT::NEQS };
+
+  const Uint W = 4;
+  typename PhysicsT::template Batch<W>::type batch;
+  Real cons[NEQS][W];
+  Data single[W];
+  for (Uint i=0; i<W; ++i)
+  {
+    Data right;
+    ColVector_NDIM normal;
+    PhysicsT::make_face(i,single[i],right,normal);
+    batch.gamma[i] = single[i].gamma;
+    batch.R[i] = single[i].R;
+    for (Uint eq=0; eq<NEQS; ++eq)
+      cons[eq][i] = single[i].cons[eq];
+    single[i].compute_from_conservative(single[i].cons);
+  }
+  batch.compute_from_conservative(cons);
+  for (Uint i=0; i<W; ++i)
+  {
+    check_ulps(batch.rho[i], single[i].rho);
+    for (Uint d=0; d<NDIM; ++d)
+      check_ulps(batch.U[d][i], single[i].U[d]);
+    check_ulps(batch.p[i], single[i].p);
+    check_ulps(batch.H[i], single[i].H);
+    check_ulps(batch.c[i], single[i].c);
+    check_ulps(batch.M[i], single[i].M);
+    check_ulps(batch.T[i], single[i].T);
+  }
+}
+
+/// The Roe average of two equal states is that state
+template < typename PhysicsT >
+void check_roe_average()
+{
+  typename PhysicsT::Data p;
+  PhysicsT::make_light_fast_state(p);
+
+  const Uint W = 4;
+  typename PhysicsT::template Batch<W>::type batch, roe;
+  for (Uint i=0; i<W; ++i)
+    batch.set(i,p);
+  compute_roe_average(batch,batch,roe);
+  for (Uint i=0; i<W; ++i)
+  {
+    BOOST_CHECK_CLOSE(roe.c[i], p.c, 1e-10);
+    BOOST_CHECK_CLOSE(roe.p[i], p.p, 1e-10);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( Euler2D_Batch_Suite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( data_from_conservative )
+{
+  check_data_from_conservative<Euler2D>();
+}
+
+BOOST_AUTO_TEST_CASE( rusanov )
+{
+  check_riemann_solver<Euler2D,4>(&euler2d::compute_rusanov_flux, &euler2d::compute_rusanov_flux<4>, 64);
+  check_riemann_solver<Euler2D,8>(&euler2d::compute_rusanov_flux, &euler2d::compute_rusanov_flux<8>, 32);
+}
+
+BOOST_AUTO_TEST_CASE( roe )
+{
+  check_riemann_solver<Euler2D,4>(&euler2d::compute_roe_flux, &euler2d::compute_roe_flux<4>, 64);
+  check_riemann_solver<Euler2D,8>(&euler2d::compute_roe_flux, &euler2d::compute_roe_flux<8>, 32);
+}
+
+BOOST_AUTO_TEST_CASE( hlle )
+{
+  check_riemann_solver<Euler2D,4>(&euler2d::compute_hlle_flux, &euler2d::compute_hlle_flux<4>, 64);
+  check_riemann_solver<Euler2D,8>(&euler2d::compute_hlle_flux, &euler2d::compute_hlle_flux<8>, 32);
+}
+
+BOOST_AUTO_TEST_CASE( roe_average )
+{
+  check_roe_average<Euler2D>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( Euler3D_Batch_Suite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( data_from_conservative )
+{
+  check_data_from_conservative<Euler3D>();
+}
+
+BOOST_AUTO_TEST_CASE( tangent_vectors )
+{
+  const Uint W = 8;
+  Real normal[Euler3D::NDIM][W];
+  Real t1[Euler3D::NDIM][W], t2[Euler3D::NDIM][W];
+  Euler3D::ColVector_NDIM face_normal[W];
+  for (Uint i=0; i<W; ++i)
+  {
+    Euler3D::Data left, right;
+    Euler3D::make_face(5*i,left,right,face_normal[i]);
+    for (Uint d=0; d<Euler3D::NDIM; ++d)
+      normal[d][i] = face_normal[i][d];
+  }
+  euler3d::compute_tangent_vectors(normal,t1,t2);
+  for (Uint i=0; i<W; ++i)
+  {
+    Euler3D::ColVector_NDIM single_t1, single_t2;
+    euler3d::compute_tangent_vectors(face_normal[i],single_t1,single_t2);
+    for (Uint d=0; d<Euler3D::NDIM; ++d)
+    {
+      check_ulps(t1[d][i], single_t1[d], 1.);
+      check_ulps(t2[d][i], single_t2[d], 1.);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( rusanov )
+{
+  check_riemann_solver<Euler3D,4>(&euler3d::compute_rusanov_flux, &euler3d::compute_rusanov_flux<4>, 64);
+  check_riemann_solver<Euler3D,8>(&euler3d::compute_rusanov_flux, &euler3d::compute_rusanov_flux<8>, 32);
+}
+
+BOOST_AUTO_TEST_CASE( roe )
+{
+  check_riemann_solver<Euler3D,4>(&euler3d::compute_roe_flux, &euler3d::compute_roe_flux<4>, 64);
+  check_riemann_solver<Euler3D,8>(&euler3d::compute_roe_flux, &euler3d::compute_roe_flux<8>, 32);
+}
+
+BOOST_AUTO_TEST_CASE( hlle )
+{
+  check_riemann_solver<Euler3D,4>(&euler3d::compute_hlle_flux, &euler3d::compute_hlle_flux<4>, 64);
+  check_riemann_solver<Euler3D,8>(&euler3d::compute_hlle_flux, &euler3d::compute_hlle_flux<8>, 32);
+}
+
+BOOST_AUTO_TEST_CASE( roe_average )
+{
+  check_roe_average<Euler3D>();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -7,6 +7,7 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for cf3::Euler"
 
+#include <cmath>
 #include <iostream>
 #include <boost/test/unit_test.hpp>
 
@@ -17,6 +18,7 @@
 #include "cf3/common/Environment.hpp"
 #include "cf3/physics/euler/euler1d/Functions.hpp"
 #include "cf3/physics/euler/euler2d/Functions.hpp"
+#include "cf3/physics/euler/euler3d/Functions.hpp"
 
 using namespace std;
 using namespace cf3;
@@ -98,6 +100,28 @@ BOOST_AUTO_TEST_CASE( Test_Euler1D_riemann )
 
 
 
+BOOST_AUTO_TEST_CASE( Test_Euler1D_roe_average )
+{
+  // Light and fast, so the kinetic energy dominates the total enthalpy
+  euler1d::Data p;
+  p.gamma=1.4;
+  p.R=287.05;
+  euler1d::RowVector_NEQS prim;
+  prim << 0.1, 300., 1e4;
+  p.compute_from_primitive(prim);
+
+  // The Roe average of two equal states is that state
+  euler1d::Data roe;
+  compute_roe_average(p, p, roe);
+  BOOST_CHECK_CLOSE(roe.rho, p.rho, 1e-10);
+  BOOST_CHECK_CLOSE(roe.H, p.H, 1e-10);
+  BOOST_CHECK_CLOSE(roe.c2, p.c2, 1e-10);
+  BOOST_CHECK_CLOSE(roe.c, p.c, 1e-10);
+  BOOST_CHECK_CLOSE(roe.p, p.p, 1e-10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( Test_Euler2D_convection )
 {
   euler2d::Data p;
@@ -170,6 +194,204 @@ BOOST_AUTO_TEST_CASE( Test_Euler2D_riemann )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( Test_Euler2D_roe_average )
+{
+  // Light and fast, so the kinetic energy dominates the total enthalpy
+  euler2d::Data p;
+  p.gamma=1.4;
+  p.R=287.05;
+  euler2d::RowVector_NEQS prim;
+  prim << 0.1, 180., 240., 1e4;
+  p.compute_from_primitive(prim);
+
+  // The Roe average of two equal states is that state
+  euler2d::Data roe;
+  compute_roe_average(p, p, roe);
+  BOOST_CHECK_CLOSE(roe.rho, p.rho, 1e-10);
+  BOOST_CHECK_CLOSE(roe.H, p.H, 1e-10);
+  BOOST_CHECK_CLOSE(roe.c2, p.c2, 1e-10);
+  BOOST_CHECK_CLOSE(roe.c, p.c, 1e-10);
+  BOOST_CHECK_CLOSE(roe.p, p.p, 1e-10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Test_Euler3D_convection )
+{
+  euler3d::Data p;
+  p.gamma=1.4;
+  p.R=287.05;
+
+  euler3d::RowVector_NEQS prim;
+  prim << 1.225, 30, 30, -20, 101300;
+  p.compute_from_primitive(prim);
+
+  euler3d::ColVector_NDIM normal; normal << 1., 1., 2.; normal.normalize();
+  euler3d::RowVector_NEQS flux;
+  Real wave_speed;
+  compute_convective_flux( p, normal, flux , wave_speed );
+
+  Real un = p.U.dot(normal);
+  BOOST_CHECK_CLOSE( flux[0] , p.rho*un            , 1e-10);
+  BOOST_CHECK_CLOSE( flux[1] , p.rho*p.U[XX]*un + p.p*normal[XX] , 1e-10);
+  BOOST_CHECK_CLOSE( flux[2] , p.rho*p.U[YY]*un + p.p*normal[YY] , 1e-10);
+  BOOST_CHECK_CLOSE( flux[3] , p.rho*p.U[ZZ]*un + p.p*normal[ZZ] , 1e-10);
+  BOOST_CHECK_CLOSE( flux[4] , (p.rho*p.E+p.p)*un , 1e-6);
+  BOOST_CHECK_CLOSE( wave_speed , std::abs(un)+p.c , 1e-10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Test_Euler3D_eigenvectors )
+{
+  euler3d::Data p;
+  p.gamma=1.4;
+  p.R=287.05;
+
+  euler3d::RowVector_NEQS prim;
+  prim << 1.225, 130, -40, 75, 101300;
+  p.compute_from_primitive(prim);
+
+  // Each branch of the choice of tangent vectors
+  euler3d::ColVector_NDIM normals[3];
+  normals[0] << 1., 2., 0.5;
+  normals[1] << 1., 0.5, 2.;
+  normals[2] << 0.5, 1., 2.;
+  for (Uint n=0; n<3; ++n)
+  {
+    euler3d::ColVector_NDIM normal = normals[n].normalized();
+    euler3d::ColVector_NDIM t1, t2;
+    euler3d::compute_tangent_vectors(normal,t1,t2);
+    BOOST_CHECK_SMALL( normal.dot(t1), 1e-14 );
+    BOOST_CHECK_SMALL( normal.dot(t2), 1e-14 );
+    BOOST_CHECK_SMALL( t1.dot(t2), 1e-14 );
+    BOOST_CHECK_CLOSE( t1.norm(), 1., 1e-12 );
+    BOOST_CHECK_CLOSE( normal.cross(t1).dot(t2), 1., 1e-12 );
+
+    euler3d::Matrix_NEQSxNEQS R, L;
+    compute_convective_right_eigenvectors(p,normal,R);
+    compute_convective_left_eigenvectors(p,normal,L);
+    const euler3d::Matrix_NEQSxNEQS identity = L*R;
+    BOOST_CHECK( identity.isIdentity(1e-10) );
+
+    // The eigen decomposition reproduces the flux Jacobian applied to a perturbation of the state
+    euler3d::RowVector_NEQS lambda;
+    compute_convective_eigenvalues(p,normal,lambda);
+    euler3d::RowVector_NEQS dcons; dcons << 1e-4*p.rho, 1e-4*p.rho*50., -1e-4*p.rho*20., 1e-4*p.rho*10., 1e-4*p.rho*p.E;
+    euler3d::Data q;
+    q.gamma=p.gamma;
+    q.R=p.R;
+    q.compute_from_conservative(p.cons+dcons);
+    euler3d::RowVector_NEQS flux_p, flux_q;
+    compute_convective_flux(p,normal,flux_p);
+    compute_convective_flux(q,normal,flux_q);
+    const euler3d::RowVector_NEQS dflux = (R*lambda.asDiagonal()*L*dcons.transpose()).transpose();
+    for (Uint eq=0; eq<euler3d::NEQS; ++eq)
+      BOOST_CHECK_SMALL( dflux[eq]-(flux_q[eq]-flux_p[eq]), 1e-3*(flux_q-flux_p).cwiseAbs().maxCoeff() );
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Test_Euler3D_riemann )
+{
+  euler3d::Data pL, pR;
+
+  pL.gamma=1.4;                                      pR.gamma=1.4;
+  pL.R=287.05;                                       pR.R=287.05;
+
+  euler3d::RowVector_NEQS prim_left, prim_right;
+  prim_left  << 4.696, 0, 0, 0, 404400; pL.compute_from_primitive(prim_left);
+  prim_right << 1.408, 0, 0, 0, 101100; pR.compute_from_primitive(prim_right);
+
+  euler3d::RowVector_NEQS flux_pos, flux_neg;
+  euler3d::ColVector_NDIM normal; normal << 0.,1.,1.; normal.normalize();
+  Real wave_speed;
+
+  compute_rusanov_flux( pL, pR, normal, flux_pos , wave_speed );
+  compute_rusanov_flux( pR, pL, -normal, flux_neg , wave_speed );
+  BOOST_CHECK_EQUAL ( flux_pos, -flux_neg );
+
+  compute_roe_flux( pL, pR,  normal, flux_pos , wave_speed );
+  compute_roe_flux( pR, pL, -normal, flux_neg , wave_speed );
+  BOOST_CHECK_EQUAL ( flux_pos, -flux_neg );
+
+  compute_hlle_flux( pL, pR,  normal, flux_pos , wave_speed );
+  compute_hlle_flux( pR, pL, -normal, flux_neg , wave_speed );
+  BOOST_CHECK_EQUAL ( flux_pos, -flux_neg );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Test_Euler3D_planar )
+{
+  // A flow without z-component gives the 2D fluxes
+  euler2d::Data pL2, pR2;
+  euler3d::Data pL3, pR3;
+  pL2.gamma=1.4;  pR2.gamma=1.4;  pL3.gamma=1.4;  pR3.gamma=1.4;
+  pL2.R=287.05;   pR2.R=287.05;   pL3.R=287.05;   pR3.R=287.05;
+
+  euler2d::RowVector_NEQS prim_left2, prim_right2;
+  prim_left2  << 1.2, 250., -80., 120000; pL2.compute_from_primitive(prim_left2);
+  prim_right2 << 0.9, 150.,  60., 90000;  pR2.compute_from_primitive(prim_right2);
+  euler3d::RowVector_NEQS prim_left3, prim_right3;
+  prim_left3  << 1.2, 250., -80., 0., 120000; pL3.compute_from_primitive(prim_left3);
+  prim_right3 << 0.9, 150.,  60., 0., 90000;  pR3.compute_from_primitive(prim_right3);
+
+  euler2d::ColVector_NDIM normal2; normal2 << 0.6, 0.8;
+  euler3d::ColVector_NDIM normal3; normal3 << 0.6, 0.8, 0.;
+
+  euler2d::RowVector_NEQS flux2;
+  euler3d::RowVector_NEQS flux3;
+  Real wave_speed2, wave_speed3;
+
+  const Uint map3d[] = {0, 1, 2, 4};
+
+  compute_roe_flux( pL2, pR2, normal2, flux2, wave_speed2 );
+  compute_roe_flux( pL3, pR3, normal3, flux3, wave_speed3 );
+  BOOST_CHECK_SMALL( flux3[3], 1e-10 );
+  BOOST_CHECK_CLOSE( wave_speed3, wave_speed2, 1e-10 );
+  for (Uint eq=0; eq<euler2d::NEQS; ++eq)
+    BOOST_CHECK_CLOSE( flux3[map3d[eq]], flux2[eq], 1e-10 );
+
+  compute_hlle_flux( pL2, pR2, normal2, flux2, wave_speed2 );
+  compute_hlle_flux( pL3, pR3, normal3, flux3, wave_speed3 );
+  BOOST_CHECK_SMALL( flux3[3], 1e-10 );
+  for (Uint eq=0; eq<euler2d::NEQS; ++eq)
+    BOOST_CHECK_CLOSE( flux3[map3d[eq]], flux2[eq], 1e-10 );
+
+  compute_rusanov_flux( pL2, pR2, normal2, flux2, wave_speed2 );
+  compute_rusanov_flux( pL3, pR3, normal3, flux3, wave_speed3 );
+  BOOST_CHECK_SMALL( flux3[3], 1e-10 );
+  for (Uint eq=0; eq<euler2d::NEQS; ++eq)
+    BOOST_CHECK_CLOSE( flux3[map3d[eq]], flux2[eq], 1e-10 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Test_Euler3D_roe_average )
+{
+  // Light and fast, so the kinetic energy dominates the total enthalpy
+  euler3d::Data p;
+  p.gamma=1.4;
+  p.R=287.05;
+  euler3d::RowVector_NEQS prim;
+  prim << 0.1, 180., 240., 0., 1e4;
+  p.compute_from_primitive(prim);
+  BOOST_CHECK_CLOSE(std::sqrt(p.U2), 300., 1e-10);
+
+  // The Roe average of two equal states is that state
+  euler3d::Data roe;
+  compute_roe_average(p, p, roe);
+  BOOST_CHECK_CLOSE(roe.rho, p.rho, 1e-10);
+  BOOST_CHECK_CLOSE(roe.H, p.H, 1e-10);
+  BOOST_CHECK_CLOSE(roe.c2, p.c2, 1e-10);
+  BOOST_CHECK_CLOSE(roe.c, p.c, 1e-10);
+  BOOST_CHECK_CLOSE(roe.p, p.p, 1e-10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -4,6 +4,8 @@
 // GNU Lesser General Public License version 3 (LGPLv3).
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 
@@ -174,7 +176,7 @@ void ComputeCFL::trigger_variable()
       compute_cfl(u, lit(m_cfl_scaling)),
       cfl = lit(m_dt) * lit(m_cfl_scaling),
       dt_max = lit(m_max_cfl) / lit(m_cfl_scaling),
-      lit(m_min_dt) = _min(lit(m_min_dt), dt_max)
+      lit(m_thread_min_dt) = _min(lit(m_thread_min_dt), dt_max)
     )
   ));
 }
@@ -182,7 +184,10 @@ void ComputeCFL::trigger_variable()
 void ComputeCFL::execute()
 {
   CFwarn << "executing CFL computation with dt " << m_dt << " and min_dt " << m_min_dt << CFendl;
+  m_thread_min_dt.set_all(m_min_dt);
   ProtoAction::execute();
+  for(Uint i = 0; i != CF3_PROTO_MAX_THREADS; ++i)
+    m_min_dt = std::min(m_min_dt, m_thread_min_dt.value(i));
 
   Real global_min_dt = m_min_dt;
   if(common::PE::Comm::instance().is_active())
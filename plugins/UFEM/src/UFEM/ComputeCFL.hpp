@@ -7,6 +7,7 @@
 #ifndef cf3_UFEM_ComputeCFL_hpp
 #define cf3_UFEM_ComputeCFL_hpp
 
+#include "solver/actions/Proto/ElementThreading.hpp"
 #include "solver/actions/Proto/ProtoAction.hpp"
 
 
@@ -34,10 +35,13 @@ public:
 private:
   /// Trigger executed when the tag or the variable name are changed
   void trigger_variable();
-  Real m_cfl_scaling;
+  /// CFL scaling of the current element, for each thread of the assembly loop
+  solver::actions::Proto::ThreadLocalReal m_cfl_scaling;
   Real m_max_cfl;
   Real m_dt;
   Real m_min_dt;
+  /// Minimum allowed time step over the elements visited by each thread
+  solver::actions::Proto::ThreadLocalReal m_thread_min_dt;
   Handle<solver::Time> m_time;
 };
 
@@ -147,9 +147,9 @@ void LSSAction::signature_create_lss(SignalArgs& node)
     .description("Name for the matrix builder to use when constructing the LSS")
     .mark_basic();
 
-  options.add("solution_strategy", "cf3.math.LSS.TrilinosStratimikosStrategy")
+  options.add("solution_strategy", "")
     .pretty_name("Solution Strategy")
-    .description("Builder name for the solution strategy to use.");
+    .description("Builder name for the solution strategy to use. If left empty, the default strategy for the matrix is used.");
 }
 
 void LSSAction::signal_create_lss(SignalArgs& node)
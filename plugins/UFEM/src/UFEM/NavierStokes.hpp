@@ -19,6 +19,8 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "solver/actions/Proto/ElementThreading.hpp"
+
 #include "LibUFEM.hpp"
 #include "LSSActionUnsteady.hpp"
 #include "NavierStokesPhysics.hpp"
@@ -103,8 +105,8 @@ private:
   PhysicsConstant kappa_heat_cond;
   // PhysicsConstant g_acceleration;
 
-  /// Storage of the stabilization coefficients
-  Real tau_ps, tau_su, tau_bulk;
+  /// Storage of the stabilization coefficients, with one value per thread of the assembly loop
+  solver::actions::Proto::ThreadLocalReal tau_ps, tau_su, tau_bulk;
   
   Handle<solver::ActionDirector> m_assembly;
   Handle<solver::ActionDirector> m_update;
@@ -18,6 +18,7 @@
 #define BOOST_MPL_LIMIT_METAFUNCTION_ARITY 10
 
 #include "solver/ActionDirector.hpp"
+#include "solver/actions/Proto/ElementThreading.hpp"
 #include "solver/actions/Proto/ProtoAction.hpp"
 
 #include "LibUFEM.hpp"
@@ -129,8 +130,8 @@ private:
   PhysicsConstant rho;
   PhysicsConstant nu;
 
-  /// Storage of the stabilization coefficients
-  Real tau_ps, tau_su, tau_bulk;
+  /// Storage of the stabilization coefficients, with one value per thread of the assembly loop
+  solver::actions::Proto::ThreadLocalReal tau_ps, tau_su, tau_bulk;
 
   /// Explcit algorithm constants
   Real gamma_u, gamma_p;
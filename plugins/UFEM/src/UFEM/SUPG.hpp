@@ -10,6 +10,7 @@
 #include "math/MatrixTypes.hpp"
 
 #include "solver/actions/Proto/ElementOperations.hpp"
+#include "solver/actions/Proto/ElementThreading.hpp"
 #include <solver/actions/Proto/ElementData.hpp>
 
 #include "NavierStokesPhysics.hpp"
@@ -71,6 +72,20 @@ struct ComputeTau
     tau_su = compute_tau_su(u, fabs(nu_eff.value().mean()));
   }
 
+  /// Threaded version of the full coefficient computation: writes into the values owned by the calling thread
+  template<typename UT, typename NUT>
+  void operator()(const UT& u, const NUT& nu_eff, const Real& u_ref, solver::actions::Proto::ThreadLocalReal& tau_ps, solver::actions::Proto::ThreadLocalReal& tau_su, solver::actions::Proto::ThreadLocalReal& tau_bulk) const
+  {
+    (*this)(u, nu_eff, u_ref, tau_ps.get(), tau_su.get(), tau_bulk.get());
+  }
+
+  /// Threaded version of the SUPG coefficient computation
+  template<typename UT, typename NUT>
+  void operator()(const UT& u, const NUT& nu_eff, solver::actions::Proto::ThreadLocalReal& tau_su) const
+  {
+    (*this)(u, nu_eff, tau_su.get());
+  }
+
   template<typename UT>
   Real compute_tau_su(const UT& u, const Real& element_nu) const
   {
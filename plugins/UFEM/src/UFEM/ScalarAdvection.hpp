@@ -25,6 +25,8 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "solver/actions/Proto/ElementThreading.hpp"
+
 #include "LibUFEM.hpp"
 #include "LSSActionUnsteady.hpp"
 
@@ -56,8 +58,8 @@ private:
   /// Scalar diffusivity
   Real m_alpha;
 
-  /// Stabilization coefficient
-  Real tau_su;
+  /// Stabilization coefficient, with one value per thread of the assembly loop
+  solver::actions::Proto::ThreadLocalReal tau_su;
 };
 
 } // UFEM
@@ -90,10 +90,9 @@ struct ComputeSACoeffs
     {
       nu_t_cell = 0.;
     }
-    //coeffs.nu_t_cell = nu_t.value().mean();
-    coeffs.chi = nu_t_cell / nu_lam;
+    const Real chi = nu_t_cell / nu_lam;
 
-    coeffs.Kappa = 0.41;
+    const Real kappa = 0.41;
 
     // Computing S needs the gradient, which is calculated at a mapped coordinate.
     // We take the first gauss point here, i.e. we approximate the gradient by the value at the cell center.
@@ -102,30 +101,27 @@ struct ComputeSACoeffs
     const typename UT::GradientT& nabla_mat = u.nabla(GaussT::instance().coords); // access the gauss point, in this case (0.5, 0.5) for triangles and tetras and (0., 0.) otherwise
     Eigen::Matrix<Real, UT::dimension, UT::dimension> nabla_u = nabla_mat * u.value(); // The gradient of the velocity is the shape function gradient matrix multiplied with the nodal values
     // wall distance
-    // const Real d = u.support().coordinates(GaussT::instance().coords)[1]; // y-coordinate of the cell center
-    coeffs.D = u.support().coordinates(GaussT::instance().coords)[1]; // y-coordinate of the cell center
-    //coeffs.omega = sqrt(2.)*0.5*(nabla_u - nabla_u.transpose()).norm();
-    coeffs.omega = 0.5*(nabla_u - nabla_u.transpose()).norm();
-    coeffs.Fv1 = fv1(coeffs.chi, 7.1);
-    coeffs.Fv2 = 1 - (coeffs.chi/(1+coeffs.chi*coeffs.Fv1));
-    coeffs.shat = coeffs.omega + (nu_t_cell * coeffs.Fv2)/(coeffs.Kappa*coeffs.Kappa*coeffs.D*coeffs.D);
-    if(coeffs.shat < 0.3*coeffs.omega)
+    const Real d = u.support().coordinates(GaussT::instance().coords)[1]; // y-coordinate of the cell center
+    //omega = sqrt(2.)*0.5*(nabla_u - nabla_u.transpose()).norm();
+    const Real omega = 0.5*(nabla_u - nabla_u.transpose()).norm();
+    const Real f_v1 = fv1(chi, 7.1);
+    const Real f_v2 = 1 - (chi/(1+chi*f_v1));
+
+    // Results are stored in the values owned by the calling thread
+    Real& shat = coeffs.shat.get();
+    shat = omega + (nu_t_cell * f_v2)/(kappa*kappa*d*d);
+    if(shat < 0.3*omega)
     {
-      coeffs.shat = 0.3*coeffs.omega;
+      shat = 0.3*omega;
     }
-    coeffs.one_over_D_squared = 1/(coeffs.D*coeffs.D);
-    coeffs.one_over_Kappa = 1/coeffs.Kappa;
-    coeffs.one_over_Kappa_squared = 1/(coeffs.Kappa*coeffs.Kappa);
-    coeffs.one_over_shat = 1/coeffs.shat;
-    coeffs.one_over_KappaD_squared = 1/(coeffs.D * coeffs.D * coeffs.Kappa * coeffs.Kappa);
-    // Average cell velocity
-    //const typename ElementT::CoordsT u_avg = u.value().colwise().mean();
+    coeffs.one_over_D_squared.get() = 1/(d*d);
 
-    coeffs.min = (nu_t_cell)/(coeffs.shat * coeffs.Kappa * coeffs.Kappa * coeffs.D * coeffs.D);
+    Real& min = coeffs.min.get();
+    min = (nu_t_cell)/(shat * kappa * kappa * d * d);
 
-    if(coeffs.min > 10.)
+    if(min > 10.)
     {
-      coeffs.min = 10.;
+      min = 10.;
     }
   }
 };
@@ -212,7 +208,7 @@ SpalartAllmaras::SpalartAllmaras(const std::string& name) :
 
                        (
                         _A = _0, _T = _0,
-                        UFEM::compute_tau(u_adv, nu_eff, tau_su),
+                        UFEM::compute_tau(u_adv, nu_eff, lit(tau_su)),
                         compute_sa_coeffs(u_adv, NU, m_sa_coeffs, nu_lam),
                         element_quadrature
                         (
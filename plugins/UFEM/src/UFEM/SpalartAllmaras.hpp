@@ -25,6 +25,8 @@
 
 #include <boost/scoped_ptr.hpp>
 
+#include "solver/actions/Proto/ElementThreading.hpp"
+
 #include "LibUFEM.hpp"
 #include "LSSActionUnsteady.hpp"
 
@@ -34,30 +36,13 @@ namespace cf3 {
 
 namespace UFEM {
 
+/// Per-element coefficients that are referred to in the assembly expression.
+/// They are written for each element by compute_sa_coeffs, so each assembly thread has its own copy.
 struct SACoeffs
 {
-  /// Constants
-  Real Cb1;
-  Real Cw2;
-  Real Cw3;
-  Real Cv1;
-  Real Cv2;
-  Real Sigma;
-  Real MuLam;
-  Real omega;
-  Real shat;
-  Real Fv1;
-  Real Fv2;
-  Real Kappa;
-  Real D;
-  Real min;
-  Real nu_t_cell;
-  Real one_over_D_squared;
-  Real one_over_Kappa;
-  Real one_over_shat;
-  Real one_over_Kappa_squared;
-  Real one_over_KappaD_squared;
-  Real chi;
+  solver::actions::Proto::ThreadLocalReal shat;
+  solver::actions::Proto::ThreadLocalReal min;
+  solver::actions::Proto::ThreadLocalReal one_over_D_squared;
 };
 
 /// solver for SpalartAllmaras turbulence model
@@ -82,7 +67,8 @@ private:
   /// Coefficients for Model
    Real cb1, cb2, cw1, cw2, cw3, cv1, one_over_sigma;
    Real r, g, shat;
-   Real tau_su;
+   /// SUPG coefficient, computed for each element by the assembly threads
+   solver::actions::Proto::ThreadLocalReal tau_su;
 
 };
 
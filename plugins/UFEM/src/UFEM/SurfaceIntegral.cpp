@@ -83,15 +83,15 @@ void SurfaceIntegral::execute()
 {
   const Uint dim = m_physical_model->ndim();
   
-  m_integral_value.resize(dim);
-  m_integral_value.setZero();
+  m_integral_value.set_all(RealVector::Zero(dim));
   
   solver::actions::Proto::ProtoAction::execute();
   
   //TODO: Stop this from counting overlapping faces twice
-  std::vector<Real> local_v(dim);
-  for(Uint i = 0; i != dim; ++i)
-    local_v[i] = m_integral_value[i];
+  std::vector<Real> local_v(dim, 0.);
+  for(Uint thread = 0; thread != CF3_PROTO_MAX_THREADS; ++thread)
+    for(Uint i = 0; i != dim; ++i)
+      local_v[i] += m_integral_value.value(thread)[i];
   std::vector<Real> global_v(local_v.begin(), local_v.end());
   
   if(common::PE::Comm::instance().is_active())
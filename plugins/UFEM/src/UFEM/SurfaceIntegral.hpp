@@ -10,6 +10,7 @@
 #include "solver/History.hpp"
 
 #include "solver/actions/Proto/DirichletBC.hpp"
+#include "solver/actions/Proto/ElementThreading.hpp"
 #include "solver/actions/Proto/ProtoAction.hpp"
 
 
@@ -43,8 +44,8 @@ private:
   /// Name of the variable to use
   std::string m_variable_name;
   
-  /// Storage for the value of the surface integral
-  RealVector m_integral_value;
+  /// Storage for the value of the surface integral, summed separately by each thread of the loop
+  solver::actions::Proto::ThreadLocalVector m_integral_value;
   
   Handle<solver::History> m_history;
 };
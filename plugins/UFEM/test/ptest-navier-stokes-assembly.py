@@ -26,7 +26,7 @@ def make_square(x_segs, y_segs):
   return blocks
 
 class TestCase:
-  def __init__(self, modelname, segments, use_spec):
+  def __init__(self, modelname, segments, use_spec, matrix_builder = 'cf3.math.LSS.TrilinosFEVbrMatrix', scatter_cache = False, nb_steps = 1):
     if len(sys.argv) == 2:
       self.nb_procs = int(sys.argv[1])
     else:
@@ -52,6 +52,9 @@ class TestCase:
     self.ns_solver.options().set('use_specializations', use_spec)
     self.ns_solver.options().set('disabled_actions', ['SolveLSS'])
     self.use_spec = use_spec
+    self.matrix_builder = matrix_builder
+    self.scatter_cache = scatter_cache
+    self.nb_steps = nb_steps
 
   def grow_overlap(self):
     if self.nb_procs > 1:
@@ -106,12 +109,14 @@ class TestCase:
   def setup_lss(self):
     self.grow_overlap()
     self.ns_solver.options().set('regions', [self.mesh.access_component('topology').uri()])
-    self.ns_solver.create_lss('cf3.math.LSS.TrilinosFEVbrMatrix')
+    self.ns_solver.create_lss(self.matrix_builder)
+    if self.scatter_cache:
+      self.ns_solver.get_child('LSS').get_child('Matrix').options().set('scatter_cache', True)
 
   def run(self):
     time = self.model.create_time()
     time.options().set('time_step', 1.)
-    time.options().set('end_time', 1.)
+    time.options().set('end_time', float(self.nb_steps))
     self.model.simulate()
     self.ns_solver.store_timings()
     try:
@@ -166,4 +171,15 @@ test_case.model.delete_component()
 test_case = TestCase('TetrasSpecialized', [80, 50, 50], True)
 test_case.cube_mesh_tetras()
 test_case.run()
-test_case.model.delete_component()
\ No newline at end of file
+test_case.model.delete_component()
+
+# Assembly into a CRS matrix over several time steps, with and without cached scatter positions
+test_case = TestCase('TetrasSpecializedCrs', [80, 50, 50], True, 'cf3.math.LSS.TrilinosCrsMatrix', False, 5)
+test_case.cube_mesh_tetras()
+test_case.run()
+test_case.model.delete_component()
+
+test_case = TestCase('TetrasSpecializedCrsCached', [80, 50, 50], True, 'cf3.math.LSS.TrilinosCrsMatrix', True, 5)
+test_case.cube_mesh_tetras()
+test_case.run()
+test_case.model.delete_component()
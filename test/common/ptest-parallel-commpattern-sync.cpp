@@ -0,0 +1,233 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+//
+// IMPORTANT:
+// measures the latency of CommPattern::synchronize against the number of processes,
+// every process has the same number of neighbours regardless of the total number of processes
+// for the sweep over the number of processes, configure with CF3_MPI_TESTS_RUN_SCALABILITY=ON or run:
+// python tools/test-mpi-scalability.py mpirun ./ptest-parallel-commpattern-sync 16 [nb_owned nb_ghosts nb_iterations]
+// on a single node this oversubscribes the cores, with openmpi set OMPI_MCA_rmaps_base_oversubscribe=1
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark for cf3::common 's parallel environment - neighbour synchronization of the commpattern."
+
+////////////////////////////////////////////////////////////////////////////////
+
+#include <set>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "common/Log.hpp"
+#include "common/Timer.hpp"
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommWrapper.hpp"
+#include "common/PE/CommPattern.hpp"
+#include "common/PE/debug.hpp"
+
+#include "Tools/Testing/DartMeasurement.hpp"
+
+////////////////////////////////////////////////////////////////////////////////
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::common::PE;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct CommPatternSyncFixture
+{
+  /// common setup for each test case
+  CommPatternSyncFixture() :
+    nb_owned(10000),
+    nb_ghosts(200),
+    nb_iterations(200),
+    stride(4)
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+    if (m_argc>1) nb_owned=boost::lexical_cast<int>(m_argv[1]);
+    if (m_argc>2) nb_ghosts=boost::lexical_cast<int>(m_argv[2]);
+    if (m_argc>3) nb_iterations=boost::lexical_cast<int>(m_argv[3]);
+  }
+
+  /// the neighbours are the three processes on either side in a ring, at most 6 regardless of the number of processes
+  std::set<int> neighbours() const
+  {
+    const int nproc=PE::Comm::instance().size();
+    const int irank=PE::Comm::instance().rank();
+    std::set<int> result;
+    for (int d=1; d<=3; d++)
+    {
+      result.insert((irank+d)%nproc);
+      result.insert(((irank-d)%nproc+nproc)%nproc);
+    }
+    result.erase(irank);
+    return result;
+  }
+
+  /// owned nodes first, followed by nb_ghosts ghosts of the first owned nodes of each neighbour
+  void setup_gid_and_rank(std::vector<Uint>& gid, std::vector<Uint>& rank) const
+  {
+    const int irank=PE::Comm::instance().rank();
+    gid.clear();
+    rank.clear();
+    for (int i=0; i<nb_owned; i++)
+    {
+      gid.push_back(irank*nb_owned+i);
+      rank.push_back(irank);
+    }
+    const std::set<int> nbs=neighbours();
+    for (std::set<int>::const_iterator nb=nbs.begin(); nb!=nbs.end(); ++nb)
+      for (int i=0; i<nb_ghosts; i++)
+      {
+        gid.push_back((*nb)*nb_owned+i);
+        rank.push_back(*nb);
+      }
+  }
+
+  /// owned values are computed from the gid, ghost values are invalid until synchronized
+  void fill_data(const std::vector<Uint>& gid, const std::vector<Uint>& rank, std::vector<double>& data) const
+  {
+    const Uint irank=PE::Comm::instance().rank();
+    data.resize(gid.size()*stride);
+    for (int i=0; i<(const int)gid.size(); i++)
+      for (int j=0; j<stride; j++)
+        data[i*stride+j] = rank[i]==irank ? (double)(gid[i]*stride+j) : -1.;
+  }
+
+  /// check that all ghosts were updated
+  void check_data(const std::vector<Uint>& gid, const std::vector<double>& data) const
+  {
+    int nb_wrong=0;
+    for (int i=0; i<(const int)gid.size(); i++)
+      for (int j=0; j<stride; j++)
+        if (data[i*stride+j]!=(double)(gid[i]*stride+j)) nb_wrong++;
+    BOOST_CHECK_EQUAL(nb_wrong,0);
+  }
+
+  /// print the slowest time per iteration over all processes, in the format expected by tools/test-mpi-scalability.py
+  void report(const std::string& name, const Real elapsed) const
+  {
+    const Real local_time=elapsed/(Real)nb_iterations;
+    Real time=0.;
+    PE::Comm::instance().all_reduce(PE::max(),&local_time,1,&time);
+    if (PE::Comm::instance().rank()==0)
+      dart_measurement(name + " time", time);
+  }
+
+  /// common params
+  int m_argc;
+  char** m_argv;
+
+  /// number of nodes owned by each process
+  int nb_owned;
+  /// number of nodes ghosted from each neighbour
+  int nb_ghosts;
+  /// number of timed synchronizations
+  int nb_iterations;
+  /// number of doubles per node
+  const int stride;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( CommPatternSyncSuite, CommPatternSyncFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( init )
+{
+  PE::Comm::instance().init(m_argc,m_argv);
+  BOOST_CHECK_EQUAL( PE::Comm::instance().is_active() , true );
+  CFinfo << "Benchmarking synchronization on " << PE::Comm::instance().size() << " processes, with " << nb_owned << " owned nodes and "
+         << nb_ghosts << " ghosts per neighbour" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( neighbour_synchronization )
+{
+  boost::shared_ptr<CommPattern> pecp_ptr = allocate_component<CommPattern>("CommPattern");
+  CommPattern& pecp = *pecp_ptr;
+
+  std::vector<Uint> gid;
+  std::vector<Uint> rank;
+  setup_gid_and_rank(gid,rank);
+  std::vector<double> data;
+  fill_data(gid,rank,data);
+
+  pecp.insert("gid",gid,1,false);
+  pecp.insert("data",data,stride,true);
+  pecp.setup(Handle<CommWrapper>(pecp.get_child("gid")),rank);
+
+  // first synchronization creates the persistent requests
+  pecp.synchronize("data");
+  check_data(gid,data);
+
+  PE::Comm::instance().barrier();
+  Timer timer;
+  for (int iter=0; iter<nb_iterations; iter++)
+    pecp.synchronize("data");
+  report("neighbour synchronize",timer.elapsed());
+
+  check_data(gid,data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( all_to_all_synchronization )
+{
+  // reference: the same exchange through all_to_all, which is O(nproc) even though there are only a few neighbours
+  const int nproc=PE::Comm::instance().size();
+
+  std::vector<Uint> gid;
+  std::vector<Uint> rank;
+  setup_gid_and_rank(gid,rank);
+  std::vector<double> data;
+  fill_data(gid,rank,data);
+
+  // the same first nb_ghosts nodes are sent to each neighbour, the ghosts are received in order of rank
+  std::vector<int> send_count(nproc,0);
+  std::vector<int> recv_count(nproc,0);
+  const std::set<int> nbs=neighbours();
+  for (std::set<int>::const_iterator nb=nbs.begin(); nb!=nbs.end(); ++nb)
+  {
+    send_count[*nb]=nb_ghosts;
+    recv_count[*nb]=nb_ghosts;
+  }
+  std::vector<double> sndbuf(nbs.size()*nb_ghosts*stride);
+  std::vector<double> rcvbuf(nbs.size()*nb_ghosts*stride);
+
+  PE::Comm::instance().barrier();
+  Timer timer;
+  for (int iter=0; iter<nb_iterations; iter++)
+  {
+    for (int n=0; n<(const int)nbs.size(); n++)
+      std::copy(data.begin(),data.begin()+nb_ghosts*stride,sndbuf.begin()+n*nb_ghosts*stride);
+    PE::Comm::instance().all_to_all(sndbuf,send_count,rcvbuf,recv_count,stride);
+    std::copy(rcvbuf.begin(),rcvbuf.end(),data.begin()+nb_owned*stride);
+  }
+  report("all_to_all synchronize",timer.elapsed());
+
+  check_data(gid,data);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( finalize )
+{
+  PE::Comm::instance().finalize();
+  BOOST_CHECK_EQUAL( PE::Comm::instance().is_active() , false );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,273 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Throughput of the linear system backends: assembly, matrix-vector product and solve"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/Log.hpp"
+#include "common/OptionList.hpp"
+#include "common/Timer.hpp"
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+
+#include "math/LSS/System.hpp"
+#include "math/LSS/SolutionStrategy.hpp"
+#include "math/LSS/Native/NativeMatrix.hpp"
+
+#include "Tools/Testing/DartMeasurement.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::math;
+using namespace cf3::math::LSS;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Benchmarks the assembly and solution of a diffusion-reaction problem on a structured
+/// hexahedral grid of nodes, with neq uncoupled equations per node.
+/// Arguments: matrix builder name, number of nodes in each direction, number of equations, number of threads
+struct LSSBenchmarkFixture
+{
+  LSSBenchmarkFixture() :
+    nb_products(50)
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+    if(m_argc < 2)
+      throw common::ParsingFailed(FromHere(), "Failed to parse command line arguments: expected the builder name for the matrix, and optionally the grid size, number of equations and number of threads");
+    matrix_builder = m_argv[1];
+    n = m_argc > 2 ? boost::lexical_cast<Uint>(m_argv[2]) : 40u;
+    neq = m_argc > 3 ? boost::lexical_cast<Uint>(m_argv[3]) : 3u;
+    nb_threads = m_argc > 4 ? boost::lexical_cast<Uint>(m_argv[4]) : 1u;
+  }
+
+  Uint node(const Uint i, const Uint j, const Uint k) const
+  {
+    return (k*n + j)*n + i;
+  }
+
+  int m_argc;
+  char** m_argv;
+
+  std::string matrix_builder;
+  Uint n;
+  Uint neq;
+  Uint nb_threads;
+  const Uint nb_products;
+
+  static boost::shared_ptr<PE::CommPattern> commpattern;
+  static boost::shared_ptr<System> system;
+  static std::vector<Uint> gids;
+  static std::vector<Uint> ranks;
+};
+
+boost::shared_ptr<PE::CommPattern> LSSBenchmarkFixture::commpattern;
+boost::shared_ptr<System> LSSBenchmarkFixture::system;
+std::vector<Uint> LSSBenchmarkFixture::gids;
+std::vector<Uint> LSSBenchmarkFixture::ranks;
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( LSSBenchmarkSuite, LSSBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Setup )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+  BOOST_CHECK_EQUAL(PE::Comm::instance().size(), 1);
+  Core::instance().environment().options().set("nb_threads", nb_threads);
+
+  const Uint nb_nodes = n*n*n;
+  gids.resize(nb_nodes);
+  ranks.assign(nb_nodes, 0);
+  for(Uint i = 0; i != nb_nodes; ++i)
+    gids[i] = i;
+
+  commpattern = allocate_component<PE::CommPattern>("commpattern");
+  commpattern->insert("gid", gids, 1, false);
+  commpattern->setup(Handle<PE::CommWrapper>(commpattern->get_child("gid")), ranks);
+
+  // 7-point stencil
+  std::vector<Uint> node_connectivity;
+  std::vector<Uint> starting_indices(1, 0);
+  node_connectivity.reserve(7*nb_nodes);
+  for(Uint k = 0; k != n; ++k)
+  {
+    for(Uint j = 0; j != n; ++j)
+    {
+      for(Uint i = 0; i != n; ++i)
+      {
+        if(k != 0) node_connectivity.push_back(node(i,j,k-1));
+        if(j != 0) node_connectivity.push_back(node(i,j-1,k));
+        if(i != 0) node_connectivity.push_back(node(i-1,j,k));
+        node_connectivity.push_back(node(i,j,k));
+        if(i != n-1) node_connectivity.push_back(node(i+1,j,k));
+        if(j != n-1) node_connectivity.push_back(node(i,j+1,k));
+        if(k != n-1) node_connectivity.push_back(node(i,j,k+1));
+        starting_indices.push_back(node_connectivity.size());
+      }
+    }
+  }
+
+  Timer timer;
+  system = allocate_component<System>("system");
+  system->options().set("matrix_builder", matrix_builder);
+  system->create(*commpattern, neq, node_connectivity, starting_indices);
+  dart_measurement(matrix_builder + " create time", timer.elapsed());
+
+  CFinfo << "Created " << matrix_builder << " system with " << nb_nodes << " nodes and " << neq << " equations per node" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Assembly )
+{
+  // one edge element per link in the grid, adding a diffusion operator and a reaction term
+  BlockAccumulator ba;
+  ba.resize(2, neq);
+  ba.reset(0.);
+  for(Uint e = 0; e != neq; ++e)
+  {
+    ba.mat(e, e) = 1. + 1e-3;
+    ba.mat(neq+e, neq+e) = 1. + 1e-3;
+    ba.mat(e, neq+e) = -1.;
+    ba.mat(neq+e, e) = -1.;
+  }
+
+  system->reset();
+  Timer timer;
+  for(Uint k = 0; k != n; ++k)
+  {
+    for(Uint j = 0; j != n; ++j)
+    {
+      for(Uint i = 0; i != n; ++i)
+      {
+        ba.indices[0] = node(i,j,k);
+        if(i != n-1) { ba.indices[1] = node(i+1,j,k); system->matrix()->add_values(ba); }
+        if(j != n-1) { ba.indices[1] = node(i,j+1,k); system->matrix()->add_values(ba); }
+        if(k != n-1) { ba.indices[1] = node(i,j,k+1); system->matrix()->add_values(ba); }
+      }
+    }
+  }
+  const Real assembly_time = timer.elapsed();
+  dart_measurement(matrix_builder + " assembly time", assembly_time);
+  dart_measurement(matrix_builder + " assembly Mblocks/s", 3.*n*n*(n-1)*4. / assembly_time * 1e-6);
+
+  // a source in one corner
+  system->rhs()->reset(0.);
+  for(Uint e = 0; e != neq; ++e)
+    system->rhs()->set_value(node(0,0,0), e, 1.);
+  system->solution()->reset(0.);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( CachedAssembly )
+{
+  if(!system->matrix()->options().check("scatter_cache"))
+  {
+    CFinfo << "Skipping the cached assembly for " << matrix_builder << CFendl;
+    return;
+  }
+  system->matrix()->options().set("scatter_cache", true);
+
+  BlockAccumulator ba;
+  ba.resize(2, neq);
+  ba.reset(0.);
+  for(Uint e = 0; e != neq; ++e)
+  {
+    ba.mat(e, e) = 1. + 1e-3;
+    ba.mat(neq+e, neq+e) = 1. + 1e-3;
+    ba.mat(e, neq+e) = -1.;
+    ba.mat(neq+e, e) = -1.;
+  }
+
+  // the edges are numbered by their first node and direction
+  const Uint nb_edges = 3*n*n*n;
+  const std::string names[2] = {"first cached assembly time", "cached assembly time"};
+  for(Uint pass = 0; pass != 2; ++pass)
+  {
+    system->matrix()->reset();
+    Timer timer;
+    for(Uint k = 0; k != n; ++k)
+    {
+      for(Uint j = 0; j != n; ++j)
+      {
+        for(Uint i = 0; i != n; ++i)
+        {
+          const Uint first_edge = 3*node(i,j,k);
+          ba.indices[0] = node(i,j,k);
+          if(i != n-1) { ba.indices[1] = node(i+1,j,k); ba.set_element(&gids, nb_edges, first_edge); system->matrix()->add_values(ba); }
+          if(j != n-1) { ba.indices[1] = node(i,j+1,k); ba.set_element(&gids, nb_edges, first_edge+1); system->matrix()->add_values(ba); }
+          if(k != n-1) { ba.indices[1] = node(i,j,k+1); ba.set_element(&gids, nb_edges, first_edge+2); system->matrix()->add_values(ba); }
+        }
+      }
+    }
+    dart_measurement(matrix_builder + " " + names[pass], timer.elapsed());
+  }
+
+  system->matrix()->options().set("scatter_cache", false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( MatrixVectorProduct )
+{
+  Handle<NativeMatrix> native(system->matrix());
+  if(is_null(native))
+  {
+    CFinfo << "Skipping the matrix-vector product for " << matrix_builder << ", it is part of the solve timing" << CFendl;
+    return;
+  }
+
+  const Uint size = n*n*n*neq;
+  std::vector<Real> x(size, 1.), y(size, 0.);
+  Timer timer;
+  for(Uint i = 0; i != nb_products; ++i)
+    native->apply(&x[0], &y[0]);
+  const Real product_time = timer.elapsed() / static_cast<Real>(nb_products);
+
+  // the diagonal entries in the interior of the grid cancel the off-diagonals, only the reaction term remains
+  BOOST_CHECK_CLOSE(y[node(n/2,n/2,n/2)*neq], 6e-3, 1e-6);
+
+  dart_measurement(matrix_builder + " SpMV time", product_time);
+  dart_measurement(matrix_builder + " SpMV GFlop/s", 2. * static_cast<Real>(native->block_values().size()) / product_time * 1e-9);
+  dart_measurement(matrix_builder + " SpMV threads", native->nb_threads(), "integer");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Solve )
+{
+  Timer timer;
+  system->solve();
+  dart_measurement(matrix_builder + " solve time", timer.elapsed());
+  dart_measurement(matrix_builder + " residual", system->solution_strategy()->compute_residual());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  system.reset();
+  commpattern.reset();
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,145 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Throughput of the evaluation of parsed functions, point by point and batched"
+
+#include <cmath>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
+#include "common/Timer.hpp"
+
+#include "math/VectorialFunction.hpp"
+
+#include "Tools/Testing/DartMeasurement.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::math;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Evaluates an inflow profile of the kind imposed on boundaries at every time step.
+/// Arguments: number of points, number of threads
+struct FunctionBatchFixture
+{
+  FunctionBatchFixture() :
+    function("[4*0.5*y*(1-y)*(1+0.1*sin(2*pi*t))][0.01*cos(pi*x)*exp(-t)][0]", "x,y,z,t")
+  {
+    int argc = boost::unit_test::framework::master_test_suite().argc;
+    char** argv = boost::unit_test::framework::master_test_suite().argv;
+    nb_points = argc > 1 ? boost::lexical_cast<Uint>(argv[1]) : 1000000u;
+    nb_threads = argc > 2 ? boost::lexical_cast<Uint>(argv[2]) : 1u;
+
+    vars.resize(4, std::vector<Real>(nb_points));
+    for(Uint p = 0; p != nb_points; ++p)
+    {
+      vars[0][p] = std::cos(Real(p));
+      vars[1][p] = Real(p) / Real(nb_points);
+      vars[2][p] = 0.;
+      vars[3][p] = 0.25;
+    }
+    results.resize(function.nbfuncs(), std::vector<Real>(nb_points));
+  }
+
+  VectorialFunction function;
+  Uint nb_points;
+  Uint nb_threads;
+  std::vector< std::vector<Real> > vars;
+  std::vector< std::vector<Real> > results;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( FunctionBatchSuite, FunctionBatchFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( PerPoint )
+{
+  std::vector<Real> point(vars.size());
+  RealVector result(function.nbfuncs());
+
+  Timer timer;
+  for(Uint p = 0; p != nb_points; ++p)
+  {
+    for(Uint v = 0; v != vars.size(); ++v)
+      point[v] = vars[v][p];
+    function.evaluate(point, result);
+    for(Uint f = 0; f != result.size(); ++f)
+      results[f][p] = result[f];
+  }
+  const Real elapsed = timer.elapsed();
+  dart_measurement("per point time", elapsed);
+  dart_measurement("per point Mpoints/s", nb_points / elapsed * 1e-6);
+}
+
+BOOST_AUTO_TEST_CASE( Batch )
+{
+  Core::instance().environment().options().set("nb_threads", nb_threads);
+
+  std::vector<const Real*> vars_ptr(vars.size());
+  std::vector<Real*> results_ptr(results.size());
+  for(Uint v = 0; v != vars.size(); ++v)
+    vars_ptr[v] = &vars[v][0];
+  for(Uint f = 0; f != results.size(); ++f)
+    results_ptr[f] = &results[f][0];
+
+  Timer timer;
+  function.evaluate_batch(nb_points, &vars_ptr[0], &results_ptr[0]);
+  const Real elapsed = timer.elapsed();
+  dart_measurement("batch time", elapsed);
+  dart_measurement("batch Mpoints/s", nb_points / elapsed * 1e-6);
+
+  // Spot check against the per point evaluation
+  std::vector<Real> point(vars.size());
+  RealVector result(function.nbfuncs());
+  for(Uint p = 0; p < nb_points; p += nb_points/100 + 1)
+  {
+    for(Uint v = 0; v != vars.size(); ++v)
+      point[v] = vars[v][p];
+    function.evaluate(point, result);
+    for(Uint f = 0; f != result.size(); ++f)
+      BOOST_CHECK_EQUAL(results[f][p], result[f]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( CompiledBatch )
+{
+  Core::instance().environment().options().set("nb_threads", nb_threads);
+
+  // Compiling (or loading from the cache) is not part of the measurement
+  if(!function.compile())
+  {
+    std::cout << "Functions not compiled, skipping" << std::endl;
+    return;
+  }
+
+  std::vector<const Real*> vars_ptr(vars.size());
+  std::vector<Real*> results_ptr(results.size());
+  for(Uint v = 0; v != vars.size(); ++v)
+    vars_ptr[v] = &vars[v][0];
+  for(Uint f = 0; f != results.size(); ++f)
+    results_ptr[f] = &results[f][0];
+
+  Timer timer;
+  function.evaluate_batch(nb_points, &vars_ptr[0], &results_ptr[0]);
+  const Real elapsed = timer.elapsed();
+  dart_measurement("compiled batch time", elapsed);
+  dart_measurement("compiled batch Mpoints/s", nb_points / elapsed * 1e-6);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -11,6 +11,11 @@
 
 #include <boost/assign/list_of.hpp>
 
+#include "common/BoostFilesystem.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
+
 #include "math/VectorialFunction.hpp"
 
 using namespace std;
@@ -83,6 +88,126 @@ BOOST_AUTO_TEST_CASE( function_2 )
 
 
 
+/// Compare the batched evaluation with the evaluation point by point
+void check_batch(const std::string& functions, const Uint nb_points)
+{
+  cf3::math::VectorialFunction f (functions,"x,y");
+  std::vector< std::vector<Real> > vars(2, std::vector<Real>(nb_points));
+  for(Uint p = 0; p != nb_points; ++p)
+  {
+    vars[0][p] = -2. + 4.*Real(p)/Real(nb_points);
+    vars[1][p] = 0.5 + std::sin(Real(p));
+  }
+  std::vector< std::vector<Real> > results(f.nbfuncs(), std::vector<Real>(nb_points));
+  std::vector<const Real*> vars_ptr(2);
+  std::vector<Real*> results_ptr(f.nbfuncs());
+  vars_ptr[0] = &vars[0][0];
+  vars_ptr[1] = &vars[1][0];
+  for(Uint i = 0; i != f.nbfuncs(); ++i)
+    results_ptr[i] = &results[i][0];
+  f.evaluate_batch(nb_points, &vars_ptr[0], &results_ptr[0]);
+
+  std::vector<Real> u(2);
+  RealVector r(f.nbfuncs());
+  for(Uint p = 0; p != nb_points; ++p)
+  {
+    u[0] = vars[0][p];
+    u[1] = vars[1][p];
+    f.evaluate(u, r);
+    for(Uint i = 0; i != f.nbfuncs(); ++i)
+      BOOST_CHECK_EQUAL(results[i][p], r[i]);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( batch )
+{
+  check_batch("[x+y][5*x*y-sin(x)][sqrt(x*x+y*y)/(1+y)][pi*x^2]", 1000);
+}
+
+BOOST_AUTO_TEST_CASE( batch_failing_points )
+{
+  // sqrt and log fail for the negative x, where the parser returns 0
+  check_batch("[sqrt(x)][log(x)+y][1/floor(x)]", 1000);
+}
+
+BOOST_AUTO_TEST_CASE( batch_conditional )
+{
+  // if() is evaluated point by point
+  check_batch("[if(x<0,y,2*y)][x>y][(x<0)&(y>0.5)]", 1000);
+}
+
+BOOST_AUTO_TEST_CASE( batch_threads )
+{
+  Core::instance().environment().options().set("nb_threads", 4u);
+  check_batch("[x+y][cos(x)*exp(y)][sqrt(x)]", 100000);
+  Core::instance().environment().options().set("nb_threads", 1u);
+}
+
+BOOST_AUTO_TEST_CASE( compiled )
+{
+  // Keep the libraries of the test out of the shared cache
+  const boost::filesystem::path cache_dir = boost::filesystem::current_path() / "utest-function-parser-cache";
+  Core::instance().environment().options().set("function_cache_dir", cache_dir.string());
+
+  const std::string functions = "[x+y][5*x*y-sin(x)][sqrt(x)][log(x)+y][1/floor(x)][if(x<0,y,2*y)][(x<0)&(y>0.5)][(x+3)^y][y^3][x^-2][pi*x^2][cbrt(x)+atanh(y/2)]";
+  cf3::math::VectorialFunction interpreted (functions,"x,y");
+  cf3::math::VectorialFunction f (functions,"x,y");
+
+  // Without a working compiler the functions stay interpreted
+  if(!f.compile())
+  {
+    BOOST_TEST_MESSAGE("Functions not compiled, skipping the comparison");
+    return;
+  }
+
+  const Uint nb_points = 1000;
+  std::vector< std::vector<Real> > vars(2, std::vector<Real>(nb_points));
+  for(Uint p = 0; p != nb_points; ++p)
+  {
+    vars[0][p] = -2. + 4.*Real(p)/Real(nb_points);
+    vars[1][p] = 0.5 + std::sin(Real(p));
+  }
+  std::vector< std::vector<Real> > results(f.nbfuncs(), std::vector<Real>(nb_points));
+  std::vector<const Real*> vars_ptr(2);
+  std::vector<Real*> results_ptr(f.nbfuncs());
+  vars_ptr[0] = &vars[0][0];
+  vars_ptr[1] = &vars[1][0];
+  for(Uint i = 0; i != f.nbfuncs(); ++i)
+    results_ptr[i] = &results[i][0];
+  f.evaluate_batch(nb_points, &vars_ptr[0], &results_ptr[0]);
+
+  std::vector<Real> u(2);
+  RealVector r(f.nbfuncs());
+  RealVector r_interpreted(f.nbfuncs());
+  for(Uint p = 0; p != nb_points; ++p)
+  {
+    u[0] = vars[0][p];
+    u[1] = vars[1][p];
+    f.evaluate(u, r);
+    interpreted.evaluate(u, r_interpreted);
+    for(Uint i = 0; i != f.nbfuncs(); ++i)
+    {
+      BOOST_CHECK_CLOSE(r[i], r_interpreted[i], 1e-10);
+      BOOST_CHECK_EQUAL(results[i][p], r[i]);
+    }
+  }
+
+  // A second compilation of the same functions comes from the cache
+  cf3::math::VectorialFunction cached (functions,"x,y");
+  BOOST_CHECK(cached.compile());
+
+  // Libraries are not loaded from a directory where others can write
+  const boost::filesystem::path shared_dir = boost::filesystem::current_path() / "utest-function-parser-shared";
+  boost::filesystem::create_directories(shared_dir);
+  boost::filesystem::permissions(shared_dir, boost::filesystem::all_all);
+  Core::instance().environment().options().set("function_cache_dir", shared_dir.string());
+  cf3::math::VectorialFunction shared ("[x*y+3]","x,y");
+  BOOST_CHECK(!shared.compile());
+  BOOST_CHECK(boost::filesystem::is_empty(shared_dir));
+
+  Core::instance().environment().options().set("function_cache_dir", std::string());
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -14,7 +14,10 @@
 
 #include <boost/test/unit_test.hpp>
 #include <boost/assign/std/vector.hpp>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "common/Log.hpp"
 #include "math/LSS/System.hpp"
@@ -58,9 +61,11 @@ struct LSSAtomicFixture
     m_argc = boost::unit_test::framework::master_test_suite().argc;
     m_argv = boost::unit_test::framework::master_test_suite().argv;
 
-    if(m_argc != 2)
-      throw common::ParsingFailed(FromHere(), "Failed to parse command line arguments: expected one argument: builder name for the matrix");
+    if(m_argc != 2 && m_argc != 3)
+      throw common::ParsingFailed(FromHere(), "Failed to parse command line arguments: expected the builder name for the matrix and optionally its solver type");
     matrix_builder = m_argv[1];
+    if(m_argc == 3)
+      solvertype = m_argv[2];
   }
 
   /// common tear-down for each test case
@@ -126,6 +131,35 @@ struct LSSAtomicFixture
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Assemble the two-node elements of a chain of nodes, as a threaded element loop would: even elements first, then
+/// odd ones, so that the elements handled concurrently never share a node. Each thread takes a contiguous part of each color.
+void assemble_chain(LSS::Matrix& mat, const Uint nb_elems, const int neq, boost::barrier& barrier, const Uint thread_idx, const Uint nb_threads)
+{
+  static const int element_group=0;
+  LSS::BlockAccumulator ba;
+  ba.resize(2,neq);
+  for (Uint color=0; color!=2; ++color)
+  {
+    const Uint color_size=(nb_elems+1-color)/2;
+    const Uint begin=(color_size*thread_idx)/nb_threads;
+    const Uint end=(color_size*(thread_idx+1))/nb_threads;
+    for (Uint i=begin; i!=end; ++i)
+    {
+      const Uint elem=2*i+color;
+      ba.set_element(&element_group,nb_elems,elem);
+      ba.indices[0]=elem;
+      ba.indices[1]=elem+1;
+      for (int r=0; r<ba.mat.rows(); r++)
+        for (int c=0; c<ba.mat.cols(); c++)
+          ba.mat(r,c)=elem*100.+r*10.+c+1.;
+      mat.add_values(ba);
+    }
+    barrier.wait();
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_FIXTURE_TEST_SUITE( LSSAtomicSuite, LSSAtomicFixture )
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -319,6 +353,58 @@ BOOST_AUTO_TEST_CASE( test_matrix_only )
         }
   }
 
+  // performant access through the cached element positions, must give the same result as without cache
+  if (mat->options().check("scatter_cache"))
+  {
+    mat->options().set("scatter_cache",true);
+    mat->reset();
+    LSS::BlockAccumulator ba;
+    ba.resize(3,neq);
+    const int element_group=0;
+    ba.set_element(&element_group,2,1);
+    if (irank==0)
+    {
+      // nodes 3 and 5 are ghosts, their rows are skipped
+      ba.indices[0]=1;
+      ba.indices[1]=3;
+      ba.indices[2]=5;
+    }
+    else
+    {
+      ba.indices[0]=5;
+      ba.indices[1]=2;
+      ba.indices[2]=8;
+    }
+    for (int i=0; i<ba.mat.rows(); i++)
+      for (int j=0; j<ba.mat.cols(); j++)
+        ba.mat(i,j)=ba.indices[i/neq]*10+i%neq*6+j+1;
+    const RealMatrix element_matrix=ba.mat;
+
+    // first pass fills the cache, the second uses it
+    mat->add_values(ba);
+    mat->add_values(ba);
+
+    // changed nodes for the same element must not use the stale positions
+    std::swap(ba.indices[0],ba.indices[2]);
+    mat->add_values(ba);
+    std::swap(ba.indices[0],ba.indices[2]);
+
+    mat->get_values(ba);
+    for (int i=0; i<ba.mat.rows(); i++)
+    {
+      if (!cp.isUpdatable()[ba.indices[i/neq]])
+        continue;
+      for (int j=0; j<ba.mat.cols(); j++)
+      {
+        // the swapped element adds the entry (i,j) of the original as entry (swapped i, swapped j)
+        const int swapped_i=(2-i/neq)*neq+i%neq;
+        const int swapped_j=(2-j/neq)*neq+j%neq;
+        BOOST_CHECK_EQUAL(ba.mat(i,j),2.*element_matrix(i,j)+element_matrix(swapped_i,swapped_j));
+      }
+    }
+    mat->options().set("scatter_cache",false);
+  }
+
   // bc-related: dirichlet-condition
   mat->reset(-1.);
   if (irank==0)
@@ -472,6 +558,66 @@ BOOST_AUTO_TEST_CASE( test_matrix_only )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+// concurrent add_values from several threads through the scatter cache, as done by the threaded proto element loops
+BOOST_AUTO_TEST_CASE( test_threaded_scatter_cache )
+{
+  // each rank owns a separate chain of nodes
+  const Uint nb_nodes=1000;
+  const Uint nb_elems=nb_nodes-1;
+  std::vector<Uint> chain_gid(nb_nodes);
+  std::vector<Uint> chain_rank(nb_nodes,irank);
+  std::vector<Uint> chain_connectivity;
+  std::vector<Uint> chain_starting_indices(1,0);
+  for (Uint i=0; i!=nb_nodes; ++i)
+  {
+    chain_gid[i]=irank*nb_nodes+i;
+    if (i!=0) chain_connectivity.push_back(i-1);
+    chain_connectivity.push_back(i);
+    if (i!=nb_nodes-1) chain_connectivity.push_back(i+1);
+    chain_starting_indices.push_back(chain_connectivity.size());
+  }
+
+  boost::shared_ptr<common::PE::CommPattern> cp_ptr = common::allocate_component<common::PE::CommPattern>("commpattern");
+  common::PE::CommPattern& cp = *cp_ptr;
+  cp.insert("gid",chain_gid,1,false);
+  cp.setup(Handle<common::PE::CommWrapper>(cp.get_child("gid")),chain_rank);
+  boost::shared_ptr<LSS::System> sys(common::allocate_component<LSS::System>("sys"));
+  sys->options().option("matrix_builder").change_value(matrix_builder);
+  sys->create(cp,neq,chain_connectivity,chain_starting_indices);
+  Handle<LSS::Matrix> mat=sys->matrix();
+  if (!mat->options().check("scatter_cache"))
+    return;
+
+  // reference: serial assembly without cache
+  std::vector<Uint> rows, cols;
+  std::vector<Real> reference, vals;
+  mat->reset();
+  {
+    boost::barrier barrier(1);
+    assemble_chain(*mat,nb_elems,neq,barrier,0,1);
+  }
+  mat->debug_data(rows,cols,reference);
+
+  // threaded assembly: the first pass fills the cache concurrently, the second uses it
+  const Uint nb_threads=4;
+  mat->options().set("scatter_cache",true);
+  for (Uint pass=0; pass!=2; ++pass)
+  {
+    mat->reset();
+    boost::barrier barrier(nb_threads);
+    boost::thread_group threads;
+    for (Uint i=0; i!=nb_threads; ++i)
+      threads.create_thread(boost::bind(&assemble_chain,boost::ref(*mat),nb_elems,neq,boost::ref(barrier),i,nb_threads));
+    threads.join_all();
+
+    mat->debug_data(rows,cols,vals);
+    BOOST_CHECK(vals==reference);
+  }
+  mat->options().set("scatter_cache",false);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( test_vector_only )
 {
   // build a commpattern and the two vectors
@@ -843,7 +989,7 @@ BOOST_AUTO_TEST_CASE( test_complete_system )
 
   // test swapping rhs and sol
   boost::shared_ptr<LSS::System> sys2(common::allocate_component<LSS::System>("sys2"));
-  sys->options().option("matrix_builder").change_value(matrix_builder);
+  sys2->options().option("matrix_builder").change_value(matrix_builder);
   build_system(*sys2,cp);
   BOOST_CHECK_EQUAL(sys2->is_created(),true);
   BOOST_CHECK_EQUAL(sys2->solvertype(),solvertype);
@@ -928,8 +1074,15 @@ BOOST_AUTO_TEST_CASE( solve_system )
 
   sys->solution_strategy()->options().set("compute_residual", true);
   sys->solution_strategy()->options().set("verbosity_level", 3);
-  sys->solution_strategy()->access_component("Parameters")->options().set("preconditioner_type", std::string("None"));
-  sys->solution_strategy()->access_component("Parameters/LinearSolverTypes/Belos/SolverTypes/BlockGMRES")->options().set("verbosity", 1);
+  if (solvertype=="Trilinos")
+  {
+    sys->solution_strategy()->access_component("Parameters")->options().set("preconditioner_type", std::string("None"));
+    sys->solution_strategy()->access_component("Parameters/LinearSolverTypes/Belos/SolverTypes/BlockGMRES")->options().set("verbosity", 1);
+  }
+  else
+  {
+    sys->solution_strategy()->options().set("tolerance", 1e-12);
+  }
 
   // set intital values and boundary conditions
   sys->matrix()->reset(-0.5);
@@ -1028,9 +1181,16 @@ BOOST_AUTO_TEST_CASE( solve_system_blocked )
 
   sys->solution_strategy()->options().set("compute_residual", true);
   sys->solution_strategy()->options().set("verbosity_level", 3);
-  sys->solution_strategy()->access_component("Parameters")->options().set("preconditioner_type", std::string("None"));
-  sys->solution_strategy()->access_component("Parameters/LinearSolverTypes/Belos/SolverTypes/BlockGMRES")->options().set("verbosity", 1);
-  sys->solution_strategy()->access_component("Parameters/LinearSolverTypes/Belos/SolverTypes/BlockGMRES")->options().set("convergence_tolerance", 0.1);
+  if (solvertype=="Trilinos")
+  {
+    sys->solution_strategy()->access_component("Parameters")->options().set("preconditioner_type", std::string("None"));
+    sys->solution_strategy()->access_component("Parameters/LinearSolverTypes/Belos/SolverTypes/BlockGMRES")->options().set("verbosity", 1);
+    sys->solution_strategy()->access_component("Parameters/LinearSolverTypes/Belos/SolverTypes/BlockGMRES")->options().set("convergence_tolerance", 0.1);
+  }
+  else
+  {
+    sys->solution_strategy()->options().set("tolerance", 1e-12);
+  }
 
   // set intital values and boundary conditions
   sys->matrix()->reset(-0.5);
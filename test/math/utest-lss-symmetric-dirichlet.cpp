@@ -58,9 +58,11 @@ struct LSSSymmetricDirichletFixture
     m_argc = boost::unit_test::framework::master_test_suite().argc;
     m_argv = boost::unit_test::framework::master_test_suite().argv;
 
-    if(m_argc != 2)
-      throw common::ParsingFailed(FromHere(), "Failed to parse command line arguments: expected one argument: builder name for the matrix");
+    if(m_argc != 2 && m_argc != 3)
+      throw common::ParsingFailed(FromHere(), "Failed to parse command line arguments: expected the builder name for the matrix and optionally its solver type");
     matrix_builder = m_argv[1];
+    if(m_argc == 3)
+      solvertype = m_argv[2];
   }
 
   /// common tear-down for each test case
@@ -0,0 +1,191 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Benchmark of the node to element connectivity storage: DynTable against CSRTable"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
+#include "common/Log.hpp"
+#include "common/Timer.hpp"
+#include "common/DynTable.hpp"
+#include "common/CSRTable.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/NodeElementConnectivity.hpp"
+
+#include "Tools/Testing/DartMeasurement.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct CSRTableBenchmarkFixture
+{
+  CSRTableBenchmarkFixture() :
+    nb_traversals(20)
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Sum of all entries, traversing the table row by row
+  template<typename TableT>
+  static Uint traverse(const TableT& table)
+  {
+    Uint sum = 0;
+    const Uint nb_rows = table.size();
+    for(Uint i = 0; i != nb_rows; ++i)
+    {
+      boost_foreach(const Uint elem, table[i])
+        sum += elem;
+    }
+    return sum;
+  }
+
+  /// Time per traversal of the table
+  template<typename TableT>
+  Real time_traversal(const TableT& table, Uint& sum) const
+  {
+    Timer timer;
+    for(Uint i = 0; i != nb_traversals; ++i)
+      sum = traverse(table);
+    return timer.elapsed() / static_cast<Real>(nb_traversals);
+  }
+
+  int m_argc;
+  char** m_argv;
+
+  const Uint nb_traversals;
+
+  /// Results of both storage methods, to check they match
+  static Uint dyntable_sum;
+  static Uint csrtable_sum;
+};
+
+Uint CSRTableBenchmarkFixture::dyntable_sum = 0;
+Uint CSRTableBenchmarkFixture::csrtable_sum = 0;
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( CSRTableBenchmarkSuite, CSRTableBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Setup )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+
+  const Uint nb_segments = m_argc > 1 ? boost::lexical_cast<Uint>(m_argv[1]) : 40u;
+
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("mesh");
+  boost::shared_ptr< MeshGenerator > generate_mesh = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","meshgenerator");
+  generate_mesh->options().set("nb_cells",std::vector<Uint>(3,nb_segments));
+  generate_mesh->options().set("lengths",std::vector<Real>(3,1.));
+  generate_mesh->options().set("mesh",mesh.uri());
+  generate_mesh->execute();
+
+  CFinfo << "Generated box mesh with " << mesh.geometry_fields().size() << " nodes" << CFendl;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( DynTableConnectivity )
+{
+  Mesh& mesh = *Core::instance().root().get_child("mesh")->handle<Mesh>();
+  const Uint nb_nodes = mesh.geometry_fields().size();
+
+  // Build the node to element table as NodeElementConnectivity did using a DynTable: one vector per node
+  Timer timer;
+  DynTable<Uint>& table = *mesh.create_component< DynTable<Uint> >("dyntable_node2elem");
+  table.resize(nb_nodes);
+  std::vector<Uint> connectivity_sizes(nb_nodes);
+  boost_foreach(const Elements& elements, find_components_recursively<Elements>(mesh.topology()))
+  {
+    boost_foreach(Connectivity::ConstRow elem_nodes, elements.geometry_space().connectivity().array())
+    {
+      boost_foreach(const Uint node_idx, elem_nodes)
+        ++connectivity_sizes[node_idx];
+    }
+  }
+  for(Uint i = 0; i != nb_nodes; ++i)
+    table.array()[i].reserve(connectivity_sizes[i]);
+  Uint glb_elem_idx = 0;
+  boost_foreach(const Elements& elements, find_components_recursively<Elements>(mesh.topology()))
+  {
+    boost_foreach(Connectivity::ConstRow elem_nodes, elements.geometry_space().connectivity().array())
+    {
+      boost_foreach(const Uint node_idx, elem_nodes)
+        table.array()[node_idx].push_back(glb_elem_idx);
+      ++glb_elem_idx;
+    }
+  }
+  const Real build_time = timer.elapsed();
+
+  // Heap use, not counting the allocator overhead of each of the nb_nodes separate allocations
+  Uint memory = table.array().capacity()*sizeof(std::vector<Uint>);
+  boost_foreach(DynTable<Uint>::ConstRow row, table.array())
+    memory += row.capacity()*sizeof(Uint);
+
+  const Real traversal_time = time_traversal(table, dyntable_sum);
+
+  dart_measurement("DynTable build time", build_time);
+  dart_measurement("DynTable traversal time", traversal_time);
+  dart_measurement("DynTable memory", memory, "integer");
+  dart_measurement("DynTable allocations", nb_nodes+1, "integer");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( CSRTableConnectivity )
+{
+  Mesh& mesh = *Core::instance().root().get_child("mesh")->handle<Mesh>();
+
+  Timer timer;
+  NodeElementConnectivity& node2elem = *mesh.create_component<NodeElementConnectivity>("node2elem");
+  node2elem.setup(mesh.topology());
+  const Real build_time = timer.elapsed();
+
+  const CSRTable<Uint>& table = node2elem.connectivity();
+  const Real traversal_time = time_traversal(table, csrtable_sum);
+
+  dart_measurement("CSRTable build time", build_time);
+  dart_measurement("CSRTable traversal time", traversal_time);
+  dart_measurement("CSRTable memory", table.memory_size(), "integer");
+  dart_measurement("CSRTable allocations", 2, "integer");
+
+  BOOST_CHECK_EQUAL(table.size(), mesh.geometry_fields().size());
+  BOOST_CHECK_EQUAL(csrtable_sum, dyntable_sum);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,117 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Throughput of the gmsh reader for the ASCII and binary formats"
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/Timer.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshReader.hpp"
+
+#include "Tools/Testing/DartMeasurement.hpp"
+
+#include "utest-mesh-gmsh-grid.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Writes an n by n grid in each gmsh format and times reading it back.
+/// Arguments: number of quads in each direction
+struct GmshBenchmarkFixture
+{
+  GmshBenchmarkFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+    n = m_argc > 1 ? boost::lexical_cast<Uint>(m_argv[1]) : 400u;
+  }
+
+  void benchmark(const std::string& format, const Uint version, const bool binary)
+  {
+    const std::string filename = "benchmark-" + format + ".msh";
+    if(PE::Comm::instance().rank() == 0)
+      gmsh_grid::write_grid(filename, n, n, version, binary);
+    PE::Comm::instance().barrier();
+
+    boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.gmsh.Reader","meshreader");
+    Handle<Mesh> mesh = Core::instance().root().create_component<Mesh>("mesh_" + format);
+
+    Timer timer;
+    reader->read_mesh_into(filename, *mesh);
+    const Real read_time = timer.elapsed();
+
+    const Real file_size = static_cast<Real>(boost::filesystem::file_size(filename));
+    dart_measurement(format + " read time", read_time);
+    dart_measurement(format + " MB/s", file_size / read_time * 1e-6);
+    CFinfo << "Read " << n << "x" << n << " grid in gmsh " << format << " format (" << file_size*1e-6 << " MB) in " << read_time << " s" << CFendl;
+
+    Core::instance().root().remove_component(*mesh);
+  }
+
+  int m_argc;
+  char** m_argv;
+  Uint n;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( GmshBenchmarkSuite, GmshBenchmarkFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Version2Ascii )
+{
+  benchmark("v2-ascii", 2, false);
+}
+
+BOOST_AUTO_TEST_CASE( Version2Binary )
+{
+  benchmark("v2-binary", 2, true);
+}
+
+BOOST_AUTO_TEST_CASE( Version4Ascii )
+{
+  benchmark("v4-ascii", 4, false);
+}
+
+BOOST_AUTO_TEST_CASE( Version4Binary )
+{
+  benchmark("v4-binary", 4, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
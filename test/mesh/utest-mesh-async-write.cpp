@@ -0,0 +1,245 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::AsyncWriteMesh"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Table.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/AsyncWriteMesh.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/MeshReader.hpp"
+#include "mesh/MeshWriter.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Writer that blocks until it is opened, to simulate a slow file system
+class GatedWriter : public MeshWriter
+{
+public:
+  GatedWriter(const std::string& name) : MeshWriter(name), m_open(false), m_nb_written(0) {}
+
+  static std::string type_name() { return "GatedWriter"; }
+
+  virtual std::string get_format() { return "Gated"; }
+
+  virtual std::vector<std::string> get_extensions() { return std::vector<std::string>(1, ".gated"); }
+
+  virtual void write()
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    while(!m_open)
+      m_condition.wait(lock);
+    ++m_nb_written;
+  }
+
+  /// Let the blocked and future writes complete
+  void open()
+  {
+    {
+      boost::mutex::scoped_lock lock(m_mutex);
+      m_open = true;
+    }
+    m_condition.notify_all();
+  }
+
+  Uint nb_written()
+  {
+    boost::mutex::scoped_lock lock(m_mutex);
+    return m_nb_written;
+  }
+
+private:
+  boost::mutex m_mutex;
+  boost::condition_variable m_condition;
+  bool m_open;
+  Uint m_nb_written;
+};
+
+/// Writer that reports making collective calls, without making any
+class CollectiveWriter : public MeshWriter
+{
+public:
+  CollectiveWriter(const std::string& name) : MeshWriter(name), m_nb_written(0) {}
+
+  static std::string type_name() { return "CollectiveWriter"; }
+
+  virtual std::string get_format() { return "Collective"; }
+
+  virtual std::vector<std::string> get_extensions() { return std::vector<std::string>(1, ".collective"); }
+
+  virtual bool is_collective() { return true; }
+
+  virtual void write() { ++m_nb_written; }
+
+  Uint m_nb_written;
+};
+
+/// Call write_mesh from a thread that is not the main thread
+void write_mesh_in_thread(AsyncWriteMesh& writer, const Mesh& mesh, const URI& file)
+{
+  Logger::instance().set_thread_muted(true);
+  writer.write_mesh(mesh, file, std::vector<URI>());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( AsyncWriteMeshSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Each file must contain the field values at the time write_mesh was called, even though the field changes afterwards
+void write_snapshots(const Uint max_in_flight)
+{
+  Component& root = Core::instance().root();
+  const std::string prefix = "async-" + to_str(max_in_flight) + "-";
+
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh_" + to_str(max_in_flight));
+  Tools::MeshGeneration::create_rectangle(*mesh, 5., 5., 20, 20);
+  Field& field = mesh->geometry_fields().create_field("solution", "u,v[vector]");
+
+  Handle<AsyncWriteMesh> writer = root.create_component<AsyncWriteMesh>("async_writer_" + to_str(max_in_flight));
+  writer->options().set("max_in_flight", max_in_flight);
+
+  const Uint nb_snapshots = 5;
+  std::vector<URI> fields(1, field.uri());
+  for(Uint iter = 0; iter != nb_snapshots; ++iter)
+  {
+    for(Uint i = 0; i != field.size(); ++i)
+      for(Uint j = 0; j != field.row_size(); ++j)
+        field[i][j] = static_cast<Real>(100*iter + i) + 0.1*static_cast<Real>(j);
+    mesh->metadata()["iter"] = iter;
+
+    writer->write_mesh(*mesh, URI(prefix + "${iter}.cf3mesh"), fields);
+    BOOST_CHECK(writer->nb_in_flight() <= max_in_flight);
+  }
+  writer->wait();
+  BOOST_CHECK_EQUAL(writer->nb_in_flight(), 0u);
+
+  boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.cf3mesh.Reader","meshreader");
+  for(Uint iter = 0; iter != nb_snapshots; ++iter)
+  {
+    Handle<Mesh> read_mesh = root.create_component<Mesh>("read_mesh");
+    reader->read_mesh_into(URI(prefix + std::string(4 - to_str(iter).size(), '0') + to_str(iter) + ".cf3mesh"), *read_mesh);
+
+    BOOST_CHECK_EQUAL(read_mesh->metadata().properties().value<Uint>("iter"), iter);
+    BOOST_CHECK(read_mesh->geometry_fields().coordinates().array() == mesh->geometry_fields().coordinates().array());
+
+    Handle<Field const> read_field(read_mesh->geometry_fields().get_child("solution"));
+    BOOST_REQUIRE(is_not_null(read_field));
+    BOOST_REQUIRE_EQUAL(read_field->size(), field.size());
+    for(Uint i = 0; i != field.size(); ++i)
+      BOOST_CHECK_EQUAL((*read_field)[i][1], static_cast<Real>(100*iter + i) + 0.1);
+
+    root.remove_component(*read_mesh);
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DoubleBuffered )
+{
+  write_snapshots(2);
+}
+
+BOOST_AUTO_TEST_CASE( SingleBuffer )
+{
+  write_snapshots(1);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Backpressure )
+{
+  Component& root = Core::instance().root();
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh_backpressure");
+  Tools::MeshGeneration::create_rectangle(*mesh, 5., 5., 2, 2);
+
+  Handle<GatedWriter> gated_writer = root.create_component<GatedWriter>("gated_writer");
+  Handle<AsyncWriteMesh> writer = root.create_component<AsyncWriteMesh>("async_writer_backpressure");
+  writer->options().set("max_in_flight", 2u);
+  writer->options().set("writer", Handle<MeshWriter>(gated_writer));
+
+  // The writer thread blocks on the first snapshot, the second one is queued
+  writer->write_mesh(*mesh, URI("gated-0.gated"), std::vector<URI>());
+  writer->write_mesh(*mesh, URI("gated-1.gated"), std::vector<URI>());
+  BOOST_CHECK_EQUAL(writer->nb_in_flight(), 2u);
+
+  // The third snapshot must wait until the writer releases one
+  boost::thread third(boost::bind(&write_mesh_in_thread, boost::ref(*writer), boost::cref(*mesh), URI("gated-2.gated")));
+  BOOST_CHECK(!third.timed_join(boost::posix_time::milliseconds(500)));
+  BOOST_CHECK_EQUAL(writer->nb_in_flight(), 2u);
+  BOOST_CHECK_EQUAL(gated_writer->nb_written(), 0u);
+
+  gated_writer->open();
+  third.join();
+  BOOST_CHECK(writer->nb_in_flight() <= 2u);
+  writer->wait();
+  BOOST_CHECK_EQUAL(writer->nb_in_flight(), 0u);
+  BOOST_CHECK_EQUAL(gated_writer->nb_written(), 3u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( UnknownExtension )
+{
+  Component& root = Core::instance().root();
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh_unknown");
+  Tools::MeshGeneration::create_rectangle(*mesh, 5., 5., 2, 2);
+
+  Handle<AsyncWriteMesh> writer = root.create_component<AsyncWriteMesh>("async_writer_unknown");
+  BOOST_CHECK_THROW(writer->write_mesh(*mesh, URI("mesh.unknown_extension"), std::vector<URI>()), FileFormatError);
+  BOOST_CHECK_EQUAL(writer->nb_in_flight(), 0u);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( CollectiveInParallel )
+{
+  Component& root = Core::instance().root();
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh_collective");
+  Tools::MeshGeneration::create_rectangle(*mesh, 5., 5., 2, 2);
+
+  Handle<CollectiveWriter> collective_writer = root.create_component<CollectiveWriter>("collective_writer");
+  Handle<AsyncWriteMesh> writer = root.create_component<AsyncWriteMesh>("async_writer_collective");
+  writer->options().set("writer", Handle<MeshWriter>(collective_writer));
+
+  // Without MPI, nothing is communicated and the writer thread may call the writer
+  writer->write_mesh(*mesh, URI("mesh.collective"), std::vector<URI>());
+  writer->wait();
+  BOOST_CHECK_EQUAL(collective_writer->m_nb_written, 1u);
+
+  // With MPI, collective calls are only allowed on the main thread
+  PE::Comm::instance().init(boost::unit_test::framework::master_test_suite().argc, boost::unit_test::framework::master_test_suite().argv);
+  BOOST_CHECK_THROW(writer->write_mesh(*mesh, URI("mesh.collective"), std::vector<URI>()), NotSupported);
+  BOOST_CHECK_EQUAL(writer->nb_in_flight(), 0u);
+  BOOST_CHECK_EQUAL(collective_writer->m_nb_written, 1u);
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,209 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::cf3mesh::MeshCache"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/BoostFilesystem.hpp"
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/Table.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/FaceCellConnectivity.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+
+#include "mesh/cf3mesh/MeshCache.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct MeshCacheFixture
+{
+  MeshCacheFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Load quadtriag.neu through a new cache component, building the faces
+  Handle<Mesh> load(const std::string& name, const bool store_cell2face)
+  {
+    Component& root = Core::instance().root();
+    Handle<cf3mesh::MeshCache> cache = root.create_component<cf3mesh::MeshCache>("cache_" + name);
+    Handle<Mesh> mesh = root.create_component<Mesh>(name);
+    cache->options().set("mesh", mesh);
+    cache->options().set("files", std::vector<URI>(1, URI("../../resources/quadtriag.neu")));
+    cache->options().set("cache_dir", URI("mesh-cache", URI::Scheme::FILE));
+    cache->add_transformer("build_faces", "cf3.mesh.actions.BuildFaces").options().set("store_cell2face", store_cell2face);
+    cache->execute();
+    m_loaded_from_cache = cache->loaded_from_cache();
+    m_key = cache->key();
+    return mesh;
+  }
+
+  int m_argc;
+  char** m_argv;
+  bool m_loaded_from_cache;
+  std::string m_key;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Component of mesh at the same path as component in source
+template<typename ComponentT>
+Handle<ComponentT const> same_component(const Mesh& mesh, const ComponentT& component, const Mesh& source)
+{
+  return Handle<ComponentT const>(mesh.access_component(component.uri().path().substr(source.uri().path().size()+1)));
+}
+
+/// Check that both face to cell connectivities refer to the same cells
+void check_same_face_cells(const Mesh& expected, const Mesh& actual)
+{
+  Uint nb_f2c = 0;
+  boost_foreach(const FaceCellConnectivity& e, find_components_recursively<FaceCellConnectivity>(expected.topology()))
+  {
+    ++nb_f2c;
+    Handle<FaceCellConnectivity const> actual_f2c = same_component(actual, e, expected);
+    BOOST_REQUIRE(is_not_null(actual_f2c));
+    const FaceCellConnectivity& a = *actual_f2c;
+    BOOST_CHECK_EQUAL(a.used().size(), e.used().size());
+    BOOST_REQUIRE_EQUAL(a.size(), e.size());
+    BOOST_REQUIRE_EQUAL(a.connectivity().row_size(), e.connectivity().row_size());
+    for(Uint f = 0; f != e.size(); ++f)
+    {
+      BOOST_CHECK_EQUAL(a.is_bdry_face()[f], e.is_bdry_face()[f]);
+      for(Uint c = 0; c != e.connectivity().row_size(); ++c)
+      {
+        BOOST_CHECK_EQUAL(a.connectivity()[f][c].comp->name(), e.connectivity()[f][c].comp->name());
+        BOOST_CHECK_EQUAL(a.connectivity()[f][c].idx, e.connectivity()[f][c].idx);
+        BOOST_CHECK_EQUAL(a.face_number()[f][c], e.face_number()[f][c]);
+        BOOST_CHECK_EQUAL(a.cell_rotation()[f][c], e.cell_rotation()[f][c]);
+        BOOST_CHECK_EQUAL(a.cell_orientation()[f][c], e.cell_orientation()[f][c]);
+      }
+    }
+
+    // The faces know their connectivity again
+    Handle<Entities const> faces(a.parent());
+    if(is_not_null(faces))
+      BOOST_CHECK(faces->connectivity_face2cell().get() == &a);
+  }
+  BOOST_CHECK(nb_f2c > 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( MeshCacheSuite, MeshCacheFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+  boost::filesystem::remove_all("mesh-cache");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( LoadTwice )
+{
+  Handle<Mesh> built = load("built", false);
+  BOOST_CHECK(!m_loaded_from_cache);
+  const std::string key = m_key;
+
+  Handle<Mesh> cached = load("cached", false);
+  BOOST_CHECK(m_loaded_from_cache);
+  BOOST_CHECK_EQUAL(m_key, key);
+
+  BOOST_CHECK(cached->geometry_fields().coordinates().array() == built->geometry_fields().coordinates().array());
+  BOOST_CHECK(cached->geometry_fields().glb_idx().array() == built->geometry_fields().glb_idx().array());
+  BOOST_REQUIRE_EQUAL(cached->elements().size(), built->elements().size());
+  boost_foreach(const Handle<Entities>& e, built->elements())
+  {
+    Handle<Entities const> a = same_component(*cached, *e, *built);
+    BOOST_REQUIRE(is_not_null(a));
+    BOOST_CHECK(a->get_tags() == e->get_tags());
+    BOOST_CHECK(a->geometry_space().connectivity().array() == e->geometry_space().connectivity().array());
+  }
+
+  // The regions built by BuildFaces come back with their tags
+  boost_foreach(const Region& region, find_components_recursively<Region>(built->topology()))
+  {
+    Handle<Region const> cached_region = same_component(*cached, region, *built);
+    BOOST_REQUIRE(is_not_null(cached_region));
+    BOOST_CHECK(cached_region->get_tags() == region.get_tags());
+  }
+
+  check_same_face_cells(*built, *cached);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( ChangedTransformer )
+{
+  // A different transformer configuration has a different key, so the mesh is built again
+  Handle<Mesh> built = load("built_cell2face", true);
+  BOOST_CHECK(!m_loaded_from_cache);
+  Handle<Mesh> cached = load("cached_cell2face", true);
+  BOOST_CHECK(m_loaded_from_cache);
+
+  check_same_face_cells(*built, *cached);
+
+  Uint nb_cell2face = 0;
+  boost_foreach(const Handle<Entities>& entities, built->elements())
+  {
+    Handle<ElementConnectivity const> e = entities->connectivity_cell2face();
+    Handle<ElementConnectivity const> a = same_component(*cached, *entities, *built)->connectivity_cell2face();
+    BOOST_REQUIRE_EQUAL(is_null(a), is_null(e));
+    if(is_null(e))
+      continue;
+    ++nb_cell2face;
+    BOOST_REQUIRE_EQUAL(a->size(), e->size());
+    BOOST_REQUIRE_EQUAL(a->row_size(), e->row_size());
+    for(Uint c = 0; c != e->size(); ++c)
+    {
+      for(Uint f = 0; f != e->row_size(); ++f)
+      {
+        BOOST_CHECK_EQUAL(is_null((*a)[c][f].comp), is_null((*e)[c][f].comp));
+        if(is_not_null((*e)[c][f].comp))
+        {
+          BOOST_CHECK_EQUAL((*a)[c][f].comp->name(), (*e)[c][f].comp->name());
+          BOOST_CHECK_EQUAL((*a)[c][f].idx, (*e)[c][f].idx);
+        }
+      }
+    }
+  }
+  BOOST_CHECK(nb_cell2face > 0);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
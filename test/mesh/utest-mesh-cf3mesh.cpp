@@ -0,0 +1,103 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the cf3mesh binary reader and writer"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/Foreach.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/PropertyList.hpp"
+#include "common/Table.hpp"
+
+#include "math/VariablesDescriptor.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshMetadata.hpp"
+#include "mesh/MeshReader.hpp"
+#include "mesh/MeshWriter.hpp"
+#include "mesh/Space.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( CF3MeshSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( WriteRead )
+{
+  Component& root = Core::instance().root();
+
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh");
+  Tools::MeshGeneration::create_rectangle(*mesh, 5., 5., 10, 10);
+
+  Field& field = mesh->geometry_fields().create_field("solution", "u,v[vector],p");
+  for(Uint i = 0; i != field.size(); ++i)
+    for(Uint j = 0; j != field.row_size(); ++j)
+      field[i][j] = static_cast<Real>(i) + 0.1*static_cast<Real>(j);
+
+  mesh->metadata()["time"] = 1.5;
+  mesh->metadata()["iter"] = 3u;
+
+  boost::shared_ptr< MeshWriter > writer = build_component_abstract_type<MeshWriter>("cf3.mesh.cf3mesh.Writer","meshwriter");
+  std::vector<URI> fields(1, field.uri());
+  writer->options().set("fields", fields);
+  writer->write_from_to(*mesh, "rectangle.cf3mesh");
+
+  boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.cf3mesh.Reader","meshreader");
+  Handle<Mesh> read_mesh = root.create_component<Mesh>("read_mesh");
+  reader->read_mesh_into("rectangle.cf3mesh", *read_mesh);
+
+  BOOST_CHECK_EQUAL(read_mesh->dimension(), mesh->dimension());
+  BOOST_CHECK_EQUAL(read_mesh->metadata().properties().value<Real>("time"), 1.5);
+  BOOST_CHECK_EQUAL(read_mesh->metadata().properties().value<Uint>("iter"), 3u);
+
+  // Geometry
+  const Field& coords = mesh->geometry_fields().coordinates();
+  const Field& read_coords = read_mesh->geometry_fields().coordinates();
+  BOOST_REQUIRE_EQUAL(read_coords.size(), coords.size());
+  BOOST_CHECK(read_coords.array() == coords.array());
+  BOOST_CHECK(read_mesh->geometry_fields().glb_idx().array() == mesh->geometry_fields().glb_idx().array());
+
+  // Elements
+  Uint nb_entities = 0;
+  boost_foreach(const Elements& elements, find_components_recursively<Elements>(*mesh))
+  {
+    Handle<Elements const> read_elements(read_mesh->access_component(elements.uri().path().substr(mesh->uri().path().size()+1)));
+    BOOST_REQUIRE(is_not_null(read_elements));
+    BOOST_CHECK_EQUAL(read_elements->element_type().derived_type_name(), elements.element_type().derived_type_name());
+    BOOST_CHECK(read_elements->geometry_space().connectivity().array() == elements.geometry_space().connectivity().array());
+    ++nb_entities;
+  }
+  BOOST_CHECK_EQUAL(find_components_recursively<Elements>(*read_mesh).size(), nb_entities);
+
+  // Field
+  Handle<Field const> read_field(read_mesh->geometry_fields().get_child("solution"));
+  BOOST_REQUIRE(is_not_null(read_field));
+  BOOST_CHECK_EQUAL(read_field->descriptor().description(), field.descriptor().description());
+  BOOST_CHECK(read_field->array() == field.array());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,281 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the parallel read of CGNS meshes"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+
+#include "common/BasicExceptions.hpp"
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/OptionList.hpp"
+#include "common/List.hpp"
+#include "common/Table.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Entities.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/MeshReader.hpp"
+
+#include "mesh/CGNS/Shared.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct CGNSParallelFixture
+{
+  CGNSParallelFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Number of cells of the grid in each direction
+const int nx = 12;
+const int ny = 7;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Write a grid of quads, a section of lines on the bottom boundary with a boco covering it,
+/// and the nodal solution u = x + 2y. If mixed is true, the quads are stored in a MIXED section.
+void write_grid(const std::string& filename, const bool mixed)
+{
+  if (PE::Comm::instance().rank() == 0)
+  {
+    const int nb_nodes = (nx+1)*(ny+1);
+    const int nb_cells = nx*ny;
+    std::vector<double> x(nb_nodes), y(nb_nodes), u(nb_nodes);
+    for (int j=0; j<=ny; ++j)
+    {
+      for (int i=0; i<=nx; ++i)
+      {
+        const int n = i + j*(nx+1);
+        x[n] = static_cast<double>(i);
+        y[n] = 0.5*static_cast<double>(j);
+        u[n] = x[n] + 2.*y[n];
+      }
+    }
+    std::vector<cgsize_t> quads;
+    for (int j=0; j<ny; ++j)
+    {
+      for (int i=0; i<nx; ++i)
+      {
+        const cgsize_t n = 1 + i + j*(nx+1);
+        if (mixed)
+          quads.push_back(CGNS_ENUMV( QUAD_4 ));
+        quads.push_back(n);
+        quads.push_back(n+1);
+        quads.push_back(n+1+nx+1);
+        quads.push_back(n+nx+1);
+      }
+    }
+    std::vector<cgsize_t> lines;
+    for (int i=0; i<nx; ++i)
+    {
+      lines.push_back(i+1);
+      lines.push_back(i+2);
+    }
+
+    int file, base, zone, coord, section, boco, sol, field;
+    cgsize_t size[3] = { nb_nodes, nb_cells, 0 };
+    cgsize_t range[2] = { nb_cells+1, nb_cells+nx };
+    BOOST_REQUIRE_EQUAL(cg_open(filename.c_str(),CG_MODE_WRITE,&file), CG_OK);
+    cg_base_write(file,"Base",2,2,&base);
+    cg_zone_write(file,base,"Zone",size,CGNS_ENUMV( Unstructured ),&zone);
+    cg_coord_write(file,base,zone,CGNS_ENUMV( RealDouble ),"CoordinateX",&x[0],&coord);
+    cg_coord_write(file,base,zone,CGNS_ENUMV( RealDouble ),"CoordinateY",&y[0],&coord);
+    if (mixed)
+    {
+#if CGNS_VERSION >= 4000
+      std::vector<cgsize_t> offsets(nb_cells+1);
+      for (int c=0; c<=nb_cells; ++c)
+        offsets[c] = 5*c;
+      BOOST_CHECK_EQUAL(cg_poly_section_write(file,base,zone,"Inner",CGNS_ENUMV( MIXED ),1,nb_cells,0,&quads[0],&offsets[0],&section), CG_OK);
+#else
+      BOOST_CHECK_EQUAL(cg_section_write(file,base,zone,"Inner",CGNS_ENUMV( MIXED ),1,nb_cells,0,&quads[0],&section), CG_OK);
+#endif
+    }
+    else
+    {
+      cg_section_write(file,base,zone,"Inner",CGNS_ENUMV( QUAD_4 ),1,nb_cells,0,&quads[0],&section);
+    }
+    cg_section_write(file,base,zone,"Bottom",CGNS_ENUMV( BAR_2 ),nb_cells+1,nb_cells+nx,0,&lines[0],&section);
+    cg_boco_write(file,base,zone,"Wall",CGNS_ENUMV( BCWall ),CGNS_ENUMV( ElementRange ),2,range,&boco);
+    cg_sol_write(file,base,zone,"Solution",CGNS_ENUMV( Vertex ),&sol);
+    cg_field_write(file,base,zone,sol,CGNS_ENUMV( RealDouble ),"u",&u[0],&field);
+    BOOST_CHECK_EQUAL(cg_close(file), CG_OK);
+  }
+  PE::Comm::instance().barrier();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Read a grid written by write_grid into a new mesh, and check the distribution over the processes
+void check_grid(const std::string& filename, const std::string& mesh_name)
+{
+  boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.CGNS.Reader","meshreader");
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>(mesh_name);
+  reader->read_mesh_into(filename,mesh);
+
+  const Uint rank = PE::Comm::instance().rank();
+  const Dictionary& nodes = mesh.geometry_fields();
+  const Table<Real>& coords = nodes.coordinates();
+
+  // Every node is owned by exactly one process
+  Uint nb_owned = 0;
+  for (Uint n=0; n<nodes.size(); ++n)
+    if (nodes.rank()[n] == rank)
+      ++nb_owned;
+  Uint total_owned;
+  PE::Comm::instance().all_reduce(PE::plus(), &nb_owned, 1, &total_owned);
+  BOOST_CHECK_EQUAL(total_owned, static_cast<Uint>((nx+1)*(ny+1)));
+
+  // Each process has part of the cells, which only refer to local nodes
+  Uint nb_cells = 0;
+  BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+  {
+    nb_cells += elements.size();
+    for (Uint e=0; e<elements.size(); ++e)
+    {
+      BOOST_CHECK_EQUAL(elements.rank()[e], rank);
+      BOOST_FOREACH(const Uint node, elements.geometry_space().connectivity()[e])
+        BOOST_CHECK(node < nodes.size());
+    }
+  }
+  if (PE::Comm::instance().size() > 1)
+    BOOST_CHECK(nb_cells < static_cast<Uint>(nx*ny));
+  Uint total_cells;
+  PE::Comm::instance().all_reduce(PE::plus(), &nb_cells, 1, &total_cells);
+  BOOST_CHECK_EQUAL(total_cells, static_cast<Uint>(nx*ny));
+
+  // The boco covering the whole section of lines takes over the section region, on all processes
+  BOOST_CHECK(is_not_null(mesh.topology().get_child("Wall")));
+  BOOST_CHECK(is_null(mesh.topology().get_child("Bottom")));
+
+  // The solution is read for the owned nodes and received for the ghost nodes
+  Handle<Field const> solution(nodes.get_child("Solution"));
+  BOOST_REQUIRE(is_not_null(solution));
+  for (Uint n=0; n<nodes.size(); ++n)
+    BOOST_CHECK_EQUAL((*solution)[n][0], coords[n][XX] + 2.*coords[n][YY]);
+
+  // Global node indices are the 0-based CGNS indices, each one owned by exactly one process
+  const Uint nb_nodes = (nx+1)*(ny+1);
+  std::vector<Uint> owned_nodes(nb_nodes, 0);
+  for (Uint n=0; n<nodes.size(); ++n)
+  {
+    const Uint gid = nodes.glb_idx()[n];
+    BOOST_REQUIRE(gid < nb_nodes);
+    BOOST_CHECK_EQUAL(gid, static_cast<Uint>(coords[n][XX] + 0.5) + static_cast<Uint>(2.*coords[n][YY] + 0.5)*(nx+1));
+    if (nodes.rank()[n] == rank)
+      ++owned_nodes[gid];
+  }
+  std::vector<Uint> total_owned_nodes(nb_nodes);
+  PE::Comm::instance().all_reduce(PE::plus(), &owned_nodes[0], nb_nodes, &total_owned_nodes[0]);
+  BOOST_CHECK_EQUAL(static_cast<Uint>(std::count(total_owned_nodes.begin(), total_owned_nodes.end(), 1u)), nb_nodes);
+
+  // Global element indices are the 0-based CGNS indices, each element being read by exactly one process
+  const Uint nb_elements = nx*ny + nx;
+  std::vector<Uint> read_elements(nb_elements, 0);
+  BOOST_FOREACH(const Elements& elements, find_components_recursively<Elements>(mesh.topology()))
+  {
+    BOOST_REQUIRE_EQUAL(elements.glb_idx().size(), elements.size());
+    for (Uint e=0; e<elements.size(); ++e)
+    {
+      const Uint gid = elements.glb_idx()[e];
+      BOOST_REQUIRE(gid < nb_elements);
+      BOOST_CHECK_EQUAL(gid < static_cast<Uint>(nx*ny), elements.element_type().dimensionality() == 2u);
+      ++read_elements[gid];
+    }
+  }
+  std::vector<Uint> total_read_elements(nb_elements);
+  PE::Comm::instance().all_reduce(PE::plus(), &read_elements[0], nb_elements, &total_read_elements[0]);
+  BOOST_CHECK_EQUAL(static_cast<Uint>(std::count(total_read_elements.begin(), total_read_elements.end(), 1u)), nb_elements);
+
+  std::vector<std::string> messages;
+  const bool sane = mesh.check_sanity(messages);
+  BOOST_FOREACH(const std::string& message, messages)
+  {
+    BOOST_TEST_MESSAGE(message);
+  }
+  BOOST_CHECK(sane);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( CGNSParallelSuite, CGNSParallelFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+  BOOST_CHECK(PE::Comm::instance().is_active());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( ReadGrid )
+{
+  write_grid("grid_parallel.cgns", false);
+  check_grid("grid_parallel.cgns", "mesh");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( ReadMixedGrid )
+{
+  write_grid("grid_parallel_mixed.cgns", true);
+  check_grid("grid_parallel_mixed.cgns", "mixed_mesh");
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( PartMismatch )
+{
+  // Ghost values are exchanged between processes, so the part must match the rank
+  if (PE::Comm::instance().size() == 1)
+    return;
+
+  boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.CGNS.Reader","meshreader");
+  reader->options().set("nb_parts", PE::Comm::instance().size()+1);
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("mismatched_mesh");
+  BOOST_CHECK_THROW(reader->read_mesh_into("grid_parallel.cgns",mesh), BadValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
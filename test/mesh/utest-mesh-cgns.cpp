@@ -5,7 +5,9 @@
 // See doc/lgpl.txt and doc/gpl.txt for the license text.
 
 
+#include <algorithm>
 #include <iostream>
+#include <map>
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for CGNS"
@@ -22,6 +24,9 @@
 #include "common/LibLoader.hpp"
 #include "common/Core.hpp"
 #include "common/Environment.hpp"
+#include "common/PropertyList.hpp"
+#include "common/BoostFilesystem.hpp"
+#include "common/FindComponents.hpp"
 
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
@@ -31,6 +36,10 @@
 #include "mesh/MeshWriter.hpp"
 #include "mesh/MeshTransformer.hpp"
 #include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/MeshMetadata.hpp"
 
 #include "mesh/CGNS/Shared.hpp"
 
@@ -796,6 +805,124 @@ BOOST_AUTO_TEST_CASE( WriteCNGS_mixed )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( WriteCGNS_time_series )
+{
+  boost::shared_ptr< MeshReader > neu_reader = build_component_abstract_type<MeshReader>("cf3.mesh.neu.Reader","meshreader");
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("quadtriag_series");
+  neu_reader->read_mesh_into("../../resources/quadtriag.neu",mesh);
+
+  // A nodal field, and a cell field with one value per element
+  const Field& coords = mesh.geometry_fields().coordinates();
+  Field& u = mesh.geometry_fields().create_field("u");
+  Field& p = mesh.create_discontinuous_space("cells_P0","cf3.mesh.LagrangeP0").create_field("p");
+
+  boost::shared_ptr< MeshWriter > meshwriter = build_component_abstract_type<MeshWriter>("cf3.mesh.CGNS.Writer","meshwriter");
+  meshwriter->options().set("time_series",true);
+  std::vector<URI> fields;
+  fields.push_back(u.uri());
+  fields.push_back(p.uri());
+  meshwriter->options().set("fields",fields);
+
+  // Each write appends a step with u = x + step*y
+  boost::filesystem::remove("quadtriag_series.cgns");
+  const Uint nb_steps = 3;
+  for (Uint step=1; step<=nb_steps; ++step)
+  {
+    for (Uint i=0; i<u.size(); ++i)
+      u[i][0] = coords[i][XX] + static_cast<Real>(step)*coords[i][YY];
+    for (Uint i=0; i<p.size(); ++i)
+      p[i][0] = static_cast<Real>(step);
+    mesh.metadata()["time"] = 0.5*static_cast<Real>(step);
+    mesh.metadata()["iter"] = 10*step;
+    meshwriter->write_from_to(mesh,"quadtriag_series.cgns");
+  }
+
+  // The file has one grid and a solution per step, referred to by the iterative data
+  int file, nb_file_steps;
+  char name[33];
+  BOOST_REQUIRE_EQUAL(cg_open("quadtriag_series.cgns",CG_MODE_READ,&file), CG_OK);
+  BOOST_CHECK_EQUAL(cg_biter_read(file,1,name,&nb_file_steps), CG_OK);
+  BOOST_CHECK_EQUAL(nb_file_steps, (int)nb_steps);
+  std::vector<double> times(nb_steps);
+  BOOST_CHECK_EQUAL(cg_goto(file,1,"BaseIterativeData_t",1,"end"), CG_OK);
+  BOOST_CHECK_EQUAL(cg_array_read_as(1,CGNS_ENUMV( RealDouble ),&times[0]), CG_OK);
+  BOOST_CHECK_EQUAL(times[nb_steps-1], 0.5*nb_steps);
+  int nb_sols;
+  BOOST_CHECK_EQUAL(cg_nsols(file,1,1,&nb_sols), CG_OK);
+  BOOST_CHECK_EQUAL(nb_sols, 2*(int)nb_steps);
+
+  // The iterative data of the zone points to the vertex and cell-centred solution of each step
+  int nb_arrays;
+  BOOST_REQUIRE_EQUAL(cg_goto(file,1,"Zone_t",1,"ZoneIterativeData_t",1,"end"), CG_OK);
+  BOOST_REQUIRE_EQUAL(cg_narrays(&nb_arrays), CG_OK);
+  BOOST_CHECK_EQUAL(nb_arrays, 2);
+  std::map<std::string, std::vector<std::string> > pointers;
+  for (int array_idx=1; array_idx<=nb_arrays; ++array_idx)
+  {
+    CGNS_ENUMT( DataType_t ) datatype;
+    int data_dim;
+    cgsize_t dims[2];
+    BOOST_REQUIRE_EQUAL(cg_array_info(array_idx,name,&datatype,&data_dim,dims), CG_OK);
+    BOOST_CHECK_EQUAL(datatype, CGNS_ENUMV( Character ));
+    BOOST_REQUIRE_EQUAL(data_dim, 2);
+    BOOST_CHECK_EQUAL(dims[0], 32);
+    BOOST_REQUIRE_EQUAL(dims[1], (cgsize_t)nb_steps);
+    std::vector<char> data(dims[0]*dims[1]);
+    BOOST_REQUIRE_EQUAL(cg_array_read(array_idx,&data[0]), CG_OK);
+    for (Uint step=0; step<nb_steps; ++step)
+    {
+      std::string pointer(&data[dims[0]*step],dims[0]);
+      pointer.erase(pointer.find_last_not_of(' ')+1);
+      pointers[name].push_back(pointer);
+    }
+  }
+  for (Uint step=1; step<=nb_steps; ++step)
+  {
+    BOOST_CHECK_EQUAL(pointers["FlowSolutionPointers"].at(step-1), "FlowSolution_000"+to_str(step));
+    BOOST_CHECK_EQUAL(pointers["FlowSolutionCellCenterPointers"].at(step-1), "FlowSolutionCellCenter_000"+to_str(step));
+  }
+
+  // p is written for the volume elements, the other cells are zero
+  Uint nb_volume_elements = 0;
+  BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(),IsElementsVolume()))
+    nb_volume_elements += elements.size();
+  cgsize_t zone_size[3];
+  BOOST_REQUIRE_EQUAL(cg_zone_read(file,1,1,name,zone_size), CG_OK);
+  Uint cell_step = 0;
+  for (int sol=1; sol<=nb_sols; ++sol)
+  {
+    CGNS_ENUMT( GridLocation_t ) location;
+    BOOST_REQUIRE_EQUAL(cg_sol_info(file,1,1,sol,name,&location), CG_OK);
+    if (location != CGNS_ENUMV( CellCenter ))
+      continue;
+    const Real step = static_cast<Real>(++cell_step);
+    BOOST_CHECK_EQUAL(std::string(name), "FlowSolutionCellCenter_000"+to_str(cell_step));
+    cgsize_t range_min = 1;
+    cgsize_t range_max = zone_size[1];
+    std::vector<double> values(zone_size[1]);
+    BOOST_REQUIRE_EQUAL(cg_field_read(file,1,1,sol,"p",CGNS_ENUMV( RealDouble ),&range_min,&range_max,&values[0]), CG_OK);
+    BOOST_CHECK_EQUAL(static_cast<Uint>(std::count(values.begin(),values.end(),step)), nb_volume_elements);
+    BOOST_CHECK_EQUAL(static_cast<Uint>(std::count(values.begin(),values.end(),0.)), static_cast<Uint>(values.size())-nb_volume_elements);
+  }
+  BOOST_CHECK_EQUAL(cell_step, nb_steps);
+  BOOST_CHECK_EQUAL(cg_close(file), CG_OK);
+
+  // Read back, the nodal solution of each step is a field
+  boost::shared_ptr< MeshReader > cgns_reader = build_component_abstract_type<MeshReader>("cf3.mesh.CGNS.Reader","meshreader");
+  Mesh& mesh2 = *Core::instance().root().create_component<Mesh>("quadtriag_series_read");
+  cgns_reader->read_mesh_into("quadtriag_series.cgns",mesh2);
+  const Field& coords2 = mesh2.geometry_fields().coordinates();
+  for (Uint step=1; step<=nb_steps; ++step)
+  {
+    Handle<Field const> solution(mesh2.geometry_fields().get_child("FlowSolution_000"+to_str(step)));
+    BOOST_REQUIRE(is_not_null(solution));
+    for (Uint i=0; i<solution->size(); ++i)
+      BOOST_CHECK_CLOSE((*solution)[i][0], coords2[i][XX] + static_cast<Real>(step)*coords2[i][YY], 1e-10);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
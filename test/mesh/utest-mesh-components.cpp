@@ -23,6 +23,7 @@
 #include "common/List.hpp"
 #include "common/Table.hpp"
 #include "common/DynTable.hpp"
+#include "common/CSRTable.hpp"
 #include "mesh/ElementType.hpp"
 #include "mesh/Dictionary.hpp"
 #include "mesh/Field.hpp"
@@ -700,6 +701,52 @@ BOOST_AUTO_TEST_CASE ( DynTable_test_hard )
 
 }
 
+BOOST_AUTO_TEST_CASE ( CSRTable_test )
+{
+  CSRTable<Uint>& table = *root.create_component< CSRTable<Uint> >("csr_table");
+  BOOST_CHECK_EQUAL(table.size(), (Uint) 0);
+
+  // first pass: row sizes, including an empty row
+  std::vector<Uint> row_sizes = list_of(3)(0)(6)(2);
+  table.set_row_sizes(row_sizes);
+
+  BOOST_CHECK_EQUAL(table.size(), (Uint) 4);
+  BOOST_CHECK_EQUAL(table.nb_values(), (Uint) 11);
+  BOOST_CHECK_EQUAL(table.offsets()[4], (Uint) 11);
+
+  // second pass: fill
+  for(Uint i=0; i<table.size(); ++i)
+    for(Uint j=0; j<table.row_size(i); ++j)
+      table[i][j] = 10*i+j;
+
+  std::vector<Uint> row = list_of(30)(31);
+  table.set_row(3, row);
+  BOOST_CHECK_THROW(table.set_row(1, row), BadValue);
+
+  const CSRTable<Uint>& const_table = table;
+  BOOST_CHECK_EQUAL(const_table[0].size(), 3);
+  BOOST_CHECK(const_table[1].empty());
+  BOOST_CHECK_EQUAL(const_table[2][5], (Uint) 25);
+  BOOST_CHECK_EQUAL(const_table.row_size(3), (Uint) 2);
+
+  Uint sum = 0;
+  boost_foreach(const Uint entry, const_table[2])
+    sum += entry;
+  BOOST_CHECK_EQUAL(sum, (Uint) 135);
+
+  // resize keeps the existing rows, adding empty ones
+  table.resize(6);
+  BOOST_CHECK_EQUAL(table.size(), (Uint) 6);
+  BOOST_CHECK_EQUAL(table.row_size(5), (Uint) 0);
+  BOOST_CHECK_EQUAL(table[3][1], (Uint) 31);
+
+  CFinfo << table << CFendl;
+
+  table.clear();
+  BOOST_CHECK_EQUAL(table.size(), (Uint) 0);
+  BOOST_CHECK_EQUAL(table.nb_values(), (Uint) 0);
+}
+
 
 BOOST_AUTO_TEST_CASE ( Mesh_test )
 {
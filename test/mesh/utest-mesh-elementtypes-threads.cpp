@@ -0,0 +1,268 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for concurrent calls to the static element type kernels"
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/mpl/bool.hpp>
+#include <boost/mpl/for_each.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/type_traits/add_pointer.hpp>
+
+#include "common/Log.hpp"
+
+#include "math/Defs.hpp"
+#include "math/MatrixTypes.hpp"
+
+#include "mesh/ElementType.hpp"
+#include "mesh/LagrangeP0/ElementTypes.hpp"
+#include "mesh/LagrangeP1/ElementTypes.hpp"
+#include "mesh/LagrangeP2/ElementTypes.hpp"
+#include "mesh/LagrangeP2B/ElementTypes.hpp"
+#include "mesh/LagrangeP3/ElementTypes.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+
+//////////////////////////////////////////////////////////////////////////////
+
+namespace helpers
+{
+
+/// Plane jacobian normals, only for the element types that implement them
+template<typename ETYPE>
+void plane_normals(const typename ETYPE::MappedCoordsT&, const typename ETYPE::NodesT&, std::vector<Real>&, boost::mpl::false_)
+{
+}
+
+template<typename ETYPE>
+void plane_normals(const typename ETYPE::MappedCoordsT& mapped_coords, const typename ETYPE::NodesT& nodes, std::vector<Real>& results, boost::mpl::true_)
+{
+  typename ETYPE::CoordsT normal;
+  for(Uint orientation = 0; orientation != ETYPE::dimensionality; ++orientation)
+  {
+    ETYPE::compute_plane_jacobian_normal(mapped_coords, nodes, static_cast<CoordRef>(orientation), normal);
+    for(Uint i = 0; i != ETYPE::dimension; ++i)
+      results.push_back(normal[i]);
+  }
+}
+
+}
+
+/// Evaluates all static kernels of an element type on a distorted element, storing every computed number in results
+template<typename ETYPE, bool HasPlaneNormals>
+struct KernelEvaluator
+{
+  typedef typename ETYPE::NodesT NodesT;
+  typedef typename ETYPE::CoordsT CoordsT;
+  typedef typename ETYPE::MappedCoordsT MappedCoordsT;
+
+  KernelEvaluator()
+  {
+    // Affine distortion of the reference element
+    const RealMatrix& local_coords = ETYPE::SF::local_coordinates();
+    for(Uint n = 0; n != ETYPE::nb_nodes; ++n)
+    {
+      for(Uint i = 0; i != ETYPE::dimension; ++i)
+      {
+        nodes(n, i) = 1. + 0.1*i;
+        for(Uint j = 0; j != ETYPE::dimensionality; ++j)
+          nodes(n, i) += (i == j ? 0.7 : 0.15) * local_coords(n, j);
+      }
+    }
+
+    // Sample points: the center of the reference element, moved a bit towards each node
+    MappedCoordsT center;
+    center.setZero();
+    for(Uint n = 0; n != ETYPE::nb_nodes; ++n)
+      center += local_coords.row(n).transpose();
+    center /= static_cast<Real>(ETYPE::nb_nodes);
+
+    for(Uint n = 0; n != ETYPE::nb_nodes; ++n)
+      sample_points.push_back(center + 0.3*(local_coords.row(n).transpose() - center));
+  }
+
+  void operator()(std::vector<Real>& results) const
+  {
+    results.clear();
+    results.push_back(ETYPE::volume(nodes));
+
+    CoordsT centroid;
+    ETYPE::compute_centroid(nodes, centroid);
+    for(Uint i = 0; i != ETYPE::dimension; ++i)
+      results.push_back(centroid[i]);
+
+    const CoordsT outside = centroid + CoordsT::Constant(10.);
+    results.push_back(ETYPE::is_coord_in_element(outside, nodes) ? 1. : 0.);
+
+    typename ETYPE::SF::ValueT sf;
+    typename ETYPE::SF::GradientT gradient;
+    typename ETYPE::JacobianT jacobian;
+    MappedCoordsT mapped_coords;
+    for(Uint p = 0; p != sample_points.size(); ++p)
+    {
+      const MappedCoordsT& point = sample_points[p];
+
+      ETYPE::SF::compute_value(point, sf);
+      for(Uint n = 0; n != ETYPE::nb_nodes; ++n)
+        results.push_back(sf[n]);
+
+      ETYPE::SF::compute_gradient(point, gradient);
+      for(Uint i = 0; i != gradient.size(); ++i)
+        results.push_back(gradient.data()[i]);
+
+      results.push_back(ETYPE::jacobian_determinant(point, nodes));
+
+      ETYPE::compute_jacobian(point, nodes, jacobian);
+      for(Uint i = 0; i != jacobian.size(); ++i)
+        results.push_back(jacobian.data()[i]);
+
+      const CoordsT coord = (sf * nodes).transpose();
+      results.push_back(ETYPE::is_coord_in_element(coord, nodes) ? 1. : 0.);
+
+      ETYPE::compute_mapped_coordinate(coord, nodes, mapped_coords);
+      for(Uint i = 0; i != ETYPE::dimensionality; ++i)
+        results.push_back(mapped_coords[i]);
+
+      helpers::plane_normals<ETYPE>(point, nodes, results, boost::mpl::bool_<HasPlaneNormals>());
+    }
+
+    results.push_back(ETYPE::faces().nodes.size());
+  }
+
+  NodesT nodes;
+  std::vector<MappedCoordsT, Eigen::aligned_allocator<MappedCoordsT> > sample_points;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/// Repeatedly evaluate the kernels, counting the number of times the result differs from the reference
+template<typename EvaluatorT>
+void evaluate_repeatedly(const EvaluatorT& evaluator, const std::vector<Real>& reference, const Uint nb_repeats, Uint& nb_mismatches)
+{
+  std::vector<Real> results;
+  for(Uint i = 0; i != nb_repeats; ++i)
+  {
+    evaluator(results);
+    if(results != reference)
+      ++nb_mismatches;
+  }
+}
+
+/// Compare the results of concurrent kernel evaluations to the serial result
+template<typename ETYPE, bool HasPlaneNormals>
+void check_threaded()
+{
+  static const Uint nb_threads = 8;
+  static const Uint nb_repeats = 2000;
+
+  const KernelEvaluator<ETYPE, HasPlaneNormals> evaluator;
+
+  std::vector<Real> reference;
+  evaluator(reference);
+  BOOST_CHECK(!reference.empty());
+
+  std::vector<Uint> nb_mismatches(nb_threads, 0);
+  boost::thread_group threads;
+  for(Uint i = 0; i != nb_threads; ++i)
+  {
+    threads.create_thread(boost::bind(&evaluate_repeatedly< KernelEvaluator<ETYPE, HasPlaneNormals> >,
+                                      boost::cref(evaluator), boost::cref(reference), nb_repeats, boost::ref(nb_mismatches[i])));
+  }
+  threads.join_all();
+
+  for(Uint i = 0; i != nb_threads; ++i)
+    BOOST_CHECK_EQUAL(nb_mismatches[i], 0u);
+}
+
+/// Copy the face table of ETYPE, after all threads reached the barrier
+template<typename ETYPE>
+void copy_faces(boost::barrier& barrier, ElementType::FaceConnectivity& result)
+{
+  barrier.wait();
+  result = ETYPE::faces();
+}
+
+/// Checks that the first calls to faces() can be made concurrently. Must run before any other use of the face tables.
+struct ConcurrentFacesChecker
+{
+  template<typename ETYPE>
+  void operator()(ETYPE*) const
+  {
+    static const Uint nb_threads = 8;
+
+    boost::barrier barrier(nb_threads);
+    std::vector<ElementType::FaceConnectivity> copies(nb_threads);
+    boost::thread_group threads;
+    for(Uint i = 0; i != nb_threads; ++i)
+      threads.create_thread(boost::bind(&copy_faces<ETYPE>, boost::ref(barrier), boost::ref(copies[i])));
+    threads.join_all();
+
+    const ElementType::FaceConnectivity& reference = ETYPE::faces();
+    for(Uint i = 0; i != nb_threads; ++i)
+    {
+      BOOST_CHECK_MESSAGE(copies[i].displs == reference.displs && copies[i].stride == reference.stride && copies[i].nodes == reference.nodes,
+                          "Face table of " << ETYPE::type_name() << " differs in thread " << i);
+    }
+  }
+};
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( ElementTypesThreadsSuite )
+
+//////////////////////////////////////////////////////////////////////////////
+
+// This must be the first test, so the face tables are built by concurrent calls
+BOOST_AUTO_TEST_CASE( ConcurrentFaces )
+{
+  boost::mpl::for_each< LagrangeP0::ElementTypes, boost::add_pointer<boost::mpl::_1> >(ConcurrentFacesChecker());
+  boost::mpl::for_each< LagrangeP1::ElementTypes, boost::add_pointer<boost::mpl::_1> >(ConcurrentFacesChecker());
+  boost::mpl::for_each< LagrangeP2::ElementTypes, boost::add_pointer<boost::mpl::_1> >(ConcurrentFacesChecker());
+  boost::mpl::for_each< LagrangeP2B::ElementTypes, boost::add_pointer<boost::mpl::_1> >(ConcurrentFacesChecker());
+  boost::mpl::for_each< LagrangeP3::ElementTypes, boost::add_pointer<boost::mpl::_1> >(ConcurrentFacesChecker());
+}
+
+BOOST_AUTO_TEST_CASE( P1Line1D )
+{
+  check_threaded<LagrangeP1::Line1D, true>();
+}
+
+BOOST_AUTO_TEST_CASE( P1Quad2D )
+{
+  check_threaded<LagrangeP1::Quad2D, true>();
+}
+
+BOOST_AUTO_TEST_CASE( P1Triag2D )
+{
+  check_threaded<LagrangeP1::Triag2D, false>();
+}
+
+BOOST_AUTO_TEST_CASE( P1Hexa3D )
+{
+  check_threaded<LagrangeP1::Hexa3D, true>();
+}
+
+BOOST_AUTO_TEST_CASE( P1Tetra3D )
+{
+  check_threaded<LagrangeP1::Tetra3D, false>();
+}
+
+BOOST_AUTO_TEST_CASE( P2Quad2D )
+{
+  check_threaded<LagrangeP2::Quad2D, true>();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+//////////////////////////////////////////////////////////////////////////////
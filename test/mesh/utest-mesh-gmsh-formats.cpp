@@ -0,0 +1,172 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the gmsh reader with the 2.2 and 4.1 ASCII and binary formats"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/FindComponents.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/Table.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshReader.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+
+#include "utest-mesh-gmsh-grid.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct GmshFormatsFixture
+{
+  GmshFormatsFixture() : nx(12), ny(7)
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Read the file and check the mesh against the grid written by gmsh_grid::write_grid
+  void check_file(const std::string& filename)
+  {
+    boost::shared_ptr< MeshReader > reader = build_component_abstract_type<MeshReader>("cf3.mesh.gmsh.Reader","meshreader");
+    Mesh& mesh = *Core::instance().root().create_component<Mesh>(filename);
+    reader->read_mesh_into(filename, mesh);
+
+    BOOST_CHECK_EQUAL(mesh.dimension(), 2u);
+
+    // Nodes: every node is owned by exactly one process and has the coordinates of its global index
+    const Field& coords = mesh.geometry_fields().coordinates();
+    const List<Uint>& glb_idx = mesh.geometry_fields().glb_idx();
+    Uint nb_owned_nodes = 0;
+    for(Uint i = 0; i != coords.size(); ++i)
+    {
+      const Uint n = glb_idx[i];
+      BOOST_CHECK_CLOSE(coords[i][XX], static_cast<Real>(n % (nx+1)) / static_cast<Real>(nx), 1e-10);
+      BOOST_CHECK_CLOSE(coords[i][YY], static_cast<Real>(n / (nx+1)) / static_cast<Real>(ny), 1e-10);
+      if(!mesh.geometry_fields().is_ghost(i))
+        ++nb_owned_nodes;
+    }
+
+    // Elements: quads in the domain region, with the connectivity given by their global index
+    Uint nb_quads = 0;
+    Uint nb_lines = 0;
+    BOOST_FOREACH(const Elements& elements, find_components_recursively<Elements>(mesh.topology()))
+    {
+      const Connectivity& connectivity = elements.geometry_space().connectivity();
+      for(Uint e = 0; e != elements.size(); ++e)
+      {
+        if(elements.is_ghost(e))
+          continue;
+        if(elements.element_type().shape() == GeoShape::QUAD)
+        {
+          BOOST_CHECK_EQUAL(elements.parent()->name(), "domain");
+          const Uint q = elements.glb_idx()[e];
+          BOOST_CHECK_EQUAL(glb_idx[connectivity[e][0]]+1, gmsh_grid::node_tag(nx, q % nx, q / nx));
+          BOOST_CHECK_EQUAL(glb_idx[connectivity[e][2]]+1, gmsh_grid::node_tag(nx, q % nx + 1, q / nx + 1));
+          ++nb_quads;
+        }
+        else
+        {
+          BOOST_CHECK_EQUAL(elements.parent()->name(), "boundary");
+          ++nb_lines;
+        }
+      }
+    }
+
+    // Nodal field
+    const Field& u = *Handle<Field const>(mesh.geometry_fields().get_child("u"));
+    BOOST_REQUIRE_EQUAL(u.size(), coords.size());
+    for(Uint i = 0; i != coords.size(); ++i)
+      BOOST_CHECK_CLOSE(u[i][0], gmsh_grid::field_value(coords[i][XX], coords[i][YY]), 1e-10);
+
+    Uint local_counts[3] = {nb_owned_nodes, nb_quads, nb_lines};
+    Uint global_counts[3] = {nb_owned_nodes, nb_quads, nb_lines};
+    if(PE::Comm::instance().is_active())
+      PE::Comm::instance().all_reduce(PE::plus(), local_counts, 3, global_counts);
+    BOOST_CHECK_EQUAL(global_counts[0], (nx+1)*(ny+1));
+    BOOST_CHECK_EQUAL(global_counts[1], nx*ny);
+    BOOST_CHECK_EQUAL(global_counts[2], 2*(nx+ny));
+  }
+
+  /// Write the grid from the first process, and read it on all of them
+  void write_and_check(const std::string& filename, const Uint version, const bool binary)
+  {
+    if(PE::Comm::instance().rank() == 0)
+      gmsh_grid::write_grid(filename, nx, ny, version, binary);
+    PE::Comm::instance().barrier();
+    check_file(filename);
+  }
+
+  const Uint nx;
+  const Uint ny;
+
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( GmshFormatsSuite, GmshFormatsFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Version2Ascii )
+{
+  write_and_check("grid-v2-ascii.msh", 2, false);
+}
+
+BOOST_AUTO_TEST_CASE( Version2Binary )
+{
+  write_and_check("grid-v2-binary.msh", 2, true);
+}
+
+BOOST_AUTO_TEST_CASE( Version4Ascii )
+{
+  write_and_check("grid-v4-ascii.msh", 4, false);
+}
+
+BOOST_AUTO_TEST_CASE( Version4Binary )
+{
+  write_and_check("grid-v4-binary.msh", 4, true);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,256 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#ifndef cf3_test_mesh_gmsh_grid_hpp
+#define cf3_test_mesh_gmsh_grid_hpp
+
+/// @file utest-mesh-gmsh-grid.hpp Writes structured grids in the gmsh formats, to test and benchmark the gmsh reader
+/// without depending on gmsh itself.
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include "common/CF.hpp"
+
+namespace gmsh_grid {
+
+/// Write value in binary format
+template<typename T>
+void write_binary(std::ostream& file, const T value)
+{
+  file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/// Tag of the node at (i,j)
+inline cf3::Uint node_tag(const cf3::Uint nx, const cf3::Uint i, const cf3::Uint j)
+{
+  return j*(nx+1) + i + 1;
+}
+
+/// Value of the nodal field "u" at the given coordinates
+inline cf3::Real field_value(const cf3::Real x, const cf3::Real y)
+{
+  return x + 2.*y;
+}
+
+/// Write a grid of nx by ny quads on the unit square, in physical group "domain", with the boundary as line elements in
+/// physical group "boundary" and the nodal field "u". Quad (i,j) has tag j*nx+i+1, the boundary lines follow the quads.
+/// @param version 2 for format 2.2, or 4 for format 4.1
+inline void write_grid(const std::string& path, const cf3::Uint nx, const cf3::Uint ny, const cf3::Uint version, const bool binary)
+{
+  using cf3::Uint;
+  using cf3::Real;
+  typedef boost::uint64_t SizeT;
+
+  std::ofstream file(path.c_str(), std::ios_base::out | std::ios_base::binary);
+  file.precision(17);
+
+  const Uint nb_nodes = (nx+1)*(ny+1);
+  const Uint nb_quads = nx*ny;
+  const Uint nb_lines = 2*(nx+ny);
+
+  // boundary lines, counterclockwise
+  std::vector<Uint> lines;
+  for(Uint i = 0; i != nx; ++i) { lines.push_back(node_tag(nx, i, 0)); lines.push_back(node_tag(nx, i+1, 0)); }
+  for(Uint j = 0; j != ny; ++j) { lines.push_back(node_tag(nx, nx, j)); lines.push_back(node_tag(nx, nx, j+1)); }
+  for(Uint i = nx; i != 0; --i) { lines.push_back(node_tag(nx, i, ny)); lines.push_back(node_tag(nx, i-1, ny)); }
+  for(Uint j = ny; j != 0; --j) { lines.push_back(node_tag(nx, 0, j)); lines.push_back(node_tag(nx, 0, j-1)); }
+
+  file << "$MeshFormat\n" << (version == 2 ? "2.2" : "4.1") << " " << (binary ? 1 : 0) << " 8\n";
+  if(binary)
+  {
+    write_binary<int>(file, 1);
+    file << "\n";
+  }
+  file << "$EndMeshFormat\n";
+
+  file << "$PhysicalNames\n2\n1 1 \"boundary\"\n2 2 \"domain\"\n$EndPhysicalNames\n";
+
+  if(version == 4)
+  {
+    // one curve for the boundary and one surface for the domain
+    file << "$Entities\n";
+    if(binary)
+    {
+      write_binary<SizeT>(file, 0); write_binary<SizeT>(file, 1); write_binary<SizeT>(file, 1); write_binary<SizeT>(file, 0);
+      for(int dim = 1; dim != 3; ++dim)
+      {
+        write_binary<int>(file, 1);
+        for(Uint c = 0; c != 6; ++c)
+          write_binary<Real>(file, c == 3 || c == 4 ? 1. : 0.);
+        write_binary<SizeT>(file, 1);
+        write_binary<int>(file, dim);
+        write_binary<SizeT>(file, 0);
+      }
+      file << "\n";
+    }
+    else
+    {
+      file << "0 1 1 0\n";
+      file << "1 0 0 0 1 1 0 1 1 0\n";
+      file << "1 0 0 0 1 1 0 1 2 0\n";
+    }
+    file << "$EndEntities\n";
+  }
+
+  // Nodes, in 2 blocks for version 4
+  file << "$Nodes\n";
+  const Uint split = nb_nodes / 2;
+  if(version == 2)
+  {
+    file << nb_nodes << "\n";
+  }
+  else if(binary)
+  {
+    write_binary<SizeT>(file, 2); write_binary<SizeT>(file, nb_nodes); write_binary<SizeT>(file, 1); write_binary<SizeT>(file, nb_nodes);
+  }
+  else
+  {
+    file << 2 << " " << nb_nodes << " " << 1 << " " << nb_nodes << "\n";
+  }
+  for(Uint block = 0; block != (version == 2 ? 1 : 2); ++block)
+  {
+    const Uint begin = version == 2 ? 0 : (block == 0 ? 0 : split);
+    const Uint end = version == 2 ? nb_nodes : (block == 0 ? split : nb_nodes);
+    if(version == 4)
+    {
+      if(binary)
+      {
+        write_binary<int>(file, 2); write_binary<int>(file, 1); write_binary<int>(file, 0); write_binary<SizeT>(file, end-begin);
+        for(Uint n = begin; n != end; ++n)
+          write_binary<SizeT>(file, n+1);
+      }
+      else
+      {
+        file << "2 1 0 " << end-begin << "\n";
+        for(Uint n = begin; n != end; ++n)
+          file << n+1 << "\n";
+      }
+    }
+    for(Uint n = begin; n != end; ++n)
+    {
+      const Real x = static_cast<Real>(n % (nx+1)) / static_cast<Real>(nx);
+      const Real y = static_cast<Real>(n / (nx+1)) / static_cast<Real>(ny);
+      if(binary)
+      {
+        if(version == 2)
+          write_binary<int>(file, n+1);
+        write_binary<Real>(file, x); write_binary<Real>(file, y); write_binary<Real>(file, 0.);
+      }
+      else
+      {
+        if(version == 2)
+          file << n+1 << " ";
+        file << x << " " << y << " 0\n";
+      }
+    }
+  }
+  if(binary)
+    file << "\n";
+  file << "$EndNodes\n";
+
+  // Elements: quads in physical group 2, then lines in physical group 1
+  file << "$Elements\n";
+  if(version == 2)
+    file << nb_quads + nb_lines << "\n";
+  else if(binary)
+  {
+    write_binary<SizeT>(file, 2); write_binary<SizeT>(file, nb_quads + nb_lines); write_binary<SizeT>(file, 1); write_binary<SizeT>(file, nb_quads + nb_lines);
+  }
+  else
+    file << 2 << " " << nb_quads + nb_lines << " " << 1 << " " << nb_quads + nb_lines << "\n";
+
+  for(Uint block = 0; block != 2; ++block)
+  {
+    const Uint type = block == 0 ? 3 : 1;
+    const Uint physical = block == 0 ? 2 : 1;
+    const Uint nb_elems = block == 0 ? nb_quads : nb_lines;
+    const Uint first_tag = block == 0 ? 1 : nb_quads+1;
+    if(binary && version == 2)
+    {
+      write_binary<int>(file, type); write_binary<int>(file, nb_elems); write_binary<int>(file, 2);
+    }
+    else if(binary)
+    {
+      write_binary<int>(file, physical); write_binary<int>(file, 1); write_binary<int>(file, type); write_binary<SizeT>(file, nb_elems);
+    }
+    else if(version == 4)
+    {
+      file << physical << " 1 " << type << " " << nb_elems << "\n";
+    }
+
+    for(Uint e = 0; e != nb_elems; ++e)
+    {
+      std::vector<Uint> nodes;
+      if(block == 0)
+      {
+        const Uint i = e % nx;
+        const Uint j = e / nx;
+        nodes.push_back(node_tag(nx, i, j));
+        nodes.push_back(node_tag(nx, i+1, j));
+        nodes.push_back(node_tag(nx, i+1, j+1));
+        nodes.push_back(node_tag(nx, i, j+1));
+      }
+      else
+      {
+        nodes.push_back(lines[2*e]);
+        nodes.push_back(lines[2*e+1]);
+      }
+
+      const Uint tag = first_tag + e;
+      if(binary && version == 2)
+      {
+        write_binary<int>(file, tag); write_binary<int>(file, physical); write_binary<int>(file, physical);
+        for(Uint n = 0; n != nodes.size(); ++n)
+          write_binary<int>(file, nodes[n]);
+      }
+      else if(binary)
+      {
+        write_binary<SizeT>(file, tag);
+        for(Uint n = 0; n != nodes.size(); ++n)
+          write_binary<SizeT>(file, nodes[n]);
+      }
+      else
+      {
+        file << tag;
+        if(version == 2)
+          file << " " << type << " 2 " << physical << " " << physical;
+        for(Uint n = 0; n != nodes.size(); ++n)
+          file << " " << nodes[n];
+        file << "\n";
+      }
+    }
+  }
+  if(binary)
+    file << "\n";
+  file << "$EndElements\n";
+
+  // Nodal field
+  file << "$NodeData\n1\n\"u\"\n1\n0\n3\n0\n1\n" << nb_nodes << "\n";
+  for(Uint n = 0; n != nb_nodes; ++n)
+  {
+    const Real value = field_value(static_cast<Real>(n % (nx+1)) / static_cast<Real>(nx), static_cast<Real>(n / (nx+1)) / static_cast<Real>(ny));
+    if(binary)
+    {
+      write_binary<int>(file, n+1);
+      write_binary<Real>(file, value);
+    }
+    else
+    {
+      file << n+1 << " " << value << "\n";
+    }
+  }
+  if(binary)
+    file << "\n";
+  file << "$EndNodeData\n";
+}
+
+} // namespace gmsh_grid
+
+#endif // cf3_test_mesh_gmsh_grid_hpp
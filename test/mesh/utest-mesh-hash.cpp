@@ -83,6 +83,11 @@ BOOST_AUTO_TEST_CASE( SingleHash )
   BOOST_CHECK_EQUAL(hash->nb_objects_in_part(0), (Uint) 3);
   BOOST_CHECK_EQUAL(hash->nb_objects_in_part(1), (Uint) 3);
   BOOST_CHECK_EQUAL(hash->nb_objects_in_part(2), (Uint) 5);
+
+  // Serially, the only process holds all parts
+  BOOST_CHECK_EQUAL(hash->start_idx_in_proc(0), (Uint) 0);
+  BOOST_CHECK_EQUAL(hash->end_idx_in_proc(0), (Uint) 11);
+  BOOST_CHECK_EQUAL(hash->nb_objects_in_proc(0), (Uint) 11);
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -11,7 +11,9 @@
 #include <boost/assign/list_of.hpp>
 #include <boost/assign/std/vector.hpp>
 
+#include "common/BasicExceptions.hpp"
 #include "common/Core.hpp"
+#include "common/Environment.hpp"
 #include "common/Foreach.hpp"
 #include "common/Log.hpp"
 #include "common/OptionList.hpp"
@@ -24,6 +26,7 @@
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
 #include "mesh/Elements.hpp"
+#include "mesh/Connectivity.hpp"
 #include "mesh/Space.hpp"
 #include "common/Table.hpp"
 #include "mesh/Dictionary.hpp"
@@ -147,6 +150,132 @@ BOOST_AUTO_TEST_CASE( Octtree_creation )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+BOOST_AUTO_TEST_CASE( Octtree_find_elements )
+{
+  Octtree& octtree = *Core::instance().root().get_child("mesh")->get_child("octtree")->handle<Octtree>();
+
+  // points on a regular grid that overshoots the 10x10 mesh, with enough points to use several threads
+  const Uint n = 101;
+  RealMatrix coordinates(n*n,2);
+  for (Uint j=0; j<n; ++j)
+  {
+    for (Uint i=0; i<n; ++i)
+    {
+      coordinates(j*n+i,XX) = -0.5 + 11.*i/(n-1.);
+      coordinates(j*n+i,YY) = -0.5 + 11.*j/(n-1.);
+    }
+  }
+
+  Core::instance().environment().options().set("nb_threads",4u);
+  std::vector<Entity> elements;
+  const Uint nb_found = octtree.find_elements(coordinates,elements);
+  Core::instance().environment().options().set("nb_threads",1u);
+
+  BOOST_CHECK_EQUAL(elements.size(), n*n);
+  Uint nb_inside = 0;
+  RealVector2 coord;
+  for (Uint p=0; p<n*n; ++p)
+  {
+    coord = coordinates.row(p);
+    const bool inside = coord[XX] >= 0. && coord[XX] <= 10. && coord[YY] >= 0. && coord[YY] <= 10.;
+    if (inside)
+      ++nb_inside;
+    const Entity element = octtree.find_element(coord);
+    BOOST_CHECK_EQUAL(is_not_null(elements[p].comp), inside);
+    BOOST_CHECK(elements[p].comp == element.comp);
+    BOOST_CHECK_EQUAL(elements[p].idx, element.idx);
+  }
+  BOOST_CHECK_EQUAL(nb_found, nb_inside);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Octtree_threaded_creation )
+{
+  // enough elements for the build to use several threads
+  Handle< MeshGenerator > mesh_generator(Core::instance().root().get_child("mesh_generator"));
+  mesh_generator->options().set("mesh",Core::instance().root().uri()/"large_mesh");
+  mesh_generator->options().set("lengths",std::vector<Real>(2,10.));
+  mesh_generator->options().set("nb_cells",std::vector<Uint>(2,80));
+  mesh_generator->options().set("part",0u);
+  mesh_generator->options().set("nb_parts",1u);
+  Mesh& mesh = mesh_generator->generate();
+  BOOST_REQUIRE_EQUAL(mesh.elements()[0]->size(), 6400u);
+
+  Octtree& serial_octtree = *mesh.create_component<Octtree>("serial_octtree");
+  serial_octtree.options().set("mesh", mesh.handle<Mesh>());
+  serial_octtree.create_octtree();
+
+  Octtree& threaded_octtree = *mesh.create_component<Octtree>("threaded_octtree");
+  Core::instance().environment().options().set("nb_threads",4u);
+  threaded_octtree.options().set("mesh", mesh.handle<Mesh>());
+  threaded_octtree.create_octtree();
+  Core::instance().environment().options().set("nb_threads",1u);
+
+  // points on the element edges and inside the elements, so a different ordering of the candidates in a cell would show
+  const Uint n = 161;
+  RealVector2 coord;
+  std::vector<Uint> serial_idx(3,0), threaded_idx(3,0);
+  std::vector<Entity> serial_elements, threaded_elements;
+  for (Uint j=0; j<n; ++j)
+  {
+    for (Uint i=0; i<n; ++i)
+    {
+      coord << 10.*i/(n-1.), 10.*j/(n-1.);
+
+      const Entity serial_element = serial_octtree.find_element(coord);
+      const Entity threaded_element = threaded_octtree.find_element(coord);
+      BOOST_CHECK(is_not_null(threaded_element.comp));
+      BOOST_CHECK(threaded_element.comp == serial_element.comp);
+      BOOST_CHECK_EQUAL(threaded_element.idx, serial_element.idx);
+
+      // the elements with their centroid in the cell, used by the stencil computer
+      BOOST_CHECK_EQUAL(threaded_octtree.find_octtree_cell(coord, threaded_idx), serial_octtree.find_octtree_cell(coord, serial_idx));
+      BOOST_CHECK(threaded_idx == serial_idx);
+      serial_elements.clear();
+      threaded_elements.clear();
+      serial_octtree.gather_elements_around_idx(serial_idx, 0, serial_elements);
+      threaded_octtree.gather_elements_around_idx(threaded_idx, 0, threaded_elements);
+      BOOST_REQUIRE_EQUAL(threaded_elements.size(), serial_elements.size());
+      for (Uint e=0; e<serial_elements.size(); ++e)
+        BOOST_CHECK_EQUAL(threaded_elements[e].idx, serial_elements[e].idx);
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Octtree_threaded_error )
+{
+  // P2 triangles can't compute their centroid, so the octtree creation fails in every thread
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("p2_mesh");
+  mesh.initialize_nodes(6, 2);
+  Table<Real>& coords = mesh.geometry_fields().coordinates();
+  coords[0][XX] = 0.;  coords[0][YY] = 0.;
+  coords[1][XX] = 1.;  coords[1][YY] = 0.;
+  coords[2][XX] = 0.;  coords[2][YY] = 1.;
+  coords[3][XX] = 0.5; coords[3][YY] = 0.;
+  coords[4][XX] = 0.5; coords[4][YY] = 0.5;
+  coords[5][XX] = 0.;  coords[5][YY] = 0.5;
+  Elements& triags = mesh.topology().create_elements("cf3.mesh.LagrangeP2.Triag2D", mesh.geometry_fields());
+  triags.resize(8192);
+  for (Uint e=0; e<triags.size(); ++e)
+    for (Uint n=0; n<6; ++n)
+      triags.geometry_space().connectivity()[e][n] = n;
+  mesh.update_structures();
+  mesh.update_statistics();
+
+  // the errors of the threads are rethrown by the calling thread, instead of terminating the process
+  Octtree& octtree = *mesh.create_component<Octtree>("octtree");
+  octtree.options().set("mesh", mesh.handle<Mesh>());
+  Core::instance().environment().options().set("nb_threads",4u);
+  BOOST_CHECK_THROW(octtree.create_octtree(), ParallelError);
+  Core::instance().environment().options().set("nb_threads",1u);
+  BOOST_CHECK_THROW(octtree.create_octtree(), NotImplemented);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_CASE( Octtree_parallel )
 {
   Handle< MeshGenerator > mesh_generator(Core::instance().root().get_child("mesh_generator"));
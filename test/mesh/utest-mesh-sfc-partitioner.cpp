@@ -0,0 +1,182 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::SFCPartitioner"
+
+#include <algorithm>
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "math/Hilbert.hpp"
+
+#include "mesh/BoundingBox.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/MeshTransformer.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Space.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct SFCPartitionerFixture
+{
+  SFCPartitionerFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( SFCPartitionerSuite, SFCPartitionerFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( LoadBalanceRectangle )
+{
+  PE::Comm& comm = PE::Comm::instance();
+  const Uint nx = 24;
+  const Uint ny = 17;
+
+  boost::shared_ptr< MeshGenerator > generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","generator");
+  generator->options().set("mesh",URI("//rectangle"));
+  std::vector<Uint> nb_cells(2, nx); nb_cells[1] = ny;
+  generator->options().set("nb_cells",nb_cells);
+  generator->options().set("lengths",std::vector<Real>(2,1.));
+  Mesh& mesh = generator->generate();
+
+  boost::shared_ptr< MeshTransformer > load_balance = build_component_abstract_type<MeshTransformer>("cf3.mesh.actions.LoadBalance","load_balance");
+  load_balance->options().set("partitioner", std::string("cf3.mesh.SFCPartitioner"));
+  load_balance->transform(mesh);
+
+  // Hilbert index of the owned cells
+  boost::shared_ptr<BoundingBox> bounding_box = allocate_component<BoundingBox>("bounding_box");
+  bounding_box->build(mesh);
+  bounding_box->make_global();
+  math::Hilbert compute_hilbert_idx(*bounding_box, 20);
+  std::vector<boost::uint64_t> hilbert_idx;
+  boost_foreach(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+  {
+    const Space& space = elements.geometry_space();
+    RealMatrix coordinates;
+    space.allocate_coordinates(coordinates);
+    RealVector centroid(elements.element_type().dimension());
+    for (Uint e=0; e<elements.size(); ++e)
+    {
+      if (elements.rank()[e] != comm.rank())
+        continue;
+      space.put_coordinates(coordinates,e);
+      elements.element_type().compute_centroid(coordinates,centroid);
+      hilbert_idx.push_back(compute_hilbert_idx(centroid));
+    }
+  }
+
+  // All cells are kept, and every process has its share
+  const Uint nb_owned = hilbert_idx.size();
+  std::vector<Uint> nb_owned_per_proc;
+  comm.all_gather(nb_owned, nb_owned_per_proc);
+  Uint total = 0;
+  boost_foreach(const Uint n, nb_owned_per_proc)
+    total += n;
+  BOOST_CHECK_EQUAL(total, nx*ny);
+  BOOST_CHECK(nb_owned + 1 >= total / comm.size());
+  BOOST_CHECK(nb_owned <= total / comm.size() + 1);
+
+  // The parts are consecutive pieces of the curve
+  BOOST_REQUIRE(!hilbert_idx.empty());
+  std::vector<boost::uint64_t> range(2);
+  range[0] = *std::min_element(hilbert_idx.begin(), hilbert_idx.end());
+  range[1] = *std::max_element(hilbert_idx.begin(), hilbert_idx.end());
+  std::vector<boost::uint64_t> ranges;
+  comm.all_gather(range, ranges);
+  for (Uint p=1; p<comm.size(); ++p)
+    BOOST_CHECK(ranges[2*p-1] < ranges[2*p]);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( BoundaryFollowsCells )
+{
+  PE::Comm& comm = PE::Comm::instance();
+  const Mesh& mesh = *Handle<Mesh>(Core::instance().root().get_child("rectangle"));
+
+  // Every owned boundary element is owned by the same process as the cell next to it
+  Uint nb_owned_faces = 0;
+  boost_foreach(const Elements& faces, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsSurface()))
+  {
+    const Connectivity& face_nodes = faces.geometry_space().connectivity();
+    for (Uint f=0; f<faces.size(); ++f)
+    {
+      if (faces.rank()[f] != comm.rank())
+        continue;
+      ++nb_owned_faces;
+
+      bool found_cell = false;
+      boost_foreach(const Elements& cells, find_components_recursively_with_filter<Elements>(mesh.topology(), IsElementsVolume()))
+      {
+        const Connectivity& cell_nodes = cells.geometry_space().connectivity();
+        for (Uint c=0; c<cells.size() && !found_cell; ++c)
+        {
+          bool adjacent = true;
+          boost_foreach(const Uint node, face_nodes[f])
+            adjacent = adjacent && std::find(cell_nodes[c].begin(), cell_nodes[c].end(), node) != cell_nodes[c].end();
+          if (adjacent)
+          {
+            found_cell = true;
+            BOOST_CHECK_EQUAL(cells.rank()[c], comm.rank());
+          }
+        }
+      }
+      BOOST_CHECK(found_cell);
+    }
+  }
+
+  // All boundary elements are kept
+  Uint nb_faces = 0;
+  comm.all_reduce(PE::plus(), &nb_owned_faces, 1, &nb_faces);
+  BOOST_CHECK_EQUAL(nb_faces, 2u*(24u+17u));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,83 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::StreamingMeshReader"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/FindComponents.hpp"
+#include "common/Foreach.hpp"
+#include "common/OptionList.hpp"
+#include "common/Table.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshReader.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/StreamingMeshReader.hpp"
+#include "mesh/StreamingMeshWriter.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE( StreamingConversionSuite )
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Converting in chunks must give the same mesh as reading the original file
+void check_conversion(const std::string& file, const Uint chunk_size)
+{
+  Component& root = Core::instance().root();
+  const std::string name = file + "-" + to_str(chunk_size);
+
+  boost::shared_ptr< StreamingMeshReader > converter = build_component_abstract_type<StreamingMeshReader>("cf3.mesh.neu.StreamingReader","converter");
+  boost::shared_ptr< StreamingMeshWriter > streaming_writer = build_component_abstract_type<StreamingMeshWriter>("cf3.mesh.gmsh.StreamingWriter","streaming_writer");
+  converter->options().set("chunk_size", chunk_size);
+  converter->convert(URI("../../resources/" + file + ".neu"), URI(name + ".msh"), *streaming_writer);
+
+  Handle<Mesh> original = root.create_component<Mesh>("original");
+  build_component_abstract_type<MeshReader>("cf3.mesh.neu.Reader","neu_reader")->read_mesh_into(URI("../../resources/" + file + ".neu"), *original);
+
+  Handle<Mesh> converted = root.create_component<Mesh>("converted");
+  build_component_abstract_type<MeshReader>("cf3.mesh.gmsh.Reader","gmsh_reader")->read_mesh_into(URI(name + ".msh"), *converted);
+
+  BOOST_CHECK_EQUAL(converted->dimension(), original->dimension());
+  BOOST_CHECK(converted->geometry_fields().coordinates().array() == original->geometry_fields().coordinates().array());
+
+  boost_foreach(const Region& region, find_components<Region>(original->topology()))
+  {
+    Handle<Region const> converted_region(converted->topology().get_child(region.name()));
+    BOOST_REQUIRE_MESSAGE(is_not_null(converted_region), "region " + region.name() + " is missing");
+    BOOST_CHECK_EQUAL(converted_region->recursive_elements_count(true), region.recursive_elements_count(true));
+  }
+
+  root.remove_component(*original);
+  root.remove_component(*converted);
+}
+
+BOOST_AUTO_TEST_CASE( Convert2D )
+{
+  check_conversion("quadtriag", 1000000);
+  check_conversion("quadtriag", 5);
+}
+
+BOOST_AUTO_TEST_CASE( Convert3D )
+{
+  check_conversion("hextet", 3);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -7,6 +7,13 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for cf3::mesh::tecplot::Writer"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/cstdint.hpp>
 #include <boost/test/unit_test.hpp>
 
 #include "common/Log.hpp"
@@ -17,6 +24,10 @@
 
 #include "mesh/Mesh.hpp"
 #include "mesh/Region.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/ElementType.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Space.hpp"
 #include "mesh/MeshReader.hpp"
 #include "mesh/MeshWriter.hpp"
 #include "mesh/MeshTransformer.hpp"
@@ -25,6 +36,7 @@
 #include "common/List.hpp"
 #include "common/Table.hpp"
 #include "mesh/Dictionary.hpp"
+#include "common/FindComponents.hpp"
 
 using namespace std;
 using namespace boost;
@@ -56,6 +68,166 @@ struct TecWriterTests_Fixture
 
 };
 
+/// Zone data as read back from a tecplot file
+struct TecplotZone
+{
+  std::string title;
+  Uint zone_type;
+  Uint nb_nodes;
+  Uint nb_elems;
+  /// values of each variable, in the order of the variables
+  std::vector< std::vector<Real> > values;
+  /// zero-based node indices in the zone
+  std::vector<Uint> connectivity;
+};
+
+template <typename T>
+T read_binary(std::istream& file)
+{
+  T value;
+  file.read(reinterpret_cast<char*>(&value), sizeof(T));
+  return value;
+}
+
+std::string read_binary_string(std::istream& file)
+{
+  std::string str;
+  for (boost::int32_t c = read_binary<boost::int32_t>(file); c != 0; c = read_binary<boost::int32_t>(file))
+    str.push_back(static_cast<char>(c));
+  return str;
+}
+
+/// Number of nodes per element for the finite element zone types of the binary format
+Uint nodes_per_element(const Uint zone_type)
+{
+  const Uint nb_nodes[] = { 1, 2, 3, 4, 4, 8 };
+  return nb_nodes[zone_type];
+}
+
+/// Read the header and zone data of a binary .plt file (version 112) as written by the tecplot writer
+void read_binary_plt(const std::string& path, std::vector<std::string>& var_names, std::vector<TecplotZone>& zones)
+{
+  std::ifstream file(path.c_str(), std::ios_base::in | std::ios_base::binary);
+  BOOST_REQUIRE(file);
+  char magic[8];
+  file.read(magic, 8);
+  BOOST_REQUIRE_EQUAL(std::string(magic, 8), "#!TDV112");
+  BOOST_REQUIRE_EQUAL(read_binary<boost::int32_t>(file), 1);   // byte order
+  BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), 0);     // full file type
+  BOOST_CHECK_EQUAL(read_binary_string(file), "COOLFluiD Mesh Data");
+
+  var_names.resize(read_binary<boost::int32_t>(file));
+  for (Uint var=0; var<var_names.size(); ++var)
+    var_names[var] = read_binary_string(file);
+
+  std::vector< std::vector<boost::int32_t> > var_locations;
+  zones.clear();
+  for (float marker = read_binary<float>(file); marker != 357.f; marker = read_binary<float>(file))
+  {
+    BOOST_REQUIRE_EQUAL(marker, 299.f);
+    TecplotZone zone;
+    zone.title = read_binary_string(file);
+    BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), -1);  // parent zone
+    read_binary<boost::int32_t>(file);                          // strand id
+    read_binary<double>(file);                                  // solution time
+    BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), -1);
+    zone.zone_type = read_binary<boost::int32_t>(file);
+    var_locations.push_back(std::vector<boost::int32_t>(var_names.size(), 0));
+    if (read_binary<boost::int32_t>(file))
+      file.read(reinterpret_cast<char*>(&var_locations.back()[0]), var_names.size()*sizeof(boost::int32_t));
+    BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), 0);   // face neighbors
+    BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), 0);   // user-defined face neighbor connections
+    zone.nb_nodes = read_binary<boost::int32_t>(file);
+    zone.nb_elems = read_binary<boost::int32_t>(file);
+    for (Uint i=0; i<3; ++i)
+      BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), 0);
+    BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), 0);   // auxiliary data
+    zones.push_back(zone);
+  }
+
+  for (Uint z=0; z<zones.size(); ++z)
+  {
+    TecplotZone& zone = zones[z];
+    BOOST_REQUIRE_EQUAL(read_binary<float>(file), 299.f);
+    for (Uint var=0; var<var_names.size(); ++var)
+      BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), 2); // double precision
+    BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), 0);   // passive variables
+    BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), 0);   // variable sharing
+    BOOST_CHECK_EQUAL(read_binary<boost::int32_t>(file), -1);  // connectivity sharing
+    std::vector<Real> min(var_names.size()), max(var_names.size());
+    for (Uint var=0; var<var_names.size(); ++var)
+    {
+      min[var] = read_binary<double>(file);
+      max[var] = read_binary<double>(file);
+    }
+    zone.values.resize(var_names.size());
+    for (Uint var=0; var<var_names.size(); ++var)
+    {
+      std::vector<Real>& column = zone.values[var];
+      column.resize(var_locations[z][var] ? zone.nb_elems : zone.nb_nodes);
+      for (Uint i=0; i<column.size(); ++i)
+        column[i] = read_binary<double>(file);
+      BOOST_CHECK_EQUAL(min[var], *std::min_element(column.begin(), column.end()));
+      BOOST_CHECK_EQUAL(max[var], *std::max_element(column.begin(), column.end()));
+    }
+    zone.connectivity.resize(zone.nb_elems*nodes_per_element(zone.zone_type));
+    for (Uint i=0; i<zone.connectivity.size(); ++i)
+      zone.connectivity[i] = read_binary<boost::int32_t>(file);
+  }
+  BOOST_REQUIRE(file);
+  file.peek();
+  BOOST_CHECK(file.eof());
+}
+
+/// Read the zone data of an ASCII .plt file as written by the tecplot writer
+void read_ascii_plt(const std::string& path, std::vector<TecplotZone>& zones)
+{
+  std::ifstream file(path.c_str());
+  BOOST_REQUIRE(file);
+  zones.clear();
+  bool in_connectivity = false;
+  std::string line;
+  while (std::getline(file, line))
+  {
+    if (line.empty() || boost::starts_with(line, "TITLE") || boost::starts_with(line, "VARIABLES"))
+      continue;
+    if (boost::starts_with(line, "ZONE"))
+    {
+      zones.push_back(TecplotZone());
+      const std::size_t title_begin = line.find("T=\"")+3;
+      zones.back().title = line.substr(title_begin, line.find('"', title_begin)-title_begin);
+      zones.back().nb_nodes = from_str<Uint>(line.substr(line.find(", N=")+4, line.find(", E=")-line.find(", N=")-4));
+      zones.back().nb_elems = from_str<Uint>(line.substr(line.find(", E=")+4, line.find(", DATAPACKING")-line.find(", E=")-4));
+      in_connectivity = false;
+    }
+    else if (boost::starts_with(line, "### variable"))
+    {
+      zones.back().values.push_back(std::vector<Real>());
+    }
+    else if (boost::starts_with(line, "### connectivity"))
+    {
+      in_connectivity = true;
+    }
+    else
+    {
+      std::istringstream numbers(line);
+      if (in_connectivity)
+      {
+        for (Uint node; numbers >> node; )
+          zones.back().connectivity.push_back(node-1);
+      }
+      else
+      {
+        Real value;
+        numbers >> value;
+        zones.back().values.back().push_back(value);
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 ////////////////////////////////////////////////////////////////////////////////
 
 BOOST_FIXTURE_TEST_SUITE( TecWriterTests_TestSuite, TecWriterTests_Fixture )
@@ -128,7 +300,88 @@ BOOST_AUTO_TEST_CASE( read_2d_mesh )
   tec_writer->options().set("file",URI("quadtriag_filtered.plt"));
   tec_writer->execute();
 
-  BOOST_CHECK(true);
+  tec_writer->options().set("binary",false);
+  tec_writer->options().set("file",URI("quadtriag_filtered_ascii.plt"));
+  tec_writer->execute();
+
+  std::ifstream ascii_file("quadtriag_filtered_ascii.plt");
+  std::string title;
+  std::getline(ascii_file, title);
+  BOOST_CHECK_EQUAL(title, "TITLE      = COOLFluiD Mesh Data");
+
+  // the binary format is the default, read it back
+  std::vector<std::string> var_names;
+  std::vector<TecplotZone> zones;
+  read_binary_plt("quadtriag_filtered.plt", var_names, zones);
+  BOOST_REQUIRE_EQUAL(var_names.size(), 8u);
+  BOOST_CHECK_EQUAL(var_names[0], "x0");
+  BOOST_CHECK_EQUAL(var_names[2], "nodal[0]");
+  BOOST_CHECK_EQUAL(var_names[5], "cell_centred[1]");
+  BOOST_CHECK_EQUAL(var_names[7], "nodesP2[1]");
+  BOOST_REQUIRE(!zones.empty());
+
+  // the same zone data as the ASCII file
+  std::vector<TecplotZone> ascii_zones;
+  read_ascii_plt("quadtriag_filtered_ascii.plt", ascii_zones);
+  BOOST_REQUIRE_EQUAL(ascii_zones.size(), zones.size());
+  for (Uint z=0; z<zones.size(); ++z)
+  {
+    BOOST_CHECK_EQUAL(ascii_zones[z].title, zones[z].title);
+    BOOST_CHECK_EQUAL(ascii_zones[z].nb_nodes, zones[z].nb_nodes);
+    BOOST_CHECK_EQUAL(ascii_zones[z].nb_elems, zones[z].nb_elems);
+    BOOST_REQUIRE_EQUAL(ascii_zones[z].values.size(), zones[z].values.size());
+    for (Uint var=0; var<zones[z].values.size(); ++var)
+    {
+      BOOST_REQUIRE_EQUAL(ascii_zones[z].values[var].size(), zones[z].values[var].size());
+      for (Uint i=0; i<zones[z].values[var].size(); ++i)
+        BOOST_CHECK_SMALL(ascii_zones[z].values[var][i] - zones[z].values[var][i], 1e-10*std::max(1., std::abs(zones[z].values[var][i])));
+    }
+    BOOST_CHECK(ascii_zones[z].connectivity == zones[z].connectivity);
+  }
+
+  // and the same data as the mesh: the nodal field holds the mesh node index, the cell centred field the element index
+  const common::Table<Real>& coordinates = mesh.geometry_fields().coordinates();
+  BOOST_FOREACH(const TecplotZone& zone, zones)
+  {
+    const std::vector<Real>& node_idx = zone.values[2];
+    BOOST_REQUIRE_EQUAL(node_idx.size(), zone.nb_nodes);
+    for (Uint n=0; n<zone.nb_nodes; ++n)
+    {
+      const Uint node = static_cast<Uint>(node_idx[n]);
+      BOOST_CHECK_EQUAL(zone.values[0][n], coordinates[node][XX]);
+      BOOST_CHECK_EQUAL(zone.values[1][n], coordinates[node][YY]);
+      BOOST_CHECK_EQUAL(zone.values[6][n], coordinates[node][XX]);
+      BOOST_CHECK_EQUAL(zone.values[7][n], coordinates[node][YY]);
+    }
+
+    // elements of the region in the zone title, with the shape of the zone
+    const std::string region_path = zone.title.substr(zone.title.find(':')+1);
+    Handle<Elements const> elements;
+    BOOST_FOREACH(const Elements& region_elements, find_components<Elements>(*mesh.topology().access_component(URI(region_path, URI::Scheme::CPATH))))
+    {
+      if (nodes_per_element(zone.zone_type) == region_elements.element_type().nb_nodes())
+        elements = region_elements.handle<Elements>();
+    }
+    BOOST_REQUIRE(is_not_null(elements));
+    BOOST_REQUIRE_EQUAL(zone.nb_elems, elements->size());
+    const Connectivity& connectivity = elements->geometry_space().connectivity();
+    const Uint nb_elem_nodes = nodes_per_element(zone.zone_type);
+    const bool has_cell_centred = cell_centred.dict().defined_for_entities(elements);
+    for (Uint e=0; e<zone.nb_elems; ++e)
+    {
+      BOOST_CHECK_EQUAL(zone.values[4][e], has_cell_centred ? static_cast<Real>(cell_centred.space(*elements).connectivity()[e][0]) : 0.);
+      for (Uint n=0; n<nb_elem_nodes; ++n)
+        BOOST_CHECK_EQUAL(static_cast<Uint>(node_idx[zone.connectivity[e*nb_elem_nodes+n]]), connectivity[e][n]);
+    }
+  }
+
+  // one zone for each element type in the filtered regions
+  Uint nb_zones = 0;
+  BOOST_FOREACH(const URI& region, regions)
+  {
+    nb_zones += find_components_recursively<Elements>(*mesh.access_component(region)).size();
+  }
+  BOOST_CHECK_EQUAL(zones.size(), nb_zones);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,180 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::mesh::XDMF::Writer"
+
+#include <fstream>
+
+#include <boost/cstdint.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "rapidxml/rapidxml.hpp"
+
+#include "common/Log.hpp"
+#include "common/Core.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Table.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "common/XML/FileOperations.hpp"
+#include "common/XML/XmlDoc.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshWriter.hpp"
+#include "mesh/SimpleMeshGenerator.hpp"
+#include "mesh/Space.hpp"
+
+using namespace cf3;
+using namespace cf3::mesh;
+using namespace cf3::common;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct XDMFFixture
+{
+  XDMFFixture()
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Offset of the data of the given node in the binary file
+  static Uint seek(rapidxml::xml_node<>* node)
+  {
+    return from_str<Uint>(node->first_node("DataItem")->first_attribute("Seek")->value());
+  }
+
+  /// Attribute with the given name
+  static rapidxml::xml_node<>* attribute(rapidxml::xml_node<>* grid, const std::string& name)
+  {
+    for(rapidxml::xml_node<>* node = grid->first_node("Attribute"); node; node = node->next_sibling("Attribute"))
+    {
+      if(name == node->first_attribute("Name")->value())
+        return node;
+    }
+    BOOST_FAIL("Attribute " + name + " not found");
+    return 0;
+  }
+
+  int m_argc;
+  char** m_argv;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( XDMFSuite, XDMFFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Init )
+{
+  Core::instance().initiate(m_argc,m_argv);
+  PE::Comm::instance().init(m_argc,m_argv);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( WriteSharedFile )
+{
+  const Uint nx = 8;
+  const Uint ny = 6;
+
+  Mesh& mesh = *Core::instance().root().create_component<Mesh>("mesh");
+  SimpleMeshGenerator& mesh_gen = *Core::instance().root().create_component<SimpleMeshGenerator>("mesh_gen");
+  mesh_gen.options().set("mesh",mesh.uri());
+  mesh_gen.options().set("lengths",std::vector<Real>(2,4.));
+  std::vector<Uint> nb_cells(2, nx); nb_cells[1] = ny;
+  mesh_gen.options().set("nb_cells",nb_cells);
+  mesh_gen.execute();
+
+  // Nodal field u = x + 2y, and a cell field p with the x-coordinate of the cell centroid
+  const Field& coords = mesh.geometry_fields().coordinates();
+  Field& u = mesh.geometry_fields().create_field("u");
+  for(Uint i = 0; i != u.size(); ++i)
+    u[i][0] = coords[i][XX] + 2.*coords[i][YY];
+
+  Dictionary& cell_dict = mesh.create_discontinuous_space("cells_P0", "cf3.mesh.LagrangeP0");
+  Field& p = cell_dict.create_field("p");
+  boost_foreach(const Handle<Space>& space, cell_dict.spaces())
+  {
+    const Connectivity& geometry_connectivity = space->support().geometry_space().connectivity();
+    for(Uint e = 0; e != space->size(); ++e)
+    {
+      Real centroid = 0.;
+      boost_foreach(const Uint node, geometry_connectivity[e])
+        centroid += coords[node][XX];
+      p[space->connectivity()[e][0]][0] = centroid / static_cast<Real>(geometry_connectivity.row_size());
+    }
+  }
+
+  boost::shared_ptr< MeshWriter > writer = build_component_abstract_type<MeshWriter>("cf3.mesh.XDMF.Writer","meshwriter");
+  std::vector<URI> fields;
+  fields.push_back(u.uri());
+  fields.push_back(p.uri());
+  writer->options().set("fields", fields);
+  writer->write_from_to(mesh, "xdmf-grid.xmf");
+  PE::Comm::instance().barrier();
+
+  // The XML description
+  boost::shared_ptr<XML::XmlDoc> doc = XML::parse_file(URI("xdmf-grid.xmf"));
+  rapidxml::xml_node<>* grid = doc->content->first_node("Xdmf")->first_node("Domain")->first_node("Grid");
+  BOOST_REQUIRE(grid);
+  const Uint nb_nodes = (nx+1)*(ny+1);
+  BOOST_CHECK_EQUAL(std::string(grid->first_node("Geometry")->first_node("DataItem")->first_attribute("Dimensions")->value()), to_str(nb_nodes) + " 3");
+  BOOST_CHECK_EQUAL(from_str<Uint>(grid->first_node("Topology")->first_attribute("NumberOfElements")->value()), nx*ny);
+
+  // The data, written by all processes into a single file
+  std::ifstream file("xdmf-grid.bin", std::ios_base::in | std::ios_base::binary);
+  BOOST_REQUIRE(file.is_open());
+  const std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  const double* file_coords = reinterpret_cast<const double*>(&data[seek(grid->first_node("Geometry"))]);
+  const double* file_u = reinterpret_cast<const double*>(&data[seek(attribute(grid, "u"))]);
+  const double* file_p = reinterpret_cast<const double*>(&data[seek(attribute(grid, "p"))]);
+  const boost::uint32_t* topology = reinterpret_cast<const boost::uint32_t*>(&data[seek(grid->first_node("Topology"))]);
+
+  // Every process finds its nodes at their global index
+  const List<Uint>& glb_idx = mesh.geometry_fields().glb_idx();
+  for(Uint i = 0; i != coords.size(); ++i)
+  {
+    const Uint n = glb_idx[i];
+    BOOST_CHECK_EQUAL(file_coords[3*n], coords[i][XX]);
+    BOOST_CHECK_EQUAL(file_coords[3*n+1], coords[i][YY]);
+    BOOST_CHECK_EQUAL(file_coords[3*n+2], 0.);
+    BOOST_CHECK_EQUAL(file_u[n], u[i][0]);
+  }
+
+  // All cells are quads, and the cell data matches the topology
+  for(Uint e = 0; e != nx*ny; ++e)
+  {
+    BOOST_CHECK_EQUAL(topology[5*e], 5u);
+    double centroid = 0.;
+    for(Uint n = 1; n != 5; ++n)
+      centroid += file_coords[3*topology[5*e+n]];
+    BOOST_CHECK_CLOSE(file_p[e], centroid / 4., 1e-10);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+  Core::instance().terminate();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -7,11 +7,19 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for cf3::mesh::tecplot::Writer"
 
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
 #include <boost/test/unit_test.hpp>
 
 #include "common/Log.hpp"
 #include "common/Core.hpp"
+#include "common/OptionList.hpp"
+#include "common/StringConversion.hpp"
 
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
 #include "mesh/MeshWriter.hpp"
 
 #include "Tools/MeshGeneration/MeshGeneration.hpp"
@@ -40,7 +48,34 @@ BOOST_AUTO_TEST_CASE( WriteGrid )
   boost::shared_ptr< MeshWriter > vtk_writer = build_component_abstract_type<MeshWriter>("cf3.mesh.VTKLegacy.Writer","meshwriter");
   vtk_writer->write_from_to(*mesh,"grid.vtk");
 
-  BOOST_CHECK(true);
+  vtk_writer->options().set("binary", false);
+  vtk_writer->write_from_to(*mesh,"grid_ascii.vtk");
+
+  // read back the big-endian point coordinates of the binary file
+  std::ifstream file("grid.vtk", std::ios_base::in | std::ios_base::binary);
+  std::string line;
+  for(Uint i = 0; i != 3; ++i)
+    std::getline(file, line);
+  BOOST_CHECK_EQUAL(line, "BINARY");
+  std::getline(file, line);
+  std::getline(file, line);
+  const Field& coords = mesh->geometry_fields().coordinates();
+  const int one = 1;
+  const bool little_endian = *reinterpret_cast<const char*>(&one) == 1;
+  BOOST_CHECK_EQUAL(line, "POINTS " + to_str(coords.size()) + " double");
+  for(Uint i = 0; i != coords.size(); ++i)
+  {
+    for(Uint j = 0; j != 3; ++j)
+    {
+      char bytes[sizeof(double)];
+      file.read(bytes, sizeof(double));
+      if(little_endian)
+        std::reverse(bytes, bytes + sizeof(double));
+      double value;
+      std::memcpy(&value, bytes, sizeof(double));
+      BOOST_CHECK_EQUAL(value, j < 2 ? coords[i][j] : 0.);
+    }
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
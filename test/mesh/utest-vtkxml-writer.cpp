@@ -7,10 +7,14 @@
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE "Test module for cf3::mesh::tecplot::Writer"
 
+#include <fstream>
+#include <sstream>
+
 #include <boost/test/unit_test.hpp>
 
 #include "common/Log.hpp"
 #include "common/Core.hpp"
+#include "common/Environment.hpp"
 #include "common/OptionList.hpp"
 #include "common/OptionComponent.hpp"
 #include "common/OptionArray.hpp"
@@ -54,6 +58,48 @@ BOOST_AUTO_TEST_CASE( WriteGrid )
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/// Contents of a file
+std::string read_file(const std::string& path)
+{
+  std::ifstream file(path.c_str(), std::ios_base::in | std::ios_base::binary);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  return contents.str();
+}
+
+BOOST_AUTO_TEST_CASE( ThreadedCompression )
+{
+  Component& root = Core::instance().root();
+
+  Handle<Mesh> mesh = root.create_component<Mesh>("large_mesh");
+  Tools::MeshGeneration::create_rectangle(*mesh, 5., 5., 100, 100);
+
+  boost::shared_ptr< MeshWriter > vtk_writer = build_component_abstract_type<MeshWriter>("cf3.mesh.VTKXML.Writer","meshwriter");
+  std::vector<URI> fields; fields.push_back(mesh->geometry_fields().coordinates().uri());
+  vtk_writer->options().set("fields",fields);
+  vtk_writer->options().set("mesh",mesh);
+
+  vtk_writer->options().set("file",URI("serial.vtu"));
+  vtk_writer->execute();
+
+  // the file must not depend on the number of threads
+  Core::instance().environment().options().set("nb_threads", 4u);
+  vtk_writer->options().set("file",URI("threaded.vtu"));
+  vtk_writer->execute();
+  Core::instance().environment().options().set("nb_threads", 1u);
+  BOOST_CHECK(read_file("serial_P0.vtu") == read_file("threaded_P0.vtu"));
+
+  // uncompressed output
+  vtk_writer->options().set("compression_level", 0u);
+  vtk_writer->options().set("file",URI("raw.vtu"));
+  vtk_writer->execute();
+  const std::string raw = read_file("raw_P0.vtu");
+  BOOST_CHECK(raw.find("vtkZLibDataCompressor") == std::string::npos);
+  BOOST_CHECK(raw.size() > read_file("serial_P0.vtu").size());
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 BOOST_AUTO_TEST_SUITE_END()
 
 ////////////////////////////////////////////////////////////////////////////////
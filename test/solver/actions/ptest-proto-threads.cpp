@@ -0,0 +1,493 @@
+// Copyright (C) 2010-2011 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Strong scaling benchmark for threaded proto element loops"
+
+#include <set>
+
+#include <boost/foreach.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/test/unit_test.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "coolfluid-packages.hpp"
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
+#include "common/Log.hpp"
+#include "common/StringConversion.hpp"
+#include "common/Timer.hpp"
+#include "common/PE/Comm.hpp"
+#include "common/PE/CommPattern.hpp"
+
+#include "math/MatrixTypes.hpp"
+#include "math/LSS/System.hpp"
+
+#include "mesh/Connectivity.hpp"
+#include "mesh/Domain.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/Region.hpp"
+#include "mesh/Elements.hpp"
+#include "mesh/FieldManager.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Space.hpp"
+
+#include "mesh/BlockMesh/BlockData.hpp"
+
+#include "physics/PhysModel.hpp"
+
+#include "solver/Model.hpp"
+#include "solver/Solver.hpp"
+#include "solver/Tags.hpp"
+
+#include "solver/actions/Proto/BlockAccumulator.hpp"
+#include "solver/actions/Proto/ProtoAction.hpp"
+#include "solver/actions/Proto/ElementLooper.hpp"
+#include "solver/actions/Proto/ElementThreading.hpp"
+#include "solver/actions/Proto/Expression.hpp"
+#include "solver/actions/Proto/Functions.hpp"
+#include "solver/actions/Proto/NodeLooper.hpp"
+#include "solver/actions/Proto/Terminals.hpp"
+
+#include "Tools/MeshGeneration/MeshGeneration.hpp"
+#include "Tools/Testing/DartMeasurement.hpp"
+
+using namespace cf3;
+using namespace cf3::solver;
+using namespace cf3::solver::actions;
+using namespace cf3::solver::actions::Proto;
+using namespace cf3::mesh;
+using namespace cf3::common;
+using namespace cf3::Tools::Testing;
+
+////////////////////////////////////////////////////
+
+struct ProtoThreadsFixture
+{
+  ProtoThreadsFixture() :
+    root(Core::instance().root()),
+    length(12.),
+    half_height(0.5),
+    width(6.),
+    nb_iterations(5)
+  {
+  }
+
+  Model& model()
+  {
+    return *root.get_child("ThreadsModel")->handle<Model>();
+  }
+
+  Mesh& mesh()
+  {
+    return *model().domain().get_child("mesh")->handle<Mesh>();
+  }
+
+  Field& solution_field()
+  {
+    return find_component_recursively_with_tag<Field>(mesh(), "solution");
+  }
+
+  /// Copy of the residual stored in the solution field
+  void get_residual(RealVector& residual)
+  {
+    const Field& field = solution_field();
+    const Uint R_idx = field.descriptor().offset("R");
+    const Uint nb_nodes = field.size();
+    residual.resize(nb_nodes);
+    for(Uint i = 0; i != nb_nodes; ++i)
+      residual[i] = field[i][R_idx];
+  }
+
+  /// Number of volume elements in the mesh
+  Uint nb_volume_elements()
+  {
+    Uint result = 0;
+    BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh().topology(), IsElementsVolume()))
+    {
+      result += elements.size();
+    }
+    return result;
+  }
+
+  /// Run the assembly nb_iterations times using the given number of threads, returning the time per iteration
+  Real run_assembly(const Uint nb_threads)
+  {
+    Core::instance().environment().options().set("nb_threads", nb_threads);
+
+    Handle<common::Action> reset(model().solver().get_child("ResetResidual"));
+    Handle<common::Action> assembly(model().solver().get_child("Assembly"));
+
+    Timer timer;
+    for(Uint i = 0; i != nb_iterations; ++i)
+    {
+      reset->execute();
+      assembly->execute();
+    }
+    const Real time_per_iteration = timer.elapsed() / static_cast<Real>(nb_iterations);
+
+    Core::instance().environment().options().set("nb_threads", 1u);
+    return time_per_iteration;
+  }
+
+  Component& root;
+  const Real length;
+  const Real half_height;
+  const Real width;
+  const Uint nb_iterations;
+
+  typedef boost::mpl::vector1<LagrangeP1::Hexa3D> ElementsT;
+
+  /// Residual obtained with a single thread
+  static RealVector serial_residual;
+};
+
+RealVector ProtoThreadsFixture::serial_residual;
+
+BOOST_FIXTURE_TEST_SUITE( ProtoThreadsSuite, ProtoThreadsFixture )
+
+//////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Setup )
+{
+  int argc = boost::unit_test::framework::master_test_suite().argc;
+  char** argv = boost::unit_test::framework::master_test_suite().argv;
+
+  // The LSS comm pattern requires MPI
+  PE::Comm::instance().init(argc, argv);
+
+  cf3_assert(argc == 4);
+  const Uint x_segs = boost::lexical_cast<Uint>(argv[1]);
+  const Uint y_segs = boost::lexical_cast<Uint>(argv[2]);
+  const Uint z_segs = boost::lexical_cast<Uint>(argv[3]);
+
+  Model& model = *root.create_component<Model>("ThreadsModel");
+  physics::PhysModel& phys_model = model.create_physics("cf3.physics.DynamicModel");
+  Domain& dom = model.create_domain("Domain");
+  Solver& solver = model.create_solver("cf3.solver.SimpleSolver");
+
+  Mesh& mesh = *dom.create_component<Mesh>("mesh");
+
+  BlockMesh::BlockArrays& blocks = *dom.create_component<BlockMesh::BlockArrays>("blocks");
+  Tools::MeshGeneration::create_channel_3d(blocks, length, half_height, width, x_segs, y_segs/2, z_segs, 0.1);
+  blocks.create_mesh(mesh);
+
+  phys_model.variable_manager().create_descriptor("solution", "T, R");
+  solver.field_manager().create_field("solution", mesh.geometry_fields());
+
+  FieldVariable<0, ScalarField> T("T", "solution");
+  FieldVariable<1, ScalarField> R("R", "solution");
+
+  // Non-trivial initial field
+  for_each_node(mesh.topology(), T = coordinates[0]*coordinates[0] + coordinates[1] + coordinates[2]);
+
+  solver << create_proto_action("ResetResidual", nodes_expression(R = 0.));
+
+  // Laplacian residual, accumulated into the nodes so threads must not touch the same node concurrently
+  solver << create_proto_action
+  (
+    "Assembly",
+    elements_expression
+    (
+      ElementsT(),
+      group
+      (
+        _A(T) = _0, _a[T] = _0,
+        element_quadrature
+        (
+          _a[T] += transpose(nabla(T)) * nabla(T) * nodal_values(T)
+        ),
+        R += _a
+      )
+    )
+  );
+
+  std::vector<URI> root_regions;
+  root_regions.push_back(mesh.topology().uri());
+  solver.configure_option_recursively(solver::Tags::regions(), root_regions);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( CheckColoring )
+{
+  BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh().topology(), IsElementsVolume()))
+  {
+    const ElementColoring& coloring = ElementThreading::instance().coloring(elements);
+    const Connectivity& connectivity = elements.geometry_space().connectivity();
+    const Uint nb_nodes = elements.geometry_fields().size();
+
+    std::cout << "Coloring of " << elements.uri().path() << " uses " << coloring.nb_colors() << " colors" << std::endl;
+    BOOST_CHECK_EQUAL(coloring.color_end(coloring.nb_colors()-1), elements.size());
+
+    // No node may be visited twice in the same color
+    std::vector<Uint> node_color(nb_nodes, coloring.nb_colors());
+    for(Uint color = 0; color != coloring.nb_colors(); ++color)
+    {
+      for(Uint i = coloring.color_begin(color); i != coloring.color_end(color); ++i)
+      {
+        BOOST_FOREACH(const Uint node, connectivity[coloring.element(i)])
+        {
+          BOOST_CHECK_NE(node_color[node], color);
+          node_color[node] = color;
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Compare with the serial residual for a fixed number of threads, so threads are used even if the machine has a single core
+BOOST_AUTO_TEST_CASE( ThreadedResidual )
+{
+  const Uint nb_elems = nb_volume_elements();
+
+  run_assembly(1);
+  get_residual(serial_residual);
+
+  RealVector threaded_residual;
+  for(Uint nb_threads = 2; nb_threads <= 4; ++nb_threads)
+  {
+    Core::instance().environment().options().set("nb_threads", nb_threads);
+    BOOST_REQUIRE_EQUAL(ElementThreading::instance().nb_workers(nb_elems), nb_threads);
+    Core::instance().environment().options().set("nb_threads", 1u);
+
+    run_assembly(nb_threads);
+    get_residual(threaded_residual);
+    for(Uint i = 0; i != threaded_residual.size(); ++i)
+      BOOST_CHECK_SMALL(threaded_residual[i] - serial_residual[i], 1e-10 * (1. + std::abs(serial_residual[i])));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Assembly into a system matrix and RHS through the block accumulator
+BOOST_AUTO_TEST_CASE( ThreadedMatrixAssembly )
+{
+  const Dictionary& geometry = mesh().geometry_fields();
+  const Uint nb_nodes = geometry.size();
+
+  // Node connectivity graph of the volume elements
+  std::vector< std::set<Uint> > connected_nodes(nb_nodes);
+  BOOST_FOREACH(const Elements& elements, find_components_recursively_with_filter<Elements>(mesh().topology(), IsElementsVolume()))
+  {
+    const Connectivity& connectivity = elements.geometry_space().connectivity();
+    const Uint nb_elems = connectivity.size();
+    for(Uint elem = 0; elem != nb_elems; ++elem)
+    {
+      BOOST_FOREACH(const Uint node_a, connectivity[elem])
+      {
+        BOOST_FOREACH(const Uint node_b, connectivity[elem])
+        {
+          connected_nodes[node_a].insert(node_b);
+        }
+      }
+    }
+  }
+
+  std::vector<Uint> node_connectivity;
+  std::vector<Uint> starting_indices(1, 0);
+  for(Uint i = 0; i != nb_nodes; ++i)
+  {
+    node_connectivity.insert(node_connectivity.end(), connected_nodes[i].begin(), connected_nodes[i].end());
+    starting_indices.push_back(node_connectivity.size());
+  }
+
+  std::vector<Uint> gids(nb_nodes);
+  std::vector<Uint> ranks(nb_nodes, 0);
+  for(Uint i = 0; i != nb_nodes; ++i)
+    gids[i] = i;
+
+  PE::CommPattern& comm_pattern = *root.create_component<PE::CommPattern>("ThreadsCommPattern");
+  comm_pattern.insert("gid", gids, 1, false);
+  comm_pattern.setup(Handle<PE::CommWrapper>(comm_pattern.get_child("gid")), ranks);
+
+  // Each backend must accept concurrent add_values on the disjoint rows of one color
+  std::vector<std::string> matrix_builders;
+  matrix_builders.push_back("cf3.math.LSS.NativeMatrix");
+#ifdef CF3_HAVE_TRILINOS
+  matrix_builders.push_back("cf3.math.LSS.TrilinosFEVbrMatrix");
+  matrix_builders.push_back("cf3.math.LSS.TrilinosCrsMatrix");
+#endif
+
+  FieldVariable<0, ScalarField> T("T", "solution");
+
+  BOOST_FOREACH(const std::string& matrix_builder, matrix_builders)
+  {
+    BOOST_TEST_MESSAGE("Threaded assembly into " << matrix_builder);
+
+    math::LSS::System& lss = *root.create_component<math::LSS::System>("ThreadsLSS");
+    lss.options().set("matrix_builder", matrix_builder);
+    lss.create(comm_pattern, 1, node_connectivity, starting_indices);
+
+    SystemMatrix system_matrix(lss);
+    SystemRHS system_rhs(lss);
+
+    boost::shared_ptr<Expression> assembly = elements_expression
+    (
+      ElementsT(),
+      group
+      (
+        _A(T) = _0,
+        element_quadrature
+        (
+          _A(T) += transpose(nabla(T)) * nabla(T) + transpose(N(T)) * N(T)
+        ),
+        system_matrix += _A,
+        system_rhs += -_A * _x
+      )
+    );
+
+    std::vector<Uint> rows, cols;
+    std::vector<Real> serial_matrix, threaded_matrix, serial_rhs, threaded_rhs;
+
+    for(Uint nb_threads = 1; nb_threads <= 4; ++nb_threads)
+    {
+      Core::instance().environment().options().set("nb_threads", nb_threads);
+      lss.matrix()->reset(0.);
+      lss.rhs()->reset(0.);
+      assembly->loop(mesh().topology());
+      Core::instance().environment().options().set("nb_threads", 1u);
+
+      if(nb_threads == 1)
+      {
+        lss.matrix()->debug_data(rows, cols, serial_matrix);
+        lss.rhs()->debug_data(serial_rhs);
+        continue;
+      }
+
+      lss.matrix()->debug_data(rows, cols, threaded_matrix);
+      lss.rhs()->debug_data(threaded_rhs);
+
+      BOOST_REQUIRE_EQUAL(threaded_matrix.size(), serial_matrix.size());
+      for(Uint i = 0; i != serial_matrix.size(); ++i)
+        BOOST_CHECK_SMALL(threaded_matrix[i] - serial_matrix[i], 1e-10 * (1. + std::abs(serial_matrix[i])));
+
+      BOOST_REQUIRE_EQUAL(threaded_rhs.size(), serial_rhs.size());
+      for(Uint i = 0; i != serial_rhs.size(); ++i)
+        BOOST_CHECK_SMALL(threaded_rhs[i] - serial_rhs[i], 1e-10 * (1. + std::abs(serial_rhs[i])));
+    }
+
+    root.remove_component(lss);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Reductions into ThreadLocal values, completed after the loop as in ComputeCFL and SurfaceIntegral
+BOOST_AUTO_TEST_CASE( ThreadLocalReductions )
+{
+  using boost::proto::lit;
+
+  FieldVariable<0, ScalarField> T("T", "solution");
+
+  ThreadLocalReal min_volume;
+  ThreadLocalVector gradient_integral;
+
+  boost::shared_ptr<Expression> reductions = elements_expression
+  (
+    ElementsT(),
+    group
+    (
+      lit(min_volume) = _min(lit(min_volume), volume),
+      lit(gradient_integral) += integral<1>(nabla(T) * nodal_values(T))
+    )
+  );
+
+  Real serial_min_volume = 0.;
+  RealVector serial_integral;
+  for(Uint nb_threads = 1; nb_threads <= 4; ++nb_threads)
+  {
+    min_volume.set_all(1e10);
+    gradient_integral.set_all(RealVector::Zero(3));
+
+    Core::instance().environment().options().set("nb_threads", nb_threads);
+    reductions->loop(mesh().topology());
+    Core::instance().environment().options().set("nb_threads", 1u);
+
+    Real result_min_volume = 1e10;
+    RealVector result_integral = RealVector::Zero(3);
+    for(Uint i = 0; i != CF3_PROTO_MAX_THREADS; ++i)
+    {
+      result_min_volume = std::min(result_min_volume, min_volume.value(i));
+      result_integral += gradient_integral.value(i);
+    }
+
+    if(nb_threads == 1)
+    {
+      serial_min_volume = result_min_volume;
+      serial_integral = result_integral;
+      BOOST_CHECK(serial_min_volume > 0.);
+      continue;
+    }
+
+    BOOST_CHECK_EQUAL(result_min_volume, serial_min_volume);
+    for(Uint i = 0; i != 3; ++i)
+      BOOST_CHECK_SMALL(result_integral[i] - serial_integral[i], 1e-10 * (1. + std::abs(serial_integral[i])));
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( StrongScaling )
+{
+  const Uint max_threads = std::max(1u, std::min(boost::thread::hardware_concurrency(), static_cast<Uint>(CF3_PROTO_MAX_THREADS)));
+
+  RealVector residual;
+  Real serial_time = 0.;
+  for(Uint nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2)
+  {
+    const Real time = run_assembly(nb_threads);
+    if(nb_threads == 1)
+    {
+      serial_time = time;
+    }
+    else
+    {
+      get_residual(residual);
+      for(Uint i = 0; i != residual.size(); ++i)
+        BOOST_CHECK_SMALL(residual[i] - serial_residual[i], 1e-10 * (1. + std::abs(serial_residual[i])));
+    }
+
+    dart_measurement("assembly time " + to_str(nb_threads) + " threads", time);
+    dart_measurement("assembly speedup " + to_str(nb_threads) + " threads", serial_time / time);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Colorings are dropped when the mesh changes
+BOOST_AUTO_TEST_CASE( ColoringCacheEviction )
+{
+  BOOST_CHECK(ElementThreading::instance().nb_cached_colorings() > 0);
+  mesh().raise_mesh_changed();
+  BOOST_CHECK_EQUAL(ElementThreading::instance().nb_cached_colorings(), 0);
+
+  // The next threaded loop rebuilds the coloring
+  run_assembly(2);
+  BOOST_CHECK(ElementThreading::instance().nb_cached_colorings() > 0);
+
+  RealVector residual;
+  get_residual(residual);
+  for(Uint i = 0; i != residual.size(); ++i)
+    BOOST_CHECK_SMALL(residual[i] - serial_residual[i], 1e-10 * (1. + std::abs(serial_residual[i])));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( Finalize )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -213,6 +213,17 @@ BOOST_AUTO_TEST_CASE( ProtoActionTest )
   Real temp_sum = 0.;
   nodes_expression(lit(temp_sum) += T)->loop(model->domain().get_child("mesh")->handle<Mesh>()->topology());
   BOOST_CHECK_EQUAL(temp_sum / static_cast<Real>(1+nb_segments), 288.);
+
+  // The list of nodes is only built again after the mesh changed
+  const Uint nb_builds = action.properties().value<Uint>("used_nodes_builds");
+  BOOST_CHECK(nb_builds <= 1);
+  action.execute();
+  action.execute();
+  BOOST_CHECK_EQUAL(action.properties().value<Uint>("used_nodes_builds"), nb_builds);
+  mesh->raise_mesh_changed();
+  action.execute();
+  action.execute();
+  BOOST_CHECK_EQUAL(action.properties().value<Uint>("used_nodes_builds"), nb_builds+1);
 }
 
 /// Test SimpleSolver
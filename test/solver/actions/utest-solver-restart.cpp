@@ -0,0 +1,217 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for the WriteRestart and ReadRestart actions"
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include "common/Core.hpp"
+#include "common/Environment.hpp"
+#include "common/OptionList.hpp"
+#include "common/List.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+
+#include "solver/Tags.hpp"
+#include "solver/Time.hpp"
+#include "solver/TimeStepping.hpp"
+#include "solver/actions/ReadRestart.hpp"
+#include "solver/actions/WriteRestart.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+using namespace cf3::solver::actions;
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct RestartFixture
+{
+  RestartFixture() :
+    root(Core::instance().root())
+  {
+    m_argc = boost::unit_test::framework::master_test_suite().argc;
+    m_argv = boost::unit_test::framework::master_test_suite().argv;
+  }
+
+  /// Path of the file written by this rank for the given restart file
+  static boost::filesystem::path rank_file(const std::string& file)
+  {
+    const boost::filesystem::path path(file);
+    return path.parent_path() / (boost::filesystem::basename(path) + "_P" + to_str(PE::Comm::instance().rank()) + boost::filesystem::extension(path));
+  }
+
+  /// Value stored in the solution field, depending on the global node index
+  static Real solution_value(const Uint gid, const Uint var)
+  {
+    return static_cast<Real>(gid) + 0.25*static_cast<Real>(var);
+  }
+
+  /// Check the solution field against solution_value, or against zero
+  static void check_solution(const Mesh& mesh, const bool expect_zero)
+  {
+    const Dictionary& dict = mesh.geometry_fields();
+    Handle<Field const> solution(dict.get_child("solution"));
+    BOOST_REQUIRE(is_not_null(solution));
+    BOOST_REQUIRE_EQUAL(solution->size(), dict.glb_idx().size());
+    for(Uint i = 0; i != solution->size(); ++i)
+      for(Uint j = 0; j != solution->row_size(); ++j)
+        BOOST_CHECK_EQUAL((*solution)[i][j], expect_zero ? 0. : solution_value(dict.glb_idx()[i], j));
+  }
+
+  int m_argc;
+  char** m_argv;
+  Component& root;
+};
+
+BOOST_FIXTURE_TEST_SUITE( RestartSuite, RestartFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( InitMPI )
+{
+  PE::Comm::instance().init(m_argc, m_argv);
+  BOOST_CHECK(PE::Comm::instance().is_active());
+}
+
+BOOST_AUTO_TEST_CASE( Setup )
+{
+  // Partitioned over all ranks by the generator
+  Handle<Mesh> mesh = root.create_component<Mesh>("mesh");
+  boost::shared_ptr<MeshGenerator> generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator", "generator");
+  generator->options().set("mesh", mesh->uri());
+  generator->options().set("nb_cells", std::vector<Uint>(2, 10u));
+  generator->options().set("lengths", std::vector<Real>(2, 1.));
+  generator->execute();
+
+  Field& solution = mesh->geometry_fields().create_field("solution", "u[vector],p");
+  for(Uint i = 0; i != solution.size(); ++i)
+    for(Uint j = 0; j != solution.row_size(); ++j)
+      solution[i][j] = solution_value(mesh->geometry_fields().glb_idx()[i], j);
+
+  Handle<Time> time = root.create_component<Time>("time");
+  Handle<TimeStepping> time_stepping = root.create_component<TimeStepping>("time_stepping");
+
+  Handle<WriteRestart> write_restart = root.create_component<WriteRestart>("write_restart");
+  write_restart->options().set("mesh", mesh);
+  write_restart->options().set(solver::Tags::time(), time);
+  write_restart->options().set("time_stepping", time_stepping);
+  write_restart->options().set("file", URI("restart-test.cf3mesh"));
+  write_restart->options().set("interval", 3u);
+
+  Handle<ReadRestart> read_restart = root.create_component<ReadRestart>("read_restart");
+  read_restart->options().set(solver::Tags::time(), time);
+  read_restart->options().set("time_stepping", time_stepping);
+  read_restart->options().set("file", URI("restart-test.cf3mesh"));
+
+  boost::filesystem::remove(rank_file("restart-test.cf3mesh"));
+}
+
+BOOST_AUTO_TEST_CASE( Interval )
+{
+  WriteRestart& write_restart = *Handle<WriteRestart>(root.get_child("write_restart"));
+  Time& time = *Handle<Time>(root.get_child("time"));
+
+  // Iteration 2 is not a multiple of the interval
+  time.options().set("iteration", 2u);
+  write_restart.execute();
+  BOOST_CHECK(!boost::filesystem::exists(rank_file("restart-test.cf3mesh")));
+
+  // An interval of 0 disables writing altogether
+  time.options().set("iteration", 3u);
+  write_restart.options().set("interval", 0u);
+  write_restart.execute();
+  BOOST_CHECK(!boost::filesystem::exists(rank_file("restart-test.cf3mesh")));
+
+  // Iteration 3 is written
+  write_restart.options().set("interval", 3u);
+  time.options().set("current_time", 0.3);
+  time.options().set("time_step", 0.1);
+  Handle<TimeStepping> time_stepping(root.get_child("time_stepping"));
+  time_stepping->options().set("step", 3u);
+  time_stepping->options().set("time", 0.3);
+  time_stepping->options().set("walltime", 12.5);
+  write_restart.execute();
+  BOOST_CHECK(boost::filesystem::exists(rank_file("restart-test.cf3mesh")));
+}
+
+BOOST_AUTO_TEST_CASE( CopyFields )
+{
+  Mesh& mesh = *Handle<Mesh>(root.get_child("mesh"));
+  Time& time = *Handle<Time>(root.get_child("time"));
+  TimeStepping& time_stepping = *Handle<TimeStepping>(root.get_child("time_stepping"));
+
+  // Wipe the state that was written
+  Handle<Field> solution(mesh.geometry_fields().get_child("solution"));
+  for(Uint i = 0; i != solution->size(); ++i)
+    for(Uint j = 0; j != solution->row_size(); ++j)
+      (*solution)[i][j] = 0.;
+  check_solution(mesh, true);
+  time.options().set("iteration", 7u);
+  time.options().set("current_time", 0.7);
+  time.options().set("time_step", 0.2);
+  time_stepping.options().set("step", 7u);
+  time_stepping.options().set("time", 0.7);
+  time_stepping.options().set("walltime", 20.);
+
+  // The mesh already has elements, so only the fields are copied
+  ReadRestart& read_restart = *Handle<ReadRestart>(root.get_child("read_restart"));
+  read_restart.options().set("mesh", mesh.handle<Mesh>());
+  read_restart.execute();
+
+  check_solution(mesh, false);
+  BOOST_CHECK(is_null(read_restart.get_child("restart_mesh")));
+
+  BOOST_CHECK_EQUAL(time.iter(), 3u);
+  BOOST_CHECK_EQUAL(time.current_time(), 0.3);
+  BOOST_CHECK_EQUAL(time.dt(), 0.1);
+  BOOST_CHECK_EQUAL(time_stepping.options().value<Uint>("step"), 3u);
+  BOOST_CHECK_EQUAL(time_stepping.options().value<Real>("time"), 0.3);
+  BOOST_CHECK_EQUAL(time_stepping.options().value<Real>("walltime"), 12.5);
+}
+
+BOOST_AUTO_TEST_CASE( ReadIntoEmptyMesh )
+{
+  const Mesh& mesh = *Handle<Mesh>(root.get_child("mesh"));
+  Time& time = *Handle<Time>(root.get_child("time"));
+  time.options().set("iteration", 0u);
+  time.options().set("current_time", 0.);
+  time.options().set("time_step", 1.);
+
+  Handle<Mesh> restarted_mesh = root.create_component<Mesh>("restarted_mesh");
+  ReadRestart& read_restart = *Handle<ReadRestart>(root.get_child("read_restart"));
+  read_restart.options().set("mesh", restarted_mesh);
+  read_restart.execute();
+
+  // Each rank gets back its own partition
+  BOOST_CHECK_EQUAL(restarted_mesh->dimension(), mesh.dimension());
+  BOOST_REQUIRE_EQUAL(restarted_mesh->geometry_fields().size(), mesh.geometry_fields().size());
+  BOOST_CHECK(restarted_mesh->geometry_fields().glb_idx().array() == mesh.geometry_fields().glb_idx().array());
+  BOOST_CHECK(restarted_mesh->geometry_fields().coordinates().array() == mesh.geometry_fields().coordinates().array());
+  check_solution(*restarted_mesh, false);
+
+  BOOST_CHECK_EQUAL(time.iter(), 3u);
+  BOOST_CHECK_EQUAL(time.current_time(), 0.3);
+  BOOST_CHECK_EQUAL(time.dt(), 0.1);
+}
+
+BOOST_AUTO_TEST_CASE( FinalizeMPI )
+{
+  PE::Comm::instance().finalize();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,250 @@
+// Copyright (C) 2010-2013 von Karman Institute for Fluid Dynamics, Belgium
+//
+// This software is distributed under the terms of the
+// GNU Lesser General Public License version 3 (LGPLv3).
+// See doc/lgpl.txt and doc/gpl.txt for the license text.
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE "Test module for cf3::solver::ComputeRHS"
+
+#include <boost/test/unit_test.hpp>
+
+#include "common/Core.hpp"
+#include "common/Foreach.hpp"
+#include "common/List.hpp"
+#include "common/OptionList.hpp"
+#include "common/PE/Comm.hpp"
+
+#include "mesh/Cells.hpp"
+#include "mesh/Connectivity.hpp"
+#include "mesh/Dictionary.hpp"
+#include "mesh/Field.hpp"
+#include "mesh/Mesh.hpp"
+#include "mesh/MeshGenerator.hpp"
+#include "mesh/Space.hpp"
+#include "mesh/LagrangeP1/Quad.hpp"
+
+#include "solver/ComputeRHS.hpp"
+#include "solver/TermComputer.hpp"
+
+using namespace cf3;
+using namespace cf3::common;
+using namespace cf3::mesh;
+using namespace cf3::solver;
+
+////////////////////////////////////////////////////////////////////////////////
+
+/// Value of the test terms, different for each element, solution point and equation
+Real term_value(const Uint elem, const Uint sol_pt, const Uint eq)
+{
+  return 10.*elem + sol_pt + 0.5*eq;
+}
+
+Real wave_speed_value(const Uint elem, const Uint sol_pt)
+{
+  return elem + 0.1*sol_pt;
+}
+
+/// Term computed element by element, through the default block implementation
+class ElementTermComputer : public TermComputer
+{
+public:
+  ElementTermComputer(const std::string& name) : TermComputer(name) {}
+  static std::string type_name() { return "ElementTermComputer"; }
+
+  virtual bool loop_cells(const Handle<Entities const>& cells)
+  {
+    return is_not_null(Handle<Cells const>(cells));
+  }
+
+  virtual void compute_term(const Uint elem_idx, std::vector<RealVector>& term, std::vector<Real>& wave_speed)
+  {
+    term.resize(4,RealVector(2));
+    wave_speed.resize(4);
+    for (Uint s=0; s<4; ++s)
+    {
+      for (Uint eq=0; eq<2; ++eq)
+        term[s][eq] = term_value(elem_idx,s,eq);
+      wave_speed[s] = wave_speed_value(elem_idx,s);
+    }
+  }
+};
+
+/// The same term computed for blocks of elements
+class BlockTermComputer : public TermComputerT<LagrangeP1::Quad,2>
+{
+public:
+  BlockTermComputer(const std::string& name) : TermComputerT<LagrangeP1::Quad,2>(name) {}
+  static std::string type_name() { return "BlockTermComputer"; }
+
+  virtual bool loop_cells(const Handle<Entities const>& cells)
+  {
+    return is_not_null(Handle<Cells const>(cells));
+  }
+
+  virtual void compute_term_block(const Uint begin, const Uint nb_elems, TermBlockT& term, WaveSpeedBlockT& wave_speed)
+  {
+    for (Uint s=0; s<NSOLPTS; ++s)
+    {
+      for (Uint eq=0; eq<NEQS; ++eq)
+      {
+        for (Uint e=0; e<nb_elems; ++e)
+          term[s][eq][e] = term_value(begin+e,s,eq);
+      }
+      for (Uint e=0; e<nb_elems; ++e)
+        wave_speed[s][e] = 2.*wave_speed_value(begin+e,s);
+    }
+  }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+struct ComputeRHSFixture
+{
+  ComputeRHSFixture()
+  {
+    boost::shared_ptr< MeshGenerator > generator = build_component_abstract_type<MeshGenerator>("cf3.mesh.SimpleMeshGenerator","generator");
+    generator->options().set("mesh",URI("//rectangle"));
+    // More elements than a block, and not a multiple of the block size
+    std::vector<Uint> nb_cells(2, 9u);
+    generator->options().set("nb_cells",nb_cells);
+    generator->options().set("lengths",std::vector<Real>(2,1.));
+    mesh = generator->generate().handle<Mesh>();
+
+    Dictionary& solution_space = mesh->create_discontinuous_space("solution_space","cf3.mesh.LagrangeP1");
+    rhs = solution_space.create_field("rhs","a,b").handle<Field>();
+    wave_speed = solution_space.create_field("wave_speed","ws").handle<Field>();
+  }
+
+  ~ComputeRHSFixture()
+  {
+    Core::instance().root().remove_component(*mesh);
+  }
+
+  /// Check the values of field at the solution points of the cells, as a function of the element, solution point and column
+  template <typename FunctorT>
+  void check(const Field& field, const FunctorT& expected)
+  {
+    boost_foreach(const Handle<Entities>& entities, field.entities_range())
+    {
+      if (is_null(Handle<Cells>(entities)))
+        continue;
+      const Space& space = field.space(*entities);
+      for (Uint e=0; e<entities->size(); ++e)
+      {
+        for (Uint s=0; s<space.shape_function().nb_nodes(); ++s)
+        {
+          const Uint p = space.connectivity()[e][s];
+          for (Uint i=0; i<field.row_size(); ++i)
+            BOOST_CHECK_EQUAL(field[p][i], expected(e,s,i));
+        }
+      }
+    }
+  }
+
+  Handle<Mesh> mesh;
+  Handle<Field> rhs;
+  Handle<Field> wave_speed;
+};
+
+struct ExpectedTerm
+{
+  ExpectedTerm(const Real factor) : factor(factor) {}
+  Real operator()(const Uint e, const Uint s, const Uint eq) const { return factor*term_value(e,s,eq); }
+  Real factor;
+};
+
+struct ExpectedWaveSpeed
+{
+  ExpectedWaveSpeed(const Real factor) : factor(factor) {}
+  Real operator()(const Uint e, const Uint s, const Uint) const { return factor*wave_speed_value(e,s); }
+  Real factor;
+};
+
+/// Expected value on the owned elements, and the initial value on the ghosts, which are skipped
+template <typename FunctorT>
+struct SkipGhosts
+{
+  SkipGhosts(const Entities& cells, const FunctorT& owned, const Real initial) : cells(cells), owned(owned), initial(initial) {}
+  Real operator()(const Uint e, const Uint s, const Uint i) const { return cells.is_ghost(e) ? initial : owned(e,s,i); }
+  const Entities& cells;
+  FunctorT owned;
+  Real initial;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_FIXTURE_TEST_SUITE( ComputeRHSSuite, ComputeRHSFixture )
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_CASE( TermComputerBlocks )
+{
+  boost::shared_ptr<TermComputer> element_term = allocate_component<ElementTermComputer>("element_term");
+  element_term->compute_term(*rhs,*wave_speed);
+  check(*rhs,ExpectedTerm(1.));
+  check(*wave_speed,ExpectedWaveSpeed(1.));
+
+  boost::shared_ptr<TermComputer> block_term = allocate_component<BlockTermComputer>("block_term");
+  block_term->compute_term(*rhs,*wave_speed);
+  check(*rhs,ExpectedTerm(1.));
+  check(*wave_speed,ExpectedWaveSpeed(2.));
+
+  // The per-element interface goes through the blocks
+  std::vector<RealVector> term;
+  std::vector<Real> ws;
+  block_term->compute_term(5u,term,ws);
+  BOOST_CHECK_EQUAL(term.size(), 4u);
+  BOOST_CHECK_EQUAL(term[3][1], term_value(5,3,1));
+  BOOST_CHECK_EQUAL(ws[2], 2.*wave_speed_value(5,2));
+}
+
+BOOST_AUTO_TEST_CASE( SumOfTerms )
+{
+  boost::shared_ptr<ComputeRHS> compute_rhs = allocate_component<ComputeRHS>("compute_rhs");
+  compute_rhs->create_component<ElementTermComputer>("element_term");
+  compute_rhs->create_component<BlockTermComputer>("block_term");
+  compute_rhs->compute_rhs(*rhs,*wave_speed);
+  check(*rhs,ExpectedTerm(2.));
+  check(*wave_speed,ExpectedWaveSpeed(2.));
+}
+
+BOOST_AUTO_TEST_CASE( GhostsInsideBlocks )
+{
+  // Ghosts split the first two blocks and end the last one
+  Handle<Entities> cells;
+  boost_foreach(const Handle<Entities>& entities, rhs->entities_range())
+  {
+    if (is_not_null(Handle<Cells>(entities)))
+      cells = entities;
+  }
+  BOOST_REQUIRE(is_not_null(cells));
+  const Uint ghost_rank = PE::Comm::instance().rank() + 1;
+  cells->rank()[5] = ghost_rank;
+  cells->rank()[6] = ghost_rank;
+  cells->rank()[TermComputer::block_size + 7] = ghost_rank;
+  cells->rank()[cells->size()-1] = ghost_rank;
+
+  *rhs = -1.;
+  *wave_speed = -1.;
+  boost::shared_ptr<ComputeRHS> compute_rhs = allocate_component<ComputeRHS>("compute_rhs");
+  compute_rhs->create_component<ElementTermComputer>("element_term");
+  compute_rhs->create_component<BlockTermComputer>("block_term");
+  compute_rhs->compute_rhs(*rhs,*wave_speed);
+  check(*rhs,SkipGhosts<ExpectedTerm>(*cells,ExpectedTerm(2.),-1.));
+  check(*wave_speed,SkipGhosts<ExpectedWaveSpeed>(*cells,ExpectedWaveSpeed(2.),-1.));
+}
+
+BOOST_AUTO_TEST_CASE( WrongSizes )
+{
+  // Three equations instead of two
+  Field& rhs3 = rhs->dict().create_field("rhs3","a,b,c");
+  boost::shared_ptr<TermComputer> block_term = allocate_component<BlockTermComputer>("block_term");
+  BOOST_CHECK_THROW(block_term->compute_term(rhs3,*wave_speed), BadValue);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+BOOST_AUTO_TEST_SUITE_END()
+
+////////////////////////////////////////////////////////////////////////////////